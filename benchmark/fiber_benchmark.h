@@ -0,0 +1,176 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_FIBER_BENCHMARK_H
+#define CURAENGINE_FIBER_BENCHMARK_H
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "Application.h"
+#include "MeshGroup.h"
+#include "fiberpath.h"
+#include "geometry/OpenLinesSet.h"
+#include "geometry/OpenPolyline.h"
+#include "geometry/Polygon.h"
+#include "geometry/Shape.h"
+#include "layerPart.h"
+#include "mesh.h"
+#include "sliceDataStorage.h"
+#include "utils/AABB.h"
+
+namespace cura
+{
+/*!
+ * Synthetic fiber paths on a plate with a grid of square parts.
+ *
+ * Every fiber layer is a zig-zag over the whole plate, split into a number of
+ * polylines. The first benchmark argument is the number of layers, the second
+ * the number of points per fiber layer.
+ */
+class FiberTestFixture : public benchmark::Fixture
+{
+public:
+    static constexpr coord_t PLATE_SIZE = MM2INT(200);
+    static constexpr size_t PARTS_PER_SIDE = 5;
+    static constexpr coord_t PART_SIZE = MM2INT(30);
+    static constexpr size_t POLYLINES_PER_LAYER = 10;
+    static constexpr coord_t LAYER_THICKNESS = 200;
+
+    size_t layer_count;
+    size_t points_per_layer;
+    FiberPaths fiber_paths;
+    Shape part_outlines; //!< All parts of a single layer.
+    std::string txt_filename;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        layer_count = state.range(0);
+        points_per_layer = state.range(1);
+
+        Application::getInstance().startThreadPool();
+
+        fiber_paths = FiberPaths();
+        const size_t points_per_polyline = std::max<size_t>(2, points_per_layer / POLYLINES_PER_LAYER);
+        for (size_t layer_nr = 0; layer_nr < layer_count; layer_nr++)
+        {
+            FiberPath& layer = fiber_paths.paths.emplace_back(static_cast<coord_t>(layer_nr + 1) * LAYER_THICKNESS);
+            for (size_t polyline_idx = 0; polyline_idx < POLYLINES_PER_LAYER; polyline_idx++)
+            {
+                OpenPolyline& polyline = layer.paths.emplace_back();
+                const coord_t y_start = static_cast<coord_t>(polyline_idx) * PLATE_SIZE / POLYLINES_PER_LAYER;
+                for (size_t point_idx = 0; point_idx < points_per_polyline; point_idx++)
+                {
+                    const coord_t x = static_cast<coord_t>(point_idx) * PLATE_SIZE / static_cast<coord_t>(points_per_polyline);
+                    const coord_t y = y_start + ((point_idx % 2 == 0) ? 0 : PLATE_SIZE / POLYLINES_PER_LAYER - 100);
+                    polyline.emplace_back(x, y);
+                }
+            }
+        }
+
+        part_outlines.clear();
+        const coord_t part_spacing = PLATE_SIZE / PARTS_PER_SIDE;
+        for (size_t x_idx = 0; x_idx < PARTS_PER_SIDE; x_idx++)
+        {
+            for (size_t y_idx = 0; y_idx < PARTS_PER_SIDE; y_idx++)
+            {
+                const coord_t x = static_cast<coord_t>(x_idx) * part_spacing;
+                const coord_t y = static_cast<coord_t>(y_idx) * part_spacing;
+                part_outlines.emplace_back();
+                part_outlines.back().emplace_back(x, y);
+                part_outlines.back().emplace_back(x + PART_SIZE, y);
+                part_outlines.back().emplace_back(x + PART_SIZE, y + PART_SIZE);
+                part_outlines.back().emplace_back(x, y + PART_SIZE);
+            }
+        }
+
+        txt_filename = (std::filesystem::temp_directory_path() / fmt::format("fiber_benchmark_{}_{}.txt", layer_count, points_per_layer)).string();
+        std::ofstream out(txt_filename);
+        for (const FiberPath& layer : fiber_paths.paths)
+        {
+            for (size_t polyline_idx = 0; polyline_idx < layer.paths.size(); polyline_idx++)
+            {
+                for (const Point2LL& point : layer.paths[polyline_idx])
+                {
+                    out << fmt::format("{:.3f} {:.3f} {:.3f} {}\n", INT2MM(point.X), INT2MM(point.Y), INT2MM(layer.z_), polyline_idx);
+                }
+            }
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+        std::filesystem::remove(txt_filename);
+    }
+
+    /*!
+     * Create mesh storage with the same parts on every layer.
+     */
+    std::shared_ptr<SliceMeshStorage> createMeshStorage(Mesh& mesh) const
+    {
+        auto storage = std::make_shared<SliceMeshStorage>(&mesh, layer_count);
+        for (size_t layer_nr = 0; layer_nr < layer_count; layer_nr++)
+        {
+            SliceLayer& layer = storage->layers[layer_nr];
+            layer.printZ = static_cast<coord_t>(layer_nr + 1) * LAYER_THICKNESS;
+            layer.thickness = LAYER_THICKNESS;
+            for (const Polygon& outline : part_outlines)
+            {
+                SliceLayerPart& part = layer.parts.emplace_back();
+                part.outline.push_back(outline);
+                part.boundaryBox.calculate(part.outline);
+            }
+        }
+        return storage;
+    }
+};
+
+BENCHMARK_DEFINE_F(FiberTestFixture, fiber_load_txt)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        FiberPaths loaded;
+        loadFiberPathTXT(&loaded, txt_filename.c_str(), Matrix4x3D());
+        benchmark::DoNotOptimize(loaded);
+    }
+    st.SetBytesProcessed(st.iterations() * std::filesystem::file_size(txt_filename));
+}
+
+BENCHMARK_REGISTER_F(FiberTestFixture, fiber_load_txt)->ArgsProduct({ { 100, 1000 }, { 1000, 10000 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(FiberTestFixture, fiber_insert)(benchmark::State& st)
+{
+    Mesh mesh;
+    for (auto _ : st)
+    {
+        st.PauseTiming();
+        std::shared_ptr<SliceMeshStorage> storage = createMeshStorage(mesh);
+        st.ResumeTiming();
+        insertFiberPath(*storage, fiber_paths);
+        benchmark::DoNotOptimize(storage);
+    }
+}
+
+BENCHMARK_REGISTER_F(FiberTestFixture, fiber_insert)->ArgsProduct({ { 100, 1000, 2000 }, { 1000, 10000 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(FiberTestFixture, fiber_line_cut)(benchmark::State& st)
+{
+    const OpenLinesSet& fiber_layer = fiber_paths.paths.front().paths;
+    for (auto _ : st)
+    {
+        for (const Polygon& outline : part_outlines)
+        {
+            Shape part;
+            part.push_back(outline);
+            benchmark::DoNotOptimize(fiber_layer.lineCut(part));
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(FiberTestFixture, fiber_line_cut)->ArgsProduct({ { 1 }, { 1000, 10000, 100000 } })->Unit(benchmark::kMillisecond);
+} // namespace cura
+#endif // CURAENGINE_FIBER_BENCHMARK_H
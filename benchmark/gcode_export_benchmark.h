@@ -0,0 +1,209 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_GCODE_EXPORT_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_GCODE_EXPORT_BENCHMARK_H
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "Application.h"
+#include "RetractionConfig.h"
+#include "Slice.h"
+#include "communication/CommandLine.h"
+#include "gcodeExport.h"
+
+namespace cura
+{
+
+/*!
+ * A stream buffer that drops everything written to it and only counts the bytes, so that the writing of the g-code is measured and not the medium it's written to.
+ */
+class CountingStreamBuffer : public std::streambuf
+{
+public:
+    size_t bytes = 0;
+
+protected:
+    int_type overflow(int_type character) override
+    {
+        if (! traits_type::eq_int_type(character, traits_type::eof()))
+        {
+            bytes++;
+        }
+        return traits_type::not_eof(character);
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override
+    {
+        bytes += static_cast<size_t>(count);
+        return count;
+    }
+};
+
+/*!
+ * A stream of moves like that of a sliced layer: walls of short extrusions, retracted travels between them and long infill lines, repeated for many layers.
+ *
+ * The first argument is the g-code flavor, as an index in \ref flavors. The second whether the print time is estimated on a background thread.
+ */
+class GCodeExportTestFixture : public benchmark::Fixture
+{
+public:
+    static constexpr size_t layer_count = 100;
+    static constexpr size_t moves_per_layer = 10000;
+    static constexpr coord_t layer_height = 200;
+    static constexpr std::array<const char*, 4> flavors{ "Marlin", "Griffin", "RepRap (RepRap)", "BFB" };
+
+    //! One move of the stream, which is written with the corresponding function of GCodeExport.
+    struct Move
+    {
+        enum class Type
+        {
+            EXTRUSION,
+            TRAVEL,
+            RETRACTION,
+        };
+        Type type;
+        Point2LL position;
+        Velocity speed;
+        PrintFeatureType feature;
+    };
+
+    std::vector<Move> moves; //!< The moves of a single layer.
+    RetractionConfig retraction_config;
+    CountingStreamBuffer sink_buffer;
+    std::unique_ptr<std::ostream> sink;
+    std::unique_ptr<GCodeExport> gcode;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        constexpr size_t num_mesh_groups = 1;
+        Application::getInstance().current_slice_ = new Slice(num_mesh_groups);
+        Application::getInstance().communication_ = new CommandLine({});
+        Settings& settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
+        settings.add("machine_gcode_flavor", flavors[state.range(0)]);
+        settings.add("time_estimate_background_thread", state.range(1) ? "true" : "false");
+        settings.add("machine_name", "Benchmark printer");
+        settings.add("machine_use_extruder_offset_to_offset_coords", "false");
+        settings.add("machine_always_write_active_tool", "false");
+        settings.add("machine_extruder_cooling_fan_number", "0");
+        settings.add("machine_firmware_retract", "false");
+        settings.add("machine_planner_buffer_size", "15");
+        settings.add("ppr_enable", "false");
+        settings.add("relative_extrusion", "false");
+        settings.add("layer_height", "0.2");
+        settings.add("material_diameter", "2.85");
+        settings.add("material_bed_temp_prepend", "false");
+        settings.add("material_bed_temperature_layer_0", "60");
+        settings.add("retraction_prime_speed", "25");
+        settings.add("machine_max_feedrate_x", "300");
+        settings.add("machine_max_feedrate_y", "300");
+        settings.add("machine_max_feedrate_z", "40");
+        settings.add("machine_max_feedrate_e", "45");
+        settings.add("machine_max_acceleration_x", "9000");
+        settings.add("machine_max_acceleration_y", "9000");
+        settings.add("machine_max_acceleration_z", "100");
+        settings.add("machine_max_acceleration_e", "10000");
+        settings.add("machine_max_jerk_xy", "20");
+        settings.add("machine_max_jerk_z", "0.4");
+        settings.add("machine_max_jerk_e", "5");
+        settings.add("machine_minimum_feedrate", "0");
+        settings.add("machine_acceleration", "3000");
+        Application::getInstance().current_slice_->scene.extruders.emplace_back(0, &settings);
+
+        retraction_config.distance = 6.5;
+        retraction_config.speed = 25.0;
+        retraction_config.primeSpeed = 25.0;
+        retraction_config.prime_volume = 0;
+        retraction_config.zHop = 0;
+        retraction_config.retraction_min_travel_distance = MM2INT(1.5);
+        retraction_config.retraction_extrusion_window = 1;
+        retraction_config.retraction_count_max = 100;
+
+        // Walls of short segments with a retracted travel to each next one, then infill lines from one side of the part to the other.
+        moves.clear();
+        std::mt19937 random(42);
+        std::uniform_int_distribution<coord_t> position(MM2INT(10), MM2INT(190));
+        std::uniform_int_distribution<coord_t> wiggle(-MM2INT(0.5), MM2INT(0.5));
+        while (moves.size() < moves_per_layer / 2)
+        {
+            Point2LL point(position(random), position(random));
+            moves.push_back(Move{ Move::Type::RETRACTION, point, 25.0, PrintFeatureType::MoveRetraction });
+            moves.push_back(Move{ Move::Type::TRAVEL, point, 150.0, PrintFeatureType::MoveRetraction });
+            for (size_t segment_idx = 0; segment_idx < 50; segment_idx++)
+            {
+                point += Point2LL(wiggle(random), wiggle(random));
+                moves.push_back(Move{ Move::Type::EXTRUSION, point, 30.0, PrintFeatureType::OuterWall });
+            }
+        }
+        for (coord_t y = MM2INT(10); moves.size() < moves_per_layer; y += MM2INT(0.4))
+        {
+            const bool forward = (y / MM2INT(0.4)) % 2 == 0;
+            moves.push_back(Move{ Move::Type::TRAVEL, Point2LL(forward ? MM2INT(10) : MM2INT(190), y), 150.0, PrintFeatureType::MoveCombing });
+            moves.push_back(Move{ Move::Type::EXTRUSION, Point2LL(forward ? MM2INT(190) : MM2INT(10), y), 80.0, PrintFeatureType::Infill });
+        }
+
+        sink_buffer.bytes = 0;
+        sink = std::make_unique<std::ostream>(&sink_buffer);
+        gcode = std::make_unique<GCodeExport>();
+        gcode->setOutputStream(sink.get());
+        gcode->preSetup(0);
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+        gcode.reset();
+        sink.reset();
+        delete Application::getInstance().communication_;
+        Application::getInstance().communication_ = nullptr;
+        delete Application::getInstance().current_slice_;
+        Application::getInstance().current_slice_ = nullptr;
+    }
+};
+
+BENCHMARK_DEFINE_F(GCodeExportTestFixture, GCodeExport_writeMoves)(benchmark::State& st)
+{
+    constexpr double extrusion_mm3_per_mm = 0.4 * 0.2;
+    LayerIndex layer_nr = 0;
+    for (auto _ : st)
+    {
+        for (size_t layer_idx = 0; layer_idx < layer_count; layer_idx++, layer_nr++)
+        {
+            gcode->setLayerNr(layer_nr);
+            gcode->setZ(static_cast<int>((layer_nr + 1) * layer_height));
+            for (const Move& move : moves)
+            {
+                switch (move.type)
+                {
+                case Move::Type::EXTRUSION:
+                    gcode->writeExtrusion(move.position, move.speed, extrusion_mm3_per_mm, move.feature);
+                    break;
+                case Move::Type::TRAVEL:
+                    gcode->writeTravel(move.position, move.speed);
+                    break;
+                case Move::Type::RETRACTION:
+                    gcode->writeRetraction(retraction_config);
+                    break;
+                }
+            }
+            gcode->updateTotalPrintTime();
+        }
+    }
+    // Layers that are still waiting for their estimate on the background thread aren't counted, but those are only a few out of many.
+    st.SetItemsProcessed(st.iterations() * layer_count * moves.size());
+    st.SetBytesProcessed(static_cast<int64_t>(sink_buffer.bytes));
+}
+
+BENCHMARK_REGISTER_F(GCodeExportTestFixture, GCodeExport_writeMoves)
+    ->ArgsProduct({ { 0, 1, 2, 3 }, { 0, 1 } })
+    ->ArgNames({ "flavor", "background_estimate" })
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_GCODE_EXPORT_BENCHMARK_H
@@ -0,0 +1,241 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_GEOMETRY_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_GEOMETRY_BENCHMARK_H
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/geometry/geometries/multi_polygon.hpp>
+#include <boost/geometry/geometries/point_xy.hpp>
+#include <boost/geometry/geometries/polygon.hpp>
+#include <boost/geometry/io/wkt/read.hpp>
+
+#include "geometry/OpenLinesSet.h"
+#include "geometry/OpenPolyline.h"
+#include "geometry/Polygon.h"
+#include "geometry/Shape.h"
+#include "utils/AABB.h"
+
+namespace cura
+{
+
+/*!
+ * The shapes that the geometry benchmarks run on: the holes of the wall benchmark, followed by the outlines of the stress benchmark, which range from a few to many
+ * thousands of vertices and from a single polygon to many parts with holes.
+ */
+inline const std::vector<std::filesystem::path>& geometryBenchmarkInputs()
+{
+    static const std::vector<std::filesystem::path> inputs = []()
+    {
+        const std::filesystem::path benchmark_path = std::filesystem::path(__FILE__).parent_path();
+        std::vector<std::filesystem::path> result{ benchmark_path / "holes.wkt" };
+        std::vector<std::filesystem::path> stress_inputs;
+        const std::filesystem::path stress_path = benchmark_path.parent_path() / "stress_benchmark" / "resources";
+        if (std::filesystem::exists(stress_path))
+        {
+            for (const auto& entry : std::filesystem::directory_iterator(stress_path))
+            {
+                if (entry.path().extension() == ".wkt")
+                {
+                    stress_inputs.push_back(entry.path());
+                }
+            }
+        }
+        std::sort(stress_inputs.begin(), stress_inputs.end());
+        result.insert(result.end(), stress_inputs.begin(), stress_inputs.end());
+        return result;
+    }();
+    return inputs;
+}
+
+//! Run a geometry benchmark once for every input.
+inline void geometryBenchmarkArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgName("input");
+    for (size_t input_idx = 0; input_idx < geometryBenchmarkInputs().size(); input_idx++)
+    {
+        benchmark->Arg(static_cast<int64_t>(input_idx));
+    }
+}
+
+class GeometryTestFixture : public benchmark::Fixture
+{
+public:
+    Shape shape;
+    Shape shifted_shape; //!< The same shape, moved over part of its size, to overlap with it in the boolean operations.
+    OpenLinesSet lines; //!< Lines across the whole shape, like infill lines.
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        using point_type = boost::geometry::model::d2::point_xy<double>;
+        using polygon_type = boost::geometry::model::polygon<point_type>;
+        using multi_polygon_type = boost::geometry::model::multi_polygon<polygon_type>;
+
+        std::ifstream file{ geometryBenchmarkInputs()[state.range(0)] };
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        const std::string wkt = buffer.str();
+
+        multi_polygon_type boost_polygons{};
+        if (wkt.starts_with("MULTIPOLYGON"))
+        {
+            boost::geometry::read_wkt(wkt, boost_polygons);
+        }
+        else
+        {
+            boost_polygons.emplace_back();
+            boost::geometry::read_wkt(wkt, boost_polygons.back());
+        }
+
+        shape.clear();
+        for (const auto& boost_polygon : boost_polygons)
+        {
+            Polygon& outer = shape.newLine();
+            for (const auto& point : boost_polygon.outer())
+            {
+                outer.emplace_back(point.x(), point.y());
+            }
+            for (const auto& hole : boost_polygon.inners())
+            {
+                Polygon& inner = shape.newLine();
+                for (const auto& point : hole)
+                {
+                    inner.emplace_back(point.x(), point.y());
+                }
+            }
+        }
+
+        const AABB bounding_box(shape);
+        const Point2LL size = bounding_box.max_ - bounding_box.min_;
+        shifted_shape = shape;
+        shifted_shape.translate(Point2LL(size.X / 7, size.Y / 11));
+
+        lines.clear();
+        constexpr coord_t line_distance = MM2INT(0.4);
+        for (coord_t y = bounding_box.min_.Y + line_distance / 2; y < bounding_box.max_.Y; y += line_distance)
+        {
+            lines.push_back(OpenPolyline({ Point2LL(bounding_box.min_.X - line_distance, y), Point2LL(bounding_box.max_.X + line_distance, y) }));
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+    }
+
+    //! Report the size of the input, to compare the inputs by complexity.
+    void setCounters(benchmark::State& state) const
+    {
+        state.counters["points"] = static_cast<double>(shape.pointCount());
+        state.counters["polygons"] = static_cast<double>(shape.size());
+    }
+};
+
+BENCHMARK_DEFINE_F(GeometryTestFixture, offset)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        benchmark::DoNotOptimize(shape.offset(MM2INT(0.4)));
+    }
+    setCounters(st);
+}
+
+BENCHMARK_REGISTER_F(GeometryTestFixture, offset)->Apply(geometryBenchmarkArguments)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_DEFINE_F(GeometryTestFixture, inset)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        benchmark::DoNotOptimize(shape.offset(-MM2INT(0.4)));
+    }
+    setCounters(st);
+}
+
+BENCHMARK_REGISTER_F(GeometryTestFixture, inset)->Apply(geometryBenchmarkArguments)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_DEFINE_F(GeometryTestFixture, union_self)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        benchmark::DoNotOptimize(shape.unionPolygons());
+    }
+    setCounters(st);
+}
+
+BENCHMARK_REGISTER_F(GeometryTestFixture, union_self)->Apply(geometryBenchmarkArguments)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_DEFINE_F(GeometryTestFixture, union_shifted)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        benchmark::DoNotOptimize(shape.unionPolygons(shifted_shape));
+    }
+    setCounters(st);
+}
+
+BENCHMARK_REGISTER_F(GeometryTestFixture, union_shifted)->Apply(geometryBenchmarkArguments)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_DEFINE_F(GeometryTestFixture, difference)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        benchmark::DoNotOptimize(shape.difference(shifted_shape));
+    }
+    setCounters(st);
+}
+
+BENCHMARK_REGISTER_F(GeometryTestFixture, difference)->Apply(geometryBenchmarkArguments)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_DEFINE_F(GeometryTestFixture, intersection)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        benchmark::DoNotOptimize(shape.intersection(shifted_shape));
+    }
+    setCounters(st);
+}
+
+BENCHMARK_REGISTER_F(GeometryTestFixture, intersection)->Apply(geometryBenchmarkArguments)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_DEFINE_F(GeometryTestFixture, line_cut)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        benchmark::DoNotOptimize(lines.lineCut(shape));
+    }
+    setCounters(st);
+}
+
+BENCHMARK_REGISTER_F(GeometryTestFixture, line_cut)->Apply(geometryBenchmarkArguments)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_DEFINE_F(GeometryTestFixture, intersection_lines)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        benchmark::DoNotOptimize(shape.intersection(lines, false));
+    }
+    setCounters(st);
+}
+
+BENCHMARK_REGISTER_F(GeometryTestFixture, intersection_lines)->Apply(geometryBenchmarkArguments)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_DEFINE_F(GeometryTestFixture, intersection_lines_restitch)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        benchmark::DoNotOptimize(shape.intersection(lines, true));
+    }
+    setCounters(st);
+}
+
+BENCHMARK_REGISTER_F(GeometryTestFixture, intersection_lines_restitch)->Apply(geometryBenchmarkArguments)->Unit(benchmark::kMicrosecond);
+
+} // namespace cura
+
+#endif // CURAENGINE_BENCHMARK_GEOMETRY_BENCHMARK_H
@@ -1,7 +1,12 @@
 
 // Copyright (c) 2023 UltiMaker
 // CuraEngine is released under the terms of the AGPLv3 or higher
+#include "fiber_benchmark.h"
+#include "gcode_export_benchmark.h"
+#include "geometry_benchmark.h"
 #include "infill_benchmark.h"
+#include "path_order_benchmark.h"
+#include "slicer_benchmark.h"
 #include "wall_benchmark.h"
 #include "simplify_benchmark.h"
 #include <benchmark/benchmark.h>
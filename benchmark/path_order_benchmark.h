@@ -0,0 +1,261 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_PATH_ORDER_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_PATH_ORDER_BENCHMARK_H
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Application.h"
+#include "PathOrderMonotonic.h"
+#include "PathOrderOptimizer.h"
+#include "Slice.h"
+#include "geometry/OpenLinesSet.h"
+#include "geometry/OpenPolyline.h"
+#include "geometry/Polygon.h"
+#include "geometry/Shape.h"
+#include "pathPlanning/Comb.h"
+#include "pathPlanning/CombPaths.h"
+#include "perf_counters.h"
+#include "sliceDataStorage.h"
+
+namespace cura
+{
+
+/*!
+ * Inputs for the path order optimizers and combing that look like those of a real layer: a large part with many small holes in it, the infill lines across it, lines scattered
+ * all over it and the combing boundary inside its walls.
+ *
+ * The first argument is the number of holes, the second whether the optimizers avoid travels that leave the combing boundary.
+ */
+class PathOrderTestFixture : public benchmark::Fixture
+{
+public:
+    static constexpr coord_t part_size = MM2INT(200);
+    static constexpr size_t scattered_line_count = 5000;
+
+    Shape part;
+    Shape combing_boundary;
+    OpenLinesSet infill_lines;
+    OpenLinesSet scattered_lines;
+    bool use_combing_boundary;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        std::mt19937 random(42); // Always the same inputs, to compare runs.
+
+        part.clear();
+        part.push_back(Polygon({ Point2LL(0, 0), Point2LL(part_size, 0), Point2LL(part_size, part_size), Point2LL(0, part_size) }, false));
+        const size_t holes_per_row = std::max(static_cast<size_t>(std::ceil(std::sqrt(state.range(0)))), size_t(1));
+        const coord_t hole_pitch = part_size / (holes_per_row + 1);
+        std::uniform_int_distribution<coord_t> hole_size(hole_pitch / 8, hole_pitch / 3);
+        for (int64_t hole_idx = 0; hole_idx < state.range(0); hole_idx++)
+        {
+            const Point2LL center((hole_idx % holes_per_row + 1) * hole_pitch, (hole_idx / holes_per_row + 1) * hole_pitch);
+            const coord_t half_size = hole_size(random);
+            // Clockwise, since it's a hole.
+            part.push_back(Polygon(
+                { center + Point2LL(-half_size, -half_size), center + Point2LL(-half_size, half_size), center + Point2LL(half_size, half_size), center + Point2LL(half_size, -half_size) },
+                false));
+        }
+        combing_boundary = part.offset(-MM2INT(0.8));
+        use_combing_boundary = state.range(1) != 0;
+
+        OpenLinesSet infill_grid;
+        constexpr coord_t line_distance = MM2INT(2);
+        for (coord_t y = line_distance / 2; y < part_size; y += line_distance)
+        {
+            infill_grid.push_back(OpenPolyline({ Point2LL(-line_distance, y), Point2LL(part_size + line_distance, y) }));
+        }
+        infill_lines = infill_grid.lineCut(combing_boundary);
+
+        scattered_lines.clear();
+        std::uniform_int_distribution<coord_t> position(0, part_size);
+        std::uniform_int_distribution<coord_t> offset(-MM2INT(10), MM2INT(10));
+        for (size_t line_idx = 0; line_idx < scattered_line_count; line_idx++)
+        {
+            const Point2LL start(position(random), position(random));
+            scattered_lines.push_back(OpenPolyline({ start, start + Point2LL(offset(random), offset(random)) }));
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+    }
+
+    [[nodiscard]] const Shape* boundary() const
+    {
+        return use_combing_boundary ? &combing_boundary : nullptr;
+    }
+};
+
+BENCHMARK_DEFINE_F(PathOrderTestFixture, PathOrderOptimizer_scatteredLines)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        PathOrderOptimizer<const OpenPolyline*> optimizer(Point2LL(0, 0), ZSeamConfig(), false, boundary());
+        for (const OpenPolyline& line : scattered_lines)
+        {
+            optimizer.addPolyline(&line);
+        }
+        optimizer.optimize();
+        benchmark::DoNotOptimize(optimizer.paths_);
+    }
+}
+
+BENCHMARK_REGISTER_F(PathOrderTestFixture, PathOrderOptimizer_scatteredLines)->ArgsProduct({ { 100, 400 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(PathOrderTestFixture, PathOrderOptimizer_infillLines)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        PathOrderOptimizer<const OpenPolyline*> optimizer(Point2LL(0, 0), ZSeamConfig(), false, boundary());
+        for (const OpenPolyline& line : infill_lines)
+        {
+            optimizer.addPolyline(&line);
+        }
+        optimizer.optimize();
+        benchmark::DoNotOptimize(optimizer.paths_);
+    }
+    st.counters["lines"] = static_cast<double>(infill_lines.size());
+}
+
+BENCHMARK_REGISTER_F(PathOrderTestFixture, PathOrderOptimizer_infillLines)->ArgsProduct({ { 100, 400 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(PathOrderTestFixture, PathOrderOptimizer_holes)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        PathOrderOptimizer<const Polygon*> optimizer(Point2LL(0, 0), ZSeamConfig(), false, boundary());
+        for (const Polygon& polygon : part)
+        {
+            optimizer.addPolygon(&polygon);
+        }
+        optimizer.optimize();
+        benchmark::DoNotOptimize(optimizer.paths_);
+    }
+}
+
+BENCHMARK_REGISTER_F(PathOrderTestFixture, PathOrderOptimizer_holes)->ArgsProduct({ { 100, 400 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(PathOrderTestFixture, PathOrderMonotonic_infillLines)(benchmark::State& st)
+{
+    constexpr coord_t max_adjacent_distance = MM2INT(2.2);
+    for (auto _ : st)
+    {
+        PathOrderMonotonic<const OpenPolyline*> optimizer(AngleRadians(0), max_adjacent_distance, Point2LL(0, 0));
+        for (const OpenPolyline& line : infill_lines)
+        {
+            optimizer.addPolyline(&line);
+        }
+        optimizer.optimize();
+        benchmark::DoNotOptimize(optimizer.paths_);
+    }
+    st.counters["lines"] = static_cast<double>(infill_lines.size());
+}
+
+// The monotonic order doesn't use a combing boundary.
+BENCHMARK_REGISTER_F(PathOrderTestFixture, PathOrderMonotonic_infillLines)->ArgsProduct({ { 100, 400 }, { 0 } })->Unit(benchmark::kMillisecond);
+
+/*!
+ * Combing travels between random points in the part with holes. All travels stay inside the part, so that no model outlines are needed to travel around it.
+ */
+class CombTestFixture : public PathOrderTestFixture
+{
+public:
+    static constexpr size_t travel_count = 200;
+
+    std::unique_ptr<SliceDataStorage> storage;
+    std::unique_ptr<Comb> comb;
+    std::vector<std::pair<Point2LL, Point2LL>> travels;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        PathOrderTestFixture::SetUp(state);
+
+        constexpr size_t num_mesh_groups = 1;
+        Application::getInstance().current_slice_ = new Slice(num_mesh_groups);
+        Settings& settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
+        settings.add("machine_width", "250");
+        settings.add("machine_depth", "250");
+        settings.add("machine_height", "250");
+        settings.add("machine_center_is_zero", "false");
+        settings.add("travel_avoid_other_parts", "true");
+        settings.add("travel_avoid_supports", "false");
+        Application::getInstance().current_slice_->scene.extruders.emplace_back(0, &settings);
+        storage = std::make_unique<SliceDataStorage>();
+
+        constexpr coord_t comb_boundary_offset = 20;
+        constexpr coord_t travel_avoid_distance = MM2INT(0.625);
+        constexpr coord_t move_inside_distance = 10;
+        comb = std::make_unique<Comb>(*storage, LayerIndex(100), combing_boundary, combing_boundary, comb_boundary_offset, travel_avoid_distance, move_inside_distance);
+
+        std::mt19937 random(42);
+        std::uniform_int_distribution<coord_t> position(0, part_size);
+        const auto random_inside = [&]()
+        {
+            Point2LL point;
+            do
+            {
+                point = Point2LL(position(random), position(random));
+            } while (! combing_boundary.inside(point));
+            return point;
+        };
+        travels.clear();
+        for (size_t travel_idx = 0; travel_idx < travel_count; travel_idx++)
+        {
+            travels.emplace_back(random_inside(), random_inside());
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+        comb.reset();
+        storage.reset();
+        delete Application::getInstance().current_slice_;
+        Application::getInstance().current_slice_ = nullptr;
+    }
+};
+
+BENCHMARK_DEFINE_F(CombTestFixture, Comb_calc)(benchmark::State& st)
+{
+    const ExtruderTrain& train = Application::getInstance().current_slice_->scene.extruders.front();
+    constexpr bool perform_z_hops = false;
+    constexpr bool perform_z_hops_only_when_collides = false;
+    constexpr bool start_inside = true;
+    constexpr bool end_inside = true;
+    constexpr coord_t max_comb_distance_ignored = MM2INT(1.6);
+    PerfCounters perf_counters;
+    for (auto _ : st)
+    {
+        for (const auto& [start, end] : travels)
+        {
+            CombPaths comb_paths;
+            bool unretract_before_last_travel_move = false;
+            benchmark::DoNotOptimize(comb->calc(
+                perform_z_hops,
+                perform_z_hops_only_when_collides,
+                train,
+                start,
+                end,
+                comb_paths,
+                start_inside,
+                end_inside,
+                max_comb_distance_ignored,
+                unretract_before_last_travel_move));
+        }
+    }
+    perf_counters.report(st);
+}
+
+BENCHMARK_REGISTER_F(CombTestFixture, Comb_calc)->ArgsProduct({ { 100, 400 }, { 1 } })->Unit(benchmark::kMillisecond);
+
+} // namespace cura
+
+#endif // CURAENGINE_BENCHMARK_PATH_ORDER_BENCHMARK_H
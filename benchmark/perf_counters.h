@@ -0,0 +1,151 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_PERF_COUNTERS_H
+#define CURAENGINE_BENCHMARK_PERF_COUNTERS_H
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+namespace cura
+{
+
+/*!
+ * Counts the CPU cycles, instructions, cache misses and branch misses of a benchmark with the hardware performance counters, and adds them to its
+ * output as counters per iteration, with the instructions per cycle.
+ *
+ * The counters are only read on Linux, through perf_event_open, and only when the environment variable CURAENGINE_PERF_COUNTERS is set to
+ * something other than 0. The kernel needs to allow that to the user, see /proc/sys/kernel/perf_event_paranoid. Without the counters, the
+ * benchmarks run as usual.
+ *
+ * Only the thread that runs the benchmark is counted, and everything from constructing this to calling \ref report is counted, including what is
+ * done while the timing is paused. Use it like this:
+ *
+ *     PerfCounters perf_counters;
+ *     for (auto _ : st) { ... }
+ *     perf_counters.report(st);
+ */
+class PerfCounters
+{
+public:
+    PerfCounters()
+    {
+#ifdef __linux__
+        if (! requested())
+        {
+            return;
+        }
+        constexpr std::array<uint64_t, event_count> events{ PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+        for (size_t event_idx = 0; event_idx < event_count; event_idx++)
+        {
+            perf_event_attr attributes{};
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.size = sizeof(perf_event_attr);
+            attributes.config = events[event_idx];
+            attributes.disabled = event_idx == 0; // The others start with the leader of the group.
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const int group = event_idx == 0 ? -1 : file_descriptors_[0];
+            file_descriptors_[event_idx] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group, 0));
+            if (file_descriptors_[event_idx] == -1)
+            {
+                static bool warned = false;
+                if (! warned)
+                {
+                    spdlog::warn("Couldn't open the hardware performance counters, so they aren't reported. Check perf_event_paranoid.");
+                    warned = true;
+                }
+                close();
+                return;
+            }
+        }
+        ioctl(file_descriptors_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(file_descriptors_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters()
+    {
+        close();
+    }
+
+    //! Stop counting and add the counts to the output of the benchmark, if they could be read.
+    void report(benchmark::State& state)
+    {
+#ifdef __linux__
+        if (file_descriptors_[0] == -1)
+        {
+            return;
+        }
+        ioctl(file_descriptors_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        struct
+        {
+            uint64_t event_count;
+            uint64_t time_enabled;
+            uint64_t time_running;
+            std::array<uint64_t, PerfCounters::event_count> values;
+        } counts{};
+        const bool complete = read(file_descriptors_[0], &counts, sizeof(counts)) == static_cast<ssize_t>(sizeof(counts));
+        close();
+        if (! complete || counts.time_running == 0)
+        {
+            return;
+        }
+        // When more counters are in use than the CPU has, they take turns and only count part of the time.
+        const double scale = static_cast<double>(counts.time_enabled) / static_cast<double>(counts.time_running);
+        const auto count = [&counts, scale](const size_t event_idx)
+        {
+            return static_cast<double>(counts.values[event_idx]) * scale;
+        };
+        state.counters["cycles"] = benchmark::Counter(count(0), benchmark::Counter::kAvgIterations);
+        state.counters["instructions"] = benchmark::Counter(count(1), benchmark::Counter::kAvgIterations);
+        state.counters["cache_misses"] = benchmark::Counter(count(2), benchmark::Counter::kAvgIterations);
+        state.counters["branch_misses"] = benchmark::Counter(count(3), benchmark::Counter::kAvgIterations);
+        state.counters["IPC"] = count(0) > 0 ? count(1) / count(0) : 0.0;
+#endif
+    }
+
+private:
+    static constexpr size_t event_count = 4;
+
+    std::array<int, event_count> file_descriptors_{ -1, -1, -1, -1 }; //!< The first is the leader of the group of counters.
+
+    static bool requested()
+    {
+        const char* setting = std::getenv("CURAENGINE_PERF_COUNTERS");
+        return setting != nullptr && *setting != '\0' && std::string_view(setting) != "0";
+    }
+
+    void close()
+    {
+#ifdef __linux__
+        for (int& file_descriptor : file_descriptors_)
+        {
+            if (file_descriptor != -1)
+            {
+                ::close(file_descriptor);
+                file_descriptor = -1;
+            }
+        }
+#endif
+    }
+};
+
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_PERF_COUNTERS_H
@@ -0,0 +1,442 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_SLICER_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_SLICER_BENCHMARK_H
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <numbers>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "Application.h"
+#include "MeshGroup.h"
+#include "Slice.h"
+#include "layerPart.h"
+#include "mesh.h"
+#include "settings/EnumSettings.h"
+#include "sliceDataStorage.h"
+#include "slicer.h"
+#include "utils/Matrix4x3D.h"
+
+namespace cura
+{
+
+/*!
+ * The slicing of a mesh, step by step, from loading the STL file to the layer parts.
+ *
+ * The first argument is the mesh: 0 for tests/testModel.stl, 1 for a sphere of subdivided icosahedron faces and 2 for a slab with the height field of a gyroid function
+ * on top. The second argument is the layer height in micron.
+ */
+class SlicerTestFixture : public benchmark::Fixture
+{
+public:
+    static constexpr size_t sphere_subdivisions = 6; //!< 81920 faces.
+    static constexpr size_t slab_resolution = 160; //!< Height field cells per side, for about 100000 faces.
+
+    using Vertex = std::array<double, 3>; //!< A corner of a face, in millimeters like in STL files.
+
+    std::vector<Vertex> corners; //!< Three corners per face.
+    std::string binary_filename;
+    std::string ascii_filename;
+    Mesh* mesh = nullptr; //!< The mesh loaded from \ref binary_filename, in the mesh group of the slice.
+    std::vector<Point3LL> mesh_corners; //!< The corners of the loaded mesh, to add the faces to a new mesh with.
+    coord_t layer_thickness;
+    size_t layer_count;
+    SlicingTolerance slicing_tolerance;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        Application::getInstance().startThreadPool();
+
+        constexpr size_t num_mesh_groups = 1;
+        Application::getInstance().current_slice_ = new Slice(num_mesh_groups);
+        Scene& scene = Application::getInstance().current_slice_->scene;
+        layer_thickness = static_cast<coord_t>(state.range(1));
+        scene.settings.add("layer_height", fmt::format("{}", INT2MM(layer_thickness)));
+        scene.settings.add("layer_height_0", fmt::format("{}", INT2MM(layer_thickness)));
+        scene.settings.add("slicing_tolerance", "middle");
+        scene.settings.add("layer_0_z_overlap", "0.0");
+        scene.settings.add("raft_airgap", "0.0");
+        scene.settings.add("raft_base_thickness", "0.2");
+        scene.settings.add("raft_interface_thickness", "0.2");
+        scene.settings.add("raft_interface_layers", "1");
+        scene.settings.add("raft_surface_thickness", "0.2");
+        scene.settings.add("raft_surface_layers", "1");
+        scene.settings.add("raft_surface_extruder_nr", "0");
+        scene.settings.add("adhesion_type", "none");
+        scene.settings.add("magic_mesh_surface_mode", "normal");
+        scene.settings.add("meshfix_extensive_stitching", "false");
+        scene.settings.add("meshfix_keep_open_polygons", "false");
+        scene.settings.add("meshfix_union_all", "true");
+        scene.settings.add("meshfix_union_all_remove_holes", "false");
+        scene.settings.add("minimum_polygon_circumference", "1");
+        scene.settings.add("meshfix_maximum_resolution", "0.04");
+        scene.settings.add("meshfix_maximum_deviation", "0.02");
+        scene.settings.add("meshfix_maximum_extrusion_area_deviation", "2000");
+        scene.settings.add("wall_line_width_0", "0.4");
+        scene.settings.add("wall_transition_angle", "10");
+        scene.settings.add("xy_offset", "0");
+        scene.settings.add("xy_offset_layer_0", "0");
+        scene.settings.add("hole_xy_offset", "0");
+        scene.settings.add("hole_xy_offset_max_diameter", "0");
+        scene.settings.add("support_mesh", "false");
+        scene.settings.add("anti_overhang_mesh", "false");
+        scene.settings.add("cutting_mesh", "false");
+        scene.settings.add("infill_mesh", "false");
+        slicing_tolerance = scene.settings.get<SlicingTolerance>("slicing_tolerance");
+
+        corners.clear();
+        switch (state.range(0))
+        {
+        case 0:
+            loadCorners((std::filesystem::path(__FILE__).parent_path().parent_path() / "tests" / "testModel.stl").string());
+            break;
+        case 1:
+            makeSphere();
+            break;
+        default:
+            makeGyroidSlab();
+            break;
+        }
+
+        const std::string basename = fmt::format("slicer_benchmark_{}", state.range(0));
+        binary_filename = (std::filesystem::temp_directory_path() / (basename + ".stl")).string();
+        ascii_filename = (std::filesystem::temp_directory_path() / (basename + "_ascii.stl")).string();
+        writeBinary(binary_filename);
+        writeAscii(ascii_filename);
+
+        MeshGroup& mesh_group = scene.mesh_groups.back();
+        loadMeshIntoMeshGroup(&mesh_group, binary_filename.c_str(), Matrix4x3D(), scene.settings);
+        mesh = &mesh_group.meshes.back();
+        mesh_corners.clear();
+        for (const MeshFace& face : mesh->faces_)
+        {
+            for (const int vertex_idx : face.vertex_index_)
+            {
+                mesh_corners.push_back(mesh->vertices_[vertex_idx].p_);
+            }
+        }
+        layer_count = static_cast<size_t>(std::max<coord_t>(1, mesh->max().z_ / layer_thickness));
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+        std::filesystem::remove(binary_filename);
+        std::filesystem::remove(ascii_filename);
+        delete Application::getInstance().current_slice_;
+        Application::getInstance().current_slice_ = nullptr;
+    }
+
+    /*!
+     * The layers to slice the mesh at, without any segments or polygons yet.
+     */
+    std::vector<SlicerLayer> emptyLayers() const
+    {
+        constexpr bool use_variable_layer_heights = false;
+        return Slicer::buildLayersWithHeight(layer_count, slicing_tolerance, layer_thickness, layer_thickness, use_variable_layer_heights, nullptr);
+    }
+
+    /*!
+     * The layers to slice the mesh at, with the segments of the mesh in them.
+     */
+    std::vector<SlicerLayer> layersWithSegments() const
+    {
+        std::vector<SlicerLayer> layers = emptyLayers();
+        Slicer::buildSegments(*mesh, Slicer::buildZHeightsForFaces(*mesh), slicing_tolerance, layers);
+        return layers;
+    }
+
+private:
+    /*!
+     * Add a face with its corners in the order that makes its normal point to the same side as \p outward.
+     */
+    void addFace(const Vertex& a, Vertex b, Vertex c, const Vertex& outward)
+    {
+        const Vertex ab{ b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        const Vertex ac{ c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        const Vertex normal{ ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+        if (normal[0] * outward[0] + normal[1] * outward[1] + normal[2] * outward[2] < 0)
+        {
+            std::swap(b, c);
+        }
+        corners.push_back(a);
+        corners.push_back(b);
+        corners.push_back(c);
+    }
+
+    void loadCorners(const std::string& filename)
+    {
+        MeshGroup mesh_group;
+        Settings settings;
+        loadMeshIntoMeshGroup(&mesh_group, filename.c_str(), Matrix4x3D(), settings);
+        for (const Mesh& loaded : mesh_group.meshes)
+        {
+            for (const MeshFace& face : loaded.faces_)
+            {
+                for (const int vertex_idx : face.vertex_index_)
+                {
+                    const Point3LL& p = loaded.vertices_[vertex_idx].p_;
+                    corners.push_back(Vertex{ INT2MM(p.x_), INT2MM(p.y_), INT2MM(p.z_) });
+                }
+            }
+        }
+    }
+
+    /*!
+     * A sphere with a radius of 40mm, standing on the build plate.
+     */
+    void makeSphere()
+    {
+        constexpr double radius = 40.0;
+        const Vertex center{ 50.0, 50.0, radius };
+        const double t = std::numbers::phi;
+        std::vector<Vertex> vertices{ { -1, t, 0 }, { 1, t, 0 },  { -1, -t, 0 }, { 1, -t, 0 }, { 0, -1, t },  { 0, 1, t },
+                                      { 0, -1, -t }, { 0, 1, -t }, { t, 0, -1 },  { t, 0, 1 },  { -t, 0, -1 }, { -t, 0, 1 } };
+        std::vector<std::array<size_t, 3>> faces{ { 0, 11, 5 }, { 0, 5, 1 },  { 0, 1, 7 },   { 0, 7, 10 }, { 0, 10, 11 }, { 1, 5, 9 }, { 5, 11, 4 },
+                                                  { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },   { 3, 9, 4 },  { 3, 4, 2 },   { 3, 2, 6 }, { 3, 6, 8 },
+                                                  { 3, 8, 9 },   { 4, 9, 5 },  { 2, 4, 11 },  { 6, 2, 10 }, { 8, 6, 7 },   { 9, 8, 1 } };
+        const auto normalize = [](const Vertex& v)
+        {
+            const double length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+            return Vertex{ v[0] / length, v[1] / length, v[2] / length };
+        };
+        for (Vertex& vertex : vertices)
+        {
+            vertex = normalize(vertex);
+        }
+        for (size_t subdivision = 0; subdivision < sphere_subdivisions; subdivision++)
+        {
+            std::map<std::pair<size_t, size_t>, size_t> midpoints;
+            const auto midpoint = [&](const size_t a, const size_t b)
+            {
+                const auto [found, inserted] = midpoints.emplace(std::minmax(a, b), vertices.size());
+                if (inserted)
+                {
+                    vertices.push_back(normalize(Vertex{ vertices[a][0] + vertices[b][0], vertices[a][1] + vertices[b][1], vertices[a][2] + vertices[b][2] }));
+                }
+                return found->second;
+            };
+            std::vector<std::array<size_t, 3>> subdivided;
+            subdivided.reserve(faces.size() * 4);
+            for (const auto& [a, b, c] : faces)
+            {
+                const size_t ab = midpoint(a, b);
+                const size_t bc = midpoint(b, c);
+                const size_t ca = midpoint(c, a);
+                subdivided.push_back({ a, ab, ca });
+                subdivided.push_back({ b, bc, ab });
+                subdivided.push_back({ c, ca, bc });
+                subdivided.push_back({ ab, bc, ca });
+            }
+            faces = std::move(subdivided);
+        }
+        const auto place = [&](const Vertex& v)
+        {
+            return Vertex{ center[0] + v[0] * radius, center[1] + v[1] * radius, center[2] + v[2] * radius };
+        };
+        for (const auto& [a, b, c] : faces)
+        {
+            const Vertex& outward = vertices[a];
+            addFace(place(vertices[a]), place(vertices[b]), place(vertices[c]), outward);
+        }
+    }
+
+    /*!
+     * A block of 100x100mm with its top surface following the gyroid function, so that every layer through the top has many islands and holes.
+     */
+    void makeGyroidSlab()
+    {
+        constexpr double size = 100.0;
+        constexpr double base_height = 20.0;
+        constexpr double amplitude = 6.0;
+        constexpr double period = 25.0;
+        const auto height = [&](const size_t x_idx, const size_t y_idx)
+        {
+            const double x = static_cast<double>(x_idx) / slab_resolution * size * 2 * std::numbers::pi / period;
+            const double y = static_cast<double>(y_idx) / slab_resolution * size * 2 * std::numbers::pi / period;
+            const double z = (x + y) / 2;
+            return base_height + amplitude * (std::sin(x) * std::cos(y) + std::sin(y) * std::cos(z) + std::sin(z) * std::cos(x)) / 1.5;
+        };
+        const auto top = [&](const size_t x_idx, const size_t y_idx)
+        {
+            return Vertex{ static_cast<double>(x_idx) / slab_resolution * size, static_cast<double>(y_idx) / slab_resolution * size, height(x_idx, y_idx) };
+        };
+        const auto bottom = [&](const size_t x_idx, const size_t y_idx)
+        {
+            return Vertex{ static_cast<double>(x_idx) / slab_resolution * size, static_cast<double>(y_idx) / slab_resolution * size, 0.0 };
+        };
+        for (size_t x_idx = 0; x_idx < slab_resolution; x_idx++)
+        {
+            for (size_t y_idx = 0; y_idx < slab_resolution; y_idx++)
+            {
+                addFace(top(x_idx, y_idx), top(x_idx + 1, y_idx), top(x_idx + 1, y_idx + 1), Vertex{ 0, 0, 1 });
+                addFace(top(x_idx, y_idx), top(x_idx + 1, y_idx + 1), top(x_idx, y_idx + 1), Vertex{ 0, 0, 1 });
+                addFace(bottom(x_idx, y_idx), bottom(x_idx + 1, y_idx), bottom(x_idx + 1, y_idx + 1), Vertex{ 0, 0, -1 });
+                addFace(bottom(x_idx, y_idx), bottom(x_idx + 1, y_idx + 1), bottom(x_idx, y_idx + 1), Vertex{ 0, 0, -1 });
+            }
+        }
+        for (size_t idx = 0; idx < slab_resolution; idx++)
+        {
+            constexpr size_t last = slab_resolution;
+            addFace(bottom(idx, 0), bottom(idx + 1, 0), top(idx + 1, 0), Vertex{ 0, -1, 0 });
+            addFace(bottom(idx, 0), top(idx + 1, 0), top(idx, 0), Vertex{ 0, -1, 0 });
+            addFace(bottom(idx, last), bottom(idx + 1, last), top(idx + 1, last), Vertex{ 0, 1, 0 });
+            addFace(bottom(idx, last), top(idx + 1, last), top(idx, last), Vertex{ 0, 1, 0 });
+            addFace(bottom(0, idx), bottom(0, idx + 1), top(0, idx + 1), Vertex{ -1, 0, 0 });
+            addFace(bottom(0, idx), top(0, idx + 1), top(0, idx), Vertex{ -1, 0, 0 });
+            addFace(bottom(last, idx), bottom(last, idx + 1), top(last, idx + 1), Vertex{ 1, 0, 0 });
+            addFace(bottom(last, idx), top(last, idx + 1), top(last, idx), Vertex{ 1, 0, 0 });
+        }
+    }
+
+    void writeBinary(const std::string& filename) const
+    {
+        std::ofstream out(filename, std::ios::binary);
+        const std::array<char, 80> header{};
+        out.write(header.data(), header.size());
+        const uint32_t face_count = static_cast<uint32_t>(corners.size() / 3);
+        out.write(reinterpret_cast<const char*>(&face_count), sizeof(face_count));
+        for (size_t corner_idx = 0; corner_idx < corners.size(); corner_idx += 3)
+        {
+            std::array<float, 12> face{}; // The normal is left at zero, since it isn't read.
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                for (size_t axis = 0; axis < 3; axis++)
+                {
+                    face[3 + corner * 3 + axis] = static_cast<float>(corners[corner_idx + corner][axis]);
+                }
+            }
+            out.write(reinterpret_cast<const char*>(face.data()), sizeof(face));
+            constexpr uint16_t attributes = 0;
+            out.write(reinterpret_cast<const char*>(&attributes), sizeof(attributes));
+        }
+    }
+
+    void writeAscii(const std::string& filename) const
+    {
+        std::ofstream out(filename);
+        out << "solid benchmark\n";
+        for (size_t corner_idx = 0; corner_idx < corners.size(); corner_idx += 3)
+        {
+            out << "facet normal 0 0 0\nouter loop\n";
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                const Vertex& vertex = corners[corner_idx + corner];
+                out << fmt::format("vertex {:.6f} {:.6f} {:.6f}\n", vertex[0], vertex[1], vertex[2]);
+            }
+            out << "endloop\nendfacet\n";
+        }
+        out << "endsolid benchmark\n";
+    }
+};
+
+BENCHMARK_DEFINE_F(SlicerTestFixture, loadMeshSTL_binary)(benchmark::State& st)
+{
+    Settings& settings = Application::getInstance().current_slice_->scene.settings;
+    for (auto _ : st)
+    {
+        MeshGroup mesh_group;
+        loadMeshIntoMeshGroup(&mesh_group, binary_filename.c_str(), Matrix4x3D(), settings);
+        benchmark::DoNotOptimize(mesh_group);
+    }
+    st.SetBytesProcessed(st.iterations() * std::filesystem::file_size(binary_filename));
+    st.counters["faces"] = static_cast<double>(corners.size() / 3);
+}
+
+BENCHMARK_REGISTER_F(SlicerTestFixture, loadMeshSTL_binary)->ArgsProduct({ { 0, 1, 2 }, { 200 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(SlicerTestFixture, loadMeshSTL_ascii)(benchmark::State& st)
+{
+    Settings& settings = Application::getInstance().current_slice_->scene.settings;
+    for (auto _ : st)
+    {
+        MeshGroup mesh_group;
+        loadMeshIntoMeshGroup(&mesh_group, ascii_filename.c_str(), Matrix4x3D(), settings);
+        benchmark::DoNotOptimize(mesh_group);
+    }
+    st.SetBytesProcessed(st.iterations() * std::filesystem::file_size(ascii_filename));
+    st.counters["faces"] = static_cast<double>(corners.size() / 3);
+}
+
+BENCHMARK_REGISTER_F(SlicerTestFixture, loadMeshSTL_ascii)->ArgsProduct({ { 0, 1, 2 }, { 200 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(SlicerTestFixture, Mesh_finish)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        st.PauseTiming();
+        Mesh unfinished(Application::getInstance().current_slice_->scene.settings);
+        std::vector<Point3LL> face_corners = mesh_corners;
+        unfinished.addFaces(std::move(face_corners));
+        st.ResumeTiming();
+        unfinished.finish();
+        benchmark::DoNotOptimize(unfinished);
+    }
+    st.counters["faces"] = static_cast<double>(mesh_corners.size() / 3);
+}
+
+BENCHMARK_REGISTER_F(SlicerTestFixture, Mesh_finish)->ArgsProduct({ { 0, 1, 2 }, { 200 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(SlicerTestFixture, Slicer_buildSegments)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        st.PauseTiming();
+        std::vector<SlicerLayer> layers = emptyLayers();
+        st.ResumeTiming();
+        Slicer::buildSegments(*mesh, Slicer::buildZHeightsForFaces(*mesh), slicing_tolerance, layers);
+        benchmark::DoNotOptimize(layers);
+    }
+    st.counters["layers"] = static_cast<double>(layer_count);
+}
+
+BENCHMARK_REGISTER_F(SlicerTestFixture, Slicer_buildSegments)->ArgsProduct({ { 0, 1, 2 }, { 100, 200 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(SlicerTestFixture, Slicer_makePolygons)(benchmark::State& st)
+{
+    const std::vector<SlicerLayer> sliced_layers = layersWithSegments();
+    for (auto _ : st)
+    {
+        st.PauseTiming();
+        std::vector<SlicerLayer> layers = sliced_layers;
+        st.ResumeTiming();
+        Slicer::makePolygons(*mesh, slicing_tolerance, layers);
+        benchmark::DoNotOptimize(layers);
+    }
+    st.counters["layers"] = static_cast<double>(layer_count);
+}
+
+BENCHMARK_REGISTER_F(SlicerTestFixture, Slicer_makePolygons)->ArgsProduct({ { 0, 1, 2 }, { 100, 200 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(SlicerTestFixture, createLayerParts)(benchmark::State& st)
+{
+    constexpr bool use_variable_layer_heights = false;
+    Slicer slicer(mesh, layer_thickness, layer_count, use_variable_layer_heights, nullptr);
+    const std::vector<SlicerLayer> sliced_layers = slicer.layers;
+    for (auto _ : st)
+    {
+        st.PauseTiming();
+        slicer.layers = sliced_layers; // Creating the parts takes the outlines out of the slicer.
+        SliceMeshStorage storage(mesh, layer_count);
+        st.ResumeTiming();
+        createLayerParts(storage, &slicer);
+        benchmark::DoNotOptimize(storage);
+    }
+    st.counters["layers"] = static_cast<double>(layer_count);
+}
+
+BENCHMARK_REGISTER_F(SlicerTestFixture, createLayerParts)->ArgsProduct({ { 0, 1, 2 }, { 100, 200 } })->Unit(benchmark::kMillisecond);
+
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_SLICER_BENCHMARK_H
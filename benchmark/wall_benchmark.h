@@ -16,6 +16,7 @@
 #include "InsetOrderOptimizer.h"
 #include "WallsComputation.h"
 #include "geometry/Polygon.h"
+#include "perf_counters.h"
 #include "settings/Settings.h"
 #include "sliceDataStorage.h"
 
@@ -155,10 +156,12 @@ public:
 
 BENCHMARK_DEFINE_F(WallTestFixture, generateWalls)(benchmark::State& st)
 {
+    PerfCounters perf_counters;
     for (auto _ : st)
     {
         walls_computation.generateWalls(&layer, SectionType::WALL);
     }
+    perf_counters.report(st);
 }
 
 BENCHMARK_REGISTER_F(WallTestFixture, generateWalls)->Arg(3)->Arg(15)->Arg(9999)->Unit(benchmark::kMillisecond);
@@ -197,10 +200,12 @@ BENCHMARK_REGISTER_F(WallTestFixture, InsetOrderOptimizer_getInsetOrder)->Arg(3)
 
 BENCHMARK_DEFINE_F(HolesWallTestFixture, generateWalls)(benchmark::State& st)
 {
+    PerfCounters perf_counters;
     for (auto _ : st)
     {
         walls_computation.generateWalls(&layer, SectionType::WALL);
     }
+    perf_counters.report(st);
 }
 
 BENCHMARK_REGISTER_F(HolesWallTestFixture, generateWalls)->Arg(3)->Arg(15)->Arg(9999)->Unit(benchmark::kMillisecond);
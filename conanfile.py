@@ -32,6 +32,9 @@ class CuraEngineConan(ConanFile):
         "enable_plugins": [True, False],
         "enable_sentry": [True, False],
         "enable_remote_plugins": [True, False],
+        "enable_settings_profiling": [True, False],
+        "enable_tracing": [True, False],
+        "enable_zstd": [True, False],
         "with_cura_resources": [True, False],
     }
     default_options = {
@@ -41,6 +44,9 @@ class CuraEngineConan(ConanFile):
         "enable_plugins": True,
         "enable_sentry": False,
         "enable_remote_plugins": False,
+        "enable_settings_profiling": False,
+        "enable_tracing": False,
+        "enable_zstd": False,
         "with_cura_resources": False,
     }
 
@@ -63,6 +69,8 @@ class CuraEngineConan(ConanFile):
         copy(self, "*", path.join(self.recipe_folder, "include"), path.join(self.export_sources_folder, "include"))
         copy(self, "*", path.join(self.recipe_folder, "benchmark"), path.join(self.export_sources_folder, "benchmark"))
         copy(self, "*", path.join(self.recipe_folder, "stress_benchmark"), path.join(self.export_sources_folder, "stress_benchmark"))
+        copy(self, "*", path.join(self.recipe_folder, "slice_benchmark"), path.join(self.export_sources_folder, "slice_benchmark"))
+        copy(self, "*", path.join(self.recipe_folder, "cmd_test"), path.join(self.export_sources_folder, "cmd_test"))
         copy(self, "*", path.join(self.recipe_folder, "tests"), path.join(self.export_sources_folder, "tests"))
 
     def config_options(self):
@@ -131,6 +139,8 @@ class CuraEngineConan(ConanFile):
         self.requires("fmt/10.1.1")
         self.requires("range-v3/0.12.0")
         self.requires("zlib/1.2.12")
+        if self.options.enable_zstd:
+            self.requires("zstd/1.5.5")
         self.requires("openssl/3.2.0")
         self.requires("mapbox-wagyu/0.5.0@ultimaker/stable")
 
@@ -144,6 +154,9 @@ class CuraEngineConan(ConanFile):
         tc.variables["ENABLE_TESTING"] = not self.conf.get("tools.build:skip_test", False, check_type=bool)
         tc.variables["ENABLE_BENCHMARKS"] = self.options.enable_benchmarks
         tc.variables["EXTENSIVE_WARNINGS"] = self.options.enable_extensive_warnings
+        tc.variables["ENABLE_SETTINGS_PROFILING"] = self.options.enable_settings_profiling
+        tc.variables["ENABLE_TRACING"] = self.options.enable_tracing
+        tc.variables["ENABLE_ZSTD"] = self.options.enable_zstd
         tc.variables["OLDER_APPLE_CLANG"] = self.settings.compiler == "apple-clang" and Version(self.settings.compiler.version) < "14"
         tc.variables["ENABLE_THREADING"] = not (self.settings.arch == "wasm" and self.settings.os == "Emscripten")
         if self.options.get_safe("enable_sentry", False):
@@ -169,6 +182,7 @@ class CuraEngineConan(ConanFile):
             if self.options.enable_benchmarks:
                 folder_dists.append("benchmark")
                 folder_dists.append("stress_benchmark")
+                folder_dists.append("slice_benchmark")
 
             for dist_folder in folder_dists:
                 dist_path = path.join(self.build_folder, dist_folder)
@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <string>
 
+#include "utils/CancellationToken.h"
 #include "utils/NoCopy.h"
 
 
@@ -44,14 +45,27 @@ public:
      * \brief The slice that is currently ongoing.
      *
      * If no slice has started yet, this will be a nullptr.
+     *
+     * Each thread has its own, so that the settings of a slice are looked up
+     * in the slice that the thread works for. The tasks of the thread pool
+     * take it over from the thread that queued them, see CurrentSliceScope.
      */
-    Slice* current_slice_ = nullptr;
+    static thread_local inline Slice* current_slice_ = nullptr;
 
     /*!
      * \brief ThreadPool with lifetime tied to Application
      */
     ThreadPool* thread_pool_ = nullptr;
 
+    /*!
+     * \brief Stops the current slice early, when it's no longer needed or
+     * takes too long.
+     *
+     * The parallel loops skip their remaining work once this is cancelled and
+     * throw a CancelledException, which stops the slice.
+     */
+    CancellationToken cancellation_;
+
     std::string instance_uuid_;
 
     /*!
@@ -90,6 +104,12 @@ public:
      * The thread pool is restarted when the number of thread differs from
      * previous invocations.
      *
+     * The environment variable CURAENGINE_THREAD_AFFINITY may list the CPUs
+     * to run on, like "0-7,16-23". The threads are then pinned to those CPUs,
+     * and by default there is one worker per CPU. On machines with several
+     * NUMA nodes, listing the CPUs of one node keeps all layer data in the
+     * memory of that node.
+     *
      * \param nworkers The number of workers (including the main thread) that are ran.
      */
     void startThreadPool(int nworkers = 0);
@@ -114,6 +134,12 @@ protected:
      */
     void printLicense() const;
 
+    /*!
+     * \brief Convert a text fiber path file to the binary format, as given by
+     * the arguments of the "convert-fiberpath" command.
+     */
+    void convertFiberPath() const;
+
     /*!
      * \brief Start slicing.
      * \param argc The number of arguments provided to the application.
@@ -121,6 +147,12 @@ protected:
      */
     void slice();
 
+    /*!
+     * \brief Start slicing the jobs read from the standard input, one at a
+     * time, until it is closed.
+     */
+    void daemon();
+
 private:
     /*
      * \brief The number of arguments that the application was called with.
@@ -150,6 +182,31 @@ private:
     void registerPlugins(const PluginSetupConfiguration& plugins_config);
 };
 
+/*!
+ * \brief Sets the current slice of this thread for as long as it lives, and
+ * then restores the previous one.
+ *
+ * Work that is handed over to another thread uses this to run for the slice
+ * that it was handed over by.
+ */
+class CurrentSliceScope : NoCopy
+{
+public:
+    explicit CurrentSliceScope(Slice* slice)
+        : previous_slice_(Application::current_slice_)
+    {
+        Application::current_slice_ = slice;
+    }
+
+    ~CurrentSliceScope()
+    {
+        Application::current_slice_ = previous_slice_;
+    }
+
+private:
+    Slice* previous_slice_;
+};
+
 } // namespace cura
 
 #endif // APPLICATION_H
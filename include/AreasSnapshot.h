@@ -0,0 +1,91 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef AREAS_SNAPSHOT_H
+#define AREAS_SNAPSHOT_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace cura
+{
+
+class MeshGroup;
+class SliceDataStorage;
+
+/*!
+ * \brief Stores the areas generated for a mesh group, so that the next run with
+ * the same models and the same settings only needs to write the g-code.
+ *
+ * The settings that are only read while writing the g-code, such as the
+ * speeds, accelerations, temperatures, fan and retraction settings, aren't part
+ * of what is checked, so these can be tuned without generating the areas again.
+ * Everything else, and the vertices of the meshes, needs to be the same for a
+ * snapshot to be used.
+ *
+ * Snapshots are stored in a directory, one binary file per combination of
+ * models and settings. They are memory-mapped to load them.
+ *
+ * Not everything that is generated can be stored. The snapshots aren't used
+ * with fiber paths, with the cross and cubic subdivision infill patterns, with
+ * cross support and with lightning infill, since their structures are only kept
+ * in memory. The prime tower and the combing boundaries are made again from
+ * the loaded areas.
+ */
+class AreasSnapshot
+{
+public:
+    /*!
+     * \brief Describe the mesh group whose areas are going to be generated, to
+     * find its snapshot.
+     *
+     * This needs to happen before the areas are generated, since slicing
+     * clears the vertices of the meshes.
+     * \param directory The directory to store the snapshots in. It's created
+     * when the first snapshot is stored.
+     * \param mesh_group The mesh group that is going to be sliced.
+     */
+    AreasSnapshot(std::filesystem::path directory, const MeshGroup& mesh_group);
+
+    /*!
+     * \brief Load the areas of the mesh group, if there is a snapshot of them.
+     *
+     * If nothing is loaded, the storage may be partially filled, so the areas
+     * need to be generated in a new storage.
+     * \param storage A new storage to load the areas into.
+     * \param mesh_group The mesh group that the areas belong to. Its meshes are
+     * cleared once the areas are loaded, like after slicing.
+     * \return Whether the areas were loaded.
+     */
+    [[nodiscard]] bool load(SliceDataStorage& storage, MeshGroup& mesh_group) const;
+
+    /*!
+     * \brief Store the areas generated for the mesh group for the next runs.
+     *
+     * Failing to store them is not an error, the next run will just have to
+     * generate them again.
+     * \param storage The generated areas.
+     */
+    void store(const SliceDataStorage& storage) const;
+
+private:
+    //! Increase this whenever the format of the snapshots changes.
+    static constexpr uint32_t format_version = 4;
+
+    std::filesystem::path directory_;
+    bool supported_; //!< Whether the mesh group can use snapshots at all.
+
+    /*!
+     * Everything the areas are generated from: the vertices of the meshes and
+     * the settings that are read to generate them.
+     */
+    std::string fingerprint_;
+
+    //! The file of the snapshot of this mesh group.
+    [[nodiscard]] std::filesystem::path snapshotPath() const;
+};
+
+} // namespace cura
+
+#endif // AREAS_SNAPSHOT_H
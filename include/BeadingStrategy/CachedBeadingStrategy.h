@@ -0,0 +1,103 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef CACHED_BEADING_STRATEGY_H
+#define CACHED_BEADING_STRATEGY_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "BeadingStrategy.h"
+
+namespace cura
+{
+
+/*!
+ * This is a meta strategy that remembers the beadings computed by its parent.
+ *
+ * The beading strategies are pure functions of the thickness and bead count,
+ * and the same combinations come up over and over again, within a layer as
+ * well as in the layers above and below it. The results are stored in a Memo,
+ * which is thread-safe and can be shared by all strategies that are made with
+ * the same parameters.
+ *
+ * The remembered beadings are exact: thickness and bead count are already
+ * integers, so no quantisation beyond the micron resolution of the coordinates
+ * is applied.
+ */
+class CachedBeadingStrategy : public BeadingStrategy
+{
+public:
+    /*!
+     * The remembered beadings, spread over a number of shards that each have
+     * their own lock, so that threads computing walls for different layers
+     * rarely wait for each other.
+     */
+    class Memo
+    {
+    public:
+        /*!
+         * Find a previously stored beading.
+         * \return Whether it was found. If so, it is copied to \p beading.
+         */
+        bool find(coord_t thickness, coord_t bead_count, Beading& beading) const;
+
+        /*!
+         * Remember a beading.
+         */
+        void store(coord_t thickness, coord_t bead_count, const Beading& beading);
+
+    private:
+        //! The number of beadings each shard holds at most. A shard that fills up is cleared.
+        static constexpr size_t max_shard_size = 1 << 14;
+
+        struct Key
+        {
+            coord_t thickness;
+            coord_t bead_count;
+
+            bool operator==(const Key&) const = default;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const;
+        };
+
+        struct Shard
+        {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<Key, Beading, KeyHash> beadings;
+        };
+
+        const Shard& shard(const Key& key) const;
+        Shard& shard(const Key& key);
+
+        std::array<Shard, 16> shards_;
+    };
+
+    CachedBeadingStrategy(BeadingStrategyPtr parent, std::shared_ptr<Memo> memo);
+
+    virtual ~CachedBeadingStrategy() override = default;
+
+    Beading compute(coord_t thickness, coord_t bead_count) const override;
+
+    coord_t getOptimalThickness(coord_t bead_count) const override;
+    coord_t getTransitionThickness(coord_t lower_bead_count) const override;
+    coord_t getOptimalBeadCount(coord_t thickness) const override;
+    coord_t getTransitioningLength(coord_t lower_bead_count) const override;
+    double getTransitionAnchorPos(coord_t lower_bead_count) const override;
+    std::vector<coord_t> getNonlinearThicknesses(coord_t lower_bead_count) const override;
+
+    std::string toString() const override;
+
+private:
+    BeadingStrategyPtr parent_;
+    std::shared_ptr<Memo> memo_;
+};
+
+} // namespace cura
+#endif // CACHED_BEADING_STRATEGY_H
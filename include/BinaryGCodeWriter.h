@@ -0,0 +1,125 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef BINARY_GCODE_WRITER_H
+#define BINARY_GCODE_WRITER_H
+
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "utils/NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Writes g-code in the binary g-code format (.bgcode).
+ *
+ * This is a stream buffer, so that the g-code can be written to it in the same way as to any other stream. The g-code is cut into blocks at line ends, and each
+ * block is compressed with heatshrink as soon as it is full, so during the slice only the compressed g-code is kept in memory.
+ *
+ * The format requires the metadata to come before the g-code, but the metadata (such as the print time) is only known at the end of the slice. So the file
+ * is only written to the target stream when \ref finish is called: first the file header, then the metadata blocks and then the g-code blocks.
+ */
+class BinaryGCodeWriter : public std::streambuf, public NoCopy
+{
+public:
+    //! The compression of a block, as numbered by the format.
+    enum class Compression : uint16_t
+    {
+        NONE = 0,
+        DEFLATE = 1, //!< Not supported for writing.
+        HEATSHRINK_11_4 = 2,
+        HEATSHRINK_12_4 = 3,
+    };
+
+    //! The type of a block, as numbered by the format.
+    enum class BlockType : uint16_t
+    {
+        FILE_METADATA = 0,
+        GCODE = 1,
+        SLICER_METADATA = 2,
+        PRINTER_METADATA = 3,
+        PRINT_METADATA = 4,
+        THUMBNAIL = 5,
+    };
+
+    //! Key-value pairs for a metadata block, in the order in which they are written.
+    using Metadata = std::vector<std::pair<std::string, std::string>>;
+
+    //! The most uncompressed g-code that goes in a single block.
+    static constexpr size_t max_block_size = 65535;
+
+    /*!
+     * \param target The stream to write the file to, once it's finished.
+     * \param compression How to compress the g-code blocks.
+     */
+    BinaryGCodeWriter(std::ostream& target, const Compression compression);
+
+    /*!
+     * \brief Put the remaining g-code in a block and write the whole file to
+     * the target stream.
+     *
+     * No g-code may be written after this.
+     * \param printer_metadata The printer metadata block, which printers use
+     * to check whether the file fits them.
+     * \param print_metadata The print metadata block, with the statistics of
+     * the print.
+     * \param slicer_metadata The slicer metadata block.
+     */
+    void finish(const Metadata& printer_metadata, const Metadata& print_metadata, const Metadata& slicer_metadata);
+
+    /*!
+     * \brief Compress data with heatshrink.
+     *
+     * Each call starts with an empty window, like every block of the format.
+     * \param data The data to compress.
+     * \param window_bits The base-2 logarithm of the size of the window.
+     * \param lookahead_bits The base-2 logarithm of the longest back-reference.
+     * \return The compressed bit stream, padded with zeros to whole bytes.
+     */
+    static std::string compressHeatshrink(const std::string_view data, const uint8_t window_bits, const uint8_t lookahead_bits);
+
+    /*!
+     * \brief The CRC-32 checksum with which the format checks each block.
+     * \param data The bytes to add to the checksum.
+     * \param crc The checksum of the bytes before \p data, to continue from.
+     */
+    static uint32_t crc32(const std::string_view data, const uint32_t crc = 0);
+
+    /*!
+     * \brief Encode a single block, with its header, parameters and checksum.
+     * \param type The type of the block.
+     * \param compression The compression to use, unless the data doesn't get
+     * any smaller with it.
+     * \param data The uncompressed content of the block.
+     * \return The encoded block.
+     */
+    static std::string encodeBlock(const BlockType type, const Compression compression, const std::string_view data);
+
+protected:
+    int_type overflow(int_type character) override;
+
+private:
+    /*!
+     * \brief Put the g-code that has been written into a block, up to the last
+     * line end if there is one.
+     * \param all Whether to put all of the g-code into a block, even if it
+     * doesn't end in a complete line.
+     */
+    void encodeBuffer(const bool all);
+
+    std::ostream& target_;
+    Compression compression_;
+    std::vector<char> buffer_; //!< The put area, where the g-code is written before it's encoded.
+    std::string gcode_blocks_; //!< All g-code blocks that have been encoded so far.
+};
+
+} // namespace cura
+
+#endif // BINARY_GCODE_WRITER_H
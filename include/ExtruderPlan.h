@@ -41,6 +41,7 @@ class ExtruderPlan
     FRIEND_TEST(ExtruderPlanPathsParameterizedTest, BackPressureCompensationZeroIsUncompensated);
     FRIEND_TEST(ExtruderPlanPathsParameterizedTest, BackPressureCompensationFull);
     FRIEND_TEST(ExtruderPlanPathsParameterizedTest, BackPressureCompensationHalf);
+    FRIEND_TEST(ExtruderPlanPathsParameterizedTest, PrecomputedTimeEstimatesMatch);
     FRIEND_TEST(ExtruderPlanTest, BackPressureCompensationEmptyPlan);
 #endif
 public:
@@ -90,6 +91,15 @@ public:
      */
     void handleAllRemainingInserts(GCodeExport& gcode);
 
+    /*!
+     * Whether there are temperature commands left to insert. If not, the time
+     * spent on the paths doesn't need to be tracked while writing them.
+     */
+    [[nodiscard]] bool hasPendingInserts() const
+    {
+        return ! inserts_.empty();
+    }
+
     /*!
      * Applying fan speed changes for minimal layer times.
      *
@@ -123,6 +133,18 @@ public:
      */
     void applyBackPressureCompensation(const Ratio back_pressure_compensation);
 
+    /*!
+     * \brief Compute the naive time estimates of the paths that don't depend
+     * on where the head is when this extruder plan starts.
+     *
+     * Only the paths up to and including the first one with points depend on
+     * that. The planning is finished per layer in parallel, while the starting
+     * position is only known once the layers are handled in order, so this
+     * leaves \ref computeNaiveTimeEstimates little to do. The paths must not
+     * change in between.
+     */
+    void precomputeNaiveTimeEstimates();
+
 private:
     LayerIndex layer_nr_{ 0 }; //!< The layer number at which we are currently printing.
     bool is_initial_layer_{ false }; //!< Whether this extruder plan is printed on the very first layer (which might be raft)
@@ -160,6 +182,7 @@ private:
 
     TimeMaterialEstimates estimates_{}; //!< Accumulated time and material estimates for all planned paths within this extruder plan.
     double slowest_path_speed_{ 0.0 };
+    std::optional<size_t> precomputed_estimates_start_{}; //!< The first path of which the estimates were computed by \ref precomputeNaiveTimeEstimates, if they were.
 
     double extra_time_{ 0.0 }; //!< Extra waiting time at the and of this extruder plan, so that the filament can cool
 
@@ -200,6 +223,21 @@ private:
      * \return the total estimates of this layer
      */
     TimeMaterialEstimates computeNaiveTimeEstimates(Point2LL starting_position);
+
+    /*!
+     * Compute the naive time and material estimates of a single path and add
+     * them to the estimates of that path.
+     *
+     * \param path The path to estimate.
+     * \param[in,out] p0 The position before the path, which becomes the last
+     * point of the path.
+     */
+    void computeNaiveTimeEstimates(GCodePath& path, Point2LL& p0);
+
+    /*!
+     * The speed of the slowest extrusion path of this plan.
+     */
+    double computeSlowestPathSpeed() const;
 };
 
 } // namespace cura
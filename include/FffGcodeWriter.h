@@ -5,6 +5,7 @@
 #define GCODE_WRITER_H
 
 #include <fstream>
+#include <memory>
 #include <optional>
 
 #include "ExtruderUse.h"
@@ -12,7 +13,9 @@
 #include "GCodePathConfig.h"
 #include "LayerPlanBuffer.h"
 #include "gcodeExport.h"
+#include "settings/PathConfigStorage.h"
 #include "utils/LayerVector.h"
+#include "utils/CompressingStreamBuf.h"
 #include "utils/NoCopy.h"
 #include "utils/gettime.h"
 
@@ -21,6 +24,7 @@ namespace cura
 
 class AngleDegrees;
 class Shape;
+class ShapeLocator;
 class SkinPart;
 class SliceDataStorage;
 class SliceMeshStorage;
@@ -61,6 +65,9 @@ private:
      */
     std::ofstream output_file;
 
+    std::unique_ptr<CompressingStreamBuf> compressing_buffer_; //!< If the gcode file is compressed, the buffer that compresses it into the file.
+    std::unique_ptr<std::ostream> compressed_output_; //!< If the gcode file is compressed, the stream that the gcode is written to.
+
     //!< For each layer, the extruders to be used in that layer in the order in which they are going to be used
     LayerVector<std::vector<ExtruderUse>> extruder_order_per_layer;
 
@@ -79,6 +86,13 @@ private:
     std::vector<FanSpeedLayerTimeSettings> fan_speed_layer_time_settings_per_extruder; //!< The settings used relating to minimal layer time
                                                                                        //!< and fan speeds. Configured for each extruder.
 
+    /*!
+     * The line configs of the layers above the initial layers, which are all
+     * the same apart from their thickness, so that they don't need to be
+     * gotten from the settings again for each layer.
+     */
+    std::optional<PathConfigStorage> layer_invariant_configs_;
+
     std::string slice_uuid; //!< The UUID of the current slice.
 
 public:
@@ -95,10 +109,19 @@ public:
      *
      * Used when CuraEngine is used as command line tool.
      *
+     * If the file name ends in .gz or .zst, the file is compressed with gzip or
+     * zstd while it's written. Zstd needs a build with ENABLE_ZSTD.
+     *
      * \param filename The filename of the file to which to write the gcode.
      */
     bool setTargetFile(const char* filename);
 
+    /*!
+     * Close the file set with \ref setTargetFile, so that another one may be
+     * set for the next slice. The gcode goes to the standard output until then.
+     */
+    void closeTargetFile();
+
     /*!
      * Set the target to write gcode to: an output stream.
      *
@@ -140,6 +163,8 @@ private:
         LayerPlan* layer_plan;
         double total_elapsed_time;
         TimeKeeper::RegisteredTimes stages_times;
+        coord_t layer_thickness;
+        size_t part_count; //!< The number of parts of all meshes in the layer.
     };
 
     /*!
@@ -450,6 +475,18 @@ private:
         processSpiralizedWall(const SliceDataStorage& storage, LayerPlan& gcode_layer, const MeshPathConfigs& mesh_config, const SliceLayerPart& part, const SliceMeshStorage& mesh)
             const;
 
+    /*!
+     * Add the fiber paths of the given part, as clipped to it by insertFiberPath.
+     *
+     * \param gcode_layer The initial planning of the gcode of the layer.
+     * \param mesh The mesh for which to add to the layer plan \p gcode_layer.
+     * \param extruder_nr The extruder for which to print all features of the mesh which should be printed with this extruder
+     * \param mesh_config the line config with which to print a print feature
+     * \param part The part for which to create gcode
+     * \return Whether this function added anything to the layer plan
+     */
+    bool processFiberPaths(LayerPlan& gcode_layer, const SliceMeshStorage& mesh, const size_t extruder_nr, const MeshPathConfigs& mesh_config, const SliceLayerPart& part) const;
+
     /*!
      * Add the gcode of the top/bottom skin of the given part and of the perimeter gaps.
      *
@@ -692,9 +729,16 @@ private:
      * \param mesh the mesh containing the layer of interest
      * \param layer_nr layer number of the layer whose seam verted index is required
      * \param last_layer_nr layer number of the previous layer
+     * \param wall_locator To find the vertices of the spiralized wall of the
+     * layer of interest.
      * \return layer seam vertex index
      */
-    unsigned int findSpiralizedLayerSeamVertexIndex(const SliceDataStorage& storage, const SliceMeshStorage& mesh, const int layer_nr, const int last_layer_nr);
+    unsigned int findSpiralizedLayerSeamVertexIndex(
+        const SliceDataStorage& storage,
+        const SliceMeshStorage& mesh,
+        const int layer_nr,
+        const int last_layer_nr,
+        const ShapeLocator& wall_locator);
 
     /*!
      * Partition the Infill regions by the skin at N layers above.
@@ -702,11 +746,10 @@ private:
      * When skin edge support layers is set this function will check N layers above the infill layer to see if there is
      * skin above. If this skin needs to be supported by a wall it will return true else it returns false. The Infill
      * outline of the Sparse density layer is partitioned into two polygons, either below the skin regions or outside
-     * of the skin region.
+     * of the skin region. The skin of the N layers above is combined beforehand, in SliceLayerPart::skin_above.
      *
      * \param infill_below_skin [out] Polygons with infill below the skin
      * \param infill_not_below_skin [out] Polygons with infill outside of skin regions above
-     * \param gcode_layer The initial planning of the gcode of the layer
      * \param mesh the mesh containing the layer of interest
      * \param part \param part The part for which to create gcode
      * \param infill_line_width line width of the infill
@@ -715,7 +758,6 @@ private:
     static bool partitionInfillBySkinAbove(
         Shape& infill_below_skin,
         Shape& infill_not_below_skin,
-        const LayerPlan& gcode_layer,
         const SliceMeshStorage& mesh,
         const SliceLayerPart& part,
         coord_t infill_line_width);
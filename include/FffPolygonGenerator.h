@@ -12,9 +12,11 @@ namespace cura
 
 class MeshGroup;
 class ProgressStageEstimator;
+class SkinOutlineCache;
 class SliceDataStorage;
 class SliceMeshStorage;
 class TimeKeeper;
+class WallToolPathsCache;
 
 /*!
  * Primary stage in Fused Filament Fabrication processing: Polygons are generated.
@@ -64,6 +66,11 @@ private:
     /*!
      * Processes the outline information as stored in the \p storage: generates inset perimeter polygons, support area polygons, etc.
      *
+     * The g-code of a layer can't be written before this is done for all layers. The support of a layer depends on all layers above it,
+     * since the support areas are dropped down from the overhangs. Depending on the settings, empty first layers may be removed, which
+     * renumbers all layers, and the prime tower, skirt, brim and shields are computed from the whole print. Even the header at the start of
+     * the g-code lists the extruders that are used, which depends on the skirt, brim and support of all layers.
+     *
      * \param storage Input and Output parameter: fetches the outline information (see SliceLayerPart::outline) and generates the other reachable field of the \p storage
      * \param timeKeeper Object which keeps track of timings of each stage.
      */
@@ -131,8 +138,10 @@ private:
     /*!
      * \brief Generate the inset polygons which form the walls.
      * \param layer_nr The layer for which to generate the insets.
+     * \param cache Walls generated for other layers of this mesh, to reuse for
+     * identical outlines.
      */
-    void processWalls(SliceMeshStorage& mesh, size_t layer_nr);
+    void processWalls(SliceMeshStorage& mesh, size_t layer_nr, WallToolPathsCache& cache);
 
     /*!
      * Generate the outline of the ooze shield.
@@ -145,8 +154,10 @@ private:
      * \param mesh Input and Output parameter: fetches the outline information (see SliceLayerPart::outline) and generates the other reachable field of the \p storage
      * \param layer_nr The layer for which to generate the skin areas.
      * \param process_infill Generate infill areas
+     * \param outline_cache The outlines of ranges of layers of this mesh,
+     * shared with the skins of the other layers.
      */
-    void processSkinsAndInfill(SliceMeshStorage& mesh, const LayerIndex layer_nr, bool process_infill);
+    void processSkinsAndInfill(SliceMeshStorage& mesh, const LayerIndex layer_nr, bool process_infill, SkinOutlineCache& outline_cache);
 
     /*!
      * Generate the polygons where the draft screen should be.
@@ -171,6 +182,15 @@ private:
      * \param[in,out] mesh where the outer wall is retrieved and stored in.
      */
     void processFuzzyWalls(SliceMeshStorage& mesh);
+
+    /*!
+     * Generate the ironing paths over the top surfaces of a mesh, so that the
+     * g-code writer only needs to order them.
+     *
+     * \param[in,out] mesh where the top surfaces are retrieved and the ironing
+     * paths are stored in.
+     */
+    void processIroning(SliceMeshStorage& mesh);
 };
 
 } // namespace cura
@@ -55,6 +55,12 @@ public:
      */
     bool setTargetFile(const char* filename);
 
+    /*!
+     * Close the file that the gcode was written to, so that the next slice may
+     * write to another file.
+     */
+    void closeTargetFile();
+
     /*!
      * Set the target to write gcode to: an output stream.
      * 
@@ -15,11 +15,15 @@
 #include "geometry/Polygon.h"
 #include "pathPlanning/GCodePath.h"
 #include "pathPlanning/NozzleTempInsert.h"
+#include "pathPlanning/PathPointsPool.h"
 #include "pathPlanning/TimeMaterialEstimates.h"
 #include "raft.h"
 #include "settings/PathConfigStorage.h"
 #include "settings/types/LayerIndex.h"
 #include "utils/ExtrusionJunction.h"
+#include "utils/NoCopy.h"
+#include "utils/ShapeCoordinates.h"
+#include "utils/polygonUtils.h"
 
 #ifdef BUILD_TESTS
 #include <gtest/gtest_prod.h> //Friend tests, so that they can inspect the privates.
@@ -56,6 +60,12 @@ class LayerPlan : public NoCopy
 #endif
 
 public:
+    enum CombBoundary
+    {
+        MINIMUM,
+        PREFERRED
+    };
+
     const PathConfigStorage configs_storage_; //!< The line configs for this layer for each feature type
     const coord_t z_;
     coord_t final_travel_z_;
@@ -93,23 +103,55 @@ private:
     bool is_inside_; //!< Whether the destination of the next planned travel move is inside a layer part
     Shape comb_boundary_minimum_; //!< The minimum boundary within which to comb, or to move into when performing a retraction.
     Shape comb_boundary_preferred_; //!< The boundary preferably within which to comb, or to move into when performing a retraction.
+    std::optional<Shape> travel_optimization_boundary_; //!< The minimum combing boundary, grown to contain all infill and skin lines. Only computed once lines are ordered with travel optimization.
+    std::shared_ptr<LocToLineGrid> travel_optimization_grid_; //!< Locates the lines of travel_optimization_boundary_, shared by all optimizers that order lines within it.
     Comb* comb_;
     coord_t comb_move_inside_distance_; //!< Whenever using the minimum boundary for combing it tries to move the coordinates inside by this distance after calculating the combing.
-    Shape bridge_wall_mask_; //!< The regions of a layer part that are not supported, used for bridging
-    Shape overhang_mask_; //!< The regions of a layer part where the walls overhang
+    PathPointsPool::Buffers recycled_points_; //!< Point buffers of the paths of an earlier layer plan, for new paths to reuse.
+
+    /*!
+     * \brief A mask of the layer part that is being processed, which every
+     * segment of the walls of the part is tested against.
+     *
+     * The edges of the mask are indexed the first time that they are needed,
+     * so that each test only looks at the edges near the segment. Like all
+     * tests against the masks, points on the border count as inside.
+     */
+    class IndexedMask : public NoCopy
+    {
+    public:
+        void set(const Shape& shape);
+
+        [[nodiscard]] const Shape& shape() const;
+
+        [[nodiscard]] bool empty() const;
+
+        //! Whether a point is inside the mask or on its border, like Shape::inside.
+        [[nodiscard]] bool inside(const Point2LL& p) const;
+
+        //! Whether a line segment crosses or touches the border of the mask, like PolygonUtils::polygonCollidesWithLineSegment.
+        [[nodiscard]] bool collidesWithLineSegment(const Point2LL& from, const Point2LL& to) const;
+
+    private:
+        static constexpr coord_t segment_grid_cell_size = MM2INT(2.0);
+
+        Shape shape_;
+        mutable std::optional<ShapeCoordinates> coordinates_; //!< For the inside tests, with the edges sorted into bands.
+        mutable std::unique_ptr<LocToLineGrid> segment_grid_; //!< For the tests whether line segments cross the border.
+    };
+
+    IndexedMask bridge_wall_mask_; //!< The regions of a layer part that are not supported, used for bridging
+    IndexedMask overhang_mask_; //!< The regions of a layer part where the walls overhang
     Shape seam_overhang_mask_; //!< The regions of a layer part where the walls overhang, specifically as defined for the seam
-    Shape roofing_mask_; //!< The regions of a layer part where the walls are exposed to the air
+    IndexedMask roofing_mask_; //!< The regions of a layer part where the walls are exposed to the air
+    mutable IndexedMask air_below_mask_; //!< The union of the bridge wall mask and the seam overhang mask, where the seams aren't placed
+    mutable bool air_below_mask_is_set_ = false; //!< Whether the air below mask is up to date with the bridge wall and seam overhang masks
 
     bool min_layer_time_used = false; //!< Wether or not the minimum layer time (cool_min_layer_time) was actually used in this layerplan.
+    bool coasting_planned_ = false; //!< Whether the paths know where their coasting starts. See \ref planCoasting.
 
     const std::vector<FanSpeedLayerTimeSettings> fan_speed_layer_time_settings_per_extruder_;
 
-    enum CombBoundary
-    {
-        MINIMUM,
-        PREFERRED
-    };
-
     /*!
      * Either create a new path with the given config or return the last path if it already had that config.
      * If LayerPlan::forceNewPathStart has been called a new path will always be returned.
@@ -158,6 +200,9 @@ public:
      * while combing.
      * \param travel_avoid_distance The distance by which to avoid other layer
      * parts when travelling through air.
+     * \param layer_invariant_configs The line configs of another layer, to
+     * copy instead of getting them from the settings again. Only for layers
+     * for which PathConfigStorage::isLayerInvariant holds.
      */
     LayerPlan(
         const SliceDataStorage& storage,
@@ -168,7 +213,8 @@ public:
         const std::vector<FanSpeedLayerTimeSettings>& fan_speed_layer_time_settings_per_extruder,
         coord_t comb_boundary_offset,
         coord_t comb_move_inside_distance,
-        coord_t travel_avoid_distance);
+        coord_t travel_avoid_distance,
+        const PathConfigStorage* layer_invariant_configs = nullptr);
 
     ~LayerPlan();
 
@@ -182,6 +228,31 @@ public:
 
     const Shape* getCombBoundaryInside() const;
 
+    /*!
+     * \brief Compute a combing boundary of a layer of the model.
+     *
+     * This is the part of \ref computeCombBoundary for model layers, with
+     * the combing mode of each mesh. It doesn't need a layer plan, so that the
+     * boundaries of all layers can be computed ahead, see
+     * \ref precomputeCombBoundaries.
+     * \param storage The data of the meshes.
+     * \param layer_nr The layer of the model, from 0.
+     * \param boundary_type The boundary type to compute.
+     * \return The combing boundary.
+     */
+    static Shape computeModelCombBoundary(const SliceDataStorage& storage, const LayerIndex layer_nr, const CombBoundary boundary_type);
+
+    /*!
+     * \brief Compute the combing boundaries of all layers of the model, and
+     * store them in the storage for the layer plans to use.
+     *
+     * A layer that combs through the same areas as the layer below it reuses
+     * the boundaries of that layer instead of offsetting the same outlines
+     * again, which saves most of the work for prismatic models.
+     * \param storage The data of the meshes, after all areas are generated.
+     */
+    static void precomputeCombBoundaries(SliceDataStorage& storage);
+
     LayerIndex getLayerNr() const;
 
     /*!
@@ -682,14 +753,20 @@ public:
             return start_idx;
         }
 
-        const auto air_below = bridge_wall_mask_.unionPolygons(seam_overhang_mask_);
+        // All closed walls of the part are tested against the same masks.
+        if (! air_below_mask_is_set_)
+        {
+            air_below_mask_.set(bridge_wall_mask_.shape().unionPolygons(seam_overhang_mask_));
+            air_below_mask_is_set_ = true;
+        }
+        const IndexedMask& air_below = air_below_mask_;
 
         unsigned curr_idx = start_idx;
 
         while (true)
         {
             const Point2LL& vertex = cura::make_point(wall[curr_idx]);
-            if (! air_below.inside(vertex, true))
+            if (! air_below.inside(vertex))
             {
                 // vertex isn't above air so it's OK to use
                 return curr_idx;
@@ -734,15 +811,20 @@ public:
      * \param extruder_plan_idx The index of the current extruder plan.
      * \param path_idx The index into LayerPlan::paths for the next path to be
      * written to GCode.
-     * \param layer_thickness The height of the current layer.
      * \return Whether any GCode has been written for the path.
      */
-    bool writePathWithCoasting(
-        GCodeExport& gcode,
-        const size_t extruder_plan_idx,
-        const size_t path_idx,
-        const coord_t layer_thickness,
-        const std::function<void(const double, const int64_t)> insertTempOnTime);
+    bool writePathWithCoasting(GCodeExport& gcode, const size_t extruder_plan_idx, const size_t path_idx, const std::function<void(const double, const int64_t)> insertTempOnTime);
+
+    /*!
+     * Find where the coasting would start on a path, if its end is coasted.
+     *
+     * \param path The extrusion path.
+     * \param coasting_volume The volume of material to coast with.
+     * \param coasting_min_volume The smallest volume of the path before which
+     * less than the full coasting volume is coasted.
+     * \return Where to start coasting, or nothing if the path is too short to coast.
+     */
+    std::optional<GCodePath::CoastingSplit> computeCoastingSplit(const GCodePath& path, const double coasting_volume, const double coasting_min_volume) const;
 
     /*!
      * Applying speed corrections for minimal layer times and determine the fanSpeed.
@@ -778,6 +860,29 @@ public:
      */
     void applyBackPressureCompensation();
 
+    /*!
+     * Estimate how much memory this layer plan takes, mostly in its paths and
+     * its combing boundaries.
+     * \return The estimated number of bytes.
+     */
+    size_t estimateMemoryUsage() const;
+
+    /*!
+     * Compute the naive time estimates of each extruder plan as far as they
+     * don't depend on the position of the head at the start of the layer. See
+     * \ref ExtruderPlan::precomputeNaiveTimeEstimates.
+     */
+    void precomputeNaiveTimeEstimates();
+
+    /*!
+     * Find where coasting starts on every extrusion path that could be
+     * coasted, so that writing the g-code only needs to split it there.
+     *
+     * This needs to be done after the paths are complete. If it wasn't done,
+     * it is done when the g-code is written.
+     */
+    void planCoasting();
+
 private:
     /*!
      * \brief Compute the preferred or minimum combing boundary
@@ -797,6 +902,18 @@ private:
      */
     Shape computeCombBoundary(const CombBoundary boundary_type);
 
+    /*!
+     * Get the boundary to comb within when ordering lines with travel
+     * optimization: the minimum combing boundary, grown so that all infill and
+     * skin lines are inside it.
+     *
+     * It is computed the first time it's needed, together with
+     * \ref travel_optimization_grid_, and then reused for all lines of this
+     * layer.
+     * \return The boundary, or ``nullptr`` if there is no combing boundary.
+     */
+    const Shape* getTravelOptimizationBoundary();
+
     /*!
      * Add order optimized lines to the gcode.
      * \param lines The lines in order
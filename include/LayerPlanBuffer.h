@@ -39,9 +39,7 @@ class LayerPlanBuffer
 
     Preheat preheat_config_; //!< the nozzle and material temperature settings for each extruder train.
 
-    static constexpr size_t buffer_size_
-        = 5; // should be as low as possible while still allowing enough time in the buffer to heat up from standby temp to printing temp // TODO: hardcoded value
-    // this value should be higher than 1, cause otherwise each layer is viewed as the first layer and no temp commands are inserted.
+    size_t buffer_size_{ default_buffer_size_ }; //!< The number of layers kept before they are written, see \ref setBufferSize.
 
     static constexpr Duration extra_preheat_time_
         = 1.0_s; //!< Time to start heating earlier than computed to avoid accummulative discrepancy between actual heating times and computed ones.
@@ -58,6 +56,15 @@ class LayerPlanBuffer
     std::list<LayerPlan*> buffer_;
 
 public:
+    //! Should be as low as possible while still allowing enough time in the buffer to heat up from standby temp to printing temp.
+    static constexpr size_t default_buffer_size_ = 5;
+
+    /*!
+     * The lowest allowed buffer size. With a single layer in the buffer, each
+     * layer is viewed as the first layer and no temp commands are inserted.
+     */
+    static constexpr size_t min_buffer_size_ = 2;
+
     LayerPlanBuffer(GCodeExport& gcode)
         : gcode_(gcode)
         , extruder_used_in_meshgroup_(MAX_EXTRUDERS, false)
@@ -66,6 +73,16 @@ public:
 
     void setPreheatConfig();
 
+    /*!
+     * Set how many layers are kept in the buffer before they are written.
+     *
+     * More layers allow heating up from the standby temperature over a longer
+     * time, at the cost of memory. Values below \ref min_buffer_size_ are
+     * raised to it.
+     * \param buffer_size The number of layers to keep.
+     */
+    void setBufferSize(const size_t buffer_size);
+
     /*!
      * Push a new layer plan into the buffer
      */
@@ -35,7 +35,7 @@ public:
     MeshGroup& operator=(const MeshGroup& other) = delete;
 
     std::vector<Mesh> meshes;
-    std::vector<FiberPaths> fiberpaths; 
+    std::vector<std::shared_ptr<FiberPaths>> fiberpaths; //!< Shared with the fiber path cache, so these must not be modified.
     Settings settings;
 
     Point3LL min() const; //! minimal corner of bounding box
@@ -58,6 +58,9 @@ public:
 /*!
  * Load a Mesh from file and store it in the \p meshgroup.
  *
+ * STL, OBJ and 3MF files are supported. A 3MF file results in a mesh for each
+ * of the items it builds.
+ *
  * \param meshgroup The meshgroup where to store the mesh
  * \param filename The filename of the mesh file
  * \param transformation The transformation applied to all vertices
@@ -69,6 +72,9 @@ bool loadMeshIntoMeshGroup(MeshGroup* meshgroup, const char* filename, const Mat
 /*!
  * Load a FiberPathGroup from file and store it in the \p meshgroup.
  *
+ * If the fiber_path_simplify setting is given and true, the fibers are
+ * simplified with the meshfix_maximum_* resolution settings.
+ *
  * \param meshgroup The meshgroup where to store the fiberpath
  * \param filename The filename of the fiberpath file
  * \param transformation The transformation applied to all vertices
@@ -79,6 +85,26 @@ bool loadMeshIntoMeshGroup(MeshGroup* meshgroup, const char* filename, const Mat
 
 bool loadFiberPathIntoMeshGroup(MeshGroup* meshgroup, const char* filename, const Matrix4x3D& transformation, Settings& object_parent_settings);
 
+/*!
+ * Load a fiber path file in the text format, with an "x y z index" line per
+ * point.
+ *
+ * \param fiberpaths Where to store the fiber layers.
+ * \param filename The filename of the fiberpath file.
+ * \param matrix The transformation applied to all points.
+ * \return whether the file could be loaded
+ */
+bool loadFiberPathTXT(FiberPaths* fiberpaths, const char* filename, const Matrix4x3D& matrix);
+
+/*!
+ * Convert a fiber path file in the text format to the binary format.
+ *
+ * \param input_filename The text file to read.
+ * \param output_filename The binary file to write.
+ * \return whether the file could be converted
+ */
+bool convertFiberPathToBinary(const char* input_filename, const char* output_filename);
+
 } // namespace cura
 
 #endif // MESH_GROUP_H
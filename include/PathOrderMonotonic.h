@@ -102,15 +102,17 @@ public:
                 return a_projection < b_projection;
             });
         // Create a bucket grid to be able to find adjacent lines quickly.
-        SparsePointGridInclusive<Path*> line_bucket_grid(MM2INT(2)); // Grid size of 2mm.
+        std::vector<typename SparsePointGridInclusive<Path*>::Elem> line_bucket_points;
+        line_bucket_points.reserve(polylines.size() * 2);
         for (Path* polyline : polylines)
         {
             if (! polyline->converted_->empty())
             {
-                line_bucket_grid.insert(polyline->converted_->front(), polyline);
-                line_bucket_grid.insert(polyline->converted_->back(), polyline);
+                line_bucket_points.emplace_back(polyline->converted_->front(), polyline);
+                line_bucket_points.emplace_back(polyline->converted_->back(), polyline);
             }
         }
+        const SparsePointGridInclusive<Path*> line_bucket_grid(MM2INT(2), line_bucket_points); // Grid size of 2mm.
 
         // Create sequences of line segments that get printed together in a monotonic direction.
         // There are several constraints we impose here:
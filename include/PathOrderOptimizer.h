@@ -4,9 +4,15 @@
 #ifndef PATHORDEROPTIMIZER_H
 #define PATHORDEROPTIMIZER_H
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <numbers>
+#include <optional>
+#include <unordered_map>
 #include <unordered_set>
 
+#include <range/v3/algorithm/none_of.hpp>
 #include <range/v3/algorithm/partition_copy.hpp>
 #include <range/v3/iterator/insert_iterators.hpp>
 #include <range/v3/view/addressof.hpp>
@@ -21,6 +27,8 @@
 #include "path_ordering.h"
 #include "settings/EnumSettings.h" //To get the seam settings.
 #include "settings/ZSeamConfig.h" //To read the seam configuration.
+#include "utils/NearestPointGrid.h"
+#include "utils/PairHash.h"
 #include "utils/linearAlg2D.h" //To find the angle of corners to hide seams.
 #include "utils/polygonUtils.h"
 #include "utils/views/dfs.h"
@@ -78,6 +86,13 @@ public:
      */
     std::unordered_map<Path, OrderablePath*> vertices_to_paths_;
 
+    /*!
+     * Scratch space for findClosestPathVertices, which is called for every
+     * path while ordering with constraints. Reusing it saves allocating a new
+     * vector for each of those calls.
+     */
+    std::vector<OrderablePath*> candidate_orderable_paths_;
+
     /*!
      * The location where the nozzle is assumed to start from before printing
      * these parts.
@@ -137,6 +152,33 @@ public:
         paths_.back().force_start_index_ = force_start_index;
     }
 
+    /*!
+     * Use a grid of the lines of the combing boundary that was already made,
+     * instead of making one. This saves making the grid for each optimizer if
+     * many of them comb within the same boundary.
+     * \param combing_grid A grid of the lines of the combing boundary that was
+     * given to the constructor.
+     */
+    void setCombingGrid(std::shared_ptr<LocToLineGrid> combing_grid)
+    {
+        combing_grid_ = std::move(combing_grid);
+    }
+
+    /*!
+     * Refine the greedy order with 2-opt and Or-opt moves, to shorten the
+     * travel moves between the paths.
+     *
+     * The refinement is bounded by the number of moves it evaluates rather
+     * than by time, so that the result doesn't depend on the speed of the
+     * computer. Orders with order requirements are never refined.
+     * \param max_evaluated_moves The number of candidate moves that may be
+     * evaluated. Zero disables the refinement, which is the default.
+     */
+    void setRefinementBudget(const size_t max_evaluated_moves)
+    {
+        refinement_budget_ = max_evaluated_moves;
+    }
+
     /*!
      * Add a new polyline to be optimized.
      * \param polyline The polyline to optimize.
@@ -182,7 +224,7 @@ public:
 
         // Add all vertices to a bucket grid so that we can find nearby endpoints quickly.
         const coord_t snap_radius = 10_mu; // 0.01mm grid cells. Chaining only needs to consider polylines which are next to each other.
-        SparsePointGridInclusive<size_t> line_bucket_grid(snap_radius);
+        std::vector<SparsePointGridInclusive<size_t>::Elem> line_bucket_points;
         for (const auto& [i, path] : paths_ | ranges::views::enumerate)
         {
             if (path.converted_->empty())
@@ -193,15 +235,16 @@ public:
             {
                 for (const Point2LL& point : *path.converted_)
                 {
-                    line_bucket_grid.insert(point, i); // Store by index so that we can also mark them down in the `picked` vector.
+                    line_bucket_points.emplace_back(point, i); // Store by index so that we can also mark them down in the `picked` vector.
                 }
             }
             else // For polylines, only insert the endpoints. Those are the only places we can start from so the only relevant vertices to be near to.
             {
-                line_bucket_grid.insert(path.converted_->front(), i);
-                line_bucket_grid.insert(path.converted_->back(), i);
+                line_bucket_points.emplace_back(path.converted_->front(), i);
+                line_bucket_points.emplace_back(path.converted_->back(), i);
             }
         }
+        const SparsePointGridInclusive<size_t> line_bucket_grid(snap_radius, line_bucket_points);
 
         // For some Z seam types the start position can be pre-computed.
         // This is faster since we don't need to re-compute the start position at each step then.
@@ -223,6 +266,10 @@ public:
         if (order_requirements_->empty())
         {
             optimized_order = getOptimizedOrder(line_bucket_grid, snap_radius);
+            if (refinement_budget_ > 0)
+            {
+                refineOrder(optimized_order);
+            }
         }
         else
         {
@@ -241,6 +288,7 @@ public:
         }
 
         combing_grid_.reset();
+        combing_distances_.clear();
     }
 
 protected:
@@ -256,9 +304,23 @@ protected:
      *
      * This is cached in order to speed up the collision checking with the
      * combing boundary. We only need to generate this mapping once for the
-     * combing boundary, since the combing boundary can't change.
+     * combing boundary, since the combing boundary can't change. It may be
+     * shared with other optimizers that comb within the same boundary, see
+     * \ref setCombingGrid.
      */
-    std::unique_ptr<LocToLineGrid> combing_grid_;
+    std::shared_ptr<LocToLineGrid> combing_grid_;
+
+    /*!
+     * The combing distances that were computed, per start and end point.
+     *
+     * The same travel moves are evaluated repeatedly, for instance when a
+     * path remains a candidate while other paths are picked. Only the most
+     * recent ones are kept, to bound the memory.
+     */
+    std::unordered_map<std::pair<Point2LL, Point2LL>, coord_t> combing_distances_;
+
+    //! How many combing distances to keep in \ref combing_distances_ at most.
+    constexpr static size_t max_cached_combing_distances_ = 4096;
 
     /*!
      * Boundary to avoid when making travel moves.
@@ -298,7 +360,13 @@ protected:
      */
     const std::unordered_multimap<Path, Path>* order_requirements_;
 
-    std::vector<OrderablePath> getOptimizedOrder(SparsePointGridInclusive<size_t> line_bucket_grid, size_t snap_radius)
+    /*!
+     * How many candidate moves the refinement of the greedy order may
+     * evaluate. See \ref setRefinementBudget.
+     */
+    size_t refinement_budget_ = 0;
+
+    std::vector<OrderablePath> getOptimizedOrder(const SparsePointGridInclusive<size_t>& line_bucket_grid, size_t snap_radius)
     {
         std::vector<OrderablePath> optimized_order; // To store our result in.
 
@@ -311,6 +379,29 @@ protected:
             return ! picked[c];
         };
 
+        // Without combing, the distance to a path only depends on its endpoints or its pre-computed seam, not on where we come from. Then the nearest unpicked path
+        // can be found with a grid instead of by going through all of them, which would make the ordering quadratic if the paths are scattered.
+        const bool precompute_start
+            = seam_config_.type_ == EZSeamType::RANDOM || seam_config_.type_ == EZSeamType::USER_SPECIFIED || seam_config_.type_ == EZSeamType::SHARPEST_CORNER;
+        const bool use_unpicked_grid = combing_boundary_ == nullptr
+                                    && (precompute_start
+                                        || ranges::none_of(
+                                            paths_,
+                                            [](const OrderablePath& path)
+                                            {
+                                                return path.is_closed_ && ! path.converted_->empty();
+                                            }));
+        std::optional<NearestPointGrid<size_t>> unpicked_grid; // Only created once it's needed, with the paths that aren't picked at that point.
+        std::vector<size_t> unpicked_empty_paths;
+        const auto getStartCandidates = [](const OrderablePath& path) -> std::vector<Point2LL>
+        {
+            if (path.is_closed_)
+            {
+                return { (*path.converted_)[path.start_vertex_] };
+            }
+            return { path.converted_->front(), path.converted_->back() };
+        };
+
         while (optimized_order.size() < paths_.size())
         {
             // Use bucket grid to find paths within snap_radius
@@ -327,6 +418,39 @@ protected:
                 available_candidates.push_back(candidate);
             }
 
+            if (available_candidates.empty() && use_unpicked_grid) // Find the nearest of all candidates in the grid.
+            {
+                if (! unpicked_grid)
+                {
+                    std::vector<std::pair<Point2LL, size_t>> unpicked_starts;
+                    for (const auto& [i, path] : paths_ | ranges::views::enumerate)
+                    {
+                        if (picked[&paths_[i]])
+                        {
+                            continue;
+                        }
+                        if (path.converted_->empty())
+                        {
+                            unpicked_empty_paths.push_back(i);
+                            continue;
+                        }
+                        for (const Point2LL& start : getStartCandidates(path))
+                        {
+                            unpicked_starts.emplace_back(start, i);
+                        }
+                    }
+                    unpicked_grid.emplace(unpicked_starts);
+                }
+                if (const std::optional<size_t> nearest = unpicked_grid->findNearest(current_position))
+                {
+                    available_candidates.push_back(&paths_[*nearest]);
+                }
+                else // Only empty paths are left. Those are picked in the same order as when going through all candidates.
+                {
+                    available_candidates.push_back(&paths_[unpicked_empty_paths.back()]);
+                    unpicked_empty_paths.pop_back();
+                }
+            }
             if (available_candidates.empty()) // We need to broaden our search through all candidates
             {
                 for (auto path : paths_ | ranges::views::addressof | ranges::views::filter(notPicked))
@@ -340,6 +464,14 @@ protected:
             auto best_path = best_candidate;
             optimized_order.push_back(*best_path);
             picked[best_path] = true;
+            if (unpicked_grid && ! best_path->converted_->empty())
+            {
+                const size_t best_path_idx = best_path - paths_.data();
+                for (const Point2LL& start : getStartCandidates(*best_path))
+                {
+                    unpicked_grid->remove(start, best_path_idx);
+                }
+            }
 
             if (! best_path->converted_->empty()) // If all paths were empty, the best path is still empty. We don't upate the current position then.
             {
@@ -358,6 +490,151 @@ protected:
         return optimized_order;
     }
 
+    /*!
+     * Improve an order with local search, to shorten the travel moves between
+     * the paths.
+     *
+     * Two kinds of moves are tried, until none of them improves the order or
+     * the budget runs out:
+     * - 2-opt: reverse a range of the order. Polylines in that range are then
+     *   printed in the other direction.
+     * - Or-opt: move one to three consecutive paths elsewhere in the order,
+     *   possibly reversed.
+     * Polygons start and end at their seam, which stays where it is.
+     * \param order The order to improve, as found by getOptimizedOrder.
+     */
+    void refineOrder(std::vector<OrderablePath>& order)
+    {
+        // Empty paths don't take part in the travel. They come last, after all paths with vertices.
+        const size_t count = std::find_if(
+                                 order.begin(),
+                                 order.end(),
+                                 [](const OrderablePath& path)
+                                 {
+                                     return path.converted_->empty();
+                                 })
+                           - order.begin();
+        if (count < 3)
+        {
+            return;
+        }
+
+        const auto entry = [&order](const size_t i) -> Point2LL
+        {
+            return (*order[i].converted_)[order[i].start_vertex_];
+        };
+        const auto exit = [&order](const size_t i) -> Point2LL
+        {
+            const OrderablePath& path = order[i];
+            if (path.is_closed_)
+            {
+                return (*path.converted_)[path.start_vertex_]; // We end where we started.
+            }
+            return path.start_vertex_ == 0 ? path.converted_->back() : path.converted_->front();
+        };
+        const auto exit_before = [&](const size_t i) -> Point2LL
+        {
+            return i == 0 ? start_point_ : exit(i - 1);
+        };
+        const auto travel = [this](const Point2LL& a, const Point2LL& b) -> double
+        {
+            return combing_boundary_ ? std::sqrt(static_cast<double>(getCombingDistance(a, b))) : static_cast<double>(vSize(a - b));
+        };
+        const auto reverse_range = [&order](const size_t first, const size_t last)
+        {
+            std::reverse(order.begin() + first, order.begin() + last + 1);
+            for (size_t i = first; i <= last; i++)
+            {
+                if (! order[i].is_closed_)
+                {
+                    order[i].start_vertex_ = order[i].converted_->size() - 1 - order[i].start_vertex_;
+                    order[i].backwards_ = ! order[i].backwards_;
+                }
+            }
+        };
+
+        constexpr double min_gain = 1.0; // Ignore improvements of less than a micron, so that rounding errors can't make moves undo each other forever.
+        size_t moves_left = refinement_budget_;
+        bool improved = true;
+        while (improved && moves_left > 0)
+        {
+            improved = false;
+
+            // 2-opt: Reverse order[first..last]. The travel moves inside the range stay the same, only the ones into and out of it change.
+            for (size_t first = 0; first < count && moves_left > 0; first++)
+            {
+                const Point2LL before = exit_before(first);
+                for (size_t last = first; last < count && moves_left > 0; last++)
+                {
+                    moves_left--;
+                    double gain = travel(before, entry(first)) - travel(before, exit(last));
+                    if (last + 1 < count)
+                    {
+                        gain += travel(exit(last), entry(last + 1)) - travel(entry(first), entry(last + 1));
+                    }
+                    if (gain > min_gain)
+                    {
+                        reverse_range(first, last);
+                        improved = true;
+                    }
+                }
+            }
+
+            // Or-opt: Move order[first..first + length - 1] to after order[target - 1], where target 0 means to the start of the order.
+            for (size_t length = 1; length <= 3; length++)
+            {
+                for (size_t first = 0; first + length <= count && moves_left > 0; first++)
+                {
+                    const size_t last = first + length - 1;
+                    for (size_t target = 0; target <= count && moves_left > 0; target++)
+                    {
+                        if (target >= first && target <= last + 1)
+                        {
+                            continue; // That's where the paths are already.
+                        }
+                        moves_left--;
+                        double removal_gain = travel(exit_before(first), entry(first));
+                        if (last + 1 < count)
+                        {
+                            removal_gain += travel(exit(last), entry(last + 1)) - travel(exit_before(first), entry(last + 1));
+                        }
+                        const Point2LL before = exit_before(target);
+                        double forward_cost = travel(before, entry(first));
+                        double reversed_cost = travel(before, exit(last));
+                        if (target < count)
+                        {
+                            const double replaced = travel(before, entry(target));
+                            forward_cost += travel(exit(last), entry(target)) - replaced;
+                            reversed_cost += travel(entry(first), entry(target)) - replaced;
+                        }
+                        const bool reverse = reversed_cost < forward_cost;
+                        if (removal_gain - std::min(forward_cost, reversed_cost) <= min_gain)
+                        {
+                            continue;
+                        }
+
+                        size_t new_first;
+                        if (target < first)
+                        {
+                            std::rotate(order.begin() + target, order.begin() + first, order.begin() + last + 1);
+                            new_first = target;
+                        }
+                        else
+                        {
+                            std::rotate(order.begin() + first, order.begin() + last + 1, order.begin() + target);
+                            new_first = target - length;
+                        }
+                        if (reverse)
+                        {
+                            reverse_range(new_first, new_first + length - 1);
+                        }
+                        improved = true;
+                    }
+                }
+            }
+        }
+    }
+
     std::vector<OrderablePath> getOptimizerOrderWithConstraints(const std::unordered_multimap<Path, Path>& order_requirements)
     {
         std::vector<OrderablePath> optimized_order; // To store our result in.
@@ -435,33 +712,25 @@ protected:
         const std::function<std::nullptr_t(const Path, const std::nullptr_t)> handle_node
             = [&current_position, &optimized_order, &order_requirements, &num_incoming_edges, this](const Path current_node, [[maybe_unused]] const std::nullptr_t state)
         {
-            // We should make map from node <-> path for this stuff
-            for (const auto& path : paths_)
+            const OrderablePath& path = *vertices_to_paths_.at(current_node);
+            if (path.is_closed_)
             {
-                if (path.vertices_ == current_node)
-                {
-                    if (path.is_closed_)
-                    {
-                        current_position = (*path.converted_)[path.start_vertex_]; // We end where we started.
-                    }
-                    else
-                    {
-                        // Pick the other end from where we started.
-                        current_position = path.start_vertex_ == 0 ? path.converted_->back() : path.converted_->front();
-                    }
-
-                    // Add to optimized order
-                    optimized_order.push_back(path);
+                current_position = (*path.converted_)[path.start_vertex_]; // We end where we started.
+            }
+            else
+            {
+                // Pick the other end from where we started.
+                current_position = path.start_vertex_ == 0 ? path.converted_->back() : path.converted_->front();
+            }
 
-                    // update incoming edges of neighbours since this path is handled
-                    const auto& [neighbour_begin, neighbour_end] = order_requirements.equal_range(path.vertices_);
-                    for (const auto& [_, neighbour] : ranges::make_subrange(neighbour_begin, neighbour_end))
-                    {
-                        num_incoming_edges.find(neighbour)->second--;
-                    }
+            // Add to optimized order
+            optimized_order.push_back(path);
 
-                    break;
-                }
+            // update incoming edges of neighbours since this path is handled
+            const auto& [neighbour_begin, neighbour_end] = order_requirements.equal_range(path.vertices_);
+            for (const auto& [_, neighbour] : ranges::make_subrange(neighbour_begin, neighbour_end))
+            {
+                num_incoming_edges.find(neighbour)->second--;
             }
 
             return nullptr;
@@ -554,20 +823,19 @@ protected:
         return reversed;
     }
 
-    Path findClosestPathVertices(Point2LL start_position, std::unordered_set<Path> candidate_paths)
+    Path findClosestPathVertices(const Point2LL& start_position, const std::unordered_set<Path>& candidate_paths)
     {
-        std::vector<OrderablePath*> candidate_orderable_paths;
-
-        for (auto& path : candidate_paths)
+        candidate_orderable_paths_.clear();
+        for (const Path& path : candidate_paths)
         {
-            candidate_orderable_paths.push_back(vertices_to_paths_.at(path));
+            candidate_orderable_paths_.push_back(vertices_to_paths_.at(path));
         }
 
-        OrderablePath* best_candidate = findClosestPath(start_position, candidate_orderable_paths);
+        OrderablePath* best_candidate = findClosestPath(start_position, candidate_orderable_paths_);
         return best_candidate->vertices_;
     }
 
-    OrderablePath* findClosestPath(Point2LL start_position, std::vector<OrderablePath*> candidate_paths)
+    OrderablePath* findClosestPath(const Point2LL& start_position, const std::vector<OrderablePath*>& candidate_paths)
     {
         coord_t best_distance2 = std::numeric_limits<coord_t>::max();
         OrderablePath* best_candidate = 0;
@@ -702,16 +970,14 @@ protected:
             return path.force_start_index_.value();
         }
 
-        // Precompute segments lengths because we are going to need them multiple times
-        std::vector<coord_t> segments_sizes(path.converted_->size());
-        coord_t total_length = 0;
-        for (size_t i = 0; i < path.converted_->size(); ++i)
+        // The corner angles only matter if there is a corner preference. Some paths have them computed in advance.
+        const bool use_corners = seam_config_.corner_pref_ != EZSeamCornerPrefType::Z_SEAM_CORNER_PREF_NONE;
+        std::vector<double> computed_corner_angles;
+        const std::vector<double>* corner_angles = use_corners ? path.getCornerAngles() : nullptr;
+        if (use_corners && corner_angles == nullptr)
         {
-            const Point2LL& here = path.converted_->at(i);
-            const Point2LL& next = path.converted_->at((i + 1) % path.converted_->size());
-            const coord_t segment_size = vSize(next - here);
-            segments_sizes[i] = segment_size;
-            total_length += segment_size;
+            computed_corner_angles = PolygonUtils::cornerAngles(*path.converted_);
+            corner_angles = &computed_corner_angles;
         }
 
         size_t best_i;
@@ -724,7 +990,7 @@ protected:
                                             ? MM2INT(10)
                                             : vSize2(here - target_pos);
 
-            double corner_angle = cornerAngle(path, i, segments_sizes, total_length);
+            const double corner_angle = use_corners ? (*corner_angles)[i] : 0.0;
             // angles < 0 are concave (left turning)
             // angles > 0 are convex (right turning)
 
@@ -803,84 +1069,6 @@ protected:
         return best_i;
     }
 
-    /*!
-     * Finds a neighbour point on the path, located before or after the given reference point. The neighbour point
-     * is computed by travelling on the path and stopping when the distance has been reached, For example:
-     * |------|---------|------|--------------*---|
-     * H      A         B      C              N   D
-     * In this case, H is the start point of the path and ABCD are the actual following points of the path.
-     * The neighbour point N is found by reaching point D then going a bit backward on the previous segment.
-     * This approach gets rid of the mesh actual resolution and gives a neighbour point that is on the path
-     * at a given physical distance.
-     * \param path The vertex data of a path
-     * \param here The starting point index
-     * \param distance The distance we want to travel on the path, which may be positive to go forward
-     * or negative to go backward
-     * \param segments_sizes The pre-computed sizes of the segments
-     * \return The position of the path a the given distance from the reference point
-     */
-    static Point2LL findNeighbourPoint(const OrderablePath& path, int here, coord_t distance, const std::vector<coord_t>& segments_sizes)
-    {
-        const int direction = distance > 0 ? 1 : -1;
-        const int size_delta = distance > 0 ? -1 : 0;
-        distance = std::abs(distance);
-
-        // Travel on the path until we reach the distance
-        int actual_delta = 0;
-        coord_t travelled_distance = 0;
-        coord_t segment_size = 0;
-        while (travelled_distance < distance)
-        {
-            actual_delta += direction;
-            segment_size = segments_sizes[(here + actual_delta + size_delta + path.converted_->size()) % path.converted_->size()];
-            travelled_distance += segment_size;
-        }
-
-        const Point2LL& next_pos = path.converted_->at((here + actual_delta + path.converted_->size()) % path.converted_->size());
-
-        if (travelled_distance > distance) [[likely]]
-        {
-            // We have overtaken the required distance, go backward on the last segment
-            int prev = (here + actual_delta - direction + path.converted_->size()) % path.converted_->size();
-            const Point2LL& prev_pos = path.converted_->at(prev);
-
-            const Point2LL vector = next_pos - prev_pos;
-            const Point2LL unit_vector = (vector * 1000) / segment_size;
-            const Point2LL vector_delta = unit_vector * (segment_size - (travelled_distance - distance));
-            return prev_pos + vector_delta / 1000;
-        }
-        else
-        {
-            // Luckily, the required distance stops exactly on an existing point
-            return next_pos;
-        }
-    }
-
-    /*!
-     * Some models have very sharp corners, but also have a high resolution. If a sharp corner
-     * consists of many points each point individual might have a shallow corner, but the
-     * collective angle of all nearby points is greater. To counter this the cornerAngle is
-     * calculated from two points within angle_query_distance of the query point, no matter
-     * what segment this leads us to
-     * \param path The vertex data of a path
-     * \param i index of the query point
-     * \param segments_sizes The pre-computed sizes of the segments
-     * \param total_length The path total length
-     * \param angle_query_distance query range (default to 1mm)
-     * \return angle between the reference point and the two sibling points, weighed to [-1.0 ; 1.0]
-     */
-    static double cornerAngle(const OrderablePath& path, int i, const std::vector<coord_t>& segments_sizes, coord_t total_length, const coord_t angle_query_distance = 1000)
-    {
-        const coord_t bounded_distance = std::min(angle_query_distance, total_length / 2);
-        const Point2LL& here = path.converted_->at(i);
-        const Point2LL next = findNeighbourPoint(path, i, bounded_distance, segments_sizes);
-        const Point2LL previous = findNeighbourPoint(path, i, -bounded_distance, segments_sizes);
-
-        double angle = LinearAlg2D::getAngleLeft(previous, here, next) - std::numbers::pi;
-
-        return angle / std::numbers::pi;
-    }
-
     /*!
      * Calculate the direct Euclidean distance to move from one point to
      * another.
@@ -904,6 +1092,26 @@ protected:
      * \return The combing distance between the two points.
      */
     coord_t getCombingDistance(const Point2LL& a, const Point2LL& b)
+    {
+        const auto cached = combing_distances_.find({ a, b });
+        if (cached != combing_distances_.end())
+        {
+            return cached->second;
+        }
+        if (combing_distances_.size() >= max_cached_combing_distances_)
+        {
+            combing_distances_.clear();
+        }
+        const coord_t distance = computeCombingDistance(a, b);
+        combing_distances_.emplace(std::make_pair(a, b), distance);
+        return distance;
+    }
+
+    /*!
+     * Calculate the combing distance between two points, without looking in
+     * the cache. See \ref getCombingDistance.
+     */
+    coord_t computeCombingDistance(const Point2LL& a, const Point2LL& b)
     {
         if (! PolygonUtils::polygonCollidesWithLineSegment(*combing_boundary_, a, b))
         {
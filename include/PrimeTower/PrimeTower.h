@@ -5,6 +5,9 @@
 #define PRIME_TOWER_H
 
 #include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "ExtruderUse.h"
@@ -44,10 +47,13 @@ protected:
         coord_t outer_radius;
     };
 
+    //! Toolpaths that are shared by all the layers that print the same pattern.
+    using SharedToolPaths = std::shared_ptr<const ClosedLinesSet>;
+
     struct ExtruderToolPaths
     {
         size_t extruder_nr;
-        ClosedLinesSet toolpaths;
+        SharedToolPaths toolpaths;
         coord_t outer_radius;
         coord_t inner_radius;
     };
@@ -75,6 +81,13 @@ private:
     //!< This is the approximate outline of the area filled at each layer, for layers having extra width for the base
     LayerVector<OccupiedOutline> base_occupied_outline_;
 
+    //! The prime toolpaths that were generated so far, by extruder and outer radius, with their inner radius.
+    std::map<std::tuple<size_t, coord_t>, std::tuple<SharedToolPaths, coord_t>> prime_toolpaths_cache_;
+    //! The support toolpaths that were generated so far, by extruder, outer radius and inner radius.
+    std::map<std::tuple<size_t, coord_t, coord_t>, SharedToolPaths> support_toolpaths_cache_;
+    //! The toolpaths that were joined so far, by the toolpaths they were joined from.
+    std::map<std::pair<const ClosedLinesSet*, const ClosedLinesSet*>, SharedToolPaths> joined_toolpaths_cache_;
+
     static constexpr size_t circle_definition_{ 32 }; // The number of vertices in each circle.
     static constexpr size_t arc_definition_{ 4 }; // The number of segments in each arc of a wheel
 
@@ -199,6 +212,29 @@ protected:
      */
     ClosedLinesSet generateSupportToolpaths(const size_t extruder_nr, const coord_t outer_radius, const coord_t inner_radius);
 
+    /*!
+     * \brief Get the priming toolpaths for the given extruder, starting at the given outer circle radius
+     *
+     * The toolpaths are only generated the first time they are asked for, so that all layers that prime the same
+     * extruder at the same radius share them.
+     * \return A tuple containing the toolpaths, and the inner radius of the annulus
+     */
+    std::tuple<SharedToolPaths, coord_t> getCachedPrimeToolpaths(const size_t extruder_nr, const coord_t outer_radius);
+
+    /*!
+     * \brief Get the support toolpaths for the given extruder on the given annulus
+     *
+     * Like \ref getCachedPrimeToolpaths, they are only generated the first time they are asked for.
+     */
+    SharedToolPaths getCachedSupportToolpaths(const size_t extruder_nr, const coord_t outer_radius, const coord_t inner_radius);
+
+    /*!
+     * \brief Get the toolpaths of \p first followed by those of \p second
+     *
+     * Joining the same toolpaths again gives the same shared result.
+     */
+    SharedToolPaths getJoinedToolpaths(const SharedToolPaths& first, const SharedToolPaths& second);
+
     /*!
      * \brief Calculates whether an extruder requires priming at a specific layer
      * \param extruder_is_used_on_this_layer The list of used extruders at this layer
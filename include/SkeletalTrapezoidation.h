@@ -152,6 +152,8 @@ protected:
     std::unordered_map<vd_t::edge_type*, edge_t*> vd_edge_to_he_edge_;
     std::unordered_map<vd_t::vertex_type*, node_t*> vd_node_to_he_node_;
 
+    std::vector<Point2LL> discretization_buffer_; //!< Reused by every edge in \ref transferEdge, so that discretizing an edge doesn't allocate.
+
     /*!
      * Compute the skeletal trapezoidation decomposition of the input shape.
      *
@@ -212,10 +214,11 @@ protected:
      * \param points All vertices of the original Polygons to fill with beads.
      * \param segments All line segments of the original Polygons to fill with
      * beads.
-     * \return A number of coordinates along the edge where the edge is broken
-     * up into discrete pieces.
+     * \param[out] discretized Receives the coordinates along the edge where the
+     * edge is broken up into discrete pieces. Anything that was in it before is
+     * removed.
      */
-    std::vector<Point2LL> discretize(const vd_t::edge_type& segment, const std::vector<Point2LL>& points, const std::vector<Segment>& segments);
+    void discretize(const vd_t::edge_type& segment, const std::vector<Point2LL>& points, const std::vector<Segment>& segments, std::vector<Point2LL>& discretized);
 
     /*!
      * Compute the range of line segments that surround a cell of the skeletal
@@ -0,0 +1,55 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_SKINOUTLINECACHE_H
+#define CURAENGINE_SKINOUTLINECACHE_H
+
+#include "geometry/Shape.h"
+#include "settings/types/LayerIndex.h"
+#include "utils/LayerRangeTree.h"
+
+namespace cura
+{
+
+class SliceMeshStorage;
+
+/*!
+ * Remembers the intersections of the outlines of ranges of layers of one mesh,
+ * which the skins of neighbouring layers all need.
+ *
+ * The skin of a layer is where the outlines of the layers above or below don't
+ * all overlap, so every layer intersects the outlines of the same number of
+ * layers, most of which the next layer intersects as well. This keeps the
+ * intersections of the layers in the ranges of a segment tree. The
+ * intersection of any range of layers is then made from a few of those,
+ * independent of how many layers it covers, and each of them is only
+ * computed once for all layers that need it.
+ *
+ * The intersections are computed when they are first asked for, so the walls
+ * of all the layers in a range must have been generated before, since they
+ * simplify the outlines. It's safe to use from the threads that generate the
+ * skins of different layers at the same time.
+ */
+class SkinOutlineCache
+{
+public:
+    /*!
+     * \param mesh The mesh of which to intersect the outlines.
+     */
+    explicit SkinOutlineCache(const SliceMeshStorage& mesh);
+
+    /*!
+     * Get the intersection of the outlines of all parts on the layers from
+     * \p first up to and including \p last.
+     *
+     * Layers above the mesh have no outlines, so if \p last is above the top
+     * of the mesh the intersection is empty.
+     */
+    Shape intersection(LayerIndex first, LayerIndex last);
+
+private:
+    LayerRangeTree<Shape> tree_; //!< The intersections of the outlines of ranges of layers.
+};
+
+} // namespace cura
+#endif // CURAENGINE_SKINOUTLINECACHE_H
@@ -4,6 +4,7 @@
 #ifndef SKIRT_BRIM_H
 #define SKIRT_BRIM_H
 
+#include <optional>
 #include <variant>
 
 #include "ExtruderTrain.h"
@@ -55,6 +56,7 @@ private:
         int inset_idx_; //!< The outset index of this brimline
         size_t extruder_nr_; //!< The extruder by which to print this brim line
         bool is_last_; //!< Whether this is the last planned offset for this extruder.
+        std::optional<Shape> reference_offset_; //!< The simplified offset of the reference outline, if it was computed in advance.
     };
 
     /*!
@@ -185,6 +187,23 @@ private:
      */
     coord_t generateOffset(const Offset& offset, Shape& covered_area, std::vector<Shape>& allowed_areas_per_extruder, MixedLinesSet& result);
 
+    /*!
+     * Offset the reference outline of each of the \p offsets that has one, and store it in the offset.
+     *
+     * Unlike the offsets from a previous brim line, these only depend on the reference outline and the distance, so they are all
+     * computed at once, in parallel.
+     *
+     * \param[in,out] offsets The offsets to compute the offsets of the reference outlines for.
+     */
+    void offsetReferenceOutlines(std::vector<Offset>& offsets) const;
+
+    /*!
+     * Offset one polygon of the reference outline of \p offset.
+     *
+     * \return The offset polygon, or nothing if the offset doesn't apply to this side of the polygon.
+     */
+    static Shape offsetReferencePolygon(const Offset& offset, const Polygon& polygon);
+
     /*!
      * Generate a skirt of extruders which don't yet comply with the minimum length requirement.
      *
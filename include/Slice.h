@@ -33,6 +33,14 @@ public:
      *
      * The g-code output is sent through the currently active communication
      * channel.
+     *
+     * The mesh groups are processed one after another. They can't overlap,
+     * since the settings of the extruders inherit from the mesh group that is
+     * being processed (see Scene::current_mesh_group), and much of the
+     * polygon generation looks up the mesh group settings through it as well.
+     * The g-code writer also carries the state of the printer over from one
+     * mesh group to the next, like the temperatures and the position. Within a
+     * mesh group, the layers are processed in parallel.
      */
     void compute();
 
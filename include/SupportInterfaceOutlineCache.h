@@ -0,0 +1,54 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_SUPPORTINTERFACEOUTLINECACHE_H
+#define CURAENGINE_SUPPORTINTERFACEOUTLINECACHE_H
+
+#include "geometry/Shape.h"
+#include "settings/types/LayerIndex.h"
+#include "utils/LayerRangeTree.h"
+
+namespace cura
+{
+
+class SliceMeshStorage;
+
+/*!
+ * Remembers the unions of the outlines of ranges of layers of one mesh, which
+ * the support roofs and bottoms of neighbouring layers all need.
+ *
+ * The interface of a support layer is where its support is close to the model
+ * a number of layers above or below it, so every layer unites the outlines of
+ * the same number of layers, most of which the next layer unites as well. Like
+ * the SkinOutlineCache, this keeps the unions of the layers in the ranges of a
+ * segment tree. The union of any range of layers is then made from a few of
+ * those, independent of how thick the interface is, and each of them is only
+ * computed once for all support layers that need it.
+ *
+ * The unions are computed when they are first asked for. It's safe to use from
+ * the threads that generate the interface of different layers at the same
+ * time.
+ */
+class SupportInterfaceOutlineCache
+{
+public:
+    /*!
+     * \param mesh The mesh of which to unite the outlines.
+     */
+    explicit SupportInterfaceOutlineCache(const SliceMeshStorage& mesh);
+
+    /*!
+     * Get the union of the outlines of the layers from \p first up to and
+     * including \p last.
+     *
+     * The layers outside of the mesh have no outlines, so they don't add
+     * anything to the union.
+     */
+    Shape unionOf(LayerIndex first, LayerIndex last);
+
+private:
+    LayerRangeTree<Shape> tree_; //!< The unions of the outlines of ranges of layers.
+};
+
+} // namespace cura
+#endif // CURAENGINE_SUPPORTINTERFACEOUTLINECACHE_H
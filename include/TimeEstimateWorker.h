@@ -0,0 +1,116 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef TIME_ESTIMATE_WORKER_H
+#define TIME_ESTIMATE_WORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "timeEstimate.h"
+#include "utils/NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Computes the time estimates of layers, optionally on a background
+ * thread.
+ *
+ * It takes the same calls as a \ref TimeEstimateCalculator. Each call to
+ * \ref endLayer calculates the time of everything planned since the previous
+ * one, and resets the calculator for the next layer.
+ *
+ * Until \ref startThread is called, all of this happens right away. After
+ * that, the calls are recorded and the layers are replayed on a background
+ * thread in order, on a single calculator. Since the state that carries over
+ * from one layer to the next (the position, the speed of the last move, the
+ * acceleration and jerk) is replayed exactly as it would have been applied,
+ * the estimates are identical either way. They just become available later.
+ */
+class TimeEstimateWorker : public NoCopy
+{
+public:
+    //! Stops the background thread, if it was started. Layers that haven't been estimated yet are dropped.
+    ~TimeEstimateWorker();
+
+    /*!
+     * \brief From now on, estimate the layers on a background thread.
+     */
+    void startThread();
+
+    /*!
+     * \brief Whether the layers are estimated on a background thread.
+     */
+    bool isThreaded() const;
+
+    void setFirmwareDefaults(const Settings& settings);
+    void setLookahead(const size_t lookahead);
+    void plan(const TimeEstimateCalculator::Position& new_position, const Velocity& feedrate, const PrintFeatureType feature);
+    void addTime(const Duration& time);
+    void setAcceleration(const Acceleration& acceleration);
+    void setMaxXyJerk(const Velocity& jerk);
+    void reset();
+
+    /*!
+     * \brief End the current layer, so that its time gets estimated.
+     */
+    void endLayer();
+
+    /*!
+     * \brief Get the estimate of the oldest layer that hasn't been taken yet.
+     * \param wait Whether to wait for the estimate if it isn't done yet.
+     * \return The estimated time per feature, or nothing if there are no layers
+     * left, or if \p wait is false and the estimate isn't done yet.
+     */
+    std::optional<std::vector<Duration>> takeEstimate(const bool wait);
+
+private:
+    //! A recorded call to the calculator.
+    struct Command
+    {
+        enum class Type
+        {
+            SET_FIRMWARE_DEFAULTS,
+            SET_LOOKAHEAD,
+            PLAN,
+            ADD_TIME,
+            SET_ACCELERATION,
+            SET_MAX_XY_JERK,
+            RESET,
+        };
+
+        Type type;
+        double value = 0.0; //!< The feedrate, time, acceleration, jerk or lookahead, depending on the type.
+        TimeEstimateCalculator::Position position{};
+        PrintFeatureType feature = PrintFeatureType::NoneType;
+        const Settings* settings = nullptr; //!< Settings outlive the slice, so they don't need to be copied.
+    };
+
+    //! Record a call, or apply it right away if there is no background thread.
+    void record(Command&& command);
+
+    void apply(const Command& command);
+
+    //! What the background thread does: estimate the layers in order, until it's stopped.
+    void estimateLayers();
+
+    TimeEstimateCalculator calculator_; //!< Only used by the background thread once it runs.
+    std::vector<Command> current_layer_; //!< The calls since the last layer ended.
+
+    std::mutex mutex_;
+    std::condition_variable condition_; //!< Notified when a layer is given to or estimated by the background thread, and when stopping.
+    std::deque<std::vector<Command>> pending_layers_; //!< Layers that the background thread hasn't started on yet.
+    std::deque<std::vector<Duration>> estimates_; //!< Estimated layers that haven't been taken yet, in order.
+    size_t layers_in_progress_ = 0; //!< Layers that have ended, but whose estimate isn't done yet.
+    bool stopping_ = false;
+    std::thread worker_;
+};
+
+} // namespace cura
+
+#endif // TIME_ESTIMATE_WORKER_H
@@ -5,7 +5,10 @@
 #define TOPSURFACE_H
 
 #include "GCodePathConfig.h"
+#include "geometry/OpenLinesSet.h"
 #include "geometry/Shape.h"
+#include "settings/types/LayerIndex.h"
+#include "utils/ExtrusionLine.h"
 
 namespace cura
 {
@@ -42,7 +45,17 @@ public:
      *
      * This generates an infill pattern over the top surface that is supposed to
      * strike the surface smooth by melting it with the hot nozzle and filling
-     * crevices with a minute amount of material.
+     * crevices with a minute amount of material. The paths are stored, so that
+     * \ref ironing only needs to add them to the layer.
+     *
+     * \param mesh The settings base to get our ironing settings and skin angles
+     * from.
+     * \param layer_nr The layer of this top surface.
+     */
+    void generateIroning(const SliceMeshStorage& mesh, const LayerIndex layer_nr);
+
+    /*!
+     * \brief Add the paths for ironing over the top surface to a layer.
      *
      * \param storage The slice data storage in the highly unlikely case that printing the ironing requires printing a brim just before it
      * \param mesh The settings base to get our ironing settings and skin angles
@@ -59,6 +72,11 @@ public:
      * \brief The areas of top surface, for each layer.
      */
     Shape areas;
+
+    Shape ironed_areas; //!< The top surface inset by the ironing inset, in which the ironing paths are generated.
+    std::vector<VariableWidthLines> ironing_paths; //!< The ironing paths of the concentric pattern.
+    Shape ironing_polygons; //!< The closed ironing lines.
+    OpenLinesSet ironing_lines; //!< The open ironing lines.
 };
 
 } // namespace cura
@@ -5,6 +5,7 @@
 #define TREEMODELVOLUMES_H
 
 #include <future>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <unordered_map>
@@ -15,6 +16,7 @@
 #include "settings/EnumSettings.h" //To store whether X/Y or Z distance gets priority.
 #include "settings/types/LayerIndex.h" //Part of the RadiusLayerPair.
 #include "utils/PairHash.h"
+#include "utils/RadiusLayerCache.h"
 #include "utils/Simplify.h"
 
 namespace cura
@@ -34,6 +36,9 @@ class Settings;
 class TreeModelVolumes
 {
 public:
+    //! The outlines of the model per layer, grouped by meshes with identical settings, together with those settings.
+    using LayerOutlines = std::vector<std::pair<Settings, std::vector<Shape>>>;
+
     TreeModelVolumes() = default;
     TreeModelVolumes(
         const SliceDataStorage& storage,
@@ -43,7 +48,8 @@ public:
         size_t current_mesh_idx,
         double progress_multiplier,
         double progress_offset,
-        const std::vector<Shape>& additional_excluded_areas = std::vector<Shape>());
+        const std::vector<Shape>& additional_excluded_areas = std::vector<Shape>(),
+        std::shared_ptr<const LayerOutlines> layer_outlines = nullptr);
     TreeModelVolumes(TreeModelVolumes&&) = default;
     TreeModelVolumes& operator=(TreeModelVolumes&&) = default;
 
@@ -59,6 +65,29 @@ public:
      */
     void precalculate(coord_t max_layer);
 
+    /*!
+     * \brief Free the avoidances and wall restrictions above a layer.
+     *
+     * The influence areas are grown strictly top-down, and only need these for
+     * the layer that is being grown and the one below it. Freeing the rest
+     * keeps the memory use bounded on tall prints. Collisions, placeable areas
+     * and the collision avoidance are kept, as they are needed again when the
+     * branches are drawn. Freed areas are recalculated if they're requested
+     * again.
+     *
+     * Must not be called while other threads request areas above the layer.
+     * \param layer_idx The highest layer to keep.
+     */
+    void evictAvoidancesAbove(LayerIndex layer_idx);
+
+    /*!
+     * \brief The outlines of the model, to construct the volumes of other support tree mesh groups with.
+     */
+    std::shared_ptr<const LayerOutlines> getLayerOutlines() const
+    {
+        return layer_outlines_;
+    }
+
     /*!
      * \brief Provides the areas that have to be avoided by the tree's branches to prevent collision with the model on this layer.
      *
@@ -332,25 +361,8 @@ private:
         calculateWallRestrictions(std::deque<RadiusLayerPair>{ RadiusLayerPair(key) });
     }
 
-    /*!
-     * \brief Checks a cache for a given RadiusLayerPair and returns it if it is found
-     * \param key RadiusLayerPair of the requested areas. The radius will be calculated up to the provided layer.
-     * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
-     */
-    template<typename KEY>
-    const std::optional<std::reference_wrapper<const Shape>> getArea(const std::unordered_map<KEY, Shape>& cache, const KEY key) const;
-
     bool checkSettingsEquality(const Settings& me, const Settings& other) const;
 
-    /*!
-     * \brief Get the highest already calculated layer in the cache.
-     * \param radius The radius for which the highest already calculated layer has to be found.
-     * \param map The cache in which the lookup is performed.
-     *
-     * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
-     */
-    LayerIndex getMaxCalculatedLayer(coord_t radius, const std::unordered_map<RadiusLayerPair, Shape>& map) const;
-
     static Shape calculateMachineBorderCollision(const Shape&& machine_border);
 
     /*!
@@ -440,8 +452,10 @@ private:
 
     /*!
      * \brief Storage for layer outlines and the corresponding settings of the meshes grouped by meshes with identical setting.
+     *
+     * These don't depend on which meshes are being supported, so they are shared with the volumes of the other support tree mesh groups.
      */
-    std::vector<std::pair<Settings, std::vector<Shape>>> layer_outlines_;
+    std::shared_ptr<const LayerOutlines> layer_outlines_;
 
     /*!
      * \brief Storage for areas that should be avoided, like support blocker or previous generated trees.
@@ -471,54 +485,44 @@ private:
      * generally considered OK as the functions are still logically const
      * (ie there is no difference in behaviour for the user between
      * calculating the values each time vs caching the results).
+     *
+     * They can be read without locking, so that the getters don't serialise
+     * the threads that grow the trees.
      */
-    mutable std::unordered_map<RadiusLayerPair, Shape> collision_cache_;
-    std::unique_ptr<std::mutex> critical_collision_cache_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache collision_cache_;
 
-    mutable std::unordered_map<RadiusLayerPair, Shape> collision_cache_holefree_;
-    std::unique_ptr<std::mutex> critical_collision_cache_holefree_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache collision_cache_holefree_;
 
-    mutable std::unordered_map<LayerIndex, Shape> accumulated_placeables_cache_radius_0_;
-    std::unique_ptr<std::mutex> critical_accumulated_placeables_cache_radius_0_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache accumulated_placeables_cache_radius_0_;
 
-    mutable std::unordered_map<RadiusLayerPair, Shape> avoidance_cache_collision_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_collision_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache avoidance_cache_collision_;
 
-    mutable std::unordered_map<RadiusLayerPair, Shape> avoidance_cache_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache avoidance_cache_;
 
-    mutable std::unordered_map<RadiusLayerPair, Shape> avoidance_cache_slow_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_slow_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache avoidance_cache_slow_;
 
-    mutable std::unordered_map<RadiusLayerPair, Shape> avoidance_cache_to_model_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_to_model_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache avoidance_cache_to_model_;
 
-    mutable std::unordered_map<RadiusLayerPair, Shape> avoidance_cache_to_model_slow_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_to_model_slow_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache avoidance_cache_to_model_slow_;
 
-    mutable std::unordered_map<RadiusLayerPair, Shape> placeable_areas_cache_;
-    std::unique_ptr<std::mutex> critical_placeable_areas_cache_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache placeable_areas_cache_;
 
     /*!
      * \brief Caches to avoid holes smaller than the radius until which the radius is always increased, as they are free of holes. Also called safe avoidances, as they are safe
      * regarding not running into holes.
      */
-    mutable std::unordered_map<RadiusLayerPair, Shape> avoidance_cache_hole_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_holefree_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache avoidance_cache_hole_;
 
-    mutable std::unordered_map<RadiusLayerPair, Shape> avoidance_cache_hole_to_model_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_holefree_to_model_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache avoidance_cache_hole_to_model_;
 
     /*!
      * \brief Caches to represent walls not allowed to be passed over.
      */
-    mutable std::unordered_map<RadiusLayerPair, Shape> wall_restrictions_cache_;
-    std::unique_ptr<std::mutex> critical_wall_restrictions_cache_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache wall_restrictions_cache_;
 
     // A different cache for min_xy_dist as the maximal safe distance an influence area can be increased(guaranteed overlap of two walls in consecutive layer) is much smaller when
     // min_xy_dist is used. This causes the area of the wall restriction to be thinner and as such just using the min_xy_dist wall restriction would be slower.
-    mutable std::unordered_map<RadiusLayerPair, Shape> wall_restrictions_cache_min_;
-    std::unique_ptr<std::mutex> critical_wall_restrictions_cache_min_ = std::make_unique<std::mutex>();
+    mutable RadiusLayerCache wall_restrictions_cache_min_;
 
     std::unique_ptr<std::mutex> critical_progress_ = std::make_unique<std::mutex>();
 
@@ -15,10 +15,13 @@
 #include "settings/EnumSettings.h"
 #include "sliceDataStorage.h"
 #include "utils/Coord_t.h"
+#include "utils/gettime.h"
 
 namespace cura
 {
 
+class TreeSupportTipGenerator;
+
 // The various stages of the process can be weighted differently in the progress bar.
 // These weights are obtained experimentally using a small sample size. Sensible weights can differ drastically based on the assumed default settings and model.
 constexpr auto TREE_PROGRESS_TOTAL = 10000;
@@ -92,6 +95,16 @@ public:
      */
     void generateSupportAreas(SliceDataStorage& storage);
 
+    /*!
+     * \brief The time spent in each stage of generating the support trees.
+     *
+     * There is an entry for every stage of every support tree mesh group that
+     * was processed, in the order they were processed in.
+     */
+    const TimeKeeper::RegisteredTimes& getStageTimes() const
+    {
+        return stage_times_.getRegisteredTimes();
+    }
 
 private:
     /*!
@@ -109,11 +122,12 @@ private:
      *
      * Generates Points where the Model should be supported and creates the areas where these points have to be placed.
      *
+     * \param tip_gen[in] The tip generator set up for this mesh.
      * \param mesh[in] The mesh that is currently processed.
      * \param move_bounds[out] Storage for the influence areas.
      * \param storage[in] Background storage, required for adding roofs.
      */
-    void generateInitialAreas(const SliceMeshStorage& mesh, std::vector<std::set<TreeSupportElement*>>& move_bounds, SliceDataStorage& storage);
+    void generateInitialAreas(TreeSupportTipGenerator& tip_gen, const SliceMeshStorage& mesh, std::vector<std::set<TreeSupportElement*>>& move_bounds, SliceDataStorage& storage);
 
 
     /*!
@@ -159,6 +173,37 @@ private:
      */
     void mergeInfluenceAreas(PropertyAreasUnordered& to_bp_areas, PropertyAreas& to_model_areas, PropertyAreas& influence_areas, LayerIndex layer_idx);
 
+    /*!
+     * \brief Areas calculated by increaseSingleArea that the next settings tried for the same element may need again.
+     *
+     * Consecutive settings often only differ in whether the radius is increased, which mostly leaves the moved area and the ceiled radius of the avoidance the same.
+     */
+    struct AreaIncreaseCache
+    {
+        //! An area moved by increaseSingleArea.
+        struct MovedArea
+        {
+            const Shape* from; //!< The area it was moved from.
+            coord_t overspeed; //!< How far it was offset again.
+            coord_t radius; //!< The collision radius it was offset again for, or 0 if it wasn't.
+            Shape area;
+        };
+
+        //! The part of a moved area outside of an avoidance.
+        struct OutsideAvoidance
+        {
+            size_t moved_idx; //!< Which of the moved areas.
+            coord_t ceiled_radius;
+            AvoidanceType type;
+            bool to_model;
+            bool min_xy_dist;
+            Shape area;
+        };
+
+        std::vector<MovedArea> moved;
+        std::vector<OutsideAvoidance> outside_avoidance;
+    };
+
     /*!
      * \brief Checks if an influence area contains a valid subsection and returns the corresponding metadata and the new Influence area.
      *
@@ -180,6 +225,8 @@ private:
      * user-supplied settings. \param overspeed[in] How much should the already offset area be offset again. Usually this is 0. \param mergelayer[in] Will the merge method be
      * called on this layer. This information is required as some calculation can be avoided if they are not required for merging. \return A valid support element for the next
      * layer regarding the calculated influence areas. Empty if no influence are can be created using the supplied influence area and settings.
+     * \param cache[in,out] Areas calculated for the same parent with earlier settings. Only used for settings without error, as those get an offset that stays the same for
+     * all settings.
      */
     std::optional<TreeSupportElement> increaseSingleArea(
         AreaIncreaseSettings settings,
@@ -190,7 +237,8 @@ private:
         Shape& to_model_data,
         Shape& increased,
         const coord_t overspeed,
-        const bool mergelayer);
+        const bool mergelayer,
+        AreaIncreaseCache& cache);
 
     /*!
      * \brief Increases influence areas as far as required.
@@ -331,6 +379,16 @@ private:
      */
     TreeModelVolumes volumes_;
 
+    /*!
+     * \brief Owner of all elements of the support tree mesh group that is being processed.
+     */
+    TreeSupportElementArena element_arena_;
+
+    /*!
+     * \brief Measures the time spent in the stages of generateSupportAreas and drawAreas.
+     */
+    TimeKeeper stage_times_;
+
     /*!
      * \brief Contains config settings to avoid loading them in every function. This was done to improve readability of the code.
      */
@@ -2,7 +2,9 @@
 #ifndef TREESUPPORTELEMENT_H
 #define TREESUPPORTELEMENT_H
 
+#include <deque>
 #include <map>
+#include <mutex>
 #include <unordered_map>
 
 #include <boost/container_hash/hash.hpp>
@@ -440,6 +442,41 @@ struct TreeSupportElement
     }
 };
 
+/*!
+ * \brief Owns the elements of a support tree mesh group.
+ *
+ * The elements are allocated in blocks and all freed at once when the group is done, rather than being allocated and deleted one by one. Their addresses stay the same for as
+ * long as the arena exists, so they can be referred to as parents of other elements and be put in the sets of move_bounds.
+ */
+class TreeSupportElementArena
+{
+public:
+    /*!
+     * \brief Construct a new element. Can be called from multiple threads at once.
+     * \param args The arguments of the constructor of the element.
+     * \return The new element, which lives until the arena is cleared.
+     */
+    template<typename... Args>
+    TreeSupportElement* emplace(Args&&... args)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return &elements_.emplace_back(std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief Free all elements. The areas of the elements are not owned by the arena, so these need to be deleted beforehand.
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        elements_.clear();
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<TreeSupportElement> elements_;
+};
+
 } // namespace cura
 
 namespace std
@@ -26,7 +26,7 @@ namespace cura
 class TreeSupportTipGenerator
 {
 public:
-    TreeSupportTipGenerator(const SliceMeshStorage& mesh, TreeModelVolumes& volumes_);
+    TreeSupportTipGenerator(const SliceMeshStorage& mesh, TreeModelVolumes& volumes_, TreeSupportElementArena& element_arena);
 
     /*!
      * \brief Generate tips, that will later form branches
@@ -58,6 +58,48 @@ private:
 
     using LineInformation = std::vector<std::pair<Point2LL, TreeSupportTipGenerator::LineStatus>>;
 
+    /*!
+     * \brief A connected part of an overhang, for which tips are generated independently of the other parts.
+     */
+    struct OverhangRegion
+    {
+        LayerIndex layer_idx_; //!< The layer the tips of the region are placed on.
+        Shape area_;
+        bool supports_roof_; //!< Whether the region is a roof, that the tips only have to support.
+        bool insert_below_; //!< Whether the region isn't supported on its own layer, so the tips are placed on the layers below it. Only when X/Y overrides Z.
+    };
+
+    /*!
+     * \brief A tip that is going to be added, with the area it starts with.
+     */
+    struct TipCandidate
+    {
+        Point2LL location_;
+        bool to_bp_;
+        bool gracious_;
+        bool safe_radius_;
+        size_t dtt_;
+        LayerIndex insert_layer_;
+        size_t dont_move_until_;
+        bool roof_;
+        bool skip_ovalisation_;
+        std::vector<Point2LL> additional_ovalization_targets_;
+        Shape area_;
+    };
+
+    /*!
+     * \brief The tips and roof areas generated for an overhang region.
+     *
+     * The regions are generated in parallel, but their results are only added to the tips and roofs afterwards, in the order of the regions. Which of two tips that are too
+     * close together is kept then doesn't depend on which thread was first.
+     */
+    struct GeneratedTips
+    {
+        std::vector<TipCandidate> tips_;
+        std::vector<std::pair<LayerIndex, Shape>> roof_tips_; //!< Areas to add to roof_tips_drawn_.
+        std::vector<std::pair<LayerIndex, Shape>> fractional_roofs_; //!< Areas to add to support_roof_drawn_fractional_.
+    };
+
     /*!
      * \brief Converts a Polygons object representing a line into the internal format.
      *
@@ -133,7 +175,7 @@ private:
 
     /*!
      * \brief Add a point as a tip
-     * \param move_bounds[out] The storage for the tips.
+     * \param generated[out] The tips of the region that is currently processed.
      * \param p[in] The point that will be added and its LineStatus.
      * \param dtt[in] The distance to top the added tip will have.
      * \param insert_layer[in] The layer the tip will be on.
@@ -142,7 +184,7 @@ private:
      * \param skip_ovalisation[in] Whether the tip may be ovalized when drawn later.
      */
     void addPointAsInfluenceArea(
-        std::vector<std::set<TreeSupportElement*>>& move_bounds,
+        GeneratedTips& generated,
         std::pair<Point2LL, LineStatus> p,
         size_t dtt,
         LayerIndex insert_layer,
@@ -154,7 +196,7 @@ private:
 
     /*!
      * \brief Add all points of a line as a tip
-     * \param move_bounds[out] The storage for the tips.
+     * \param generated[out] The tips and roofs of the region that is currently processed.
      * \param lines[in] The lines of which points will be added.
      * \param roof_tip_layers[in] Amount of layers the tip should be drawn as roof.
      * \param insert_layer_idx[in] The layer the tip will be on.
@@ -162,7 +204,7 @@ private:
      * \param dont_move_until[in] Until which dtt the branch should not move if possible.
      */
     void addLinesAsInfluenceAreas(
-        std::vector<std::set<TreeSupportElement*>>& move_bounds,
+        GeneratedTips& generated,
         std::vector<TreeSupportTipGenerator::LineInformation> lines,
         size_t roof_tip_layers,
         LayerIndex insert_layer_idx,
@@ -170,6 +212,29 @@ private:
         size_t dont_move_until,
         bool connect_points);
 
+    /*!
+     * \brief Generate the tips for a connected part of an overhang.
+     * \param region[in] The part of the overhang.
+     * \param relevant_forbidden[in] Where the tips can't be placed on the layer of the region.
+     * \return The tips and roofs of the region, to be added with insertTips.
+     */
+    GeneratedTips generateRegionTips(const OverhangRegion& region, const Shape& relevant_forbidden);
+
+    /*!
+     * \brief Add the tips and roofs that were generated for a region, skipping tips that are too close to tips that were added before.
+     * \param generated[in] The tips and roofs of the region.
+     * \param move_bounds[out] The storage for the tips.
+     */
+    void insertTips(GeneratedTips& generated, std::vector<std::set<TreeSupportElement*>>& move_bounds);
+
+    /*!
+     * \brief Generate support lines in an area, with the distance between the lines for tips.
+     * \param area[in] The area to fill.
+     * \param roof[in] Whether the area is a roof.
+     * \param generate_layer_idx[in] The layer the lines are generated for.
+     */
+    OpenLinesSet generateTipLines(const Shape& area, bool roof, LayerIndex generate_layer_idx) const;
+
     /*!
      * \brief Remove tips that should not have been added in the first place.
      * \param move_bounds[in,out] The already added tips
@@ -193,6 +258,11 @@ private:
      */
     TreeModelVolumes& volumes_;
 
+    /*!
+     * \brief Owner of the tips that are generated.
+     */
+    TreeSupportElementArena& element_arena_;
+
     /*!
      * \brief Minimum area an overhang has to have to be supported.
      */
@@ -309,9 +379,6 @@ private:
      * \brief Areas that will be saved as support roof, originating from tips being replaced with roof areas.
      */
     std::vector<Shape> roof_tips_drawn_;
-
-    std::mutex critical_move_bounds_;
-    std::mutex critical_roof_tips_;
 };
 
 } // namespace cura
@@ -0,0 +1,96 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_WALLTOOLPATHSCACHE_H
+#define CURAENGINE_WALLTOOLPATHSCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "geometry/Shape.h"
+#include "utils/Coord_t.h"
+#include "utils/ExtrusionLine.h"
+#include "utils/section_type.h"
+
+namespace cura
+{
+
+/*!
+ * Remembers the walls generated for the outlines of one mesh, so that layers
+ * with exactly the same outline don't have to generate them again.
+ *
+ * Prismatic models have the same outline on many layers, and generating walls
+ * is the most expensive part of slicing them. The walls only depend on the
+ * outline, the line widths, the wall count, the inset of the outer wall and the
+ * section type, since any other settings that are used come from the mesh and
+ * are the same for all layers. A cache is only valid for the settings of one
+ * mesh.
+ *
+ * It's safe to use from the threads that generate the walls of different
+ * layers at the same time.
+ */
+class WallToolPathsCache
+{
+public:
+    //! The parameters, besides the outline, that the walls depend on.
+    struct Parameters
+    {
+        coord_t line_width_0;
+        coord_t line_width_x;
+        size_t wall_count;
+        coord_t wall_0_inset;
+        SectionType section_type;
+
+        bool operator==(const Parameters&) const = default;
+    };
+
+    //! The walls generated for an outline.
+    struct Walls
+    {
+        std::vector<VariableWidthLines> toolpaths;
+        Shape inner_contour;
+    };
+
+    /*!
+     * \param max_entries How many different outlines to remember at most.
+     */
+    explicit WallToolPathsCache(size_t max_entries = 64);
+
+    /*!
+     * Get the walls that were generated before for an identical outline.
+     * \param outline The outline to generate walls for.
+     * \param parameters The other inputs of the wall generation.
+     * \return The walls, or nothing if they weren't generated before.
+     */
+    std::optional<Walls> find(const Shape& outline, const Parameters& parameters) const;
+
+    /*!
+     * Remember the walls generated for an outline. If the cache is full, the
+     * outline that was stored the longest ago is forgotten.
+     */
+    void store(const Shape& outline, const Parameters& parameters, const Walls& walls);
+
+private:
+    struct Entry
+    {
+        Shape outline;
+        Parameters parameters;
+        Walls walls;
+    };
+
+    static uint64_t hash(const Shape& outline, const Parameters& parameters);
+    static bool isSameOutline(const Shape& a, const Shape& b);
+
+    size_t max_entries_;
+    mutable std::mutex mutex_;
+    std::list<std::shared_ptr<const Entry>> order_; //!< Oldest entries first, for eviction.
+    std::unordered_multimap<uint64_t, std::shared_ptr<const Entry>> entries_;
+};
+
+} // namespace cura
+#endif // CURAENGINE_WALLTOOLPATHSCACHE_H
@@ -4,6 +4,7 @@
 #ifndef WALLS_COMPUTATION_H
 #define WALLS_COMPUTATION_H
 
+#include "WallToolPathsCache.h"
 #include "settings/Settings.h"
 #include "settings/types/LayerIndex.h"
 #include "utils/Coord_t.h"
@@ -27,8 +28,11 @@ public:
      *
      * \param settings The per-mesh settings object to get setting values from.
      * \param layer_nr The layer index that these walls are generated for.
+     * \param cache Walls generated for the other layers of the same mesh, to
+     * reuse if a part has exactly the same outline. Can be nullptr to always
+     * generate the walls.
      */
-    WallsComputation(const Settings& settings, const LayerIndex layer_nr);
+    WallsComputation(const Settings& settings, const LayerIndex layer_nr, WallToolPathsCache* cache = nullptr);
 
     /*!
      * \brief Generates the walls / inner area for all parts in a layer.
@@ -52,6 +56,11 @@ private:
      */
     const LayerIndex layer_nr_;
 
+    /*!
+     * \brief Walls generated for other layers of the same mesh, if any.
+     */
+    WallToolPathsCache* cache_;
+
     /*!
      * Generates the walls / inner area for a single layer part.
      *
@@ -59,6 +68,21 @@ private:
      */
     void generateWalls(SliceLayerPart* part, SectionType section);
 
+    /*!
+     * Generates the wall toolpaths and inner area of a single layer part, or
+     * reuses them from a layer with the same outline.
+     */
+    void generateWallToolPaths(SliceLayerPart* part, coord_t line_width_0, coord_t line_width_x, size_t wall_count, coord_t wall_0_inset, SectionType section_type);
+
+    /*!
+     * Computes the corner angles of the closed walls in advance, if the seams
+     * are going to be placed in corners.
+     *
+     * Otherwise they would be computed while writing the g-code, which goes
+     * through the layers in order.
+     */
+    void computeCornerAngles(std::vector<VariableWidthLines>& toolpaths) const;
+
     /*!
      * Generates the outer inset / perimeter used in spiralize mode for a single layer part. The spiral inset is
      * generated using offsets.
@@ -75,6 +75,12 @@ public:
      */
     bool isSequential() const override;
 
+    /*
+     * \brief The front-end shows the layer view.
+     * \return Always ``true``.
+     */
+    bool wantsLayerView() const override;
+
     /*
      * \brief Test if there are any more slices in the queue.
      */
@@ -179,7 +185,7 @@ public:
     /*
      * \brief Communicate to Arcus what our progress is.
      */
-    void sendProgress(double progress) const override;
+    void sendProgress(double progress, std::optional<Duration> remaining_time) const override;
 
     /*
      * \brief Set which extruder is being used for the following calls to
@@ -9,6 +9,8 @@
 #include "SliceDataStruct.h"
 #include "settings/types/LayerIndex.h"
 
+#include <deque> //For the g-code messages that are still being sent.
+#include <memory>
 #include <sstream> //For ostringstream.
 
 namespace cura
@@ -46,11 +48,44 @@ public:
      */
     void readMeshGroupMessage(const proto::ObjectList& mesh_group_message);
 
+    /*
+     * \brief Send g-code to the front-end.
+     *
+     * Large layers are split into several messages of at most
+     * \ref max_gcode_message_size bytes, at line breaks where possible. The
+     * front-end joins all g-code messages anyway.
+     *
+     * If the front-end doesn't keep up, this waits until the socket has sent
+     * enough of the earlier messages, so that there are never more than
+     * \ref max_gcode_in_flight bytes in the send queue of the socket.
+     * \param gcode The g-code to send.
+     */
+    void sendGCode(const std::string& gcode);
+
+    /*
+     * \brief Forget about the g-code messages that the socket has sent.
+     *
+     * The socket holds on to a message until it has written it. Once it
+     * lets go, the weak pointer to it expires.
+     */
+    void releaseSentGCode();
+
+    //! G-code messages are at most this size, so that large layers don't need a single, huge protobuf buffer.
+    static constexpr size_t max_gcode_message_size = 1024 * 1024;
+
+    //! How many bytes of g-code the socket can have in its send queue before the slicing waits for it.
+    static constexpr size_t max_gcode_in_flight = 16 * 1024 * 1024;
+
     Arcus::Socket* socket; //!< Socket to send data to.
     size_t object_count; //!< Number of objects that need to be sliced.
+    bool compact_path_segments; //!< Whether the front-end reads the layer view in the compact encoding of proto::PathSegment.
     std::string temp_gcode_file; //!< Temporary buffer for the g-code.
     std::ostringstream gcode_output_stream; //!< The stream to write g-code to.
 
+    //! The g-code messages that the socket may not have sent yet, with their size.
+    std::deque<std::pair<std::weak_ptr<proto::GCodeLayer>, size_t>> gcode_in_flight;
+    size_t gcode_in_flight_size; //!< The total size of the messages in \ref gcode_in_flight.
+
     SliceDataStruct<cura::proto::Layer> sliced_layers;
     SliceDataStruct<cura::proto::LayerOptimized> optimized_layers;
 
@@ -4,7 +4,10 @@
 #ifndef COMMANDLINE_H
 #define COMMANDLINE_H
 
+#include <atomic>
 #include <filesystem>
+#include <istream>
+#include <memory>
 #include <optional>
 #include <rapidjson/document.h> //Loading JSON documents to get settings from them.
 #include <string> //To store the command line arguments.
@@ -12,6 +15,7 @@
 #include <vector> //To store the command line arguments.
 
 #include "Communication.h" //The class we're implementing.
+#include "DefinitionCache.h" //To skip parsing the definition files if they were loaded before.
 
 namespace cura
 {
@@ -34,6 +38,25 @@ public:
      */
     CommandLine(const std::vector<std::string>& arguments);
 
+    /*
+     * \brief Keep running and slice the jobs read from \p input, one per line,
+     * until it ends.
+     *
+     * Each line holds the arguments of a ``CuraEngine slice`` command, separated
+     * by spaces. Arguments with spaces in them can be put between double
+     * quotes. Whenever a job is done, a line ``job <number> done`` or
+     * ``job <number> cancelled`` is written to the standard output, so each job
+     * should write its g-code to a file with ``-o``. While slicing, lines
+     * ``job <number> progress <fraction> remaining <seconds>`` tell how far the
+     * job is, with a negative number of seconds if there is no estimate yet.
+     *
+     * The thread pool and the definitions loaded for earlier jobs are kept, so
+     * that each job only needs to load its models and slice.
+     * \param input Where to read the jobs from. It is read on a separate
+     * thread, so jobs can be queued while slicing.
+     */
+    void readJobs(std::istream& input);
+
     /*
      * \brief Indicate that we're beginning to send g-code.
      * This does nothing to the command line.
@@ -53,8 +76,17 @@ public:
      */
     bool isSequential() const override;
 
+    /*
+     * \brief The command line doesn't show a layer view.
+     * \return Always ``false``.
+     */
+    bool wantsLayerView() const override;
+
     /*
      * \brief Test if there are any more slices to be made.
+     *
+     * When reading jobs, this waits until the next job is read or the input
+     * ends.
      */
     bool hasSlice() const override;
 
@@ -130,7 +162,7 @@ public:
     /*
      * \brief Show an update of our slicing progress.
      */
-    void sendProgress(double progress) const override;
+    void sendProgress(double progress, std::optional<Duration> remaining_time) const override;
 
     /*
      * \brief Set which extruder is being used for the following calls to
@@ -156,12 +188,40 @@ public:
     void sliceNext() override;
 
 private:
+    struct JobQueue;
+
 #ifdef __EMSCRIPTEN__
     std::string progressHandler;
 #endif
 
     std::vector<std::filesystem::path> search_directories_;
 
+    /*
+     * \brief The jobs that were read but not sliced yet, when reading jobs.
+     *
+     * Shared with the thread that reads them, which may still be waiting for
+     * input when the engine exits.
+     */
+    std::shared_ptr<JobQueue> job_queue_;
+    size_t job_number_ = 0; //!< How many jobs were started.
+    std::vector<std::filesystem::path> initial_search_directories_; //!< The search directories before the first job, to start every job with.
+
+    /*
+     * \brief Snapshots of the definition files loaded in earlier runs.
+     *
+     * Only used if the CURAENGINE_DEFINITION_CACHE environment variable names
+     * a directory to keep them in.
+     */
+    std::optional<DefinitionCache> definition_cache_;
+
+    /*
+     * \brief While loading a definition file for the cache, what loading it
+     * does.
+     */
+    DefinitionCache::Snapshot* recording_ = nullptr;
+    const Settings* recording_settings_ = nullptr; //!< The settings that the recorded definition file is loaded into.
+    bool recording_complete_ = false; //!< Whether everything that loading the definition file does could be recorded.
+
     /*
      * \brief The command line arguments that the application was called with.
      */
@@ -169,8 +229,24 @@ private:
 
     /*
      * The last progress update that we output to stdcerr.
+     *
+     * Progress may be sent from any thread.
+     */
+    mutable std::atomic<unsigned int> last_shown_progress_;
+
+    /*
+     * \brief Load a definition file given on the command line and store the
+     * settings inside it, from the definition cache if possible.
+     *
+     * The parameters and the return value are those of \ref loadJSON.
+     */
+    int loadDefinition(const std::filesystem::path& json_filename, Settings& settings, bool force_read_parent, bool force_read_nondefault);
+
+    /*
+     * \brief Record a setting that is added while loading a definition file
+     * for the cache.
      */
-    unsigned int last_shown_progress_;
+    void recordSetting(const Settings& settings, const std::string& key, const std::string& value);
 
     /*
      * \brief Load a JSON file and store the settings inside it.
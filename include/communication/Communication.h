@@ -4,7 +4,10 @@
 #ifndef COMMUNICATION_H
 #define COMMUNICATION_H
 
+#include <optional>
+
 #include "geometry/Point2LL.h"
+#include "settings/types/Duration.h"
 #include "settings/types/LayerIndex.h"
 #include "settings/types/Velocity.h"
 
@@ -45,11 +48,23 @@ public:
      */
     virtual bool isSequential() const = 0;
 
+    /*
+     * \brief Whether anyone looks at the layer view data sent with
+     * \ref sendLineTo, \ref sendPolygons and the like.
+     *
+     * If not, the callers may skip computing what they would send, which adds
+     * up since it is done for every point of every path.
+     */
+    virtual bool wantsLayerView() const = 0;
+
     /*
      * \brief Indicate to the communication channel what the current progress of
      * slicing the current slice is.
+     * \param progress How far the slice is, between 0 and 1.
+     * \param remaining_time An estimate of how long the rest of the slice will
+     * take, if there is one yet.
      */
-    virtual void sendProgress(double progress) const = 0;
+    virtual void sendProgress(double progress, std::optional<Duration> remaining_time) const = 0;
 
     /*
      * \brief Indicate to the communication channel that a layer is complete and
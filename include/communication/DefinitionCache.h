@@ -0,0 +1,120 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef DEFINITION_CACHE_H
+#define DEFINITION_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cura
+{
+
+/*!
+ * \brief Stores the settings resolved from a definition file and everything it
+ * inherits, so that the next run doesn't need to parse all of the JSON again.
+ *
+ * Loading fdmprinter.def.json, the machine definitions and the extruder
+ * definitions takes most of the start-up time of a command line slice. A
+ * snapshot stores the settings that came out of that in the order in which
+ * they were added, together with the files that were read and which files
+ * the definition IDs were found in. The snapshot is only used if none of those
+ * files changed and each definition ID is still found in the same file.
+ *
+ * Snapshots are stored in a directory, one binary file per definition file and
+ * set of search directories. The snapshots that were loaded or stored are also
+ * kept in memory, for processes that slice more than once.
+ */
+class DefinitionCache
+{
+public:
+    //! A file that was read, to check if it changed since.
+    struct File
+    {
+        std::string path;
+        uint64_t size;
+        int64_t modified; //!< Last write time, in the units of the file clock.
+    };
+
+    //! A definition ID that was looked up in the search directories.
+    struct Lookup
+    {
+        std::string definition_id;
+        size_t search_directory_count; //!< How many of the search directories there were at the time.
+        std::string file; //!< Where it was found.
+    };
+
+    //! A setting that was added.
+    struct Setting
+    {
+        int64_t extruder_nr; //!< Which extruder the setting was added to, or -1 if it was added to the settings the definition was loaded into.
+        std::string key;
+        std::string value;
+    };
+
+    //! Everything that loading a definition file did.
+    struct Snapshot
+    {
+        std::vector<File> files;
+        std::vector<Lookup> lookups;
+        std::vector<std::filesystem::path> added_search_directories; //!< Loading a file adds its directory to the search directories.
+        size_t extruder_count = 0; //!< How many extruders the scene had afterwards.
+        std::vector<Setting> settings;
+    };
+
+    /*!
+     * \param directory The directory to store the snapshots in. It's created
+     * when the first snapshot is stored. If empty, the snapshots are only kept
+     * in memory.
+     */
+    explicit DefinitionCache(std::filesystem::path directory);
+
+    /*!
+     * \brief Get the snapshot of a definition file, if it is still valid.
+     * \param json_filename The definition file that is loaded.
+     * \param search_directories The search directories before the file is
+     * loaded.
+     * \return The snapshot, or nothing if there is none or if any of the files
+     * it was made from changed.
+     */
+    [[nodiscard]] std::optional<Snapshot> load(const std::filesystem::path& json_filename, const std::vector<std::filesystem::path>& search_directories);
+
+    /*!
+     * \brief Store the snapshot of a definition file for the next runs.
+     *
+     * Failing to store it is not an error, the next run will just have to
+     * parse the JSON again.
+     * \param json_filename The definition file that was loaded.
+     * \param search_directories The search directories before the file was
+     * loaded.
+     * \param snapshot What loading the file did.
+     */
+    void store(const std::filesystem::path& json_filename, const std::vector<std::filesystem::path>& search_directories, const Snapshot& snapshot);
+
+    /*!
+     * \brief Describe a file as it is now, to compare with later.
+     * \return The file, or nothing if it can't be read.
+     */
+    [[nodiscard]] static std::optional<File> describeFile(const std::filesystem::path& path);
+
+private:
+    //! Increase this whenever the format of the snapshots changes.
+    static constexpr uint32_t format_version = 1;
+
+    std::filesystem::path directory_;
+    std::unordered_map<std::string, Snapshot> remembered_; //!< The snapshots loaded or stored so far, by the file they are stored in.
+
+    //! The file of the snapshot of a definition file loaded with these search directories.
+    [[nodiscard]] std::filesystem::path snapshotPath(const std::filesystem::path& json_filename, const std::vector<std::filesystem::path>& search_directories) const;
+
+    //! Whether the files of the snapshot didn't change and the definitions would still be found in the same files.
+    [[nodiscard]] static bool isValid(const Snapshot& snapshot, const std::vector<std::filesystem::path>& search_directories);
+};
+
+} // namespace cura
+
+#endif // DEFINITION_CACHE_H
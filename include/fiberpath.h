@@ -2,9 +2,17 @@
 #ifndef FIBERPATH_H
 #define FIBERPATH_H
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "settings/Settings.h"
+#include "utils/AABB.h"
 #include "utils/AABB3D.h"
 #include "utils/Matrix4x3D.h"
+#include "utils/PolygonsPointIndex.h"
+#include "utils/SparseLineGrid.h"
 #include "geometry/OpenPolyline.h"
 #include "geometry/Shape.h"
 
@@ -18,27 +26,230 @@ class FiberPath
 public:
     OpenLinesSet paths;
     coord_t z_;
+    bool loaded_ = true; //!< Whether \ref paths holds the polylines. False if they still have to be decoded from FiberPaths::source.
+    size_t source_layer_idx_ = 0; //!< The index of this layer in FiberPaths::source, if not \ref loaded_.
     FiberPath(coord_t z);
     FiberPath();
     Shape path2shape();
     void translate(Point3LL offset);
+
+    /*!
+     * Transform all points of this layer, in the same way as the vertices of
+     * a mesh are transformed when loaded.
+     *
+     * The transformation should keep the layers horizontal. The height of the
+     * layer is the transformed height of its origin.
+     */
     void transform(const Matrix4x3D& transformation);
 
 };
 
+/*!
+ * Spatial index over the segments of the polylines of a fiber layer.
+ *
+ * Used to clip a fiber layer with many small parts: each part only needs to
+ * intersect the pieces of the fiber polylines that are near it, instead of the
+ * whole fiber layer.
+ */
+class FiberPathGrid
+{
+public:
+    /*!
+     * \param polylines The polylines to index. These must outlive the grid.
+     * \param cell_size The size of the grid cells.
+     */
+    FiberPathGrid(const OpenLinesSet& polylines, const coord_t cell_size);
+
+    /*!
+     * Get the pieces of the polylines that may intersect a box.
+     *
+     * The pieces are maximal runs of consecutive segments of which the bounding
+     * box hits \p box. Clipping the result to an area within \p box gives the
+     * same result as clipping all polylines.
+     */
+    OpenLinesSet getPolylinesNear(const AABB& box) const;
+
+private:
+    using SegmentIndex = PathsPointIndex<OpenLinesSet>;
+
+    struct SegmentLocator
+    {
+        std::pair<Point2LL, Point2LL> operator()(const SegmentIndex& segment) const
+        {
+            const OpenPolyline& polyline = (*segment.polygons_)[segment.poly_idx_];
+            return { polyline[segment.point_idx_], polyline[segment.point_idx_ + 1] };
+        }
+    };
+
+    const OpenLinesSet& polylines_;
+    SparseLineGrid<SegmentIndex, SegmentLocator> grid_;
+};
+
+class FiberPathBinaryFile;
+
+/*!
+ * All fiber layers of a single fiber path file.
+ *
+ * The layers are kept sorted on z together with a z index, so that the fiber
+ * layer(s) of a slice layer can be looked up with a binary search. Whenever
+ * \ref paths is modified, \ref sorted should be reset so that the index gets
+ * rebuilt on the next lookup.
+ */
 class FiberPaths
 {
 public:
     std::vector<FiberPath> paths;
+    std::vector<coord_t> z_index; //!< The z of each of the fiber layers in \ref paths, in the same order. Only valid when \ref sorted.
     bool sorted;
+    std::shared_ptr<const FiberPathBinaryFile> source; //!< The memory-mapped file to decode the layers that aren't loaded from, if any.
+    Matrix4x3D source_transformation; //!< The transformation to apply to layers when they're decoded from \ref source.
+    coord_t simplify_resolution = 0; //!< The resolution to simplify layers to when they're decoded from \ref source, or 0 to keep all their points. See \ref simplify.
+    coord_t simplify_deviation = 0; //!< The deviation allowed when simplifying layers that are decoded from \ref source. See \ref simplify.
+    coord_t simplify_area_deviation = 0; //!< The area deviation allowed when simplifying layers that are decoded from \ref source. See \ref simplify.
     FiberPaths();
+
+    /*!
+     * Remove the points of the fibers that are closer together than the
+     * machine can resolve, like \ref Simplify does for polylines. The ends of
+     * the fibers are kept.
+     *
+     * The loaded fiber layers are simplified right away, in parallel. Layers
+     * that still have to be decoded are simplified when they're decoded.
+     * \param max_resolution Segments shorter than this are joined with their
+     * neighbours. If 0, nothing is simplified.
+     * \param max_deviation How far the simplified fibers may deviate from the
+     * original fibers.
+     * \param max_area_deviation How much area the removed points may enclose
+     * between the simplified and the original fibers, in square micrometres.
+     */
+    void simplify(const coord_t max_resolution, const coord_t max_deviation, const coord_t max_area_deviation);
+
+    /*!
+     * Get the polylines of a fiber layer, decoding them from \ref source if
+     * they aren't loaded. This doesn't modify the fiber layer, so it's safe to
+     * call concurrently.
+     * \param path_idx The index of the fiber layer in \ref paths.
+     * \param decoded Storage for the decoded polylines, if they need decoding.
+     * \return Either the loaded polylines, or \p decoded.
+     */
+    const OpenLinesSet& getPolylines(const size_t path_idx, OpenLinesSet& decoded) const;
+
+    /*!
+     * Get the bounding box of a fiber layer. For layers that aren't loaded this
+     * comes from the layer table of \ref source, without decoding the layer.
+     */
+    AABB getBoundingBox(const size_t path_idx) const;
+
+    /*!
+     * Transform all fiber layers. Layers that still have to be decoded get
+     * transformed when they're decoded.
+     */
     void transform(const Matrix4x3D& transformation);
+
+    /*!
+     * Sort the fiber layers on z and rebuild the z index, if this hasn't been
+     * done since the last modification.
+     */
     void sort();
-    FiberPath* getFiberPath(const coord_t z);
+
+    /*!
+     * Get the fiber layer closest to a certain height.
+     * \param z The height to look for.
+     * \param tolerance The maximum distance between \p z and the height of the
+     * fiber layer.
+     * \return The closest fiber layer, or nullptr if there is none within
+     * \p tolerance.
+     */
+    FiberPath* getFiberPath(const coord_t z, const coord_t tolerance = 0);
+
+    /*!
+     * Get the range of fiber layers of which the height is strictly less than
+     * \p tolerance away from \p z.
+     * \return The indices in \ref paths of the first fiber layer in range and
+     * one past the last one.
+     */
+    std::pair<size_t, size_t> getFiberPathRange(const coord_t z, const coord_t tolerance);
 };
 
 
 
+/*!
+ * A fiber path file in the binary format, mapped into memory.
+ *
+ * The file consists of a header, a table with the z, bounding box and location
+ * of the data of each layer, and the data of the layers. The data of a layer is
+ * the number of points of each of its polylines, followed by the points as
+ * pairs of int64 coordinates. Layers are only decoded when requested, so only
+ * the pages of the layers that are actually sliced are read from disk.
+ *
+ * All numbers are in the byte order of the machine that wrote the file; the
+ * header is used to detect files with a different byte order.
+ */
+class FiberPathBinaryFile
+{
+public:
+    static constexpr char magic[4] = { 'C', 'F', 'P', 'B' };
+    static constexpr uint32_t version = 1;
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t layer_count;
+    };
+
+    struct LayerEntry
+    {
+        int64_t z;
+        int64_t min_x;
+        int64_t min_y;
+        int64_t max_x;
+        int64_t max_y;
+        uint64_t offset; //!< Where the data of this layer starts in the file.
+        uint64_t polyline_count;
+        uint64_t point_count;
+    };
+
+    /*!
+     * Map a binary fiber path file into memory and validate its layer table.
+     * \return The mapped file, or nullptr if it couldn't be opened or isn't a
+     * valid fiber path file.
+     */
+    static std::shared_ptr<FiberPathBinaryFile> open(const std::string& filename);
+
+    /*!
+     * Write fiber paths to a file in the binary format. The layers are written
+     * sorted on z.
+     * \return Whether the file was written successfully.
+     */
+    static bool write(FiberPaths& fiberpaths, const std::string& filename);
+
+    size_t layerCount() const;
+    const LayerEntry& layer(const size_t layer_idx) const;
+
+    /*!
+     * Decode the polylines of a layer.
+     */
+    OpenLinesSet decodeLayer(const size_t layer_idx) const;
+
+    /*!
+     * Create a fiber layer for each of the layers in this file, without
+     * decoding them, and make \p fiberpaths decode them from this file.
+     */
+    static void addTo(const std::shared_ptr<FiberPathBinaryFile>& file, FiberPaths& fiberpaths);
+
+    ~FiberPathBinaryFile();
+
+private:
+    FiberPathBinaryFile() = default;
+
+    struct Mapping;
+    std::unique_ptr<Mapping> mapping_; //!< Keeps the file mapped while this object is alive.
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<LayerEntry> layers_;
+};
+
 } // namespace cura
 
 #endif // FIBERPATH_H
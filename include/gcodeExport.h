@@ -5,12 +5,14 @@
 #define GCODEEXPORT_H
 
 #include <deque> // for extrusionAmountAtPreviousRetractions
+#include <memory>
 #ifdef BUILD_TESTS
 #include <gtest/gtest_prod.h> //To allow tests to use protected members.
 #endif
 #include <optional>
 #include <sstream> // for stream.str()
 #include <stdio.h>
+#include <string_view>
 
 #include "geometry/Point2LL.h"
 #include "settings/EnumSettings.h"
@@ -18,6 +20,7 @@
 #include "settings/types/LayerIndex.h"
 #include "settings/types/Temperature.h" //Bed temperature.
 #include "settings/types/Velocity.h"
+#include "TimeEstimateWorker.h"
 #include "timeEstimate.h"
 #include "utils/AABB3D.h" //To track the used build volume for the Griffin header.
 #include "utils/NoCopy.h"
@@ -25,6 +28,7 @@
 namespace cura
 {
 
+class BinaryGCodeWriter;
 class RetractionConfig;
 class SliceDataStorage;
 struct WipeScriptConfig;
@@ -40,6 +44,7 @@ class GCodeExport : public NoCopy
     FRIEND_TEST(GCodeExportTest, CommentSimple);
     FRIEND_TEST(GCodeExportTest, CommentMultiLine);
     FRIEND_TEST(GCodeExportTest, CommentMultiple);
+    FRIEND_TEST(GCodeExportTest, CommentMinimal);
     FRIEND_TEST(GCodeExportTest, CommentTimeZero);
     FRIEND_TEST(GCodeExportTest, CommentTimeInteger);
     FRIEND_TEST(GCodeExportTest, CommentTimeFloatRoundingError);
@@ -59,6 +64,7 @@ class GCodeExport : public NoCopy
     FRIEND_TEST(GCodeExportTest, WriteZHopEndZero);
     FRIEND_TEST(GCodeExportTest, WriteZHopEndDefaultSpeed);
     FRIEND_TEST(GCodeExportTest, WriteZHopEndCustomSpeed);
+    FRIEND_TEST(GCodeExportTest, WriteArcExtrusion);
     FRIEND_TEST(GCodeExportTest, insertWipeScriptSingleMove);
     FRIEND_TEST(GCodeExportTest, insertWipeScriptMultipleMoves);
     FRIEND_TEST(GCodeExportTest, insertWipeScriptOptionalDelay);
@@ -94,6 +100,18 @@ private:
         Point2LL nozzle_offset_; //!< Cache of setting machine_nozzle_offset_[xy]
         bool machine_firmware_retract_; //!< Cache of setting machine_firmware_retract
 
+        //! Cache of the settings that are needed when switching to or from this extruder.
+        struct SwitchSettings
+        {
+            bool retraction_enable;
+            std::string start_code;
+            Duration start_code_duration;
+            std::string end_code;
+            Duration end_code_duration;
+        };
+        std::optional<SwitchSettings> switch_settings_; //!< Loaded on the first extruder switch, see \ref GCodeExport::getSwitchSettings.
+        std::optional<Velocity> z_hop_speed_; //!< Cache of setting speed_z_hop, loaded on the first z hop.
+
         std::deque<double> extruded_volume_at_previous_n_retractions_; // in mm^3
 
         ExtruderTrainAttributes()
@@ -121,6 +139,16 @@ private:
     std::ostream* output_stream_;
     std::string new_line_;
 
+    std::unique_ptr<BinaryGCodeWriter> binary_writer_; //!< If writing binary g-code, the writer that the output stream writes to.
+    std::unique_ptr<std::ostream> binary_stream_; //!< If writing binary g-code, the output stream that writes to the binary writer.
+    std::ostream* binary_target_ = nullptr; //!< If writing binary g-code, where the finished file goes.
+
+    //! While estimating the time on a background thread, how many layers may wait for their estimate before the g-code writing waits for it.
+    static constexpr size_t max_unestimated_layers = 4;
+    std::ostream* estimated_target_ = nullptr; //!< While layers wait for their time estimate, where the g-code goes once they have it.
+    std::ostringstream unestimated_output_; //!< While layers wait for their time estimate, the g-code written since the last layer ended.
+    std::deque<std::string> unestimated_layers_; //!< The g-code of each layer that waits for its time estimate, which comes before its time comment.
+
     double current_e_value_; //!< The last E value written to gcode (in mm or mm^3)
 
     // flow-rate compensation
@@ -156,13 +184,15 @@ private:
     EGCodeFlavor flavor_;
 
     std::vector<Duration> total_print_times_; //!< The total estimated print time in seconds for each feature
-    TimeEstimateCalculator estimate_calculator_;
+    TimeEstimateWorker time_estimates_;
 
     LayerIndex layer_nr_; //!< for sending travel data
 
     bool is_volumetric_;
     bool relative_extrusion_; //!< whether to use relative extrusion distances rather than absolute
     bool always_write_active_tool_; //!< whether to write the active tool after sending commands to inactive tool
+    coord_t arc_fitting_tolerance_ = 0; //!< How far arcs may deviate from the paths that they replace, or 0 to write no arcs.
+    bool minimal_comments_ = false; //!< Whether to leave out the comments that only help people to read the g-code, for g-code that is only read by machines.
 
     Temperature initial_bed_temp_; //!< bed temperature at the beginning of the print.
     Temperature bed_temperature_; //!< Current build plate temperature.
@@ -304,7 +334,22 @@ public:
     void updateTotalPrintTime();
     void resetTotalPrintTimeAndFilament();
 
-    void writeComment(const std::string& comment);
+    void writeComment(const std::string_view comment);
+
+    /*!
+     * Write a comment that only helps people to read the g-code. It's left out
+     * if the g-code is written with minimal comments.
+     *
+     * \param comment The comment to write.
+     */
+    void writeDetailComment(const std::string_view comment);
+
+    /*!
+     * Write a comment with the type of the features that follow. It's left out
+     * if the g-code is written with minimal comments.
+     *
+     * \param type The type of the features. Travel moves have no type comment.
+     */
     void writeTypeComment(const PrintFeatureType& type);
 
     /*!
@@ -385,6 +430,37 @@ public:
      */
     void writeExtrusion(const Point3LL& p, const Velocity& speed, double extrusion_mm3_per_mm, PrintFeatureType feature, bool update_extrusion_offset = false);
 
+    /*!
+     * Go along an arc to a X/Y location with the extrusion Z, with a G2 or G3
+     * command. Like writeExtrusion, it performs un-z-hop and unretraction.
+     *
+     * Coordinates are build plate coordinates, which might be offsetted when extruder offsets are encoded in the gcode.
+     *
+     * \param p location to go to
+     * \param center The centre of the arc. It must be as far from the current
+     * position as from \p p, give or take rounding.
+     * \param counter_clockwise Whether the arc goes counter-clockwise (G3)
+     * rather than clockwise (G2).
+     * \param speed movement speed
+     * \param extrusion_mm3_per_mm flow
+     * \param feature the feature that's currently printing
+     * \param update_extrusion_offset whether to update the extrusion offset to match the current flow rate
+     */
+    void writeArcExtrusion(
+        const Point2LL& p,
+        const Point2LL& center,
+        const bool counter_clockwise,
+        const Velocity& speed,
+        const double extrusion_mm3_per_mm,
+        const PrintFeatureType& feature,
+        const bool update_extrusion_offset = false);
+
+    /*!
+     * How far arcs may deviate from the paths that they replace, or 0 if the
+     * g-code shouldn't contain arcs.
+     */
+    coord_t getArcFittingTolerance() const;
+
     /*!
      * Initialize the extruder trains.
      *
@@ -410,6 +486,30 @@ public:
     bool needPrimeBlob() const;
 
 private:
+    /*!
+     * Send all g-code that is written from now on through a binary g-code
+     * writer, until \ref finishBinaryOutput is called.
+     */
+    void startBinaryOutput();
+
+    /*!
+     * The comment that marks the start of features of a type, without the
+     * line end.
+     *
+     * \return The comment, or an empty string if the type has no comment.
+     */
+    static std::string_view typeComment(const PrintFeatureType type);
+
+    /*!
+     * Write the g-code and time comments of the layers whose time has been
+     * estimated, in order.
+     *
+     * Once no layers wait for their estimate any more, the g-code is written
+     * directly to the target stream again.
+     * \param wait Whether to wait for all layers to be estimated.
+     */
+    void writeEstimatedLayers(const bool wait);
+
     /*!
      * Coordinates are build plate coordinates, which might be offsetted when extruder offsets are encoded in the gcode.
      *
@@ -443,6 +543,53 @@ private:
         const PrintFeatureType& feature,
         const bool update_extrusion_offset = false);
 
+    /*!
+     * Unretract and update the flow rate compensation before an extrusion
+     * move.
+     *
+     * \param length The length of the move in mm.
+     * \param speed movement speed
+     * \param extrusion_mm3_per_mm flow
+     * \param update_extrusion_offset whether to update the extrusion offset to match the current flow rate
+     * \return The E value at the end of the move.
+     */
+    double startExtrusion(const double length, const Velocity& speed, const double extrusion_mm3_per_mm, const bool update_extrusion_offset);
+
+    /*!
+     * Write a move of only the filament, for retractions and primes.
+     *
+     * The line is formatted in a buffer and written to the output stream at
+     * once, since support-heavy prints can have very many retractions.
+     *
+     * \param speed The speed of the filament.
+     * \param output_e The E value to write, which is relative or absolute
+     * depending on the extrusion mode.
+     */
+    void writeFilamentMove(const Velocity& speed, const double output_e);
+
+    /*!
+     * Write a move of only the Z axis, for z hops. Like \ref writeFilamentMove,
+     * it's written to the output stream at once.
+     *
+     * \param speed movement speed
+     * \param z The height to move to.
+     */
+    void writeZMove(const Velocity& speed, const coord_t z);
+
+    /*!
+     * Get the settings of an extruder that are needed to switch extruders.
+     * They're read from the settings only once per mesh group.
+     *
+     * \param extruder_nr The extruder to get the settings of.
+     */
+    const ExtruderTrainAttributes::SwitchSettings& getSwitchSettings(const size_t extruder_nr);
+
+    /*!
+     * Get the default speed of z hops of the current extruder, which is read
+     * from the settings only once per mesh group.
+     */
+    Velocity getZHopSpeed();
+
     /*!
      * Write the F, X, Y, Z and E value (if they are not different from the last)
      *
@@ -452,8 +599,17 @@ private:
      * This function updates the \ref GCodeExport::total_bounding_box
      * It estimates the time in \ref GCodeExport::estimateCalculator for the correct feature
      * It updates \ref GCodeExport::currentPosition, \ref GCodeExport::current_e_value and \ref GCodeExport::currentSpeed
+     *
+     * The whole line, starting with \p command, is formatted in a buffer and written to the output stream at once.
      */
-    void writeFXYZE(const Velocity& speed, const coord_t x, const coord_t y, const coord_t z, const double e, const PrintFeatureType& feature);
+    void writeFXYZE(
+        const std::string_view command,
+        const Velocity& speed,
+        const coord_t x,
+        const coord_t y,
+        const coord_t z,
+        const double e,
+        const PrintFeatureType& feature);
 
     /*!
      * The writeTravel and/or writeExtrusion when flavor == BFB
@@ -625,6 +781,15 @@ public:
      */
     void finalize(const char* endCode);
 
+    /*!
+     * If writing binary g-code, write the finished file to the target stream,
+     * with the metadata of the whole print.
+     *
+     * This must be done after the very last g-code has been written. Any
+     * g-code written afterwards goes to the target stream as text.
+     */
+    void finishBinaryOutput();
+
     /*!
      * Get amount of material extruded since last wipe script was inserted.
      *
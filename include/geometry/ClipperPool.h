@@ -0,0 +1,95 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef GEOMETRY_CLIPPER_POOL_H
+#define GEOMETRY_CLIPPER_POOL_H
+
+#include <memory>
+#include <vector>
+
+#include <polyclipping/clipper.hpp>
+
+namespace cura
+{
+
+/*!
+ * \brief Recycles Clipper objects per thread.
+ *
+ * Every boolean operation and offset used to construct its own Clipper object
+ * and let it free its internal buffers again afterwards. When many threads do
+ * this at once they keep contending on the global allocator. Leasing a Clipper
+ * from this pool instead hands out one that was used before by the same thread,
+ * which still has its buffers allocated.
+ *
+ * Leases may be nested, e.g. when an offset first needs a union. A lease must
+ * be released on the thread that took it.
+ */
+class ClipperPool
+{
+public:
+    /*!
+     * \brief A pooled object, which is cleared and returned to the pool of its
+     * thread when the lease goes out of scope.
+     */
+    template<typename T>
+    class Lease
+    {
+    public:
+        Lease(std::unique_ptr<T> object, std::vector<std::unique_ptr<T>>& pool)
+            : object_(std::move(object))
+            , pool_(pool)
+        {
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ~Lease()
+        {
+            ClipperPool::release(std::move(object_), pool_);
+        }
+
+        T& operator*() const
+        {
+            return *object_;
+        }
+
+        T* operator->() const
+        {
+            return object_.get();
+        }
+
+    private:
+        std::unique_ptr<T> object_;
+        std::vector<std::unique_ptr<T>>& pool_;
+    };
+
+    /*!
+     * \brief Lease a Clipper with the default options.
+     */
+    [[nodiscard]] static Lease<ClipperLib::Clipper> clipper();
+
+    /*!
+     * \brief Lease a ClipperOffset without any paths.
+     * \param miter_limit The miter limit to offset with.
+     * \param arc_tolerance The maximum deviation of rounded joins.
+     */
+    [[nodiscard]] static Lease<ClipperLib::ClipperOffset> offsetter(double miter_limit, double arc_tolerance = 10.0);
+
+    /*!
+     * \brief Lease an empty PolyTree to receive the result of a Clipper.
+     */
+    [[nodiscard]] static Lease<ClipperLib::PolyTree> polyTree();
+
+private:
+    //! How many unused objects of a type each thread keeps around. More are only needed for deeply nested leases.
+    static constexpr size_t max_pooled = 8;
+
+    //! Clear an object and give it back to the pool, or free it if the pool is full.
+    template<typename T>
+    static void release(std::unique_ptr<T> object, std::vector<std::unique_ptr<T>>& pool);
+};
+
+} // namespace cura
+
+#endif // GEOMETRY_CLIPPER_POOL_H
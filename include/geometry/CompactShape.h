@@ -0,0 +1,67 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef GEOMETRY_COMPACT_SHAPE_H
+#define GEOMETRY_COMPACT_SHAPE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "geometry/Point2LL.h"
+#include "geometry/Shape.h"
+
+namespace cura
+{
+
+/*!
+ * \brief A shape stored in half the memory, for geometry that is kept for the
+ * whole slice but only read now and then.
+ *
+ * The points are stored as 32-bit offsets from the corner of the bounding box
+ * of the shape, which covers over 4 kilometres. A shape that is larger than
+ * that is stored as is. Decoding gives back exactly the same shape.
+ */
+class CompactShape
+{
+public:
+    CompactShape() = default;
+
+    explicit CompactShape(const Shape& shape);
+
+    //! Get the shape back.
+    [[nodiscard]] Shape decode() const;
+
+    [[nodiscard]] bool empty() const
+    {
+        return path_ends_.empty() && wide_.empty();
+    }
+
+    [[nodiscard]] size_t pointCount() const
+    {
+        return points_.size() + wide_.pointCount();
+    }
+
+    //! An estimate of the bytes that the stored points and polygons take.
+    [[nodiscard]] size_t byteSize() const
+    {
+        return points_.size() * sizeof(Offset) + path_ends_.size() * sizeof(size_t) + explicitely_closed_.size() / 8 + wide_.pointCount() * sizeof(Point2LL)
+             + wide_.size() * sizeof(Polygon);
+    }
+
+private:
+    struct Offset
+    {
+        uint32_t x;
+        uint32_t y;
+    };
+
+    Point2LL origin_; //!< The corner of the bounding box, which the points are offsets from.
+    std::vector<Offset> points_; //!< The points of all polygons, one polygon after another.
+    std::vector<size_t> path_ends_; //!< For each polygon, the index in points_ just after its last point.
+    std::vector<bool> explicitely_closed_; //!< For each polygon, whether it repeats its first point at the end.
+    Shape wide_; //!< The shape itself, if it's too large to store compactly.
+};
+
+} // namespace cura
+
+#endif // GEOMETRY_COMPACT_SHAPE_H
@@ -248,6 +248,20 @@ public:
     [[nodiscard]] Shape offset(coord_t distance, ClipperLib::JoinType join_type = ClipperLib::jtMiter, double miter_limit = 1.2) const;
     [[nodiscard]] OpenLinesSet lineCut(const Shape& cutter) const;
 
+    /*!
+     * Cut the lines to the inside of a shape, like \ref lineCut, but without
+     * breaking them up anywhere else than where they cross the border of it.
+     *
+     * This is for continuous fibers, which are cut every time a line ends.
+     * Each line is clipped on its own, against only the polygons whose
+     * bounding box it touches, and the pieces that Clipper splits it into are
+     * stitched back together, so pieces of different lines are never joined.
+     * The pieces keep the direction of their line and are in the order along
+     * it.
+     * \param cutter The shape to keep the inside of.
+     */
+    [[nodiscard]] OpenLinesSet fiberCut(const Shape& cutter) const;
+
     /*!
      * Utility method for creating the tube (or 'donut') of a shape.
      *
@@ -0,0 +1,87 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef GEOMETRY_OFFSET_ENGINE_H
+#define GEOMETRY_OFFSET_ENGINE_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "geometry/Shape.h"
+#include "utils/Coord_t.h"
+
+namespace cura
+{
+
+class Polygon;
+
+/*!
+ * \brief Offsets the same shape by many different distances.
+ *
+ * Offsetting a shape with Clipper first preprocesses its paths, which is a
+ * considerable part of the work when offsetting by small distances. This
+ * class does that once, and then serves as many offsets as needed, for
+ * instance for every line of a brim.
+ *
+ * The results are exactly the same as those of Shape::offset or
+ * Polygon::offset, depending on what the engine was made from.
+ */
+class OffsetEngine
+{
+public:
+    /*!
+     * \brief Prepare to offset a shape, like Shape::offset does.
+     * \param shape The shape to offset. It is unioned first.
+     */
+    explicit OffsetEngine(const Shape& shape, ClipperLib::JoinType join_type = ClipperLib::jtMiter, double miter_limit = 1.2);
+
+    /*!
+     * \brief Prepare to offset a single polygon, like Polygon::offset does.
+     *
+     * The polygon is used as it is, so holes stay holes.
+     */
+    explicit OffsetEngine(const Polygon& polygon, ClipperLib::JoinType join_type = ClipperLib::jtMiter, double miter_limit = 1.2);
+
+    OffsetEngine(const OffsetEngine&) = delete;
+    OffsetEngine& operator=(const OffsetEngine&) = delete;
+    ~OffsetEngine();
+
+    /*!
+     * \brief Offset the shape by one distance.
+     *
+     * Not safe to call from several threads at once. Use \ref offsets for
+     * that.
+     * \param distance How far to offset. Negative to inset.
+     */
+    [[nodiscard]] Shape offset(coord_t distance);
+
+    /*!
+     * \brief Offset the shape by a number of distances.
+     * \param distances The distances to offset by.
+     * \param parallel Whether to compute the offsets on the thread pool. Each
+     * thread then gets its own preprocessed copy of the paths.
+     * \return The offset shapes, in the order of the distances.
+     */
+    [[nodiscard]] std::vector<Shape> offsets(const std::vector<coord_t>& distances, bool parallel = false);
+
+private:
+    //! Make a ClipperOffset that has the paths added.
+    [[nodiscard]] std::unique_ptr<ClipperLib::ClipperOffset> makeClipper() const;
+
+    //! Offset with one of the clippers.
+    [[nodiscard]] Shape offset(ClipperLib::ClipperOffset& clipper, coord_t distance) const;
+
+    Shape original_; //!< What to return when offsetting by zero, which Clipper doesn't do.
+    ClipperLib::Paths paths_; //!< The paths as they are added to Clipper.
+    ClipperLib::JoinType join_type_;
+    double miter_limit_;
+
+    std::unique_ptr<ClipperLib::ClipperOffset> clipper_; //!< The clipper used by serial calls.
+    std::mutex spare_clippers_mutex_;
+    std::vector<std::unique_ptr<ClipperLib::ClipperOffset>> spare_clippers_; //!< Clippers that parallel calls can use, so that each thread prepares at most one.
+};
+
+} // namespace cura
+
+#endif // GEOMETRY_OFFSET_ENGINE_H
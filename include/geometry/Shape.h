@@ -4,6 +4,8 @@
 #ifndef GEOMETRY_SHAPE_H
 #define GEOMETRY_SHAPE_H
 
+#include <span>
+
 #include "geometry/LinesSet.h"
 #include "geometry/Polygon.h"
 #include "settings/types/Angle.h"
@@ -71,15 +73,47 @@ public:
 
     [[nodiscard]] Shape difference(const Polygon& polygon) const;
 
+    /*!
+     * Subtract a number of shapes at once, which is faster than subtracting
+     * them one by one. Shapes that can't overlap this one are skipped.
+     *
+     * The shapes need to be oriented like the output of Clipper (outlines
+     * counter-clockwise, holes clockwise) if there are several of them.
+     */
+    [[nodiscard]] Shape difference(const std::vector<Shape>& others) const;
+
     [[nodiscard]] Shape unionPolygons(const Shape& other, ClipperLib::PolyFillType fill_type = ClipperLib::pftNonZero) const;
 
     [[nodiscard]] Shape unionPolygons(const Polygon& polygon, ClipperLib::PolyFillType fill_type = ClipperLib::pftNonZero) const;
 
+    /*!
+     * Union this shape with a number of other shapes at once, which is faster
+     * than unioning them one by one.
+     */
+    [[nodiscard]] Shape unionPolygons(const std::vector<Shape>& others, ClipperLib::PolyFillType fill_type = ClipperLib::pftNonZero) const;
+
     /*!
      * Union all polygons with each other (When polygons.add(polygon) has been called for overlapping polygons)
      */
     [[nodiscard]] Shape unionPolygons() const;
 
+    /*!
+     * Union all polygons with each other, like \ref unionPolygons(), but
+     * spread the work over the thread pool for shapes with many vertices.
+     *
+     * The bounding box is split into tiles, which are intersected with the
+     * polygons that overlap them in parallel. The tiles are then merged row
+     * by row, and the rows are merged at once. This pays off for outlines that
+     * span the build plate, like the first layer of a plate full of models.
+     *
+     * Where the outlines cross the borders between tiles, the crossings are
+     * rounded to whole coordinates, so the result may deviate slightly from
+     * \ref unionPolygons().
+     * \param parallel_vertex_count From how many vertices on the tiles are
+     * used. Smaller shapes are unioned at once.
+     */
+    [[nodiscard]] Shape unionPolygonsParallel(size_t parallel_vertex_count = 20000) const;
+
     [[nodiscard]] Shape intersection(const Shape& other) const;
 
     /*!
@@ -121,6 +155,17 @@ public:
      */
     [[nodiscard]] bool inside(const Point2LL& p, bool border_result = false) const;
 
+    /*!
+     * Check for each of a number of points whether it's inside the polygon, like inside(p, border_result).
+     *
+     * The polygons are prepared once for all points, which is faster than checking the points one by one when there are a lot of them.
+     *
+     * \param points The points to check
+     * \param border_result What to return for points that are exactly on the border
+     * \return For each point, whether it's inside this polygon (or \p border_result when it is on the border)
+     */
+    [[nodiscard]] std::vector<bool> inside(std::span<const Point2LL> points, bool border_result = false) const;
+
     /*!
      * Find the polygon inside which point \p p resides.
      *
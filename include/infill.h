@@ -4,6 +4,7 @@
 #ifndef INFILL_H
 #define INFILL_H
 
+#include <deque>
 #include <numbers>
 
 #include <range/v3/range/concepts.hpp>
@@ -368,6 +369,14 @@ private:
      */
     std::vector<std::vector<std::vector<InfillLineSegment*>>> crossings_on_line_;
 
+    /*!
+     * Owns all infill line segments that are referred to by
+     * crossings_on_line_, as well as the connecting segments that are made
+     * while connecting them. A deque, so that adding segments doesn't move the
+     * ones that are already linked together.
+     */
+    std::deque<InfillLineSegment> line_segments_;
+
     /*!
      * Generate the infill pattern without the infill_multiplier functionality
      */
@@ -5,6 +5,11 @@
 #ifndef INFILL_IMAGE_BASED_DENSITY_PROVIDER_H
 #define INFILL_IMAGE_BASED_DENSITY_PROVIDER_H
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "../utils/AABB.h"
 #include "DensityProvider.h"
 
@@ -23,8 +28,37 @@ public:
     virtual double operator()(const AABB3D& aabb) const;
 
 protected:
+    /*!
+     * The lightness of a decoded image as a summed-area table, so that the
+     * average lightness of any box of pixels can be computed in constant time.
+     */
+    struct SummedAreaTable
+    {
+        Point3LL image_size; //!< dimensions of the image. Third dimension is the amount of channels.
+
+        /*!
+         * For each (x, y) the total of all channels of the pixels left of x and
+         * below y, where y runs from the bottom row of the image up. Rows of
+         * image_size.x_ + 1 values, with the first row and column all zeroes.
+         */
+        std::vector<uint64_t> sums;
+
+        //! The total of all channels of the pixels from min_x to max_x and from min_y to max_y, inclusive.
+        uint64_t total(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y) const;
+    };
+
+    /*!
+     * Load an image and make its summed-area table.
+     *
+     * The tables are shared by all providers which use the same file, as long
+     * as any of them is alive.
+     * \param filename The image file to load.
+     * \return The table of that image.
+     */
+    static std::shared_ptr<const SummedAreaTable> loadImage(const std::string& filename);
+
+    std::shared_ptr<const SummedAreaTable> image; //!< The lightness of the image.
     Point3LL image_size; //!< dimensions of the image. Third dimension is the amount of channels.
-    unsigned char* image = nullptr; //!< image data: rows of channel data per pixel.
 
     AABB print_aabb; //!< bounding box of print coordinates in which to apply the image
 };
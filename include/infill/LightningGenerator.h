@@ -57,6 +57,14 @@ public:
     const LightningLayer& getTreesForLayer(const size_t& layer_id) const;
 
 protected:
+    /*!
+     * Calculate the area of each layer that the pattern fills, i.e. the infill
+     * areas inset by the infill walls.
+     *
+     * The layers are independent, so they are computed in parallel.
+     */
+    static std::vector<Shape> computeInfillOutlines(const SliceMeshStorage& mesh);
+
     /*!
      * Calculate the overhangs above the infill areas that need to be supported
      * by infill.
@@ -64,13 +72,17 @@ protected:
      * Normally, overhangs are only generated for the outside of the model and
      * only when support is generated. For this pattern, we also need to
      * generate overhang areas for the inside of the model.
+     * \param infill_outlines The infill outlines of each layer, as computed by
+     * \ref computeInfillOutlines.
      */
-    void generateInitialInternalOverhangs(const SliceMeshStorage& mesh);
+    void generateInitialInternalOverhangs(const std::vector<Shape>& infill_outlines);
 
     /*!
      * Calculate the tree structure of all layers.
+     * \param infill_outlines The infill outlines of each layer, as computed by
+     * \ref computeInfillOutlines.
      */
-    void generateTrees(const SliceMeshStorage& mesh);
+    void generateTrees(const std::vector<Shape>& infill_outlines);
 
     /*!
      * How far each piece of infill can support skin in the layer above.
@@ -12,11 +12,14 @@
 #include "geometry/LinesSet.h"
 #include "geometry/OpenLinesSet.h"
 #include "infill/LightningTreeNode.h"
+#include "utils/ShapeLocator.h"
 #include "utils/SquareGrid.h"
 #include "utils/polygonUtils.h"
 
 namespace cura
 {
+class LightningDistanceField;
+
 using LightningTreeNodeSPtr = std::shared_ptr<LightningTreeNode>;
 using SparseLightningTreeNodeGrid = SparsePointGridInclusive<std::weak_ptr<LightningTreeNode>>;
 
@@ -37,10 +40,15 @@ class LightningLayer
 public:
     std::vector<LightningTreeNodeSPtr> tree_roots;
 
+    /*!
+     * Add trees to support the overhang that isn't supported yet.
+     * \param distance_field The distance field of this layer, constructed from
+     * its outlines and overhang. It is updated as trees are added.
+     */
     void generateNewTrees(
-        const Shape& current_overhang,
+        LightningDistanceField& distance_field,
         const Shape& current_outlines,
-        const LocToLineGrid& outline_locator,
+        const ShapeLocator& outline_locator,
         const coord_t supporting_radius,
         const coord_t wall_supporting_radius);
 
@@ -50,7 +58,7 @@ public:
     GroundingLocation getBestGroundingLocation(
         const Point2LL& unsupported_location,
         const Shape& current_outlines,
-        const LocToLineGrid& outline_locator,
+        const ShapeLocator& outline_locator,
         const coord_t supporting_radius,
         const coord_t wall_supporting_radius,
         const SparseLightningTreeNodeGrid& tree_node_locator,
@@ -66,7 +74,7 @@ public:
     void reconnectRoots(
         std::vector<LightningTreeNodeSPtr>& to_be_reconnected_tree_roots,
         const Shape& current_outlines,
-        const LocToLineGrid& outline_locator,
+        const ShapeLocator& outline_locator,
         const coord_t supporting_radius,
         const coord_t wall_supporting_radius);
 
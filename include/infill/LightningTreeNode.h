@@ -130,7 +130,7 @@ public:
      * \param visitor A function to execute for every node in this node's sub-
      * tree.
      */
-    void visitNodes(const std::function<void(LightningTreeNodeSPtr)>& visitor);
+    void visitNodes(const std::function<void(const LightningTreeNodeSPtr&)>& visitor);
 
     /*!
      * Get a weighted distance from an unsupported point to this node (given the current supporting radius).
@@ -6,6 +6,7 @@
 #define INFILL_SIERPINSKI_FILL_H
 
 #include <list>
+#include <vector>
 
 #include "../utils/AABB.h"
 
@@ -292,9 +293,9 @@ protected:
         {
         }
         //! Get the first edge of this triangle crossed by the Sierpinski and/or Cross Fractal curve.
-        Edge getFromEdge();
+        Edge getFromEdge() const;
         //! Get the second edge of this triangle crossed by the Sierpinski and/or Cross Fractal curve.
-        Edge getToEdge();
+        Edge getToEdge() const;
         //! Get the total error value modulating the \ref requested_length
         double getTotalError();
         //! Get the total modulated \ref requested_length
@@ -340,6 +341,18 @@ protected:
      */
     std::list<SierpinskiTriangle*> sequence_;
 
+    /*!
+     * The triangles crossed by the finished fractal, in order.
+     *
+     * These are copies of the triangles in \ref sequence_ without their
+     * children, made by \ref compactSequence, so that the tree of all possible
+     * triangles doesn't need to be kept in memory while the layers are
+     * generated.
+     */
+    std::vector<SierpinskiTriangle> curve_;
+
+    double total_requested_length_ = 0; //!< The requested length of the root of the tree.
+
 
     /*!
      * Calculate all possible subdivision triangles and their statistics.
@@ -435,6 +448,14 @@ protected:
      */
     void diffuseError();
 
+    /*!
+     * Copy the triangles of the final \ref sequence_ into \ref curve_ and
+     * free the tree of all possible triangles.
+     *
+     * Should be called after the sequence is final.
+     */
+    void compactSequence();
+
     /*!
      * \return whether a node \p it in the sequence is constrained by the previous node.
      */
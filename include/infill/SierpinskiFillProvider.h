@@ -5,9 +5,11 @@
 #ifndef INFILL_SIERPINSKI_FILL_PROVIDER_H
 #define INFILL_SIERPINSKI_FILL_PROVIDER_H
 
+#include <mutex>
 #include <optional>
 
 #include "SierpinskiFill.h"
+#include "../geometry/Polygon.h"
 #include "../settings/EnumSettings.h" //For EFillMethod.
 
 namespace cura
@@ -44,10 +46,20 @@ public:
 
     SierpinskiFillProvider(const AABB3D aabb_3d, coord_t min_line_distance, coord_t line_width, std::string cross_subdisivion_spec_image_file);
 
+    /*!
+     * Generate the fill pattern for a layer.
+     *
+     * The pattern of the 2D cross infill is the same on every layer, so it's
+     * only generated the first time and copied after that. This may be called
+     * from multiple threads at once.
+     */
     Polygon generate(EFillMethod pattern, coord_t z, coord_t line_width, coord_t pocket_size) const;
 
     ~SierpinskiFillProvider();
 protected:
+    mutable std::once_flag cross_pattern_generated_; //!< Guards the generation of \ref cross_pattern_.
+    mutable Polygon cross_pattern_; //!< The 2D cross pattern, which is shared by all layers.
+
     /*!
      * Get the parameters with which to generate a sierpinski fractal for this object
      */
@@ -4,11 +4,16 @@
 #ifndef INFILL_SUBDIVCUBE_H
 #define INFILL_SUBDIVCUBE_H
 
+#include <array>
+#include <memory>
+#include <vector>
+
 #include "geometry/OpenLinesSet.h"
 #include "geometry/Point2LL.h"
 #include "geometry/Point3LL.h"
 #include "geometry/Point3Matrix.h"
 #include "geometry/PointMatrix.h"
+#include "geometry/Shape.h"
 #include "settings/types/LayerIndex.h"
 #include "settings/types/Ratio.h"
 
@@ -20,14 +25,27 @@ class SliceMeshStorage;
 
 class SubDivCube
 {
+private:
+    /*!
+     * The data of the mesh that is needed to decide which cubes to subdivide,
+     * gathered once before the octree is built.
+     */
+    struct OctreeInput
+    {
+        std::vector<Shape> infill_areas; //!< For each layer, the infill areas of all its parts together.
+        coord_t layer_height; //!< The layer height of the mesh.
+    };
+
 public:
     /*!
      * Constructor for SubDivCube. Recursively calls itself eight times to flesh out the octree.
-     * \param mesh contains infill layer data and settings
+     *
+     * The children of the larger cubes are built in parallel.
+     * \param input contains the infill areas of the mesh
      * \param my_center the center of the cube
      * \param depth the recursion depth of the cube (0 is most recursed)
      */
-    SubDivCube(SliceMeshStorage& mesh, Point3LL& center, size_t depth);
+    SubDivCube(const OctreeInput& input, Point3LL& center, size_t depth);
 
     /*!
      * Precompute the octree of subdivided cubes
@@ -74,22 +92,22 @@ private:
 
     /*!
      * Determines if a described theoretical cube should be subdivided based on if a sphere that encloses the cube touches the infill mesh.
-     * \param mesh contains infill layer data and settings
+     * \param input contains the infill areas of the mesh
      * \param center the center of the described cube
      * \param radius the radius of the enclosing sphere
      * \return the described cube should be subdivided
      */
-    static bool isValidSubdivision(SliceMeshStorage& mesh, Point3LL& center, coord_t radius);
+    static bool isValidSubdivision(const OctreeInput& input, Point3LL& center, coord_t radius);
 
     /*!
      * Finds the distance to the infill border at the specified layer from the specified point.
-     * \param mesh contains infill layer data and settings
+     * \param input contains the infill areas of the mesh
      * \param layer_nr the number of the specified layer
      * \param location the location of the specified point
      * \param[out] distance2 the squared distance to the infill border
      * \return Code 0: outside, 1: inside, 2: boundary does not exist at specified layer
      */
-    static coord_t distanceFromPointToMesh(SliceMeshStorage& mesh, const LayerIndex layer_nr, Point2LL& location, coord_t* distance2);
+    static coord_t distanceFromPointToMesh(const OctreeInput& input, const LayerIndex layer_nr, Point2LL& location, coord_t* distance2);
 
     /*!
      * Adds the defined line to the specified polygons. It assumes that the specified polygons are all parallel lines. Combines line segments with touching ends closer than
@@ -97,6 +115,8 @@ private:
      */
     void addLineAndCombine(OpenLinesSet& group, Point2LL from, Point2LL to);
 
+    static constexpr size_t min_parallel_depth = 4; //!< Cubes at least this deep build their children in parallel. Smaller cubes aren't worth a task.
+
     size_t depth_; //!< the recursion depth of the cube (0 is most recursed)
     Point3LL center_; //!< center location of the cube in absolute coordinates
     std::array<std::shared_ptr<SubDivCube>, 8> children_; //!< pointers to this cube's eight octree children
@@ -158,13 +158,6 @@ protected:
      */
     void reset();
 
-    /*!
-     * Add a line to the result while reverse-applying the rotation matrix.
-     *
-     * \param polyline The polyline to add
-     */
-    void addPolyline(const OpenPolyline& polyline);
-
     /*!
      * Checks whether the current connector should be added or not.
      *
@@ -174,8 +167,9 @@ protected:
     bool shouldAddCurrentConnector(int start_scanline_idx, int end_scanline_idx) const;
 
     /*!
-     * Adds a Zag connector represented by the given points. The last line of the connector will not be
-     * added if the given connector is an end piece and "connected_endpieces" is not enabled.
+     * Adds a Zag connector represented by the given points to the result, while reverse-applying the rotation
+     * matrix. The last line of the connector will not be added if the given connector is an end piece and
+     * "connected_endpieces" is not enabled.
      *
      * \param points All the points on this connector
      * \param is_endpiece Whether this connector is an end piece
@@ -34,10 +34,22 @@ class SliceMeshStorage;
  */
 void createLayerWithParts(const Settings& settings, SliceLayer& storageLayer, SlicerLayer* layer);
 
+/*!
+ * \brief Clip the fiber layers to the parts of the slice layers they belong to.
+ *
+ * The fiber paths get sorted on z, after which every slice layer looks up the
+ * fiber layers within half a layer thickness of its printZ. This should be
+ * called once per mesh, after the printZ of all layers is final.
+ * \param mesh The mesh of which the layer parts receive the fiber paths.
+ * \param fiberpath The fiber layers to distribute over the layers.
+ */
 void insertFiberPath(SliceMeshStorage& mesh, FiberPaths& fiberpath);
 
 /*!
  * \brief Split all layers into parts.
+ *
+ * The outlines of each slicer layer are released as soon as its parts have
+ * been created, so the slicer can't be used to get them afterwards.
  * \param mesh The mesh of which to split the layers into parts.
  * \param slicer The slicer to get the layers from.
  */
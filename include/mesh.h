@@ -4,6 +4,8 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include <array>
+
 #include "settings/Settings.h"
 #include "utils/AABB3D.h"
 #include "utils/Matrix4x3D.h"
@@ -64,8 +66,8 @@ See MeshFace for the specifics of how/when faces are connected.
 */
 class Mesh
 {
-    //! The vertex_hash_map stores a index reference of each vertex for the hash of that location. Allows for quick retrieval of points with the same location.
-    std::unordered_map<uint32_t, std::vector<uint32_t>> vertex_hash_map_;
+    //! Corners of the faces added since the last finish(), three per face. They get welded into vertices_ by finish().
+    std::vector<Point3LL> pending_corners_;
     AABB3D aabb_;
 
 public:
@@ -77,7 +79,29 @@ public:
     Mesh(Settings& parent);
     Mesh();
 
-    void addFace(Point3LL& v0, Point3LL& v1, Point3LL& v2); //!< add a face to the mesh without settings it's connected_faces.
+    void addFace(Point3LL& v0, Point3LL& v1, Point3LL& v2); //!< add a face to the mesh without settings it's connected_faces. The face only shows up in faces_ after finish().
+
+    /*!
+     * Add many faces at once, without setting their connected_faces.
+     *
+     * Like addFace, the faces only show up in faces_ after finish().
+     * \param corners The corners of the faces, three consecutive corners per face.
+     */
+    void addFaces(std::vector<Point3LL>&& corners);
+
+    /*!
+     * Add faces that index into a list of vertices, like those of 3MF and OBJ
+     * files, without setting their connected_faces.
+     *
+     * The vertices are used as they are, rather than welded like the corners
+     * of addFace, since the faces already tell which corners they share. Faces
+     * with two corners at the same location are dropped. Unlike addFace, the
+     * faces show up in faces_ right away, after the pending faces.
+     * \param vertices The locations of the vertices.
+     * \param faces For each face, the indices of its corners in \p vertices.
+     * The indices need to be within range.
+     */
+    void addIndexedFaces(const std::vector<Point3LL>& vertices, const std::vector<std::array<uint32_t, 3>>& faces);
     void clear(); //!< clears all data
     void finish(); //!< complete the model : set the connected_face_index fields of the faces.
 
@@ -126,7 +150,16 @@ public:
 private:
     mutable bool has_disconnected_faces; //!< Whether it has been logged that this mesh contains disconnected faces
     mutable bool has_overlapping_faces; //!< Whether it has been logged that this mesh contains overlapping faces
-    int findIndexOfVertex(const Point3LL& v); //!< find index of vertex close to the given point, or create a new vertex and return its index.
+
+    /*!
+     * Weld the pending corners into vertices and turn them into faces.
+     *
+     * A corner is merged into the first vertex (in order of appearance) that
+     * lies in the same vertex_meld_distance cell and within that distance of
+     * it. Otherwise it becomes a new vertex. Faces where two corners merge
+     * into the same vertex are dropped.
+     */
+    void weldPendingCorners();
 
     /*!
      * Get the index of the face connected to the face with index \p notFaceIdx, via vertices \p idx0 and \p idx1.
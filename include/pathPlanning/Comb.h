@@ -11,6 +11,7 @@
 #include "geometry/Polygon.h"
 #include "geometry/SingleShape.h"
 #include "settings/types/LayerIndex.h" // To store the layer on which we comb.
+#include "utils/ShapeLocator.h"
 #include "utils/polygonUtils.h"
 
 namespace cura
@@ -140,8 +141,8 @@ private:
     Shape boundary_inside_optimal_; //!< The boundary within which to comb. (Will be reordered by the partsView_inside_optimal)
     const PartsView parts_view_inside_minimum_; //!< Structured indices onto boundary_inside_minimum which shows which polygons belong to which part.
     const PartsView parts_view_inside_optimal_; //!< Structured indices onto boundary_inside_optimal which shows which polygons belong to which part.
-    std::unique_ptr<LocToLineGrid> inside_loc_to_line_minimum_; //!< The SparsePointGridInclusive mapping locations to line segments of the inner boundary.
-    std::unique_ptr<LocToLineGrid> inside_loc_to_line_optimal_; //!< The SparsePointGridInclusive mapping locations to line segments of the inner boundary.
+    ShapeLocator inside_locator_minimum_; //!< To find the nearby line segments of the minimum inner boundary.
+    ShapeLocator inside_locator_optimal_; //!< To find the nearby line segments of the optimal inner boundary.
     std::unordered_map<size_t, Shape> boundary_outside_; //!< The boundary outside of which to stay to avoid collision with other layer parts. This is a pointer cause we only
                                                          //!< compute it when we move outside the boundary (so not when there is only a single part in the layer)
     std::unordered_map<size_t, Shape> model_boundary_; //!< The boundary of the model itself
@@ -173,16 +174,30 @@ private:
 
     /*!
      * Move the startPoint or endPoint inside when it should be inside
+     * \param inside_locator[in] The locator of the boundary to move the point inside of
      * \param is_inside[in] Whether the \p dest_point should be inside
-     * \param inside_loc_to_line[in] A SparseGrid mapping locations to line segments of \p polygons
      * \param dest_point[in,out] The point to move
      * \param start_inside_poly[out] The polygon in which the point has been moved
      * \return Whether we have moved the point inside
      */
-    bool moveInside(Shape& boundary_inside, bool is_inside, LocToLineGrid* inside_loc_to_line, Point2LL& dest_point, size_t& start_inside_poly);
+    bool moveInside(const ShapeLocator& inside_locator, bool is_inside, Point2LL& dest_point, size_t& start_inside_poly);
 
     void moveCombPathInside(Shape& boundary_inside, Shape& boundary_inside_optimal, CombPath& comb_path_input, CombPath& comb_path_output);
 
+    /*!
+     * \brief Whether a travel can go straight, because it stays well within a
+     * single part of the optimal comb boundary.
+     *
+     * This is a quick check through the grid of the boundary: it only holds
+     * if no boundary segment is in any cell the travel passes through, nor
+     * near its endpoints, so that combing would neither move the endpoints nor
+     * find any crossings.
+     * \param start_point Where the travel starts.
+     * \param end_point Where the travel ends.
+     * \return Whether the direct line can be used as the comb path.
+     */
+    bool isDirectTravelInside(const Point2LL& start_point, const Point2LL& end_point) const;
+
 public:
     /*!
      * Initialises the combing areas for every mesh in the layer (not support).
@@ -5,6 +5,7 @@
 #define PATH_PLANNING_G_CODE_PATH_H
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "GCodePathConfig.h"
@@ -29,6 +30,13 @@ namespace cura
  */
 struct GCodePath
 {
+    //! Where the coasting starts on a path, when its end is coasted. See \ref LayerPlan::planCoasting.
+    struct CoastingSplit
+    {
+        size_t point_idx_before_start; //!< The last point that is still extruded normally.
+        Point2LL start; //!< The point between that point and the next where the extrusion stops and the coasting starts.
+    };
+
     coord_t z_offset{}; //<! vertical offset from 'full' layer height
     GCodePathConfig config{}; //!< The configuration settings of the path.
     std::shared_ptr<const SliceMeshStorage> mesh; //!< Which mesh this path belongs to, if any. If it's not part of any mesh, the mesh should be nullptr;
@@ -50,6 +58,7 @@ struct GCodePath
     bool done{ false }; //!< Path is finished, no more moves should be added, and a new path should be started instead of any appending done to this one.
     double fan_speed{ GCodePathConfig::FAN_SPEED_DEFAULT }; //!< fan speed override for this path, value should be within range 0-100 (inclusive) and ignored otherwise
     TimeMaterialEstimates estimates{}; //!< Naive time and material estimates
+    std::optional<CoastingSplit> coasting_split{}; //!< Where coasting starts if this path is followed by a travel, or nothing if it's not coasted at all.
 
     /*!
      * Whether this config is the config of a travel path.
@@ -0,0 +1,62 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef PATH_PLANNING_PATH_POINTS_POOL_H
+#define PATH_PLANNING_PATH_POINTS_POOL_H
+
+#include <mutex>
+#include <vector>
+
+#include "geometry/Point2LL.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Recycles the point buffers of the paths of layer plans.
+ *
+ * Every path of a layer plan used to allocate its points while the layer was
+ * planned and free them again right after the layer was written. This pool
+ * collects the buffers of a layer plan when it is deleted, and hands them to
+ * the next layer plan that is made, so that its paths reuse their capacity.
+ *
+ * Layer plans are made on any thread and deleted on the thread that writes
+ * them, so the pool is shared. The buffers are passed in one batch per layer
+ * plan, so the lock is taken twice per layer rather than for every path.
+ */
+class PathPointsPool
+{
+public:
+    using Buffers = std::vector<std::vector<Point2LL>>;
+
+    static PathPointsPool& getInstance();
+
+    /*!
+     * \brief Take the buffers of a layer plan that was deleted before.
+     * \return Empty buffers with some capacity, or none if there are no
+     * recycled buffers.
+     */
+    [[nodiscard]] Buffers take();
+
+    /*!
+     * \brief Hand back the point buffers of a layer plan that is deleted.
+     * \param buffers The buffers, which don't need to be empty.
+     */
+    void give(Buffers buffers);
+
+private:
+    PathPointsPool() = default;
+
+    /*!
+     * The number of batches to keep. Only about as many layer plans as there
+     * are threads are planned at once, so more would just hold on to memory.
+     */
+    static constexpr size_t max_batches = 16;
+
+    std::mutex mutex_;
+    std::vector<Buffers> batches_; //!< The buffers of each deleted layer plan, all empty.
+};
+
+} // namespace cura
+
+#endif // PATH_PLANNING_PATH_POINTS_POOL_H
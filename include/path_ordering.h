@@ -5,6 +5,7 @@
 #define PATH_ORDER_PATH_H
 
 #include <optional>
+#include <vector>
 
 #include "settings/ZSeamConfig.h" //To get the seam settings.
 #include "utils/polygonUtils.h"
@@ -96,6 +97,18 @@ struct PathOrdering
      */
     const PointsSet& getVertexData();
 
+    /*!
+     * Get the corner angles of the vertices, if they were computed in advance,
+     * as PolygonUtils::cornerAngles computes them.
+     *
+     * Only some types of paths have these. For the other paths, this returns
+     * nullptr and the angles are computed when they are needed.
+     */
+    const std::vector<double>* getCornerAngles() const
+    {
+        return nullptr;
+    }
+
 protected:
     /*!
      * Some input data structures need to be converted to polygons before use.
@@ -108,6 +121,11 @@ protected:
     std::optional<PointsSet> cached_vertices_;
 };
 
+struct ExtrusionLine;
+
+template<>
+const std::vector<double>* PathOrdering<const ExtrusionLine*>::getCornerAngles() const;
+
 } // namespace cura
 
 #endif // PATH_ORDER_PATH_H
@@ -41,6 +41,8 @@
 #include <optional>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <vector>
 
 namespace cura::plugins
 {
@@ -180,21 +182,7 @@ public:
             boost::asio::detached);
         grpc_context.run();
 
-        if (! status.ok()) // TODO: handle different kind of status codes
-        {
-            if (plugin_info_.has_value())
-            {
-                spdlog::error(
-                    "Plugin '{}' running at [{}] for slot {} failed with error: {}",
-                    plugin_info_.value().plugin_name,
-                    plugin_info_.value().peer,
-                    slot_info_.slot_id,
-                    status.error_message());
-                throw exceptions::RemoteException(slot_info_, plugin_info_.value(), status.error_message());
-            }
-            spdlog::error("Plugin for slot {} failed with error: {}", slot_info_.slot_id, status.error_message());
-            throw exceptions::RemoteException(slot_info_, status.error_message());
-        }
+        checkStatus(status);
         return ret_value;
     }
 
@@ -213,22 +201,49 @@ public:
             boost::asio::detached);
         grpc_context.run();
 
-        if (! status.ok()) // TODO: handle different kind of status codes
+        checkStatus(status);
+        return ret_value;
+    }
+
+    /**
+     * @brief Modifies several values, with all their requests in flight at the same time.
+     *
+     * The round trips to the plugin overlap, instead of each request waiting for the response to the previous one.
+     *
+     * @param calls Random access range of tuples, each holding a reference to the value to modify followed by the other
+     * arguments of its request. Each value is replaced by its modified version.
+     */
+    void modifyAll(auto& calls)
+    {
+        agrpc::GrpcContext grpc_context;
+        std::vector<value_type> ret_values(std::size(calls));
+        std::vector<grpc::Status> statuses(std::size(calls));
+
+        for (size_t call_idx = 0; call_idx < std::size(calls); call_idx++)
         {
-            if (plugin_info_.has_value())
-            {
-                spdlog::error(
-                    "Plugin '{}' running at [{}] for slot {} failed with error: {}",
-                    plugin_info_.value().plugin_name,
-                    plugin_info_.value().peer,
-                    slot_info_.slot_id,
-                    status.error_message());
-                throw exceptions::RemoteException(slot_info_, plugin_info_.value(), status.error_message());
-            }
-            spdlog::error("Plugin for slot {} failed with error: {}", slot_info_.slot_id, status.error_message());
-            throw exceptions::RemoteException(slot_info_, status.error_message());
+            boost::asio::co_spawn(
+                grpc_context,
+                [this, &grpc_context, &statuses, &ret_values, &call = calls[call_idx], call_idx]()
+                {
+                    return std::apply(
+                        [this, &grpc_context, &statuses, &ret_values, call_idx](auto& original_value, auto&... args)
+                        {
+                            return this->modifyCall(grpc_context, statuses[call_idx], ret_values[call_idx], original_value, args...);
+                        },
+                        call);
+                },
+                boost::asio::detached);
+        }
+        grpc_context.run();
+
+        for (const grpc::Status& status : statuses)
+        {
+            checkStatus(status);
+        }
+        for (size_t call_idx = 0; call_idx < std::size(calls); call_idx++)
+        {
+            std::get<0>(calls[call_idx]) = std::move(ret_values[call_idx]);
         }
-        return ret_value;
     }
 
     template<plugins::v0::SlotID Subscription>
@@ -250,6 +265,18 @@ public:
             boost::asio::detached);
         grpc_context.run();
 
+        checkStatus(status);
+    }
+
+private:
+    /**
+     * @brief Logs and throws the error of a failed call to the plugin.
+     *
+     * @param status - Status of the gRPC call
+     * @throws exceptions::RemoteException if the call failed
+     */
+    void checkStatus(const grpc::Status& status) const
+    {
         if (! status.ok()) // TODO: handle different kind of status codes
         {
             if (plugin_info_.has_value())
@@ -267,7 +294,6 @@ public:
         }
     }
 
-private:
     inline static void prep_client_context(grpc::ClientContext& client_context, const slot_metadata& slot_info, const std::chrono::milliseconds& timeout = std::chrono::minutes(5))
     {
         // Set time-out
@@ -9,6 +9,7 @@
 #include <grpcpp/channel.h>
 #include <memory>
 #include <optional>
+#include <tuple>
 
 #include <boost/asio/use_awaitable.hpp>
 
@@ -95,6 +96,34 @@ public:
         return std::invoke(default_process, original_value, std::forward<decltype(args)>(args)...);
     }
 
+    /**
+     * @brief Modifies several values, with all their plugin requests in flight at the same time.
+     *
+     * @param calls Random access range of tuples, each holding a reference to the value to modify followed by the other
+     * arguments of `modify`. Each value is replaced by its modified version.
+     */
+    constexpr void modifyAll(auto& calls)
+    {
+        if (plugin_.has_value())
+        {
+            plugin_.value().modifyAll(calls);
+            return;
+        }
+        if constexpr (requires { requires Default::identity; })
+        {
+            return; // The values would only be copied onto themselves.
+        }
+        for (auto& call : calls)
+        {
+            std::get<0>(call) = std::apply(
+                [this](auto& original_value, auto&... args)
+                {
+                    return modify(original_value, args...);
+                },
+                call);
+        }
+    }
+
     template<v0::SlotID S>
     void broadcast(auto&&... args)
     {
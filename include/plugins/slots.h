@@ -29,6 +29,8 @@ namespace details
 {
 struct default_process
 {
+    static constexpr bool identity = true; //!< The values are returned unchanged, so modifying them without a plugin can be skipped.
+
     constexpr auto operator()(auto&& arg, auto&&...)
     {
         return std::forward<decltype(arg)>(arg);
@@ -150,6 +152,12 @@ public:
         return get<S>().modify(original_value, std::forward<decltype(args)>(args)...);
     }
 
+    template<v0::SlotID S>
+    constexpr void modifyAll(auto& calls)
+    {
+        get<S>().modifyAll(calls);
+    }
+
     template<v0::SlotID S>
     constexpr auto generate(auto&&... args)
     {
@@ -265,6 +273,11 @@ struct Slots
         return std::forward<decltype(data)>(data);
     }
 
+    template<plugins::v0::SlotID S>
+    constexpr void modifyAll(auto& calls) noexcept
+    {
+    }
+
     template<plugins::v0::SlotID S>
     constexpr auto broadcast(auto&&... args) noexcept
     {
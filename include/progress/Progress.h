@@ -5,17 +5,19 @@
 #define PROGRESS_H
 
 #include <array>
+#include <chrono>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
+#include "settings/types/Duration.h"
+#include "settings/types/LayerIndex.h"
 #include "utils/gettime.h"
 
 namespace cura
 {
 
-struct LayerIndex;
-
 static constexpr size_t N_PROGRESS_STAGES = 7;
 
 /*!
@@ -23,6 +25,11 @@ static constexpr size_t N_PROGRESS_STAGES = 7;
  *
  * The progress bar is based on a single slicing of a rather large model which needs some complex support;
  * the relative timing of each stage is currently based on that of the slicing of dragon_65_tilted_large.stl
+ *
+ * The remaining time is estimated from how fast this slice actually goes: the current stage is extrapolated from how
+ * far it got in the time it took so far, and the stages after it get the relative timing above, scaled by how long the
+ * stages so far took compared to that timing. In the export stage, the progress is counted in vertices of the layers
+ * instead of in layers, since those take about as long as they have vertices.
  */
 class Progress
 {
@@ -56,6 +63,21 @@ private:
     static std::array<double, N_PROGRESS_STAGES> accumulated_times; //!< Time past before each stage
     static double total_timing; //!< An estimate of the total time
     static std::optional<LayerIndex> first_skipped_layer; //!< The index of the layer for which we skipped time reporting
+
+    using clock_t = std::chrono::steady_clock;
+    static clock_t::time_point stage_start; //!< When the current stage started
+    static std::array<double, N_PROGRESS_STAGES> measured_times; //!< How long each stage before the current one took, in seconds
+    static std::vector<double> export_workload; //!< The work to export the layers up to and including each layer, from the first exported layer
+    static LayerIndex first_export_layer; //!< The layer that the export workload starts at
+
+    /*!
+     * Estimate how long the rest of the slice will take, from how fast it went so far.
+     *
+     * \param stage The current stage of processing
+     * \param stage_progress How far we currently are in the \p stage
+     * \return The estimate, or nothing if too little was done to tell yet.
+     */
+    static std::optional<Duration> estimateRemainingTime(Stage stage, double stage_progress);
     /*!
      * Give an estimate between 0 and 1 of how far the process is.
      *
@@ -76,6 +98,15 @@ public:
      */
     static void messageProgress(Stage stage, int progress_in_stage, int progress_in_stage_max);
 
+    /*!
+     * Set how much work each layer of the export stage is, to report the export progress by.
+     *
+     * \param first_layer The first layer that is exported. It can be negative if there is a raft.
+     * \param workload_per_layer A measure of how much work each layer is, like the number of vertices in it, starting at
+     * \p first_layer.
+     */
+    static void setExportWorkload(LayerIndex first_layer, const std::vector<double>& workload_per_layer);
+
     /*!
      * Message the progress stage over the command socket.
      *
@@ -0,0 +1,93 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef PROGRESS_SLOW_LAYER_CAPTURE_H
+#define PROGRESS_SLOW_LAYER_CAPTURE_H
+
+#include <atomic>
+#include <filesystem>
+#include <iosfwd>
+#include <vector>
+
+#include "geometry/SingleShape.h"
+#include "settings/Settings.h"
+#include "settings/types/LayerIndex.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Stores the input of the walls of layers that took long to generate,
+ * so that they can be run again without the model they came from.
+ *
+ * This only captures anything after it has been enabled with the
+ * --capture-slow-layers command line option. Each layer whose walls took
+ * longer than the threshold is written as a pair of files in the format of
+ * the test cases of the stress benchmark: the outlines of its parts as a WKT
+ * multipolygon, and the settings of its mesh as one "key=value" line each,
+ * see \ref writeSettings.
+ * Running the stress benchmark with --resources on the directory generates
+ * those walls again.
+ */
+class SlowLayerCapture
+{
+public:
+    static SlowLayerCapture& getInstance();
+
+    /*!
+     * \brief Start capturing.
+     * \param directory The directory to write the layers to. It's created when
+     * the first layer is captured.
+     * \param threshold How long the walls of a layer need to take to capture
+     * it, in seconds.
+     */
+    void enable(std::filesystem::path directory, double threshold);
+
+    [[nodiscard]] bool isEnabled() const
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] double threshold() const
+    {
+        return threshold_;
+    }
+
+    /*!
+     * \brief Write the input of the walls of a layer that took long.
+     * \param outlines The outlines of the parts of the layer, as they were
+     * before the walls were generated.
+     * \param settings The settings of the mesh.
+     * \param layer_nr The layer, for the name of the files.
+     * \param duration How long generating the walls took, in seconds.
+     */
+    void captureWalls(const std::vector<SingleShape>& outlines, const Settings& settings, LayerIndex layer_nr, double duration);
+
+    /*!
+     * \brief Write settings as one "key=value" line each, sorted by key.
+     *
+     * Backslashes and line breaks in the values, like those of the start
+     * g-code, are escaped as "\\\\", "\\n" and "\\r", so that every setting
+     * stays on one line.
+     */
+    static void writeSettings(std::ostream& out, const Settings& settings);
+
+    /*!
+     * \brief Read settings written by \ref writeSettings.
+     *
+     * Lines without a "=" are skipped.
+     */
+    static Settings readSettings(std::istream& in);
+
+private:
+    SlowLayerCapture() = default;
+
+    std::atomic<bool> enabled_{ false };
+    std::filesystem::path directory_;
+    double threshold_ = 0.0;
+    std::atomic<size_t> capture_count_{ 0 }; //!< To give the files of each layer a different name, even for layers of different meshes or mesh groups.
+};
+
+} // namespace cura
+
+#endif // PROGRESS_SLOW_LAYER_CAPTURE_H
@@ -0,0 +1,132 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef PROGRESS_TIMING_REPORT_H
+#define PROGRESS_TIMING_REPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "settings/types/LayerIndex.h"
+#include "utils/Coord_t.h"
+#include "utils/gettime.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Collects how long the stages of a slice take and writes them to a
+ * JSON file, for tools that track the performance of the engine over time.
+ *
+ * This only records anything after it has been enabled with the
+ * --timing-report command line option. The report holds:
+ * - the slicing stages, with the sub-stages that were timed within them,
+ * - how long each layer took to plan, per part of the planning, with its
+ *   height, thickness and number of parts,
+ * - per part of the layer planning, the slowest layers and a histogram of how
+ *   long it took in the layers, to find the layers and features that make a
+ *   slice slow,
+ * - the number of threads and the peak memory use at the end of each stage,
+ * - the memory that the slice data takes at the end of some stages, per member.
+ *
+ * The peak memory use is that of the whole process so far, so it only grows.
+ * A stage that raised it is one that needed more memory than any stage before.
+ */
+class TimingReport
+{
+public:
+    static TimingReport& getInstance();
+
+    /*!
+     * \brief Start recording.
+     * \param report_file The file to write the report to.
+     */
+    void enable(std::string report_file);
+
+    [[nodiscard]] bool isEnabled() const
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    //! Record a slicing stage that just ended, with the sub-stages recorded since the previous one.
+    void recordStage(std::string_view name, double duration);
+
+    //! Record sub-stages of the current stage.
+    void recordSubStages(const TimeKeeper::RegisteredTimes& times);
+
+    /*!
+     * \brief Record how much memory a member of the slice data takes at the
+     * end of the current stage.
+     * \see SliceDataStorage::memoryReport
+     */
+    void recordFootprint(std::string_view field, uint64_t points, uint64_t bytes);
+
+    /*!
+     * \brief Record how long planning a layer took, and how long each part of
+     * that took.
+     * \param layer_nr The layer that was planned.
+     * \param z The height of the layer.
+     * \param thickness The thickness of the layer.
+     * \param part_count The number of parts of all meshes in the layer.
+     * \param duration How long planning the layer took, in seconds.
+     * \param times How long each part of the planning took.
+     */
+    void recordLayer(LayerIndex layer_nr, coord_t z, coord_t thickness, size_t part_count, double duration, const TimeKeeper::RegisteredTimes& times);
+
+    //! Write the report, then start recording from scratch.
+    void report();
+
+private:
+    using clock_t = std::chrono::steady_clock;
+
+    static constexpr size_t hot_spot_count = 10; //!< The number of slowest layers to report per part of the layer planning.
+
+    struct Footprint
+    {
+        std::string field;
+        uint64_t points;
+        uint64_t bytes;
+    };
+
+    struct Stage
+    {
+        std::string name;
+        double start; //!< In seconds since recording started.
+        double duration;
+        std::optional<uint64_t> peak_rss; //!< In bytes, if it could be measured.
+        TimeKeeper::RegisteredTimes sub_stages;
+        std::vector<Footprint> footprint; //!< Of the slice data at the end of the stage, if it was recorded.
+    };
+
+    struct Layer
+    {
+        LayerIndex layer_nr;
+        coord_t z;
+        coord_t thickness;
+        size_t part_count;
+        double duration;
+        TimeKeeper::RegisteredTimes stages;
+    };
+
+    TimingReport() = default;
+
+    std::atomic<bool> enabled_{ false };
+    std::string report_file_;
+    clock_t::time_point origin_; //!< When recording started.
+    std::mutex mutex_;
+    std::vector<Stage> stages_;
+    TimeKeeper::RegisteredTimes pending_sub_stages_; //!< Recorded during the current stage, which didn't end yet.
+    std::vector<Footprint> pending_footprint_; //!< Recorded at the end of the current stage, which didn't end yet.
+    std::vector<Layer> layers_;
+};
+
+} // namespace cura
+
+#endif // PROGRESS_TIMING_REPORT_H
@@ -95,6 +95,9 @@ private:
 
     /*!
      * Stores the found slopes of each face using the same index.
+     *
+     * The faces are ordered by their minimum z, so that the faces that start
+     * below some height are a prefix of these arrays.
      */
     std::vector<double> face_slopes_;
     std::vector<int> face_min_z_values_;
@@ -112,7 +115,8 @@ private:
     void calculateLayers();
 
     /*!
-     * Calculates the slopes for each triangle in the mesh.
+     * Calculates the slopes for each triangle in the mesh, in parallel, and
+     * orders them by their minimum z.
      * These are uses later by calculateLayers to find the steepest triangle in a potential layer.
      */
     void calculateMeshTriangleSlopes();
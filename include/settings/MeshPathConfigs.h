@@ -26,9 +26,15 @@ struct MeshPathConfigs
     GCodePathConfig roofing_config{};
     std::vector<GCodePathConfig> infill_config{};
     GCodePathConfig ironing_config{};
+    GCodePathConfig fiber_config{}; //!< Printed with the outer wall extruder and its line width and speed.
 
     MeshPathConfigs(const SliceMeshStorage& mesh, const coord_t layer_thickness, const LayerIndex layer_nr, const std::vector<Ratio>& line_width_factor_per_extruder);
     void smoothAllSpeeds(const SpeedDerivatives& first_layer_config, const LayerIndex layer_nr, const LayerIndex max_speed_layer);
+
+    /*!
+     * Change the layer thickness of all configs, for another layer with the same configs.
+     */
+    void setLayerThickness(const coord_t layer_thickness);
 };
 
 } // namespace cura
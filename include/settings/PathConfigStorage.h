@@ -60,6 +60,27 @@ public:
      */
     PathConfigStorage(const SliceDataStorage& storage, const LayerIndex& layer_nr, const coord_t layer_thickness);
 
+    /*!
+     * \brief Make the configs of a layer from the configs of another layer
+     * that only differs in its thickness, without getting the settings again.
+     *
+     * \see isLayerInvariant
+     * \param layer_invariant_configs The configs of another layer for which
+     * \ref isLayerInvariant holds, like this layer.
+     * \param layer_thickness The thickness of this layer.
+     */
+    PathConfigStorage(const PathConfigStorage& layer_invariant_configs, const coord_t layer_thickness);
+
+    /*!
+     * \brief Whether the configs of a layer are the same as those of all layers
+     * above it, apart from the layer thickness.
+     *
+     * Only the first layers are different, because of the line width factor
+     * and the flows of the initial layer and the slower speeds of the first
+     * layers.
+     */
+    static bool isLayerInvariant(const LayerIndex& layer_nr);
+
 private:
     void handleInitialLayerSpeedup(const SliceDataStorage& storage, const LayerIndex& layer_nr, const size_t initial_speedup_layer_count);
 };
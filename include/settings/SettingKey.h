@@ -0,0 +1,139 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef SETTINGS_SETTING_KEY_H
+#define SETTINGS_SETTING_KEY_H
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace cura
+{
+
+/*!
+ * \brief The key of a setting, together with its hash.
+ *
+ * Setting keys are nearly always string literals, like
+ * ``settings.get<bool>("support_enable")``. For those the hash is computed at
+ * compile time, so looking up the setting neither allocates a string nor
+ * hashes it at run time. Keys that are only known at run time, such as the
+ * ones read from a JSON file, are hashed when the key is constructed.
+ *
+ * A SettingKey only refers to the characters of the key, so it must not
+ * outlive the string it was made from.
+ */
+class SettingKey
+{
+public:
+    /*!
+     * \brief Create a key from a string literal, hashing it at compile time.
+     */
+    template<size_t N>
+    consteval SettingKey(const char (&key)[N])
+        : key_(key, N - 1)
+        , hash_(hashOf(key_))
+    {
+    }
+
+    /*!
+     * \brief Create a key from a string that is only known at run time.
+     */
+    template<typename T>
+    requires std::convertible_to<const T&, std::string_view>
+    constexpr SettingKey(const T& key)
+        : key_(key)
+        , hash_(hashOf(key_))
+    {
+    }
+
+    [[nodiscard]] constexpr std::string_view view() const
+    {
+        return key_;
+    }
+
+    [[nodiscard]] std::string str() const
+    {
+        return std::string(key_);
+    }
+
+    [[nodiscard]] constexpr uint64_t hash() const
+    {
+        return hash_;
+    }
+
+    /*!
+     * \brief Hash the characters of a key, using 64-bit FNV-1a.
+     */
+    [[nodiscard]] static constexpr uint64_t hashOf(const std::string_view key)
+    {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const char c : key)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    /*!
+     * \brief Hasher for maps with std::string keys, which can be searched
+     * with a SettingKey without creating a string.
+     */
+    struct Hash
+    {
+        using is_transparent = void;
+
+        size_t operator()(const SettingKey& key) const
+        {
+            return static_cast<size_t>(key.hash());
+        }
+        size_t operator()(const std::string& key) const
+        {
+            return static_cast<size_t>(hashOf(key));
+        }
+    };
+
+    /*!
+     * \brief Equality for maps with std::string keys, which can be searched
+     * with a SettingKey.
+     */
+    struct Equal
+    {
+        using is_transparent = void;
+
+        template<typename A, typename B>
+        bool operator()(const A& a, const B& b) const
+        {
+            return viewOf(a) == viewOf(b);
+        }
+
+    private:
+        static std::string_view viewOf(const SettingKey& key)
+        {
+            return key.view();
+        }
+        static std::string_view viewOf(const std::string& key)
+        {
+            return key;
+        }
+    };
+
+    /*!
+     * \brief A map from setting keys to values, which can be searched with a
+     * SettingKey.
+     */
+    template<typename T>
+    using Map = std::unordered_map<std::string, T, Hash, Equal>;
+
+private:
+    std::string_view key_;
+    uint64_t hash_;
+};
+
+} // namespace cura
+
+#endif // SETTINGS_SETTING_KEY_H
@@ -13,11 +13,18 @@
 // Maximum number of infill layers that can be combined into a single infill extrusion area.
 #define MAX_INFILL_COMBINE 8
 
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "settings/SettingKey.h"
+
 namespace cura
 {
 
@@ -61,11 +68,12 @@ public:
      *     settings.
      *  4. If a setting is not known at all, an error is returned and the
      *     application is closed with an error value of 2.
-     * \param key The key of the setting to get.
+     * \param key The key of the setting to get. For string literals, its hash
+     * is computed at compile time.
      * \return The setting's value, cast to the desired type.
      */
     template<typename A>
-    A get(const std::string& key) const;
+    A get(const SettingKey& key) const;
 
     /*!
      * \brief Get a string containing all settings in this container.
@@ -87,7 +95,7 @@ public:
      * \return Whether that setting is contained in this particular Settings
      * instance (``true``) or would be obtained via inheritance (``false``).
      */
-    bool has(const std::string& key) const;
+    bool has(const SettingKey& key) const;
 
     /*
      * Change the parent settings object.
@@ -100,7 +108,81 @@ public:
 
     std::vector<std::string> getKeys() const;
 
+    /*!
+     * \brief Discard the cached setting values of all Settings containers.
+     *
+     * This happens automatically when settings are added or parents are
+     * changed. Call this when something else that setting lookups depend on
+     * changes, such as the limit_to_extruder mapping of the scene.
+     */
+    static void invalidateCaches();
+
 private:
+    /*!
+     * \brief Values that were already looked up in this container, per type.
+     *
+     * This saves walking the parent chain and parsing the string value again
+     * in the hot code paths that get the same settings over and over. The
+     * cache is only valid as long as its generation equals cache_generation_,
+     * which changes whenever any setting anywhere changes.
+     *
+     * Copies of a Settings container start with an empty cache.
+     */
+    struct ValueCache
+    {
+        ValueCache() = default;
+        ValueCache(const ValueCache&)
+        {
+        }
+        ValueCache& operator=(const ValueCache&)
+        {
+            std::unique_lock lock(mutex);
+            clear();
+            return *this;
+        }
+
+        void clear()
+        {
+            strings.clear();
+            doubles.clear();
+            size_ts.clear();
+            ints.clear();
+            bools.clear();
+        }
+
+        std::shared_mutex mutex; //!< Getting settings happens from many threads at the same time.
+        uint64_t generation = 0;
+        SettingKey::Map<std::string> strings;
+        SettingKey::Map<double> doubles;
+        SettingKey::Map<size_t> size_ts;
+        SettingKey::Map<int> ints;
+        SettingKey::Map<bool> bools;
+    };
+
+    /*!
+     * \brief Changes whenever a cached value of any Settings container might
+     * have become outdated.
+     *
+     * Starts at 1 so that a fresh cache doesn't count as valid.
+     */
+    static std::atomic<uint64_t> cache_generation_;
+
+    /*!
+     * \brief The cache of looked up values of this container.
+     */
+    mutable ValueCache cache_;
+
+    /*!
+     * \brief Get a value from the cache, or compute and cache it.
+     * \param values The map of the cache for the type of the value.
+     * \param key The key of the setting to get.
+     * \param compute Computes the value if it's not in the cache.
+     * \return The setting's value.
+     */
+    template<typename T, typename F>
+    T getCached(SettingKey::Map<T> ValueCache::*values, const SettingKey& key, F&& compute) const;
+
+
     /*!
      * Optionally, a parent setting container to ask for the value of a setting
      * if this container has no value for it.
@@ -110,7 +192,7 @@ private:
     /*!
      * \brief A dictionary to map the setting keys to the actual setting values.
      */
-    std::unordered_map<std::string, std::string> settings;
+    SettingKey::Map<std::string> settings;
 
     /*!
      * \brief Get the value of a setting, but without looking at the limiting to
@@ -121,7 +203,7 @@ private:
      * \param key The key of the setting to get.
      * \return The setting's value.
      */
-    std::string getWithoutLimiting(const std::string& key) const;
+    std::string getWithoutLimiting(const SettingKey& key) const;
 };
 
 } // namespace cura
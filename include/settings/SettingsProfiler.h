@@ -0,0 +1,124 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef SETTINGS_SETTINGS_PROFILER_H
+#define SETTINGS_SETTINGS_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "settings/SettingKey.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Counts how often each setting is looked up and how long that takes.
+ *
+ * This is only compiled in when building with ENABLE_SETTINGS_PROFILING, and
+ * then only records anything after it has been enabled with the
+ * --profile-settings command line option. The report tells which settings are
+ * worth hoisting out of loops.
+ *
+ * Every thread records into its own tables, which are merged when the report
+ * is made, so that profiling doesn't serialise the threads.
+ */
+class SettingsProfiler
+{
+public:
+    //! The deepest level of the parent chain that is counted separately. Deeper lookups are counted at this level.
+    static constexpr size_t max_depth = 7;
+
+    //! The statistics of looking up a single setting as a single type.
+    struct Stats
+    {
+        uint64_t calls = 0; //!< How often the setting was looked up.
+        uint64_t cache_hits = 0; //!< How many of those lookups were answered by the cache of the container that was asked.
+        std::chrono::nanoseconds duration{ 0 }; //!< Total time spent, including the time spent in nested lookups.
+    };
+
+    //! How often the value of a setting was found this many levels up the parent chain.
+    using Depths = std::array<uint64_t, max_depth + 1>;
+
+    /*!
+     * \brief Measures a single lookup for as long as it's in scope.
+     */
+    class Scope
+    {
+    public:
+        Scope(const char* type, const SettingKey& key);
+        ~Scope();
+
+        //! Mark that this lookup was answered by the cache.
+        void cacheHit()
+        {
+            cache_hit_ = true;
+        }
+
+    private:
+        const char* type_;
+        const SettingKey& key_;
+        bool active_;
+        bool cache_hit_ = false;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    static SettingsProfiler& getInstance();
+
+    /*!
+     * \brief Start recording lookups.
+     * \param report_file A CSV file to write the full report to, or empty to
+     * only log the most expensive settings.
+     */
+    void enable(std::string report_file);
+
+    [[nodiscard]] bool isEnabled() const
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Record at which level of the parent chain a string value was
+     * found.
+     * \param key The setting that was looked up.
+     * \param depth How many parents up the value was found.
+     */
+    void recordDepth(const SettingKey& key, size_t depth);
+
+    /*!
+     * \brief Log the settings that took the most time and write the full
+     * report, if a report file was given. Then start counting from zero again.
+     */
+    void report();
+
+private:
+    //! The statistics recorded by one thread, per type and then per setting.
+    struct ThreadTables
+    {
+        std::mutex mutex; //!< Only contended while a report is being made.
+        std::vector<std::pair<const char*, SettingKey::Map<Stats>>> per_type;
+        SettingKey::Map<Depths> depths;
+
+        SettingKey::Map<Stats>& forType(const char* type);
+    };
+
+    SettingsProfiler() = default;
+
+    ThreadTables& threadTables();
+
+    std::atomic<bool> enabled_{ false };
+    std::string report_file_;
+    std::mutex tables_mutex_;
+    std::vector<std::shared_ptr<ThreadTables>> tables_; //!< The tables of all threads that recorded something.
+};
+
+} // namespace cura
+
+#endif // SETTINGS_SETTINGS_PROFILER_H
@@ -14,6 +14,7 @@ class Shape;
 class SkinPart;
 class SliceLayerPart;
 class SliceMeshStorage;
+class SkinOutlineCache;
 
 /*!
  * Class containing all skin and infill area computation functions
@@ -30,8 +31,11 @@ public:
      * stored and where the skin insets and fill areas (output) are stored.
      * \param process_infill Whether to process infill, i.e. whether there's a
      * positive infill density or there are infill meshes modifying this mesh.
+     * \param outline_cache The intersections of the outlines of ranges of
+     * layers of this mesh, shared with the other layers. If null, the outlines
+     * of the layers around this one are intersected one by one.
      */
-    SkinInfillAreaComputation(const LayerIndex& layer_nr, SliceMeshStorage& mesh, bool process_infill);
+    SkinInfillAreaComputation(const LayerIndex& layer_nr, SliceMeshStorage& mesh, bool process_infill, SkinOutlineCache* outline_cache = nullptr);
 
     /*!
      * Generate the skin areas and its insets.
@@ -49,6 +53,17 @@ public:
      */
     static void combineInfillLayers(SliceMeshStorage& mesh);
 
+    /*!
+     * \brief Combine the skin of the layers above each part, to find where the
+     * infill needs walls under the edges of skin.
+     *
+     * This fills in SliceLayerPart::skin_above for every part of the mesh, in
+     * parallel per layer, so that writing the g-code only needs to intersect
+     * it with the infill.
+     * \param mesh The mesh to combine the skin of.
+     */
+    static void combineSkinAbove(SliceMeshStorage& mesh);
+
     /*!
      * \brief Generate infill areas which cause a gradually less dense infill
      * structure from top to bottom.
@@ -176,6 +191,7 @@ protected:
     coord_t bottom_skin_preshrink_; //!< The bottom skin removal width, to remove thin strips of skin along nearly-vertical walls.
     coord_t top_skin_expand_distance_; //!< The distance by which the top skins should be larger than the original top skins.
     coord_t bottom_skin_expand_distance_; //!< The distance by which the bottom skins should be larger than the original bottom skins.
+    SkinOutlineCache* outline_cache_; //!< The intersections of the outlines of ranges of layers, if they are shared with the other layers.
 
 private:
     static coord_t getSkinLineWidth(const SliceMeshStorage& mesh, const LayerIndex& layer_nr); //!< Compute the skin line width, which might be different for the first layer.
@@ -192,6 +208,18 @@ private:
      * \param layer2_nr The layer index from which to gather the outlines.
      */
     Shape getOutlineOnLayer(const SliceLayerPart& part_here, const LayerIndex layer2_nr);
+
+    /*!
+     * Intersect \p outlines with the outlines of each part which might
+     * intersect with \p part_here on the layers from \p first up to and
+     * including \p last.
+     *
+     * \param part_here The part for which to check.
+     * \param first The lowest layer of which to intersect the outlines.
+     * \param last The highest layer of which to intersect the outlines.
+     * \param[in,out] outlines The outlines to intersect.
+     */
+    void intersectOutlinesOnLayers(const SliceLayerPart& part_here, const LayerIndex first, const LayerIndex last, Shape& outlines);
 };
 
 } // namespace cura
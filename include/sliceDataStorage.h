@@ -7,10 +7,13 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <string>
+#include <vector>
 
 #include "SupportInfillPart.h"
 #include "TopSurface.h"
 #include "WipeScriptConfig.h"
+#include "geometry/CompactShape.h"
 #include "geometry/LinesSet.h"
 #include "geometry/MixedLinesSet.h"
 #include "geometry/OpenLinesSet.h"
@@ -23,7 +26,9 @@
 #include "settings/types/LayerIndex.h"
 #include "utils/AABB.h"
 #include "utils/AABB3D.h"
+#include "utils/LayerVector.h"
 #include "utils/NoCopy.h"
+#include "utils/SpillFile.h"
 
 namespace cura
 {
@@ -135,6 +140,15 @@ public:
      */
     std::vector<std::vector<Shape>> infill_area_per_combine_per_density;
 
+    /*!
+     * The skin on the skin_edge_support_layers above this part, within the own
+     * infill area of this part. The skin of different layers is combined with
+     * small gaps between them, so that their edges can be supported by infill
+     * walls. Empty if there are no skin edge support layers.
+     * \see FffGcodeWriter::partitionInfillBySkinAbove
+     */
+    Shape skin_above;
+
     /*!
      * Get the infill_area_own (or when it's not instantiated: the normal infill_area)
      * \see SliceLayerPart::infill_area_own
@@ -155,6 +169,9 @@ public:
      * \return true if there is at least one ExtrusionLine at the specified wall index, false otherwise
      */
     bool hasWallAtInsetIndex(size_t inset_idx) const;
+
+    std::optional<SpillFile::Record> spilled_walls; //!< Where the wall_toolpaths are stored while they are spilled to disk. \see SliceMeshStorage::spillWalls
+    std::vector<bool> spilled_wall_insets; //!< While the walls are spilled, for each inset index whether there is a wall at it.
 };
 
 /*!
@@ -200,6 +217,15 @@ public:
      */
     void getOutlines(Shape& result, bool external_polys_only = false) const;
 
+    /*!
+     * \brief Free the geometry that is only read to plan this layer and the
+     * layer above it, once those are planned.
+     *
+     * The outlines are kept, since planning the other layers around it reads
+     * them too.
+     */
+    void releasePlannedGeometry();
+
     ~SliceLayer();
 };
 
@@ -311,8 +337,8 @@ public:
     std::vector<AngleDegrees> roofing_angles; //!< a list of angle values which is cycled through to determine the roofing angle of each layer
     std::vector<AngleDegrees> skin_angles; //!< a list of angle values which is cycled through to determine the skin angle of each layer
     std::vector<Shape> overhang_areas; //!< For each layer the areas that are classified as overhang on this mesh.
-    std::vector<Shape> full_overhang_areas; //!< For each layer the full overhang without the tangent of the overhang angle removed, such that the overhang area adjoins the
-                                            //!< areas of the next layers.
+    std::vector<CompactShape> full_overhang_areas; //!< For each layer the full overhang without the tangent of the overhang angle removed, such that the overhang area
+                                                   //!< adjoins the areas of the next layers. Stored compactly, since it's kept for the whole slice but only read to generate support.
     std::vector<std::vector<Shape>> overhang_points; //!< For each layer a list of points where point-overhang is detected. This is overhang that hasn't got any surface area,
                                                      //!< such as a corner pointing downwards.
     AABB3D bounding_box; //!< the mesh's bounding box
@@ -324,6 +350,8 @@ public:
 
     RetractionAndWipeConfig retraction_wipe_config; //!< Per-Object retraction and wipe settings.
 
+    std::shared_ptr<SpillFile> wall_spill; //!< Where the walls of finished layers are moved to, or null to keep all walls in memory.
+
     /*!
      * \brief Creates a storage space for slice results of a mesh.
      * \param mesh The mesh that the storage space belongs to.
@@ -357,6 +385,55 @@ public:
      * \return the mesh's user specified z seam hint
      */
     Point2LL getZSeamHint() const;
+
+    /*!
+     * \brief Move the walls of a layer out of memory, into the spill file, if
+     * there is one.
+     *
+     * While the walls are spilled, SliceLayerPart::hasWallAtInsetIndex still
+     * works, but the walls need to be restored before reading them. Only this
+     * layer is changed, so different layers can be spilled at the same time.
+     * \param layer_nr The layer whose walls are finished.
+     */
+    void spillWalls(const LayerIndex layer_nr);
+
+    /*!
+     * \brief Take the spilled walls of a layer back into memory.
+     *
+     * Only this layer is changed, so different layers can be restored at the
+     * same time.
+     * \param layer_nr The layer whose walls are needed again.
+     */
+    void restoreWalls(const LayerIndex layer_nr);
+
+    /*!
+     * \brief Read the spilled walls of a part, without taking them back into
+     * memory.
+     * \param part A part of this mesh whose walls are spilled.
+     * \return The walls, or nothing if they couldn't be read.
+     */
+    std::optional<std::vector<VariableWidthLines>> readSpilledWalls(const SliceLayerPart& part) const;
+};
+
+/*!
+ * The combing boundaries of a layer of the model. See
+ * LayerPlan::computeModelCombBoundary.
+ */
+struct LayerCombBoundaries
+{
+    Shape minimum; //!< The minimum boundary within which to comb.
+    Shape preferred; //!< The boundary preferably within which to comb.
+};
+
+/*!
+ * How much memory one kind of geometry in the slice data takes, summed over
+ * all meshes and layers. See SliceDataStorage::memoryReport.
+ */
+struct StorageFootprint
+{
+    std::string field; //!< The name of the member, e.g. "part.inner_area".
+    size_t points = 0; //!< The number of points (or wall junctions) in it.
+    size_t bytes = 0; //!< An estimate of the bytes those take, from the number of points and paths. Spare capacity isn't counted.
 };
 
 class SliceDataStorage : public NoCopy
@@ -393,6 +470,13 @@ public:
     std::vector<Shape> ooze_shield; // oozeShield per layer
     Shape draft_protection_shield; //!< The polygons for a heightened skirt which protects from warping by gusts of wind and acts as a heated chamber.
 
+    /*!
+     * The combing boundaries per layer of the model, computed before the
+     * g-code is generated. Consecutive layers with the same boundaries share
+     * them. Empty if combing is off.
+     */
+    std::vector<std::shared_ptr<const LayerCombBoundaries>> comb_boundaries;
+
     /*!
      * \brief Creates a new slice data storage that stores the slice data of the
      * current mesh group.
@@ -441,6 +525,56 @@ public:
      */
     std::vector<bool> getExtrudersUsed(LayerIndex layer_nr) const;
 
+    /*!
+     * \brief Find the extruders used overall and on every layer once, so that
+     * getExtrudersUsed doesn't need to go over the areas again.
+     *
+     * The layers are checked in parallel. This needs to be called once the
+     * areas are complete, before the g-code is written: the areas of a layer
+     * are released while writing, and the extruders that were found stay.
+     */
+    void cacheExtrudersUsed();
+
+    /*!
+     * \brief Free the areas that were only needed to generate the support,
+     * once it is generated.
+     *
+     * This releases the overhang areas of the meshes and the areas of the
+     * support meshes and anti-overhang meshes.
+     */
+    void releaseSupportInputs();
+
+    /*!
+     * \brief Free the geometry of a layer of the meshes that is only needed to
+     * plan that layer and the layer above it, once those are planned.
+     *
+     * \see SliceLayer::releasePlannedGeometry
+     * \param layer_nr The layer that was planned (negative layer numbers
+     * indicate the raft, which has nothing to release).
+     */
+    void releasePlannedLayer(LayerIndex layer_nr);
+
+    /*!
+     * \brief Take the spilled walls of a layer of all meshes back into
+     * memory, to plan that layer.
+     *
+     * \see SliceMeshStorage::restoreWalls
+     * \param layer_nr The layer to plan (negative layer numbers indicate the
+     * raft, which has no walls).
+     */
+    void restoreSpilledLayer(LayerIndex layer_nr);
+
+    /*!
+     * \brief Count how much memory the geometry in this storage takes, per
+     * member of the layers, parts and support layers.
+     *
+     * This walks over all layers of all meshes, so it's only meant for
+     * reporting where the memory goes, not to be called along the way.
+     * \return The footprint per member, those that take the most bytes first.
+     * Members that are empty are left out.
+     */
+    std::vector<StorageFootprint> memoryReport() const;
+
     /*!
      * Gets whether prime blob is enabled for the given extruder number.
      *
@@ -460,10 +594,23 @@ public:
     void initializePrimeTower();
 
 private:
+    std::optional<std::vector<bool>> extruders_used_; //!< The extruders used overall, once they're cached. \see cacheExtrudersUsed
+    LayerVector<std::vector<bool>> extruders_used_per_layer_; //!< The extruders used on each layer, once they're cached. \see cacheExtrudersUsed
+
     /*!
      * Construct the retraction_wipe_config_per_extruder
      */
     std::vector<RetractionAndWipeConfig> initializeRetractionAndWipeConfigs();
+
+    /*!
+     * Find the extruders used from the areas, as returned by getExtrudersUsed.
+     */
+    std::vector<bool> computeExtrudersUsed() const;
+
+    /*!
+     * Find the extruders used on a layer from its areas, as returned by getExtrudersUsed.
+     */
+    std::vector<bool> computeExtrudersUsed(LayerIndex layer_nr) const;
 };
 
 } // namespace cura
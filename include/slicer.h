@@ -13,6 +13,8 @@
 #include "geometry/OpenPolyline.h"
 #include "geometry/Shape.h"
 #include "settings/EnumSettings.h"
+#include "utils/SparsePointGridInclusive.h"
+#include "utils/polygonUtils.h"
 
 /*
     The Slicer creates layers of polygons from an optimized 3D model.
@@ -86,8 +88,9 @@ protected:
      *
      * \param[in,out] open_polylines The polylines which are stiched, but couldn't be closed into a loop
      * \param[in] start_segment_idx The index into SlicerLayer::segments for the first segment from which to start the polygon loop
+     * \param[in,out] segment_start_grid The start points of all segments, built on first use. See findNearbyNextSegmentIdx.
      */
-    void makeBasicPolygonLoop(OpenLinesSet& open_polylines, const size_t start_segment_idx);
+    void makeBasicPolygonLoop(OpenLinesSet& open_polylines, const size_t start_segment_idx, std::optional<SparsePointGridInclusive<int>>& segment_start_grid);
 
     /*!
      * Get the next segment connected to the end of \p segment.
@@ -99,6 +102,22 @@ protected:
      */
     int getNextSegmentIdx(const SlicerSegment& segment, const size_t start_segment_idx) const;
 
+    /*!
+     * Get an unused segment that starts where \p segment ends, by location
+     * rather than by face adjacency.
+     *
+     * This is the fallback for when the adjacency of the faces is broken, as
+     * with non-manifold meshes. Chaining the segments here keeps those layers
+     * from falling apart into many tiny polylines, which would otherwise all
+     * have to be joined up by the much more expensive stitching.
+     *
+     * \param[in] segment The segment from which to start looking for the next
+     * \param[in] start_segment_idx The index to the segment which is preferred if it is close enough, since it closes the loop.
+     * \param[in,out] segment_start_grid The start points of all segments. Built on first use.
+     * \return The index of the closest segment, or -1 if there is none.
+     */
+    int findNearbyNextSegmentIdx(const SlicerSegment& segment, const size_t start_segment_idx, std::optional<SparsePointGridInclusive<int>>& segment_start_grid) const;
+
     /*!
      * Connecting polygons that are not closed yet, as models are not always perfect manifold we need to join some stuff up to get proper polygons.
      * First link up polygon ends that are within 2 microns.
@@ -118,9 +137,22 @@ protected:
      */
     void stitch(OpenLinesSet& open_polylines);
 
-    std::optional<GapCloserResult> findPolygonGapCloser(Point2LL ip0, Point2LL ip1);
+    /*!
+     * Find the shortest way along one of the closed polygons between the two ends of an open polyline, if both ends are on the same polygon.
+     *
+     * \param ip0 The one end.
+     * \param ip1 The other end.
+     * \param polygon_grid The segments of \ref SlicerLayer::polygons_, see \ref findPolygonPointClosestTo.
+     */
+    std::optional<GapCloserResult> findPolygonGapCloser(Point2LL ip0, Point2LL ip1, const LocToLineGrid& polygon_grid);
 
-    std::optional<ClosePolygonResult> findPolygonPointClosestTo(Point2LL input);
+    /*!
+     * Find the first segment of the closed polygons, in the order of \ref SlicerLayer::polygons_, that is close to a point.
+     *
+     * \param input The point to find a segment near to.
+     * \param polygon_grid The segments of \ref SlicerLayer::polygons_, so that only those near the point are tested.
+     */
+    std::optional<ClosePolygonResult> findPolygonPointClosestTo(Point2LL input, const LocToLineGrid& polygon_grid);
 
     /*!
      * Try to close up polylines into polygons while they have large gaps in them.
@@ -518,6 +550,23 @@ private:
      */
     static SlicerSegment project2D(const Point3LL& p0, const Point3LL& p1, const Point3LL& p2, const coord_t z);
 
+    /*! Groups the faces of a mesh per layer they intersect.
+     *
+     * The faces of layer \p i are bucket_faces[bucket_start[i] .. bucket_start[i + 1]).
+     * \param[in] zbboxes The z part of the bounding boxes of the faces of the mesh.
+     * \param[in] layers The layers to slice, ordered by ascending z.
+     * \param[out] bucket_start Offsets into \p bucket_faces, one per layer plus an end marker.
+     * \param[out] bucket_faces The face indices per layer, ascending within each layer.
+     */
+    static void buildFaceBuckets(
+        const std::vector<std::pair<int32_t, int32_t>>& zbboxes,
+        const std::vector<SlicerLayer>& layers,
+        std::vector<size_t>& bucket_start,
+        std::vector<unsigned int>& bucket_faces);
+
+public:
+    // The steps of slicing that the constructor goes through, which are public so that they can be benchmarked one by one.
+
     /*! Creates an array of "z bounding boxes" for each face.
      * \param[in] mesh The mesh which is analyzed.
      * \return z heights aka z bounding boxes of the faces.
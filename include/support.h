@@ -4,6 +4,7 @@
 #ifndef SUPPORT_H
 #define SUPPORT_H
 
+#include <atomic>
 #include <cstddef>
 #include <vector>
 
@@ -19,6 +20,7 @@ class SliceMeshStorage;
 class Slicer;
 class Polygon;
 class Shape;
+class SupportInterfaceOutlineCache;
 
 class AreaSupport
 {
@@ -151,15 +153,22 @@ private:
      * \param mesh_idx The index of the object for which to generate support
      * areas.
      * \param layer_count Total number of layers.
+     * \param support_areas[out] The support areas of the mesh per layer.
+     * \param layers_done The number of layers that all meshes processed so
+     * far, to report the progress with. The meshes may be processed
+     * concurrently.
+     * \return Whether support areas were generated for this mesh, i.e. whether
+     * it has support enabled and is tall enough to need any.
      */
-    static void generateSupportAreasForMesh(
-        SliceDataStorage& storage,
+    static bool generateSupportAreasForMesh(
+        const SliceDataStorage& storage,
         const Settings& infill_settings,
         const Settings& roof_settings,
         const Settings& bottom_settings,
         const size_t mesh_idx,
         const size_t layer_count,
-        std::vector<Shape>& support_areas);
+        std::vector<Shape>& support_areas,
+        std::atomic<size_t>& layers_done);
 
     /*!
      * Generate support bottom areas for a given mesh.
@@ -171,9 +180,14 @@ private:
      * \param storage Where to find the previously generated support areas and
      * where to output the new support bottom areas.
      * \param mesh The mesh to generate support for.
+     * \param mesh_outlines The unions of the outlines of the layers of the mesh.
      * \param global_support_areas_per_layer the global support areas on each layer.
      */
-    static void generateSupportBottom(SliceDataStorage& storage, const SliceMeshStorage& mesh, std::vector<Shape>& global_support_areas_per_layer);
+    static void generateSupportBottom(
+        SliceDataStorage& storage,
+        const SliceMeshStorage& mesh,
+        SupportInterfaceOutlineCache& mesh_outlines,
+        std::vector<Shape>& global_support_areas_per_layer);
 
     /*!
      * Generate support roof areas for a given mesh.
@@ -185,9 +199,14 @@ private:
      * \param storage Where to find the previously generated support areas and
      * where to output the new support roof areas.
      * \param mesh The mesh to generate support roof for.
+     * \param mesh_outlines The unions of the outlines of the layers of the mesh.
      * \param global_support_areas_per_layer the global support areas on each layer.
      */
-    static void generateSupportRoof(SliceDataStorage& storage, const SliceMeshStorage& mesh, std::vector<Shape>& global_support_areas_per_layer);
+    static void generateSupportRoof(
+        SliceDataStorage& storage,
+        const SliceMeshStorage& mesh,
+        SupportInterfaceOutlineCache& mesh_outlines,
+        std::vector<Shape>& global_support_areas_per_layer);
 
     /*!
      * \brief Generate a single layer of support interface.
@@ -197,9 +216,9 @@ private:
      *
      * \param support_areas The areas where support infill is going to be
      * printed.
-     * \param mesh_outlines The outlines of the mesh above or below the layer
-     * we're generating interface for. These layers determine what areas are
-     * going to be filled with the interface.
+     * \param model The union of the outlines of the mesh above or below the
+     * layer we're generating interface for. These layers determine what areas
+     * are going to be filled with the interface.
      * \param safety_offset An offset applied to the result to make sure
      * everything can be printed.
      * \param outline_offset An offset applied to the result outlines.
@@ -208,7 +227,7 @@ private:
      */
     static void generateSupportInterfaceLayer(
         Shape& support_areas,
-        const Shape mesh_outlines,
+        const Shape& model,
         const coord_t safety_offset,
         const coord_t outline_offset,
         const double minimum_interface_area,
@@ -317,14 +336,28 @@ private:
     static void cleanup(SliceDataStorage& storage);
 
 
+    /*!
+     * Closes and simplifies the outlines of every layer of a mesh, as used by
+     * generateVaryingXYDisallowedArea.
+     *
+     * Every layer compares its outline with the ones of the layers above and
+     * below, so these are computed once up front instead of three times.
+     *
+     * \param storage Data storage containing the input layer data.
+     * \return The closed outlines per layer.
+     */
+    static std::vector<Shape> generateClosedOutlines(const SliceMeshStorage& storage);
+
     /*!
      * generates varying xy disallowed areas for \param layer_idx where the offset distance is dependent on the wall angle
      *
      * \param storage Data storage containing the input layer data and
+     * \param closed_outlines The outlines of the layers of the mesh, as
+     * generated by generateClosedOutlines.
      * \param layer_idx The layer for which the disallowed areas are to be calcualted
      *
      */
-    static Shape generateVaryingXYDisallowedArea(const SliceMeshStorage& storage, const LayerIndex layer_idx);
+    static Shape generateVaryingXYDisallowedArea(const SliceMeshStorage& storage, const std::vector<Shape>& closed_outlines, const LayerIndex layer_idx);
 };
 
 
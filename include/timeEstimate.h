@@ -97,6 +97,9 @@ private:
 
     std::vector<Block> blocks;
 
+    size_t lookahead = 0; //!< How many blocks are planned ahead before the oldest ones are finalized, or 0 to plan all blocks together.
+    std::vector<Duration> finalized_times = std::vector<Duration>(static_cast<size_t>(PrintFeatureType::NumPrintFeatureTypes), 0.0); //!< Per feature, the time of finalized blocks.
+
 public:
     /*!
      * \brief Set the movement configuration of the firmware.
@@ -109,11 +112,30 @@ public:
     void setAcceleration(const Acceleration& acc); //!< Set the default acceleration to \p acc
     void setMaxXyJerk(const Velocity& jerk); //!< Set the max xy jerk to \p jerk
 
+    /*!
+     * \brief Limit how far ahead the speeds are planned, like the block buffer
+     * of a firmware.
+     *
+     * Once twice this many blocks are planned, all but the newest \p lookahead
+     * blocks are finalized: their time is added to the totals and they are
+     * forgotten. This keeps the memory use constant and the time linear in the
+     * number of moves.
+     * \param lookahead The number of blocks that are always planned ahead, or
+     * 0 to plan all blocks until \ref calculate is called.
+     */
+    void setLookahead(const size_t lookahead);
+
     void reset();
 
     std::vector<Duration> calculate();
 
 private:
+    /*!
+     * \brief Plan the blocks and finalize the oldest ones.
+     * \param count The number of blocks to finalize.
+     */
+    void finalizeOldestBlocks(const size_t count);
+
     void reversePass();
     void forwardPass();
 
@@ -0,0 +1,140 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_ALLOCATION_PROFILER_H
+#define UTILS_ALLOCATION_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace cura
+{
+
+/*!
+ * \brief Counts the heap allocations per slicing stage, to tell where pools or
+ * arenas would pay off.
+ *
+ * This only counts anything in a build with ENABLE_ALLOCATION_PROFILING,
+ * which replaces the global operator new and delete, and after it has been
+ * enabled with the --profile-allocations command line option. At the end of the slice, the number of allocations, the bytes
+ * allocated and the peak of the bytes that were live at once are logged for
+ * every progress stage, and for every sub-stage that a TimeKeeper registered.
+ *
+ * The progress stages count the allocations of all threads. A sub-stage only
+ * counts those of the thread that registered it, since the TimeKeepers don't
+ * know about the work they hand out to other threads.
+ *
+ * The counters are spread over a number of cache lines picked per thread, so
+ * that counting doesn't make all threads contend for the same one. That
+ * includes the live bytes, which are only summed up to update the peaks every
+ * time a thread has allocated another \ref peak_sample_bytes. Aligned
+ * allocations (of types that are aligned to more than a std::max_align_t)
+ * aren't counted.
+ */
+class AllocationProfiler
+{
+public:
+    //! A number of allocations and the bytes they allocated: those of a thread so far, or those of a sub-stage.
+    struct ThreadCounts
+    {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+    };
+
+    //! The statistics of the allocations in a stage.
+    struct Stats
+    {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        int64_t peak_live_bytes = 0; //!< The most bytes that were allocated at once while the stage ran, including those of earlier stages. Sampled, see \ref peak_sample_bytes.
+    };
+
+    //! The most progress stages that are kept apart. See Progress::Stage.
+    static constexpr size_t max_stages = 8;
+
+    //! How many bytes a thread allocates between the samples of the live bytes for the peaks, which therefore may miss up to this much per thread.
+    static constexpr uint64_t peak_sample_bytes = 1 << 20;
+
+    static AllocationProfiler& getInstance();
+
+    /*!
+     * \brief Start counting.
+     * \param report_file A CSV file to write the full report to, or empty to
+     * only log it.
+     */
+    void enable(std::string report_file);
+
+    [[nodiscard]] bool isEnabled() const
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Count the allocations from now on for a different progress stage.
+     * \param stage_idx The index of the stage, which is the same for the same
+     * stage in every mesh group.
+     * \param name The name of the stage, which needs to outlive the profiler.
+     */
+    void startStage(size_t stage_idx, std::string_view name);
+
+    //! The allocations of the calling thread so far.
+    [[nodiscard]] static ThreadCounts threadCounts();
+
+    /*!
+     * \brief Record the allocations of a sub-stage of the current stage.
+     * \param name The name of the sub-stage.
+     * \param start The allocations of this thread when the sub-stage started.
+     */
+    void recordSubStage(std::string_view name, const ThreadCounts& start);
+
+    /*!
+     * \brief Log the allocations per stage and write them to the report file,
+     * if one was given. Then start counting from zero again.
+     */
+    void report();
+
+    //! Count an allocation. Only for the replaced operator new.
+    void recordAllocation(size_t size);
+
+    //! Count a deallocation. Only for the replaced operator delete.
+    void recordDeallocation(size_t size);
+
+private:
+    static constexpr size_t counter_slots = 64; //!< The threads are spread over this many sets of counters.
+
+    //! The counters of some of the threads, per stage.
+    struct alignas(64) Slot
+    {
+        std::array<std::atomic<uint64_t>, max_stages> allocations{};
+        std::array<std::atomic<uint64_t>, max_stages> bytes{};
+        std::atomic<int64_t> live_bytes{ 0 }; //!< Allocated minus freed by these threads, which is negative if they free more than they allocate.
+    };
+
+    AllocationProfiler() = default;
+
+    //! The bytes that are allocated right now, by all threads.
+    [[nodiscard]] int64_t liveBytes() const;
+
+    //! Raise the peak of the live bytes of a stage to the bytes that are allocated right now.
+    void samplePeak(size_t stage_idx);
+
+    std::atomic<bool> enabled_{ false };
+    std::string report_file_;
+    std::atomic<size_t> stage_idx_{ 0 };
+    std::array<std::string_view, max_stages> stage_names_{};
+    std::array<Slot, counter_slots> slots_{};
+    std::array<std::atomic<int64_t>, max_stages> peak_live_bytes_{};
+
+    std::mutex sub_stages_mutex_;
+    std::map<std::pair<size_t, std::string>, ThreadCounts> sub_stages_; //!< Per stage index and sub-stage name.
+};
+
+} // namespace cura
+
+#endif // UTILS_ALLOCATION_PROFILER_H
@@ -0,0 +1,94 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_ARC_FITTER_H
+#define UTILS_ARC_FITTER_H
+
+#include <optional>
+#include <vector>
+
+#include "geometry/Point2LL.h"
+#include "utils/Coord_t.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Finds sequences of points in a path that lie on a circular arc, so
+ * that they can be written as a single G2 or G3 move.
+ *
+ * Round walls and holes consist of many short line segments. Printers have to
+ * read and plan each of them, which makes for big files and can starve the
+ * motion planner at high speeds. An arc move describes the same curve in a
+ * single command.
+ *
+ * A sequence of points is replaced by an arc only if:
+ * * All points lie within the tolerance of the arc.
+ * * No line segment deviates from the arc by more than the tolerance, so that
+ *   corners of polygons that happen to lie on a circle are kept.
+ * * All points go around the centre in the same direction, by less than a
+ *   quarter turn at a time.
+ * * The arc has at least \ref min_segments line segments, and a radius between
+ *   \ref min_radius and \ref max_radius.
+ *
+ * Since all points of a path are printed with the same line width and flow,
+ * arcs are only fitted within a path. Places where the width changes start a
+ * new path, so they are never covered by an arc.
+ */
+class ArcFitter
+{
+public:
+    //! An arc that replaces a sequence of line segments.
+    struct Arc
+    {
+        size_t first_point_idx; //!< The first point that the arc replaces. The arc starts at the point before it.
+        size_t last_point_idx; //!< The last point that the arc replaces, where the arc ends.
+        Point2LL center;
+        bool counter_clockwise;
+    };
+
+    //! Fewer line segments than this aren't worth replacing by an arc.
+    static constexpr size_t min_segments = 3;
+
+    //! Firmware splits arcs into segments of up to a millimetre, which would be coarser than the original points for very small arcs.
+    static constexpr coord_t min_radius = MM2INT(1.0);
+
+    //! The centres of arcs with a bigger radius can't be computed accurately, and lines are just as good for them.
+    static constexpr coord_t max_radius = MM2INT(1000.0);
+
+    //! Limits the time spent on checking long arcs, since every extension of an arc checks all of its points again.
+    static constexpr size_t max_segments = 128;
+
+    /*!
+     * \param tolerance How far the arc may deviate from the points and line
+     * segments that it replaces.
+     */
+    explicit ArcFitter(const coord_t tolerance);
+
+    /*!
+     * \brief Find the arcs in a path.
+     * \param start Where the path starts, before its first point.
+     * \param points The points of the path.
+     * \return The arcs that replace parts of the path, in order. They don't
+     * overlap.
+     */
+    std::vector<Arc> fit(const Point2LL& start, const std::vector<Point2LL>& points) const;
+
+private:
+    /*!
+     * \brief Check whether a sequence of points lies on an arc.
+     * \param start Where the path starts.
+     * \param points The points of the path.
+     * \param first The index of the first point of the sequence, where the
+     * start is index 0 and the points of the path come after it.
+     * \param last The index of the last point of the sequence.
+     * \return The arc through the sequence, or nothing if it isn't one.
+     */
+    std::optional<Arc> fitArc(const Point2LL& start, const std::vector<Point2LL>& points, const size_t first, const size_t last) const;
+
+    coord_t tolerance_;
+};
+
+} // namespace cura
+
+#endif // UTILS_ARC_FITTER_H
@@ -0,0 +1,91 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_CANCELLATION_TOKEN_H
+#define UTILS_CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <limits>
+
+namespace cura
+{
+
+/*!
+ * \brief Thrown by work that finds that it was cancelled, to unwind out of
+ * everything that depends on its results.
+ */
+class CancelledException : public std::exception
+{
+public:
+    const char* what() const noexcept override
+    {
+        return "The work was cancelled.";
+    }
+};
+
+/*!
+ * \brief Tells long-running work that it should stop, because the result is
+ * no longer needed or took too long.
+ *
+ * Cancelling is cooperative: the work checks \ref isCancelled once in a while,
+ * for instance between the chunks of a parallel loop, skips whatever is left
+ * and throws a \ref CancelledException. Any thread may cancel.
+ */
+class CancellationToken
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    //! Cancel the work.
+    void cancel()
+    {
+        cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Cancel the work once it runs past a point in time.
+     * \param time_limit How much longer the work may take from now.
+     */
+    void setTimeLimit(const std::chrono::duration<double> time_limit)
+    {
+        deadline_.store((clock_t::now() + std::chrono::duration_cast<clock_t::duration>(time_limit)).time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    //! Let the work take as long as it takes again.
+    void clearTimeLimit()
+    {
+        deadline_.store(no_deadline, std::memory_order_relaxed);
+    }
+
+    //! Whether the work was cancelled or ran past its deadline.
+    bool isCancelled() const
+    {
+        if (cancelled_.load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+        const clock_t::rep deadline = deadline_.load(std::memory_order_relaxed);
+        return deadline != no_deadline && clock_t::now().time_since_epoch().count() > deadline;
+    }
+
+    //! Throw a \ref CancelledException if the work was cancelled.
+    void throwIfCancelled() const
+    {
+        if (isCancelled())
+        {
+            throw CancelledException();
+        }
+    }
+
+private:
+    static constexpr clock_t::rep no_deadline = std::numeric_limits<clock_t::rep>::max();
+
+    std::atomic<bool> cancelled_ = false;
+    std::atomic<clock_t::rep> deadline_ = no_deadline; //!< The time since the epoch of the clock after which the work is cancelled.
+};
+
+} // namespace cura
+
+#endif // UTILS_CANCELLATION_TOKEN_H
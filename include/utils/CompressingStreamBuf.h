@@ -0,0 +1,125 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_COMPRESSING_STREAM_BUF_H
+#define UTILS_COMPRESSING_STREAM_BUF_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utils/NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * \brief A stream buffer that compresses everything written to it and writes
+ * the compressed data to a target stream.
+ *
+ * The data is collected in chunks. Full chunks are compressed on a background
+ * thread, so that whoever writes to the stream doesn't have to wait for the
+ * compression. If the background thread falls behind, writing blocks until it
+ * has caught up, so that the memory use stays limited.
+ *
+ * The compressed stream is only complete after \ref close has been called.
+ *
+ * Zstd compression is only available if CuraEngine is built with ENABLE_ZSTD.
+ */
+class CompressingStreamBuf : public std::streambuf, public NoCopy
+{
+public:
+    enum class Format
+    {
+        GZIP,
+        ZSTD,
+    };
+
+    //! Compresses chunks of data for one whole compressed stream.
+    class Compressor
+    {
+    public:
+        virtual ~Compressor() = default;
+
+        /*!
+         * \brief Compress the next part of the data.
+         * \param data The uncompressed data.
+         * \param finish Whether this is the end of the data, so that the
+         * compressed stream needs to be ended.
+         * \param target Where to write the compressed data.
+         */
+        virtual void compress(const std::string_view data, const bool finish, std::ostream& target) = 0;
+    };
+
+    //! How much data is collected before it's given to the background thread.
+    static constexpr size_t chunk_size = 1 << 20;
+
+    //! How many chunks may wait for the background thread before writing blocks.
+    static constexpr size_t max_pending_chunks = 4;
+
+    /*!
+     * \brief Find out how a file should be compressed from its extension.
+     * \param file_name The name of the file.
+     * \return The compression format, or nothing if the file shouldn't be
+     * compressed or if its format isn't available in this build.
+     */
+    static std::optional<Format> formatFromFileName(const std::string_view file_name);
+
+    /*!
+     * \brief Create a compressor for a format.
+     * \return The compressor, or nullptr if the format isn't available in this
+     * build.
+     */
+    static std::unique_ptr<Compressor> makeCompressor(const Format format);
+
+    /*!
+     * \param target The stream to write the compressed data to. It must outlive this buffer.
+     * \param format How to compress the data.
+     */
+    CompressingStreamBuf(std::ostream& target, const Format format);
+
+    //! Closes the stream, if that hasn't been done yet.
+    ~CompressingStreamBuf() override;
+
+    /*!
+     * \brief Compress everything that has been written so far, end the
+     * compressed stream and wait until it's written to the target.
+     *
+     * Writing anything after this fails, so that the stream it's written
+     * with gets its badbit set.
+     */
+    void close();
+
+protected:
+    int_type overflow(int_type character) override;
+
+private:
+    //! Give the data in the put area to the background thread, and start a new put area.
+    void submitChunk();
+
+    //! What the background thread does: compress the chunks in order, until the buffer is closed.
+    void compressChunks();
+
+    std::ostream& target_;
+    std::unique_ptr<Compressor> compressor_;
+    std::vector<char> put_area_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_; //!< Notified when a chunk is given to or completed by the background thread, and when closing.
+    std::deque<std::vector<char>> pending_chunks_; //!< Chunks that haven't been compressed yet, in order.
+    std::vector<std::vector<char>> spare_chunks_; //!< Chunks that have been compressed, whose memory can be used again.
+    bool closing_ = false;
+    bool closed_ = false;
+    std::thread worker_;
+};
+
+} // namespace cura
+
+#endif // UTILS_COMPRESSING_STREAM_BUF_H
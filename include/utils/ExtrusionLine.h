@@ -5,6 +5,9 @@
 #ifndef UTILS_EXTRUSION_LINE_H
 #define UTILS_EXTRUSION_LINE_H
 
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
 #include <range/v3/view/enumerate.hpp>
 #include <range/v3/view/reverse.hpp>
 #include <range/v3/view/sliding.hpp>
@@ -25,6 +28,15 @@ namespace cura
  */
 struct ExtrusionLine
 {
+    /*!
+     * How many junctions are stored in the line itself, before they are moved
+     * to the heap. Most gap fillers and odd walls are only a handful of
+     * junctions long, so they don't need an allocation of their own.
+     */
+    static constexpr size_t inline_junction_count = 8;
+
+    using Junctions = boost::container::small_vector<ExtrusionJunction, inline_junction_count>;
+
     /*!
      * Which inset this path represents, counted from the outside inwards.
      *
@@ -51,7 +63,18 @@ struct ExtrusionLine
      *
      * Each junction has a width, making this path a variable-width path.
      */
-    std::vector<ExtrusionJunction> junctions_;
+    Junctions junctions_;
+
+    /*!
+     * The corner angle at each junction of a closed path, as computed by
+     * PolygonUtils::cornerAngles to place the seam, if they are computed in
+     * advance with \ref computeCornerAngles.
+     *
+     * These are only used while there are as many as there are junctions.
+     * Changing the positions of the junctions without changing their number
+     * should clear these.
+     */
+    std::vector<double> corner_angles_;
 
     /*!
      * Gets the number of vertices in this polygon.
@@ -92,12 +115,23 @@ struct ExtrusionLine
         , is_odd_(other.is_odd_)
         , is_closed_(other.is_closed_)
         , junctions_(other.junctions_)
+        , corner_angles_(other.corner_angles_)
+    {
+    }
+
+    ExtrusionLine(ExtrusionLine&& other) noexcept
+        : inset_idx_(other.inset_idx_)
+        , is_odd_(other.is_odd_)
+        , is_closed_(other.is_closed_)
+        , junctions_(std::move(other.junctions_))
+        , corner_angles_(std::move(other.corner_angles_))
     {
     }
 
-    ExtrusionLine& operator=(ExtrusionLine&& other)
+    ExtrusionLine& operator=(ExtrusionLine&& other) noexcept
     {
         junctions_ = std::move(other.junctions_);
+        corner_angles_ = std::move(other.corner_angles_);
         inset_idx_ = other.inset_idx_;
         is_odd_ = other.is_odd_;
         is_closed_ = other.is_closed_;
@@ -107,6 +141,7 @@ struct ExtrusionLine
     ExtrusionLine& operator=(const ExtrusionLine& other)
     {
         junctions_ = other.junctions_;
+        corner_angles_ = other.corner_angles_;
         inset_idx_ = other.inset_idx_;
         is_odd_ = other.is_odd_;
         is_closed_ = other.is_closed_;
@@ -114,32 +149,32 @@ struct ExtrusionLine
     }
 
 
-    std::vector<ExtrusionJunction>::const_iterator begin() const
+    Junctions::const_iterator begin() const
     {
         return junctions_.begin();
     }
 
-    std::vector<ExtrusionJunction>::const_iterator end() const
+    Junctions::const_iterator end() const
     {
         return junctions_.end();
     }
 
-    std::vector<ExtrusionJunction>::const_reverse_iterator rbegin() const
+    Junctions::const_reverse_iterator rbegin() const
     {
         return junctions_.rbegin();
     }
 
-    std::vector<ExtrusionJunction>::const_reverse_iterator rend() const
+    Junctions::const_reverse_iterator rend() const
     {
         return junctions_.rend();
     }
 
-    std::vector<ExtrusionJunction>::const_reference front() const
+    Junctions::const_reference front() const
     {
         return junctions_.front();
     }
 
-    std::vector<ExtrusionJunction>::const_reference back() const
+    Junctions::const_reference back() const
     {
         return junctions_.back();
     }
@@ -154,22 +189,22 @@ struct ExtrusionLine
         return junctions_[index];
     }
 
-    std::vector<ExtrusionJunction>::iterator begin()
+    Junctions::iterator begin()
     {
         return junctions_.begin();
     }
 
-    std::vector<ExtrusionJunction>::iterator end()
+    Junctions::iterator end()
     {
         return junctions_.end();
     }
 
-    std::vector<ExtrusionJunction>::reference front()
+    Junctions::reference front()
     {
         return junctions_.front();
     }
 
-    std::vector<ExtrusionJunction>::reference back()
+    Junctions::reference back()
     {
         return junctions_.back();
     }
@@ -191,7 +226,7 @@ struct ExtrusionLine
     }
 
     template<class iterator>
-    std::vector<ExtrusionJunction>::iterator insert(std::vector<ExtrusionJunction>::const_iterator pos, iterator first, iterator last)
+    Junctions::iterator insert(Junctions::const_iterator pos, iterator first, iterator last)
     {
         return junctions_.insert(pos, first, last);
     }
@@ -226,12 +261,29 @@ struct ExtrusionLine
         return ret;
     }
 
+    /*!
+     * Whether a point is inside the polygon through the junctions of this path,
+     * which is treated as closed. This is the same test as that of a Polygon,
+     * without converting the path to one.
+     *
+     * \param p The point to test.
+     * \param border_result What to return when the point is exactly on the
+     * path.
+     */
+    bool inside(const Point2LL& p, bool border_result = false) const;
+
     /*!
      * Get the minimal width of this path
      */
     coord_t getMinimalWidth() const;
 
     bool shorterThan(const coord_t check_length) const;
+
+    /*!
+     * Compute the corner angles of a closed path in advance, so that they
+     * don't need to be computed when its seam is placed.
+     */
+    void computeCornerAngles();
 };
 
 using VariableWidthLines = std::vector<ExtrusionLine>; //<! The ExtrusionLines generated by libArachne
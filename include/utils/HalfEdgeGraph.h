@@ -7,6 +7,7 @@
 
 #include <list>
 #include <cassert>
+#include <memory_resource>
 
 
 
@@ -18,14 +19,38 @@ namespace cura
 {
     using namespace cura;
 
+/*!
+ * A graph of half-edges and the nodes they connect.
+ *
+ * The edges and nodes refer to each other by pointer, so they are stored in
+ * lists, which never move their elements. The list elements are allocated from
+ * an arena owned by the graph, which hands out consecutive pieces of large
+ * chunks. That way building a graph of many thousands of edges takes a handful
+ * of allocations instead of one per element, elements that were created after
+ * each other lie next to each other in memory, and all of it is freed at once
+ * when the graph is destroyed. Memory of erased elements is only reclaimed
+ * then as well.
+ */
 template<class node_data_t, class edge_data_t, class derived_node_t, class derived_edge_t> // types of data contained in nodes and edges
 class HalfEdgeGraph
 {
 public:
     using edge_t = derived_edge_t;
     using node_t = derived_node_t;
-    std::list<edge_t> edges;
-    std::list<node_t> nodes;
+
+    HalfEdgeGraph() = default;
+    HalfEdgeGraph(const HalfEdgeGraph&) = delete; // The elements refer to each other, so can't be copied element-wise.
+    HalfEdgeGraph& operator=(const HalfEdgeGraph&) = delete;
+
+private:
+    //! Size of the first chunk of the arena. Every next chunk is larger.
+    static constexpr size_t initial_arena_size = 64 * 1024;
+
+    std::pmr::monotonic_buffer_resource arena_{ initial_arena_size }; // Must be declared before the lists, so that it outlives them.
+
+public:
+    std::pmr::list<edge_t> edges{ &arena_ };
+    std::pmr::list<node_t> nodes{ &arena_ };
 };
 
 } // namespace cura
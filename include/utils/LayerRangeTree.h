@@ -0,0 +1,135 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_LAYER_RANGE_TREE_H
+#define UTILS_LAYER_RANGE_TREE_H
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cura
+{
+
+/*!
+ * \brief A segment tree over the layers of a mesh, which combines the values
+ * of ranges of layers when they are first asked for.
+ *
+ * Every node of the tree holds the combination of the values of the layers it
+ * covers. Any range of layers is covered by a few of those nodes, independent
+ * of how many layers it spans, and each node is only computed once for all
+ * ranges that need it.
+ *
+ * It's safe to ask for ranges from multiple threads at the same time.
+ *
+ * \tparam T The type of value of a layer and of a combination of layers.
+ */
+template<typename T>
+class LayerRangeTree
+{
+public:
+    /*!
+     * \param layer_count The number of layers to cover.
+     * \param layer_value Computes the value of a single layer.
+     * \param combine Combines the values of two neighbouring ranges of layers,
+     * the lower one first.
+     * \param absorbs (optional) Whether combining a value of a lower range
+     * with anything gives that value again, like an empty intersection. The
+     * upper range then doesn't need to be computed.
+     */
+    LayerRangeTree(
+        const size_t layer_count,
+        std::function<T(size_t)> layer_value,
+        std::function<T(const T&, const T&)> combine,
+        std::function<bool(const T&)> absorbs = nullptr)
+        : layer_count_(layer_count)
+        , nodes_(4 * std::max(layer_count, size_t(1)))
+        , layer_value_(std::move(layer_value))
+        , combine_(std::move(combine))
+        , absorbs_(std::move(absorbs))
+    {
+    }
+
+    //! The number of layers that the tree covers.
+    size_t layerCount() const
+    {
+        return layer_count_;
+    }
+
+    /*!
+     * Get the values of the nodes that together cover the layers from \p first
+     * up to \p last (exclusive), from the bottom up, computing them if needed.
+     *
+     * The range must lie within the layers of the tree.
+     */
+    std::vector<const T*> cover(const size_t first, const size_t last)
+    {
+        std::vector<const T*> result;
+        if (first < last)
+        {
+            collect(1, 0, layer_count_, first, last, result);
+        }
+        return result;
+    }
+
+private:
+    struct Node
+    {
+        std::once_flag computed;
+        T value; //!< The combination of the values of the layers of this node, once computed.
+    };
+
+    size_t layer_count_;
+    std::vector<Node> nodes_; //!< The segment tree, with the root at index 1 and the children of node i at 2i and 2i + 1.
+    std::function<T(size_t)> layer_value_;
+    std::function<T(const T&, const T&)> combine_;
+    std::function<bool(const T&)> absorbs_;
+
+    //! Get the value of a node of the tree, which covers the layers from \p begin up to \p end, computing it if needed.
+    const T& node(const size_t node_idx, const size_t begin, const size_t end)
+    {
+        Node& node = nodes_[node_idx];
+        // A node only waits for its children while it's computed, so threads that need the same nodes can't wait for each other in a cycle.
+        std::call_once(
+            node.computed,
+            [&]()
+            {
+                if (end - begin == 1)
+                {
+                    node.value = layer_value_(begin);
+                    return;
+                }
+                const size_t middle = (begin + end) / 2;
+                const T& below = this->node(2 * node_idx, begin, middle);
+                if (absorbs_ && absorbs_(below))
+                {
+                    node.value = below;
+                    return;
+                }
+                node.value = combine_(below, this->node(2 * node_idx + 1, middle, end));
+            });
+        return node.value;
+    }
+
+    //! Collect the nodes that together cover the layers from \p first up to \p last (exclusive), from the bottom up.
+    void collect(const size_t node_idx, const size_t begin, const size_t end, const size_t first, const size_t last, std::vector<const T*>& result)
+    {
+        if (last <= begin || end <= first)
+        {
+            return;
+        }
+        if (first <= begin && end <= last)
+        {
+            result.push_back(&node(node_idx, begin, end));
+            return;
+        }
+        const size_t middle = (begin + end) / 2;
+        collect(2 * node_idx, begin, middle, first, last, result);
+        collect(2 * node_idx + 1, middle, end, first, last, result);
+    }
+};
+
+} // namespace cura
+#endif // UTILS_LAYER_RANGE_TREE_H
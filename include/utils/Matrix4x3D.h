@@ -4,6 +4,9 @@
 #ifndef MATRIX4X3D_H
 #define MATRIX4X3D_H
 
+#include <span>
+
+#include "geometry/Point2LL.h"
 #include "settings/types/Ratio.h"
 
 namespace cura
@@ -59,6 +62,28 @@ public:
      * \return A transformed coordinate.
      */
     Point3LL apply(const Point3LL& p) const;
+
+    /*!
+     * Apply this transformation to a batch of integer-based points at the same
+     * height, in place, keeping only the transformed X and Y.
+     *
+     * This gives exactly the same result as converting each point to
+     * millimeters and applying this transformation to it as a ``Point3D``, but
+     * the coordinates are processed in blocks of contiguous arrays, which the
+     * compiler can vectorize.
+     * \param points The points to transform.
+     * \param z The height of the points, in millimeters.
+     */
+    void applyXY(std::span<Point2LL> points, const double z) const;
+
+    /*!
+     * Compose this transformation with another one.
+     * \param other The transformation to apply first.
+     * \return A transformation that applies \p other, and then this one.
+     */
+    Matrix4x3D compose(const Matrix4x3D& other) const;
+
+    bool operator==(const Matrix4x3D& other) const = default;
 };
 
 } // namespace cura
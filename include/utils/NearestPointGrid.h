@@ -0,0 +1,209 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_NEAREST_POINT_GRID_H
+#define UTILS_NEAREST_POINT_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "geometry/Point2LL.h"
+#include "utils/Coord_t.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Finds the nearest of a set of points, while points are removed from
+ * the set.
+ *
+ * The points are bucketed in a dense grid over their bounding box, with about
+ * as many cells as there are points. A query searches rings of cells around
+ * the query point, outwards, until no unsearched cell can contain a point that
+ * is closer than the best one found so far. Removed points are taken out of
+ * their cell, so that they don't slow down later queries.
+ *
+ * All points must be given up front. Only removing them is supported.
+ *
+ * \tparam ElemT The element stored with each point. If several points are
+ * equally near, the one with the lowest element is reported, so this needs to
+ * be ordered.
+ */
+template<class ElemT>
+class NearestPointGrid
+{
+public:
+    /*!
+     * \brief Create a grid containing the given points.
+     * \param points The points, each with the element that is reported when
+     * that point is the nearest.
+     */
+    explicit NearestPointGrid(const std::vector<std::pair<Point2LL, ElemT>>& points)
+        : size_(points.size())
+    {
+        if (points.empty())
+        {
+            return;
+        }
+        min_ = points.front().first;
+        Point2LL max = points.front().first;
+        for (const auto& [point, elem] : points)
+        {
+            min_.X = std::min(min_.X, point.X);
+            min_.Y = std::min(min_.Y, point.Y);
+            max.X = std::max(max.X, point.X);
+            max.Y = std::max(max.Y, point.Y);
+        }
+
+        // Aim for about one point per cell, but don't let the grid degenerate into very many cells if the points are all on a line.
+        const double width = static_cast<double>(max.X - min_.X);
+        const double height = static_cast<double>(max.Y - min_.Y);
+        const double count = static_cast<double>(points.size());
+        cell_size_ = std::max(coord_t(1), static_cast<coord_t>(std::ceil(std::max(std::sqrt(width * height / count), std::max(width, height) / count))));
+        width_ = (max.X - min_.X) / cell_size_ + 1;
+        height_ = (max.Y - min_.Y) / cell_size_ + 1;
+
+        cells_.resize(width_ * height_);
+        for (const auto& [point, elem] : points)
+        {
+            cellAt((point.X - min_.X) / cell_size_, (point.Y - min_.Y) / cell_size_).emplace_back(point, elem);
+        }
+    }
+
+    /*!
+     * \brief Whether all points have been removed.
+     */
+    [[nodiscard]] bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    /*!
+     * \brief Remove a point from the grid.
+     *
+     * The point must have been given to the constructor with this element,
+     * and not have been removed yet.
+     * \param point The location of the point.
+     * \param elem The element that was stored with the point.
+     */
+    void remove(const Point2LL& point, const ElemT& elem)
+    {
+        std::vector<std::pair<Point2LL, ElemT>>& cell = cellAt((point.X - min_.X) / cell_size_, (point.Y - min_.Y) / cell_size_);
+        const auto found = std::find(cell.begin(), cell.end(), std::make_pair(point, elem));
+        if (found == cell.end())
+        {
+            return;
+        }
+        *found = cell.back();
+        cell.pop_back();
+        size_--;
+    }
+
+    /*!
+     * \brief Find the point that is nearest to a query point.
+     * \param query_point The point to search around.
+     * \return The element stored with the nearest point, or nothing if the
+     * grid is empty.
+     */
+    [[nodiscard]] std::optional<ElemT> findNearest(const Point2LL& query_point) const
+    {
+        if (empty())
+        {
+            return std::nullopt;
+        }
+
+        const coord_t query_x = floorDiv(query_point.X - min_.X);
+        const coord_t query_y = floorDiv(query_point.Y - min_.Y);
+        // The first ring that overlaps the grid, and the ring after which the whole grid has been searched.
+        const coord_t first_ring = std::max({ coord_t(0), -query_x, query_x - (width_ - 1), -query_y, query_y - (height_ - 1) });
+        const coord_t last_ring = std::max({ query_x, width_ - 1 - query_x, query_y, height_ - 1 - query_y });
+
+        std::optional<ElemT> best;
+        coord_t best_distance2 = std::numeric_limits<coord_t>::max();
+        const auto search_cell = [&](const coord_t x, const coord_t y)
+        {
+            for (const auto& [point, elem] : cellAt(x, y))
+            {
+                const coord_t distance2 = vSize2(point - query_point);
+                if (! best || distance2 < best_distance2 || (distance2 == best_distance2 && elem < *best))
+                {
+                    best = elem;
+                    best_distance2 = distance2;
+                }
+            }
+        };
+
+        for (coord_t ring = first_ring; ring <= last_ring; ring++)
+        {
+            const coord_t min_x = std::max(coord_t(0), query_x - ring);
+            const coord_t max_x = std::min(width_ - 1, query_x + ring);
+            const coord_t min_y = std::max(coord_t(0), query_y - ring);
+            const coord_t max_y = std::min(height_ - 1, query_y + ring);
+            for (coord_t x = min_x; x <= max_x; x++)
+            {
+                if (query_y - ring >= 0)
+                {
+                    search_cell(x, query_y - ring);
+                }
+                if (ring > 0 && query_y + ring < height_)
+                {
+                    search_cell(x, query_y + ring);
+                }
+            }
+            for (coord_t y = std::max(min_y, query_y - ring + 1); y <= std::min(max_y, query_y + ring - 1); y++)
+            {
+                if (query_x - ring >= 0)
+                {
+                    search_cell(query_x - ring, y);
+                }
+                if (ring > 0 && query_x + ring < width_)
+                {
+                    search_cell(query_x + ring, y);
+                }
+            }
+
+            // Any point in a later ring is further than `ring` whole cells away.
+            const coord_t searched_radius = ring * cell_size_;
+            if (best && best_distance2 <= searched_radius * searched_radius)
+            {
+                break;
+            }
+        }
+        return best;
+    }
+
+private:
+    std::vector<std::pair<Point2LL, ElemT>>& cellAt(const coord_t x, const coord_t y)
+    {
+        return cells_[y * width_ + x];
+    }
+
+    const std::vector<std::pair<Point2LL, ElemT>>& cellAt(const coord_t x, const coord_t y) const
+    {
+        return cells_[y * width_ + x];
+    }
+
+    /*!
+     * \brief Divide by the cell size, rounding down also for negative numbers,
+     * which happen for query points outside of the grid.
+     */
+    coord_t floorDiv(const coord_t offset) const
+    {
+        return offset >= 0 ? offset / cell_size_ : -((-offset + cell_size_ - 1) / cell_size_);
+    }
+
+    size_t size_; //!< The number of points that haven't been removed.
+    Point2LL min_; //!< The lowest corner of the grid.
+    coord_t cell_size_ = 1;
+    coord_t width_ = 0; //!< The number of cells in the X direction.
+    coord_t height_ = 0; //!< The number of cells in the Y direction.
+    std::vector<std::vector<std::pair<Point2LL, ElemT>>> cells_; //!< The points in each cell, row by row.
+};
+
+} // namespace cura
+
+#endif // UTILS_NEAREST_POINT_GRID_H
@@ -67,7 +67,7 @@ public:
     static bool isOdd(const Path& line);
 
 private:
-    static void pushToClosedResult(OutputPaths& result_polygons, const Path& polyline);
+    static void pushToClosedResult(OutputPaths& result_polygons, Path&& polyline);
 };
 
 } // namespace cura
@@ -0,0 +1,124 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_RADIUS_LAYER_CACHE_H
+#define UTILS_RADIUS_LAYER_CACHE_H
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "geometry/Shape.h"
+#include "settings/types/LayerIndex.h"
+
+namespace cura
+{
+
+/*!
+ * \brief A cache of areas per radius and layer, which can be read without
+ * locking while other threads add to it.
+ *
+ * The areas are stored per radius, in dense arrays indexed by layer. Once an
+ * area is added it is never changed or moved, so the references handed out
+ * stay valid until the area is evicted. Adding an area for a radius and layer
+ * that are already in the cache leaves the existing area alone.
+ *
+ * Only adding and evicting areas takes a lock. Moving the cache is not
+ * thread-safe.
+ */
+class RadiusLayerCache
+{
+public:
+    RadiusLayerCache() = default;
+    ~RadiusLayerCache();
+    RadiusLayerCache(RadiusLayerCache&& other) noexcept;
+    RadiusLayerCache& operator=(RadiusLayerCache&& other) noexcept;
+    RadiusLayerCache(const RadiusLayerCache&) = delete;
+    RadiusLayerCache& operator=(const RadiusLayerCache&) = delete;
+
+    /*!
+     * \brief Get the area of a radius on a layer, if it has been added.
+     * \param radius The radius of the area.
+     * \param layer_idx The layer of the area.
+     * \return The area, or nothing if it wasn't added yet.
+     */
+    [[nodiscard]] std::optional<std::reference_wrapper<const Shape>> get(const coord_t radius, const LayerIndex layer_idx) const;
+
+    [[nodiscard]] bool contains(const coord_t radius, const LayerIndex layer_idx) const
+    {
+        return get(radius, layer_idx).has_value();
+    }
+
+    /*!
+     * \brief Get the highest layer up to which the areas of a radius have been
+     * added without gaps, or -1 if there are none.
+     *
+     * The areas on model don't exist on layer 0, as there can't be a model
+     * below it, so this may start counting at layer 1.
+     */
+    [[nodiscard]] LayerIndex getMaxCalculatedLayer(const coord_t radius) const;
+
+    /*!
+     * \brief Add the area of a radius on a layer.
+     *
+     * Areas on negative layers are ignored.
+     */
+    void insert(const coord_t radius, const LayerIndex layer_idx, const Shape& area);
+
+    /*!
+     * \brief Add many areas at once.
+     * \param data A range of pairs of a (radius, layer) key and an area.
+     */
+    template<typename Range>
+    void insert(const Range& data)
+    {
+        std::lock_guard lock(*mutex_);
+        for (const auto& [key, area] : data)
+        {
+            insertLocked(key.first, key.second, area);
+        }
+    }
+
+    /*!
+     * \brief Free the areas of all radii above a layer.
+     *
+     * They are simply missing from the cache afterwards, so they will be
+     * recalculated if they are needed again. No other thread may be using
+     * areas above the layer while they are evicted.
+     * \param layer_idx The highest layer to keep.
+     */
+    void evictAbove(const LayerIndex layer_idx);
+
+private:
+    static constexpr size_t chunk_size = 256; //!< The number of layers in each block of the per-radius arrays.
+    static constexpr size_t max_chunks = 1024; //!< The number of blocks per radius, which limits the number of layers.
+
+    using Chunk = std::array<std::atomic<const Shape*>, chunk_size>;
+
+    //! The areas of a single radius.
+    struct RadiusEntry
+    {
+        coord_t radius;
+        std::array<std::atomic<Chunk*>, max_chunks> chunks{}; //!< Blocks of layers, made when an area is first added to them.
+        LayerIndex max_layer = -1; //!< The highest layer that an area was added to since the last eviction.
+        const RadiusEntry* next = nullptr; //!< The radius that was added before this one.
+    };
+
+    [[nodiscard]] const RadiusEntry* findEntry(const coord_t radius) const;
+
+    //! Add an area while holding the lock.
+    void insertLocked(const coord_t radius, const LayerIndex layer_idx, const Shape& area);
+
+    std::atomic<const RadiusEntry*> head_{ nullptr }; //!< The most recently added radius. The others can be found through RadiusEntry::next.
+    std::unique_ptr<std::mutex> mutex_ = std::make_unique<std::mutex>(); //!< Held while adding areas.
+    std::vector<std::unique_ptr<RadiusEntry>> entries_; //!< Owns the entries of all radii.
+    std::vector<std::unique_ptr<Chunk>> chunks_; //!< Owns the blocks of all radii. The blocks own the areas they point to.
+};
+
+} // namespace cura
+
+#endif // UTILS_RADIUS_LAYER_CACHE_H
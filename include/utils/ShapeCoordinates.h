@@ -0,0 +1,126 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_SHAPE_COORDINATES_H
+#define UTILS_SHAPE_COORDINATES_H
+
+#include <span>
+#include <vector>
+
+#include "geometry/Point2LL.h"
+#include "utils/AABB.h"
+#include "utils/polygonUtils.h" //For ClosestPointPolygon.
+
+namespace cura
+{
+
+class Shape;
+
+/*!
+ * \brief The points of a shape with their X and Y coordinates in separate
+ * arrays, for the geometric queries that are done very often on the same shape.
+ *
+ * The first point of each polygon is repeated after its last point, so that all
+ * segments of a polygon, the closing one included, are consecutive pairs of
+ * points. The queries then loop over plain arrays without branches, which the
+ * compiler can vectorize. The coordinates are stored as doubles, which hold
+ * them exactly, since that's what the queries compute with and what most
+ * vector instructions support. Making this copy takes about as long as a single
+ * query on the shape itself, so it only pays off when a shape is queried many
+ * times, like finding the closest point for each of a lot of points.
+ *
+ * For inside tests on shapes with a lot of edges, the edges can also be sorted
+ * into horizontal bands, so that each test only goes over the edges at the
+ * height of the point.
+ *
+ * The shape is referenced by the results of findClosest, so it needs to outlive
+ * this.
+ */
+class ShapeCoordinates
+{
+public:
+    /*!
+     * \param shape The shape to copy the coordinates of.
+     * \param index_edges Whether to sort the edges into horizontal bands, for
+     * when a lot of points are going to be tested with inside. This is only
+     * done when the shape has enough edges for it to help.
+     */
+    explicit ShapeCoordinates(const Shape& shape, bool index_edges = false);
+
+    /*!
+     * The bounding box of all points of the shape.
+     */
+    [[nodiscard]] AABB bounds() const;
+
+    /*!
+     * The area of the shape, where holes have a negative area, like
+     * Shape::area.
+     */
+    [[nodiscard]] double area() const;
+
+    /*!
+     * Whether a point is inside the shape, like Shape::inside.
+     * \param p The point to check.
+     * \param border_result What to return when the point is exactly on the
+     * border.
+     */
+    [[nodiscard]] bool inside(const Point2LL& p, bool border_result = false) const;
+
+    /*!
+     * Whether each of a number of points is inside the shape, like
+     * Shape::inside.
+     * \param points The points to check.
+     * \param border_result What to return for points that are exactly on the
+     * border.
+     * \return For each point, whether it's inside.
+     */
+    [[nodiscard]] std::vector<bool> inside(std::span<const Point2LL> points, bool border_result = false) const;
+
+    /*!
+     * \brief Find the closest point on the border of the shape.
+     *
+     * This is the same point as PolygonUtils::findClosest without a penalty
+     * function, except that two segments at practically the same distance may
+     * be chosen the other way around.
+     * \param from The point to find the closest point to.
+     * \return The closest point, or an invalid result if the shape has no
+     * points.
+     */
+    [[nodiscard]] ClosestPointPolygon findClosest(const Point2LL& from) const;
+
+private:
+    //! The shapes need to have at least this many edges for sorting them into bands to be faster.
+    static constexpr size_t min_indexed_edges = 64;
+
+    /*!
+     * The edges that are at least partly within a horizontal band of the
+     * shape, with their coordinates in separate arrays.
+     */
+    struct EdgeBand
+    {
+        std::vector<double> x0_;
+        std::vector<double> y0_;
+        std::vector<double> x1_;
+        std::vector<double> y1_;
+    };
+
+    const Shape& shape_;
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<size_t> path_starts_; //!< Where the points of each polygon start in the arrays, with the end of the arrays at the back.
+
+    std::vector<EdgeBand> bands_; //!< The edges sorted into bands from the bottom up, if they are indexed.
+    double bands_min_y_ = 0.0; //!< The bottom of the lowest band.
+    double bands_max_y_ = 0.0; //!< The top of the highest band.
+    double band_height_ = 0.0;
+
+    /*!
+     * Sort the edges of polygons that can contain points into bands of the
+     * same height.
+     */
+    void indexEdges();
+};
+
+} // namespace cura
+
+#endif // UTILS_SHAPE_COORDINATES_H
@@ -0,0 +1,97 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_SHAPE_LOCATOR_H
+#define UTILS_SHAPE_LOCATOR_H
+
+#include <limits>
+#include <memory>
+
+#include "geometry/Point2LL.h"
+#include "utils/ShapeCoordinates.h"
+#include "utils/polygonUtils.h"
+
+namespace cura
+{
+
+class Shape;
+
+/*!
+ * \brief Finds the points on the border of a shape near given points, for when
+ * a lot of points need to be located on the same shape.
+ *
+ * The segments of the shape are put in a grid once. Points that are within a
+ * cell of the border are then only compared to the segments around them, and
+ * the other points to all segments at once with ShapeCoordinates. Either way
+ * the result is the same as that of the functions in PolygonUtils that go over
+ * all segments without a penalty function, apart from which of two equally
+ * close segments is chosen.
+ *
+ * The shape is referenced by the results, so it needs to outlive this.
+ */
+class ShapeLocator
+{
+public:
+    /*!
+     * \param shape The shape to locate points on.
+     * \param cell_size The size of the cells of the grid. Points that are
+     * within this distance of the border are located the fastest.
+     */
+    ShapeLocator(const Shape& shape, coord_t cell_size);
+
+    [[nodiscard]] const Shape& shape() const;
+
+    /*!
+     * The grid with the segments of the shape, for the functions in
+     * PolygonUtils that use one.
+     */
+    [[nodiscard]] const LocToLineGrid& grid() const;
+    [[nodiscard]] LocToLineGrid& grid();
+
+    /*!
+     * Find the point on the border of the shape closest to \p from, like
+     * PolygonUtils::findClosest.
+     * \return The closest point, or an invalid result if the shape is empty.
+     */
+    [[nodiscard]] ClosestPointPolygon findClosest(const Point2LL& from) const;
+
+    /*!
+     * Find the vertex of the shape closest to \p from, like
+     * PolygonUtils::findNearestVert.
+     */
+    [[nodiscard]] PolygonsPointIndex findNearestVert(const Point2LL& from) const;
+
+    /*!
+     * Move a point to the inside or the outside of the shape, like
+     * PolygonUtils::moveInside2.
+     * \param from[in,out] The point to move.
+     * \param distance The distance by which to move the point inside, or
+     * outside if it's negative.
+     * \param max_dist2 The squared distance from the border beyond which the
+     * point isn't moved.
+     * \return The point on the border closest to \p from.
+     */
+    ClosestPointPolygon moveInside(Point2LL& from, int distance = 0, int64_t max_dist2 = std::numeric_limits<int64_t>::max()) const;
+
+    /*!
+     * Move a point to the inside or the outside of the shape, and check that it
+     * ended up there, like PolygonUtils::ensureInsideOrOutside.
+     * \param from[in,out] The point to move.
+     * \param preferred_dist_inside The distance by which to move the point
+     * inside, or outside if it's negative.
+     * \param max_dist2 The squared distance from the border beyond which the
+     * point isn't moved.
+     * \return The point on the border closest to \p from, or an invalid result
+     * if the point couldn't be moved to the correct side.
+     */
+    ClosestPointPolygon ensureInsideOrOutside(Point2LL& from, int preferred_dist_inside, int64_t max_dist2 = std::numeric_limits<int64_t>::max()) const;
+
+private:
+    const Shape& shape_;
+    std::unique_ptr<LocToLineGrid> grid_;
+    ShapeCoordinates coordinates_; //!< For the points that are farther than a cell from the border.
+};
+
+} // namespace cura
+
+#endif // UTILS_SHAPE_LOCATOR_H
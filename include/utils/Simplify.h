@@ -4,6 +4,8 @@
 #ifndef UTILS_SIMPLIFY_H
 #define UTILS_SIMPLIFY_H
 
+#include <vector>
+
 #include "geometry/Point2LL.h"
 #include "utils/Coord_t.h"
 
@@ -90,6 +92,8 @@ public:
 
     /*!
      * Simplify a batch of polygons.
+     *
+     * Large batches are simplified in parallel.
      * \param polygons The polygons to simplify.
      * \return The simplified polygons.
      */
@@ -112,7 +116,8 @@ public:
     /*!
      * Simplify a batch of polylines.
      *
-     * The endpoints of each polyline cannot be altered.
+     * The endpoints of each polyline cannot be altered. Large batches are
+     * simplified in parallel.
      * \param polylines The polylines to simplify.
      * \return The simplified polylines.
      */
@@ -154,6 +159,17 @@ public:
      */
     ExtrusionLine polyline(const ExtrusionLine& polyline) const;
 
+    /*!
+     * Simplify a batch of variable-line-width lines, each as a polygon if it is
+     * closed or as a polyline if it isn't.
+     *
+     * Lines that are simplified away entirely are left out. Large batches are
+     * simplified in parallel.
+     * \param lines The lines to simplify.
+     * \return The simplified lines.
+     */
+    std::vector<ExtrusionLine> lines(const std::vector<ExtrusionLine>& lines) const;
+
 protected:
     /*!
      * Line segments smaller than this should not occur in the output.
@@ -162,31 +178,55 @@ protected:
      */
     constexpr static coord_t min_resolution = 5; // 5 units, regardless of how big those are, to allow for rounding errors.
 
+    /*!
+     * Batches with fewer vertices than this are simplified on the calling
+     * thread, since spreading them over the thread pool costs more than it
+     * gains.
+     */
+    constexpr static size_t parallel_vertex_count = 10000;
+
+    /*!
+     * The vertices of a polygonal that are not about to get deleted, as a
+     * doubly linked list over their indices.
+     *
+     * This way the neighbours of a vertex are found right away, instead of by
+     * skipping over all the deleted vertices in between.
+     *
+     * The list loops around. If the polygonal is a polyline, the endpoints of
+     * the polyline may never be deleted so it should never be an issue.
+     */
+    struct RemainingVertices
+    {
+        std::vector<size_t> previous; //!< For each remaining vertex, the index of the remaining vertex before it.
+        std::vector<size_t> next; //!< For each remaining vertex, the index of the remaining vertex after it.
+        std::vector<bool> deleted; //!< For each vertex, whether it is to be deleted.
+
+        explicit RemainingVertices(const size_t size);
+
+        //! Start over with all of the vertices of a polygonal of this size, keeping the allocated memory.
+        void reset(const size_t size);
+
+        //! Mark a vertex to be deleted, linking its neighbours to each other.
+        void erase(const size_t index);
+    };
+
     /*!
      * Helper method to find the index of the next vertex that is not about to
      * get deleted.
-     *
-     * This method assumes that the polygon is looping. If it is a polyline, the
-     * endpoints of the polyline may never be deleted so it should never be an
-     * issue.
      * \param index The index of the current vertex.
-     * \param to_delete For each vertex, whether it is to be deleted.
+     * \param remaining The vertices that are not to be deleted.
      * \return The index of the vertex afterwards.
      */
-    size_t nextNotDeleted(size_t index, const std::vector<bool>& to_delete) const;
+    size_t nextNotDeleted(size_t index, const RemainingVertices& remaining) const;
 
     /*!
      * Helper method to find the index of the previous vertex that is not about
      * to get deleted.
-     *
-     * This method assumes that the polygon is looping. If it is a polyline, the
-     * endpoints of the polyline may never be deleted so it should never be an
-     * issue.
      * \param index The index of the current vertex.
-     * \param to_delete For each vertex, whether it is to be deleted.
+     * \param remaining The vertices that are not to be deleted.
      * \return The index of the vertex before it.
      */
-    size_t previousNotDeleted(size_t index, const std::vector<bool>& to_delete) const;
+    size_t previousNotDeleted(size_t index, const RemainingVertices& remaining) const;
 
     /*!
      * Append a vertex to this polygon.
@@ -295,7 +335,7 @@ private:
      * A measure of the importance of a vertex.
      * \tparam Polygonal A polygonal object, which is a list of vertices.
      * \param polygon The polygon or polyline the vertex is part of.
-     * \param to_delete For each vertex, whether it is set to be deleted.
+     * \param remaining The vertices that are not set to be deleted.
      * \param index The vertex index to compute the importance of.
      * \param is_closed Whether the polygon is closed (a polygon) or open
      * (a polyline).
@@ -303,7 +343,7 @@ private:
      * that the vertex should probably be retained in the output.
      */
     template<typename Polygonal>
-    coord_t importance(const Polygonal& polygon, const std::vector<bool>& to_delete, const size_t index, const bool is_closed) const;
+    coord_t importance(const Polygonal& polygon, const RemainingVertices& remaining, const size_t index, const bool is_closed) const;
 
     /*!
      * Mark a vertex for removal.
@@ -313,8 +353,8 @@ private:
      * to delete an edge, fusing two vertices together.
      * \tparam Polygonal A polygonal object, which is a list of vertices.
      * \param polygon The polygon to remove a vertex from.
-     * \param to_delete The vertices that have been marked for deletion so far.
-     * This will be edited in-place.
+     * \param remaining The vertices that have not been marked for deletion so
+     * far. This will be edited in-place.
      * \param vertex The index of the vertex to remove.
      * \param deviation2 The previously found deviation for this vertex.
      * \param is_closed Whether we're working on a closed polygon or an open
@@ -322,7 +362,7 @@ private:
      * polyline.
      */
     template<typename Polygonal>
-    bool remove(Polygonal& polygon, std::vector<bool>& to_delete, const size_t vertex, const coord_t deviation2, const bool is_closed) const;
+    bool remove(Polygonal& polygon, RemainingVertices& remaining, const size_t vertex, const coord_t deviation2, const bool is_closed) const;
 };
 
 } // namespace cura
@@ -5,9 +5,13 @@
 #ifndef UTILS_SPARSE_GRID_H
 #define UTILS_SPARSE_GRID_H
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cstdint>
 #include <functional>
-#include <unordered_map>
+#include <limits>
+#include <utility>
 #include <vector>
 
 #include "SquareGrid.h"
@@ -17,6 +21,19 @@ namespace cura
 {
 
 /*! \brief Sparse grid which can locate spatially nearby elements efficiently.
+ *
+ * The elements are stored in a single array, in the order in which they were
+ * inserted, and the cells are in a flat hash table with open addressing. Each
+ * cell links the elements in it as a chain through the array. Unlike a hash map
+ * with a node per element, this doesn't allocate memory for every element, and
+ * looking up a cell mostly stays within one cache line of the table.
+ * The elements in a cell are processed in the order in which they were
+ * inserted.
+ *
+ * When all elements are known up front, the grid can be built at once instead,
+ * with the constructors of the subclasses that take all elements. The table of
+ * cells is then sized once, and the elements of each cell end up next to each
+ * other.
  *
  * \note This is an abstract template class which doesn't have any functions to insert elements.
  * \see SparsePointGrid
@@ -31,38 +48,47 @@ public:
 
     using GridPoint = SquareGrid::GridPoint;
     using grid_coord_t = SquareGrid::grid_coord_t;
-    using GridMap = std::unordered_multimap<GridPoint, Elem>;
+    using GridElem = std::pair<const GridPoint, Elem>; //!< An element, with the cell it's in.
 
-    using iterator = typename GridMap::iterator;
-    using const_iterator = typename GridMap::const_iterator;
+    using iterator = typename std::vector<GridElem>::iterator;
+    using const_iterator = typename std::vector<GridElem>::const_iterator;
 
     /*! \brief Constructs a sparse grid with the specified cell size.
      *
      * \param[in] cell_size The size to use for a cell (square) in the grid.
      *    Typical values would be around 0.5-2x of expected query radius.
      * \param[in] elem_reserve Number of elements to research space for.
-     * \param[in] max_load_factor Maximum average load factor before rehashing.
+     * \param[in] max_load_factor Maximum fraction of the cell table that may be
+     *    in use before it grows. Since the table uses open addressing, this is
+     *    limited to \ref max_cell_load_factor.
      */
     SparseGrid(coord_t cell_size, size_t elem_reserve = 0U, double max_load_factor = 1.0);
 
+    /*! \brief Iterate over all elements, with the cells they are in.
+     *
+     * The elements are in the order in which they were inserted, except when
+     * the grid was built at once. Then they are grouped by cell, in the order
+     * in which the cells first got an element. An element that was inserted in
+     * multiple cells occurs once for each of them.
+     */
     iterator begin()
     {
-        return grid_.begin();
+        return elems_.begin();
     }
 
     iterator end()
     {
-        return grid_.end();
+        return elems_.end();
     }
 
     const_iterator begin() const
     {
-        return grid_.begin();
+        return elems_.begin();
     }
 
     const_iterator end() const
     {
-        return grid_.end();
+        return elems_.end();
     }
 
     /*! \brief Returns all data within radius of query_pt.
@@ -124,6 +150,28 @@ public:
     bool processLine(const std::pair<Point2LL, Point2LL> query_line, const std::function<bool(const Elem&)>& process_elem_func) const;
 
 protected:
+    //! The cell table is kept at most this full, so that probing stays short.
+    static constexpr double max_cell_load_factor = 0.75;
+
+    /*! \brief Add an element to the cell indicated by \p grid_pt.
+     *
+     * \param[in] grid_pt The grid coordinates of the cell.
+     * \param[in] elem The element to add.
+     */
+    void insertIntoCell(const GridPoint& grid_pt, const Elem& elem);
+
+    /*! \brief Add a lot of elements at once.
+     *
+     * If the grid is still empty, this counts the elements of each cell and
+     * then puts them in place, so that the elements of each cell are next to
+     * each other. Otherwise they are inserted one by one. Either way, the grid
+     * ends up with the same elements in each cell, in the same order, as if
+     * they were inserted one by one.
+     * \param[in] cell_elems Each element with the cell to add it to, in the
+     *    order in which they would otherwise be inserted.
+     */
+    void insertIntoCells(std::vector<std::pair<GridPoint, Elem>>&& cell_elems);
+
     /*! \brief Process elements from the cell indicated by \p grid_pt.
      *
      * \param[in] grid_pt The grid coordinates of the cell.
@@ -133,8 +181,29 @@ protected:
      */
     bool processFromCell(const GridPoint& grid_pt, const std::function<bool(const Elem&)>& process_func) const;
 
-    /*! \brief Map from grid locations (GridPoint) to elements (Elem). */
-    GridMap grid_;
+private:
+    //! Marks the end of the chain of elements of a cell, or a slot of the cell table that's not in use.
+    static constexpr uint32_t no_elem = std::numeric_limits<uint32_t>::max();
+
+    //! A slot of the cell table.
+    struct Cell
+    {
+        GridPoint grid_pt_;
+        uint32_t first_elem_ = no_elem; //!< The index in \ref elems_ of the first element in this cell, or no_elem if the slot isn't in use.
+        uint32_t last_elem_ = no_elem; //!< The index in \ref elems_ of the last element in this cell, to append to the chain.
+    };
+
+    /*! \brief The slot of the cell table where a cell is, or should be put if it isn't in the table. */
+    size_t findSlot(const GridPoint& grid_pt) const;
+
+    /*! \brief Make the cell table at least big enough for \p cell_count cells, and put the cells in their new slots. */
+    void reserveCells(size_t cell_count);
+
+    std::vector<GridElem> elems_; //!< All elements, with the cell they are in, in the order in which they were inserted.
+    std::vector<uint32_t> next_elem_; //!< For each element, the index of the next element in the same cell, or no_elem.
+    std::vector<Cell> cells_; //!< Hash table of the cells that have elements, with a power of two size.
+    size_t cell_count_ = 0; //!< The number of slots of \ref cells_ in use.
+    double max_load_factor_;
 };
 
 
@@ -144,22 +213,153 @@ protected:
 SGI_TEMPLATE
 SGI_THIS::SparseGrid(coord_t cell_size, size_t elem_reserve, double max_load_factor)
     : SquareGrid(cell_size)
+    , max_load_factor_(std::clamp(max_load_factor, 0.1, max_cell_load_factor))
 {
-    // Must be before the reserve call.
-    grid_.max_load_factor(max_load_factor);
     if (elem_reserve != 0U)
     {
-        grid_.reserve(elem_reserve);
+        elems_.reserve(elem_reserve);
+        next_elem_.reserve(elem_reserve);
+        reserveCells(elem_reserve);
+    }
+}
+
+SGI_TEMPLATE
+size_t SGI_THIS::findSlot(const GridPoint& grid_pt) const
+{
+    assert(std::has_single_bit(cells_.size()));
+    // Mix both coordinates into the high bits, then use those, since neighbouring cells only differ in the low bits of their coordinates.
+    const uint64_t hash = static_cast<uint64_t>(grid_pt.X) * 0x9E3779B97F4A7C15ULL + static_cast<uint64_t>(grid_pt.Y) * 0xC2B2AE3D27D4EB4FULL;
+    const size_t mask = cells_.size() - 1;
+    for (size_t slot = (hash ^ (hash >> 32)) & mask;; slot = (slot + 1) & mask)
+    {
+        const Cell& cell = cells_[slot];
+        if (cell.first_elem_ == no_elem || cell.grid_pt_ == grid_pt)
+        {
+            return slot;
+        }
+    }
+}
+
+SGI_TEMPLATE
+void SGI_THIS::reserveCells(size_t cell_count)
+{
+    const size_t slot_count = std::bit_ceil(std::max(size_t(16), static_cast<size_t>(static_cast<double>(cell_count) / max_load_factor_) + 1));
+    if (slot_count <= cells_.size())
+    {
+        return;
+    }
+    std::vector<Cell> old_cells(slot_count);
+    std::swap(cells_, old_cells);
+    for (const Cell& cell : old_cells)
+    {
+        if (cell.first_elem_ != no_elem)
+        {
+            cells_[findSlot(cell.grid_pt_)] = cell;
+        }
+    }
+}
+
+SGI_TEMPLATE
+void SGI_THIS::insertIntoCell(const GridPoint& grid_pt, const Elem& elem)
+{
+    assert(elems_.size() < no_elem);
+    if (static_cast<double>(cell_count_ + 1) > static_cast<double>(cells_.size()) * max_load_factor_)
+    {
+        reserveCells(std::max(cell_count_ + 1, cell_count_ * 2));
+    }
+
+    const uint32_t elem_idx = static_cast<uint32_t>(elems_.size());
+    elems_.emplace_back(grid_pt, elem);
+    next_elem_.push_back(no_elem);
+
+    Cell& cell = cells_[findSlot(grid_pt)];
+    if (cell.first_elem_ == no_elem)
+    {
+        cell.grid_pt_ = grid_pt;
+        cell.first_elem_ = elem_idx;
+        cell_count_++;
+    }
+    else
+    {
+        next_elem_[cell.last_elem_] = elem_idx;
+    }
+    cell.last_elem_ = elem_idx;
+}
+
+SGI_TEMPLATE
+void SGI_THIS::insertIntoCells(std::vector<std::pair<GridPoint, Elem>>&& cell_elems)
+{
+    assert(elems_.size() + cell_elems.size() < no_elem);
+    if (! elems_.empty())
+    {
+        for (const std::pair<GridPoint, Elem>& cell_elem : cell_elems)
+        {
+            insertIntoCell(cell_elem.first, cell_elem.second);
+        }
+        return;
+    }
+
+    // Count the elements of each cell, keeping the count in the last_elem_ of the cell for now.
+    reserveCells(cell_elems.size());
+    std::vector<size_t> cell_slots; // The slots of the cells, in the order in which they first got an element.
+    std::vector<uint32_t> elem_slots(cell_elems.size());
+    for (size_t elem_idx = 0; elem_idx < cell_elems.size(); elem_idx++)
+    {
+        const size_t slot = findSlot(cell_elems[elem_idx].first);
+        Cell& cell = cells_[slot];
+        if (cell.first_elem_ == no_elem)
+        {
+            cell.grid_pt_ = cell_elems[elem_idx].first;
+            cell.first_elem_ = 0;
+            cell.last_elem_ = 0;
+            cell_slots.push_back(slot);
+        }
+        cell.last_elem_++;
+        elem_slots[elem_idx] = static_cast<uint32_t>(slot);
+    }
+    cell_count_ = cell_slots.size();
+
+    // Give each cell its span of elements, and use last_elem_ to fill it from the front.
+    uint32_t span_start = 0;
+    for (const size_t slot : cell_slots)
+    {
+        Cell& cell = cells_[slot];
+        const uint32_t count = cell.last_elem_;
+        cell.first_elem_ = span_start;
+        cell.last_elem_ = span_start;
+        span_start += count;
+    }
+    std::vector<uint32_t> source_elems(cell_elems.size()); // For each position, the element that goes there.
+    for (size_t elem_idx = 0; elem_idx < cell_elems.size(); elem_idx++)
+    {
+        source_elems[cells_[elem_slots[elem_idx]].last_elem_++] = static_cast<uint32_t>(elem_idx);
+    }
+
+    elems_.reserve(cell_elems.size());
+    next_elem_.resize(cell_elems.size());
+    for (size_t position = 0; position < cell_elems.size(); position++)
+    {
+        elems_.emplace_back(std::move(cell_elems[source_elems[position]]));
+        next_elem_[position] = static_cast<uint32_t>(position + 1);
+    }
+    for (const size_t slot : cell_slots)
+    {
+        Cell& cell = cells_[slot];
+        cell.last_elem_--; // From one past the end of the span to the last element.
+        next_elem_[cell.last_elem_] = no_elem;
     }
 }
 
 SGI_TEMPLATE
 bool SGI_THIS::processFromCell(const GridPoint& grid_pt, const std::function<bool(const Elem&)>& process_func) const
 {
-    auto grid_range = grid_.equal_range(grid_pt);
-    for (auto iter = grid_range.first; iter != grid_range.second; ++iter)
+    if (cells_.empty())
+    {
+        return true;
+    }
+    for (uint32_t elem_idx = cells_[findSlot(grid_pt)].first_elem_; elem_idx != no_elem; elem_idx = next_elem_[elem_idx])
     {
-        if (! process_func(iter->second))
+        if (! process_func(elems_[elem_idx].second))
         {
             return false;
         }
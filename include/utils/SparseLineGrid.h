@@ -7,7 +7,7 @@
 
 #include <cassert>
 #include <functional>
-#include <unordered_map>
+#include <span>
 #include <vector>
 
 #include "SVG.h" // debug
@@ -29,7 +29,6 @@ class SparseLineGrid : public SparseGrid<ElemT>
 {
 public:
     using Elem = ElemT;
-    using typename SparseGrid<ElemT>::GridMap;
 
     /*! \brief Constructs a sparse grid with the specified cell size.
      *
@@ -40,6 +39,17 @@ public:
      */
     SparseLineGrid(coord_t cell_size, size_t elem_reserve = 0U, double max_load_factor = 1.0);
 
+    /*! \brief Constructs a sparse grid with all of its elements at once.
+     *
+     * This gives the same grid as inserting the elements one by one, but with
+     * the elements of each cell next to each other, which makes the queries
+     * faster.
+     *
+     * \param[in] cell_size The size to use for a cell (square) in the grid.
+     * \param[in] elems The elements to insert.
+     */
+    SparseLineGrid(coord_t cell_size, std::span<const Elem> elems);
+
     /*! \brief Inserts elem into the sparse grid.
      *
      * \param[in] elem The element to be inserted.
@@ -68,21 +78,33 @@ SGI_THIS::SparseLineGrid(coord_t cell_size, size_t elem_reserve, double max_load
 {
 }
 
+SGI_TEMPLATE
+SGI_THIS::SparseLineGrid(coord_t cell_size, std::span<const Elem> elems)
+    : SparseGrid<ElemT>(cell_size)
+{
+    std::vector<std::pair<GridPoint, Elem>> cell_elems;
+    cell_elems.reserve(elems.size());
+    for (const Elem& elem : elems)
+    {
+        const std::function<bool(const GridPoint)> process_cell_func = [&elem, &cell_elems](const GridPoint grid_loc)
+        {
+            cell_elems.emplace_back(grid_loc, elem);
+            return true;
+        };
+        SparseGrid<ElemT>::processLineCells(m_locator(elem), process_cell_func);
+    }
+    SparseGrid<ElemT>::insertIntoCells(std::move(cell_elems));
+}
+
 SGI_TEMPLATE
 void SGI_THIS::insert(const Elem& elem)
 {
     const std::pair<Point2LL, Point2LL> line = m_locator(elem);
-    // below is a workaround for the fact that lambda functions cannot access private or protected members
-    // first we define a lambda which works on any GridMap and then we bind it to the actual protected GridMap of the parent class
-    std::function<bool(GridMap*, const GridPoint)> process_cell_func_ = [&elem, this](GridMap* grid, const GridPoint grid_loc)
+    const std::function<bool(const GridPoint)> process_cell_func = [&elem, this](const GridPoint grid_loc)
     {
-        grid->emplace(grid_loc, elem);
+        this->insertIntoCell(grid_loc, elem);
         return true;
     };
-    using namespace std::placeholders; // for _1, _2, _3...
-    GridMap* grid = &(this->grid_);
-    std::function<bool(const GridPoint)> process_cell_func(std::bind(process_cell_func_, grid, _1));
-
     SparseGrid<ElemT>::processLineCells(line, process_cell_func);
 }
 
@@ -90,13 +112,13 @@ SGI_TEMPLATE
 void SGI_THIS::debugHTML(std::string filename)
 {
     AABB aabb;
-    for (std::pair<GridPoint, ElemT> cell : SparseGrid<ElemT>::grid_)
+    for (const std::pair<const GridPoint, ElemT>& cell : *this)
     {
         aabb.include(SparseGrid<ElemT>::toLowerCorner(cell.first));
         aabb.include(SparseGrid<ElemT>::toLowerCorner(cell.first + GridPoint(SparseGrid<ElemT>::nonzero_sign(cell.first.X), SparseGrid<ElemT>::nonzero_sign(cell.first.Y))));
     }
     SVG svg(filename.c_str(), aabb);
-    for (std::pair<GridPoint, ElemT> cell : SparseGrid<ElemT>::grid_)
+    for (const std::pair<const GridPoint, ElemT>& cell : *this)
     {
         // doesn't draw cells at x = 0 or y = 0 correctly (should be double size)
         Point2LL lb = SparseGrid<ElemT>::toLowerCorner(cell.first);
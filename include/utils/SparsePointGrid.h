@@ -6,7 +6,7 @@
 #define UTILS_SPARSE_POINT_GRID_H
 
 #include <cassert>
-#include <unordered_map>
+#include <span>
 #include <vector>
 
 #include "SparseGrid.h"
@@ -37,6 +37,17 @@ public:
      */
     SparsePointGrid(coord_t cell_size, size_t elem_reserve = 0U, double max_load_factor = 1.0);
 
+    /*! \brief Constructs a sparse grid with all of its elements at once.
+     *
+     * This gives the same grid as inserting the elements one by one, but with
+     * the elements of each cell next to each other, which makes the queries
+     * faster.
+     *
+     * \param[in] cell_size The size to use for a cell (square) in the grid.
+     * \param[in] elems The elements to insert.
+     */
+    SparsePointGrid(coord_t cell_size, std::span<const Elem> elems);
+
     /*! \brief Inserts elem into the sparse grid.
      *
      * \param[in] elem The element to be inserted.
@@ -70,13 +81,26 @@ SGI_THIS::SparsePointGrid(coord_t cell_size, size_t elem_reserve, double max_loa
 {
 }
 
+SGI_TEMPLATE
+SGI_THIS::SparsePointGrid(coord_t cell_size, std::span<const Elem> elems)
+    : SparseGrid<ElemT>(cell_size)
+{
+    std::vector<std::pair<GridPoint, Elem>> cell_elems;
+    cell_elems.reserve(elems.size());
+    for (const Elem& elem : elems)
+    {
+        cell_elems.emplace_back(SparseGrid<ElemT>::toGridPoint(m_locator(elem)), elem);
+    }
+    SparseGrid<ElemT>::insertIntoCells(std::move(cell_elems));
+}
+
 SGI_TEMPLATE
 void SGI_THIS::insert(const Elem& elem)
 {
     Point2LL loc = m_locator(elem);
     GridPoint grid_loc = SparseGrid<ElemT>::toGridPoint(loc);
 
-    SparseGrid<ElemT>::grid_.emplace(grid_loc, elem);
+    SparseGrid<ElemT>::insertIntoCell(grid_loc, elem);
 }
 
 SGI_TEMPLATE
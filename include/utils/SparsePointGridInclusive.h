@@ -6,7 +6,7 @@
 #define UTILS_SPARSE_POINT_GRID_INCLUSIVE_H
 
 #include <cassert>
-#include <unordered_map>
+#include <span>
 #include <vector>
 
 #include "SparsePointGrid.h"
@@ -66,6 +66,15 @@ public:
      */
     SparsePointGridInclusive(coord_t cell_size, size_t elem_reserve = 0U, double max_load_factor = 1.0);
 
+    /*! \brief Constructs a sparse grid with all of its elements at once.
+     *
+     * See \ref SparsePointGrid::SparsePointGrid(coord_t, std::span<const Elem>).
+     *
+     * \param[in] cell_size The size to use for a cell (square) in the grid.
+     * \param[in] elems The elements to insert, each with its location and value.
+     */
+    SparsePointGridInclusive(coord_t cell_size, std::span<const typename Base::Elem> elems);
+
     /*! \brief Inserts an element with specified point and value into the sparse grid.
      *
      * This is a convenience wrapper over \ref SparsePointGrid::insert()
@@ -98,6 +107,12 @@ SG_THIS::SparsePointGridInclusive(coord_t cell_size, size_t elem_reserve, double
 {
 }
 
+SG_TEMPLATE
+SG_THIS::SparsePointGridInclusive(coord_t cell_size, std::span<const typename Base::Elem> elems)
+    : Base(cell_size, elems)
+{
+}
+
 SG_TEMPLATE
 void SG_THIS::insert(const Point2LL& point, const Val& val)
 {
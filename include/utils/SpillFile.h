@@ -0,0 +1,70 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_SPILL_FILE_H
+#define UTILS_SPILL_FILE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace cura
+{
+
+/*!
+ * \brief A scratch file to move data out of memory until it is needed again.
+ *
+ * Records are only ever appended, so a record that is written again takes new
+ * space in the file. The file is removed when this is destroyed. Writing and
+ * reading records is safe from multiple threads at the same time.
+ */
+class SpillFile
+{
+public:
+    //! Where a record is stored in the file.
+    struct Record
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    /*!
+     * \param directory The directory to create the file in. It's created if it
+     * doesn't exist yet.
+     */
+    explicit SpillFile(const std::filesystem::path& directory);
+
+    ~SpillFile();
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    //! Whether the file could be created.
+    [[nodiscard]] bool isOpen() const;
+
+    /*!
+     * \brief Append a record to the file.
+     * \return Where the record is stored, or nothing if it couldn't be written,
+     * in which case the data should be kept in memory instead.
+     */
+    [[nodiscard]] std::optional<Record> write(const std::string& data);
+
+    /*!
+     * \brief Read back a record that was written before.
+     * \return The data of the record, or nothing if it couldn't be read.
+     */
+    [[nodiscard]] std::optional<std::string> read(const Record& record) const;
+
+private:
+    std::filesystem::path path_;
+    mutable std::mutex mutex_; //!< Guards the file, whose reading and writing positions are shared.
+    mutable std::fstream file_;
+    uint64_t size_ = 0; //!< How much of the file is used by records.
+};
+
+} // namespace cura
+
+#endif // UTILS_SPILL_FILE_H
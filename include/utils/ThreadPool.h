@@ -4,15 +4,20 @@
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
+#include <atomic>
 #include <cassert>
 #include <condition_variable>
 #include <deque>
 #include <functional> // std::function<>
+#include <memory>
 #include <mutex>
+#include <source_location>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "../Application.h" // accessing singleton's Application::thread_pool
+#include "../utils/ThreadPoolProfiler.h"
 #include "../utils/math.h" // round_up_divide
 
 namespace cura
@@ -31,8 +36,13 @@ public:
     using lock_t = std::unique_lock<std::mutex>;
     using task_t = std::function<void(lock_t&)>;
 
-    //! Spawns a thread pool with `nthreads` threads
-    ThreadPool(size_t nthreads);
+    /*!
+     * \brief Spawns a thread pool with `nthreads` threads.
+     * \param cpus If not empty, the CPUs to run on. The calling thread, which takes part in the parallel loops, is pinned to the
+     * first one, and the threads of the pool to the next ones, wrapping around if there are more threads than CPUs. Only
+     * supported on Linux.
+     */
+    ThreadPool(size_t nthreads, const std::vector<size_t>& cpus = {});
 
     ~ThreadPool()
     {
@@ -60,9 +70,32 @@ public:
     void push(const lock_t& lock [[maybe_unused]], F&& func)
     {
         assert(lock);
-        tasks.push_back(std::forward<F>(func));
+        tasks.push_back(make_task(std::forward<F>(func)));
         condition.notify_one();
     }
+
+    /*!
+     * \brief Pushes a new task in front of all pending tasks, while the queue is locked.
+     *
+     * This is meant for tasks that some other task is waiting for, like the chunks of a nested `parallel_for()`, so that
+     * they aren't held up by all the other work in the queue.
+     * \param func Closure that unlocks the local worker's lock passed as an argument while
+     * doing asynchronous work.
+     */
+    template<typename F>
+    void push_front(const lock_t& lock [[maybe_unused]], F&& func)
+    {
+        assert(lock);
+        tasks.push_front(make_task(std::forward<F>(func)));
+        condition.notify_one();
+    }
+
+    //! Returns the number of threads that are waiting for a task, while the queue is locked
+    size_t idle_thread_count(const lock_t& lock [[maybe_unused]]) const
+    {
+        assert(lock);
+        return idle_threads;
+    }
     /*!
      * \brief Executes pending tasks while the predicates returns true
      * This method doesn't wait unless predicate does (like implementation of ThreadPool::worker())
@@ -87,13 +120,32 @@ private:
 
     void join();
 
+    //! Wraps a task to record how long it waits in the queue, if the thread pool is profiled
+    template<typename F>
+    static task_t make_task(F&& func)
+    {
+        if (! ThreadPoolProfiler::getInstance().isEnabled())
+        {
+            return task_t(std::forward<F>(func));
+        }
+        return [func = std::forward<F>(func), pushed = ThreadPoolProfiler::clock_t::now()](lock_t& lock) mutable
+        {
+            ThreadPoolProfiler::getInstance().recordQueueWait(pushed, ThreadPoolProfiler::clock_t::now());
+            func(lock);
+        };
+    }
+
     std::mutex mutex;
     std::condition_variable condition;
     std::deque<task_t> tasks;
     std::vector<std::thread> threads;
+    size_t idle_threads; //!< The number of threads waiting for a task
     bool wait_for_new_tasks;
 };
 
+//! \private The number of `parallel_for()` loops that the current thread is running an item of.
+inline thread_local size_t parallel_for_depth = 0;
+
 
 /// `std::make_signed_t` fails for non integral types in a way that doesn't allows SFINAE fallbacks. This alias solves that.
 template<typename T>
@@ -111,16 +163,40 @@ inline Signed distance(const Int& first, const Int& last)
  * There are still a lot of compilers that claim to be fully C++17 compatible, but don't implement the Parallel Execution TS of the accompanying standard library.
  * This means that we mostly have to fall back to the things that C++11/14 provide when it comes to threading/parallelism/etc.
  *
- * The range of items is divided in chunks such that there is a maximum number of `chunks_per_worker` and such that
- * chunk size is a multiple of `chunk_size_factor`.
+ * The range of items is divided in chunks such that chunk size is a multiple of `chunk_size_factor`. The chunks get smaller
+ * towards the end of the range (guided scheduling): each chunk is a share of the items that are left, but never bigger than
+ * an even split into `chunks_per_worker` chunks per worker. The cost per item is often very skewed, for instance for the
+ * first layers with a brim or the layers with much support. If all chunks were equally big, the slowest one would still run
+ * long after the other workers have run out of work. Small chunks at the end let them even that out.
+ *
+ * The chunks aren't queued on the thread pool one by one. Instead, at most one task per worker is queued, and the calling
+ * thread and those tasks claim chunks through an atomic counter until all are claimed. This way the lock of the thread pool
+ * is taken a few times per call instead of twice per chunk, which made fine-grained loops scale poorly with many threads.
+ * Workers that are busy with something else simply don't claim any chunks, so the load stays balanced.
+ *
+ * A `parallel_for()` may be called from the body of another one. The calling thread then runs the inner chunks itself as
+ * much as possible, since it would otherwise just wait for them. Only threads that are idle are asked to help, so that the
+ * inner loop doesn't take workers away from the outer loop. Their tasks go in front of the queue, because the inner loop
+ * has to finish before the chunk of the outer loop can continue.
+ *
+ * Once the slice is cancelled (see `Application::cancellation_`), the chunks that haven't started yet are skipped, and so are
+ * the rest of the chunks of which the body throws a `CancelledException`. The loop then throws a `CancelledException` on the
+ * calling thread, so that no code after it uses the items that weren't processed.
  *
  * \param from, to: The [inclusive, exclusive) range of iteration. Integers or random access iterators
  * \param body The loop-body, as a closure. Receives the index on invocation.
  * \param chunk_size_factor Chunk size will be a multiple of this number.
- * \param chunks_per_worker Maximum number of tasks that are queue at once (defaults to 4 times the number of workers).
+ * \param chunks_per_worker The biggest chunks are as big as an even split into this number of chunks per worker.
+ * \param location Where the loop is called from, to tell the loops apart when the thread pool is profiled.
  */
 template<typename T, typename F>
-void parallel_for(T first, T last, F&& loop_body, size_t chunk_size_factor = 1, const size_t chunks_per_worker = 8)
+void parallel_for(
+    T first,
+    T last,
+    F&& loop_body,
+    size_t chunk_size_factor = 1,
+    const size_t chunks_per_worker = 8,
+    const std::source_location location = std::source_location::current())
 {
     using lock_t = ThreadPool::lock_t;
 
@@ -135,6 +211,8 @@ void parallel_for(T first, T last, F&& loop_body, size_t chunk_size_factor = 1,
     ThreadPool* const thread_pool = Application::getInstance().thread_pool_;
     assert(thread_pool);
     const size_t nworkers = thread_pool->thread_count() + 1; // One task per std::thread + 1 for main thread
+    const bool profiled = ThreadPoolProfiler::getInstance().isEnabled();
+    const ThreadPoolProfiler::clock_t::time_point loop_start = profiled ? ThreadPoolProfiler::clock_t::now() : ThreadPoolProfiler::clock_t::time_point();
 
     size_t blocks; // Number of indivisible units of work (sized by chunk_size_factor)
     if (chunk_size_factor <= 1)
@@ -147,63 +225,133 @@ void parallel_for(T first, T last, F&& loop_body, size_t chunk_size_factor = 1,
         blocks = round_up_divide(nitems, chunk_size_factor);
     }
 
-    // With the maximum number of chunks, computes the chunk size, and then the number of chunks
-    const size_t max_chunks = std::min(chunks_per_worker * nworkers, blocks);
-    const size_t chunk_size = chunk_size_factor * round_up_divide(blocks, max_chunks);
-    const size_t chunks = round_up_divide(nitems, chunk_size);
-    const auto chunk_increment = static_cast<decltype(dist)>(chunk_size);
-    assert(chunks * chunk_size >= nitems && (chunks - 1) * chunk_size < nitems);
-    assert(chunks <= chunks_per_worker * nworkers && chunks <= blocks);
+    // With the minimum number of chunks, computes the biggest chunk size
+    const size_t min_chunks = std::min(chunks_per_worker * nworkers, blocks);
+    const size_t max_chunk_size = chunk_size_factor * round_up_divide(blocks, min_chunks);
+    assert(round_up_divide(nitems, max_chunk_size) <= min_chunks);
 
-    // Packs state variables such that they can be referenced by the task closure through a single reference
-    struct
+    // State shared with the tasks on the thread pool. A task may only start after all chunks are done and this function has
+    // returned, so the tasks keep the state alive. They never touch the loop body then, since there are no chunks left to claim.
+    struct SharedState
     {
-        std::decay_t<F> loop_body; // User's closure data
-        size_t chunks_remaining;
+        std::remove_reference_t<F>* loop_body; // User's closure, which outlives all calls to it
+        Slice* slice; // The slice that the loop runs for
+        const std::source_location* location; // Where the loop is called from, if the thread pool is profiled
+        T first;
+        size_t nitems;
+        size_t chunk_size_factor;
+        size_t max_chunk_size;
+        size_t guided_divisor; // Each chunk gets the remaining items divided by this, so that all workers still get a chunk after it
+        std::atomic<size_t> next_item = 0; // The first item that isn't claimed yet
+        std::atomic<size_t> items_remaining; // The number of items that aren't done yet
+        std::atomic<bool> cancelled = false; // Whether any items were skipped because the slice was cancelled
         std::condition_variable work_done = {};
-    } shared_state = { std::forward<F>(loop_body), chunks };
+    };
+    const auto shared_state = std::make_shared<SharedState>(&loop_body, Application::current_slice_, profiled ? &location : nullptr, first, nitems, chunk_size_factor, max_chunk_size, 2 * nworkers, 0, nitems);
 
-    // Schedules a task per chunk on the thread pool
-    lock_t lock = thread_pool->get_lock();
-    T chunk_last;
-    for (T chunk_first = first; chunk_first < last; chunk_first = chunk_last)
+    // Runs chunks until all are claimed. Returns whether this thread completed the last chunk.
+    const auto run_chunks = [](SharedState& state)
     {
-        if (distance(chunk_first, last) > chunk_increment)
-        { // Full size chunk
-            chunk_last = chunk_first + chunk_increment;
-        }
-        else
-        { // Adjust for the size of the last chunk
-            chunk_last = last;
-        }
-
-        thread_pool->push(
-            lock,
-            [&shared_state, chunk_first, chunk_last](lock_t& th_lock)
+        bool completed_last = false;
+        size_t chunk_first = state.next_item.load(std::memory_order_relaxed);
+        while (chunk_first < state.nitems)
+        {
+            const size_t remaining = state.nitems - chunk_first;
+            const size_t guided_size = state.chunk_size_factor * round_up_divide(remaining, state.guided_divisor * state.chunk_size_factor);
+            const size_t chunk_size = std::min(std::min(guided_size, state.max_chunk_size), remaining);
+            if (! state.next_item.compare_exchange_weak(chunk_first, chunk_first + chunk_size, std::memory_order_relaxed))
+            {
+                continue; // Another thread claimed these items. chunk_first is updated to the next unclaimed item.
+            }
+            if (state.cancelled.load(std::memory_order_relaxed) || Application::getInstance().cancellation_.isCancelled())
+            {
+                state.cancelled.store(true, std::memory_order_relaxed);
+            }
+            else
             {
-                th_lock.unlock(); // Enter unsynchronized region
-                for (T i = chunk_first; i < chunk_last; ++i)
+                const T chunk_begin = state.first + static_cast<decltype(dist)>(chunk_first);
+                const T chunk_end = chunk_begin + static_cast<decltype(dist)>(chunk_size);
+                parallel_for_depth++;
+                try
                 {
-                    shared_state.loop_body(i);
+                    const ThreadPoolProfiler::clock_t::time_point chunk_start = state.location ? ThreadPoolProfiler::clock_t::now() : ThreadPoolProfiler::clock_t::time_point();
+                    for (T i = chunk_begin; i < chunk_end; ++i)
+                    {
+                        (*state.loop_body)(i);
+                    }
+                    if (state.location)
+                    {
+                        ThreadPoolProfiler::getInstance().recordChunk(*state.location, chunk_start, ThreadPoolProfiler::clock_t::now());
+                    }
                 }
-                th_lock.lock();
-                if (--shared_state.chunks_remaining == 0)
-                {
-                    shared_state.work_done.notify_one();
+                catch (const CancelledException&)
+                { // A nested loop was cancelled. Don't let it escape a task of the thread pool
+                    state.cancelled.store(true, std::memory_order_relaxed);
                 }
-            });
+                parallel_for_depth--;
+            }
+            completed_last = state.items_remaining.fetch_sub(chunk_size, std::memory_order_acq_rel) == chunk_size;
+            chunk_first = state.next_item.load(std::memory_order_relaxed);
+        }
+        return completed_last;
+    };
+
+    // Schedules a task per worker that may help, the calling thread being one of them
+    lock_t lock = thread_pool->get_lock();
+    const bool nested = parallel_for_depth > 0;
+    size_t helpers = std::min(blocks, nworkers) - 1;
+    if (nested)
+    { // The other workers are busy with the outer loop. Only ask the threads that have nothing to do
+        helpers = std::min(helpers, thread_pool->idle_thread_count(lock));
     }
+    for (size_t helper = 0; helper < helpers; helper++)
+    {
+        auto task = [shared_state, run_chunks](lock_t& th_lock)
+        {
+            th_lock.unlock(); // Enter unsynchronized region
+            bool completed_last;
+            {
+                CurrentSliceScope slice_scope(shared_state->slice);
+                completed_last = run_chunks(*shared_state);
+            }
+            th_lock.lock();
+            if (completed_last)
+            {
+                shared_state->work_done.notify_one();
+            }
+        };
+        if (nested)
+        {
+            thread_pool->push_front(lock, std::move(task));
+        }
+        else
+        {
+            thread_pool->push(lock, std::move(task));
+        }
+    }
+    lock.unlock();
+    run_chunks(*shared_state);
+    lock.lock();
+    const ThreadPoolProfiler::clock_t::time_point wait_start = profiled ? ThreadPoolProfiler::clock_t::now() : ThreadPoolProfiler::clock_t::time_point();
 
-    // Do work while parallel_for's tasks are running
+    // Do other work while the last chunks are running on other threads
     thread_pool->work_while(
         lock,
         [&]
         {
-            return shared_state.chunks_remaining > 0;
+            return shared_state->items_remaining.load(std::memory_order_acquire) > 0;
         });
-    while (shared_state.chunks_remaining > 0) // Wait until all the task are completed
+    while (shared_state->items_remaining.load(std::memory_order_acquire) > 0) // Wait until all the chunks are completed
     {
-        shared_state.work_done.wait(lock);
+        shared_state->work_done.wait(lock);
+    }
+    if (profiled)
+    {
+        ThreadPoolProfiler::getInstance().recordLoop(location, nitems, loop_start, wait_start, ThreadPoolProfiler::clock_t::now());
+    }
+    if (shared_state->cancelled.load(std::memory_order_relaxed))
+    {
+        throw CancelledException();
     }
 }
 
@@ -212,9 +360,14 @@ void parallel_for(T first, T last, F&& loop_body, size_t chunk_size_factor = 1,
  *  Overload for iterating over containers with random access iterators.
  */
 template<typename Container, typename F>
-auto parallel_for(Container& container, F&& loop_body, size_t chunk_size_factor = 1, size_t chunks_per_worker = 8) -> std::void_t<decltype(container.end() - container.begin())>
+auto parallel_for(
+    Container& container,
+    F&& loop_body,
+    size_t chunk_size_factor = 1,
+    size_t chunks_per_worker = 8,
+    const std::source_location location = std::source_location::current()) -> std::void_t<decltype(container.end() - container.begin())>
 {
-    parallel_for(container.begin(), container.end(), std::forward<F>(loop_body), chunk_size_factor, chunks_per_worker);
+    parallel_for(container.begin(), container.end(), std::forward<F>(loop_body), chunk_size_factor, chunks_per_worker, location);
 }
 
 
@@ -239,15 +392,29 @@ class MultipleProducersOrderedConsumer;
  * \param producer Given an index/iterator, produces a non-null value of a nullable type (eg pointer, optional, etc...).
  * \param consumer Consumes an item produced by `producer`.
  * \param max_pending_per_worker Number of allocated slots per worker for items waiting to be consumed.
+ * \param item_weight Estimates the weight (eg memory usage) of a produced item. May be empty to only limit the number of items.
+ * \param max_pending_weight When the items waiting to be consumed weigh more than this, no new items are produced until some are consumed.
+ *
+ * Once the slice is cancelled (see `Application::cancellation_`), or a producer throws a `CancelledException`, no new items are
+ * produced. The items that were produced before are still consumed, up to the first one that is missing. Then a
+ * `CancelledException` is thrown on the calling thread.
  */
 template<typename P, typename C>
-void run_multiple_producers_ordered_consumer(ptrdiff_t first, ptrdiff_t last, P&& producer, C&& consumer, size_t max_pending_per_worker = 8)
+void run_multiple_producers_ordered_consumer(
+    ptrdiff_t first,
+    ptrdiff_t last,
+    P&& producer,
+    C&& consumer,
+    size_t max_pending_per_worker = 8,
+    std::function<size_t(const std::invoke_result_t<P, ptrdiff_t>&)> item_weight = nullptr,
+    size_t max_pending_weight = 0)
 {
     ThreadPool* thread_pool = Application::getInstance().thread_pool_;
     assert(thread_pool);
     assert(max_pending_per_worker > 0);
     const size_t max_pending = max_pending_per_worker * (thread_pool->thread_count() + 1);
-    MultipleProducersOrderedConsumer<P, C>(first, last, std::forward<P>(producer), std::forward<C>(consumer), max_pending).run(*thread_pool);
+    MultipleProducersOrderedConsumer<P, C>(first, last, std::forward<P>(producer), std::forward<C>(consumer), max_pending, std::move(item_weight), max_pending_weight)
+        .run(*thread_pool);
 }
 
 template<typename Producer, typename Consumer>
@@ -260,13 +427,25 @@ public:
     /*!
      * \see run_multiple_producers_ordered_consumer
      * \param max_pending Number of allocated slots for items waiting to be consumed.
+     * \param item_weight Estimates the weight of a produced item, or empty to not limit the weight.
+     * \param max_pending_weight The maximum total weight of the items waiting to be consumed.
      */
     template<typename P, typename C>
-    MultipleProducersOrderedConsumer(ptrdiff_t first, ptrdiff_t last, P&& producer, C&& consumer, size_t max_pending)
+    MultipleProducersOrderedConsumer(
+        ptrdiff_t first,
+        ptrdiff_t last,
+        P&& producer,
+        C&& consumer,
+        size_t max_pending,
+        std::function<size_t(const item_t&)> item_weight = nullptr,
+        size_t max_pending_weight = 0)
         : producer_(std::forward<P>(producer))
         , consumer_(std::forward<C>(consumer))
+        , item_weight_(std::move(item_weight))
+        , max_pending_weight_(max_pending_weight)
         , max_pending_(max_pending)
         , queue_(std::make_unique<item_t[]>(max_pending))
+        , weights_(std::make_unique<size_t[]>(max_pending))
         , last_idx_(last)
         , write_idx_(first)
         , read_idx_(first)
@@ -290,6 +469,7 @@ public:
                 lock,
                 [this](lock_t& th_lock)
                 {
+                    CurrentSliceScope slice_scope(slice_);
                     worker(th_lock);
                 });
         }
@@ -300,6 +480,10 @@ public:
         {
             work_done_cond_.wait(lock);
         }
+        if (cancelled_)
+        {
+            throw CancelledException();
+        }
     }
 
 protected:
@@ -312,7 +496,13 @@ protected:
             { // Work completed: stop worker
                 return false;
             }
-            if (write_idx_ - read_idx_ < max_pending_)
+            if (cancelled_ || Application::getInstance().cancellation_.isCancelled())
+            { // Work cancelled: stop worker
+                cancelled_ = true;
+                return false;
+            }
+            // Items that are claimed but not produced yet are not weighed. Their producers are not waiting here, so the consumer can't starve.
+            if (write_idx_ - read_idx_ < max_pending_ && ! isOverweight())
             { // Continue as a producer
                 return true;
             }
@@ -323,7 +513,10 @@ protected:
         }
     }
 
-    //! Produces an item and store in in the ring buffer. Assumes that there is items to produce and free space in the ring
+    /*!
+     * Produces an item and store in in the ring buffer. Assumes that there is items to produce and free space in the ring.
+     * Returns the index of the item, or `last_idx_` if the producer was cancelled.
+     */
     ptrdiff_t produce(lock_t& lock)
     {
         ptrdiff_t produced_idx = write_idx_++;
@@ -332,12 +525,25 @@ protected:
 
         // Unlocks global mutex while producing an item
         lock.unlock();
-        item_t item = producer_(produced_idx);
+        item_t item{};
+        try
+        {
+            item = producer_(produced_idx);
+        }
+        catch (const CancelledException&)
+        { // Leave the slot empty, so that the consumer stops there
+            lock.lock();
+            cancelled_ = true;
+            return last_idx_;
+        }
+        const size_t weight = item_weight_ ? item_weight_(item) : 0;
         lock.lock();
 
         assert(! *slot);
         *slot = std::move(item);
         assert(*slot);
+        weights_[(produced_idx + max_pending_) % max_pending_] = weight;
+        pending_weight_ += weight;
 
         return produced_idx;
     }
@@ -355,7 +561,8 @@ protected:
             lock.lock();
 
             // Increment read index and signal a waiting worker if there is one
-            bool queue_was_full = write_idx_ - read_idx_ >= max_pending_;
+            bool queue_was_full = write_idx_ - read_idx_ >= max_pending_ || isOverweight();
+            pending_weight_ -= weights_[(read_idx_ + max_pending_) % max_pending_];
             read_idx_++;
 
             // Notify producers that are waiting for a queue slot
@@ -367,6 +574,12 @@ protected:
         consumer_wait_idx_ = read_idx_; // The producer filling this slot will resume consumption
     }
 
+    //! Whether the produced items waiting to be consumed weigh too much to produce more.
+    bool isOverweight() const
+    {
+        return item_weight_ && pending_weight_ > max_pending_weight_;
+    }
+
     //! Task pushed on the ThreadPool
     void worker(lock_t& lock)
     {
@@ -388,19 +601,26 @@ protected:
         }
     }
 
+    Slice* const slice_ = Application::current_slice_; // The slice that the workers run for
+
     // Tracks worker completion
     size_t workers_count_;
     std::condition_variable work_done_cond_;
 
     Producer producer_;
     Consumer consumer_;
+    const std::function<size_t(const item_t&)> item_weight_; // Estimates the weight of an item, if the pending weight is limited
+    const size_t max_pending_weight_; // Maximum total weight of produced items that wait in the queue
+    size_t pending_weight_ = 0; // Total weight of produced items that wait in the queue
     const ptrdiff_t max_pending_; // Number of produced items that can wait in the queue
     const std::unique_ptr<item_t[]> queue_; // Ring buffer mapping each intermediary result to a slot
+    const std::unique_ptr<size_t[]> weights_; // The weight of the item in each slot of the ring buffer
     const ptrdiff_t last_idx_;
 
     ptrdiff_t write_idx_; // Next slot to produce
     ptrdiff_t read_idx_; // Next slot to consume
     ptrdiff_t consumer_wait_idx_; // First slot that is waited for by the consumer
+    bool cancelled_ = false; // Whether the slice was cancelled, so that no more items are produced
     std::condition_variable free_slot_cond_; // Condition to wait for available space in the buffer
 };
 
@@ -0,0 +1,148 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_THREAD_POOL_PROFILER_H
+#define UTILS_THREAD_POOL_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cura
+{
+
+/*!
+ * \brief Records how well the thread pool is used: how long each chunk of each
+ * `parallel_for()` takes, how long the calling thread waits for the last
+ * chunks, how long tasks wait in the queue and how long the workers are idle.
+ *
+ * This only records anything after it has been enabled with the
+ * --profile-threads command line option. At the end of the slice, the loops
+ * with the most time spent are logged per call site, and everything can be
+ * written to a Chrome trace (open it in chrome://tracing or Perfetto), with
+ * the slicing stages and the trace spans (see TraceSpan.h) alongside.
+ *
+ * Every thread records into its own tables, which are merged when the report
+ * is made, so that profiling doesn't serialise the threads.
+ */
+class ThreadPoolProfiler
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    static ThreadPoolProfiler& getInstance();
+
+    /*!
+     * \brief Start recording.
+     * \param trace_file A file to write the Chrome trace to, or empty to only
+     * log the summary.
+     */
+    void enable(std::string trace_file);
+
+    [[nodiscard]] bool isEnabled() const
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    //! Record a chunk of a parallel loop that ran on this thread.
+    void recordChunk(const std::source_location& location, clock_t::time_point start, clock_t::time_point end);
+
+    /*!
+     * \brief Record a call of a parallel loop.
+     * \param location Where the loop was called.
+     * \param items How many items the loop had.
+     * \param start When the loop started.
+     * \param wait_start When the calling thread had no chunks left to claim,
+     * and started waiting for the others to complete theirs.
+     * \param end When the loop was done.
+     */
+    void recordLoop(const std::source_location& location, size_t items, clock_t::time_point start, clock_t::time_point wait_start, clock_t::time_point end);
+
+    //! Record how long a task waited in the queue, from when it was pushed until a thread started it.
+    void recordQueueWait(clock_t::time_point pushed, clock_t::time_point started);
+
+    //! Record that a worker waited for new tasks.
+    void recordIdle(clock_t::time_point start, clock_t::time_point end);
+
+    //! Record a trace span that ran on this thread.
+    void recordSpan(const char* name, clock_t::time_point start, clock_t::time_point end);
+
+    //! Record a slicing stage that just ended.
+    void recordStage(std::string_view name, std::chrono::duration<double> duration);
+
+    /*!
+     * \brief Log the call sites in which the most time was spent and write the
+     * trace, if a trace file was given. Then start recording from scratch.
+     */
+    void report();
+
+private:
+    //! Something that happened on one thread for a while.
+    struct Event
+    {
+        enum class Kind
+        {
+            CHUNK,
+            IDLE,
+            SPAN
+        };
+        Kind kind;
+        std::source_location location; //!< Where the loop of the chunk was called.
+        const char* name = nullptr; //!< The name of the span.
+        clock_t::time_point start;
+        clock_t::time_point end;
+    };
+
+    //! A call of a parallel loop.
+    struct Loop
+    {
+        std::source_location location;
+        size_t items;
+        clock_t::time_point start;
+        clock_t::time_point wait_start;
+        clock_t::time_point end;
+    };
+
+    //! What one thread recorded.
+    struct ThreadTables
+    {
+        std::mutex mutex; //!< Only contended while a report is being made.
+        size_t thread_idx; //!< Identifies the thread in the trace.
+        std::vector<Event> events;
+        std::vector<Loop> loops;
+        size_t queued_tasks = 0;
+        clock_t::duration queue_wait{ 0 };
+        clock_t::duration max_queue_wait{ 0 };
+    };
+
+    //! A slicing stage, as reported by the progress.
+    struct Stage
+    {
+        std::string name;
+        clock_t::time_point start;
+        clock_t::time_point end;
+    };
+
+    ThreadPoolProfiler() = default;
+
+    ThreadTables& threadTables();
+
+    //! Write the trace of everything recorded to the trace file.
+    void writeTrace(const std::vector<std::shared_ptr<ThreadTables>>& tables) const;
+
+    std::atomic<bool> enabled_{ false };
+    std::string trace_file_;
+    clock_t::time_point origin_; //!< When recording started. The trace counts from here.
+    std::mutex tables_mutex_;
+    std::vector<std::shared_ptr<ThreadTables>> tables_; //!< The tables of all threads that recorded something.
+    std::vector<Stage> stages_; //!< Guarded by tables_mutex_.
+};
+
+} // namespace cura
+
+#endif // UTILS_THREAD_POOL_PROFILER_H
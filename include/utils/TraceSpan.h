@@ -0,0 +1,67 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_TRACE_SPAN_H
+#define UTILS_TRACE_SPAN_H
+
+#include "utils/ThreadPoolProfiler.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Records how long a scope takes on the current thread, for the trace
+ * of the thread pool profiler.
+ *
+ * Use it through CURA_TRACE_SPAN, which is only compiled in when building with
+ * ENABLE_TRACING. The spans are only recorded if the profiler is enabled with
+ * the --profile-threads command line option, and are written to its trace along
+ * with the chunks of the parallel loops, so that it shows what each thread was
+ * doing during the slice.
+ */
+class TraceSpan
+{
+public:
+    using clock_t = ThreadPoolProfiler::clock_t;
+
+    /*!
+     * \param name The name of the span in the trace. It is not copied, so it
+     * should be a string literal.
+     */
+    explicit TraceSpan(const char* name)
+        : name_(name)
+        , enabled_(ThreadPoolProfiler::getInstance().isEnabled())
+        , start_(enabled_ ? clock_t::now() : clock_t::time_point())
+    {
+    }
+
+    ~TraceSpan()
+    {
+        if (enabled_)
+        {
+            ThreadPoolProfiler::getInstance().recordSpan(name_, start_, clock_t::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    bool enabled_;
+    clock_t::time_point start_;
+};
+
+} // namespace cura
+
+#define CURA_TRACE_SPAN_CONCAT_IMPL(a, b) a##b
+#define CURA_TRACE_SPAN_CONCAT(a, b) CURA_TRACE_SPAN_CONCAT_IMPL(a, b)
+
+#ifdef TRACING
+//! Record how long the rest of the current scope takes, under this name.
+#define CURA_TRACE_SPAN(name) const cura::TraceSpan CURA_TRACE_SPAN_CONCAT(trace_span_, __LINE__)(name)
+#else
+#define CURA_TRACE_SPAN(name)
+#endif
+
+#endif // UTILS_TRACE_SPAN_H
@@ -38,9 +38,16 @@ public:
     /*!
      * Discretize a parabola based on (approximate) step size.
      * The \p approximate_step_size is measured parallel to the \p source_segment, not along the parabola.
+     * The points are appended to \p discretized, so that the caller can reuse its buffer.
      */
-    static std::vector<Point2LL>
-        discretizeParabola(const Point2LL& source_point, const Segment& source_segment, Point2LL start, Point2LL end, coord_t approximate_step_size, double transitioning_angle);
+    static void discretizeParabola(
+        const Point2LL& source_point,
+        const Segment& source_segment,
+        Point2LL start,
+        Point2LL end,
+        coord_t approximate_step_size,
+        double transitioning_angle,
+        std::vector<Point2LL>& discretized);
 
 protected:
     /*!
@@ -4,17 +4,33 @@
 #ifndef UTILS_VOXEL_UTILS_H
 #define UTILS_VOXEL_UTILS_H
 
+#include <algorithm>
+#include <cassert>
+#include <concepts>
 #include <functional>
+#include <limits>
+#include <span>
 #include <unordered_set>
+#include <vector>
 
 #include "geometry/Point2LL.h"
+#include "geometry/Point3LL.h"
 #include "geometry/Polygon.h"
+#include "geometry/Shape.h"
 
 namespace cura
 {
 
 using GridPoint3 = Point3LL;
 
+//! A function to perform on a voxel cell, which returns whether to continue walking.
+template<typename F>
+concept CellFunc = std::predicate<F&, GridPoint3>;
+
+//! A function to perform on a run of voxel cells, which returns whether to continue walking.
+template<typename F>
+concept CellsFunc = std::predicate<F&, std::span<const GridPoint3>>;
+
 /*!
  * Class for holding the relative positiongs wrt a reference cell on which to perform a dilation.
  */
@@ -80,7 +96,54 @@ public:
      * \param process_cell_func Function to perform on each cell the line crosses
      * \return Whether executing was stopped short as indicated by the \p cell_processing_function
      */
-    bool walkLine(Point3LL start, Point3LL end, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    template<CellFunc ProcessCellFunc>
+    bool walkLine(Point3LL start, Point3LL end, ProcessCellFunc&& process_cell_func) const
+    {
+        Point3LL diff = end - start;
+
+        const GridPoint3 start_cell = toGridPoint(start);
+        const GridPoint3 end_cell = toGridPoint(end);
+        if (start_cell == end_cell)
+        {
+            return process_cell_func(start_cell);
+        }
+
+        Point3LL current_cell = start_cell;
+        while (true)
+        {
+            bool continue_ = process_cell_func(current_cell);
+
+            if (! continue_)
+            {
+                return false;
+            }
+
+            int stepping_dim = -1; // dimension in which the line next exits the current cell
+            double percentage_along_line = std::numeric_limits<double>::max();
+            for (int dim = 0; dim < 3; dim++)
+            {
+                if (diff[dim] == 0)
+                {
+                    continue;
+                }
+                coord_t crossing_boundary = toLowerCoord(current_cell[dim], dim) + (diff[dim] > 0) * cell_size_[dim];
+                double percentage_along_line_here = (crossing_boundary - start[dim]) / static_cast<double>(diff[dim]);
+                if (percentage_along_line_here < percentage_along_line)
+                {
+                    percentage_along_line = percentage_along_line_here;
+                    stepping_dim = dim;
+                }
+            }
+            assert(stepping_dim != -1);
+            if (percentage_along_line > 1.0)
+            {
+                // next cell is beyond the end
+                return true;
+            }
+            current_cell[stepping_dim] += (diff[stepping_dim] > 0) ? 1 : -1;
+        }
+        return true;
+    }
 
     /*!
      * Process voxels which the line segments of a polygon crosses.
@@ -92,7 +155,24 @@ public:
      * \param process_cell_func Function to perform on each voxel cell
      * \return Whether executing was stopped short as indicated by the \p cell_processing_function
      */
-    bool walkPolygons(const Shape& polys, coord_t z, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    template<CellFunc ProcessCellFunc>
+    bool walkPolygons(const Shape& polys, coord_t z, ProcessCellFunc&& process_cell_func) const
+    {
+        for (const Polygon& poly : polys)
+        {
+            Point2LL last = poly.back();
+            for (Point2LL p : poly)
+            {
+                bool continue_ = walkLine(Point3LL(last.X, last.Y, z), Point3LL(p.X, p.Y, z), process_cell_func);
+                if (! continue_)
+                {
+                    return false;
+                }
+                last = p;
+            }
+        }
+        return true;
+    }
 
     /*!
      * Process voxels near the line segments of a polygon.
@@ -105,13 +185,32 @@ public:
      * \param process_cell_func Function to perform on each voxel cell
      * \return Whether executing was stopped short as indicated by the \p cell_processing_function
      */
-    bool walkDilatedPolygons(const Shape& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    template<CellFunc ProcessCellFunc>
+    bool walkDilatedPolygons(const Shape& polys, coord_t z, const DilationKernel& kernel, ProcessCellFunc&& process_cell_func) const
+    {
+        Shape translated = polys;
+        const Point3LL translation = (Point3LL(1, 1, 1) - kernel.kernel_size_ % 2) * cell_size_ / 2;
+        if (translation.x_ && translation.y_)
+        {
+            translated.translate(Point2LL(translation.x_, translation.y_));
+        }
+        return walkPolygons(translated, z + translation.z_, dilate(kernel, process_cell_func));
+    }
 
 private:
     /*!
+     * Compute the voxels of which the middle is inside an area, in runs of
+     * neighbouring cells along the Y axis.
+     *
      * \warning the \p polys is assumed to be translated by half the cell_size in xy already
+     *
+     * \param[out] cells The cells, run after run
+     * \param[out] run_ends For each run, the index in \p cells after its last cell
      */
-    bool _walkAreas(const Shape& polys, coord_t z, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    void areaCells(const Shape& polys, coord_t z, std::vector<GridPoint3>& cells, std::vector<size_t>& run_ends) const;
+
+    //! The translation to apply to an area before walking it, so that the cells are centered on the area.
+    Point3LL areaTranslation(const DilationKernel* kernel) const;
 
 public:
     /*!
@@ -124,7 +223,18 @@ public:
      * \param process_cell_func Function to perform on each voxel cell
      * \return Whether executing was stopped short as indicated by the \p cell_processing_function
      */
-    bool walkAreas(const Shape& polys, coord_t z, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    template<CellFunc ProcessCellFunc>
+    bool walkAreas(const Shape& polys, coord_t z, ProcessCellFunc&& process_cell_func) const
+    {
+        return walkDilatedAreaRuns(
+            polys,
+            z,
+            nullptr,
+            [&process_cell_func](const std::span<const GridPoint3> cells)
+            {
+                return std::all_of(cells.begin(), cells.end(), std::ref(process_cell_func));
+            });
+    }
 
     /*!
      * Process all voxels inside the area of a polygons object.
@@ -137,7 +247,86 @@ public:
      * \param process_cell_func Function to perform on each voxel cell
      * \return Whether executing was stopped short as indicated by the \p cell_processing_function
      */
-    bool walkDilatedAreas(const Shape& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    template<CellFunc ProcessCellFunc>
+    bool walkDilatedAreas(const Shape& polys, coord_t z, const DilationKernel& kernel, ProcessCellFunc&& process_cell_func) const
+    {
+        return walkDilatedAreaRuns(
+            polys,
+            z,
+            kernel,
+            [&process_cell_func](const std::span<const GridPoint3> cells)
+            {
+                return std::all_of(cells.begin(), cells.end(), std::ref(process_cell_func));
+            });
+    }
+
+    /*!
+     * Process all voxels inside the area of a polygons object, a run of
+     * neighbouring cells at a time, so that they can be stored in bulk.
+     * For each run of voxels inside the polygon we process the run offset by
+     * each of the offset positions of the kernel.
+     *
+     * \warning The voxels along the area are not processed. Thin areas might not process any voxels at all.
+     *
+     * \param polys The area to fill
+     * \param z The height at which the polygons occur
+     * \param kernel The kernel to dilate with, or nullptr to not dilate
+     * \param process_cells_func Function to perform on each run of voxel cells
+     * \return Whether executing was stopped short as indicated by the \p process_cells_func
+     */
+    template<CellsFunc ProcessCellsFunc>
+    bool walkDilatedAreaRuns(const Shape& polys, coord_t z, const DilationKernel* kernel, ProcessCellsFunc&& process_cells_func) const
+    {
+        Shape translated = polys;
+        const Point3LL translation = areaTranslation(kernel);
+        if (translation.x_ && translation.y_)
+        {
+            translated.translate(Point2LL(translation.x_, translation.y_));
+        }
+        std::vector<GridPoint3> cells;
+        std::vector<size_t> run_ends;
+        areaCells(translated, z + translation.z_, cells, run_ends);
+        if (kernel == nullptr)
+        {
+            size_t run_start = 0;
+            for (const size_t run_end : run_ends)
+            {
+                if (! process_cells_func(std::span<const GridPoint3>(cells.data() + run_start, run_end - run_start)))
+                {
+                    return false;
+                }
+                run_start = run_end;
+            }
+            return true;
+        }
+
+        std::vector<GridPoint3> dilated_run;
+        size_t run_start = 0;
+        for (const size_t run_end : run_ends)
+        {
+            for (const GridPoint3& rel : kernel->relative_cells_)
+            {
+                dilated_run.clear();
+                for (size_t cell_idx = run_start; cell_idx < run_end; cell_idx++)
+                {
+                    dilated_run.push_back(cells[cell_idx] + rel);
+                }
+                if (! process_cells_func(std::span<const GridPoint3>(dilated_run)))
+                {
+                    return false;
+                }
+            }
+            run_start = run_end;
+        }
+        return true;
+    }
+
+    //! \copydoc walkDilatedAreaRuns
+    template<CellsFunc ProcessCellsFunc>
+    bool walkDilatedAreaRuns(const Shape& polys, coord_t z, const DilationKernel& kernel, ProcessCellsFunc&& process_cells_func) const
+    {
+        return walkDilatedAreaRuns(polys, z, &kernel, process_cells_func);
+    }
 
     /*!
      * Dilate with a kernel.
@@ -147,9 +336,23 @@ public:
      * Apply this function to a process_cell_func to create a new process_cell_func which applies the effect to nearby voxels as well.
      *
      * \param kernel The offset positions relative to the input of \p process_cell_func
-     * \param process_cell_func Function to perform on each voxel cell
+     * \param process_cell_func Function to perform on each voxel cell. It
+     * needs to outlive the returned function.
      */
-    std::function<bool(GridPoint3)> dilate(const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    template<CellFunc ProcessCellFunc>
+    auto dilate(const DilationKernel& kernel, ProcessCellFunc& process_cell_func) const
+    {
+        return [&process_cell_func, &kernel](GridPoint3 loc)
+        {
+            for (const GridPoint3& rel : kernel.relative_cells_)
+            {
+                bool continue_ = process_cell_func(loc + rel);
+                if (! continue_)
+                    return false;
+            }
+            return true;
+        };
+    }
 
     GridPoint3 toGridPoint(const Point3LL& point) const
     {
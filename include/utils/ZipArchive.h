@@ -0,0 +1,82 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef UTILS_ZIP_ARCHIVE_H
+#define UTILS_ZIP_ARCHIVE_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace cura
+{
+
+/*!
+ * \brief Read access to the files in a ZIP archive, like the parts of a 3MF
+ * file.
+ *
+ * The archive is mapped into memory and only its central directory is read
+ * when it's opened. The files are extracted when they're requested. Only the
+ * stored and deflated compression methods are supported, and no ZIP64
+ * extensions or encryption, which is all that 3MF files use in practice.
+ *
+ * File names are looked up case-insensitively and without a leading slash,
+ * like the part names of the Open Packaging Conventions that 3MF is based on.
+ */
+class ZipArchive
+{
+public:
+    /*!
+     * Map a ZIP archive into memory and read its central directory.
+     * \param filename The archive to open.
+     * \return The opened archive, or nullptr if it couldn't be opened or isn't
+     * a valid ZIP archive.
+     */
+    static std::unique_ptr<ZipArchive> open(const std::string& filename);
+
+    ~ZipArchive();
+
+    /*!
+     * Whether the archive contains a file with a certain name.
+     */
+    [[nodiscard]] bool contains(std::string_view name) const;
+
+    /*!
+     * Extract a file from the archive.
+     * \param name The name of the file in the archive.
+     * \return The contents of the file, or nothing if the archive doesn't
+     * contain it or it couldn't be decompressed.
+     */
+    [[nodiscard]] std::optional<std::string> read(std::string_view name) const;
+
+private:
+    ZipArchive() = default;
+
+    //! Where a file is in the archive and how it's compressed, from the central directory.
+    struct Entry
+    {
+        uint16_t method_; //!< 0 for stored, 8 for deflated.
+        uint32_t compressed_size_;
+        uint32_t uncompressed_size_;
+        uint32_t local_header_offset_;
+    };
+
+    /*!
+     * The key under which a file name is stored in \ref entries_.
+     */
+    static std::string normalizeName(std::string_view name);
+
+    struct Mapping;
+    std::unique_ptr<Mapping> mapping_; //!< Keeps the file mapped while this object is alive.
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::string filename_; //!< For the error messages.
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace cura
+
+#endif // UTILS_ZIP_ARCHIVE_H
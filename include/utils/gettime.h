@@ -10,6 +10,10 @@
 
 #include <spdlog/stopwatch.h>
 
+#ifdef ALLOCATION_PROFILING
+#include "utils/AllocationProfiler.h"
+#endif
+
 namespace cura
 {
 
@@ -28,6 +32,9 @@ private:
     spdlog::stopwatch watch;
     double start_time;
     RegisteredTimes registered_times;
+#ifdef ALLOCATION_PROFILING
+    AllocationProfiler::ThreadCounts allocations_start; //!< To count the allocations of the registered stages.
+#endif
 
 public:
     TimeKeeper();
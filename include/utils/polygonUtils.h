@@ -385,6 +385,21 @@ public:
      */
     static unsigned int findNearestVert(const Point2LL from, const Polygon& poly);
 
+    /*!
+     * Compute how sharp the corner at each vertex of a closed path is, to place seams in corners.
+     *
+     * Some models have very sharp corners, but also have a high resolution. If a sharp corner
+     * consists of many points each point individual might have a shallow corner, but the
+     * collective angle of all nearby points is greater. To counter this the angle is
+     * calculated from two points within angle_query_distance of the query point, no matter
+     * what segment this leads us to.
+     * \param points The vertices of the closed path
+     * \param angle_query_distance query range (default to 1mm)
+     * \return For each vertex, the angle between the vertex and the two sibling points, weighed to [-1.0 ; 1.0]. Angles < 0 are concave (left turning), angles > 0
+     * are convex (right turning).
+     */
+    static std::vector<double> cornerAngles(const PointsSet& points, const coord_t angle_query_distance = 1000);
+
     /*!
      * Create a SparsePointGridInclusive mapping from locations to line segments occurring in the \p polygons
      *
@@ -701,6 +716,8 @@ public:
     static ClosedLinesSet generateCircularInset(const Point2LL& center, const coord_t outer_radius, const coord_t line_width, const size_t circle_definition);
 
 private:
+    friend class ShapeLocator; // To move points inside from the closest points it finds.
+
     /*!
      * Helper function for PolygonUtils::moveInside2: moves a point \p from which was moved onto \p closest_polygon_point towards inside/outside when it's not already
      * inside/outside by enough distance.
@@ -4,10 +4,13 @@
 #ifndef UTILS_STRING_H
 #define UTILS_STRING_H
 
+#include <algorithm>
+#include <charconv> // to_chars
 #include <cmath>
 #include <cstdio> // sprintf
 #include <ctype.h>
 #include <sstream> // ostringstream
+#include <system_error> // errc
 
 #include <spdlog/spdlog.h>
 
@@ -27,74 +30,73 @@ static inline int stringcasecompare(const char* a, const char* b)
     return *a - *b;
 }
 
+//! The most characters that \ref writeInt2mm writes: a sign, ten digits and the decimal dot.
+constexpr size_t int2mm_max_chars = 16;
+
 /*!
- * Efficient conversion of micron integer type to millimeter string.
+ * Efficient conversion of micron integer type to millimeter string, written into a character buffer.
  *
  * The integer type is half the size of the normal integer type because of implementation details.
  * However, half the integer type should suffice, because we made the basic coord_t twice as big as necessary
  * so as to support multiplication within the same integer type.
  *
+ * The digits are formatted without going through any format string.
+ *
  * \param coord The micron unit to convert
- * \param ss The output stream to write the string to
+ * \param out Where to write the characters. There must be room for at least \ref int2mm_max_chars characters.
+ * \return The end of the written characters.
  */
-static inline void writeInt2mm(const int32_t coord, std::ostream& ss)
+static inline char* writeInt2mm(const int32_t coord, char* out)
 {
-    constexpr size_t buffer_size = 24;
+    constexpr size_t buffer_size = 12;
     char buffer[buffer_size];
-    int char_count = sprintf(buffer, "%d", coord); // we haven't found any way for the windows compiler to accept formatting of a coord_t, so it has to be int32_t instead
-#ifdef DEBUG
-    if (char_count + 1 >= int(buffer_size)) // + 1 for the null character
-    {
-        spdlog::error("Cannot write {} to buffer of size {}", coord, buffer_size);
-    }
-    if (char_count < 0)
-    {
-        spdlog::error("Encoding error while writing {}", coord);
-    }
-#endif // DEBUG
-    int end_pos = char_count; // the first character not to write any more
-    int trailing_zeros = 1;
-    while (trailing_zeros < 4 && buffer[char_count - trailing_zeros] == '0')
+    const int char_count = static_cast<int>(std::to_chars(buffer, buffer + buffer_size, coord).ptr - buffer);
+
+    int trailing_zeros = 0; // Up to 3, the number of decimals that are 0.
+    while (trailing_zeros < 3 && trailing_zeros < char_count && buffer[char_count - 1 - trailing_zeros] == '0')
     {
         trailing_zeros++;
     }
-    trailing_zeros--;
-    end_pos = char_count - trailing_zeros;
+    const int end_pos = char_count - trailing_zeros; // the first character not to write any more
     if (trailing_zeros == 3)
     { // no need to write the decimal dot
-        buffer[char_count - trailing_zeros] = '\0';
-        ss << buffer;
-        return;
+        return std::copy(buffer, buffer + end_pos, out);
     }
+
     if (char_count <= 3)
     {
         int start = 0; // where to start writing from the buffer
         if (coord < 0)
         {
-            ss << '-';
+            *out++ = '-';
             start = 1;
         }
-        ss << "0.";
+        *out++ = '0';
+        *out++ = '.';
         for (int nulls = char_count - start; nulls < 3; nulls++)
         { // fill up to 3 decimals with zeros
-            ss << '0';
-        }
-        buffer[char_count - trailing_zeros] = '\0';
-        ss << (static_cast<char*>(buffer) + start);
-    }
-    else
-    {
-        char prev = '.';
-        int pos;
-        for (pos = char_count - 3; pos <= end_pos; pos++)
-        { // shift all characters and insert the decimal dot
-            char next_prev = buffer[pos];
-            buffer[pos] = prev;
-            prev = next_prev;
+            *out++ = '0';
         }
-        buffer[pos] = '\0';
-        ss << buffer;
+        return std::copy(buffer + start, buffer + end_pos, out);
     }
+    // insert the decimal dot before the last 3 digits
+    out = std::copy(buffer, buffer + char_count - 3, out);
+    *out++ = '.';
+    return std::copy(buffer + char_count - 3, buffer + end_pos, out);
+}
+
+/*!
+ * Efficient conversion of micron integer type to millimeter string.
+ *
+ * The characters are formatted with \ref writeInt2mm into a buffer and then written to the stream at once.
+ *
+ * \param coord The micron unit to convert
+ * \param ss The output stream to write the string to
+ */
+static inline void writeInt2mm(const int32_t coord, std::ostream& ss)
+{
+    char output[int2mm_max_chars];
+    ss.write(output, writeInt2mm(coord, output) - output);
 }
 
 /*!
@@ -112,54 +114,77 @@ struct MMtoStream
 };
 
 /*!
- * Efficient writing of a double to a stringstream
+ * Efficient writing of a double to a character buffer
  *
  * writes with \p precision digits after the decimal dot, but removes trailing zeros
  *
+ * The number is formatted with std::to_chars, which rounds exactly like printf but doesn't need to parse
+ * a format string or consult the locale. Only infinity and NaN still go through sprintf, to keep them in
+ * upper case.
+ *
  * \warning only works with precision up to 9 and input up to 10^14
  *
  * \param precision The number of (non-zero) digits after the decimal dot
  * \param coord double to output
- * \param ss The output stream to write the string to
+ * \param out Where to write the characters.
+ * \param out_limit The end of the room there is to write characters. Nothing is written if the number doesn't fit.
+ * \return The end of the written characters.
  */
-static inline void writeDoubleToStream(const uint8_t precision, const double coord, std::ostream& ss)
+static inline char* writeDoubleToBuffer(const uint8_t precision, const double coord, char* out, char* out_limit)
 {
-    char format[5] = "%.xF"; // write a float with [x] digits after the dot
-    format[2] = '0' + static_cast<char>(precision); // set [x]
-    constexpr size_t buffer_size = 400;
-    char buffer[buffer_size];
-    int char_count = sprintf(buffer, format, coord);
-#ifdef DEBUG
-    if (char_count + 1 >= int(buffer_size)) // + 1 for the null character
+    int char_count;
+    if (std::isfinite(coord))
+    {
+        const std::to_chars_result result = std::to_chars(out, out_limit, coord, std::chars_format::fixed, precision);
+        char_count = result.ec == std::errc() ? static_cast<int>(result.ptr - out) : -1;
+    }
+    else
     {
-        spdlog::error("Cannot write {} to buffer of size {}", coord, buffer_size);
+        char format[5] = "%.xF"; // write a float with [x] digits after the dot
+        format[2] = '0' + static_cast<char>(precision); // set [x]
+        char_count = snprintf(out, out_limit - out, format, coord);
+        if (char_count >= out_limit - out)
+        {
+            char_count = -1;
+        }
     }
+#ifdef DEBUG
     if (char_count < 0)
     {
-        spdlog::error("Encoding error while writing {}", coord);
+        spdlog::error("Cannot write {} to buffer of size {}", coord, out_limit - out);
     }
 #endif // DEBUG
     if (char_count <= 0)
     {
-        return;
+        return out;
     }
-    if (buffer[char_count - precision - 1] == '.')
+    int end_pos = char_count; // the first character not to write any more
+    if (char_count > precision && out[char_count - precision - 1] == '.')
     {
         int non_nul_pos = char_count - 1;
-        while (buffer[non_nul_pos] == '0')
+        while (out[non_nul_pos] == '0')
         {
             non_nul_pos--;
         }
-        if (buffer[non_nul_pos] == '.')
-        {
-            buffer[non_nul_pos] = '\0';
-        }
-        else
-        {
-            buffer[non_nul_pos + 1] = '\0';
-        }
+        end_pos = out[non_nul_pos] == '.' ? non_nul_pos : non_nul_pos + 1;
     }
-    ss << buffer;
+    return out + end_pos;
+}
+
+/*!
+ * Efficient writing of a double to a stringstream
+ *
+ * The characters are formatted with \ref writeDoubleToBuffer and then written to the stream at once.
+ *
+ * \param precision The number of (non-zero) digits after the decimal dot
+ * \param coord double to output
+ * \param ss The output stream to write the string to
+ */
+static inline void writeDoubleToStream(const uint8_t precision, const double coord, std::ostream& ss)
+{
+    constexpr size_t buffer_size = 400;
+    char buffer[buffer_size];
+    ss.write(buffer, writeDoubleToBuffer(precision, coord, buffer, buffer + buffer_size) - buffer);
 }
 
 /*!
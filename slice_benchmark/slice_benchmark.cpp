@@ -0,0 +1,426 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include <algorithm>
+#include <csignal>
+#include <docopt/docopt.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <source_location>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "Application.h"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+
+constexpr std::string_view USAGE = R"(Slice Benchmark.
+
+Slices the reference models with their settings, each in a process of its own, and reports how long each stage took, the peak memory use
+and the size of the g-code.
+
+Usage:
+  slice_benchmark -o FILE [--baseline FILE] [--tolerance PERCENT] [--threads N] [--timeout SECONDS]
+  slice_benchmark (-h | --help)
+  slice_benchmark --version
+
+Options:
+  -h --help                      Show this screen.
+  --version                      Show version.
+  -o FILE                        Specify the output Json file.
+  --baseline FILE                The output Json file of an earlier run. Fails if a case got slower or used more memory than in it.
+  --tolerance PERCENT            How much slower or bigger than the baseline a result may be [default: 10].
+  --threads N                    The number of threads to slice with, or 0 for the number of cores [default: 0].
+  --timeout SECONDS              How long a case may take before it's stopped [default: 900].
+)";
+
+//! Stages that took less than this in the baseline aren't compared, since they vary too much from run to run.
+constexpr double min_gated_duration = 0.1;
+
+/*!
+ * A reference model with its settings, read from a Json file in the resources:
+ * - "machine": the definition file of the printer, in cmd_test/definitions,
+ * - "models": the models to slice, in cmd_test,
+ * - "settings": the settings to slice with, as strings, on top of those of the printer.
+ */
+struct Resource
+{
+    std::filesystem::path case_file;
+
+    std::string stem() const
+    {
+        return case_file.stem().string();
+    }
+
+    //! The arguments to slice the case with, like those on the command line.
+    std::optional<std::vector<std::string>> arguments(const std::filesystem::path& report_file, const std::filesystem::path& gcode_file, const size_t threads) const
+    {
+        std::ifstream file{ case_file };
+        if (! file)
+        {
+            spdlog::error("Could not read the case from: {}", case_file.string());
+            return std::nullopt;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        rapidjson::Document document;
+        document.Parse(buffer.str().c_str());
+        if (document.HasParseError() || ! document.IsObject() || ! document.HasMember("machine") || ! document["machine"].IsString() || ! document.HasMember("models")
+            || ! document["models"].IsArray())
+        {
+            spdlog::error("Invalid case: {}", case_file.string());
+            return std::nullopt;
+        }
+
+        const std::filesystem::path cmd_test_path = std::filesystem::path(std::source_location::current().file_name()).parent_path().parent_path().append("cmd_test");
+        const std::filesystem::path definitions_path = cmd_test_path / "definitions";
+        std::vector<std::string> arguments{ "CuraEngine",
+                                            "slice",
+                                            fmt::format("--timing-report={}", report_file.string()),
+                                            "-d",
+                                            fmt::format("{}:{}", definitions_path.string(), (cmd_test_path / "extruders").string()),
+                                            "-j",
+                                            (definitions_path / fmt::format("{}.def.json", document["machine"].GetString())).string() };
+        if (threads > 0)
+        {
+            arguments.emplace_back(fmt::format("-m{}", threads));
+        }
+        if (document.HasMember("settings") && document["settings"].IsObject())
+        {
+            for (const auto& setting : document["settings"].GetObject())
+            {
+                if (! setting.value.IsString())
+                {
+                    spdlog::error("The value of {} in {} isn't a string.", setting.name.GetString(), case_file.string());
+                    return std::nullopt;
+                }
+                arguments.emplace_back("-s");
+                arguments.emplace_back(fmt::format("{}={}", setting.name.GetString(), setting.value.GetString()));
+            }
+        }
+        for (const auto& model : document["models"].GetArray())
+        {
+            if (! model.IsString())
+            {
+                spdlog::error("Invalid model in {}.", case_file.string());
+                return std::nullopt;
+            }
+            arguments.emplace_back("-l");
+            arguments.emplace_back((cmd_test_path / model.GetString()).string());
+        }
+        arguments.emplace_back("-o");
+        arguments.emplace_back(gcode_file.string());
+        return arguments;
+    }
+};
+
+//! The results of a case, as reported by the engine.
+struct Result
+{
+    double duration;
+    std::optional<uint64_t> peak_rss;
+    uintmax_t gcode_bytes;
+    std::vector<std::pair<std::string, double>> stages;
+};
+
+std::vector<Resource> getResources()
+{
+    auto resource_path = std::filesystem::path(std::source_location::current().file_name()).parent_path().append("resources");
+
+    std::vector<Resource> resources;
+    for (const auto& p : std::filesystem::recursive_directory_iterator(resource_path))
+    {
+        if (p.path().extension() == ".json")
+        {
+            spdlog::info("Adding resources for: {}", p.path().filename().stem().string());
+            resources.emplace_back(Resource{ .case_file = p });
+        }
+    }
+    std::sort(
+        resources.begin(),
+        resources.end(),
+        [](const Resource& a, const Resource& b)
+        {
+            return a.case_file < b.case_file;
+        }); // Keep the order of the results the same from run to run.
+    return resources;
+}
+
+void handleChildProcess(std::vector<std::string> arguments)
+{
+    std::vector<char*> argv;
+    for (std::string& argument : arguments)
+    {
+        argv.push_back(argument.data());
+    }
+    argv.push_back(nullptr);
+    cura::Application::getInstance().run(arguments.size(), argv.data());
+    exit(EXIT_SUCCESS);
+}
+
+//! Read the timing report that the engine wrote for a case.
+std::optional<Result> readResult(const std::filesystem::path& report_file, const std::filesystem::path& gcode_file)
+{
+    std::ifstream file{ report_file };
+    if (! file)
+    {
+        spdlog::error("The engine wrote no timing report to {}.", report_file.string());
+        return std::nullopt;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    rapidjson::Document document;
+    document.Parse(buffer.str().c_str());
+    if (document.HasParseError() || ! document.IsObject() || ! document.HasMember("duration") || ! document.HasMember("stages") || ! document["stages"].IsArray())
+    {
+        spdlog::error("Invalid timing report: {}", report_file.string());
+        return std::nullopt;
+    }
+
+    Result result{ .duration = document["duration"].GetDouble(), .peak_rss = std::nullopt, .gcode_bytes = 0, .stages = {} };
+    if (document.HasMember("peak_rss") && document["peak_rss"].IsUint64())
+    {
+        result.peak_rss = document["peak_rss"].GetUint64();
+    }
+    std::error_code error;
+    result.gcode_bytes = std::filesystem::file_size(gcode_file, error);
+    if (error)
+    {
+        spdlog::error("The engine wrote no g-code to {}.", gcode_file.string());
+        return std::nullopt;
+    }
+    for (const auto& stage : document["stages"].GetArray())
+    {
+        result.stages.emplace_back(stage["name"].GetString(), stage["duration"].GetDouble());
+    }
+    return result;
+}
+
+rapidjson::Value
+    createRapidJSONObject(rapidjson::Document::AllocatorType& allocator, const std::string& test_name, const auto value, const std::string& unit, const std::string& extra_info)
+{
+    rapidjson::Value obj(rapidjson::kObjectType);
+    rapidjson::Value key("name", allocator);
+    rapidjson::Value val1(test_name.c_str(), test_name.length(), allocator);
+    obj.AddMember(key, val1, allocator);
+    key.SetString("unit", allocator);
+    rapidjson::Value val2(unit.c_str(), unit.length(), allocator);
+    obj.AddMember(key, val2, allocator);
+    key.SetString("value", allocator);
+    rapidjson::Value val3(value);
+    obj.AddMember(key, val3, allocator);
+    key.SetString("extra", allocator);
+    rapidjson::Value val4(extra_info.c_str(), extra_info.length(), allocator);
+    obj.AddMember(key, val4, allocator);
+    return obj;
+}
+
+/*!
+ * Write the results in the format of the other benchmarks: a list of named values with their unit.
+ *
+ * For each case there is the total duration (\<case\>: total), the duration of each stage (\<case\>: \<stage\>), the peak memory use (\<case\>: peak memory) and the size of
+ * the g-code (\<case\>: g-code size). Cases that failed only have their total duration, of -1.
+ */
+rapidjson::Document createJson(const std::vector<std::pair<std::string, std::optional<Result>>>& results)
+{
+    rapidjson::Document doc;
+    doc.SetArray();
+    rapidjson::Document::AllocatorType& allocator = doc.GetAllocator();
+    for (const auto& [name, result] : results)
+    {
+        if (! result)
+        {
+            doc.PushBack(createRapidJSONObject(allocator, fmt::format("{}: total", name), -1.0, "s", "Failed"), allocator);
+            continue;
+        }
+        doc.PushBack(createRapidJSONObject(allocator, fmt::format("{}: total", name), result->duration, "s", ""), allocator);
+        for (const auto& [stage, duration] : result->stages)
+        {
+            doc.PushBack(createRapidJSONObject(allocator, fmt::format("{}: {}", name, stage), duration, "s", ""), allocator);
+        }
+        if (result->peak_rss)
+        {
+            doc.PushBack(createRapidJSONObject(allocator, fmt::format("{}: peak memory", name), *result->peak_rss, "bytes", ""), allocator);
+        }
+        doc.PushBack(createRapidJSONObject(allocator, fmt::format("{}: g-code size", name), static_cast<uint64_t>(result->gcode_bytes), "bytes", ""), allocator);
+    }
+    return doc;
+}
+
+void writeJson(const std::filesystem::path& out_file, const rapidjson::Document& doc)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    doc.Accept(writer);
+
+    spdlog::info("Writing Json results: {}", std::filesystem::absolute(out_file).string());
+    std::ofstream file{ out_file };
+    if (! file)
+    {
+        spdlog::critical("Failed to open the file: {}", out_file.string());
+        exit(EXIT_FAILURE);
+    }
+    file.write(buffer.GetString(), buffer.GetSize());
+    file.close();
+}
+
+/*!
+ * Compare the results with those of an earlier run.
+ *
+ * The durations and the peak memory use may be at most \p tolerance_percent higher than in the baseline. The size of the g-code isn't compared, since that changes with
+ * anything that changes the output.
+ * \return The number of results that got worse, or nothing if the baseline couldn't be read.
+ */
+std::optional<size_t> compareWithBaseline(const rapidjson::Document& doc, const std::filesystem::path& baseline_file, const double tolerance_percent)
+{
+    std::ifstream file{ baseline_file };
+    if (! file)
+    {
+        spdlog::critical("Could not read the baseline from: {}", baseline_file.string());
+        return std::nullopt;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    rapidjson::Document baseline;
+    baseline.Parse(buffer.str().c_str());
+    if (baseline.HasParseError() || ! baseline.IsArray())
+    {
+        spdlog::critical("Invalid baseline: {}", baseline_file.string());
+        return std::nullopt;
+    }
+    std::map<std::string, double> baseline_values;
+    for (const auto& entry : baseline.GetArray())
+    {
+        baseline_values.emplace(entry["name"].GetString(), entry["value"].GetDouble());
+    }
+
+    size_t regressions = 0;
+    for (const auto& entry : doc.GetArray())
+    {
+        const std::string name = entry["name"].GetString();
+        const std::string_view unit = entry["unit"].GetString();
+        const double value = entry["value"].GetDouble();
+        const auto baseline_value = baseline_values.find(name);
+        if (name.ends_with(": g-code size") || baseline_value == baseline_values.end() || baseline_value->second < 0.0)
+        {
+            continue;
+        }
+        if (value < 0.0)
+        {
+            spdlog::error("{} failed, but didn't in the baseline.", name);
+            regressions++;
+        }
+        else if (unit == "s" && baseline_value->second < min_gated_duration)
+        {
+            continue;
+        }
+        else if (value > baseline_value->second * (1.0 + tolerance_percent / 100.0))
+        {
+            spdlog::error("{} went from {} to {} {} (+{:.1f}%).", name, baseline_value->second, value, unit, (value / baseline_value->second - 1.0) * 100.0);
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+int main(int argc, const char** argv)
+{
+    constexpr bool show_help = true;
+    constexpr std::string_view version = "0.1.0";
+    const std::map<std::string, docopt::value> args = docopt::docopt(fmt::format("{}", USAGE), { argv + 1, argv + argc }, show_help, fmt::format("{}", version));
+    const size_t threads = std::stoul(args.at("--threads").asString());
+    const unsigned int timeout = std::stoul(args.at("--timeout").asString());
+
+    const std::filesystem::path work_path = std::filesystem::temp_directory_path() / fmt::format("slice_benchmark_{}", getpid());
+    std::filesystem::create_directories(work_path);
+
+    std::vector<std::pair<std::string, std::optional<Result>>> results;
+    for (const auto& resource : getResources())
+    {
+        const std::filesystem::path report_file = work_path / fmt::format("{}.json", resource.stem());
+        const std::filesystem::path gcode_file = work_path / fmt::format("{}.gcode", resource.stem());
+        const auto arguments = resource.arguments(report_file, gcode_file, threads);
+        if (! arguments)
+        {
+            results.emplace_back(resource.stem(), std::nullopt);
+            continue;
+        }
+
+        spdlog::critical("Starting test case {}", resource.stem());
+        pid_t engine_pid = fork();
+        if (engine_pid == -1)
+        {
+            spdlog::critical("Unable to fork - engine");
+            return EXIT_FAILURE;
+        }
+        else if (engine_pid == 0)
+        {
+            handleChildProcess(*arguments);
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            pid_t waiter_pid = fork();
+            if (waiter_pid == -1)
+            {
+                spdlog::critical("Unable to fork - waiter");
+                return EXIT_FAILURE;
+            }
+            else if (waiter_pid == 0)
+            {
+                sleep(timeout);
+                kill(engine_pid, SIGKILL);
+                return EXIT_SUCCESS;
+            }
+            else
+            {
+                int status;
+                waitpid(engine_pid, &status, 0);
+                kill(waiter_pid, SIGKILL);
+                waitpid(waiter_pid, nullptr, 0);
+                if (WIFSIGNALED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+                {
+                    spdlog::error("# Test case {} crashed or was stopped", resource.stem());
+                    results.emplace_back(resource.stem(), std::nullopt);
+                }
+                else
+                {
+                    spdlog::info("+ Test case {} processed normally", resource.stem());
+                    results.emplace_back(resource.stem(), readResult(report_file, gcode_file));
+                }
+            }
+        }
+    }
+    std::filesystem::remove_all(work_path);
+
+    const rapidjson::Document doc = createJson(results);
+    writeJson(std::filesystem::path{ args.at("-o").asString() }, doc);
+
+    if (args.at("--baseline"))
+    {
+        const std::optional<size_t> regressions = compareWithBaseline(doc, std::filesystem::path{ args.at("--baseline").asString() }, std::stod(args.at("--tolerance").asString()));
+        if (! regressions)
+        {
+            return EXIT_FAILURE;
+        }
+        if (*regressions > 0)
+        {
+            spdlog::critical("{} results got worse than in the baseline.", *regressions);
+            return EXIT_FAILURE;
+        }
+        spdlog::info("No results got worse than in the baseline.");
+    }
+    return EXIT_SUCCESS;
+}
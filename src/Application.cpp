@@ -3,9 +3,18 @@
 
 #include "Application.h"
 
+#ifdef __linux__
+#include <sched.h> // For CPU_SETSIZE.
+#endif
+
+#include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <iostream> // To read the jobs of the daemon from the standard input.
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <boost/uuid/random_generator.hpp> //For generating a UUID.
 #include <boost/uuid/uuid_io.hpp> //For generating a UUID.
@@ -20,6 +29,7 @@
 
 #include "communication/ArcusCommunication.h" //To connect via Arcus to the front-end.
 #include "communication/CommandLine.h" //To use the command line to slice stuff.
+#include "MeshGroup.h" //To convert fiber path files.
 #include "progress/Progress.h"
 #include "utils/ThreadPool.h"
 #include "utils/string.h" //For stringcasecompare.
@@ -125,7 +135,10 @@ void Application::printHelp() const
     fmt::print("  -m<thread_count>\n\tSet the desired number of threads. Supports only a single digit.\n");
     fmt::print("\n");
 #endif // ARCUS
-    fmt::print("CuraEngine slice [-v] [-p] [-j <settings.json>] [-s <settingkey>=<value>] [-g] [-e<extruder_nr>] [-o <output.gcode>] [-l <model.stl>] [-f <fiberpath.json>] [--next]\n");
+    fmt::print("CuraEngine convert-fiberpath <fiberpath.txt> <fiberpath.fpb>\n");
+    fmt::print("\tConvert a text fiber path file to the binary format, which loads faster.\n");
+    fmt::print("\n");
+    fmt::print("CuraEngine slice [-v] [-p] [-j <settings.json>] [-s <settingkey>=<value>] [-g] [-e<extruder_nr>] [-o <output.gcode>] [-l <model.stl>] [-f <fiberpath.txt|fiberpath.fpb>] [--next]\n");
     fmt::print("  -v\n\tIncrease the verbose level (show log messages).\n");
     fmt::print("  -m<thread_count>\n\tSet the desired number of threads.\n");
     fmt::print("  -p\n\tLog progress information.\n");
@@ -133,12 +146,21 @@ void Application::printHelp() const
     fmt::print("  -j\n\tLoad settings.def.json file to register all settings and their defaults.\n");
     fmt::print("  -r\n\tLoad a json file containing resolved setting values.\n");
     fmt::print("  -s <setting>=<value>\n\tSet a setting to a value for the last supplied object, \n\textruder train, or general settings.\n");
-    fmt::print("  -l <model_file>\n\tLoad an STL model. \n");
-    fmt::print("  -f <fiber_path>\n\tLoad FiberPath into current MeshGroup. \n");
+    fmt::print("  -l <model_file>\n\tLoad an STL, OBJ or 3MF model. \n");
+    fmt::print("  -f <fiber_path>\n\tLoad FiberPath into current MeshGroup. Either a .txt file or a binary .fpb file.\n");
     fmt::print("  -g\n\tSwitch setting focus to the current mesh group only.\n\tUsed for one-at-a-time printing.\n");
     fmt::print("  -e<extruder_nr>\n\tSwitch setting focus to the extruder train with the given number.\n");
     fmt::print("  --next\n\tGenerate gcode for the previously supplied mesh group and append that to \n\tthe gcode of further models for one-at-a-time printing.\n");
     fmt::print("  -o <output_file>\n\tSpecify a file to which to write the generated gcode.\n");
+    fmt::print("  --profile-settings[=<report.csv>]\n\tCount how often each setting is looked up and how long that takes, and report \n\tthe most expensive ones at the end of the slice. Needs a build with \n\tENABLE_SETTINGS_PROFILING.\n");
+    fmt::print("  --profile-allocations[=<report.csv>]\n\tCount the heap allocations, the bytes allocated and the peak of the bytes in \n\tuse per stage of the slice, and report them at the end of the slice. Needs a \n\tbuild with ENABLE_ALLOCATION_PROFILING.\n");
+    fmt::print("  --profile-threads[=<trace.json>]\n\tRecord how long the chunks of each parallel loop take and how long the threads \n\twait, and report the loops that take the most time at the end of the slice. \n\tThe trace can be opened in chrome://tracing. In a build with ENABLE_TRACING, it \n\talso shows the main stages of the slice on each thread.\n");
+    fmt::print("  --timing-report=<report.json>\n\tWrite how long each stage and each layer took, with the number of threads and \n\tthe peak memory use, to a JSON file at the end of the slice.\n");
+    fmt::print("  --capture-slow-layers=<directory>[,<seconds>]\n\tWrite the outlines and the settings of each layer whose walls take longer than \n\tthe given number of seconds (10 by default) to the directory, as test cases \n\tof the stress benchmark.\n");
+    fmt::print("  --time-limit=<seconds>\n\tStop slicing if it takes longer than this, counted from where this option is \n\tgiven. The g-code is then incomplete.\n");
+    fmt::print("\n");
+    fmt::print("CuraEngine daemon\n");
+    fmt::print("\tKeep running and slice the jobs given on the standard input, one per line. Each \n\tline holds the arguments of a slice command, with -o to set the output file. \n\tAfter each job, \"job <number> done\" is written to the standard output.\n");
     fmt::print("\n");
     fmt::print("The settings are appended to the last supplied object:\n");
     fmt::print("CuraEngine slice [general settings] \n\t-g [current group settings] \n\t-e0 [extruder train 0 settings] \n\t-l obj_inheriting_from_last_extruder_train.stl [object "
@@ -146,6 +168,8 @@ void Application::printHelp() const
     fmt::print("\n");
     fmt::print("In order to load machine definitions from custom locations, you need to create the environment variable CURA_ENGINE_SEARCH_PATH, which should contain all search "
                "paths delimited by a (semi-)colon.\n");
+    fmt::print("To load the definition files faster in the next runs, set the environment variable CURAENGINE_DEFINITION_CACHE to a directory to keep the settings resolved "
+               "from them in.\n");
     fmt::print("\n");
 }
 
@@ -219,6 +243,27 @@ void Application::slice()
     communication_ = new CommandLine(arguments);
 }
 
+void Application::daemon()
+{
+    auto* command_line = new CommandLine({});
+    command_line->readJobs(std::cin);
+    communication_ = command_line;
+}
+
+void Application::convertFiberPath() const
+{
+    if (argc_ != 4)
+    {
+        spdlog::error("Usage: CuraEngine convert-fiberpath <fiberpath.txt> <fiberpath.fpb>");
+        exit(1);
+    }
+    if (! convertFiberPathToBinary(argv_[2], argv_[3]))
+    {
+        spdlog::error("Failed to convert fiber path: {}.", argv_[2]);
+        exit(1);
+    }
+}
+
 void Application::run(const size_t argc, char** argv)
 {
     argc_ = argc;
@@ -245,10 +290,18 @@ void Application::run(const size_t argc, char** argv)
         {
             slice();
         }
+        else if (stringcasecompare(argv[1], "daemon") == 0)
+        {
+            daemon();
+        }
         else if (stringcasecompare(argv[1], "help") == 0)
         {
             printHelp();
         }
+        else if (stringcasecompare(argv[1], "convert-fiberpath") == 0)
+        {
+            convertFiberPath();
+        }
         else
         {
             spdlog::error("Unknown command: {}", argv[1]);
@@ -272,6 +325,51 @@ void Application::run(const size_t argc, char** argv)
     }
 }
 
+namespace
+{
+
+#ifdef __linux__
+constexpr size_t max_cpu_count = CPU_SETSIZE; //!< Threads can only be pinned to CPUs that fit in a cpu_set_t.
+#else
+constexpr size_t max_cpu_count = 1024;
+#endif
+
+/*!
+ * Parses a list of CPUs like "0-7,16-23".
+ * \return The CPUs, or nothing if the list is invalid or has CPUs that threads
+ * can't be pinned to.
+ */
+std::vector<size_t> parseCpuList(const std::string_view list)
+{
+    std::vector<size_t> cpus;
+    size_t range_start = 0;
+    while (range_start < list.size())
+    {
+        const size_t range_end = std::min(list.find(',', range_start), list.size());
+        const std::string_view range = list.substr(range_start, range_end - range_start);
+        const size_t dash = range.find('-');
+        const std::string_view first_str = range.substr(0, dash);
+        const std::string_view last_str = dash == std::string_view::npos ? first_str : range.substr(dash + 1);
+        size_t first;
+        size_t last;
+        const auto first_result = std::from_chars(first_str.data(), first_str.data() + first_str.size(), first);
+        const auto last_result = std::from_chars(last_str.data(), last_str.data() + last_str.size(), last);
+        if (first_result.ec != std::errc() || first_result.ptr != first_str.data() + first_str.size() || last_result.ec != std::errc()
+            || last_result.ptr != last_str.data() + last_str.size() || last < first || last >= max_cpu_count)
+        {
+            return {};
+        }
+        for (size_t cpu = first; cpu <= last; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+        range_start = range_end + 1;
+    }
+    return cpus;
+}
+
+} // namespace
+
 void Application::startThreadPool(int nworkers)
 {
     size_t nthreads;
@@ -279,13 +377,23 @@ void Application::startThreadPool(int nworkers)
     nworkers = 1;
 #endif // DEBUG  // let thread = 1 to debug parallel process
 
+    std::vector<size_t> cpus;
+    if (const auto affinity = spdlog::details::os::getenv("CURAENGINE_THREAD_AFFINITY"); ! affinity.empty())
+    {
+        cpus = parseCpuList(affinity);
+        if (cpus.empty())
+        {
+            spdlog::warn("Invalid CPU list in CURAENGINE_THREAD_AFFINITY: {}", affinity);
+        }
+    }
+
     if (nworkers <= 0)
     {
         if (thread_pool_)
         {
             return; // Keep the previous ThreadPool
         }
-        nthreads = std::thread::hardware_concurrency() - 1;
+        nthreads = (cpus.empty() ? std::thread::hardware_concurrency() : cpus.size()) - 1;
     }
     else
     {
@@ -296,7 +404,7 @@ void Application::startThreadPool(int nworkers)
         return; // Keep the previous ThreadPool
     }
     delete thread_pool_;
-    thread_pool_ = new ThreadPool(nthreads);
+    thread_pool_ = new ThreadPool(nthreads, cpus);
 }
 
 } // namespace cura
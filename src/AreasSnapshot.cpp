@@ -0,0 +1,916 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "AreasSnapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "Application.h" //To get the extruders.
+#include "ExtruderTrain.h"
+#include "LayerPlan.h" //To compute the combing boundaries of the loaded areas.
+#include "MeshGroup.h"
+#include "Slice.h"
+#include "geometry/ClosedPolyline.h"
+#include "geometry/OpenPolyline.h"
+#include "geometry/Polygon.h"
+#include "sliceDataStorage.h"
+#include "utils/ExtrusionLine.h"
+#include "utils/format/filesystem_path.h"
+
+namespace cura
+{
+
+namespace
+{
+
+constexpr char snapshot_magic[8] = { 'C', 'U', 'R', 'A', 'A', 'R', 'E', 'A' };
+
+//! The types of lines in a MixedLinesSet, as they are stored.
+enum class LineKind : uint8_t
+{
+    OPEN = 0,
+    CLOSED = 1,
+    POLYGON = 2,
+};
+
+/*!
+ * Whether a setting is only read while writing the g-code, so that changing it
+ * doesn't change the generated areas.
+ *
+ * The combing settings are among these, since the combing boundaries are
+ * computed again when a snapshot is loaded.
+ */
+bool isGcodeSetting(const std::string& key)
+{
+    constexpr std::array<std::string_view, 14> prefixes{ "speed_",
+                                                         "acceleration_",
+                                                         "jerk_",
+                                                         "cool_",
+                                                         "retraction_",
+                                                         "retract_",
+                                                         "travel_",
+                                                         "wipe_",
+                                                         "switch_extruder_",
+                                                         "machine_max_",
+                                                         "machine_start_gcode",
+                                                         "machine_end_gcode",
+                                                         "machine_extruder_start_",
+                                                         "machine_extruder_end_" };
+    return key.find("temperature") != std::string::npos
+        || std::any_of(
+               prefixes.begin(),
+               prefixes.end(),
+               [&key](const std::string_view prefix)
+               {
+                   return key.starts_with(prefix);
+               });
+}
+
+//! Add the settings that the areas are generated from to a fingerprint, in a fixed order.
+void appendSettings(std::string& fingerprint, const std::string_view scope, const Settings& settings)
+{
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (auto& [key, value] : settings.getFlattendSettings())
+    {
+        if (! isGcodeSetting(key))
+        {
+            entries.emplace_back(key, std::move(value));
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    fingerprint += fmt::format("[{}]\n", scope);
+    for (const auto& [key, value] : entries)
+    {
+        fingerprint += fmt::format("{}={}\n", key, value);
+    }
+}
+
+//! FNV-1a hash of the vertices and faces of a mesh, which would be too large to put in the fingerprint.
+uint64_t hashGeometry(const Mesh& mesh)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    const auto add = [&hash](const int64_t value)
+    {
+        for (size_t byte_idx = 0; byte_idx < sizeof(value); byte_idx++)
+        {
+            hash ^= static_cast<uint64_t>(value >> (byte_idx * 8)) & 0xFF;
+            hash *= 1099511628211ULL;
+        }
+    };
+    for (const MeshVertex& vertex : mesh.vertices_)
+    {
+        add(vertex.p_.x_);
+        add(vertex.p_.y_);
+        add(vertex.p_.z_);
+    }
+    for (const MeshFace& face : mesh.faces_)
+    {
+        for (const int vertex_idx : face.vertex_index_)
+        {
+            add(vertex_idx);
+        }
+    }
+    return hash;
+}
+
+//! Writes the fields of a snapshot one after another, in the byte order of this machine.
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter(std::ostream& out)
+        : out_(out)
+    {
+    }
+
+    template<typename T>
+    requires std::is_arithmetic_v<T>
+    void write(const T value)
+    {
+        out_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(const std::string& value)
+    {
+        write(static_cast<uint64_t>(value.size()));
+        out_.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    void write(const Point2LL& point)
+    {
+        write(point.X);
+        write(point.Y);
+    }
+
+    void write(const Point3LL& point)
+    {
+        write(point.x_);
+        write(point.y_);
+        write(point.z_);
+    }
+
+    void write(const AABB& box)
+    {
+        write(box.min_);
+        write(box.max_);
+    }
+
+    void write(const AABB3D& box)
+    {
+        write(box.min_);
+        write(box.max_);
+    }
+
+    void write(const ClipperLib::Path& path)
+    {
+        write(static_cast<uint64_t>(path.size()));
+        for (const Point2LL& point : path)
+        {
+            write(point);
+        }
+    }
+
+    template<typename LineType>
+    void write(const LinesSet<LineType>& lines)
+    {
+        write(static_cast<uint64_t>(lines.size()));
+        for (const LineType& line : lines)
+        {
+            write(line.getPoints());
+            if constexpr (std::is_base_of_v<ClosedPolyline, LineType>)
+            {
+                write(static_cast<uint8_t>(line.isExplicitelyClosed()));
+            }
+        }
+    }
+
+    void write(const MixedLinesSet& lines)
+    {
+        write(static_cast<uint64_t>(lines.size()));
+        for (const PolylinePtr& line : lines)
+        {
+            if (const auto polygon = std::dynamic_pointer_cast<Polygon>(line))
+            {
+                write(static_cast<uint8_t>(LineKind::POLYGON));
+                write(static_cast<uint8_t>(polygon->isExplicitelyClosed()));
+            }
+            else if (const auto closed = std::dynamic_pointer_cast<ClosedPolyline>(line))
+            {
+                write(static_cast<uint8_t>(LineKind::CLOSED));
+                write(static_cast<uint8_t>(closed->isExplicitelyClosed()));
+            }
+            else
+            {
+                write(static_cast<uint8_t>(LineKind::OPEN));
+            }
+            write(line->getPoints());
+        }
+    }
+
+    void write(const std::vector<VariableWidthLines>& walls)
+    {
+        write(static_cast<uint64_t>(walls.size()));
+        for (const VariableWidthLines& lines : walls)
+        {
+            write(static_cast<uint64_t>(lines.size()));
+            for (const ExtrusionLine& line : lines)
+            {
+                write(static_cast<uint64_t>(line.inset_idx_));
+                write(static_cast<uint8_t>(line.is_odd_));
+                write(static_cast<uint8_t>(line.is_closed_));
+                write(static_cast<uint64_t>(line.junctions_.size()));
+                for (const ExtrusionJunction& junction : line.junctions_)
+                {
+                    write(junction.p_);
+                    write(junction.w_);
+                    write(static_cast<uint64_t>(junction.perimeter_index_));
+                }
+                write(static_cast<uint64_t>(line.corner_angles_.size()));
+                for (const double angle : line.corner_angles_)
+                {
+                    write(angle);
+                }
+            }
+        }
+    }
+
+    void write(const std::vector<std::vector<Shape>>& areas)
+    {
+        write(static_cast<uint64_t>(areas.size()));
+        for (const std::vector<Shape>& combined_areas : areas)
+        {
+            write(combined_areas);
+        }
+    }
+
+    void write(const std::vector<Shape>& areas)
+    {
+        write(static_cast<uint64_t>(areas.size()));
+        for (const Shape& area : areas)
+        {
+            write(area);
+        }
+    }
+
+    void write(const std::vector<AngleDegrees>& angles)
+    {
+        write(static_cast<uint64_t>(angles.size()));
+        for (const AngleDegrees& angle : angles)
+        {
+            write(static_cast<double>(angle));
+        }
+    }
+
+    void writeMagic(const uint32_t version)
+    {
+        out_.write(snapshot_magic, sizeof(snapshot_magic));
+        write(version);
+    }
+
+    [[nodiscard]] bool good() const
+    {
+        return static_cast<bool>(out_);
+    }
+
+private:
+    std::ostream& out_;
+};
+
+//! Reads the fields written by the SnapshotWriter. Once anything is missing, everything reads as empty and the reader has failed.
+class SnapshotReader
+{
+public:
+    SnapshotReader(const char* data, const size_t size)
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    template<typename T>
+    requires std::is_arithmetic_v<T>
+    void read(T& value)
+    {
+        value = T{};
+        if (failed_ || size_ - position_ < sizeof(T))
+        {
+            failed_ = true;
+            return;
+        }
+        std::memcpy(&value, data_ + position_, sizeof(T));
+        position_ += sizeof(T);
+    }
+
+    template<typename T>
+    requires std::is_arithmetic_v<T>
+    [[nodiscard]] T read()
+    {
+        T value;
+        read(value);
+        return value;
+    }
+
+    void read(std::string& value)
+    {
+        const size_t size = readCount();
+        value.assign(failed_ ? data_ : data_ + position_, size);
+        position_ += size;
+    }
+
+    //! Read the size of a list, which can't be larger than the data that is left, since every element takes at least a byte.
+    [[nodiscard]] size_t readCount()
+    {
+        const uint64_t count = read<uint64_t>();
+        if (count > size_ - position_)
+        {
+            failed_ = true;
+            return 0;
+        }
+        return count;
+    }
+
+    void read(Point2LL& point)
+    {
+        read(point.X);
+        read(point.Y);
+    }
+
+    void read(Point3LL& point)
+    {
+        read(point.x_);
+        read(point.y_);
+        read(point.z_);
+    }
+
+    void read(AABB& box)
+    {
+        read(box.min_);
+        read(box.max_);
+    }
+
+    void read(AABB3D& box)
+    {
+        read(box.min_);
+        read(box.max_);
+    }
+
+    void read(ClipperLib::Path& path)
+    {
+        path.resize(readCount());
+        for (Point2LL& point : path)
+        {
+            read(point);
+        }
+    }
+
+    template<typename LineType>
+    void read(LinesSet<LineType>& lines)
+    {
+        const size_t count = readCount();
+        lines.reserve(count);
+        for (size_t line_idx = 0; line_idx < count; line_idx++)
+        {
+            ClipperLib::Path path;
+            read(path);
+            if constexpr (std::is_base_of_v<ClosedPolyline, LineType>)
+            {
+                lines.emplace_back(std::move(path), read<uint8_t>() != 0);
+            }
+            else
+            {
+                lines.emplace_back(std::move(path));
+            }
+        }
+    }
+
+    void read(MixedLinesSet& lines)
+    {
+        const size_t count = readCount();
+        lines.reserve(count);
+        for (size_t line_idx = 0; line_idx < count; line_idx++)
+        {
+            const auto kind = static_cast<LineKind>(read<uint8_t>());
+            const bool explicitely_closed = kind != LineKind::OPEN && read<uint8_t>() != 0;
+            ClipperLib::Path path;
+            read(path);
+            switch (kind)
+            {
+            case LineKind::POLYGON:
+                lines.push_back(PolylinePtr(std::make_shared<Polygon>(std::move(path), explicitely_closed)));
+                break;
+            case LineKind::CLOSED:
+                lines.push_back(PolylinePtr(std::make_shared<ClosedPolyline>(std::move(path), explicitely_closed)));
+                break;
+            case LineKind::OPEN:
+                lines.push_back(PolylinePtr(std::make_shared<OpenPolyline>(std::move(path))));
+                break;
+            default:
+                failed_ = true;
+                return;
+            }
+        }
+    }
+
+    void read(std::vector<VariableWidthLines>& walls)
+    {
+        walls.resize(readCount());
+        for (VariableWidthLines& lines : walls)
+        {
+            const size_t line_count = readCount();
+            lines.reserve(line_count);
+            for (size_t line_idx = 0; line_idx < line_count; line_idx++)
+            {
+                const auto inset_idx = read<uint64_t>();
+                const bool is_odd = read<uint8_t>() != 0;
+                const bool is_closed = read<uint8_t>() != 0;
+                ExtrusionLine& line = lines.emplace_back(inset_idx, is_odd, is_closed);
+                const size_t junction_count = readCount();
+                for (size_t junction_idx = 0; junction_idx < junction_count; junction_idx++)
+                {
+                    Point2LL position;
+                    read(position);
+                    const auto width = read<coord_t>();
+                    const auto perimeter_index = read<uint64_t>();
+                    line.junctions_.emplace_back(position, width, static_cast<coord_t>(perimeter_index));
+                }
+                line.corner_angles_.resize(readCount());
+                for (double& angle : line.corner_angles_)
+                {
+                    angle = read<double>();
+                }
+            }
+        }
+    }
+
+    void read(std::vector<std::vector<Shape>>& areas)
+    {
+        areas.resize(readCount());
+        for (std::vector<Shape>& combined_areas : areas)
+        {
+            read(combined_areas);
+        }
+    }
+
+    void read(std::vector<Shape>& areas)
+    {
+        areas.resize(readCount());
+        for (Shape& area : areas)
+        {
+            read(area);
+        }
+    }
+
+    void read(std::vector<AngleDegrees>& angles)
+    {
+        const size_t count = readCount();
+        angles.clear();
+        angles.reserve(count);
+        for (size_t angle_idx = 0; angle_idx < count; angle_idx++)
+        {
+            angles.emplace_back(read<double>());
+        }
+    }
+
+    [[nodiscard]] bool readMagic(const uint32_t version)
+    {
+        if (size_ < sizeof(snapshot_magic) || std::memcmp(data_, snapshot_magic, sizeof(snapshot_magic)) != 0)
+        {
+            failed_ = true;
+            return false;
+        }
+        position_ = sizeof(snapshot_magic);
+        return read<uint32_t>() == version && ! failed_;
+    }
+
+    [[nodiscard]] bool failed() const
+    {
+        return failed_;
+    }
+
+    [[nodiscard]] bool atEnd() const
+    {
+        return position_ == size_;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_ = 0;
+    bool failed_ = false;
+};
+
+} // namespace
+
+AreasSnapshot::AreasSnapshot(std::filesystem::path directory, const MeshGroup& mesh_group)
+    : directory_(std::move(directory))
+    , supported_(mesh_group.fiberpaths.empty()) // The fiber paths are read from files of their own, which aren't in the fingerprint.
+{
+    if (! supported_)
+    {
+        return;
+    }
+    fingerprint_ = fmt::format("{}\n", CURA_ENGINE_VERSION);
+    appendSettings(fingerprint_, "mesh group", mesh_group.settings);
+    const Scene& scene = Application::getInstance().current_slice_->scene;
+    for (const ExtruderTrain& extruder : scene.extruders)
+    {
+        appendSettings(fingerprint_, fmt::format("extruder {}", extruder.extruder_nr_), extruder.settings_);
+    }
+    for (const Mesh& mesh : mesh_group.meshes)
+    {
+        appendSettings(fingerprint_, fmt::format("mesh {}", mesh.mesh_name_), mesh.settings_);
+        fingerprint_ += fmt::format("vertices={} faces={} geometry={:016x}\n", mesh.vertices_.size(), mesh.faces_.size(), hashGeometry(mesh));
+    }
+}
+
+bool AreasSnapshot::load(SliceDataStorage& storage, MeshGroup& mesh_group) const
+{
+    if (! supported_)
+    {
+        return false;
+    }
+    const std::filesystem::path snapshot_path = snapshotPath();
+    std::error_code error;
+    if (! std::filesystem::exists(snapshot_path, error))
+    {
+        return false;
+    }
+
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+    try
+    {
+        file = boost::interprocess::file_mapping(snapshot_path.string().c_str(), boost::interprocess::read_only);
+        region = boost::interprocess::mapped_region(file, boost::interprocess::read_only);
+    }
+    catch (const boost::interprocess::interprocess_exception& exception)
+    {
+        spdlog::warn("Couldn't map the areas snapshot {}: {}", snapshot_path, exception.what());
+        return false;
+    }
+
+    SnapshotReader reader(static_cast<const char*>(region.get_address()), region.get_size());
+    std::string fingerprint;
+    if (reader.readMagic(format_version))
+    {
+        reader.read(fingerprint);
+    }
+    if (fingerprint != fingerprint_)
+    {
+        spdlog::debug("Areas snapshot {} is outdated.", snapshot_path);
+        return false;
+    }
+
+    reader.read(storage.model_size);
+    reader.read(storage.model_min);
+    reader.read(storage.model_max);
+    storage.print_layer_count = reader.read<uint64_t>();
+
+    const size_t mesh_count = reader.readCount();
+    storage.meshes.reserve(mesh_count);
+    for (size_t mesh_storage_idx = 0; mesh_storage_idx < mesh_count && ! reader.failed(); mesh_storage_idx++)
+    {
+        const auto mesh_idx = reader.read<uint64_t>();
+        const size_t layer_count = reader.readCount();
+        if (mesh_idx >= mesh_group.meshes.size())
+        {
+            break;
+        }
+        SliceMeshStorage& mesh = *storage.meshes.emplace_back(std::make_shared<SliceMeshStorage>(&mesh_group.meshes[mesh_idx], layer_count));
+        mesh.layer_nr_max_filled_layer = reader.read<LayerIndex::value_type>();
+        reader.read(mesh.infill_angles);
+        reader.read(mesh.roofing_angles);
+        reader.read(mesh.skin_angles);
+        reader.read(mesh.bounding_box);
+        for (SliceLayer& layer : mesh.layers)
+        {
+            reader.read(layer.printZ);
+            reader.read(layer.thickness);
+            layer.parts.resize(reader.readCount());
+            for (SliceLayerPart& part : layer.parts)
+            {
+                reader.read(part.boundaryBox);
+                reader.read(part.outline);
+                reader.read(part.print_outline);
+                reader.read(part.spiral_wall);
+                reader.read(part.inner_area);
+                part.skin_parts.resize(reader.readCount());
+                for (SkinPart& skin_part : part.skin_parts)
+                {
+                    reader.read(skin_part.outline);
+                    reader.read(skin_part.skin_fill);
+                    reader.read(skin_part.roofing_fill);
+                    reader.read(skin_part.top_most_surface_fill);
+                    reader.read(skin_part.bottom_most_surface_fill);
+                }
+                reader.read(part.wall_toolpaths);
+                reader.read(part.infill_wall_toolpaths);
+                reader.read(part.fiberpath);
+                reader.read(part.infill_area);
+                if (reader.read<uint8_t>() != 0)
+                {
+                    reader.read(part.infill_area_own.emplace());
+                }
+                reader.read(part.infill_area_per_combine_per_density);
+                reader.read(part.skin_above);
+            }
+            reader.read(layer.open_polylines);
+            reader.read(layer.top_surface.areas);
+            reader.read(layer.top_surface.ironed_areas);
+            reader.read(layer.top_surface.ironing_paths);
+            reader.read(layer.top_surface.ironing_polygons);
+            reader.read(layer.top_surface.ironing_lines);
+            reader.read(layer.bottom_surface);
+        }
+    }
+    if (storage.meshes.size() != mesh_count)
+    {
+        spdlog::warn("Areas snapshot {} is damaged, generating the areas instead.", snapshot_path);
+        return false;
+    }
+
+    storage.support.generated = reader.read<uint8_t>() != 0;
+    reader.read(storage.support.layer_nr_max_filled_layer);
+    reader.read(storage.support.support_infill_angles);
+    reader.read(storage.support.support_infill_angles_layer_0);
+    reader.read(storage.support.support_roof_angles);
+    reader.read(storage.support.support_bottom_angles);
+
+    reader.read(storage.raft_base_outline);
+    reader.read(storage.raft_interface_outline);
+    reader.read(storage.raft_surface_outline);
+    reader.read(storage.max_print_height_second_to_last_extruder);
+    storage.max_print_height_per_extruder.resize(reader.readCount());
+    for (int& max_print_height : storage.max_print_height_per_extruder)
+    {
+        reader.read(max_print_height);
+    }
+    storage.max_print_height_order.resize(reader.readCount());
+    for (size_t& extruder_nr : storage.max_print_height_order)
+    {
+        extruder_nr = reader.read<uint64_t>();
+    }
+    reader.read(storage.ooze_shield);
+    reader.read(storage.draft_protection_shield);
+
+    // The prime tower is made like during the generation: before the skirt and brim are added and with no support to subtract it from, since it was subtracted already.
+    if (reader.failed())
+    {
+        spdlog::warn("Areas snapshot {} is damaged, generating the areas instead.", snapshot_path);
+        return false;
+    }
+    storage.initializePrimeTower();
+
+    storage.support.supportLayers.resize(reader.readCount());
+    for (SupportLayer& support_layer : storage.support.supportLayers)
+    {
+        const size_t part_count = reader.readCount();
+        support_layer.support_infill_parts.reserve(part_count);
+        for (size_t part_idx = 0; part_idx < part_count && ! reader.failed(); part_idx++)
+        {
+            SingleShape outline;
+            reader.read(outline);
+            const auto support_line_width = reader.read<coord_t>();
+            const bool use_fractional_config = reader.read<uint8_t>() != 0;
+            const auto inset_count_to_generate = reader.read<int32_t>();
+            const auto custom_line_distance = reader.read<coord_t>();
+            SupportInfillPart& part = support_layer.support_infill_parts.emplace_back(outline, support_line_width, use_fractional_config, inset_count_to_generate, custom_line_distance);
+            reader.read(part.outline_boundary_box_);
+            reader.read(part.infill_area_per_combine_per_density_);
+            reader.read(part.wall_toolpaths_);
+        }
+        reader.read(support_layer.support_bottom);
+        reader.read(support_layer.support_roof);
+        reader.read(support_layer.support_fractional_roof);
+    }
+
+    const size_t extruder_count = reader.readCount();
+    for (size_t extruder_nr = 0; extruder_nr < extruder_count && extruder_nr < MAX_EXTRUDERS; extruder_nr++)
+    {
+        storage.skirt_brim[extruder_nr].resize(reader.readCount());
+        for (MixedLinesSet& lines : storage.skirt_brim[extruder_nr])
+        {
+            reader.read(lines);
+        }
+    }
+    reader.read(storage.support_brim);
+
+    if (reader.failed() || extruder_count > MAX_EXTRUDERS || ! reader.atEnd())
+    {
+        spdlog::warn("Areas snapshot {} is damaged, generating the areas instead.", snapshot_path);
+        return false;
+    }
+
+    // Like after slicing, the vertices of the meshes aren't needed anymore.
+    mesh_group.clear();
+    LayerPlan::precomputeCombBoundaries(storage);
+    spdlog::info("Loaded the areas from {}, only writing the g-code.", snapshot_path);
+    return true;
+}
+
+void AreasSnapshot::store(const SliceDataStorage& storage) const
+{
+    if (! supported_)
+    {
+        return;
+    }
+    if (storage.support.cross_fill_provider)
+    {
+        spdlog::debug("Not storing an areas snapshot, the cross support pattern can't be stored.");
+        return;
+    }
+    for (const std::shared_ptr<SliceMeshStorage>& mesh : storage.meshes)
+    {
+        if (mesh->base_subdiv_cube || mesh->cross_fill_provider || mesh->lightning_generator)
+        {
+            spdlog::debug("Not storing an areas snapshot, the infill pattern of mesh {} can't be stored.", mesh->mesh_name);
+            return;
+        }
+    }
+    const Scene& scene = Application::getInstance().current_slice_->scene;
+    const std::vector<Mesh>& meshes = scene.current_mesh_group->meshes;
+
+    const std::filesystem::path snapshot_path = snapshotPath();
+    const std::filesystem::path temporary_path = std::filesystem::path(snapshot_path).concat(fmt::format(".{:08x}.tmp", std::random_device{}()));
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        SnapshotWriter writer(file);
+        writer.writeMagic(format_version);
+        writer.write(fingerprint_);
+
+        writer.write(storage.model_size);
+        writer.write(storage.model_min);
+        writer.write(storage.model_max);
+        writer.write(static_cast<uint64_t>(storage.print_layer_count));
+
+        writer.write(static_cast<uint64_t>(storage.meshes.size()));
+        bool complete = true;
+        for (const std::shared_ptr<SliceMeshStorage>& mesh_ptr : storage.meshes)
+        {
+            const auto mesh = std::find_if(
+                meshes.begin(),
+                meshes.end(),
+                [&mesh_ptr](const Mesh& candidate)
+                {
+                    return &candidate.settings_ == &mesh_ptr->settings;
+                });
+            writer.write(static_cast<uint64_t>(std::distance(meshes.begin(), mesh)));
+            writer.write(static_cast<uint64_t>(mesh_ptr->layers.size()));
+            writer.write(mesh_ptr->layer_nr_max_filled_layer.value);
+            writer.write(mesh_ptr->infill_angles);
+            writer.write(mesh_ptr->roofing_angles);
+            writer.write(mesh_ptr->skin_angles);
+            writer.write(mesh_ptr->bounding_box);
+            for (const SliceLayer& layer : mesh_ptr->layers)
+            {
+                writer.write(layer.printZ);
+                writer.write(layer.thickness);
+                writer.write(static_cast<uint64_t>(layer.parts.size()));
+                for (const SliceLayerPart& part : layer.parts)
+                {
+                    writer.write(part.boundaryBox);
+                    writer.write(part.outline);
+                    writer.write(part.print_outline);
+                    writer.write(part.spiral_wall);
+                    writer.write(part.inner_area);
+                    writer.write(static_cast<uint64_t>(part.skin_parts.size()));
+                    for (const SkinPart& skin_part : part.skin_parts)
+                    {
+                        writer.write(skin_part.outline);
+                        writer.write(skin_part.skin_fill);
+                        writer.write(skin_part.roofing_fill);
+                        writer.write(skin_part.top_most_surface_fill);
+                        writer.write(skin_part.bottom_most_surface_fill);
+                    }
+                    if (part.spilled_walls)
+                    {
+                        const std::optional<std::vector<VariableWidthLines>> walls = mesh_ptr->readSpilledWalls(part);
+                        if (! walls)
+                        {
+                            complete = false;
+                            break;
+                        }
+                        writer.write(*walls);
+                    }
+                    else
+                    {
+                        writer.write(part.wall_toolpaths);
+                    }
+                    writer.write(part.infill_wall_toolpaths);
+                    writer.write(part.fiberpath);
+                    writer.write(part.infill_area);
+                    writer.write(static_cast<uint8_t>(part.infill_area_own.has_value()));
+                    if (part.infill_area_own)
+                    {
+                        writer.write(*part.infill_area_own);
+                    }
+                    writer.write(part.infill_area_per_combine_per_density);
+                    writer.write(part.skin_above);
+                }
+                writer.write(layer.open_polylines);
+                writer.write(layer.top_surface.areas);
+                writer.write(layer.top_surface.ironed_areas);
+                writer.write(layer.top_surface.ironing_paths);
+                writer.write(layer.top_surface.ironing_polygons);
+                writer.write(layer.top_surface.ironing_lines);
+                writer.write(layer.bottom_surface);
+            }
+        }
+
+        writer.write(static_cast<uint8_t>(storage.support.generated));
+        writer.write(storage.support.layer_nr_max_filled_layer);
+        writer.write(storage.support.support_infill_angles);
+        writer.write(storage.support.support_infill_angles_layer_0);
+        writer.write(storage.support.support_roof_angles);
+        writer.write(storage.support.support_bottom_angles);
+
+        writer.write(storage.raft_base_outline);
+        writer.write(storage.raft_interface_outline);
+        writer.write(storage.raft_surface_outline);
+        writer.write(storage.max_print_height_second_to_last_extruder);
+        writer.write(static_cast<uint64_t>(storage.max_print_height_per_extruder.size()));
+        for (const int max_print_height : storage.max_print_height_per_extruder)
+        {
+            writer.write(max_print_height);
+        }
+        writer.write(static_cast<uint64_t>(storage.max_print_height_order.size()));
+        for (const size_t extruder_nr : storage.max_print_height_order)
+        {
+            writer.write(static_cast<uint64_t>(extruder_nr));
+        }
+        writer.write(storage.ooze_shield);
+        writer.write(storage.draft_protection_shield);
+
+        writer.write(static_cast<uint64_t>(storage.support.supportLayers.size()));
+        for (const SupportLayer& support_layer : storage.support.supportLayers)
+        {
+            writer.write(static_cast<uint64_t>(support_layer.support_infill_parts.size()));
+            for (const SupportInfillPart& part : support_layer.support_infill_parts)
+            {
+                writer.write(part.outline_);
+                writer.write(part.support_line_width_);
+                writer.write(static_cast<uint8_t>(part.use_fractional_config_));
+                writer.write(static_cast<int32_t>(part.inset_count_to_generate_));
+                writer.write(part.custom_line_distance_);
+                writer.write(part.outline_boundary_box_);
+                writer.write(part.infill_area_per_combine_per_density_);
+                writer.write(part.wall_toolpaths_);
+            }
+            writer.write(support_layer.support_bottom);
+            writer.write(support_layer.support_roof);
+            writer.write(support_layer.support_fractional_roof);
+        }
+
+        const size_t extruder_count = scene.extruders.size();
+        writer.write(static_cast<uint64_t>(extruder_count));
+        for (size_t extruder_nr = 0; extruder_nr < extruder_count; extruder_nr++)
+        {
+            writer.write(static_cast<uint64_t>(storage.skirt_brim[extruder_nr].size()));
+            for (const MixedLinesSet& lines : storage.skirt_brim[extruder_nr])
+            {
+                writer.write(lines);
+            }
+        }
+        writer.write(storage.support_brim);
+
+        if (! complete || ! writer.good())
+        {
+            spdlog::debug("Couldn't write the areas snapshot {}.", temporary_path);
+            file.close();
+            std::filesystem::remove(temporary_path, error);
+            return;
+        }
+    }
+    // Only move the snapshot in place once it's complete, so that other processes never read half a snapshot.
+    std::filesystem::rename(temporary_path, snapshot_path, error);
+    if (error)
+    {
+        spdlog::debug("Couldn't write the areas snapshot {}: {}", snapshot_path, error.message());
+        std::filesystem::remove(temporary_path, error);
+        return;
+    }
+    spdlog::info("Stored the areas in {}.", snapshot_path);
+}
+
+std::filesystem::path AreasSnapshot::snapshotPath() const
+{
+    return directory_ / fmt::format("areas-{:016x}.snapshot", std::hash<std::string>{}(fingerprint_));
+}
+
+} // namespace cura
@@ -4,9 +4,13 @@
 #include "BeadingStrategy/BeadingStrategyFactory.h"
 
 #include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 #include <spdlog/spdlog.h>
 
+#include "BeadingStrategy/CachedBeadingStrategy.h"
 #include "BeadingStrategy/DistributedBeadingStrategy.h"
 #include "BeadingStrategy/LimitedBeadingStrategy.h"
 #include "BeadingStrategy/OuterWallInsetBeadingStrategy.h"
@@ -16,6 +20,38 @@
 namespace cura
 {
 
+namespace
+{
+//! The parameters of a strategy chain, which determine the beadings it computes.
+using StrategyParameters = std::tuple<coord_t, coord_t, coord_t, double, bool, coord_t, coord_t, double, double, coord_t, coord_t, int, double>;
+
+/*!
+ * Get the memo of beadings shared by all strategies with these parameters.
+ *
+ * Walls are generated with a separate strategy for every part in every layer,
+ * but those are all the same function for one mesh, so they can share what
+ * they computed.
+ */
+std::shared_ptr<CachedBeadingStrategy::Memo> getMemo(const StrategyParameters& parameters)
+{
+    static std::mutex mutex;
+    static std::map<StrategyParameters, std::shared_ptr<CachedBeadingStrategy::Memo>> memos;
+
+    std::lock_guard lock(mutex);
+    constexpr size_t max_memo_count = 64; // Keeps the engine from growing when it slices many different things in one session.
+    if (memos.size() >= max_memo_count && ! memos.contains(parameters))
+    {
+        memos.clear(); // Strategies still in use keep their own memo alive.
+    }
+    std::shared_ptr<CachedBeadingStrategy::Memo>& memo = memos[parameters];
+    if (! memo)
+    {
+        memo = std::make_shared<CachedBeadingStrategy::Memo>();
+    }
+    return memo;
+}
+} // namespace
+
 BeadingStrategyPtr BeadingStrategyFactory::makeStrategy(
     const coord_t preferred_bead_width_outer,
     const coord_t preferred_bead_width_inner,
@@ -57,6 +93,21 @@ BeadingStrategyPtr BeadingStrategyFactory::makeStrategy(
     // Apply the LimitedBeadingStrategy last, since that adds a 0-width marker wall which other beading strategies shouldn't touch.
     spdlog::debug("Applying the Limited Beading meta-strategy with maximum bead count = {}", max_bead_count);
     ret = make_unique<LimitedBeadingStrategy>(max_bead_count, std::move(ret));
+
+    const StrategyParameters parameters{ preferred_bead_width_outer,
+                                         preferred_bead_width_inner,
+                                         preferred_transition_length,
+                                         transitioning_angle,
+                                         print_thin_walls,
+                                         min_bead_width,
+                                         min_feature_size,
+                                         wall_split_middle_threshold,
+                                         wall_add_middle_threshold,
+                                         max_bead_count,
+                                         outer_wall_offset,
+                                         inward_distributed_center_wall_count,
+                                         minimum_variable_line_ratio };
+    ret = make_unique<CachedBeadingStrategy>(std::move(ret), getMemo(parameters));
     return ret;
 }
 } // namespace cura
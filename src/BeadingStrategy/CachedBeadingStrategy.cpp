@@ -0,0 +1,110 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "BeadingStrategy/CachedBeadingStrategy.h"
+
+#include <mutex>
+
+namespace cura
+{
+
+bool CachedBeadingStrategy::Memo::find(coord_t thickness, coord_t bead_count, Beading& beading) const
+{
+    const Key memo_key{ thickness, bead_count };
+    const Shard& memo_shard = shard(memo_key);
+    std::shared_lock lock(memo_shard.mutex);
+    const auto it = memo_shard.beadings.find(memo_key);
+    if (it == memo_shard.beadings.end())
+    {
+        return false;
+    }
+    beading = it->second;
+    return true;
+}
+
+void CachedBeadingStrategy::Memo::store(coord_t thickness, coord_t bead_count, const Beading& beading)
+{
+    const Key memo_key{ thickness, bead_count };
+    Shard& memo_shard = shard(memo_key);
+    std::unique_lock lock(memo_shard.mutex);
+    if (memo_shard.beadings.size() >= max_shard_size)
+    {
+        memo_shard.beadings.clear();
+    }
+    memo_shard.beadings.emplace(memo_key, beading);
+}
+
+size_t CachedBeadingStrategy::Memo::KeyHash::operator()(const Key& key) const
+{
+    uint64_t hash = static_cast<uint64_t>(key.thickness) * 0x9E3779B97F4A7C15ULL;
+    hash ^= static_cast<uint64_t>(key.bead_count) + 0x632BE59BD9B4E019ULL + (hash << 6) + (hash >> 2);
+    return static_cast<size_t>(hash);
+}
+
+const CachedBeadingStrategy::Memo::Shard& CachedBeadingStrategy::Memo::shard(const Key& key) const
+{
+    // Neighbouring thicknesses go to different shards, so that threads working on similar parts don't all wait for the same lock.
+    return shards_[static_cast<uint64_t>(key.thickness + key.bead_count) % shards_.size()];
+}
+
+CachedBeadingStrategy::Memo::Shard& CachedBeadingStrategy::Memo::shard(const Key& key)
+{
+    return shards_[static_cast<uint64_t>(key.thickness + key.bead_count) % shards_.size()];
+}
+
+CachedBeadingStrategy::CachedBeadingStrategy(BeadingStrategyPtr parent, std::shared_ptr<Memo> memo)
+    : BeadingStrategy(*parent)
+    , parent_(std::move(parent))
+    , memo_(std::move(memo))
+{
+    name_ = "CachedBeadingStrategy";
+}
+
+BeadingStrategy::Beading CachedBeadingStrategy::compute(coord_t thickness, coord_t bead_count) const
+{
+    Beading ret;
+    if (memo_->find(thickness, bead_count, ret))
+    {
+        return ret;
+    }
+    ret = parent_->compute(thickness, bead_count);
+    memo_->store(thickness, bead_count, ret);
+    return ret;
+}
+
+coord_t CachedBeadingStrategy::getOptimalThickness(coord_t bead_count) const
+{
+    return parent_->getOptimalThickness(bead_count);
+}
+
+coord_t CachedBeadingStrategy::getTransitionThickness(coord_t lower_bead_count) const
+{
+    return parent_->getTransitionThickness(lower_bead_count);
+}
+
+coord_t CachedBeadingStrategy::getOptimalBeadCount(coord_t thickness) const
+{
+    return parent_->getOptimalBeadCount(thickness);
+}
+
+coord_t CachedBeadingStrategy::getTransitioningLength(coord_t lower_bead_count) const
+{
+    return parent_->getTransitioningLength(lower_bead_count);
+}
+
+double CachedBeadingStrategy::getTransitionAnchorPos(coord_t lower_bead_count) const
+{
+    return parent_->getTransitionAnchorPos(lower_bead_count);
+}
+
+std::vector<coord_t> CachedBeadingStrategy::getNonlinearThicknesses(coord_t lower_bead_count) const
+{
+    return parent_->getNonlinearThicknesses(lower_bead_count);
+}
+
+std::string CachedBeadingStrategy::toString() const
+{
+    return parent_->toString();
+}
+
+} // namespace cura
@@ -0,0 +1,284 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "BinaryGCodeWriter.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace cura
+{
+
+namespace
+{
+
+//! Append a number in little-endian byte order, which the format uses throughout.
+template<typename T>
+void appendLittleEndian(std::string& out, const T value)
+{
+    for (size_t byte = 0; byte < sizeof(T); byte++)
+    {
+        out.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * byte)) & 0xFF));
+    }
+}
+
+//! Writes bits most significant bit first, as heatshrink reads them.
+class BitWriter
+{
+public:
+    explicit BitWriter(std::string& out)
+        : out_(out)
+    {
+    }
+
+    void write(const uint32_t value, const uint8_t bit_count)
+    {
+        for (int bit = bit_count - 1; bit >= 0; bit--)
+        {
+            current_ = static_cast<uint8_t>((current_ << 1) | ((value >> bit) & 1));
+            if (++current_bits_ == 8)
+            {
+                out_.push_back(static_cast<char>(current_));
+                current_ = 0;
+                current_bits_ = 0;
+            }
+        }
+    }
+
+    //! Pad the last byte with zeros. These are too few bits for another back-reference, so the decoder ignores them.
+    void flush()
+    {
+        if (current_bits_ > 0)
+        {
+            out_.push_back(static_cast<char>(current_ << (8 - current_bits_)));
+            current_ = 0;
+            current_bits_ = 0;
+        }
+    }
+
+private:
+    std::string& out_;
+    uint8_t current_ = 0;
+    uint8_t current_bits_ = 0;
+};
+
+constexpr std::array<uint32_t, 256> crc32_table = []()
+{
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+} // namespace
+
+BinaryGCodeWriter::BinaryGCodeWriter(std::ostream& target, const Compression compression)
+    : target_(target)
+    , compression_(compression)
+    , buffer_(max_block_size)
+{
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+void BinaryGCodeWriter::finish(const Metadata& printer_metadata, const Metadata& print_metadata, const Metadata& slicer_metadata)
+{
+    encodeBuffer(true);
+
+    std::string header = "GCDE";
+    appendLittleEndian<uint32_t>(header, 1); // Version of the format.
+    appendLittleEndian<uint16_t>(header, 1); // The blocks have a CRC-32 checksum.
+    target_.write(header.data(), header.size());
+
+    const auto write_metadata = [this](const BlockType type, const Metadata& metadata)
+    {
+        std::string ini;
+        for (const auto& [key, value] : metadata)
+        {
+            ini += key;
+            ini += '=';
+            ini += value;
+            ini += '\n';
+        }
+        // Metadata is small, and not every reader can decompress it, so it's left uncompressed.
+        const std::string block = encodeBlock(type, Compression::NONE, ini);
+        target_.write(block.data(), block.size());
+    };
+    write_metadata(BlockType::PRINTER_METADATA, printer_metadata);
+    write_metadata(BlockType::PRINT_METADATA, print_metadata);
+    write_metadata(BlockType::SLICER_METADATA, slicer_metadata);
+
+    target_.write(gcode_blocks_.data(), gcode_blocks_.size());
+    target_.flush();
+    gcode_blocks_.clear();
+    gcode_blocks_.shrink_to_fit();
+}
+
+std::string BinaryGCodeWriter::compressHeatshrink(const std::string_view data, const uint8_t window_bits, const uint8_t lookahead_bits)
+{
+    const size_t window_size = size_t(1) << window_bits;
+    const size_t max_match = size_t(1) << lookahead_bits;
+    constexpr size_t min_match = 3; // Shorter back-references aren't smaller than literals.
+    constexpr size_t max_candidates = 64; // Limits the time spent on finding long matches in very repetitive data.
+    constexpr size_t hash_bits = 15;
+
+    const auto hash = [&data](const size_t pos)
+    {
+        const uint32_t value = static_cast<uint8_t>(data[pos]) | (static_cast<uint8_t>(data[pos + 1]) << 8) | (static_cast<uint8_t>(data[pos + 2]) << 16);
+        return (value * 2654435761u) >> (32 - hash_bits);
+    };
+    // Chains of earlier positions with the same hash, most recent first.
+    std::vector<int64_t> head(size_t(1) << hash_bits, -1);
+    std::vector<int64_t> previous(data.size(), -1);
+    const auto insert = [&](const size_t pos)
+    {
+        if (pos + min_match <= data.size())
+        {
+            const uint32_t h = hash(pos);
+            previous[pos] = head[h];
+            head[h] = static_cast<int64_t>(pos);
+        }
+    };
+
+    std::string result;
+    result.reserve(data.size() / 2);
+    BitWriter bits(result);
+    size_t pos = 0;
+    while (pos < data.size())
+    {
+        size_t best_length = 0;
+        size_t best_distance = 0;
+        if (pos + min_match <= data.size())
+        {
+            const size_t length_limit = std::min(max_match, data.size() - pos);
+            size_t candidates = 0;
+            for (int64_t candidate = head[hash(pos)]; candidate >= 0 && pos - static_cast<size_t>(candidate) <= window_size && candidates < max_candidates;
+                 candidate = previous[candidate], candidates++)
+            {
+                size_t length = 0;
+                while (length < length_limit && data[candidate + length] == data[pos + length])
+                {
+                    length++;
+                }
+                if (length > best_length)
+                {
+                    best_length = length;
+                    best_distance = pos - static_cast<size_t>(candidate);
+                    if (length == length_limit)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (best_length >= min_match)
+        {
+            bits.write(0, 1);
+            bits.write(static_cast<uint32_t>(best_distance - 1), window_bits);
+            bits.write(static_cast<uint32_t>(best_length - 1), lookahead_bits);
+            for (size_t i = 0; i < best_length; i++)
+            {
+                insert(pos + i);
+            }
+            pos += best_length;
+        }
+        else
+        {
+            bits.write(1, 1);
+            bits.write(static_cast<uint8_t>(data[pos]), 8);
+            insert(pos);
+            pos++;
+        }
+    }
+    bits.flush();
+    return result;
+}
+
+uint32_t BinaryGCodeWriter::crc32(const std::string_view data, const uint32_t crc)
+{
+    uint32_t result = ~crc;
+    for (const char byte : data)
+    {
+        result = crc32_table[(result ^ static_cast<uint8_t>(byte)) & 0xFF] ^ (result >> 8);
+    }
+    return ~result;
+}
+
+std::string BinaryGCodeWriter::encodeBlock(const BlockType type, const Compression compression, const std::string_view data)
+{
+    assert(type != BlockType::THUMBNAIL && "Thumbnails have different block parameters.");
+
+    std::string compressed;
+    Compression used_compression = Compression::NONE;
+    if (compression == Compression::HEATSHRINK_11_4 || compression == Compression::HEATSHRINK_12_4)
+    {
+        compressed = compressHeatshrink(data, compression == Compression::HEATSHRINK_11_4 ? 11 : 12, 4);
+        if (compressed.size() < data.size())
+        {
+            used_compression = compression;
+        }
+    }
+    const std::string_view payload = used_compression == Compression::NONE ? data : std::string_view(compressed);
+
+    std::string block;
+    block.reserve(payload.size() + 20);
+    appendLittleEndian(block, static_cast<uint16_t>(type));
+    appendLittleEndian(block, static_cast<uint16_t>(used_compression));
+    appendLittleEndian(block, static_cast<uint32_t>(data.size()));
+    if (used_compression != Compression::NONE)
+    {
+        appendLittleEndian(block, static_cast<uint32_t>(payload.size()));
+    }
+    appendLittleEndian<uint16_t>(block, 0); // Encoding: INI for metadata, plain text for g-code.
+    block += payload;
+    appendLittleEndian(block, crc32(block));
+    return block;
+}
+
+BinaryGCodeWriter::int_type BinaryGCodeWriter::overflow(int_type character)
+{
+    encodeBuffer(false);
+    if (traits_type::eq_int_type(character, traits_type::eof()))
+    {
+        return traits_type::not_eof(character);
+    }
+    *pptr() = traits_type::to_char_type(character);
+    pbump(1);
+    return character;
+}
+
+void BinaryGCodeWriter::encodeBuffer(const bool all)
+{
+    char* const begin = pbase();
+    char* const end = pptr();
+    if (begin == end)
+    {
+        return;
+    }
+    char* block_end = end;
+    if (! all)
+    {
+        const auto last_line_end = std::find(std::make_reverse_iterator(end), std::make_reverse_iterator(begin), '\n');
+        if (last_line_end.base() != begin)
+        {
+            block_end = last_line_end.base();
+        }
+    }
+    gcode_blocks_ += encodeBlock(BlockType::GCODE, compression_, std::string_view(begin, block_end - begin));
+
+    // Keep the incomplete line for the next block.
+    const size_t remaining = end - block_end;
+    std::copy(block_end, end, begin);
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    pbump(static_cast<int>(remaining));
+}
+
+} // namespace cura
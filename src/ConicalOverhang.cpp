@@ -11,6 +11,7 @@
 #include "settings/types/LayerIndex.h"
 #include "slicer.h"
 #include "utils/Simplify.h" //Simplifying at every step to prevent getting lots of vertices from all the insets.
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -47,31 +48,50 @@ void ConicalOverhang::apply(Slicer* slicer, const Mesh& mesh)
 
             // Now go through all the holes in the current layer and check if they intersect anything in the layer above
             // If not, then they're the top of a hole and should be cut from the layer above before the union
-            for (unsigned int part = 0; part < layer_parts.size(); part++)
+            std::vector<const Polygon*> holes;
+            for (const SingleShape& layer_part : layer_parts)
             {
-                if (layer_parts[part].size() > 1) // first poly is the outer contour, 1..n are the holes
+                for (size_t hole_nr = 1; hole_nr < layer_part.size(); ++hole_nr) // first poly is the outer contour, 1..n are the holes
                 {
-                    for (unsigned int hole_nr = 1; hole_nr < layer_parts[part].size(); ++hole_nr)
+                    holes.push_back(&layer_part[hole_nr]);
+                }
+            }
+            // The holes don't overlap, so cutting one from the layer above doesn't change whether another is covered by it. They can all be checked at once.
+            std::vector<char> hole_is_covered(holes.size(), false); // Not a vector<bool>, since it is written from multiple threads.
+            if (max_hole_area > 0.0)
+            {
+                cura::parallel_for<size_t>(
+                    0,
+                    holes.size(),
+                    [&](const size_t hole_idx)
                     {
                         Shape hole_poly;
-                        hole_poly.push_back(layer_parts[part][hole_nr]);
-                        if (max_hole_area > 0.0 && INT2MM2(std::abs(hole_poly.area())) < max_hole_area)
+                        hole_poly.push_back(*holes[hole_idx]);
+                        if (INT2MM2(std::abs(hole_poly.area())) < max_hole_area)
                         {
                             Shape hole_with_above = hole_poly.intersection(above);
                             if (! hole_with_above.empty())
                             {
                                 // The hole had some intersection with the above layer, check if it's a complete overlap
                                 Shape hole_difference = hole_poly.xorPolygons(hole_with_above);
-                                if (hole_difference.empty())
-                                {
-                                    // The hole was returned unchanged, so the layer above must completely cover it.  Remove the hole from the layer above.
-                                    above = above.difference(hole_poly);
-                                }
+                                hole_is_covered[hole_idx] = hole_difference.empty();
                             }
                         }
-                    }
+                    });
+            }
+            Shape covered_holes;
+            for (size_t hole_idx = 0; hole_idx < holes.size(); ++hole_idx)
+            {
+                if (hole_is_covered[hole_idx])
+                {
+                    covered_holes.push_back(*holes[hole_idx]);
                 }
             }
+            if (! covered_holes.empty())
+            {
+                // The holes were returned unchanged, so the layer above must completely cover them. Remove the holes from the layer above.
+                above = above.difference(covered_holes);
+            }
             // And now union with offset of the resulting above layer
             layer.polygons_ = layer.polygons_.unionPolygons(above.offset(-max_dist_from_lower_layer));
         }
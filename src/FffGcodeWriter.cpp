@@ -4,12 +4,16 @@
 #include "FffGcodeWriter.h"
 
 #include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iostream> // The gcode goes to the standard output when no file is set.
 #include <limits> // numeric_limits
 #include <list>
 #include <memory>
 #include <numbers>
 #include <numeric>
 #include <optional>
+#include <string>
 #include <unordered_set>
 
 #include <range/v3/view/concat.hpp>
@@ -27,13 +31,17 @@
 #include "bridge.h"
 #include "communication/Communication.h" //To send layer view data.
 #include "geometry/LinesSet.h"
+#include "geometry/OffsetEngine.h"
 #include "geometry/OpenPolyline.h"
 #include "geometry/PointMatrix.h"
 #include "infill.h"
 #include "progress/Progress.h"
+#include "progress/TimingReport.h"
 #include "raft.h"
+#include "utils/ShapeLocator.h"
 #include "utils/Simplify.h" //Removing micro-segments created by offsetting.
 #include "utils/ThreadPool.h"
+#include "utils/TraceSpan.h"
 #include "utils/linearAlg2D.h"
 #include "utils/math.h"
 #include "utils/orderOptimizer.h"
@@ -70,17 +78,61 @@ std::vector<Duration> FffGcodeWriter::getTotalPrintTimePerFeature()
 
 bool FffGcodeWriter::setTargetFile(const char* filename)
 {
-    output_file.open(filename);
-    if (output_file.is_open())
+    const std::optional<CompressingStreamBuf::Format> compression = CompressingStreamBuf::formatFromFileName(filename);
+    output_file.open(filename, compression ? std::ios::out | std::ios::binary : std::ios::out);
+    if (! output_file.is_open())
+    {
+        return false;
+    }
+    if (compression)
+    {
+        compressing_buffer_ = std::make_unique<CompressingStreamBuf>(output_file, *compression);
+        compressed_output_ = std::make_unique<std::ostream>(compressing_buffer_.get());
+        gcode.setOutputStream(compressed_output_.get());
+    }
+    else
     {
         gcode.setOutputStream(&output_file);
-        return true;
     }
-    return false;
+    return true;
+}
+
+void FffGcodeWriter::closeTargetFile()
+{
+    if (! output_file.is_open())
+    {
+        return;
+    }
+    gcode.setOutputStream(&std::cout);
+    compressed_output_.reset();
+    compressing_buffer_.reset();
+    output_file.close();
+}
+
+/*!
+ * Get an optional setting that tunes how layers are passed from planning to
+ * writing, from the mesh group or else from the command line.
+ * \param key The setting to get.
+ * \param default_value The value to use if the setting isn't given.
+ */
+static size_t getLayerPipelineSetting(const std::string& key, const size_t default_value)
+{
+    const Scene& scene = Application::getInstance().current_slice_->scene;
+    for (const Settings* settings : std::initializer_list<const Settings*>{ &scene.current_mesh_group->settings, &scene.settings })
+    {
+        if (settings->has(key))
+        {
+            return settings->get<size_t>(key);
+        }
+    }
+    return default_value;
 }
 
 void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keeper)
 {
+    // The extruder use is asked for every layer many times while planning, so find it once.
+    storage.cacheExtrudersUsed();
+
     const size_t start_extruder_nr = getStartExtruder(storage);
     gcode.preSetup(start_extruder_nr);
     gcode.setSliceUUID(slice_uuid);
@@ -94,6 +146,8 @@ void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keep
 
     Application::getInstance().communication_->beginGCode();
 
+    layer_plan_buffer.setBufferSize(getLayerPipelineSetting("layer_plan_buffer_size", LayerPlanBuffer::default_buffer_size_));
+
     setConfigFanSpeedLayerTime();
 
     setConfigRetractionAndWipe(storage);
@@ -156,6 +210,12 @@ void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keep
     calculateExtruderOrderPerLayer(storage);
     calculatePrimeLayerPerExtruder(storage);
 
+    {
+        const Settings& mesh_group_settings = scene.current_mesh_group->settings;
+        const LayerIndex first_invariant_layer = std::max(LayerIndex(1), LayerIndex(mesh_group_settings.get<size_t>("speed_slowdown_layers")));
+        layer_invariant_configs_.emplace(storage, first_invariant_layer, mesh_group_settings.get<coord_t>("layer_height"));
+    }
+
     if (scene.current_mesh_group->settings.get<bool>("magic_spiralize"))
     {
         findLayerSeamsForSpiralize(storage, total_layers);
@@ -178,19 +238,72 @@ void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keep
         }
     }
 
+    { // Planning a layer takes about as long as it has vertices, so report the export progress by those.
+        std::vector<double> workload_per_layer;
+        workload_per_layer.reserve(total_layers - process_layer_starting_layer_nr);
+        for (int layer_nr = process_layer_starting_layer_nr; layer_nr < static_cast<int>(total_layers); layer_nr++)
+        {
+            double workload = 1.0; // Even an empty layer takes a bit of time.
+            if (layer_nr >= 0)
+            {
+                for (const std::shared_ptr<SliceMeshStorage>& mesh : storage.meshes)
+                {
+                    if (static_cast<size_t>(layer_nr) < mesh->layers.size())
+                    {
+                        for (const SliceLayerPart& part : mesh->layers[layer_nr].parts)
+                        {
+                            workload += part.outline.pointCount();
+                        }
+                    }
+                }
+                if (static_cast<size_t>(layer_nr) < storage.support.supportLayers.size())
+                {
+                    const SupportLayer& support_layer = storage.support.supportLayers[layer_nr];
+                    workload += support_layer.support_roof.pointCount() + support_layer.support_bottom.pointCount();
+                    for (const SupportInfillPart& part : support_layer.support_infill_parts)
+                    {
+                        workload += part.outline_.pointCount();
+                    }
+                }
+            }
+            workload_per_layer.push_back(workload);
+        }
+        Progress::setExportWorkload(LayerIndex(process_layer_starting_layer_nr), workload_per_layer);
+    }
+
+    // Layer plans that are produced but not written yet can take a lot of memory with many threads, so their number and size can be limited.
+    const size_t max_pending_per_worker = std::max(size_t(1), getLayerPipelineSetting("layer_plan_max_pending_per_worker", 8));
+    const size_t max_pending_bytes = getLayerPipelineSetting("layer_plan_max_pending_mb", 0) * 1024 * 1024;
+    std::function<size_t(const std::optional<ProcessLayerResult>&)> layer_plan_bytes = nullptr;
+    if (max_pending_bytes > 0)
+    {
+        layer_plan_bytes = [](const std::optional<ProcessLayerResult>& result)
+        {
+            return result->layer_plan->estimateMemoryUsage();
+        };
+    }
     run_multiple_producers_ordered_consumer(
         process_layer_starting_layer_nr,
         total_layers,
         [&storage, total_layers, this](int layer_nr)
         {
+            storage.restoreSpilledLayer(layer_nr);
             return std::make_optional(processLayer(storage, layer_nr, total_layers));
         },
-        [this, total_layers](std::optional<ProcessLayerResult> result_opt)
+        [&storage, this, total_layers](std::optional<ProcessLayerResult> result_opt)
         {
             const ProcessLayerResult& result = result_opt.value();
-            Progress::messageProgressLayer(result.layer_plan->getLayerNr(), total_layers, result.total_elapsed_time, result.stages_times);
+            const LayerIndex layer_nr = result.layer_plan->getLayerNr();
+            Progress::messageProgressLayer(layer_nr, total_layers, result.total_elapsed_time, result.stages_times);
+            TimingReport::getInstance().recordLayer(layer_nr, result.layer_plan->z_, result.layer_thickness, result.part_count, result.total_elapsed_time, result.stages_times);
             layer_plan_buffer.handle(*result.layer_plan, gcode);
-        });
+            // The layers that are still being planned read the infill of the layer below them to detect bridges, and the skin of the layers above them.
+            // So only the layer below this one is not needed anymore.
+            storage.releasePlannedLayer(layer_nr - 1);
+        },
+        max_pending_per_worker,
+        std::move(layer_plan_bytes),
+        max_pending_bytes);
 
     layer_plan_buffer.flush();
 
@@ -204,7 +317,12 @@ void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keep
     gcode.writeRetraction(storage.retraction_wipe_config_per_extruder[gcode.getExtruderNr()].retraction_config, force); // retract after finishing each meshgroup
 }
 
-unsigned int FffGcodeWriter::findSpiralizedLayerSeamVertexIndex(const SliceDataStorage& storage, const SliceMeshStorage& mesh, const int layer_nr, const int last_layer_nr)
+unsigned int FffGcodeWriter::findSpiralizedLayerSeamVertexIndex(
+    const SliceDataStorage& storage,
+    const SliceMeshStorage& mesh,
+    const int layer_nr,
+    const int last_layer_nr,
+    const ShapeLocator& wall_locator)
 {
     const SliceLayer& layer = mesh.layers[layer_nr];
 
@@ -236,7 +354,7 @@ unsigned int FffGcodeWriter::findSpiralizedLayerSeamVertexIndex(const SliceDataS
         // seam_vertex_idx is going to be the index of the seam vertex in the current wall polygon
         // initially we choose the vertex that is closest to the seam vertex in the last spiralized layer processed
 
-        int seam_vertex_idx = PolygonUtils::findNearestVert(last_wall_seam_vertex, wall);
+        int seam_vertex_idx = wall_locator.findNearestVert(last_wall_seam_vertex).point_idx_;
 
         // now we check that the vertex following the seam vertex is to the left of the seam vertex in the last layer
         // and if it isn't, we move forward
@@ -273,41 +391,62 @@ void FffGcodeWriter::findLayerSeamsForSpiralize(SliceDataStorage& storage, size_
     storage.spiralize_wall_outlines.assign(total_layers, nullptr); // default is no information available
     storage.spiralize_seam_vertex_indices.assign(total_layers, 0);
 
-    int last_layer_nr = -1; // layer number of the last non-empty layer processed (for any extruder or mesh)
-
-    for (unsigned layer_nr = 0; layer_nr < total_layers; ++layer_nr)
+    // What can be found for a layer without knowing the seam of the layer below.
+    struct SpiralizedLayer
     {
-        bool done_this_layer = false;
+        size_t layer_nr;
+        SliceMeshStorage* mesh = nullptr; //!< The mesh of which the first part of this layer is spiralized, if any.
+        Shape wall; //!< The polygon of the spiral wall of that part that the seam is placed on.
+        std::optional<ShapeLocator> wall_locator; //!< To find the vertex of the wall closest to the seam of the layer below.
+    };
 
-        // iterate through extruders until we find a mesh that has a part with insets
-        const std::vector<ExtruderUse> extruder_order = extruder_order_per_layer.get(layer_nr);
-        for (unsigned int extruder_idx = 0; ! done_this_layer && extruder_idx < extruder_order.size(); ++extruder_idx)
+    int last_layer_nr = -1; // layer number of the last non-empty layer processed (for any extruder or mesh)
+
+    // Only chaining the seams needs to go from the bottom up. Finding the spiralized walls of the layers and preparing the search for their vertices is done in
+    // parallel.
+    run_multiple_producers_ordered_consumer(
+        0,
+        total_layers,
+        [&](const size_t layer_nr)
         {
-            const size_t extruder_nr = extruder_order[extruder_idx].extruder_nr;
-            // iterate through this extruder's meshes until we find a part with insets
-            const std::vector<size_t>& mesh_order = mesh_order_per_extruder[extruder_nr];
-            for (unsigned int mesh_idx : mesh_order)
+            auto spiralized = std::make_unique<SpiralizedLayer>();
+            spiralized->layer_nr = layer_nr;
+
+            // iterate through extruders until we find a mesh that has a part with insets
+            const std::vector<ExtruderUse> extruder_order = extruder_order_per_layer.get(layer_nr);
+            for (unsigned int extruder_idx = 0; ! spiralized->mesh && extruder_idx < extruder_order.size(); ++extruder_idx)
             {
-                SliceMeshStorage& mesh = *storage.meshes[mesh_idx];
-                // if this mesh has layer data for this layer process it
-                if (! done_this_layer && mesh.layers.size() > layer_nr)
+                const size_t extruder_nr = extruder_order[extruder_idx].extruder_nr;
+                // iterate through this extruder's meshes until we find a part with insets
+                const std::vector<size_t>& mesh_order = mesh_order_per_extruder[extruder_nr];
+                for (unsigned int mesh_idx : mesh_order)
                 {
-                    SliceLayer& layer = mesh.layers[layer_nr];
-                    // if the first part in the layer (if any) has insets, process it
-                    if (! layer.parts.empty() && ! layer.parts[0].spiral_wall.empty())
+                    SliceMeshStorage& mesh = *storage.meshes[mesh_idx];
+                    // if this mesh has layer data for this layer and the first part in the layer (if any) has insets, process it
+                    if (! spiralized->mesh && mesh.layers.size() > layer_nr && ! mesh.layers[layer_nr].parts.empty()
+                        && ! mesh.layers[layer_nr].parts[0].spiral_wall.empty())
                     {
-                        // save the seam vertex index for this layer as we need it to determine the seam vertex index for the next layer
-                        storage.spiralize_seam_vertex_indices[layer_nr] = findSpiralizedLayerSeamVertexIndex(storage, mesh, layer_nr, last_layer_nr);
-                        // save the wall outline for this layer so it can be used in the spiralize interpolation calculation
-                        storage.spiralize_wall_outlines[layer_nr] = &layer.parts[0].spiral_wall;
-                        last_layer_nr = layer_nr;
-                        // ignore any further meshes/extruders for this layer
-                        done_this_layer = true;
+                        spiralized->mesh = &mesh;
+                        spiralized->wall.push_back(mesh.layers[layer_nr].parts[0].spiral_wall[0]);
+                        spiralized->wall_locator.emplace(spiralized->wall, mesh.settings.get<coord_t>("wall_line_width_0"));
                     }
                 }
             }
-        }
-    }
+            return spiralized;
+        },
+        [&](std::unique_ptr<SpiralizedLayer> spiralized)
+        {
+            if (! spiralized->mesh)
+            {
+                return;
+            }
+            const size_t layer_nr = spiralized->layer_nr;
+            // save the seam vertex index for this layer as we need it to determine the seam vertex index for the next layer
+            storage.spiralize_seam_vertex_indices[layer_nr] = findSpiralizedLayerSeamVertexIndex(storage, *spiralized->mesh, layer_nr, last_layer_nr, *spiralized->wall_locator);
+            // save the wall outline for this layer so it can be used in the spiralize interpolation calculation
+            storage.spiralize_wall_outlines[layer_nr] = &spiralized->mesh->layers[layer_nr].parts[0].spiral_wall;
+            last_layer_nr = layer_nr;
+        });
 }
 
 void FffGcodeWriter::setConfigFanSpeedLayerTime()
@@ -1123,6 +1262,7 @@ void FffGcodeWriter::endRaftLayer(const SliceDataStorage& storage, LayerPlan& gc
 
 FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataStorage& storage, LayerIndex layer_nr, const size_t total_layers) const
 {
+    CURA_TRACE_SPAN("FffGcodeWriter::processLayer");
     spdlog::debug("GcodeWriter processing layer {} of {}", layer_nr, total_layers);
     TimeKeeper time_keeper;
     spdlog::stopwatch timer_total;
@@ -1208,7 +1348,8 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
         fan_speed_layer_time_settings_per_extruder,
         comb_offset_from_outlines,
         first_outer_wall_line_width,
-        avoid_distance);
+        avoid_distance,
+        PathConfigStorage::isLayerInvariant(layer_nr) ? &*layer_invariant_configs_ : nullptr);
     time_keeper.registerTime("Init");
 
     if (include_helper_parts)
@@ -1276,7 +1417,25 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
     gcode_layer.applyBackPressureCompensation();
     time_keeper.registerTime("Back pressure comp.");
 
-    return { &gcode_layer, timer_total.elapsed().count(), time_keeper.getRegisteredTimes() };
+    gcode_layer.planCoasting();
+    time_keeper.registerTime("Coasting");
+
+    gcode_layer.precomputeNaiveTimeEstimates();
+    time_keeper.registerTime("Time estimates");
+
+    size_t part_count = 0;
+    if (layer_nr >= 0)
+    {
+        for (const std::shared_ptr<SliceMeshStorage>& mesh : storage.meshes)
+        {
+            if (layer_nr < static_cast<int>(mesh->layers.size()))
+            {
+                part_count += mesh->layers[layer_nr].parts.size();
+            }
+        }
+    }
+
+    return { &gcode_layer, timer_total.elapsed().count(), time_keeper.getRegisteredTimes(), layer_thickness, part_count };
 }
 
 bool FffGcodeWriter::getExtruderNeedPrimeBlobDuringFirstLayer(const SliceDataStorage& storage, const size_t extruder_nr) const
@@ -1823,6 +1982,8 @@ void FffGcodeWriter::addMeshPartToGCode(
 
     added_something = added_something | processSkin(storage, gcode_layer, mesh, extruder_nr, mesh_config, part);
 
+    added_something = added_something | processFiberPaths(gcode_layer, mesh, extruder_nr, mesh_config, part);
+
     // After a layer part, make sure the nozzle is inside the comb boundary, so we do not retract on the perimeter.
     if (added_something
         && (! mesh_group_settings.get<bool>("magic_spiralize") || gcode_layer.getLayerNr() < static_cast<LayerIndex>(mesh.settings.get<size_t>("initial_bottom_layers"))))
@@ -1838,6 +1999,23 @@ void FffGcodeWriter::addMeshPartToGCode(
     gcode_layer.setIsInside(false);
 }
 
+bool FffGcodeWriter::processFiberPaths(
+    LayerPlan& gcode_layer,
+    const SliceMeshStorage& mesh,
+    const size_t extruder_nr,
+    const MeshPathConfigs& mesh_config,
+    const SliceLayerPart& part) const
+{
+    if (part.fiberpath.empty() || extruder_nr != mesh.settings.get<ExtruderTrain&>("wall_0_extruder_nr").extruder_nr_)
+    {
+        return false;
+    }
+    // The fibers are continuous, so order them with travel optimization to minimize the (combed) moves between them.
+    constexpr bool enable_travel_optimization = true;
+    gcode_layer.addLinesByOptimizer(part.fiberpath, mesh_config.fiber_config, SpaceFillType::PolyLines, enable_travel_optimization);
+    return true;
+}
+
 bool FffGcodeWriter::processInfill(
     const SliceDataStorage& storage,
     LayerPlan& gcode_layer,
@@ -2050,7 +2228,7 @@ bool FffGcodeWriter::processSingleLayerInfill(
     // boundary edge
     Shape infill_below_skin;
     Shape infill_not_below_skin;
-    const bool hasSkinEdgeSupport = partitionInfillBySkinAbove(infill_below_skin, infill_not_below_skin, gcode_layer, mesh, part, infill_line_width);
+    const bool hasSkinEdgeSupport = partitionInfillBySkinAbove(infill_below_skin, infill_not_below_skin, mesh, part, infill_line_width);
 
     const auto pocket_size = mesh.settings.get<coord_t>("cross_infill_pocket_size");
     constexpr bool skip_stitching = false;
@@ -2351,97 +2529,16 @@ bool FffGcodeWriter::processSingleLayerInfill(
 bool FffGcodeWriter::partitionInfillBySkinAbove(
     Shape& infill_below_skin,
     Shape& infill_not_below_skin,
-    const LayerPlan& gcode_layer,
     const SliceMeshStorage& mesh,
     const SliceLayerPart& part,
     coord_t infill_line_width)
 {
     constexpr coord_t tiny_infill_offset = 20;
-    const auto skin_edge_support_layers = mesh.settings.get<size_t>("skin_edge_support_layers");
-    Shape skin_above_combined; // skin regions on the layers above combined with small gaps between
-
-    // working from the highest layer downwards, combine the regions of skin on all the layers
-    // but don't let the regions merge together
-    // otherwise "terraced" skin regions on separate layers will look like a single region of unbroken skin
-    for (size_t i = skin_edge_support_layers; i > 0; --i)
+    if (mesh.settings.get<size_t>("skin_edge_support_layers") > 0)
     {
-        const size_t skin_layer_nr = gcode_layer.getLayerNr() + i;
-        if (skin_layer_nr < mesh.layers.size())
-        {
-            for (const SliceLayerPart& part_i : mesh.layers[skin_layer_nr].parts)
-            {
-                for (const SkinPart& skin_part : part_i.skin_parts)
-                {
-                    // Limit considered areas to the ones that should have infill underneath at the current layer.
-                    const Shape relevant_outline = skin_part.outline.intersection(part.getOwnInfillArea());
-
-                    if (! skin_above_combined.empty())
-                    {
-                        // does this skin part overlap with any of the skin parts on the layers above?
-                        const Shape overlap = skin_above_combined.intersection(relevant_outline);
-                        if (! overlap.empty())
-                        {
-                            // yes, it overlaps, need to leave a gap between this skin part and the others
-                            if (i > 1) // this layer is the 2nd or higher layer above the layer whose infill we're printing
-                            {
-                                // looking from the side, if the combined regions so far look like this...
-                                //
-                                //     ----------------------------------
-                                //
-                                // and the new skin part looks like this...
-                                //
-                                //             -------------------------------------
-                                //
-                                // the result should be like this...
-                                //
-                                //     ------- -------------------------- ----------
-
-                                // expand the overlap region slightly to make a small gap
-                                const Shape overlap_expanded = overlap.offset(tiny_infill_offset);
-                                // subtract the expanded overlap region from the regions accumulated from higher layers
-                                skin_above_combined = skin_above_combined.difference(overlap_expanded);
-                                // subtract the expanded overlap region from this skin part and add the remainder to the overlap region
-                                skin_above_combined.push_back(relevant_outline.difference(overlap_expanded));
-                                // and add the overlap area as well
-                                skin_above_combined.push_back(overlap);
-                            }
-                            else // this layer is the 1st layer above the layer whose infill we're printing
-                            {
-                                // add this layer's skin region without subtracting the overlap but still make a gap between this skin region and what has been accumulated so
-                                // far we do this so that these skin region edges will definitely have infill walls below them
-
-                                // looking from the side, if the combined regions so far look like this...
-                                //
-                                //     ----------------------------------
-                                //
-                                // and the new skin part looks like this...
-                                //
-                                //             -------------------------------------
-                                //
-                                // the result should be like this...
-                                //
-                                //     ------- -------------------------------------
-
-                                skin_above_combined = skin_above_combined.difference(relevant_outline.offset(tiny_infill_offset));
-                                skin_above_combined.push_back(relevant_outline);
-                            }
-                        }
-                        else // no overlap
-                        {
-                            skin_above_combined.push_back(relevant_outline);
-                        }
-                    }
-                    else // this is the first skin region we have looked at
-                    {
-                        skin_above_combined.push_back(relevant_outline);
-                    }
-                }
-            }
-        }
-
         // the shrink/expand here is to remove regions of infill below skin that are narrower than the width of the infill walls otherwise the infill walls could merge and form
         // a bump
-        infill_below_skin = skin_above_combined.intersection(part.infill_area_per_combine_per_density.back().front()).offset(-infill_line_width).offset(infill_line_width);
+        infill_below_skin = part.skin_above.intersection(part.infill_area_per_combine_per_density.back().front()).offset(-infill_line_width).offset(infill_line_width);
 
         constexpr bool remove_small_holes_from_infill_below_skin = true;
         constexpr double min_area_multiplier = 25;
@@ -2654,6 +2751,7 @@ bool FffGcodeWriter::processInsets(
             gcode_layer.setBridgeWallMask(Shape());
         }
 
+        OffsetEngine outlines_below_offsetter(outlines_below); // The wall and seam overhang masks expand the same outlines.
         const auto get_overhang_region = [&](const AngleDegrees overhang_angle) -> Shape
         {
             if (overhang_angle >= 90)
@@ -2665,7 +2763,7 @@ bool FffGcodeWriter::processInsets(
             // expanded to take into account the overhang angle, the greater the overhang angle, the larger the supported area is
             // considered to be
             const coord_t overhang_width = layer_height * std::tan(overhang_angle / (180 / std::numbers::pi));
-            return part.outline.offset(-half_outer_wall_width).difference(outlines_below.offset(10 + overhang_width - half_outer_wall_width)).offset(10);
+            return part.outline.offset(-half_outer_wall_width).difference(outlines_below_offsetter.offset(10 + overhang_width - half_outer_wall_width)).offset(10);
         };
         gcode_layer.setOverhangMask(get_overhang_region(mesh.settings.get<AngleDegrees>("wall_overhang_angle")));
         gcode_layer.setSeamOverhangMask(get_overhang_region(mesh.settings.get<AngleDegrees>("seam_overhang_angle")));
@@ -4033,6 +4131,22 @@ void FffGcodeWriter::finalize()
     gcode.writeComment("Cura profile string:");
     gcode.writeComment(FffProcessor::getInstance()->getAllLocalSettingsString() + FffProcessor::getInstance()->getProfileString());
     */
+
+    if (compressing_buffer_ && Application::getInstance().communication_->isSequential())
+    {
+        // The header at the start was written before the print time and material use were known, and a compressed file can't be patched afterwards.
+        // So repeat the header with the final values at the end.
+        gcode.writeComment("FINAL_HEADER");
+        gcode.writeCode(prefix.substr(0, prefix.find_last_not_of("\r\n") + 1).c_str());
+    }
+
+    gcode.finishBinaryOutput();
+
+    if (compressing_buffer_)
+    {
+        compressed_output_->flush();
+        compressing_buffer_->close();
+    }
 }
 
 
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <fstream> // ifstream.good()
 #include <map> // multimap (ordered map allowing duplicate keys)
 #include <numeric>
@@ -17,6 +18,7 @@
 #include "FffPolygonGenerator.h"
 #include "infill.h"
 #include "InterlockingGenerator.h"
+#include "LayerPlan.h"
 #include "layerPart.h"
 #include "MeshGroup.h"
 #include "Mold.h"
@@ -24,6 +26,7 @@
 #include "PrintFeature.h"
 #include "raft.h"
 #include "skin.h"
+#include "SkinOutlineCache.h"
 #include "SkirtBrim.h"
 #include "Slice.h"
 #include "sliceDataStorage.h"
@@ -42,11 +45,14 @@
 #include "progress/ProgressEstimator.h"
 #include "progress/ProgressEstimatorLinear.h"
 #include "progress/ProgressStageEstimator.h"
+#include "progress/SlowLayerCapture.h"
+#include "progress/TimingReport.h"
 #include "settings/AdaptiveLayerHeights.h"
 #include "settings/types/Angle.h"
 #include "settings/types/LayerIndex.h"
 #include "utils/algorithm.h"
 #include "utils/ThreadPool.h"
+#include "utils/TraceSpan.h"
 #include "utils/gettime.h"
 #include "utils/math.h"
 #include "PrimeTower/PrimeTower.h"
@@ -57,6 +63,35 @@
 namespace cura
 {
 
+namespace
+{
+
+/*!
+ * Log how much memory the slice data takes per member, and add it to the
+ * timing report, at the end of a stage. This walks over all of the slice data,
+ * so it's skipped unless anyone is going to see it.
+ */
+void reportFootprint(const SliceDataStorage& storage, const std::string_view stage)
+{
+    if (! TimingReport::getInstance().isEnabled() && ! spdlog::should_log(spdlog::level::debug))
+    {
+        return;
+    }
+    const std::vector<StorageFootprint> footprints = storage.memoryReport();
+    size_t total_bytes = 0;
+    for (const StorageFootprint& footprint : footprints)
+    {
+        total_bytes += footprint.bytes;
+        TimingReport::getInstance().recordFootprint(footprint.field, footprint.points, footprint.bytes);
+    }
+    spdlog::debug("Slice data after {}: {:.1f} MiB", stage, static_cast<double>(total_bytes) / (1024.0 * 1024.0));
+    for (const StorageFootprint& footprint : footprints)
+    {
+        spdlog::debug("  {}: {} points, {:.1f} MiB", footprint.field, footprint.points, static_cast<double>(footprint.bytes) / (1024.0 * 1024.0));
+    }
+}
+
+} // namespace
 
 bool FffPolygonGenerator::generateAreas(SliceDataStorage& storage, MeshGroup* meshgroup, TimeKeeper& timeKeeper)
 {
@@ -322,11 +357,6 @@ bool FffPolygonGenerator::sliceModel(MeshGroup* meshgroup, TimeKeeper& timeKeepe
                     meshStorage.layers[layer_nr].thickness = layer_thickness;
                 }
             }
-            for (FiberPaths& paths : meshgroup->fiberpaths)
-            {
-                insertFiberPath(meshStorage, paths);
-            }
-            
             // add the raft offset to each layer
             if (has_raft)
             {
@@ -341,6 +371,12 @@ bool FffPolygonGenerator::sliceModel(MeshGroup* meshgroup, TimeKeeper& timeKeepe
             }
         }
 
+        // printZ is final now, so the fiber layers can be matched to the slice layers in a single pass.
+        for (const std::shared_ptr<FiberPaths>& paths : meshgroup->fiberpaths)
+        {
+            insertFiberPath(meshStorage, *paths);
+        }
+
         delete slicerList[meshIdx];
 
         Progress::messageProgress(Progress::Stage::PARTS, meshIdx + 1, slicerList.size());
@@ -370,6 +406,20 @@ void FffPolygonGenerator::slices2polygons(SliceDataStorage& storage, TimeKeeper&
     }
     ProgressStageEstimator inset_skin_progress_estimate(mesh_timings);
 
+    // For prints with very many layers, the walls can be moved to disk once they're generated, until the g-code is written.
+    if (const auto spill_directory = spdlog::details::os::getenv("CURAENGINE_SPILL_DIRECTORY"); ! spill_directory.empty())
+    {
+        auto wall_spill = std::make_shared<SpillFile>(spill_directory);
+        if (wall_spill->isOpen())
+        {
+            for (std::shared_ptr<SliceMeshStorage>& mesh : storage.meshes)
+            {
+                mesh->wall_spill = wall_spill;
+            }
+        }
+    }
+
+    reportFootprint(storage, "layerparts");
     Progress::messageProgressStage(Progress::Stage::INSET_SKIN, &time_keeper);
     std::vector<size_t> mesh_order;
     { // compute mesh order
@@ -408,12 +458,14 @@ void FffPolygonGenerator::slices2polygons(SliceDataStorage& storage, TimeKeeper&
         return;
     }
 
+    reportFootprint(storage, "inset+skin");
     Progress::messageProgressStage(Progress::Stage::SUPPORT, &time_keeper);
 
     AreaSupport::generateOverhangAreas(storage);
     AreaSupport::generateSupportAreas(storage);
     TreeSupport tree_support_generator(storage);
     tree_support_generator.generateSupportAreas(storage);
+    storage.releaseSupportInputs();
 
     computePrintHeightStatistics(storage);
 
@@ -444,6 +496,11 @@ void FffPolygonGenerator::slices2polygons(SliceDataStorage& storage, TimeKeeper&
     spdlog::debug("Processing gradual support");
     // generate gradual support
     AreaSupport::generateSupportInfillFeatures(storage);
+
+    spdlog::debug("Precomputing combing boundaries");
+    LayerPlan::precomputeCombBoundaries(storage);
+
+    reportFootprint(storage, "support");
 }
 
 void FffPolygonGenerator::processBasicWallsSkinInfill(
@@ -460,15 +517,9 @@ void FffPolygonGenerator::processBasicWallsSkinInfill(
         processInfillMesh(storage, mesh_order_idx, mesh_order);
     }
 
-    // TODO: make progress more accurate!!
-    // note: estimated time for     insets : skins = 22.953 : 48.858
-    std::vector<double> walls_vs_skin_timing({ 22.953, 48.858 });
-    ProgressStageEstimator* mesh_inset_skin_progress_estimator = new ProgressStageEstimator(walls_vs_skin_timing);
-
-    inset_skin_progress_estimate.nextStage(mesh_inset_skin_progress_estimator); // the stage of this function call
-
-    ProgressEstimatorLinear* inset_estimator = new ProgressEstimatorLinear(mesh_layer_count);
-    mesh_inset_skin_progress_estimator->nextStage(inset_estimator);
+    // The walls and the skins of each layer take one step each, since they are processed together.
+    ProgressEstimatorLinear* inset_skin_estimator = new ProgressEstimatorLinear(2 * mesh_layer_count);
+    inset_skin_progress_estimate.nextStage(inset_skin_estimator); // the stage of this function call
 
     struct
     {
@@ -490,26 +541,8 @@ void FffPolygonGenerator::processBasicWallsSkinInfill(
                 processed_layer_count.fetch_add(1, std::memory_order_release);
             }
         }
-        void reset()
-        {
-            processed_layer_count.store(0, std::memory_order_relaxed);
-        }
     } guarded_progress = { inset_skin_progress_estimate };
 
-    // walls
-    cura::parallel_for<size_t>(
-        0,
-        mesh_layer_count,
-        [&](size_t layer_number)
-        {
-            spdlog::debug("Processing insets for layer {} of {}", layer_number, mesh.layers.size());
-            processWalls(mesh, layer_number);
-            guarded_progress++;
-        });
-
-    ProgressEstimatorLinear* skin_estimator = new ProgressEstimatorLinear(mesh_layer_count);
-    mesh_inset_skin_progress_estimator->nextStage(skin_estimator);
-
     bool process_infill = mesh.settings.get<coord_t>("infill_line_distance") > 0;
     if (! process_infill)
     { // do process infill anyway if it's modified by modifier meshes
@@ -530,7 +563,6 @@ void FffPolygonGenerator::processBasicWallsSkinInfill(
         }
     }
 
-    // skin & infill
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     bool magic_spiralize = mesh_group_settings.get<bool>("magic_spiralize");
     size_t mesh_max_initial_bottom_layer_count = 0;
@@ -539,18 +571,47 @@ void FffPolygonGenerator::processBasicWallsSkinInfill(
         mesh_max_initial_bottom_layer_count = std::max(mesh_max_initial_bottom_layer_count, mesh.settings.get<size_t>("initial_bottom_layers"));
     }
 
-    guarded_progress.reset();
+    // The skins and infill of a layer are computed from the outlines of the layers around it, which the walls simplify. Rather than waiting
+    // for the walls of all layers, the skins of a layer are processed right after the walls of the last of those layers are done.
+    // Nothing waits for anything, so nested parallel loops in the walls can't deadlock on this.
+    const size_t layers_below = std::max(mesh.settings.get<size_t>("bottom_layers"), size_t(1)); // Bottom skin, and the air below the top-most skin.
+    const size_t layers_above = std::max(mesh.settings.get<size_t>("top_layers"), size_t(1)); // Top skin, roofing and the top surface.
+    std::vector<std::atomic<size_t>> skin_dependencies(mesh_layer_count); // For each layer, the number of layers whose walls it still waits for.
+    for (size_t layer_number = 0; layer_number < mesh_layer_count; layer_number++)
+    {
+        const size_t lowest = layer_number - std::min(layer_number, layers_below);
+        const size_t highest = std::min(layer_number + layers_above, mesh_layer_count - 1);
+        skin_dependencies[layer_number].store(highest - lowest + 1, std::memory_order_relaxed);
+    }
+
+    // walls, skin & infill
+    WallToolPathsCache walls_cache; // Shared by all layers of this mesh, so that prismatic parts only generate their walls once.
+    SkinOutlineCache skin_outline_cache(mesh); // Shared by the skins of all layers, so that each range of layers is only intersected once.
     cura::parallel_for<size_t>(
         0,
         mesh_layer_count,
         [&](size_t layer_number)
         {
-            spdlog::debug("Processing skins and infill layer {} of {}", layer_number, mesh.layers.size());
-            if (! magic_spiralize || layer_number < mesh_max_initial_bottom_layer_count) // Only generate up/downskin and infill for the first X layers when spiralize is choosen.
+            spdlog::debug("Processing insets for layer {} of {}", layer_number, mesh.layers.size());
+            processWalls(mesh, layer_number, walls_cache);
+            guarded_progress++;
+
+            const size_t lowest_dependent = layer_number - std::min(layer_number, layers_above);
+            const size_t highest_dependent = std::min(layer_number + layers_below, mesh_layer_count - 1);
+            for (size_t skin_layer_number = lowest_dependent; skin_layer_number <= highest_dependent; skin_layer_number++)
             {
-                processSkinsAndInfill(mesh, layer_number, process_infill);
+                if (skin_dependencies[skin_layer_number].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                {
+                    continue; // Still waiting for the walls of other layers.
+                }
+                spdlog::debug("Processing skins and infill layer {} of {}", skin_layer_number, mesh.layers.size());
+                if (! magic_spiralize
+                    || skin_layer_number < mesh_max_initial_bottom_layer_count) // Only generate up/downskin and infill for the first X layers when spiralize is choosen.
+                {
+                    processSkinsAndInfill(mesh, skin_layer_number, process_infill, skin_outline_cache);
+                }
+                guarded_progress++;
             }
-            guarded_progress++;
         });
 }
 
@@ -667,6 +728,7 @@ void FffPolygonGenerator::processInfillMesh(SliceDataStorage& storage, const siz
 
 void FffPolygonGenerator::processDerivedWallsSkinInfill(SliceMeshStorage& mesh)
 {
+    CURA_TRACE_SPAN("FffPolygonGenerator::processDerivedWallsSkinInfill");
     if (mesh.settings.get<bool>("infill_support_enabled"))
     { // create gradual infill areas
         SkinInfillAreaComputation::generateInfillSupport(mesh);
@@ -718,11 +780,20 @@ void FffPolygonGenerator::processDerivedWallsSkinInfill(SliceMeshStorage& mesh)
     // combine infill
     SkinInfillAreaComputation::combineInfillLayers(mesh);
 
+    // combine the skin above the infill, for the walls under the edges of skin
+    SkinInfillAreaComputation::combineSkinAbove(mesh);
+
     // Fuzzy skin. Disabled when using interlocking structures, the internal interlocking walls become fuzzy.
     if (mesh.settings.get<bool>("magic_fuzzy_skin_enabled") && ! mesh.settings.get<bool>("interlocking_enable"))
     {
         processFuzzyWalls(mesh);
     }
+
+    // The layer numbers are final now that the empty first layers are removed, which the direction of the ironing depends on.
+    if (mesh.settings.get<bool>("ironing_enabled"))
+    {
+        processIroning(mesh);
+    }
 }
 
 /*
@@ -731,11 +802,33 @@ void FffPolygonGenerator::processDerivedWallsSkinInfill(SliceMeshStorage& mesh)
  *
  * processInsets only reads and writes data for the current layer
  */
-void FffPolygonGenerator::processWalls(SliceMeshStorage& mesh, size_t layer_nr)
+void FffPolygonGenerator::processWalls(SliceMeshStorage& mesh, size_t layer_nr, WallToolPathsCache& cache)
 {
     SliceLayer* layer = &mesh.layers[layer_nr];
-    WallsComputation walls_computation(mesh.settings, layer_nr);
-    walls_computation.generateWalls(layer, SectionType::WALL);
+    WallsComputation walls_computation(mesh.settings, layer_nr, &cache);
+    SlowLayerCapture& slow_layer_capture = SlowLayerCapture::getInstance();
+    if (slow_layer_capture.isEnabled())
+    {
+        // The outlines are simplified while the walls are generated, so they are kept as they were to capture them.
+        std::vector<SingleShape> outlines;
+        outlines.reserve(layer->parts.size());
+        for (const SliceLayerPart& part : layer->parts)
+        {
+            outlines.push_back(part.outline);
+        }
+        const auto start = std::chrono::steady_clock::now();
+        walls_computation.generateWalls(layer, SectionType::WALL);
+        const double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (duration > slow_layer_capture.threshold())
+        {
+            slow_layer_capture.captureWalls(outlines, mesh.settings, layer_nr, duration);
+        }
+    }
+    else
+    {
+        walls_computation.generateWalls(layer, SectionType::WALL);
+    }
+    mesh.spillWalls(layer_nr); // Nothing reads them again until the g-code is written, apart from fuzzy skin.
 }
 
 bool FffPolygonGenerator::isEmptyLayer(SliceDataStorage& storage, const LayerIndex& layer_idx)
@@ -832,14 +925,14 @@ void FffPolygonGenerator::removeEmptyFirstLayers(SliceDataStorage& storage, size
  * processSkinsAndInfill read (depend on) mesh.layers[*].parts[*].{insets,boundingBox}.
  *                       write mesh.layers[n].parts[*].{skin_parts,infill_area}.
  */
-void FffPolygonGenerator::processSkinsAndInfill(SliceMeshStorage& mesh, const LayerIndex layer_nr, bool process_infill)
+void FffPolygonGenerator::processSkinsAndInfill(SliceMeshStorage& mesh, const LayerIndex layer_nr, bool process_infill, SkinOutlineCache& outline_cache)
 {
     if (mesh.settings.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::SURFACE)
     {
         return;
     }
 
-    SkinInfillAreaComputation skin_infill_area_computation(layer_nr, mesh, process_infill);
+    SkinInfillAreaComputation skin_infill_area_computation(layer_nr, mesh, process_infill, &outline_cache);
     skin_infill_area_computation.generateSkinsAndInfill();
 
     if (((mesh.settings.get<bool>("ironing_enabled") && (! mesh.settings.get<bool>("ironing_only_highest_layer"))) || mesh.layer_nr_max_filled_layer == layer_nr)
@@ -1078,6 +1171,26 @@ void FffPolygonGenerator::processPlatformAdhesion(SliceDataStorage& storage)
 }
 
 
+void FffPolygonGenerator::processIroning(SliceMeshStorage& mesh)
+{
+    CURA_TRACE_SPAN("FffPolygonGenerator::processIroning");
+    if (mesh.settings.get<bool>("ironing_only_highest_layer"))
+    {
+        if (mesh.layer_nr_max_filled_layer >= 0 && static_cast<size_t>(mesh.layer_nr_max_filled_layer) < mesh.layers.size())
+        {
+            mesh.layers[mesh.layer_nr_max_filled_layer].top_surface.generateIroning(mesh, mesh.layer_nr_max_filled_layer);
+        }
+        return;
+    }
+    cura::parallel_for<size_t>(
+        0,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
+        {
+            mesh.layers[layer_nr].top_surface.generateIroning(mesh, layer_nr);
+        });
+}
+
 void FffPolygonGenerator::processFuzzyWalls(SliceMeshStorage& mesh)
 {
     if (mesh.settings.get<size_t>("wall_line_count") == 0)
@@ -1103,6 +1216,7 @@ void FffPolygonGenerator::processFuzzyWalls(SliceMeshStorage& mesh)
 
     for (LayerIndex layer_nr = start_layer_nr; layer_nr < mesh.layers.size(); layer_nr++)
     {
+        mesh.restoreWalls(layer_nr);
         SliceLayer& layer = mesh.layers[layer_nr];
         for (SliceLayerPart& part : layer.parts)
         {
@@ -1197,6 +1311,7 @@ void FffPolygonGenerator::processFuzzyWalls(SliceMeshStorage& mesh)
             }
             part.wall_toolpaths = result_paths;
         }
+        mesh.spillWalls(layer_nr);
     }
 }
 
@@ -3,6 +3,15 @@
 
 #include "FffProcessor.h"
 
+#include "progress/TimingReport.h"
+#ifdef SETTINGS_PROFILING
+#include "settings/SettingsProfiler.h"
+#endif
+#ifdef ALLOCATION_PROFILING
+#include "utils/AllocationProfiler.h"
+#endif
+#include "utils/ThreadPoolProfiler.h"
+
 namespace cura 
 {
 
@@ -13,6 +22,11 @@ bool FffProcessor::setTargetFile(const char* filename)
     return gcode_writer.setTargetFile(filename);
 }
 
+void FffProcessor::closeTargetFile()
+{
+    gcode_writer.closeTargetFile();
+}
+
 void FffProcessor::setTargetStream(std::ostream* stream)
 {
     return gcode_writer.setTargetStream(stream);
@@ -31,6 +45,14 @@ std::vector<Duration> FffProcessor::getTotalPrintTimePerFeature()
 void FffProcessor::finalize()
 {
     gcode_writer.finalize();
+#ifdef SETTINGS_PROFILING
+    SettingsProfiler::getInstance().report();
+#endif
+#ifdef ALLOCATION_PROFILING
+    AllocationProfiler::getInstance().report();
+#endif
+    ThreadPoolProfiler::getInstance().report();
+    TimingReport::getInstance().report();
 }
 
 } // namespace cura 
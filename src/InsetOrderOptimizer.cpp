@@ -4,6 +4,8 @@
 #include "InsetOrderOptimizer.h"
 
 #include <functional>
+#include <limits>
+#include <set>
 #include <tuple>
 
 #include <range/v3/algorithm/max.hpp>
@@ -267,6 +269,7 @@ std::optional<size_t> InsetOrderOptimizer::insertSeamPoint(ExtrusionLine& closed
     const coord_t w = ((end_pt.w_ * end_dist) / total_dist) + ((start_pt.w_ * start_dist) / total_dist);
 
     closed_line.junctions_.insert(closed_line.junctions_.begin() + closest_junction_idx + 1, ExtrusionJunction(closest_point, w, start_pt.perimeter_index_));
+    closed_line.corner_angles_.clear(); // Not needed anymore, since the seam is forced to the new junction.
     return closest_junction_idx + 1;
 }
 
@@ -278,79 +281,80 @@ InsetOrderOptimizer::value_type InsetOrderOptimizer::getRegionOrder(const std::v
         return {};
     }
 
-    // view on the extrusion lines, sorted by area
-    const std::vector<const ExtrusionLine*> sorted_extrusion_lines = [&extrusion_lines]()
+    // view on the extrusion lines with their bounding boxes, sorted by area
+    const std::vector<std::pair<const ExtrusionLine*, AABB>> sorted_extrusion_lines = [&extrusion_lines]()
     {
-        auto extrusion_lines_area = extrusion_lines | ranges::views::addressof
+        auto extrusion_lines_aabb = extrusion_lines | ranges::views::addressof
                                   | ranges::views::transform(
                                         [](const ExtrusionLine* line)
                                         {
-                                            const Polygon poly = line->toPolygon();
                                             AABB aabb;
-                                            aabb.include(poly);
-                                            return std::make_pair(line, aabb.area());
+                                            for (const ExtrusionJunction& junction : line->junctions_)
+                                            {
+                                                aabb.include(junction.p_);
+                                            }
+                                            return std::make_pair(line, aabb);
                                         })
                                   | ranges::to_vector;
 
         ranges::sort(
-            extrusion_lines_area,
+            extrusion_lines_aabb,
             [](const auto& lhs, const auto& rhs)
             {
-                return std::get<1>(lhs) < std::get<1>(rhs);
+                return std::get<1>(lhs).area() < std::get<1>(rhs).area();
             });
 
-        return extrusion_lines_area
-             | ranges::views::transform(
-                   [](const auto& pair)
-                   {
-                       return std::get<0>(pair);
-                   })
-             | ranges::to_vector;
+        return extrusion_lines_aabb;
     }();
 
     // graph will contain the parent-child relationships between the extrusion lines
     // an edge is added for both the parent to child and child to parent relationship
     std::unordered_multimap<const ExtrusionLine*, const ExtrusionLine*> graph;
     // during the loop we maintain a list of invariant parents; these are the parents
-    // that we have found so far
-    std::unordered_set<const ExtrusionLine*> invariant_outer_parents;
-    for (const auto& extrusion_line : sorted_extrusion_lines)
+    // that we have found so far. They are sorted by the X and Y of their first junction,
+    // so that only those within the bounding box of a line need to be tested against it.
+    using Candidate = std::tuple<coord_t, coord_t, const ExtrusionLine*>;
+    std::set<Candidate> invariant_outer_parents;
+    const auto add_invariant_parent = [&invariant_outer_parents](const ExtrusionLine* line)
     {
-        // Create a polygon representing the inner area of the extrusion line; any
-        // point inside this polygon is considered to the child of the extrusion line.
-        Shape hole_polygons;
-        if (extrusion_line->is_closed_)
+        if (! line->junctions_.empty())
         {
-            hole_polygons.push_back(extrusion_line->toPolygon());
+            const Point2LL& point = line->junctions_[0].p_;
+            invariant_outer_parents.emplace(point.X, point.Y, line);
         }
-
-        if (hole_polygons.empty())
+    };
+    for (const auto& [extrusion_line, extrusion_line_aabb] : sorted_extrusion_lines)
+    {
+        // Any point inside the polygon through the junctions of a closed extrusion line
+        // is considered to be a child of the extrusion line.
+        if (! extrusion_line->is_closed_)
         {
-            invariant_outer_parents.emplace(extrusion_line);
+            add_invariant_parent(extrusion_line);
             continue;
         }
 
-        // go through all the invariant parents and see if they are inside the hole polygon
+        // go through the invariant parents within the bounding box and see if they are inside the extrusion line
         // if they are, then that means we have found a child for this extrusion line
-        std::vector<const ExtrusionLine*> removed_parent_invariants;
-        for (const ExtrusionLine* invariant_parent : invariant_outer_parents)
+        for (auto parent_it = invariant_outer_parents.lower_bound(Candidate{ extrusion_line_aabb.min_.X, std::numeric_limits<coord_t>::lowest(), nullptr });
+             parent_it != invariant_outer_parents.end() && std::get<0>(*parent_it) <= extrusion_line_aabb.max_.X;)
         {
-            if (hole_polygons.inside(invariant_parent->junctions_[0].p_, false))
+            const auto& [x, y, invariant_parent] = *parent_it;
+            if (y >= extrusion_line_aabb.min_.Y && y <= extrusion_line_aabb.max_.Y && extrusion_line->inside(Point2LL(x, y), false))
             {
                 // The root polygon is inside the location polygon. It is no longer a root in the graph we are building.
                 // Add this relationship (locator <-> root) to the graph, and remove root from roots.
                 graph.emplace(extrusion_line, invariant_parent);
                 graph.emplace(invariant_parent, extrusion_line);
-                removed_parent_invariants.emplace_back(invariant_parent);
+                parent_it = invariant_outer_parents.erase(parent_it);
+            }
+            else
+            {
+                ++parent_it;
             }
-        }
-        for (const auto& node : removed_parent_invariants)
-        {
-            invariant_outer_parents.erase(node);
         }
 
         // the current extrusion line is now an invariant parent
-        invariant_outer_parents.emplace(extrusion_line);
+        add_invariant_parent(extrusion_line);
     }
 
     const std::vector<const ExtrusionLine*> outer_walls = extrusion_lines | ranges::views::filter(&ExtrusionLine::is_outer_wall) | ranges::views::addressof | ranges::to_vector;
@@ -3,7 +3,9 @@
 
 #include "InterlockingGenerator.h"
 
-#include <algorithm> // max
+#include <algorithm> // max, sort, set_intersection
+#include <iterator>
+#include <span>
 
 #include <range/v3/view/enumerate.hpp>
 #include <range/v3/view/iota.hpp>
@@ -15,6 +17,7 @@
 #include "geometry/PointMatrix.h"
 #include "settings/types/LayerIndex.h"
 #include "slicer.h"
+#include "utils/ThreadPool.h"
 #include "utils/VoxelUtils.h"
 #include "utils/polygonUtils.h"
 
@@ -90,7 +93,7 @@ std::pair<Shape, Shape> InterlockingGenerator::growBorderAreasPerpendicular(cons
     return { from_border_a, from_border_b };
 }
 
-void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>& has_all_meshes) const
+void InterlockingGenerator::handleThinAreas(const std::vector<GridPoint3>& has_all_meshes) const
 {
     Settings& global_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     const coord_t boundary_avoidance = global_settings.get<int>("interlocking_boundary_avoidance");
@@ -150,23 +153,23 @@ void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>
 
 void InterlockingGenerator::generateInterlockingStructure() const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh = getShellVoxels(interface_dilation_);
+    std::vector<std::vector<GridPoint3>> voxels_per_mesh = getShellVoxels(interface_dilation_);
 
-    std::unordered_set<GridPoint3>& has_any_mesh = voxels_per_mesh[0];
-    std::unordered_set<GridPoint3>& has_all_meshes = voxels_per_mesh[1];
-    has_any_mesh.merge(has_all_meshes); // perform union and intersection simultaneously. Cannibalizes voxels_per_mesh
+    // The voxels are sorted, so the cells that have both meshes are found in a single pass over both.
+    std::vector<GridPoint3> has_all_meshes;
+    std::set_intersection(voxels_per_mesh[0].begin(), voxels_per_mesh[0].end(), voxels_per_mesh[1].begin(), voxels_per_mesh[1].end(), std::back_inserter(has_all_meshes));
+    voxels_per_mesh.clear();
 
     const std::vector<Shape> layer_regions = computeUnionedVolumeRegions();
 
     if (air_filtering_)
     {
-        std::unordered_set<GridPoint3> air_cells;
+        std::vector<GridPoint3> air_cells;
         addBoundaryCells(layer_regions, air_dilation_, air_cells);
 
-        for (const GridPoint3& p : air_cells)
-        {
-            has_all_meshes.erase(p);
-        }
+        std::vector<GridPoint3> away_from_air;
+        std::set_difference(has_all_meshes.begin(), has_all_meshes.end(), air_cells.begin(), air_cells.end(), std::back_inserter(away_from_air));
+        has_all_meshes = std::move(away_from_air);
 
         handleThinAreas(has_all_meshes);
     }
@@ -174,23 +177,26 @@ void InterlockingGenerator::generateInterlockingStructure() const
     applyMicrostructureToOutlines(has_all_meshes, layer_regions);
 }
 
-std::vector<std::unordered_set<GridPoint3>> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
+std::vector<std::vector<GridPoint3>> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh(2);
+    std::vector<std::vector<GridPoint3>> voxels_per_mesh(2);
 
     // mark all cells which contain some boundary
     for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++)
     {
         Slicer* mesh = (mesh_idx == 0) ? &mesh_a_ : &mesh_b_;
-        std::unordered_set<GridPoint3>& mesh_voxels = voxels_per_mesh[mesh_idx];
+        std::vector<GridPoint3>& mesh_voxels = voxels_per_mesh[mesh_idx];
 
         std::vector<Shape> rotated_polygons_per_layer(mesh->layers.size());
-        for (size_t layer_nr = 0; layer_nr < mesh->layers.size(); layer_nr++)
-        {
-            SlicerLayer& layer = mesh->layers[layer_nr];
-            rotated_polygons_per_layer[layer_nr] = layer.polygons_;
-            rotated_polygons_per_layer[layer_nr].applyMatrix(rotation_);
-        }
+        cura::parallel_for<size_t>(
+            0,
+            mesh->layers.size(),
+            [&](const size_t layer_nr)
+            {
+                SlicerLayer& layer = mesh->layers[layer_nr];
+                rotated_polygons_per_layer[layer_nr] = layer.polygons_;
+                rotated_polygons_per_layer[layer_nr].applyMatrix(rotation_);
+            });
 
         addBoundaryCells(rotated_polygons_per_layer, kernel, mesh_voxels);
     }
@@ -198,26 +204,58 @@ std::vector<std::unordered_set<GridPoint3>> InterlockingGenerator::getShellVoxel
     return voxels_per_mesh;
 }
 
-void InterlockingGenerator::addBoundaryCells(const std::vector<Shape>& layers, const DilationKernel& kernel, std::unordered_set<GridPoint3>& cells) const
+void InterlockingGenerator::addBoundaryCells(const std::vector<Shape>& layers, const DilationKernel& kernel, std::vector<GridPoint3>& cells) const
 {
-    auto voxel_emplacer = [&cells](GridPoint3 p)
+    // Walk each layer into its own list, and remove the many duplicates that the dilation gives right away to keep the lists small.
+    std::vector<std::vector<GridPoint3>> cells_per_layer(layers.size());
+    cura::parallel_for<size_t>(
+        0,
+        layers.size(),
+        [&](const size_t layer_nr)
+        {
+            std::vector<GridPoint3>& layer_cells = cells_per_layer[layer_nr];
+            auto voxel_emplacer = [&layer_cells](GridPoint3 p)
+            {
+                layer_cells.push_back(p);
+                return true;
+            };
+
+            const coord_t z = static_cast<coord_t>(layer_nr);
+            vu_.walkDilatedPolygons(layers[layer_nr], z, kernel, voxel_emplacer);
+            Shape skin = layers[layer_nr];
+            if (layer_nr > 0)
+            {
+                skin = skin.xorPolygons(layers[layer_nr - 1]);
+            }
+            skin = skin.offset(-cell_size_.x_ / 2).offset(cell_size_.x_ / 2); // remove superfluous small areas, which would anyway be included because of walkPolygons
+            vu_.walkDilatedAreaRuns(
+                skin,
+                z,
+                kernel,
+                [&layer_cells](const std::span<const GridPoint3> cells)
+                {
+                    layer_cells.insert(layer_cells.end(), cells.begin(), cells.end());
+                    return true;
+                });
+
+            std::sort(layer_cells.begin(), layer_cells.end());
+            layer_cells.erase(std::unique(layer_cells.begin(), layer_cells.end()), layer_cells.end());
+        });
+
+    // The dilation reaches into the neighbouring layers, so the same cell can still come from several layers.
+    size_t total_cells = cells.size();
+    for (const std::vector<GridPoint3>& layer_cells : cells_per_layer)
     {
-        cells.emplace(p);
-        return true;
-    };
-
-    for (size_t layer_nr = 0; layer_nr < layers.size(); layer_nr++)
+        total_cells += layer_cells.size();
+    }
+    cells.reserve(total_cells);
+    for (std::vector<GridPoint3>& layer_cells : cells_per_layer)
     {
-        const coord_t z = static_cast<coord_t>(layer_nr);
-        vu_.walkDilatedPolygons(layers[layer_nr], z, kernel, voxel_emplacer);
-        Shape skin = layers[layer_nr];
-        if (layer_nr > 0)
-        {
-            skin = skin.xorPolygons(layers[layer_nr - 1]);
-        }
-        skin = skin.offset(-cell_size_.x_ / 2).offset(cell_size_.x_ / 2); // remove superfluous small areas, which would anyway be included because of walkPolygons
-        vu_.walkDilatedAreas(skin, z, kernel, voxel_emplacer);
+        cells.insert(cells.end(), layer_cells.begin(), layer_cells.end());
+        layer_cells = std::vector<GridPoint3>();
     }
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
 }
 
 std::vector<Shape> InterlockingGenerator::computeUnionedVolumeRegions() const
@@ -225,21 +263,24 @@ std::vector<Shape> InterlockingGenerator::computeUnionedVolumeRegions() const
     const size_t max_layer_count = std::max(mesh_a_.layers.size(), mesh_b_.layers.size()) + 1; // introduce ghost layer on top for correct skin computation of topmost layer.
     std::vector<Shape> layer_regions(max_layer_count);
 
-    for (LayerIndex layer_nr = 0; layer_nr < max_layer_count; layer_nr++)
-    {
-        Shape& layer_region = layer_regions[static_cast<size_t>(layer_nr)];
-        for (Slicer* mesh : { &mesh_a_, &mesh_b_ })
+    cura::parallel_for<size_t>(
+        0,
+        max_layer_count,
+        [&](const size_t layer_nr)
         {
-            if (layer_nr >= mesh->layers.size())
+            Shape& layer_region = layer_regions[layer_nr];
+            for (Slicer* mesh : { &mesh_a_, &mesh_b_ })
             {
-                break;
+                if (layer_nr >= mesh->layers.size())
+                {
+                    break;
+                }
+                const SlicerLayer& layer = mesh->layers[layer_nr];
+                layer_region.push_back(layer.polygons_);
             }
-            const SlicerLayer& layer = mesh->layers[static_cast<size_t>(layer_nr)];
-            layer_region.push_back(layer.polygons_);
-        }
-        layer_region = layer_region.offset(ignored_gap_).offset(-ignored_gap_); // Morphological close to merge meshes into single volume
-        layer_region.applyMatrix(rotation_);
-    }
+            layer_region = layer_region.offset(ignored_gap_).offset(-ignored_gap_); // Morphological close to merge meshes into single volume
+            layer_region.applyMatrix(rotation_);
+        });
     return layer_regions;
 }
 
@@ -276,7 +317,7 @@ std::vector<std::vector<Shape>> InterlockingGenerator::generateMicrostructure()
     return cell_area_per_mesh_per_layer;
 }
 
-void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_set<GridPoint3>& cells, const std::vector<Shape>& layer_regions) const
+void InterlockingGenerator::applyMicrostructureToOutlines(const std::vector<GridPoint3>& cells, const std::vector<Shape>& layer_regions) const
 {
     std::vector<std::vector<Shape>> cell_area_per_mesh_per_layer = generateMicrostructure();
 
@@ -7,8 +7,10 @@
 #include <cstring>
 #include <numeric>
 #include <optional>
+#include <tuple>
 
 #include <range/v3/algorithm/max_element.hpp>
+#include <range/v3/view/zip.hpp>
 #include <scripta/logger.h>
 #include <spdlog/spdlog.h>
 
@@ -25,7 +27,11 @@
 #include "raft.h" // getTotalExtraLayers
 #include "settings/types/Ratio.h"
 #include "sliceDataStorage.h"
+#include "utils/ArcFitter.h"
+#include "utils/ShapeCoordinates.h"
 #include "utils/Simplify.h"
+#include "utils/ThreadPool.h"
+#include "utils/TraceSpan.h"
 #include "utils/linearAlg2D.h"
 #include "utils/math.h"
 #include "utils/polygonUtils.h"
@@ -65,6 +71,11 @@ GCodePath* LayerPlan::getLatestPathWithConfig(
 
     GCodePath* ret = &paths.back();
     ret->skip_agressive_merge_hint = mode_skip_agressive_merge_;
+    if (! recycled_points_.empty())
+    {
+        ret->points = std::move(recycled_points_.back());
+        recycled_points_.pop_back();
+    }
     return ret;
 }
 
@@ -73,6 +84,40 @@ const Shape* LayerPlan::getCombBoundaryInside() const
     return &comb_boundary_preferred_;
 }
 
+const Shape* LayerPlan::getTravelOptimizationBoundary()
+{
+    if (comb_boundary_minimum_.empty())
+    {
+        return nullptr;
+    }
+    if (! travel_optimization_boundary_)
+    {
+        // use the combing boundary inflated so that all infill lines are inside the boundary
+        int dist = 0;
+        if (layer_nr_ >= 0)
+        {
+            // determine how much the skin/infill lines overlap the combing boundary
+            for (const std::shared_ptr<SliceMeshStorage>& mesh : storage_.meshes)
+            {
+                const coord_t overlap = std::max(mesh->settings.get<coord_t>("skin_overlap_mm"), mesh->settings.get<coord_t>("infill_overlap_mm"));
+                if (overlap > dist)
+                {
+                    dist = overlap;
+                }
+            }
+            dist += 100; // ensure boundary is slightly outside all skin/infill lines
+        }
+        Shape boundary;
+        boundary.push_back(comb_boundary_minimum_.offset(dist));
+        // simplify boundary to cut down processing time
+        travel_optimization_boundary_ = Simplify(MM2INT(0.1), MM2INT(0.1), 0).polygon(boundary);
+
+        constexpr coord_t grid_size = 2000; // Same cell size as the path order optimizer uses for its own grid.
+        travel_optimization_grid_ = PolygonUtils::createLocToLineGrid(*travel_optimization_boundary_, grid_size);
+    }
+    return &*travel_optimization_boundary_;
+}
+
 void LayerPlan::forceNewPathStart()
 {
     std::vector<GCodePath>& paths = extruder_plans_.back().paths_;
@@ -89,8 +134,9 @@ LayerPlan::LayerPlan(
     const std::vector<FanSpeedLayerTimeSettings>& fan_speed_layer_time_settings_per_extruder,
     coord_t comb_boundary_offset,
     coord_t comb_move_inside_distance,
-    coord_t travel_avoid_distance)
-    : configs_storage_(storage, layer_nr, layer_thickness)
+    coord_t travel_avoid_distance,
+    const PathConfigStorage* layer_invariant_configs)
+    : configs_storage_(layer_invariant_configs ? PathConfigStorage(*layer_invariant_configs, layer_thickness) : PathConfigStorage(storage, layer_nr, layer_thickness))
     , z_(z)
     , final_travel_z_(z)
     , mode_skip_agressive_merge_(false)
@@ -108,6 +154,7 @@ LayerPlan::LayerPlan(
     comb_boundary_minimum_(computeCombBoundary(CombBoundary::MINIMUM))
     , comb_boundary_preferred_(computeCombBoundary(CombBoundary::PREFERRED))
     , comb_move_inside_distance_(comb_move_inside_distance)
+    , recycled_points_(PathPointsPool::getInstance().take())
     , fan_speed_layer_time_settings_per_extruder_(fan_speed_layer_time_settings_per_extruder)
 {
     size_t current_extruder = start_extruder;
@@ -146,6 +193,15 @@ LayerPlan::~LayerPlan()
 {
     if (comb_)
         delete comb_;
+
+    for (ExtruderPlan& extruder_plan : extruder_plans_)
+    {
+        for (GCodePath& path : extruder_plan.paths_)
+        {
+            recycled_points_.push_back(std::move(path.points));
+        }
+    }
+    PathPointsPool::getInstance().give(std::move(recycled_points_));
 }
 
 ExtruderTrain* LayerPlan::getLastPlannedExtruderTrain()
@@ -178,66 +234,202 @@ Shape LayerPlan::computeCombBoundary(const CombBoundary boundary_type)
             break;
 
         case Raft::LayerType::Model:
-            for (const std::shared_ptr<SliceMeshStorage>& mesh_ptr : storage_.meshes)
+            if (static_cast<size_t>(layer_nr_) < storage_.comb_boundaries.size())
             {
-                const auto& mesh = *mesh_ptr;
-                const SliceLayer& layer = mesh.layers[static_cast<size_t>(layer_nr_)];
-                // don't process infill_mesh or anti_overhang_mesh
-                if (mesh.settings.get<bool>("infill_mesh") || mesh.settings.get<bool>("anti_overhang_mesh"))
-                {
-                    continue;
-                }
-                coord_t offset;
-                switch (boundary_type)
-                {
-                case CombBoundary::MINIMUM:
-                    offset = -mesh.settings.get<coord_t>("machine_nozzle_size") / 2 - mesh.settings.get<coord_t>("wall_line_width_0") / 2;
-                    break;
-                case CombBoundary::PREFERRED:
-                    offset = -mesh.settings.get<coord_t>("machine_nozzle_size") * 3 / 2 - mesh.settings.get<coord_t>("wall_line_width_0") / 2;
-                    break;
-                default:
-                    offset = 0;
-                    spdlog::warn("Unknown combing boundary type. Did you forget to configure the comb offset for a new boundary type?");
-                    break;
-                }
+                const LayerCombBoundaries& precomputed = *storage_.comb_boundaries[static_cast<size_t>(layer_nr_)];
+                comb_boundary = boundary_type == CombBoundary::MINIMUM ? precomputed.minimum : precomputed.preferred;
+            }
+            else
+            {
+                comb_boundary = computeModelCombBoundary(storage_, layer_nr_, boundary_type);
+            }
+            break;
+        }
+    }
+    return comb_boundary;
+}
+
+Shape LayerPlan::computeModelCombBoundary(const SliceDataStorage& storage, const LayerIndex layer_nr, const CombBoundary boundary_type)
+{
+    Shape comb_boundary;
+    for (const std::shared_ptr<SliceMeshStorage>& mesh_ptr : storage.meshes)
+    {
+        const auto& mesh = *mesh_ptr;
+        const SliceLayer& layer = mesh.layers[static_cast<size_t>(layer_nr)];
+        // don't process infill_mesh or anti_overhang_mesh
+        if (mesh.settings.get<bool>("infill_mesh") || mesh.settings.get<bool>("anti_overhang_mesh"))
+        {
+            continue;
+        }
+        coord_t offset;
+        switch (boundary_type)
+        {
+        case CombBoundary::MINIMUM:
+            offset = -mesh.settings.get<coord_t>("machine_nozzle_size") / 2 - mesh.settings.get<coord_t>("wall_line_width_0") / 2;
+            break;
+        case CombBoundary::PREFERRED:
+            offset = -mesh.settings.get<coord_t>("machine_nozzle_size") * 3 / 2 - mesh.settings.get<coord_t>("wall_line_width_0") / 2;
+            break;
+        default:
+            offset = 0;
+            spdlog::warn("Unknown combing boundary type. Did you forget to configure the comb offset for a new boundary type?");
+            break;
+        }
 
-                const CombingMode combing_mode = mesh.settings.get<CombingMode>("retraction_combing");
-                for (const SliceLayerPart& part : layer.parts)
+        const CombingMode combing_mode = mesh.settings.get<CombingMode>("retraction_combing");
+        for (const SliceLayerPart& part : layer.parts)
+        {
+            if (combing_mode == CombingMode::ALL) // Add the increased outline offset (skin, infill and part of the inner walls)
+            {
+                comb_boundary.push_back(part.outline.offset(offset));
+            }
+            else if (combing_mode == CombingMode::NO_SKIN) // Add the increased outline offset, subtract skin (infill and part of the inner walls)
+            {
+                comb_boundary.push_back(part.outline.offset(offset).difference(part.inner_area.difference(part.infill_area)));
+            }
+            else if (combing_mode == CombingMode::NO_OUTER_SURFACES)
+            {
+                Shape top_and_bottom_most_fill;
+                for (const SliceLayerPart& outer_surface_part : layer.parts)
                 {
-                    if (combing_mode == CombingMode::ALL) // Add the increased outline offset (skin, infill and part of the inner walls)
-                    {
-                        comb_boundary.push_back(part.outline.offset(offset));
-                    }
-                    else if (combing_mode == CombingMode::NO_SKIN) // Add the increased outline offset, subtract skin (infill and part of the inner walls)
-                    {
-                        comb_boundary.push_back(part.outline.offset(offset).difference(part.inner_area.difference(part.infill_area)));
-                    }
-                    else if (combing_mode == CombingMode::NO_OUTER_SURFACES)
-                    {
-                        Shape top_and_bottom_most_fill;
-                        for (const SliceLayerPart& outer_surface_part : layer.parts)
-                        {
-                            for (const SkinPart& skin_part : outer_surface_part.skin_parts)
-                            {
-                                top_and_bottom_most_fill.push_back(skin_part.top_most_surface_fill);
-                                top_and_bottom_most_fill.push_back(skin_part.bottom_most_surface_fill);
-                            }
-                        }
-                        comb_boundary.push_back(part.outline.offset(offset).difference(top_and_bottom_most_fill));
-                    }
-                    else if (combing_mode == CombingMode::INFILL) // Add the infill (infill only)
+                    for (const SkinPart& skin_part : outer_surface_part.skin_parts)
                     {
-                        comb_boundary.push_back(part.infill_area);
+                        top_and_bottom_most_fill.push_back(skin_part.top_most_surface_fill);
+                        top_and_bottom_most_fill.push_back(skin_part.bottom_most_surface_fill);
                     }
                 }
+                comb_boundary.push_back(part.outline.offset(offset).difference(top_and_bottom_most_fill));
+            }
+            else if (combing_mode == CombingMode::INFILL) // Add the infill (infill only)
+            {
+                comb_boundary.push_back(part.infill_area);
             }
-            break;
         }
     }
     return comb_boundary;
 }
 
+/*!
+ * Whether two shapes have exactly the same vertices.
+ */
+static bool isSameShape(const Shape& a, const Shape& b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (size_t polygon_idx = 0; polygon_idx < a.size(); polygon_idx++)
+    {
+        if (a[polygon_idx].getPoints() != b[polygon_idx].getPoints())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * Whether everything that the combing boundaries of two layers of the model
+ * are computed from is the same, so that the boundaries are the same too.
+ */
+static bool haveSameCombingInputs(const SliceDataStorage& storage, const size_t layer_nr_a, const size_t layer_nr_b)
+{
+    for (const std::shared_ptr<SliceMeshStorage>& mesh_ptr : storage.meshes)
+    {
+        const auto& mesh = *mesh_ptr;
+        if (mesh.settings.get<bool>("infill_mesh") || mesh.settings.get<bool>("anti_overhang_mesh"))
+        {
+            continue;
+        }
+        if (std::max(layer_nr_a, layer_nr_b) >= mesh.layers.size())
+        {
+            return false;
+        }
+        const SliceLayer& layer_a = mesh.layers[layer_nr_a];
+        const SliceLayer& layer_b = mesh.layers[layer_nr_b];
+        if (layer_a.parts.size() != layer_b.parts.size())
+        {
+            return false;
+        }
+
+        const CombingMode combing_mode = mesh.settings.get<CombingMode>("retraction_combing");
+        for (const auto& [part_a, part_b] : ranges::views::zip(layer_a.parts, layer_b.parts))
+        {
+            bool same = true;
+            switch (combing_mode)
+            {
+            case CombingMode::ALL:
+                same = isSameShape(part_a.outline, part_b.outline);
+                break;
+            case CombingMode::NO_SKIN:
+                same = isSameShape(part_a.outline, part_b.outline) && isSameShape(part_a.inner_area, part_b.inner_area) && isSameShape(part_a.infill_area, part_b.infill_area);
+                break;
+            case CombingMode::NO_OUTER_SURFACES:
+                same = isSameShape(part_a.outline, part_b.outline) && part_a.skin_parts.size() == part_b.skin_parts.size();
+                for (size_t skin_idx = 0; same && skin_idx < part_a.skin_parts.size(); skin_idx++)
+                {
+                    same = isSameShape(part_a.skin_parts[skin_idx].top_most_surface_fill, part_b.skin_parts[skin_idx].top_most_surface_fill)
+                        && isSameShape(part_a.skin_parts[skin_idx].bottom_most_surface_fill, part_b.skin_parts[skin_idx].bottom_most_surface_fill);
+                }
+                break;
+            case CombingMode::INFILL:
+                same = isSameShape(part_a.infill_area, part_b.infill_area);
+                break;
+            default:
+                break;
+            }
+            if (! same)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void LayerPlan::precomputeCombBoundaries(SliceDataStorage& storage)
+{
+    storage.comb_boundaries.clear();
+    if (Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<CombingMode>("retraction_combing") == CombingMode::OFF)
+    {
+        return;
+    }
+    const size_t layer_count = storage.print_layer_count;
+
+    // Layers that comb within the same boundaries as the layer below share them. Prismatic models have many of those.
+    std::vector<char> same_as_below(layer_count, false); // Not a vector<bool>, since it is written from multiple threads.
+    cura::parallel_for<size_t>(
+        1,
+        layer_count,
+        [&](const size_t layer_nr)
+        {
+            same_as_below[layer_nr] = haveSameCombingInputs(storage, layer_nr - 1, layer_nr);
+        });
+
+    std::vector<std::shared_ptr<const LayerCombBoundaries>> comb_boundaries(layer_count);
+    cura::parallel_for<size_t>(
+        0,
+        layer_count,
+        [&](const size_t layer_nr)
+        {
+            if (same_as_below[layer_nr])
+            {
+                return;
+            }
+            comb_boundaries[layer_nr] = std::make_shared<const LayerCombBoundaries>(LayerCombBoundaries{
+                .minimum = computeModelCombBoundary(storage, layer_nr, CombBoundary::MINIMUM),
+                .preferred = computeModelCombBoundary(storage, layer_nr, CombBoundary::PREFERRED) });
+        });
+    for (size_t layer_nr = 1; layer_nr < layer_count; layer_nr++)
+    {
+        if (same_as_below[layer_nr])
+        {
+            comb_boundaries[layer_nr] = comb_boundaries[layer_nr - 1];
+        }
+    }
+    storage.comb_boundaries = std::move(comb_boundaries);
+}
+
 void LayerPlan::setIsInside(bool _is_inside)
 {
     is_inside_ = _is_inside;
@@ -738,7 +930,7 @@ void LayerPlan::addWallLine(
                         segment_flow,
                         width_factor,
                         spiralize,
-                        (overhang_mask_.empty() || (! overhang_mask_.inside(p0, true) && ! overhang_mask_.inside(p1, true))) ? speed_factor : overhang_speed_factor);
+                        (overhang_mask_.empty() || (! overhang_mask_.inside(p0) && ! overhang_mask_.inside(p1))) ? speed_factor : overhang_speed_factor);
                 }
 
                 distance_to_bridge_start -= len;
@@ -753,7 +945,7 @@ void LayerPlan::addWallLine(
                     segment_flow,
                     width_factor,
                     spiralize,
-                    (overhang_mask_.empty() || (! overhang_mask_.inside(p0, true) && ! overhang_mask_.inside(p1, true))) ? speed_factor : overhang_speed_factor);
+                    (overhang_mask_.empty() || (! overhang_mask_.inside(p0) && ! overhang_mask_.inside(p1))) ? speed_factor : overhang_speed_factor);
             }
             non_bridge_line_volume += vSize(cur_point - segment_end) * segment_flow * width_factor * speed_factor * default_config.getSpeed();
             cur_point = segment_end;
@@ -774,7 +966,7 @@ void LayerPlan::addWallLine(
             // what part of the line segment will be printed with what config.
             return false;
         }
-        return PolygonUtils::polygonCollidesWithLineSegment(roofing_mask_, p0, p1) || roofing_mask_.inside(p1, true);
+        return roofing_mask_.collidesWithLineSegment(p0, p1) || roofing_mask_.inside(p1);
     }();
 
     if (use_roofing_config)
@@ -788,7 +980,7 @@ void LayerPlan::addWallLine(
         OpenLinesSet line_polys;
         line_polys.addSegment(p0, p1);
         constexpr bool restitch = false; // only a single line doesn't need stitching
-        auto roofing_line_segments = roofing_mask_.intersection(line_polys, restitch);
+        auto roofing_line_segments = roofing_mask_.shape().intersection(line_polys, restitch);
 
         if (roofing_line_segments.empty())
         {
@@ -847,12 +1039,12 @@ void LayerPlan::addWallLine(
             flow,
             width_factor,
             spiralize,
-            (overhang_mask_.empty() || (! overhang_mask_.inside(p0, true) && ! overhang_mask_.inside(p1, true))) ? 1.0_r : overhang_speed_factor);
+            (overhang_mask_.empty() || (! overhang_mask_.inside(p0) && ! overhang_mask_.inside(p1))) ? 1.0_r : overhang_speed_factor);
     }
     else
     {
         // bridges may be required
-        if (PolygonUtils::polygonCollidesWithLineSegment(bridge_wall_mask_, p0, p1))
+        if (bridge_wall_mask_.collidesWithLineSegment(p0, p1))
         {
             // the line crosses the boundary between supported and non-supported regions so one or more bridges are required
 
@@ -861,7 +1053,7 @@ void LayerPlan::addWallLine(
             OpenLinesSet line_polys;
             line_polys.addSegment(p0, p1);
             constexpr bool restitch = false; // only a single line doesn't need stitching
-            line_polys = bridge_wall_mask_.intersection(line_polys, restitch);
+            line_polys = bridge_wall_mask_.shape().intersection(line_polys, restitch);
 
             // line_polys now contains the wall lines that need to be printed using bridge_config
 
@@ -925,7 +1117,7 @@ void LayerPlan::addWallLine(
             // if we haven't yet reached p1, fill the gap with default_config line
             addNonBridgeLine(p1);
         }
-        else if (bridge_wall_mask_.inside(p0, true) && vSize(p0 - p1) >= min_bridge_line_len)
+        else if (bridge_wall_mask_.inside(p0) && vSize(p0 - p1) >= min_bridge_line_len)
         {
             // both p0 and p1 must be above air (the result will be ugly!)
             addExtrusionMove(p1, bridge_config, SpaceFillType::Polygons, flow, width_factor);
@@ -1024,7 +1216,7 @@ void LayerPlan::addWall(
                 const ExtrusionJunction& p0 = wall[point_idx];
                 const ExtrusionJunction& p1 = wall[(point_idx + 1) % wall.size()];
 
-                if (PolygonUtils::polygonCollidesWithLineSegment(bridge_wall_mask_, p0.p_, p1.p_))
+                if (bridge_wall_mask_.collidesWithLineSegment(p0.p_, p1.p_))
                 {
                     // the line crosses the boundary between supported and non-supported regions so it will contain one or more bridge segments
 
@@ -1033,7 +1225,7 @@ void LayerPlan::addWall(
                     OpenLinesSet line_polys;
                     line_polys.addSegment(p0.p_, p1.p_);
                     constexpr bool restitch = false; // only a single line doesn't need stitching
-                    line_polys = bridge_wall_mask_.intersection(line_polys, restitch);
+                    line_polys = bridge_wall_mask_.shape().intersection(line_polys, restitch);
 
                     while (line_polys.size() > 0)
                     {
@@ -1078,7 +1270,7 @@ void LayerPlan::addWall(
                         line_polys.removeAt(nearest);
                     }
                 }
-                else if (! bridge_wall_mask_.inside(p0.p_, true))
+                else if (! bridge_wall_mask_.inside(p0.p_))
                 {
                     // none of the line is over air
                     distance_to_bridge_start += vSize(p1.p_ - p0.p_);
@@ -1270,6 +1462,27 @@ void LayerPlan::addWalls(
     }
 }
 
+/*!
+ * How many moves the travel order refinement may evaluate for a set of lines.
+ *
+ * The refinement is opt-in, with the travel_order_refinement_moves setting:
+ * the number of moves to evaluate per line. It isn't part of the setting
+ * definitions, so it is only used when it's given explicitly, in the global or
+ * the mesh group settings.
+ */
+static size_t getTravelOrderRefinementBudget(const size_t line_count)
+{
+    const Scene& scene = Application::getInstance().current_slice_->scene;
+    for (const Settings* settings : std::initializer_list<const Settings*>{ &scene.current_mesh_group->settings, &scene.settings })
+    {
+        if (settings->has("travel_order_refinement_moves"))
+        {
+            return settings->get<size_t>("travel_order_refinement_moves") * line_count;
+        }
+    }
+    return 0;
+}
+
 template<class LineType>
 void LayerPlan::addLinesByOptimizer(
     const LinesSet<LineType>& lines,
@@ -1283,36 +1496,23 @@ void LayerPlan::addLinesByOptimizer(
     const bool reverse_print_direction,
     const std::unordered_multimap<const Polyline*, const Polyline*>& order_requirements)
 {
-    Shape boundary;
-    if (enable_travel_optimization && ! comb_boundary_minimum_.empty())
-    {
-        // use the combing boundary inflated so that all infill lines are inside the boundary
-        int dist = 0;
-        if (layer_nr_ >= 0)
-        {
-            // determine how much the skin/infill lines overlap the combing boundary
-            for (const std::shared_ptr<SliceMeshStorage>& mesh : storage_.meshes)
-            {
-                const coord_t overlap = std::max(mesh->settings.get<coord_t>("skin_overlap_mm"), mesh->settings.get<coord_t>("infill_overlap_mm"));
-                if (overlap > dist)
-                {
-                    dist = overlap;
-                }
-            }
-            dist += 100; // ensure boundary is slightly outside all skin/infill lines
-        }
-        boundary.push_back(comb_boundary_minimum_.offset(dist));
-        // simplify boundary to cut down processing time
-        boundary = Simplify(MM2INT(0.1), MM2INT(0.1), 0).polygon(boundary);
-    }
+    const Shape* boundary = enable_travel_optimization ? getTravelOptimizationBoundary() : nullptr;
     constexpr bool detect_loops = true;
     PathOrderOptimizer<const Polyline*> order_optimizer(
         near_start_location.value_or(getLastPlannedPositionOrStartingPosition()),
         ZSeamConfig(),
         detect_loops,
-        &boundary,
+        boundary,
         reverse_print_direction,
         order_requirements);
+    if (boundary != nullptr)
+    {
+        order_optimizer.setCombingGrid(travel_optimization_grid_);
+    }
+    if (enable_travel_optimization)
+    {
+        order_optimizer.setRefinementBudget(getTravelOrderRefinementBudget(lines.size()));
+    }
     if constexpr (std::is_same<LineType, OpenPolyline>::value)
     {
         for (const OpenPolyline& polyline : lines)
@@ -1344,36 +1544,23 @@ void LayerPlan::addLinesByOptimizer(
     const bool reverse_print_direction,
     const std::unordered_multimap<const Polyline*, const Polyline*>& order_requirements)
 {
-    Shape boundary;
-    if (enable_travel_optimization && ! comb_boundary_minimum_.empty())
-    {
-        // use the combing boundary inflated so that all infill lines are inside the boundary
-        int dist = 0;
-        if (layer_nr_ >= 0)
-        {
-            // determine how much the skin/infill lines overlap the combing boundary
-            for (const std::shared_ptr<SliceMeshStorage>& mesh : storage_.meshes)
-            {
-                const coord_t overlap = std::max(mesh->settings.get<coord_t>("skin_overlap_mm"), mesh->settings.get<coord_t>("infill_overlap_mm"));
-                if (overlap > dist)
-                {
-                    dist = overlap;
-                }
-            }
-            dist += 100; // ensure boundary is slightly outside all skin/infill lines
-        }
-        boundary.push_back(comb_boundary_minimum_.offset(dist));
-        // simplify boundary to cut down processing time
-        boundary = Simplify(MM2INT(0.1), MM2INT(0.1), 0).polygon(boundary);
-    }
+    const Shape* boundary = enable_travel_optimization ? getTravelOptimizationBoundary() : nullptr;
     constexpr bool detect_loops = false; // We already know which lines are closed
     PathOrderOptimizer<const Polyline*> order_optimizer(
         near_start_location.value_or(getLastPlannedPositionOrStartingPosition()),
         ZSeamConfig(),
         detect_loops,
-        &boundary,
+        boundary,
         reverse_print_direction,
         order_requirements);
+    if (boundary != nullptr)
+    {
+        order_optimizer.setCombingGrid(travel_optimization_grid_);
+    }
+    if (enable_travel_optimization)
+    {
+        order_optimizer.setRefinementBudget(getTravelOrderRefinementBudget(lines.size()));
+    }
     for (const std::shared_ptr<const Polyline>& line : lines)
     {
         if (const std::shared_ptr<const OpenPolyline> open_line = dynamic_pointer_cast<const OpenPolyline>(line))
@@ -1595,6 +1782,7 @@ void LayerPlan::spiralizeWallSlice(
     const int n_points = wall.size();
     Shape last_wall_polygons;
     last_wall_polygons.push_back(last_wall);
+    const ShapeCoordinates last_wall_coordinates(last_wall_polygons); // Searched for the closest point of each point of the wall.
     const int max_dist2 = config.getLineWidth() * config.getLineWidth() * 4; // (2 * lineWidth)^2;
 
     double total_length = 0.0; // determine the length of the complete wall
@@ -1665,7 +1853,7 @@ void LayerPlan::spiralizeWallSlice(
         if (smooth_contours && ! is_bottom_layer && wall_point_idx < n_points)
         {
             // now find the point on the last wall that is closest to p
-            ClosestPointPolygon cpp = PolygonUtils::findClosest(p, last_wall_polygons);
+            ClosestPointPolygon cpp = last_wall_coordinates.findClosest(p);
 
             // if we found a point and it's not further away than max_dist2, use it
             if (cpp.isValid() && vSize2(cpp.location_ - p) <= max_dist2)
@@ -1721,13 +1909,9 @@ bool ExtruderPlan::forceMinimalLayerTime(double minTime, double time_other_extr_
     const double totalTime = travelTime + extrudeTime + time_other_extr_plans;
     constexpr double epsilon = 0.01;
 
-    double total_extrude_time_at_minimum_speed = 0.0;
-    double total_extrude_time_at_slowest_speed = 0.0;
-    for (GCodePath& path : paths_)
-    {
-        total_extrude_time_at_minimum_speed += path.estimates.extrude_time_at_minimum_speed;
-        total_extrude_time_at_slowest_speed += path.estimates.extrude_time_at_slowest_path_speed;
-    }
+    // Accumulated over the paths by computeNaiveTimeEstimates.
+    const double total_extrude_time_at_minimum_speed = estimates_.extrude_time_at_minimum_speed;
+    const double total_extrude_time_at_slowest_speed = estimates_.extrude_time_at_slowest_path_speed;
 
     if (totalTime < minTime - epsilon && extrudeTime > 0.0)
     {
@@ -1808,77 +1992,120 @@ std::pair<double, double> ExtruderPlan::getPointToPointTime(const Point2LL& p0,
 
 TimeMaterialEstimates ExtruderPlan::computeNaiveTimeEstimates(Point2LL starting_position)
 {
+    const size_t precomputed_start = precomputed_estimates_start_.value_or(paths_.size());
+    if (! precomputed_estimates_start_)
+    {
+        slowest_path_speed_ = computeSlowestPathSpeed();
+    }
+    precomputed_estimates_start_.reset();
+
     Point2LL p0 = starting_position;
+    for (size_t path_idx = 0; path_idx < precomputed_start; path_idx++)
+    {
+        computeNaiveTimeEstimates(paths_[path_idx], p0);
+    }
+    for (const GCodePath& path : paths_)
+    {
+        estimates_ += path.estimates;
+    }
+    return estimates_;
+}
 
-    const double min_path_speed = fan_speed_layer_time_settings_.cool_min_speed;
-    slowest_path_speed_ = std::accumulate(
+void ExtruderPlan::precomputeNaiveTimeEstimates()
+{
+    slowest_path_speed_ = computeSlowestPathSpeed();
+
+    const auto first_with_points = std::find_if(
         paths_.begin(),
         paths_.end(),
-        std::numeric_limits<double>::max(),
-        [](double value, const GCodePath& path)
+        [](const GCodePath& path)
         {
-            return path.isTravelPath() ? value : std::min(value, path.config.getSpeed().value * path.speed_factor);
+            return ! path.points.empty();
         });
+    if (first_with_points == paths_.end())
+    {
+        precomputed_estimates_start_ = paths_.size();
+        return;
+    }
+    precomputed_estimates_start_ = std::distance(paths_.begin(), first_with_points) + 1;
 
-    bool was_retracted = false; // wrong assumption; won't matter that much. (TODO)
-    for (GCodePath& path : paths_)
+    Point2LL p0 = first_with_points->points.back();
+    for (size_t path_idx = *precomputed_estimates_start_; path_idx < paths_.size(); path_idx++)
     {
-        bool is_extrusion_path = false;
-        double* path_time_estimate;
-        double& material_estimate = path.estimates.material;
+        computeNaiveTimeEstimates(paths_[path_idx], p0);
+    }
+}
 
-        path.estimates.extrude_time_at_minimum_speed = 0.0;
-        path.estimates.extrude_time_at_slowest_path_speed = 0.0;
+void ExtruderPlan::computeNaiveTimeEstimates(GCodePath& path, Point2LL& p0)
+{
+    const double min_path_speed = fan_speed_layer_time_settings_.cool_min_speed;
+    constexpr bool was_retracted = false; // wrong assumption; won't matter that much. (TODO)
 
-        if (! path.isTravelPath())
+    bool is_extrusion_path = false;
+    double* path_time_estimate;
+    double& material_estimate = path.estimates.material;
+
+    path.estimates.extrude_time_at_minimum_speed = 0.0;
+    path.estimates.extrude_time_at_slowest_path_speed = 0.0;
+
+    if (! path.isTravelPath())
+    {
+        is_extrusion_path = true;
+        path_time_estimate = &path.estimates.extrude_time;
+    }
+    else
+    {
+        if (path.retract)
         {
-            is_extrusion_path = true;
-            path_time_estimate = &path.estimates.extrude_time;
+            path_time_estimate = &path.estimates.retracted_travel_time;
         }
         else
         {
+            path_time_estimate = &path.estimates.unretracted_travel_time;
+        }
+        if (path.retract != was_retracted)
+        { // handle retraction times
+            double retract_unretract_time;
             if (path.retract)
             {
-                path_time_estimate = &path.estimates.retracted_travel_time;
+                retract_unretract_time = retraction_config_.distance / retraction_config_.speed;
             }
             else
             {
-                path_time_estimate = &path.estimates.unretracted_travel_time;
-            }
-            if (path.retract != was_retracted)
-            { // handle retraction times
-                double retract_unretract_time;
-                if (path.retract)
-                {
-                    retract_unretract_time = retraction_config_.distance / retraction_config_.speed;
-                }
-                else
-                {
-                    retract_unretract_time = retraction_config_.distance / retraction_config_.primeSpeed;
-                }
-                path.estimates.retracted_travel_time += 0.5 * retract_unretract_time;
-                path.estimates.unretracted_travel_time += 0.5 * retract_unretract_time;
+                retract_unretract_time = retraction_config_.distance / retraction_config_.primeSpeed;
             }
+            path.estimates.retracted_travel_time += 0.5 * retract_unretract_time;
+            path.estimates.unretracted_travel_time += 0.5 * retract_unretract_time;
         }
-        for (Point2LL& p1 : path.points)
+    }
+    for (Point2LL& p1 : path.points)
+    {
+        double length = vSizeMM(p0 - p1);
+        if (is_extrusion_path)
         {
-            double length = vSizeMM(p0 - p1);
-            if (is_extrusion_path)
+            if (length > 0)
             {
-                if (length > 0)
-                {
-                    path.estimates.extrude_time_at_minimum_speed += length / min_path_speed;
-                    path.estimates.extrude_time_at_slowest_path_speed += length / slowest_path_speed_;
-                }
-                material_estimate += length * INT2MM(layer_thickness_) * INT2MM(path.config.getLineWidth());
+                path.estimates.extrude_time_at_minimum_speed += length / min_path_speed;
+                path.estimates.extrude_time_at_slowest_path_speed += length / slowest_path_speed_;
             }
-            double thisTime = length / (path.config.getSpeed() * path.speed_factor);
-            *path_time_estimate += thisTime;
-            p0 = p1;
+            material_estimate += length * INT2MM(layer_thickness_) * INT2MM(path.config.getLineWidth());
         }
-        estimates_ += path.estimates;
+        double thisTime = length / (path.config.getSpeed() * path.speed_factor);
+        *path_time_estimate += thisTime;
+        p0 = p1;
     }
-    return estimates_;
+}
+
+double ExtruderPlan::computeSlowestPathSpeed() const
+{
+    return std::accumulate(
+        paths_.begin(),
+        paths_.end(),
+        std::numeric_limits<double>::max(),
+        [](double value, const GCodePath& path)
+        {
+            return path.isTravelPath() ? value : std::min(value, path.config.getSpeed().value * path.speed_factor);
+        });
 }
 
 void ExtruderPlan::processFanSpeedForMinimalLayerTime(Duration minTime, double time_other_extr_plans)
@@ -1983,7 +2210,9 @@ void LayerPlan::processFanSpeedAndMinimalLayerTime(Point2LL starting_position)
 
 void LayerPlan::writeGCode(GCodeExport& gcode)
 {
+    CURA_TRACE_SPAN("LayerPlan::writeGCode");
     Communication* communication = Application::getInstance().communication_;
+    const bool send_layer_view = communication->wantsLayerView();
     communication->setLayerForSend(layer_nr_);
     communication->sendCurrentPosition(gcode.getPositionXY());
     gcode.setLayerNr(layer_nr_);
@@ -1991,7 +2220,7 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
     gcode.writeLayerComment(layer_nr_);
     if (min_layer_time_used)
     {
-        gcode.writeComment("note -- min layer time used");
+        gcode.writeDetailComment("note -- min layer time used");
     }
 
     // flow-rate compensation
@@ -2222,7 +2451,7 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
                 gcode.writeTypeComment(path.config.type);
                 if (path.config.isBridgePath())
                 {
-                    gcode.writeComment("BRIDGE");
+                    gcode.writeDetailComment("BRIDGE");
                 }
                 last_extrusion_config = path.config;
                 update_extrusion_offset = true;
@@ -2241,9 +2470,7 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
             if (path.mesh != current_mesh)
             {
                 current_mesh = path.mesh;
-                std::stringstream ss;
-                ss << "MESH:" << (current_mesh ? current_mesh->mesh_name : "NONMESH");
-                gcode.writeComment(ss.str());
+                gcode.writeDetailComment("MESH:" + (current_mesh ? current_mesh->mesh_name : std::string("NONMESH")));
             }
 
             if (! path.spiralize && (! path.retract || ! path.perform_z_hop) && (z_ + path.z_offset != gcode.getPositionZ()) && (path_idx > 0 || layer_nr_ > 0))
@@ -2290,18 +2517,55 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
                 bool coasting = extruder.settings_.get<bool>("coasting_enable");
                 if (coasting)
                 {
-                    coasting = writePathWithCoasting(gcode, extruder_plan_idx, path_idx, layer_thickness_, insertTempOnTime);
+                    coasting = writePathWithCoasting(gcode, extruder_plan_idx, path_idx, insertTempOnTime);
                 }
                 if (! coasting) // not same as 'else', cause we might have changed [coasting] in the line above...
                 { // normal path to gcode algorithm
                     Point2LL prev_point = gcode.getPositionXY();
+                    const double extrude_speed = speed * path.speed_back_pressure_factor;
+
+                    // Temperature inserts are timed per point, so they would end up after an arc instead of in it.
+                    std::vector<ArcFitter::Arc> arcs;
+                    if (gcode.getArcFittingTolerance() > 0 && ! extruder_plan.hasPendingInserts())
+                    {
+                        arcs = ArcFitter(gcode.getArcFittingTolerance()).fit(prev_point, path.points);
+                    }
+                    auto next_arc = arcs.begin();
+
                     for (unsigned int point_idx = 0; point_idx < path.points.size(); point_idx++)
                     {
-                        const auto [_, time] = extruder_plan.getPointToPointTime(prev_point, path.points[point_idx], path);
-                        insertTempOnTime(time, path_idx);
+                        if (next_arc != arcs.end() && next_arc->first_point_idx == point_idx)
+                        {
+                            for (size_t arc_point_idx = point_idx; send_layer_view && arc_point_idx <= next_arc->last_point_idx; arc_point_idx++)
+                            {
+                                // The layer view still shows the original points, which are on the arc.
+                                communication->sendLineTo(path.config.type, path.points[arc_point_idx], path.getLineWidthForLayerView(), path.config.getLayerThickness(), extrude_speed);
+                            }
+                            point_idx = next_arc->last_point_idx;
+                            gcode.writeArcExtrusion(
+                                path.points[point_idx],
+                                next_arc->center,
+                                next_arc->counter_clockwise,
+                                extrude_speed,
+                                path.getExtrusionMM3perMM(),
+                                path.config.type,
+                                update_extrusion_offset);
+
+                            prev_point = path.points[point_idx];
+                            ++next_arc;
+                            continue;
+                        }
 
-                        const double extrude_speed = speed * path.speed_back_pressure_factor;
-                        communication->sendLineTo(path.config.type, path.points[point_idx], path.getLineWidthForLayerView(), path.config.getLayerThickness(), extrude_speed);
+                        if (extruder_plan.hasPendingInserts())
+                        {
+                            const auto [_, time] = extruder_plan.getPointToPointTime(prev_point, path.points[point_idx], path);
+                            insertTempOnTime(time, path_idx);
+                        }
+
+                        if (send_layer_view)
+                        {
+                            communication->sendLineTo(path.config.type, path.points[point_idx], path.getLineWidthForLayerView(), path.config.getLayerThickness(), extrude_speed);
+                        }
                         gcode.writeExtrusion(path.points[point_idx], extrude_speed, path.getExtrusionMM3perMM(), path.config.type, update_extrusion_offset);
 
                         prev_point = path.points[point_idx];
@@ -2338,12 +2602,15 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
                         gcode.setZ(std::round(z_ + layer_thickness_ * length / totalLength));
 
                         const double extrude_speed = speed * spiral_path.speed_back_pressure_factor;
-                        communication->sendLineTo(
-                            spiral_path.config.type,
-                            spiral_path.points[point_idx],
-                            spiral_path.getLineWidthForLayerView(),
-                            spiral_path.config.getLayerThickness(),
-                            extrude_speed);
+                        if (send_layer_view)
+                        {
+                            communication->sendLineTo(
+                                spiral_path.config.type,
+                                spiral_path.points[point_idx],
+                                spiral_path.getLineWidthForLayerView(),
+                                spiral_path.config.getLayerThickness(),
+                                extrude_speed);
+                        }
                         gcode.writeExtrusion(spiral_path.points[point_idx], extrude_speed, spiral_path.getExtrusionMM3perMM(), spiral_path.config.type, update_extrusion_offset);
                     }
                     // for layer display only - the loop finished at the seam vertex but as we started from
@@ -2355,8 +2622,15 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
                     // vertex would not be shifted (as it's the last vertex in the sequence). The smoother the model,
                     // the less the vertices are shifted and the less obvious is the ridge. If the layer display
                     // really displayed a spiral rather than slices of a spiral, this would not be required.
-                    communication
-                        ->sendLineTo(spiral_path.config.type, spiral_path.points[0], spiral_path.getLineWidthForLayerView(), spiral_path.config.getLayerThickness(), speed);
+                    if (send_layer_view)
+                    {
+                        communication->sendLineTo(
+                            spiral_path.config.type,
+                            spiral_path.points[0],
+                            spiral_path.getLineWidthForLayerView(),
+                            spiral_path.config.getLayerThickness(),
+                            speed);
+                    }
                 }
                 path_idx--; // the last path_idx didnt spiralize, so it's not part of the current spiralize path
             }
@@ -2364,7 +2638,7 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
 
         if (extruder.settings_.get<bool>("cool_lift_head") && extruder_plan.extra_time_ > 0.0)
         {
-            gcode.writeComment("Small layer, adding delay");
+            gcode.writeDetailComment("Small layer, adding delay");
             const RetractionAndWipeConfig& actual_retraction_config
                 = current_mesh ? current_mesh->retraction_wipe_config : storage_.retraction_wipe_config_per_extruder[gcode.getExtruderNr()];
             gcode.writeRetraction(actual_retraction_config.retraction_config);
@@ -2435,36 +2709,35 @@ bool LayerPlan::makeRetractSwitchRetract(unsigned int extruder_plan_idx, unsigne
     }
 }
 
-bool LayerPlan::writePathWithCoasting(
-    GCodeExport& gcode,
-    const size_t extruder_plan_idx,
-    const size_t path_idx,
-    const coord_t layer_thickness,
-    const std::function<void(const double, const int64_t)> insertTempOnTime)
+void LayerPlan::planCoasting()
 {
-    ExtruderPlan& extruder_plan = extruder_plans_[extruder_plan_idx];
-    const ExtruderTrain& extruder = Application::getInstance().current_slice_->scene.extruders[extruder_plan.extruder_nr_];
-    const double coasting_volume = extruder.settings_.get<double>("coasting_volume");
-    if (coasting_volume <= 0)
-    {
-        return false;
-    }
-    const std::vector<GCodePath>& paths = extruder_plan.paths_;
-    const GCodePath& path = paths[path_idx];
-    if (path_idx + 1 >= paths.size() || (path.isTravelPath() || ! paths[path_idx + 1].config.isTravelPath()) || path.points.size() < 2)
+    for (ExtruderPlan& extruder_plan : extruder_plans_)
     {
-        return false;
+        const ExtruderTrain& extruder = Application::getInstance().current_slice_->scene.extruders[extruder_plan.extruder_nr_];
+        const double coasting_volume = extruder.settings_.get<double>("coasting_volume");
+        const bool coasting_enabled = extruder.settings_.get<bool>("coasting_enable") && coasting_volume > 0;
+        const double coasting_min_volume = extruder.settings_.get<double>("coasting_min_volume");
+        for (GCodePath& path : extruder_plan.paths_)
+        {
+            // Whether a travel follows is only checked when writing, since the travel to the next layer is only added later.
+            path.coasting_split.reset();
+            if (coasting_enabled && ! path.isTravelPath() && ! path.spiralize && path.points.size() >= 2)
+            {
+                path.coasting_split = computeCoastingSplit(path, coasting_volume, coasting_min_volume);
+            }
+        }
     }
+    coasting_planned_ = true;
+}
 
+std::optional<GCodePath::CoastingSplit> LayerPlan::computeCoastingSplit(const GCodePath& path, const double coasting_volume, const double coasting_min_volume) const
+{
     coord_t coasting_min_dist_considered = MM2INT(0.1); // hardcoded setting for when to not perform coasting
 
-    const double extrude_speed = path.config.getSpeed() * path.speed_factor * path.speed_back_pressure_factor;
-
     const coord_t coasting_dist
-        = MM2INT(MM2_2INT(coasting_volume) / layer_thickness) / path.config.getLineWidth(); // closing brackets of MM2INT at weird places for precision issues
-    const double coasting_min_volume = extruder.settings_.get<double>("coasting_min_volume");
+        = MM2INT(MM2_2INT(coasting_volume) / layer_thickness_) / path.config.getLineWidth(); // closing brackets of MM2INT at weird places for precision issues
     const coord_t coasting_min_dist
-        = MM2INT(MM2_2INT(coasting_min_volume + coasting_volume) / layer_thickness) / path.config.getLineWidth(); // closing brackets of MM2INT at weird places for precision issues
+        = MM2INT(MM2_2INT(coasting_min_volume + coasting_volume) / layer_thickness_) / path.config.getLineWidth(); // closing brackets of MM2INT at weird places for precision issues
     //           /\ the minimal distance when coasting will coast the full coasting volume instead of linearly less with linearly smaller paths
 
     std::vector<coord_t> accumulated_dist_per_point; // the first accumulated dist is that of the last point! (that of the last point is always zero...)
@@ -2501,7 +2774,7 @@ bool LayerPlan::writePathWithCoasting(
 
     if (accumulated_dist < coasting_min_dist_considered)
     {
-        return false;
+        return std::nullopt;
     }
     coord_t actual_coasting_dist = coasting_dist;
     if (length_is_less_than_min_dist)
@@ -2510,7 +2783,7 @@ bool LayerPlan::writePathWithCoasting(
         actual_coasting_dist = accumulated_dist * coasting_dist / coasting_min_dist;
         if (actual_coasting_dist == 0) // Downscaling due to Minimum Coasting Distance reduces coasting to less than 1 micron.
         {
-            return false; // Skip coasting at all then.
+            return std::nullopt; // Skip coasting at all then.
         }
         for (acc_dist_idx_gt_coast_dist = 1; acc_dist_idx_gt_coast_dist.value() < accumulated_dist_per_point.size(); acc_dist_idx_gt_coast_dist.value()++)
         { // search for the correct coast_dist_idx
@@ -2526,36 +2799,66 @@ bool LayerPlan::writePathWithCoasting(
 
     const size_t point_idx_before_start = path.points.size() - 1 - acc_dist_idx_gt_coast_dist.value();
 
-    Point2LL start;
-    { // computation of begin point of coasting
-        const coord_t residual_dist = actual_coasting_dist - accumulated_dist_per_point[acc_dist_idx_gt_coast_dist.value() - 1];
-        const Point2LL& a = path.points[point_idx_before_start];
-        const Point2LL& b = path.points[point_idx_before_start + 1];
-        start = b + normal(a - b, residual_dist);
+    // computation of begin point of coasting
+    const coord_t residual_dist = actual_coasting_dist - accumulated_dist_per_point[acc_dist_idx_gt_coast_dist.value() - 1];
+    const Point2LL& a = path.points[point_idx_before_start];
+    const Point2LL& b = path.points[point_idx_before_start + 1];
+    return GCodePath::CoastingSplit{ .point_idx_before_start = point_idx_before_start, .start = b + normal(a - b, residual_dist) };
+}
+
+bool LayerPlan::writePathWithCoasting(GCodeExport& gcode, const size_t extruder_plan_idx, const size_t path_idx, const std::function<void(const double, const int64_t)> insertTempOnTime)
+{
+    if (! coasting_planned_)
+    {
+        planCoasting();
+    }
+    ExtruderPlan& extruder_plan = extruder_plans_[extruder_plan_idx];
+    const ExtruderTrain& extruder = Application::getInstance().current_slice_->scene.extruders[extruder_plan.extruder_nr_];
+    const std::vector<GCodePath>& paths = extruder_plan.paths_;
+    const GCodePath& path = paths[path_idx];
+    if (! path.coasting_split || path_idx + 1 >= paths.size() || ! paths[path_idx + 1].config.isTravelPath())
+    {
+        return false;
     }
+    const size_t point_idx_before_start = path.coasting_split->point_idx_before_start;
+    const Point2LL& start = path.coasting_split->start;
+    const double extrude_speed = path.config.getSpeed() * path.speed_factor * path.speed_back_pressure_factor;
 
     Point2LL prev_pt = gcode.getPositionXY();
     { // write normal extrude path:
         Communication* communication = Application::getInstance().communication_;
+        const bool send_layer_view = communication->wantsLayerView();
         for (size_t point_idx = 0; point_idx <= point_idx_before_start; point_idx++)
         {
-            auto [_, time] = extruder_plan.getPointToPointTime(prev_pt, path.points[point_idx], path);
-            insertTempOnTime(time, path_idx);
+            if (extruder_plan.hasPendingInserts())
+            {
+                auto [_, time] = extruder_plan.getPointToPointTime(prev_pt, path.points[point_idx], path);
+                insertTempOnTime(time, path_idx);
+            }
 
-            communication->sendLineTo(path.config.type, path.points[point_idx], path.getLineWidthForLayerView(), path.config.getLayerThickness(), extrude_speed);
+            if (send_layer_view)
+            {
+                communication->sendLineTo(path.config.type, path.points[point_idx], path.getLineWidthForLayerView(), path.config.getLayerThickness(), extrude_speed);
+            }
             gcode.writeExtrusion(path.points[point_idx], extrude_speed, path.getExtrusionMM3perMM(), path.config.type);
 
             prev_pt = path.points[point_idx];
         }
-        communication->sendLineTo(path.config.type, start, path.getLineWidthForLayerView(), path.config.getLayerThickness(), extrude_speed);
+        if (send_layer_view)
+        {
+            communication->sendLineTo(path.config.type, start, path.getLineWidthForLayerView(), path.config.getLayerThickness(), extrude_speed);
+        }
         gcode.writeExtrusion(start, extrude_speed, path.getExtrusionMM3perMM(), path.config.type);
     }
 
     // write coasting path
     for (size_t point_idx = point_idx_before_start + 1; point_idx < path.points.size(); point_idx++)
     {
-        auto [_, time] = extruder_plan.getPointToPointTime(prev_pt, path.points[point_idx], path);
-        insertTempOnTime(time, path_idx);
+        if (extruder_plan.hasPendingInserts())
+        {
+            auto [_, time] = extruder_plan.getPointToPointTime(prev_pt, path.points[point_idx], path);
+            insertTempOnTime(time, path_idx);
+        }
 
         const Ratio coasting_speed_modifier = extruder.settings_.get<Ratio>("coasting_speed");
         const Velocity speed = Velocity(coasting_speed_modifier * path.config.getSpeed());
@@ -2568,6 +2871,9 @@ bool LayerPlan::writePathWithCoasting(
 
 void LayerPlan::applyModifyPlugin()
 {
+    // Send the requests for all extruder plans at once, so that the round trips to the plugin overlap.
+    std::vector<std::tuple<std::vector<GCodePath>&, size_t, LayerIndex>> calls;
+    calls.reserve(extruder_plans_.size());
     for (auto& extruder_plan : extruder_plans_)
     {
         scripta::log(
@@ -2588,8 +2894,13 @@ void LayerPlan::applyModifyPlugin()
             scripta::CellVDI{ "is_travel_path", &GCodePath::isTravelPath },
             scripta::CellVDI{ "extrusion_mm3_per_mm", &GCodePath::getExtrusionMM3perMM });
 
-        extruder_plan.paths_ = slots::instance().modify<plugins::v0::SlotID::GCODE_PATHS_MODIFY>(extruder_plan.paths_, extruder_plan.extruder_nr_, layer_nr_);
+        calls.emplace_back(extruder_plan.paths_, extruder_plan.extruder_nr_, layer_nr_);
+    }
+
+    slots::instance().modifyAll<plugins::v0::SlotID::GCODE_PATHS_MODIFY>(calls);
 
+    for (auto& extruder_plan : extruder_plans_)
+    {
         scripta::log(
             "extruder_plan_1",
             extruder_plan.paths_,
@@ -2610,6 +2921,31 @@ void LayerPlan::applyModifyPlugin()
     }
 }
 
+size_t LayerPlan::estimateMemoryUsage() const
+{
+    size_t bytes = sizeof(LayerPlan);
+    for (const ExtruderPlan& extruder_plan : extruder_plans_)
+    {
+        bytes += sizeof(ExtruderPlan);
+        for (const GCodePath& path : extruder_plan.paths_)
+        {
+            bytes += sizeof(GCodePath) + path.points.capacity() * sizeof(Point2LL);
+        }
+    }
+    // The comber keeps its own copies of the boundaries, with grids on top.
+    constexpr size_t copies_of_boundaries = 3;
+    bytes += (comb_boundary_minimum_.pointCount() + comb_boundary_preferred_.pointCount()) * sizeof(Point2LL) * copies_of_boundaries;
+    return bytes;
+}
+
+void LayerPlan::precomputeNaiveTimeEstimates()
+{
+    for (ExtruderPlan& extruder_plan : extruder_plans_)
+    {
+        extruder_plan.precomputeNaiveTimeEstimates();
+    }
+}
+
 void LayerPlan::applyBackPressureCompensation()
 {
     for (auto& extruder_plan : extruder_plans_)
@@ -2655,22 +2991,69 @@ size_t LayerPlan::getExtruder() const
 
 void LayerPlan::setBridgeWallMask(const Shape& polys)
 {
-    bridge_wall_mask_ = polys;
+    bridge_wall_mask_.set(polys);
+    air_below_mask_is_set_ = false;
 }
 
 void LayerPlan::setOverhangMask(const Shape& polys)
 {
-    overhang_mask_ = polys;
+    overhang_mask_.set(polys);
 }
 
 void LayerPlan::setSeamOverhangMask(const Shape& polys)
 {
     seam_overhang_mask_ = polys;
+    air_below_mask_is_set_ = false;
 }
 
 void LayerPlan::setRoofingMask(const Shape& polys)
 {
-    roofing_mask_ = polys;
+    roofing_mask_.set(polys);
+}
+
+void LayerPlan::IndexedMask::set(const Shape& shape)
+{
+    coordinates_.reset();
+    segment_grid_.reset();
+    shape_ = shape;
+}
+
+const Shape& LayerPlan::IndexedMask::shape() const
+{
+    return shape_;
+}
+
+bool LayerPlan::IndexedMask::empty() const
+{
+    return shape_.empty();
+}
+
+bool LayerPlan::IndexedMask::inside(const Point2LL& p) const
+{
+    if (shape_.empty())
+    {
+        return false;
+    }
+    if (! coordinates_)
+    {
+        constexpr bool index_edges = true;
+        coordinates_.emplace(shape_, index_edges);
+    }
+    constexpr bool border_result = true;
+    return coordinates_->inside(p, border_result);
+}
+
+bool LayerPlan::IndexedMask::collidesWithLineSegment(const Point2LL& from, const Point2LL& to) const
+{
+    if (shape_.empty() || from == to)
+    {
+        return false; // Zero-length line segments never collide.
+    }
+    if (! segment_grid_)
+    {
+        segment_grid_ = PolygonUtils::createLocToLineGrid(shape_, segment_grid_cell_size);
+    }
+    return PolygonUtils::polygonCollidesWithLineSegment(from, to, *segment_grid_);
 }
 
 template void LayerPlan::addLinesByOptimizer(
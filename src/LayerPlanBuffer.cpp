@@ -3,6 +3,8 @@
 
 #include "LayerPlanBuffer.h"
 
+#include <algorithm>
+
 #include <spdlog/spdlog.h>
 
 #include "Application.h" //To flush g-code through the communication channel.
@@ -19,6 +21,11 @@ namespace cura
 
 constexpr Duration LayerPlanBuffer::extra_preheat_time_;
 
+void LayerPlanBuffer::setBufferSize(const size_t buffer_size)
+{
+    buffer_size_ = std::max(buffer_size, min_buffer_size_);
+}
+
 void LayerPlanBuffer::push(LayerPlan& layer_plan)
 {
     buffer_.push_back(&layer_plan);
@@ -3,10 +3,25 @@
 
 #include "MeshGroup.h"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <initializer_list>
 #include <limits>
+#include <mutex>
+#include <optional>
 #include <stdio.h>
 #include <string.h>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <fmt/format.h>
 #include <range/v3/view/enumerate.hpp>
 #include <scripta/logger.h>
@@ -15,6 +30,9 @@
 #include "settings/types/Ratio.h" //For the shrinkage percentage and scale factor.
 #include "utils/Matrix4x3D.h" //To transform the input meshes for shrinkage compensation and to align in command line mode.
 #include "utils/Point3F.h" //To accept incoming meshes with floating point vertices.
+#include "utils/Point3D.h"
+#include "utils/ThreadPool.h"
+#include "utils/ZipArchive.h"
 #include "utils/gettime.h"
 #include "utils/section_type.h"
 #include "utils/string.h"
@@ -172,28 +190,32 @@ bool loadMeshSTL_ascii(Mesh* mesh, const char* filename, const Matrix4x3D& matri
 
 bool loadMeshSTL_binary(Mesh* mesh, const char* filename, const Matrix4x3D& matrix)
 {
-    FILE* f = fopen(filename, "rb");
-
-    fseek(f, 0L, SEEK_END);
-    long long file_size = ftell(f); // The file size is the position of the cursor after seeking to the end.
-    rewind(f); // Seek back to start.
-    size_t face_count = (file_size - 80 - sizeof(uint32_t)) / 50; // Subtract the size of the header. Every face uses exactly 50 bytes.
+    constexpr size_t header_size = 80 + sizeof(uint32_t);
+    constexpr size_t face_size = 50;
 
-    char buffer[80];
-    // Skip the header
-    if (fread(buffer, 80, 1, f) != 1)
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+    try
     {
-        fclose(f);
+        file = boost::interprocess::file_mapping(filename, boost::interprocess::read_only);
+        region = boost::interprocess::mapped_region(file, boost::interprocess::read_only);
+    }
+    catch (const boost::interprocess::interprocess_exception& exception)
+    {
+        spdlog::error("Failed to map STL file {}: {}", filename, exception.what());
         return false;
     }
-
-    uint32_t reported_face_count;
-    // Read the face count. We'll use it as a sort of redundancy code to check for file corruption.
-    if (fread(&reported_face_count, sizeof(uint32_t), 1, f) != 1)
+    const char* data = static_cast<const char*>(region.get_address());
+    const size_t file_size = region.get_size();
+    if (file_size < header_size)
     {
-        fclose(f);
         return false;
     }
+    const size_t face_count = (file_size - header_size) / face_size; // Every face uses exactly 50 bytes.
+
+    uint32_t reported_face_count;
+    // Read the face count. We'll use it as a sort of redundancy code to check for file corruption.
+    std::memcpy(&reported_face_count, data + 80, sizeof(uint32_t));
     if (reported_face_count != face_count)
     {
         spdlog::warn("Face count reported by file ({}) is not equal to actual face count ({}). File could be corrupt!", reported_face_count, face_count);
@@ -202,85 +224,294 @@ bool loadMeshSTL_binary(Mesh* mesh, const char* filename, const Matrix4x3D& matr
     // For each face read:
     // float(x,y,z) = normal, float(X,Y,Z)*3 = vertexes, uint16_t = flags
     //  Every Face is 50 Bytes: Normal(3*float), Vertices(9*float), 2 Bytes Spacer
-    mesh->faces_.reserve(face_count);
-    mesh->vertices_.reserve(face_count);
-    for (size_t i = 0; i < face_count; i++)
+    // The faces are independent of each other, so they are decoded and transformed in parallel.
+    std::vector<Point3LL> corners(face_count * 3);
+    cura::parallel_for<size_t>(
+        0,
+        face_count,
+        [&](const size_t face_idx)
+        {
+            float v[9];
+            std::memcpy(v, data + header_size + face_idx * face_size + 3 * sizeof(float), sizeof(v));
+            corners[face_idx * 3 + 0] = matrix.apply(Point3F(v[0], v[1], v[2]).toPoint3d());
+            corners[face_idx * 3 + 1] = matrix.apply(Point3F(v[3], v[4], v[5]).toPoint3d());
+            corners[face_idx * 3 + 2] = matrix.apply(Point3F(v[6], v[7], v[8]).toPoint3d());
+        },
+        1024);
+
+    mesh->addFaces(std::move(corners));
+    mesh->finish();
+    return true;
+}
+
+namespace
+{
+/*!
+ * Parse a decimal floating point number, like "-12.345" or "1.5e-3".
+ *
+ * This is a lot faster than sscanf, since it doesn't need to deal with locales
+ * or a format string, and it doesn't need the input to be null-terminated.
+ * \param cursor The position to start parsing at. Leading spaces and tabs are
+ * skipped. Advanced to just past the number if successful.
+ * \param end The end of the text that may be parsed.
+ * \param result The parsed number.
+ * \return Whether a number was found.
+ */
+bool parseFloat(const char*& cursor, const char* end, double& result)
+{
+    const char* c = cursor;
+    while (c < end && (*c == ' ' || *c == '\t'))
+    {
+        c++;
+    }
+    bool negative = false;
+    if (c < end && (*c == '-' || *c == '+'))
+    {
+        negative = *c == '-';
+        c++;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int num_digits = 0;
+    constexpr int max_significant_digits = 18; // Keep the mantissa within the range of uint64_t.
+    for (; c < end && *c >= '0' && *c <= '9'; c++, num_digits++)
     {
-        if (fread(buffer, 50, 1, f) != 1)
+        if (num_digits < max_significant_digits)
         {
-            fclose(f);
-            return false;
+            mantissa = mantissa * 10 + (*c - '0');
+        }
+        else
+        {
+            exponent++;
         }
-        float* v = reinterpret_cast<float*>(buffer) + 3;
+    }
+    if (c < end && *c == '.')
+    {
+        c++;
+        for (; c < end && *c >= '0' && *c <= '9'; c++, num_digits++)
+        {
+            if (num_digits < max_significant_digits)
+            {
+                mantissa = mantissa * 10 + (*c - '0');
+                exponent--;
+            }
+        }
+    }
+    if (num_digits == 0)
+    {
+        return false;
+    }
+    if (c < end && (*c == 'e' || *c == 'E'))
+    {
+        const char* exponent_start = c + 1;
+        if (exponent_start < end && *exponent_start == '+')
+        {
+            exponent_start++; // from_chars doesn't accept a leading plus sign.
+        }
+        int written_exponent = 0;
+        const auto [exponent_end, error] = std::from_chars(exponent_start, end, written_exponent);
+        if (error == std::errc())
+        {
+            exponent += written_exponent;
+            c = exponent_end;
+        }
+    }
 
-        Point3LL v0 = matrix.apply(Point3F(v[0], v[1], v[2]).toPoint3d());
-        Point3LL v1 = matrix.apply(Point3F(v[3], v[4], v[5]).toPoint3d());
-        Point3LL v2 = matrix.apply(Point3F(v[6], v[7], v[8]).toPoint3d());
-        mesh->addFace(v0, v1, v2);
+    double value = static_cast<double>(mantissa);
+    if (exponent != 0)
+    {
+        static constexpr double powers_of_ten[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18 };
+        const int abs_exponent = std::abs(exponent);
+        const double scale = abs_exponent <= 18 ? powers_of_ten[abs_exponent] : std::pow(10.0, abs_exponent);
+        value = exponent < 0 ? value / scale : value * scale;
     }
-    fclose(f);
-    mesh->finish();
+    result = negative ? -value : value;
+    cursor = c;
+    return true;
+}
+
+/*!
+ * Parse an integer, skipping leading spaces and tabs.
+ * \return Whether an integer was found.
+ */
+bool parseInt(const char*& cursor, const char* end, int& result)
+{
+    const char* c = cursor;
+    while (c < end && (*c == ' ' || *c == '\t'))
+    {
+        c++;
+    }
+    if (c < end && *c == '+')
+    {
+        c++;
+    }
+    const auto [int_end, error] = std::from_chars(c, end, result);
+    if (error != std::errc())
+    {
+        return false;
+    }
+    cursor = int_end;
     return true;
 }
 
+/*!
+ * Incremental state of the fiber path TXT parser.
+ *
+ * Every line of a fiber path file contains "x y z index" in millimeters. Each
+ * consecutive run of points with the same z forms a fiber layer and each
+ * consecutive run of points with the same index within it forms a polyline.
+ */
+class FiberPathTXTParser
+{
+public:
+    FiberPathTXTParser(FiberPaths& fiberpaths)
+        : fiberpaths_(fiberpaths)
+    {
+    }
+
+    /*!
+     * Parse a single line. The line doesn't include the line ending.
+     */
+    void parseLine(const char* begin, const char* end)
+    {
+        const char* cursor = begin;
+        double fx, fy, fz;
+        int index;
+        if (! parseFloat(cursor, end, fx) || ! parseFloat(cursor, end, fy) || ! parseFloat(cursor, end, fz) || ! parseInt(cursor, end, index))
+        {
+            const bool is_blank = std::all_of(
+                begin,
+                end,
+                [](const char c)
+                {
+                    return std::isspace(static_cast<unsigned char>(c));
+                });
+            if (! is_blank)
+            {
+                constexpr size_t max_logged_length = 256;
+                spdlog::warn("Failed to parse line: {}", std::string_view(begin, std::min<size_t>(end - begin, max_logged_length)));
+            }
+            return;
+        }
+        const coord_t z = MM2INT(fz);
+
+        if (! has_layer_ || z != cur_fiberpath_.z_)
+        {
+            flushLayer();
+            cur_fiberpath_.z_ = z;
+            has_layer_ = true;
+            last_index_ = index;
+        }
+        else if (index != last_index_)
+        {
+            flushPolyline();
+            last_index_ = index;
+        }
+        cur_poly_.emplace_back(MM2INT(fx), MM2INT(fy));
+    }
+
+    /*!
+     * Store the layer that is still being parsed. Call this after the last line.
+     */
+    void finish()
+    {
+        flushLayer();
+    }
+
+private:
+    FiberPaths& fiberpaths_;
+    FiberPath cur_fiberpath_;
+    OpenPolyline cur_poly_;
+    bool has_layer_ = false;
+    int last_index_ = 0;
+    size_t poly_size_hint_ = 0; //!< The size of the previous polyline, to reserve space for the next one.
+    size_t layer_size_hint_ = 0; //!< The number of polylines in the previous layer, to reserve space for the next one.
+
+    void flushPolyline()
+    {
+        if (cur_poly_.size() > 1)
+        {
+            poly_size_hint_ = cur_poly_.size();
+            cur_fiberpath_.paths.push_back(std::move(cur_poly_));
+        }
+        cur_poly_ = OpenPolyline();
+        cur_poly_.reserve(poly_size_hint_);
+    }
+
+    void flushLayer()
+    {
+        flushPolyline();
+        if (! cur_fiberpath_.paths.empty())
+        {
+            layer_size_hint_ = cur_fiberpath_.paths.size();
+            fiberpaths_.paths.push_back(std::move(cur_fiberpath_));
+            fiberpaths_.sorted = false;
+        }
+        cur_fiberpath_ = FiberPath();
+        cur_fiberpath_.paths.reserve(layer_size_hint_);
+    }
+};
+} // namespace
+
 bool loadFiberPathTXT(FiberPaths* fiberpaths, const char* filename, const Matrix4x3D& matrix)
 {
-    FILE* f = fopen(filename, "r");
+    FILE* f = fopen(filename, "rb");
     if (! f)
     {
         spdlog::error("Failed to open FiberPath file: {}", filename);
         return false;
     }
-    char buffer[256];
-    std::set<int> zSet;
-    coord_t last_z = -999;
-    int last_index = -999;
-    OpenPolyline cur_poly;
-    FiberPath cur_fiberpath;
-    while (fgets(buffer, sizeof(buffer), f))
+
+    // Read the file in large chunks and parse the lines in place. The part of a line that is cut off at the end of a
+    // chunk is moved to the front of the buffer. The buffer grows if a single line doesn't fit, so any line length is
+    // handled.
+    constexpr size_t chunk_size = 1 << 20;
+    std::vector<char> buffer(chunk_size);
+    size_t buffer_fill = 0;
+    FiberPathTXTParser parser(*fiberpaths);
+    bool end_of_file = false;
+    while (! end_of_file)
     {
-        float fx, fy, fz;
-        coord_t x, y, z;
-        int index;
-        if (sscanf(buffer, "%f %f %f %d", &fx, &fy, &fz, &index) != 4)
+        if (buffer_fill == buffer.size())
         {
-            spdlog::warn("Failed to parse line: {}", buffer);
-            continue;
+            buffer.resize(buffer.size() * 2);
         }
-        x = MM2INT(fx);
-        y = MM2INT(fy);
-        z = MM2INT(fz);
+        const size_t read = fread(buffer.data() + buffer_fill, 1, buffer.size() - buffer_fill, f);
+        end_of_file = read == 0;
+        buffer_fill += read;
 
-        if (zSet.find(z) == zSet.end())
+        const char* line_start = buffer.data();
+        const char* const data_end = buffer.data() + buffer_fill;
+        for (const char* c = line_start; c < data_end; c++)
         {
-            if (cur_fiberpath.paths.size() > 1)
+            if (*c == '\n' || *c == '\r') // Also supports Mac and Windows line endings. The empty line of a \r\n is skipped by the parser.
             {
-                fiberpaths->paths.emplace_back(cur_fiberpath);
+                parser.parseLine(line_start, c);
+                line_start = c + 1;
             }
-            FiberPath fiberpath(z);
-            cur_fiberpath = fiberpath;
-            zSet.insert(z);
         }
-        if (index != last_index)
+        if (end_of_file && line_start < data_end) // Last line without line ending.
         {
-            if (cur_poly.size() > 1)
-            {
-                cur_fiberpath.paths.emplace_back(cur_poly);
-            }
-            OpenPolyline poly;
-            cur_poly = poly;
-            last_index = index;
+            parser.parseLine(line_start, data_end);
+            line_start = data_end;
         }
-        cur_poly.emplace_back(Point2LL(x, y));
+        buffer_fill = data_end - line_start;
+        std::memmove(buffer.data(), line_start, buffer_fill);
     }
-    if (cur_poly.size() > 1)
+    const bool read_error = ferror(f);
+    fclose(f);
+    if (read_error)
     {
-        cur_fiberpath.paths.emplace_back(cur_poly);
-        fiberpaths->paths.emplace_back(cur_fiberpath);
+        spdlog::error("Failed to read FiberPath file: {}", filename);
+        return false;
+    }
+    parser.finish();
+    if (! (matrix == Matrix4x3D()))
+    {
+        fiberpaths->transform(matrix);
     }
-    fclose(f);
     return true;
-
 }
 
 bool loadMeshSTL(Mesh* mesh, const char* filename, const Matrix4x3D& matrix)
@@ -340,15 +571,705 @@ bool loadMeshSTL(Mesh* mesh, const char* filename, const Matrix4x3D& matrix)
     return loadMeshSTL_binary(mesh, filename, matrix);
 }
 
+namespace
+{
+//! Text files are parsed in parallel in pieces of about this many bytes.
+constexpr size_t parse_chunk_size = 1 << 20;
+
+/*!
+ * Split text into pieces of about \p chunk_size bytes that can be parsed
+ * independently.
+ * \param text The text to split.
+ * \param chunk_size The minimum size of each piece, except the last.
+ * \param boundary Each piece but the last ends right before this character,
+ * like the end of a line or the start of a tag.
+ */
+std::vector<std::string_view> splitIntoChunks(std::string_view text, const size_t chunk_size, const char boundary)
+{
+    std::vector<std::string_view> chunks;
+    while (! text.empty())
+    {
+        size_t length = text.size();
+        if (length > chunk_size)
+        {
+            length = std::min(text.find(boundary, chunk_size), text.size());
+        }
+        chunks.push_back(text.substr(0, length));
+        text.remove_prefix(length);
+    }
+    return chunks;
+}
+
+/*!
+ * The vertices and faces of a piece of an OBJ file.
+ *
+ * Faces may refer to vertices relative to the last vertex before them, which
+ * can be in earlier pieces. Those indices are kept relative to the start of the
+ * piece until it's known how many vertices the earlier pieces have.
+ */
+struct OBJChunk
+{
+    std::vector<Point3D> vertices_;
+    std::vector<std::array<int64_t, 3>> faces_; //!< Zero-based indices of the corners of each triangle.
+    std::vector<uint8_t> relative_corners_; //!< For each face, a bit per corner that tells whether its index is relative to the first vertex of this piece.
+    std::vector<size_t> unparsed_vertices_; //!< The indices in this piece of the vertices that couldn't be parsed, which no face may use.
+};
+
+/*!
+ * Parse the vertex positions and faces of the lines of a piece of an OBJ file.
+ * All other lines are ignored. Faces with more than three corners are
+ * triangulated as a fan.
+ */
+void parseOBJChunk(const std::string_view text, OBJChunk& chunk)
+{
+    std::vector<std::pair<int64_t, bool>> corners; // The index of each corner of a face, and whether it's relative.
+    const char* const end = text.data() + text.size();
+    for (const char* c = text.data(); c < end;)
+    {
+        const char* line_end = c;
+        while (line_end < end && *line_end != '\n' && *line_end != '\r')
+        {
+            line_end++;
+        }
+        while (c < line_end && (*c == ' ' || *c == '\t'))
+        {
+            c++;
+        }
+
+        if (line_end - c >= 2 && c[0] == 'v' && (c[1] == ' ' || c[1] == '\t'))
+        {
+            const char* cursor = c + 1;
+            Point3D& vertex = chunk.vertices_.emplace_back();
+            if (! parseFloat(cursor, line_end, vertex.x_) || ! parseFloat(cursor, line_end, vertex.y_) || ! parseFloat(cursor, line_end, vertex.z_))
+            {
+                vertex = Point3D(); // Keep the numbering of the other vertices intact.
+                chunk.unparsed_vertices_.push_back(chunk.vertices_.size() - 1);
+            }
+        }
+        else if (line_end - c >= 2 && c[0] == 'f' && (c[1] == ' ' || c[1] == '\t'))
+        {
+            corners.clear();
+            const char* cursor = c + 1;
+            int index;
+            while (parseInt(cursor, line_end, index))
+            {
+                // Indices are one-based, or negative to count back from the last vertex. Zero is invalid, so it becomes -1, which is out of range.
+                const int64_t local_vertex_count = static_cast<int64_t>(chunk.vertices_.size());
+                corners.emplace_back(index > 0 ? index - 1 : (index < 0 ? local_vertex_count + index : -1), index < 0);
+                while (cursor < line_end && *cursor != ' ' && *cursor != '\t') // Skip the texture coordinate and normal indices.
+                {
+                    cursor++;
+                }
+            }
+            for (size_t corner_idx = 1; corner_idx + 1 < corners.size(); corner_idx++)
+            {
+                chunk.faces_.push_back({ corners[0].first, corners[corner_idx].first, corners[corner_idx + 1].first });
+                chunk.relative_corners_.push_back(static_cast<uint8_t>(corners[0].second | (corners[corner_idx].second << 1) | (corners[corner_idx + 1].second << 2)));
+            }
+        }
+        c = line_end + 1;
+    }
+}
+} // namespace
+
+bool loadMeshOBJ(Mesh* mesh, const char* filename, const Matrix4x3D& matrix)
+{
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+    try
+    {
+        file = boost::interprocess::file_mapping(filename, boost::interprocess::read_only);
+        region = boost::interprocess::mapped_region(file, boost::interprocess::read_only);
+    }
+    catch (const boost::interprocess::interprocess_exception& exception)
+    {
+        spdlog::error("Failed to map OBJ file {}: {}", filename, exception.what());
+        return false;
+    }
+    mesh->mesh_name_ = filename;
+
+    const std::vector<std::string_view> texts = splitIntoChunks(std::string_view(static_cast<const char*>(region.get_address()), region.get_size()), parse_chunk_size, '\n');
+    std::vector<OBJChunk> chunks(texts.size());
+    cura::parallel_for<size_t>(
+        0,
+        texts.size(),
+        [&](const size_t chunk_idx)
+        {
+            parseOBJChunk(texts[chunk_idx], chunks[chunk_idx]);
+        });
+
+    // Now that the number of vertices and faces of each piece is known, they can be put in place in parallel.
+    std::vector<size_t> vertex_starts(chunks.size() + 1, 0);
+    std::vector<size_t> face_starts(chunks.size() + 1, 0);
+    for (size_t chunk_idx = 0; chunk_idx < chunks.size(); chunk_idx++)
+    {
+        vertex_starts[chunk_idx + 1] = vertex_starts[chunk_idx] + chunks[chunk_idx].vertices_.size();
+        face_starts[chunk_idx + 1] = face_starts[chunk_idx] + chunks[chunk_idx].faces_.size();
+    }
+    const int64_t vertex_count = static_cast<int64_t>(vertex_starts.back());
+    if (vertex_count > std::numeric_limits<int>::max())
+    {
+        spdlog::error("OBJ file {} has more vertices than are supported.", filename);
+        return false;
+    }
+    // The faces that use a vertex that couldn't be parsed are dropped, rather than pulled to the origin.
+    size_t unparsed_vertex_count = 0;
+    for (const OBJChunk& chunk : chunks)
+    {
+        unparsed_vertex_count += chunk.unparsed_vertices_.size();
+    }
+    std::vector<uint8_t> is_unparsed(unparsed_vertex_count > 0 ? vertex_count : 0, 0);
+    for (size_t chunk_idx = 0; chunk_idx < chunks.size(); chunk_idx++)
+    {
+        for (const size_t vertex_idx : chunks[chunk_idx].unparsed_vertices_)
+        {
+            is_unparsed[vertex_starts[chunk_idx] + vertex_idx] = 1;
+        }
+    }
+    if (unparsed_vertex_count > 0)
+    {
+        spdlog::warn("Couldn't parse {} vertices of OBJ file {}, so the faces that use them are skipped.", unparsed_vertex_count, filename);
+    }
+
+    constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+    std::vector<Point3LL> vertices(vertex_count);
+    std::vector<std::array<uint32_t, 3>> faces(face_starts.back());
+    cura::parallel_for<size_t>(
+        0,
+        chunks.size(),
+        [&](const size_t chunk_idx)
+        {
+            const OBJChunk& chunk = chunks[chunk_idx];
+            for (size_t vertex_idx = 0; vertex_idx < chunk.vertices_.size(); vertex_idx++)
+            {
+                vertices[vertex_starts[chunk_idx] + vertex_idx] = matrix.apply(chunk.vertices_[vertex_idx]);
+            }
+            for (size_t face_idx = 0; face_idx < chunk.faces_.size(); face_idx++)
+            {
+                std::array<uint32_t, 3>& face = faces[face_starts[chunk_idx] + face_idx];
+                for (size_t corner_idx = 0; corner_idx < 3; corner_idx++)
+                {
+                    const bool is_relative = chunk.relative_corners_[face_idx] & (1 << corner_idx);
+                    const int64_t index = chunk.faces_[face_idx][corner_idx] + (is_relative ? static_cast<int64_t>(vertex_starts[chunk_idx]) : 0);
+                    const bool is_valid = index >= 0 && index < vertex_count && (is_unparsed.empty() || ! is_unparsed[index]);
+                    face[corner_idx] = is_valid ? static_cast<uint32_t>(index) : invalid_index;
+                }
+            }
+        });
+    chunks = std::vector<OBJChunk>(); // Release the parsed pieces before the mesh gets built.
+
+    const size_t invalid_faces = std::erase_if(
+        faces,
+        [](const std::array<uint32_t, 3>& face)
+        {
+            return face[0] == invalid_index || face[1] == invalid_index || face[2] == invalid_index;
+        });
+    if (invalid_faces > 0)
+    {
+        spdlog::warn("Skipped {} faces of OBJ file {} that refer to vertices that don't exist or couldn't be parsed.", invalid_faces, filename);
+    }
+
+    mesh->addIndexedFaces(vertices, faces);
+    mesh->finish();
+    return true;
+}
+
+namespace
+{
+/*!
+ * A start or end tag of an XML element, as found by nextXMLTag.
+ */
+struct XMLTag
+{
+    std::string_view qualified_name_; //!< The name of the element, with its namespace prefix if it has one.
+    std::string_view name_; //!< The name of the element without namespace prefix.
+    std::string_view attributes_; //!< Everything between the name and the end of the tag.
+    bool is_end_ = false; //!< Whether this is an end tag, like </mesh>.
+    bool is_empty_ = false; //!< Whether this is an empty element, like <vertex ... />, which has no end tag.
+};
+
+/*!
+ * Find the next start or end tag in XML text, skipping the text between tags,
+ * comments, processing instructions and declarations.
+ *
+ * This is only meant for the 3MF model files, which consist of lots of small
+ * elements, so it doesn't validate the XML or decode any entities.
+ * \param cursor Where to start looking. Moved to just after the tag.
+ * \param end The end of the text.
+ * \param tag The tag that was found.
+ * \return Whether a tag was found.
+ */
+bool nextXMLTag(const char*& cursor, const char* end, XMLTag& tag)
+{
+    while (cursor < end)
+    {
+        const char* open = static_cast<const char*>(std::memchr(cursor, '<', end - cursor));
+        if (open == nullptr || open + 1 >= end)
+        {
+            break;
+        }
+        const std::string_view rest(open, end - open);
+        if (rest.starts_with("<!--"))
+        {
+            const size_t comment_end = rest.find("-->");
+            cursor = comment_end == rest.npos ? end : open + comment_end + 3;
+            continue;
+        }
+
+        // The tag ends at the first > that isn't inside an attribute value.
+        const char* close = open + 1;
+        char quote = '\0';
+        for (; close < end && (quote != '\0' || *close != '>'); close++)
+        {
+            if (quote == '\0' && (*close == '"' || *close == '\''))
+            {
+                quote = *close;
+            }
+            else if (*close == quote)
+            {
+                quote = '\0';
+            }
+        }
+        if (close == end)
+        {
+            break;
+        }
+        cursor = close + 1;
+        if (open[1] == '?' || open[1] == '!')
+        {
+            continue;
+        }
+
+        tag.is_end_ = open[1] == '/';
+        tag.is_empty_ = close[-1] == '/';
+        const char* name_start = open + (tag.is_end_ ? 2 : 1);
+        const char* name_end = name_start;
+        while (name_end < close && ! std::isspace(static_cast<unsigned char>(*name_end)) && *name_end != '/')
+        {
+            name_end++;
+        }
+        tag.qualified_name_ = std::string_view(name_start, name_end - name_start);
+        const size_t prefix_end = tag.qualified_name_.find(':');
+        tag.name_ = prefix_end == std::string_view::npos ? tag.qualified_name_ : tag.qualified_name_.substr(prefix_end + 1);
+        tag.attributes_ = std::string_view(name_end, (tag.is_empty_ ? close - 1 : close) - name_end);
+        return true;
+    }
+    cursor = end;
+    return false;
+}
+
+/*!
+ * Get the value of an attribute from the attributes of a tag.
+ * \return The value without its quotes, or nothing if the tag doesn't have the
+ * attribute.
+ */
+std::optional<std::string_view> getXMLAttribute(std::string_view attributes, const std::string_view name)
+{
+    while (true)
+    {
+        const size_t name_start = attributes.find_first_not_of(" \t\r\n");
+        if (name_start == std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+        const size_t equals = attributes.find('=', name_start);
+        const size_t value_start = attributes.find_first_of("\"'", equals);
+        if (value_start == std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+        const size_t value_end = attributes.find(attributes[value_start], value_start + 1);
+        if (value_end == std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+        std::string_view attribute_name = attributes.substr(name_start, equals - name_start);
+        attribute_name = attribute_name.substr(0, attribute_name.find_last_not_of(" \t\r\n") + 1);
+        if (attribute_name == name)
+        {
+            return attributes.substr(value_start + 1, value_end - value_start - 1);
+        }
+        attributes.remove_prefix(value_end + 1);
+    }
+}
+
+/*!
+ * Replace the predefined entities of XML, like &amp;, by the characters they
+ * stand for.
+ */
+std::string decodeXMLEntities(std::string_view text)
+{
+    static constexpr std::pair<std::string_view, char> entities[] = { { "&amp;", '&' }, { "&lt;", '<' }, { "&gt;", '>' }, { "&quot;", '"' }, { "&apos;", '\'' } };
+    std::string result;
+    result.reserve(text.size());
+    while (! text.empty())
+    {
+        const size_t entity_start = text.find('&');
+        result += text.substr(0, entity_start);
+        if (entity_start == std::string_view::npos)
+        {
+            break;
+        }
+        text.remove_prefix(entity_start);
+        const auto entity = std::find_if(
+            std::begin(entities),
+            std::end(entities),
+            [&text](const std::pair<std::string_view, char>& candidate)
+            {
+                return text.starts_with(candidate.first);
+            });
+        result += entity == std::end(entities) ? '&' : entity->second;
+        text.remove_prefix(entity == std::end(entities) ? 1 : entity->first.size());
+    }
+    return result;
+}
+
+//! Get the value of a floating point attribute of a tag, if it has one.
+bool getXMLAttribute(const std::string_view attributes, const std::string_view name, double& result)
+{
+    const std::optional<std::string_view> value = getXMLAttribute(attributes, name);
+    const char* cursor = value ? value->data() : nullptr;
+    return value && parseFloat(cursor, value->data() + value->size(), result);
+}
+
+//! Get the value of a non-negative integer attribute of a tag, if it has one.
+bool getXMLAttribute(const std::string_view attributes, const std::string_view name, uint32_t& result)
+{
+    const std::optional<std::string_view> value = getXMLAttribute(attributes, name);
+    int parsed = -1;
+    const char* cursor = value ? value->data() : nullptr;
+    if (! value || ! parseInt(cursor, value->data() + value->size(), parsed) || parsed < 0)
+    {
+        return false;
+    }
+    result = static_cast<uint32_t>(parsed);
+    return true;
+}
+
+/*!
+ * Parse the transformation of a 3MF component or build item.
+ *
+ * The transformation is given as the first three columns of a 4x4 matrix with
+ * which the points are multiplied as row vectors, row after row, which is
+ * exactly the layout of Matrix4x3D.
+ */
+Matrix4x3D parse3MFTransform(const std::optional<std::string_view> transform, const char* filename)
+{
+    Matrix4x3D result;
+    if (! transform)
+    {
+        return result;
+    }
+    const char* cursor = transform->data();
+    const char* const end = cursor + transform->size();
+    for (size_t idx = 0; idx < 12; idx++)
+    {
+        while (cursor < end && std::isspace(static_cast<unsigned char>(*cursor))) // parseFloat only skips spaces and tabs.
+        {
+            cursor++;
+        }
+        if (! parseFloat(cursor, end, result.m[idx / 3][idx % 3]))
+        {
+            spdlog::warn("Ignoring the invalid transformation '{}' in 3MF file {}.", *transform, filename);
+            return Matrix4x3D();
+        }
+    }
+    return result;
+}
+
+//! A reference from a 3MF object or build item to an object.
+struct ThreeMFComponent
+{
+    std::string object_id_;
+    Matrix4x3D transform_;
+};
+
+//! An object of a 3MF model, which has either a mesh or components.
+struct ThreeMFObject
+{
+    std::string name_;
+    std::vector<Point3D> vertices_; //!< In the unit of the model.
+    std::vector<std::array<uint32_t, 3>> triangles_;
+    std::vector<ThreeMFComponent> components_;
+};
+
+//! The <vertices> or <triangles> of a 3MF object, or a piece of it, which is parsed in parallel with the others.
+struct ThreeMFChunk
+{
+    size_t object_idx_;
+    bool is_triangles_;
+    std::string_view text_;
+    std::vector<Point3D> vertices_;
+    std::vector<std::array<uint32_t, 3>> triangles_;
+    bool is_valid_ = true;
+};
+
+void parse3MFChunk(ThreeMFChunk& chunk)
+{
+    const char* cursor = chunk.text_.data();
+    const char* const end = cursor + chunk.text_.size();
+    XMLTag tag;
+    while (nextXMLTag(cursor, end, tag))
+    {
+        if (tag.is_end_)
+        {
+            continue;
+        }
+        if (! chunk.is_triangles_ && tag.name_ == "vertex")
+        {
+            Point3D& vertex = chunk.vertices_.emplace_back();
+            chunk.is_valid_ &= getXMLAttribute(tag.attributes_, "x", vertex.x_) && getXMLAttribute(tag.attributes_, "y", vertex.y_) && getXMLAttribute(tag.attributes_, "z", vertex.z_);
+        }
+        else if (chunk.is_triangles_ && tag.name_ == "triangle")
+        {
+            std::array<uint32_t, 3>& triangle = chunk.triangles_.emplace_back();
+            chunk.is_valid_ &= getXMLAttribute(tag.attributes_, "v1", triangle[0]) && getXMLAttribute(tag.attributes_, "v2", triangle[1])
+                            && getXMLAttribute(tag.attributes_, "v3", triangle[2]);
+        }
+    }
+}
+
+/*!
+ * The scale from the unit of a 3MF model to millimeters.
+ */
+std::optional<double> get3MFUnitScale(const std::string_view unit)
+{
+    static constexpr std::pair<std::string_view, double> units[] = { { "micron", 0.001 }, { "millimeter", 1.0 }, { "centimeter", 10.0 },
+                                                                     { "inch", 25.4 },    { "foot", 304.8 },     { "meter", 1000.0 } };
+    for (const auto& [name, scale] : units)
+    {
+        if (unit == name)
+        {
+            return scale;
+        }
+    }
+    return std::nullopt;
+}
+
+/*!
+ * Find the path of the model part of a 3MF package, from the relationships of
+ * the package.
+ */
+std::string find3MFModelPath(const ZipArchive& archive)
+{
+    const std::optional<std::string> relationships = archive.read("_rels/.rels");
+    if (relationships)
+    {
+        const char* cursor = relationships->data();
+        const char* const end = cursor + relationships->size();
+        XMLTag tag;
+        while (nextXMLTag(cursor, end, tag))
+        {
+            const std::optional<std::string_view> type = getXMLAttribute(tag.attributes_, "Type");
+            const std::optional<std::string_view> target = getXMLAttribute(tag.attributes_, "Target");
+            if (! tag.is_end_ && tag.name_ == "Relationship" && type && type->ends_with("/3dmodel") && target)
+            {
+                return std::string(*target);
+            }
+        }
+    }
+    return "3D/3dmodel.model";
+}
+
+/*!
+ * Add the meshes of a 3MF object and of its components to a mesh.
+ * \param depth How many components deep this object is, to stop at components
+ * that refer to themselves.
+ * \return Whether the object could be added.
+ */
+bool add3MFObject(
+    Mesh& mesh,
+    const std::vector<ThreeMFObject>& objects,
+    const std::unordered_map<std::string_view, size_t>& object_indices,
+    const std::string_view object_id,
+    const Matrix4x3D& transformation,
+    const size_t depth,
+    const char* filename)
+{
+    constexpr size_t max_depth = 32;
+    const auto found = object_indices.find(object_id);
+    if (found == object_indices.end() || depth > max_depth)
+    {
+        spdlog::error("3MF file {} refers to an object {} that doesn't exist or contains itself.", filename, object_id);
+        return false;
+    }
+    const ThreeMFObject& object = objects[found->second];
+
+    if (! object.triangles_.empty())
+    {
+        std::vector<Point3LL> vertices(object.vertices_.size());
+        cura::parallel_for<size_t>(
+            0,
+            vertices.size(),
+            [&](const size_t vertex_idx)
+            {
+                vertices[vertex_idx] = transformation.apply(object.vertices_[vertex_idx]);
+            },
+            4096);
+        mesh.addIndexedFaces(vertices, object.triangles_);
+    }
+    for (const ThreeMFComponent& component : object.components_)
+    {
+        if (! add3MFObject(mesh, objects, object_indices, component.object_id_, transformation.compose(component.transform_), depth + 1, filename))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+bool loadMesh3MF(MeshGroup* meshgroup, const char* filename, const Matrix4x3D& matrix, Settings& object_parent_settings)
+{
+    const std::unique_ptr<ZipArchive> archive = ZipArchive::open(filename);
+    if (! archive)
+    {
+        return false;
+    }
+    const std::string model_path = find3MFModelPath(*archive);
+    const std::optional<std::string> model = archive->read(model_path);
+    if (! model)
+    {
+        spdlog::error("3MF file {} doesn't contain its model {}.", filename, model_path);
+        return false;
+    }
+
+    // Go over the structure of the model, but leave the actual vertices and triangles, which are most of it, to be parsed in parallel.
+    double unit_scale = 1.0;
+    std::vector<ThreeMFObject> objects;
+    std::vector<std::string_view> object_ids;
+    std::vector<ThreeMFComponent> build_items;
+    std::vector<ThreeMFChunk> chunks;
+    std::optional<size_t> current_object;
+    const char* cursor = model->data();
+    const char* const end = cursor + model->size();
+    XMLTag tag;
+    while (nextXMLTag(cursor, end, tag))
+    {
+        if (tag.is_end_)
+        {
+            if (tag.name_ == "object")
+            {
+                current_object.reset();
+            }
+            continue;
+        }
+        if (tag.name_ == "model")
+        {
+            const std::optional<std::string_view> unit = getXMLAttribute(tag.attributes_, "unit");
+            if (unit && ! get3MFUnitScale(*unit))
+            {
+                spdlog::warn("Unknown unit '{}' in 3MF file {}, using millimeters.", *unit, filename);
+            }
+            unit_scale = unit ? get3MFUnitScale(*unit).value_or(1.0) : 1.0;
+        }
+        else if (tag.name_ == "object")
+        {
+            const std::optional<std::string_view> name = getXMLAttribute(tag.attributes_, "name");
+            objects.push_back(ThreeMFObject{ .name_ = decodeXMLEntities(name.value_or("")) });
+            object_ids.push_back(getXMLAttribute(tag.attributes_, "id").value_or(""));
+            current_object = tag.is_empty_ ? std::nullopt : std::make_optional(objects.size() - 1);
+        }
+        else if ((tag.name_ == "vertices" || tag.name_ == "triangles") && current_object && ! tag.is_empty_)
+        {
+            const std::string_view rest(cursor, end - cursor);
+            const size_t region_end = std::min(rest.find(fmt::format("</{}", tag.qualified_name_)), rest.size());
+            for (const std::string_view text : splitIntoChunks(rest.substr(0, region_end), parse_chunk_size, '<'))
+            {
+                chunks.push_back(ThreeMFChunk{ .object_idx_ = *current_object, .is_triangles_ = tag.name_ == "triangles", .text_ = text });
+            }
+            cursor += region_end;
+        }
+        else if (tag.name_ == "component" && current_object)
+        {
+            if (getXMLAttribute(tag.attributes_, "p:path"))
+            {
+                spdlog::warn("Skipping a component in 3MF file {} that refers to another model file, which isn't supported.", filename);
+                continue;
+            }
+            objects[*current_object].components_.push_back(
+                ThreeMFComponent{ .object_id_ = std::string(getXMLAttribute(tag.attributes_, "objectid").value_or("")),
+                                  .transform_ = parse3MFTransform(getXMLAttribute(tag.attributes_, "transform"), filename) });
+        }
+        else if (tag.name_ == "item")
+        {
+            build_items.push_back(ThreeMFComponent{ .object_id_ = std::string(getXMLAttribute(tag.attributes_, "objectid").value_or("")),
+                                                    .transform_ = parse3MFTransform(getXMLAttribute(tag.attributes_, "transform"), filename) });
+        }
+    }
+
+    cura::parallel_for<size_t>(
+        0,
+        chunks.size(),
+        [&](const size_t chunk_idx)
+        {
+            parse3MFChunk(chunks[chunk_idx]);
+        });
+    for (ThreeMFChunk& chunk : chunks)
+    {
+        if (! chunk.is_valid_)
+        {
+            spdlog::error("3MF file {} has vertices or triangles with missing or invalid coordinates.", filename);
+            return false;
+        }
+        ThreeMFObject& object = objects[chunk.object_idx_];
+        object.vertices_.insert(object.vertices_.end(), chunk.vertices_.begin(), chunk.vertices_.end());
+        object.triangles_.insert(object.triangles_.end(), chunk.triangles_.begin(), chunk.triangles_.end());
+    }
+    chunks.clear();
+
+    std::unordered_map<std::string_view, size_t> object_indices;
+    for (size_t object_idx = 0; object_idx < objects.size(); object_idx++)
+    {
+        ThreeMFObject& object = objects[object_idx];
+        object_indices.emplace(object_ids[object_idx], object_idx);
+        const size_t invalid_triangles = std::erase_if(
+            object.triangles_,
+            [vertex_count = object.vertices_.size()](const std::array<uint32_t, 3>& triangle)
+            {
+                return triangle[0] >= vertex_count || triangle[1] >= vertex_count || triangle[2] >= vertex_count;
+            });
+        if (invalid_triangles > 0)
+        {
+            spdlog::warn("Skipped {} triangles of 3MF file {} that refer to vertices that don't exist.", invalid_triangles, filename);
+        }
+    }
+    if (build_items.empty())
+    {
+        spdlog::error("3MF file {} doesn't have any objects to build.", filename);
+        return false;
+    }
+
+    // Each build item becomes a mesh, with the meshes of all of its components.
+    Matrix4x3D to_millimeters;
+    to_millimeters.m[0][0] = unit_scale;
+    to_millimeters.m[1][1] = unit_scale;
+    to_millimeters.m[2][2] = unit_scale;
+    for (const ThreeMFComponent& item : build_items)
+    {
+        Mesh mesh(object_parent_settings);
+        if (! add3MFObject(mesh, objects, object_indices, item.object_id_, matrix.compose(to_millimeters.compose(item.transform_)), 0, filename))
+        {
+            return false;
+        }
+        const ThreeMFObject& object = objects[object_indices.at(item.object_id_)];
+        mesh.mesh_name_ = object.name_.empty() ? filename : object.name_;
+        mesh.finish();
+        meshgroup->meshes.push_back(std::move(mesh));
+    }
+    return true;
+}
+
 bool loadMeshIntoMeshGroup(MeshGroup* meshgroup, const char* filename, const Matrix4x3D& transformation, Settings& object_parent_settings)
 {
     TimeKeeper load_timer;
 
     const char* ext = strrchr(filename, '.');
-    if (ext && (strcmp(ext, ".stl") == 0 || strcmp(ext, ".STL") == 0))
+    if (ext && (stringcasecompare(ext, ".stl") == 0 || stringcasecompare(ext, ".obj") == 0))
     {
         Mesh mesh(object_parent_settings);
-        if (loadMeshSTL(&mesh, filename, transformation)) // Load it! If successful...
+        const bool is_stl = stringcasecompare(ext, ".stl") == 0;
+        if (is_stl ? loadMeshSTL(&mesh, filename, transformation) : loadMeshOBJ(&mesh, filename, transformation)) // Load it! If successful...
         {
             meshgroup->meshes.push_back(mesh);
             spdlog::info("loading '{}' took {:03.3f} seconds", filename, load_timer.restart());
@@ -357,19 +1278,148 @@ bool loadMeshIntoMeshGroup(MeshGroup* meshgroup, const char* filename, const Mat
         spdlog::warn("loading '{}' failed", filename);
         return false;
     }
-    spdlog::warn("Unable to recognize the extension of the file. Currently only .stl and .STL are supported.");
+    if (ext && stringcasecompare(ext, ".3mf") == 0)
+    {
+        if (loadMesh3MF(meshgroup, filename, transformation, object_parent_settings))
+        {
+            spdlog::info("loading '{}' took {:03.3f} seconds", filename, load_timer.restart());
+            return true;
+        }
+        spdlog::warn("loading '{}' failed", filename);
+        return false;
+    }
+    spdlog::warn("Unable to recognize the extension of the file. Currently only .stl, .obj and .3mf are supported.");
     return false;
 }
 
+namespace
+{
+/*!
+ * Cache of the fiber path files loaded by this process.
+ *
+ * Slicing the same fiber paths for multiple mesh groups or multiple slices
+ * only parses (or maps) the file once. An entry is reused as long as the file
+ * has the same size and modification time. The fiber paths are shared with the
+ * mesh groups, so they must not be modified after they're cached.
+ */
+class FiberPathCache
+{
+public:
+    static FiberPathCache& getInstance()
+    {
+        static FiberPathCache instance;
+        return instance;
+    }
+
+    /*!
+     * Get the fiber paths of a file, transformed with \p transformation.
+     *
+     * The fibers are simplified with \p max_resolution, \p max_deviation and
+     * \p max_area_deviation right after loading them, see \ref FiberPaths::simplify. Asking for
+     * other tolerances loads the file again.
+     * \return The fiber paths, or nullptr if the file couldn't be loaded.
+     */
+    std::shared_ptr<FiberPaths> get(const char* filename, const Matrix4x3D& transformation, const bool is_binary, const coord_t max_resolution, const coord_t max_deviation, const coord_t max_area_deviation)
+    {
+        std::error_code path_error;
+        std::error_code size_error;
+        std::error_code time_error;
+        const std::filesystem::path path = std::filesystem::absolute(filename, path_error);
+        const auto file_size = std::filesystem::file_size(path, size_error);
+        const auto modified_time = std::filesystem::last_write_time(path, time_error);
+        if (path_error || size_error || time_error)
+        {
+            spdlog::error("Failed to open FiberPath file: {}", filename);
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = entries_[path.string()];
+        if (! entry.untransformed || entry.file_size != file_size || entry.modified_time != modified_time || entry.max_resolution != max_resolution
+            || entry.max_deviation != max_deviation || entry.max_area_deviation != max_area_deviation)
+        {
+            entry = Entry{ .file_size = file_size, .modified_time = modified_time, .max_resolution = max_resolution, .max_deviation = max_deviation, .max_area_deviation = max_area_deviation };
+            entry.untransformed = std::make_shared<FiberPaths>();
+            if (is_binary)
+            {
+                std::shared_ptr<FiberPathBinaryFile> file = FiberPathBinaryFile::open(filename);
+                if (! file)
+                {
+                    entries_.erase(path.string());
+                    return nullptr;
+                }
+                FiberPathBinaryFile::addTo(file, *entry.untransformed);
+            }
+            else if (! loadFiberPathTXT(entry.untransformed.get(), filename, Matrix4x3D()))
+            {
+                entries_.erase(path.string());
+                return nullptr;
+            }
+            entry.untransformed->simplify(max_resolution, max_deviation, max_area_deviation);
+            entry.untransformed->sort();
+        }
+        else
+        {
+            spdlog::debug("Reusing the cached fiber paths of '{}'", filename);
+        }
+
+        if (transformation == Matrix4x3D())
+        {
+            return entry.untransformed;
+        }
+        if (! entry.transformed || ! (entry.transformation == transformation))
+        {
+            // Transform a copy of the untransformed points, rather than transforming the previously transformed copy
+            // again, so that rounding errors don't accumulate.
+            entry.transformed = std::make_shared<FiberPaths>(*entry.untransformed);
+            entry.transformed->transform(transformation);
+            entry.transformed->sort();
+            entry.transformation = transformation;
+        }
+        return entry.transformed;
+    }
+
+private:
+    struct Entry
+    {
+        std::uintmax_t file_size = 0;
+        std::filesystem::file_time_type modified_time;
+        coord_t max_resolution = 0; //!< The resolution that the fiber paths were simplified to.
+        coord_t max_deviation = 0; //!< The deviation that the fiber paths were simplified with.
+        coord_t max_area_deviation = 0; //!< The area deviation that the fiber paths were simplified with.
+        std::shared_ptr<FiberPaths> untransformed;
+        Matrix4x3D transformation; //!< The transformation of \ref transformed.
+        std::shared_ptr<FiberPaths> transformed; //!< The fiber paths with the last requested non-identity transformation.
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+} // namespace
+
 bool loadFiberPathIntoMeshGroup(MeshGroup* meshgroup, const char* filename, const Matrix4x3D& transformation, Settings& object_parent_settings)
 {
     TimeKeeper load_timer;
 
     const char* ext = strrchr(filename, '.');
-    if (ext && (strcmp(ext, ".txt") == 0 || strcmp(ext, ".TXT") == 0))
+    const bool is_binary = ext && (strcmp(ext, ".fpb") == 0 || strcmp(ext, ".FPB") == 0);
+    if (is_binary || (ext && (strcmp(ext, ".txt") == 0 || strcmp(ext, ".TXT") == 0)))
     {
-        FiberPaths fiberpaths;
-        if (loadFiberPathTXT(&fiberpaths, filename, transformation)) // Load it! If successful...
+        // Generated fiber paths often have points much closer together than the printer can resolve. Simplifying them changes the fibers, so it is opt-in.
+        bool simplify = false;
+        for (const Settings* settings : std::initializer_list<const Settings*>{ &object_parent_settings, &meshgroup->settings })
+        {
+            if (settings->has("fiber_path_simplify"))
+            {
+                simplify = settings->get<bool>("fiber_path_simplify");
+                break;
+            }
+        }
+        const coord_t max_resolution = simplify ? object_parent_settings.get<coord_t>("meshfix_maximum_resolution") : 0;
+        const coord_t max_deviation = simplify ? object_parent_settings.get<coord_t>("meshfix_maximum_deviation") : 0;
+        const coord_t max_area_deviation = simplify ? object_parent_settings.get<coord_t>("meshfix_maximum_extrusion_area_deviation") : 0;
+        std::shared_ptr<FiberPaths> fiberpaths = FiberPathCache::getInstance().get(filename, transformation, is_binary, max_resolution, max_deviation, max_area_deviation);
+        if (fiberpaths) // Loaded it! If successful...
         {
             meshgroup->fiberpaths.push_back(fiberpaths);
             spdlog::info("loading '{}' took {:03.3f} seconds", filename, load_timer.restart());
@@ -378,10 +1428,26 @@ bool loadFiberPathIntoMeshGroup(MeshGroup* meshgroup, const char* filename, cons
         spdlog::warn("loading '{}' failed", filename);
         return false;
     }
-    spdlog::warn("Unable to recognize the extension of the file. Currently only .txt and .TXT are supported.");
+    spdlog::warn("Unable to recognize the extension of the file. Currently only .txt, .TXT, .fpb and .FPB are supported.");
     return false;
 }
 
+bool convertFiberPathToBinary(const char* input_filename, const char* output_filename)
+{
+    TimeKeeper convert_timer;
+    FiberPaths fiberpaths;
+    if (! loadFiberPathTXT(&fiberpaths, input_filename, Matrix4x3D()))
+    {
+        return false;
+    }
+    if (! FiberPathBinaryFile::write(fiberpaths, output_filename))
+    {
+        return false;
+    }
+    spdlog::info("converting '{}' to '{}' took {:03.3f} seconds", input_filename, output_filename, convert_timer.restart());
+    return true;
+}
+
 
 
 } // namespace cura
@@ -14,6 +14,7 @@
 #include "settings/types/Ratio.h"
 #include "sliceDataStorage.h"
 #include "slicer.h"
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -49,77 +50,117 @@ void Mold::process(std::vector<Slicer*>& slicer_list)
     }
 
     const coord_t layer_height = scene.current_mesh_group->settings.get<coord_t>("layer_height");
-    std::vector<Shape> mold_outline_above_per_mesh; // the outer outlines of the layer above without the original model(s) being cut out
-    mold_outline_above_per_mesh.resize(slicer_list.size());
-    for (int layer_nr = layer_count - 1; layer_nr >= 0; layer_nr--)
-    {
-        Shape all_original_mold_outlines; // outlines of all models for which to generate a mold (insides of all molds)
 
-        // first generate outlines
-        for (unsigned int mesh_idx = 0; mesh_idx < slicer_list.size(); mesh_idx++)
+    // The outlines of the models and their offsets only depend on the sliced layer itself, so they're computed for all layers in parallel first. Only growing the
+    // molds from the layer above needs to go from the top down.
+    std::vector<std::vector<Shape>> model_outlines_per_mesh(slicer_list.size()); // per layer, the outlines of the model for which to generate a mold (the inside of the mold)
+    std::vector<std::vector<Shape>> model_offset_per_mesh(slicer_list.size()); // per layer, the outlines of the model expanded by the mold width
+    std::vector<std::vector<Shape>> roof_offset_per_mesh(slicer_list.size()); // per layer, the sliced layer expanded by the mold width, for the roofs above it
+    for (unsigned int mesh_idx = 0; mesh_idx < slicer_list.size(); mesh_idx++)
+    {
+        const Mesh& mesh = scene.current_mesh_group->meshes[mesh_idx];
+        if (! mesh.settings_.get<bool>("mold_enabled"))
         {
-            const Mesh& mesh = scene.current_mesh_group->meshes[mesh_idx];
-            Slicer& slicer = *slicer_list[mesh_idx];
-            if (! mesh.settings_.get<bool>("mold_enabled") || layer_nr >= static_cast<int>(slicer.layers.size()))
-            {
-                continue;
-            }
-            coord_t width = mesh.settings_.get<coord_t>("mold_width");
-            coord_t open_polyline_width = mesh.settings_.get<coord_t>("wall_line_width_0");
-            if (layer_nr == 0)
+            continue;
+        }
+        Slicer& slicer = *slicer_list[mesh_idx];
+        const coord_t width = mesh.settings_.get<coord_t>("mold_width");
+        const coord_t open_polyline_width = mesh.settings_.get<coord_t>("wall_line_width_0");
+        const Ratio initial_layer_line_width_factor = mesh.settings_.get<ExtruderTrain&>("wall_0_extruder_nr").settings_.get<Ratio>("initial_layer_line_width_factor");
+        const bool has_roofs = mesh.settings_.get<coord_t>("mold_roof_height") / layer_height > 0;
+
+        std::vector<Shape>& model_outlines = model_outlines_per_mesh[mesh_idx];
+        std::vector<Shape>& model_offset = model_offset_per_mesh[mesh_idx];
+        std::vector<Shape>& roof_offset = roof_offset_per_mesh[mesh_idx];
+        model_outlines.resize(slicer.layers.size());
+        model_offset.resize(slicer.layers.size());
+        roof_offset.resize(has_roofs ? slicer.layers.size() : 0);
+        cura::parallel_for<size_t>(
+            0,
+            slicer.layers.size(),
+            [&](const size_t layer_nr)
             {
-                const ExtruderTrain& train_wall_0 = mesh.settings_.get<ExtruderTrain&>("wall_0_extruder_nr");
-                open_polyline_width *= train_wall_0.settings_.get<Ratio>("initial_layer_line_width_factor");
-            }
-            const AngleDegrees angle = mesh.settings_.get<AngleDegrees>("mold_angle");
-            const coord_t roof_height = mesh.settings_.get<coord_t>("mold_roof_height");
+                SlicerLayer& layer = slicer.layers[layer_nr];
+                const coord_t layer_open_polyline_width = layer_nr == 0 ? coord_t(open_polyline_width * initial_layer_line_width_factor) : open_polyline_width;
+                const bool has_open_polylines = ! layer.open_polylines_.empty();
+                model_outlines[layer_nr] = layer.polygons_.unionPolygons(layer.open_polylines_.offset(layer_open_polyline_width / 2));
+                layer.open_polylines_.clear();
+                model_offset[layer_nr] = model_outlines[layer_nr].offset(width, ClipperLib::jtRound);
+                if (has_roofs)
+                {
+                    // Without open polylines that's the same as the offset of the model outlines.
+                    roof_offset[layer_nr] = has_open_polylines ? layer.polygons_.offset(width, ClipperLib::jtRound) : model_offset[layer_nr];
+                }
+            });
+    }
 
-            const coord_t inset = tan(angle / 180 * std::numbers::pi) * layer_height;
-            const size_t roof_layer_count = roof_height / layer_height;
+    for (unsigned int mesh_idx = 0; mesh_idx < slicer_list.size(); mesh_idx++)
+    {
+        const Mesh& mesh = scene.current_mesh_group->meshes[mesh_idx];
+        if (! mesh.settings_.get<bool>("mold_enabled"))
+        {
+            continue;
+        }
+        Slicer& slicer = *slicer_list[mesh_idx];
+        const AngleDegrees angle = mesh.settings_.get<AngleDegrees>("mold_angle");
+        const coord_t roof_height = mesh.settings_.get<coord_t>("mold_roof_height");
 
+        const coord_t inset = tan(angle / 180 * std::numbers::pi) * layer_height;
+        const size_t roof_layer_count = roof_height / layer_height;
 
+        Shape mold_outline_above; // the outside of the mold on the layer above, without the original model(s) being cut out
+        for (int layer_nr = static_cast<int>(slicer.layers.size()) - 1; layer_nr >= 0; layer_nr--)
+        {
             SlicerLayer& layer = slicer.layers[layer_nr];
-            Shape model_outlines = layer.polygons_.unionPolygons(layer.open_polylines_.offset(open_polyline_width / 2));
-            layer.open_polylines_.clear();
-            all_original_mold_outlines.push_back(model_outlines);
-
             if (angle >= 90)
             {
-                layer.polygons_ = model_outlines.offset(width, ClipperLib::jtRound);
+                layer.polygons_ = std::move(model_offset_per_mesh[mesh_idx][layer_nr]);
             }
             else
             {
-                Shape& mold_outline_above = mold_outline_above_per_mesh[mesh_idx]; // the outside of the mold on the layer above
-                layer.polygons_ = mold_outline_above.offset(-inset).unionPolygons(model_outlines.offset(width, ClipperLib::jtRound));
+                layer.polygons_ = mold_outline_above.offset(-inset).unionPolygons(model_offset_per_mesh[mesh_idx][layer_nr]);
             }
 
             // add roofs
             if (roof_layer_count > 0 && layer_nr > 0)
             {
                 LayerIndex layer_nr_below = std::max(0, static_cast<int>(layer_nr - roof_layer_count));
-                Shape roofs = slicer.layers[layer_nr_below].polygons_.offset(width, ClipperLib::jtRound); // TODO: don't compute offset twice!
-                layer.polygons_ = layer.polygons_.unionPolygons(roofs);
+                layer.polygons_ = layer.polygons_.unionPolygons(roof_offset_per_mesh[mesh_idx][layer_nr_below]);
             }
 
-            mold_outline_above_per_mesh[mesh_idx] = layer.polygons_;
+            mold_outline_above = layer.polygons_;
         }
-        all_original_mold_outlines = all_original_mold_outlines.unionPolygons();
-
-        // cut out molds from all objects after generating mold outlines for all objects so that molds won't overlap into the casting cutout of another mold
+    }
 
-        // carve molds out of all other models
-        for (unsigned int mesh_idx = 0; mesh_idx < slicer_list.size(); mesh_idx++)
+    // cut out molds from all objects after generating mold outlines for all objects so that molds won't overlap into the casting cutout of another mold
+    cura::parallel_for<size_t>(
+        0,
+        layer_count,
+        [&](const size_t layer_nr)
         {
-            const Mesh& mesh = scene.current_mesh_group->meshes[mesh_idx];
-            if (! mesh.settings_.get<bool>("mold_enabled"))
+            Shape all_original_mold_outlines; // outlines of all models for which to generate a mold (insides of all molds)
+            for (const std::vector<Shape>& model_outlines : model_outlines_per_mesh)
             {
-                continue; // only cut original models out of all molds
+                if (layer_nr < model_outlines.size())
+                {
+                    all_original_mold_outlines.push_back(model_outlines[layer_nr]);
+                }
             }
-            Slicer& slicer = *slicer_list[mesh_idx];
-            SlicerLayer& layer = slicer.layers[layer_nr];
-            layer.polygons_ = layer.polygons_.difference(all_original_mold_outlines);
-        }
-    }
+            all_original_mold_outlines = all_original_mold_outlines.unionPolygons();
+
+            // carve molds out of all other models
+            for (unsigned int mesh_idx = 0; mesh_idx < slicer_list.size(); mesh_idx++)
+            {
+                const Mesh& mesh = scene.current_mesh_group->meshes[mesh_idx];
+                Slicer& slicer = *slicer_list[mesh_idx];
+                if (! mesh.settings_.get<bool>("mold_enabled") || layer_nr >= slicer.layers.size())
+                {
+                    continue; // only cut original models out of all molds
+                }
+                SlicerLayer& layer = slicer.layers[layer_nr];
+                layer.polygons_ = layer.polygons_.difference(all_original_mold_outlines);
+            }
+        });
 }
 
 
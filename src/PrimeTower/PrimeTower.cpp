@@ -85,7 +85,9 @@ void PrimeTower::generateBase()
 
                 std::tuple<ClosedLinesSet, coord_t> outset
                     = PolygonUtils::generateCirculatOutset(middle_, first_extruder_toolpaths.outer_radius, base_ouline_at_this_layer.outer_radius, line_width, circle_definition_);
-                first_extruder_toolpaths.toolpaths.push_back(std::get<0>(outset));
+                auto toolpaths_with_outset = std::make_shared<ClosedLinesSet>(*first_extruder_toolpaths.toolpaths); // The outset differs per layer, so it's not shared.
+                toolpaths_with_outset->push_back(std::get<0>(outset));
+                first_extruder_toolpaths.toolpaths = std::move(toolpaths_with_outset);
 
                 base_extrusion_outline_.push_back(PolygonUtils::makeDisc(middle_, std::get<1>(outset), circle_definition_));
             }
@@ -106,7 +108,9 @@ void PrimeTower::generateFirtLayerInset()
             const size_t extruder_nr = last_extruder_toolpaths.extruder_nr;
             const coord_t line_width = scene.extruders[extruder_nr].settings_.get<coord_t>("prime_tower_line_width");
             ClosedLinesSet pattern = PolygonUtils::generateCircularInset(middle_, last_extruder_toolpaths.inner_radius, line_width, circle_definition_);
-            last_extruder_toolpaths.toolpaths.push_back(pattern);
+            auto toolpaths_with_inset = std::make_shared<ClosedLinesSet>(*last_extruder_toolpaths.toolpaths);
+            toolpaths_with_inset->push_back(pattern);
+            last_extruder_toolpaths.toolpaths = std::move(toolpaths_with_inset);
         }
     }
 }
@@ -135,6 +139,47 @@ std::tuple<ClosedLinesSet, coord_t> PrimeTower::generatePrimeToolpaths(const siz
     return { toolpaths, current_outer_radius + semi_line_width };
 }
 
+std::tuple<PrimeTower::SharedToolPaths, coord_t> PrimeTower::getCachedPrimeToolpaths(const size_t extruder_nr, const coord_t outer_radius)
+{
+    auto [iterator, inserted] = prime_toolpaths_cache_.try_emplace(std::make_tuple(extruder_nr, outer_radius));
+    if (inserted)
+    {
+        auto [toolpaths, inner_radius] = generatePrimeToolpaths(extruder_nr, outer_radius);
+        iterator->second = std::make_tuple(std::make_shared<const ClosedLinesSet>(std::move(toolpaths)), inner_radius);
+    }
+    return iterator->second;
+}
+
+PrimeTower::SharedToolPaths PrimeTower::getCachedSupportToolpaths(const size_t extruder_nr, const coord_t outer_radius, const coord_t inner_radius)
+{
+    auto [iterator, inserted] = support_toolpaths_cache_.try_emplace(std::make_tuple(extruder_nr, outer_radius, inner_radius));
+    if (inserted)
+    {
+        iterator->second = std::make_shared<const ClosedLinesSet>(generateSupportToolpaths(extruder_nr, outer_radius, inner_radius));
+    }
+    return iterator->second;
+}
+
+PrimeTower::SharedToolPaths PrimeTower::getJoinedToolpaths(const SharedToolPaths& first, const SharedToolPaths& second)
+{
+    if (second->empty())
+    {
+        return first;
+    }
+    if (first->empty())
+    {
+        return second;
+    }
+    auto [iterator, inserted] = joined_toolpaths_cache_.try_emplace(std::make_pair(first.get(), second.get()));
+    if (inserted)
+    {
+        auto joined = std::make_shared<ClosedLinesSet>(*first);
+        joined->push_back(*second);
+        iterator->second = std::move(joined);
+    }
+    return iterator->second;
+}
+
 ClosedLinesSet PrimeTower::generateSupportToolpaths(const size_t extruder_nr, const coord_t outer_radius, const coord_t inner_radius)
 {
     const Scene& scene = Application::getInstance().current_slice_->scene;
@@ -219,7 +264,7 @@ void PrimeTower::addToGcode(
             });
         if (iterator_extruder != iterator_layer->second.end())
         {
-            toolpaths = &(iterator_extruder->toolpaths);
+            toolpaths = iterator_extruder->toolpaths.get();
         }
     }
 
@@ -301,6 +346,11 @@ void PrimeTower::processExtrudersUse(LayerVector<std::vector<ExtruderUse>>& extr
     toolpaths_ = generateToolPaths(extruders_use);
     generateBase();
     generateFirtLayerInset();
+
+    // The layers keep the toolpaths they use, the ones that are only cached aren't needed anymore.
+    prime_toolpaths_cache_.clear();
+    support_toolpaths_cache_.clear();
+    joined_toolpaths_cache_.clear();
 }
 
 PrimeTower* PrimeTower::createPrimeTower(SliceDataStorage& storage)
@@ -63,7 +63,7 @@ std::map<LayerIndex, std::vector<PrimeTower::ExtruderToolPaths>> PrimeTowerInter
                 extruder_toolpaths.outer_radius = prime_next_outer_radius;
                 extruder_toolpaths.extruder_nr = extruder_use.extruder_nr;
 
-                std::tie(extruder_toolpaths.toolpaths, extruder_toolpaths.inner_radius) = generatePrimeToolpaths(extruder_use.extruder_nr, prime_next_outer_radius);
+                std::tie(extruder_toolpaths.toolpaths, extruder_toolpaths.inner_radius) = getCachedPrimeToolpaths(extruder_use.extruder_nr, prime_next_outer_radius);
                 toolpaths_at_layer.push_back(extruder_toolpaths);
 
                 prime_next_outer_radius = extruder_toolpaths.inner_radius;
@@ -88,12 +88,13 @@ std::map<LayerIndex, std::vector<PrimeTower::ExtruderToolPaths>> PrimeTowerInter
             {
                 if (toolpaths_at_layer.empty())
                 {
-                    toolpaths_at_layer.push_back(ExtruderToolPaths{ last_extruder_support, ClosedLinesSet(), prime_next_outer_radius, inner_support_radius });
+                    toolpaths_at_layer.push_back(ExtruderToolPaths{ last_extruder_support, std::make_shared<const ClosedLinesSet>(), prime_next_outer_radius, inner_support_radius });
                 }
 
+                // Most layers print the same patterns as the layers around them, so they share the toolpaths instead of generating their own
                 ExtruderToolPaths& last_extruder_toolpaths = toolpaths_at_layer.back();
-                ClosedLinesSet support_toolpaths = generateSupportToolpaths(last_extruder_toolpaths.extruder_nr, prime_next_outer_radius, inner_support_radius);
-                last_extruder_toolpaths.toolpaths.push_back(support_toolpaths);
+                const SharedToolPaths support_toolpaths = getCachedSupportToolpaths(last_extruder_toolpaths.extruder_nr, prime_next_outer_radius, inner_support_radius);
+                last_extruder_toolpaths.toolpaths = getJoinedToolpaths(last_extruder_toolpaths.toolpaths, support_toolpaths);
                 last_extruder_toolpaths.outer_radius = prime_next_outer_radius;
                 last_extruder_toolpaths.inner_radius = inner_support_radius;
             }
@@ -60,7 +60,7 @@ std::map<LayerIndex, std::vector<PrimeTower::ExtruderToolPaths>> PrimeTowerNorma
             return adhesion_a < adhesion_b;
         });
 
-    // For each extruder, generate the prime and support patterns, which will always be the same across layers
+    // For each extruder, generate the prime and support patterns, which will always be the same across layers, so all layers share them
     coord_t current_radius = tower_radius;
     std::map<size_t, ExtruderToolPaths> extruders_prime_toolpaths;
     std::map<size_t, ExtruderToolPaths> extruders_support_toolpaths;
@@ -69,11 +69,11 @@ std::map<LayerIndex, std::vector<PrimeTower::ExtruderToolPaths>> PrimeTowerNorma
         ExtruderToolPaths extruder_prime_toolpaths;
         extruder_prime_toolpaths.extruder_nr = extruder_nr;
         extruder_prime_toolpaths.outer_radius = current_radius;
-        std::tie(extruder_prime_toolpaths.toolpaths, extruder_prime_toolpaths.inner_radius) = generatePrimeToolpaths(extruder_nr, current_radius);
+        std::tie(extruder_prime_toolpaths.toolpaths, extruder_prime_toolpaths.inner_radius) = getCachedPrimeToolpaths(extruder_nr, current_radius);
         extruders_prime_toolpaths[extruder_nr] = extruder_prime_toolpaths;
 
         ExtruderToolPaths extruder_support_toolpaths = extruder_prime_toolpaths;
-        extruder_support_toolpaths.toolpaths = generateSupportToolpaths(extruder_nr, current_radius, extruder_prime_toolpaths.inner_radius);
+        extruder_support_toolpaths.toolpaths = getCachedSupportToolpaths(extruder_nr, current_radius, extruder_prime_toolpaths.inner_radius);
         extruders_support_toolpaths[extruder_nr] = extruder_support_toolpaths;
 
         current_radius = extruder_prime_toolpaths.inner_radius;
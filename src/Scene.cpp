@@ -3,9 +3,14 @@
 
 #include "Scene.h"
 
+#include <memory>
+#include <optional>
+
+#include <spdlog/details/os.h>
 #include <spdlog/spdlog.h>
 
 #include "Application.h"
+#include "AreasSnapshot.h"
 #include "FffProcessor.h" //To start a slice.
 #include "communication/Communication.h" //To flush g-code and layer view when we're done.
 #include "progress/Progress.h"
@@ -85,14 +90,32 @@ void Scene::processMeshGroup(MeshGroup& mesh_group)
         return;
     }
 
-    SliceDataStorage storage;
-    if (! fff_processor->polygon_generator.generateAreas(storage, &mesh_group, fff_processor->time_keeper))
+    // When only the g-code settings changed since the previous slice, the areas it generated can be used again.
+    std::optional<AreasSnapshot> areas_snapshot;
+    if (const auto snapshot_directory = spdlog::details::os::getenv("CURAENGINE_AREAS_SNAPSHOT"); ! snapshot_directory.empty())
     {
-        return;
+        areas_snapshot.emplace(snapshot_directory, mesh_group);
+    }
+
+    auto storage = std::make_unique<SliceDataStorage>();
+    if (! areas_snapshot || ! areas_snapshot->load(*storage, mesh_group))
+    {
+        if (areas_snapshot)
+        {
+            storage = std::make_unique<SliceDataStorage>(); // Loading may have filled it partially.
+        }
+        if (! fff_processor->polygon_generator.generateAreas(*storage, &mesh_group, fff_processor->time_keeper))
+        {
+            return;
+        }
+        if (areas_snapshot)
+        {
+            areas_snapshot->store(*storage);
+        }
     }
 
     Progress::messageProgressStage(Progress::Stage::EXPORT, &fff_processor->time_keeper);
-    fff_processor->gcode_writer.writeGCode(storage, fff_processor->time_keeper);
+    fff_processor->gcode_writer.writeGCode(*storage, fff_processor->time_keeper);
 
     Progress::messageProgress(Progress::Stage::FINISH, 1, 1); // 100% on this meshgroup
     Application::getInstance().communication_->flushGCode();
@@ -104,7 +104,8 @@ void SkeletalTrapezoidation::transferEdge(
     }
     else
     {
-        std::vector<Point2LL> discretized = discretize(vd_edge, points, segments);
+        std::vector<Point2LL>& discretized = discretization_buffer_;
+        discretize(vd_edge, points, segments, discretized);
         assert(discretized.size() >= 2);
         if (discretized.size() < 2)
         {
@@ -159,8 +160,14 @@ void SkeletalTrapezoidation::transferEdge(
     }
 }
 
-std::vector<Point2LL> SkeletalTrapezoidation::discretize(const vd_t::edge_type& vd_edge, const std::vector<Point2LL>& points, const std::vector<Segment>& segments)
+void SkeletalTrapezoidation::discretize(
+    const vd_t::edge_type& vd_edge,
+    const std::vector<Point2LL>& points,
+    const std::vector<Segment>& segments,
+    std::vector<Point2LL>& discretized)
 {
+    discretized.clear();
+
     /*Terminology in this function assumes that the edge moves horizontally from
     left to right. This is not necessarily the case; the edge can go in any
     direction, but it helps to picture it in a certain direction in your head.*/
@@ -174,13 +181,16 @@ std::vector<Point2LL> SkeletalTrapezoidation::discretize(const vd_t::edge_type&
     bool point_right = right_cell->contains_point();
     if ((! point_left && ! point_right) || vd_edge.is_secondary()) // Source vert is directly connected to source segment
     {
-        return std::vector<Point2LL>({ start, end });
+        discretized.emplace_back(start);
+        discretized.emplace_back(end);
+        return;
     }
     else if (point_left != point_right) // This is a parabolic edge between a point and a line.
     {
         Point2LL p = VoronoiUtils::getSourcePoint(*(point_left ? left_cell : right_cell), points, segments);
         const Segment& s = VoronoiUtils::getSourceSegment(*(point_left ? right_cell : left_cell), points, segments);
-        return VoronoiUtils::discretizeParabola(p, s, start, end, discretization_step_size_, transitioning_angle_);
+        VoronoiUtils::discretizeParabola(p, s, start, end, discretization_step_size_, transitioning_angle_, discretized);
+        return;
     }
     else // This is a straight edge between two points.
     {
@@ -222,8 +232,7 @@ std::vector<Point2LL> SkeletalTrapezoidation::discretize(const vd_t::edge_type&
         // Start generating points along the edge.
         Point2LL a = start;
         Point2LL b = end;
-        std::vector<Point2LL> ret;
-        ret.emplace_back(a);
+        discretized.emplace_back(a);
 
         // Introduce an extra edge at the borders of the markings?
         bool add_marking_start = marking_start_x * direction > start_x * direction;
@@ -243,22 +252,21 @@ std::vector<Point2LL> SkeletalTrapezoidation::discretize(const vd_t::edge_type&
             coord_t x_here = projected_x(here); // If we've surpassed the position of the extra markings, we may need to insert them first.
             if (add_marking_start && marking_start_x * direction < x_here * direction)
             {
-                ret.emplace_back(marking_start);
+                discretized.emplace_back(marking_start);
                 add_marking_start = false;
             }
             if (add_marking_end && marking_end_x * direction < x_here * direction)
             {
-                ret.emplace_back(marking_end);
+                discretized.emplace_back(marking_end);
                 add_marking_end = false;
             }
-            ret.emplace_back(here);
+            discretized.emplace_back(here);
         }
         if (add_marking_end && marking_end_x * direction < end_x * direction)
         {
-            ret.emplace_back(marking_end);
+            discretized.emplace_back(marking_end);
         }
-        ret.emplace_back(b);
-        return ret;
+        discretized.emplace_back(b);
     }
 }
 
@@ -400,7 +408,14 @@ void SkeletalTrapezoidation::constructFromPolygons(const Shape& polys)
 
     std::vector<Point2LL> points; // Remains empty
 
-    std::vector<Segment> segments;
+    // The Voronoi builder and diagram keep their buffers between calls on the same thread, since walls are generated for every part of every layer.
+    thread_local std::vector<Segment> segments;
+    thread_local boost::polygon::default_voronoi_builder voronoi_builder;
+    thread_local vd_t vonoroi_diagram;
+    segments.clear();
+    voronoi_builder.clear();
+    vonoroi_diagram.clear();
+
     for (size_t poly_idx = 0; poly_idx < polys.size(); poly_idx++)
     {
         const Polygon& poly = polys[poly_idx];
@@ -410,8 +425,10 @@ void SkeletalTrapezoidation::constructFromPolygons(const Shape& polys)
         }
     }
 
-    vd_t vonoroi_diagram;
-    construct_voronoi(segments.begin(), segments.end(), &vonoroi_diagram);
+    boost::polygon::insert(segments.begin(), segments.end(), &voronoi_builder);
+    voronoi_builder.construct(&vonoroi_diagram);
+    vd_edge_to_he_edge_.reserve(vonoroi_diagram.num_edges());
+    vd_node_to_he_node_.reserve(vonoroi_diagram.num_vertices());
 
     for (vd_t::cell_type cell : vonoroi_diagram.cells())
     {
@@ -472,6 +489,9 @@ void SkeletalTrapezoidation::constructFromPolygons(const Shape& polys)
         transferEdge(VoronoiUtils::p(ending_vonoroi_edge->vertex0()), end_source_point, *ending_vonoroi_edge, prev_edge, start_source_point, end_source_point, points, segments);
         prev_edge->to_->data_.distance_to_boundary_ = 0;
     }
+    // The diagram is reused by the next call on this thread, so don't keep pointers into it.
+    vd_edge_to_he_edge_.clear();
+    vd_node_to_he_node_.clear();
 
     separatePointyQuadEndNodes();
 
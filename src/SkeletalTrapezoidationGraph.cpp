@@ -199,8 +199,8 @@ bool STHalfEdgeNode::isLocalMaximum(bool strict) const
 
 void SkeletalTrapezoidationGraph::collapseSmallEdges(coord_t snap_dist)
 {
-    std::unordered_map<edge_t*, std::list<edge_t>::iterator> edge_locator;
-    std::unordered_map<node_t*, std::list<node_t>::iterator> node_locator;
+    std::unordered_map<edge_t*, decltype(edges)::iterator> edge_locator;
+    std::unordered_map<node_t*, decltype(nodes)::iterator> node_locator;
 
     for (auto edge_it = edges.begin(); edge_it != edges.end(); ++edge_it)
     {
@@ -212,7 +212,7 @@ void SkeletalTrapezoidationGraph::collapseSmallEdges(coord_t snap_dist)
         node_locator.emplace(&*node_it, node_it);
     }
 
-    auto safelyRemoveEdge = [this, &edge_locator](edge_t* to_be_removed, std::list<edge_t>::iterator& current_edge_it, bool& edge_it_is_updated)
+    auto safelyRemoveEdge = [this, &edge_locator](edge_t* to_be_removed, decltype(edges)::iterator& current_edge_it, bool& edge_it_is_updated)
     {
         if (current_edge_it != edges.end() && to_be_removed == &*current_edge_it)
         {
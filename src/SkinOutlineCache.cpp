@@ -0,0 +1,54 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "SkinOutlineCache.h"
+
+#include "sliceDataStorage.h"
+
+namespace cura
+{
+
+SkinOutlineCache::SkinOutlineCache(const SliceMeshStorage& mesh)
+    : tree_(
+        mesh.layers.size(),
+        [&mesh](const size_t layer_idx)
+        {
+            Shape outlines;
+            for (const SliceLayerPart& part : mesh.layers[layer_idx].parts)
+            {
+                outlines.push_back(part.outline);
+            }
+            return outlines;
+        },
+        [](const Shape& below, const Shape& above)
+        {
+            return below.intersection(above);
+        },
+        [](const Shape& below)
+        {
+            return below.empty();
+        })
+{
+}
+
+Shape SkinOutlineCache::intersection(const LayerIndex first, const LayerIndex last)
+{
+    if (last < first)
+    {
+        return {};
+    }
+    if (first < 0 || static_cast<size_t>(last) >= tree_.layerCount())
+    {
+        return {}; // There is nothing outside of the mesh.
+    }
+
+    const std::vector<const Shape*> covering_nodes = tree_.cover(static_cast<size_t>(first), static_cast<size_t>(last) + 1);
+    Shape result = *covering_nodes.front();
+    for (size_t covering_idx = 1; covering_idx < covering_nodes.size() && ! result.empty(); covering_idx++)
+    {
+        result = result.intersection(*covering_nodes[covering_idx]);
+    }
+    return result;
+}
+
+} // namespace cura
@@ -8,6 +8,7 @@
 #include "Application.h"
 #include "ExtruderTrain.h"
 #include "Slice.h"
+#include "geometry/OffsetEngine.h"
 #include "geometry/OpenPolyline.h"
 #include "geometry/Shape.h"
 #include "settings/EnumSettings.h"
@@ -16,6 +17,7 @@
 #include "support.h"
 #include "utils/MixedPolylineStitcher.h"
 #include "utils/Simplify.h"
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -174,6 +176,8 @@ std::vector<coord_t> SkirtBrim::generatePrimaryBrim(std::vector<Offset>& all_bri
 {
     std::vector<coord_t> total_length(extruder_count_, 0U);
 
+    offsetReferenceOutlines(all_brim_offsets);
+
     for (size_t offset_idx = 0; offset_idx < all_brim_offsets.size(); offset_idx++)
     {
         Offset& offset = all_brim_offsets[offset_idx];
@@ -220,33 +224,30 @@ coord_t SkirtBrim::generateOffset(const Offset& offset, Shape& covered_area, std
     Shape brim;
     const ExtruderConfig& extruder_config = extruders_configs_[offset.extruder_nr_];
 
-    if (std::holds_alternative<Shape*>(offset.reference_outline_or_index_))
+    if (offset.reference_offset_)
+    {
+        brim = *offset.reference_offset_;
+    }
+    else
     {
-        Shape* reference_outline = std::get<Shape*>(offset.reference_outline_or_index_);
-        const coord_t offset_value = offset.offset_value_;
-        for (const Polygon& polygon : *reference_outline)
+        if (std::holds_alternative<Shape*>(offset.reference_outline_or_index_))
         {
-            const double area = polygon.area();
-            if (area > 0 && offset.outside_)
-            {
-                brim.push_back(polygon.offset(offset_value, ClipperLib::jtRound));
-            }
-            else if (area < 0 && offset.inside_)
+            for (const Polygon& polygon : *std::get<Shape*>(offset.reference_outline_or_index_))
             {
-                brim.push_back(polygon.offset(-offset_value, ClipperLib::jtRound));
+                brim.push_back(offsetReferencePolygon(offset, polygon));
             }
         }
-    }
-    else
-    {
-        const int reference_idx = std::get<int>(offset.reference_outline_or_index_);
-        const coord_t offset_dist = extruder_config.line_width_;
+        else
+        {
+            const int reference_idx = std::get<int>(offset.reference_outline_or_index_);
+            const coord_t offset_dist = extruder_config.line_width_;
 
-        brim.push_back(storage_.skirt_brim[offset.extruder_nr_][reference_idx].offset(offset_dist, ClipperLib::jtRound));
+            brim.push_back(storage_.skirt_brim[offset.extruder_nr_][reference_idx].offset(offset_dist, ClipperLib::jtRound));
+        }
+        brim = Simplify(Application::getInstance().current_slice_->scene.extruders[offset.extruder_nr_].settings_).polygon(brim);
     }
 
     // limit brim lines to allowed areas, stitch them and store them in the result
-    brim = Simplify(Application::getInstance().current_slice_->scene.extruders[offset.extruder_nr_].settings_).polygon(brim);
 
     OpenLinesSet brim_lines = allowed_areas_per_extruder[offset.extruder_nr_].intersection(brim, false);
     length_added = brim_lines.length();
@@ -284,6 +285,70 @@ coord_t SkirtBrim::generateOffset(const Offset& offset, Shape& covered_area, std
     return length_added;
 }
 
+void SkirtBrim::offsetReferenceOutlines(std::vector<Offset>& offsets) const
+{
+    // Every polygon of every reference outline is offset separately, so those are the tasks to spread over the threads.
+    struct ReferencePolygon
+    {
+        const Offset* offset;
+        const Polygon* polygon;
+    };
+    std::vector<Offset*> reference_offsets;
+    std::vector<ReferencePolygon> reference_polygons;
+    for (Offset& offset : offsets)
+    {
+        if (std::holds_alternative<Shape*>(offset.reference_outline_or_index_))
+        {
+            reference_offsets.push_back(&offset);
+            for (const Polygon& polygon : *std::get<Shape*>(offset.reference_outline_or_index_))
+            {
+                reference_polygons.push_back(ReferencePolygon{ .offset = &offset, .polygon = &polygon });
+            }
+        }
+    }
+
+    std::vector<Shape> offset_polygons(reference_polygons.size());
+    cura::parallel_for<size_t>(
+        0,
+        reference_polygons.size(),
+        [&](const size_t polygon_idx)
+        {
+            offset_polygons[polygon_idx] = offsetReferencePolygon(*reference_polygons[polygon_idx].offset, *reference_polygons[polygon_idx].polygon);
+        });
+
+    size_t polygon_idx = 0;
+    for (Offset* offset : reference_offsets)
+    {
+        Shape& brim = offset->reference_offset_.emplace();
+        for (; polygon_idx < reference_polygons.size() && reference_polygons[polygon_idx].offset == offset; polygon_idx++)
+        {
+            brim.push_back(offset_polygons[polygon_idx]);
+        }
+    }
+    cura::parallel_for<size_t>(
+        0,
+        reference_offsets.size(),
+        [&](const size_t offset_idx)
+        {
+            Offset& offset = *reference_offsets[offset_idx];
+            offset.reference_offset_ = Simplify(Application::getInstance().current_slice_->scene.extruders[offset.extruder_nr_].settings_).polygon(*offset.reference_offset_);
+        });
+}
+
+Shape SkirtBrim::offsetReferencePolygon(const Offset& offset, const Polygon& polygon)
+{
+    const double area = polygon.area();
+    if (area > 0 && offset.outside_)
+    {
+        return polygon.offset(offset.offset_value_, ClipperLib::jtRound);
+    }
+    if (area < 0 && offset.inside_)
+    {
+        return polygon.offset(-offset.offset_value_, ClipperLib::jtRound);
+    }
+    return {};
+}
+
 Shape SkirtBrim::getFirstLayerOutline(const int extruder_nr /* = -1 */)
 {
     Shape first_layer_outline;
@@ -314,8 +379,9 @@ Shape SkirtBrim::getFirstLayerOutline(const int extruder_nr /* = -1 */)
         {
             constexpr bool include_support = true;
             constexpr bool include_prime_tower = true;
-            first_layer_outline = first_layer_outline.unionPolygons(storage_.getLayerOutlines(i_layer, include_support, include_prime_tower, true));
+            first_layer_outline.push_back(storage_.getLayerOutlines(i_layer, include_support, include_prime_tower, true));
         }
+        first_layer_outline = first_layer_outline.unionPolygonsParallel(); // Only the outer polygons, so the layers can be unioned all at once.
 
         Shape shields;
         if (has_ooze_shield_)
@@ -341,7 +407,7 @@ Shape SkirtBrim::getFirstLayerOutline(const int extruder_nr /* = -1 */)
         constexpr bool include_prime_tower = false; // Not included, has its own brim
         constexpr bool external_polys_only = false; // Gather all polygons and treat them separately.
         first_layer_outline = storage_.getLayerOutlines(layer_nr, include_support, include_prime_tower, external_polys_only, extruder_nr);
-        first_layer_outline = first_layer_outline.unionPolygons(); // To guard against overlapping outlines, which would produce holes according to the even-odd rule.
+        first_layer_outline = first_layer_outline.unionPolygonsParallel(); // To guard against overlapping outlines, which would produce holes according to the even-odd rule.
 
         if (storage_.support.generated && primary_line_count > 0 && ! storage_.support.supportLayers.empty()
             && (extruder_nr == -1 || extruder_nr == global_settings.get<int>("support_infill_extruder_nr")))
@@ -358,32 +424,42 @@ Shape SkirtBrim::getFirstLayerOutline(const int extruder_nr /* = -1 */)
                 //  |+-+|     |+--+|
                 //  +---+     +----+
                 const coord_t primary_extruder_skirt_brim_line_width = reference_extruder_config.line_width_;
-                Shape model_brim_covered_area;
 
                 // always leave a gap of an even number of brim lines, so that it fits if it's generating brim from both sides
                 const coord_t offset = primary_extruder_skirt_brim_line_width * (primary_line_count + primary_line_count % 2);
 
-                for (const Polygon& polygon : first_layer_outline)
-                {
-                    // Compute the fringe that the brim is going to cover around the model
-                    Shape outset;
-                    Shape inset;
-
-                    double area = polygon.area();
-                    if (area > 0 && reference_extruder_config.outside_polys_)
+                // The fringes of the polygons don't depend on each other, so they're computed in parallel and then unioned all at once.
+                std::vector<Shape> fringes(first_layer_outline.size());
+                cura::parallel_for<size_t>(
+                    0,
+                    first_layer_outline.size(),
+                    [&](const size_t polygon_idx)
                     {
-                        outset = polygon.offset(offset, ClipperLib::jtRound);
-                        inset.push_back(polygon);
-                    }
-                    else if (area < 0 && reference_extruder_config.inside_polys_)
-                    {
-                        outset.push_back(polygon);
-                        inset = polygon.offset(-offset, ClipperLib::jtRound);
-                    }
-
-                    outset = outset.difference(inset);
-                    model_brim_covered_area = model_brim_covered_area.unionPolygons(outset);
+                        // Compute the fringe that the brim is going to cover around the model
+                        const Polygon& polygon = first_layer_outline[polygon_idx];
+                        Shape outset;
+                        Shape inset;
+
+                        double area = polygon.area();
+                        if (area > 0 && reference_extruder_config.outside_polys_)
+                        {
+                            outset = polygon.offset(offset, ClipperLib::jtRound);
+                            inset.push_back(polygon);
+                        }
+                        else if (area < 0 && reference_extruder_config.inside_polys_)
+                        {
+                            outset.push_back(polygon);
+                            inset = polygon.offset(-offset, ClipperLib::jtRound);
+                        }
+
+                        fringes[polygon_idx] = outset.difference(inset);
+                    });
+                Shape model_brim_covered_area;
+                for (Shape& fringe : fringes)
+                {
+                    model_brim_covered_area.push_back(std::move(fringe));
                 }
+                model_brim_covered_area = model_brim_covered_area.unionPolygonsParallel();
 
                 AABB model_brim_covered_area_boundary_box(model_brim_covered_area);
                 support_layer.excludeAreasFromSupportInfillAreas(model_brim_covered_area, model_brim_covered_area_boundary_box);
@@ -401,7 +477,7 @@ Shape SkirtBrim::getFirstLayerOutline(const int extruder_nr /* = -1 */)
         }
     }
     constexpr coord_t join_distance = 20;
-    first_layer_outline = first_layer_outline.offset(join_distance).offset(-join_distance); // merge adjacent models into single polygon
+    first_layer_outline = first_layer_outline.unionPolygonsParallel().offset(join_distance).offset(-join_distance); // merge adjacent models into single polygon
     constexpr coord_t smallest_line_length = 200;
     constexpr coord_t largest_error_of_removed_point = 50;
     first_layer_outline = Simplify(smallest_line_length, largest_error_of_removed_point, 0).polygon(first_layer_outline);
@@ -541,102 +617,137 @@ std::vector<Shape> SkirtBrim::generateAllowedAreas(const std::vector<Shape>& sta
 {
     constexpr LayerIndex layer_nr = 0;
 
-    // For each extruder, pre-compute the areas covered by models/supports/prime tower
+    // For each extruder, pre-compute the areas covered by models/supports/prime tower, offset by the margin that each extruder keeps from them
     struct ExtruderOutlines
     {
         Shape models_outlines;
-        Shape supports_outlines;
+        std::vector<std::vector<Shape>> models_offsets; //!< For each of the models outlines, its offset for each extruder.
+        std::vector<Shape> supports_offsets; //!< For each extruder, the offset of the supports outlines.
     };
 
     std::vector<ExtruderOutlines> covered_area_by_extruder;
     if (adhesion_type_ == EPlatformAdhesion::BRIM)
     {
-        covered_area_by_extruder.resize(extruder_count_);
+        std::vector<coord_t> hole_brim_distances(extruder_count_, 0);
         for (size_t extruder_nr = 0; extruder_nr < extruder_count_; extruder_nr++)
         {
             if (extruders_configs_[extruder_nr].extruder_is_used_)
             {
+                hole_brim_distances[extruder_nr] = Application::getInstance().current_slice_->scene.extruders[extruder_nr].settings_.get<coord_t>("brim_inside_margin");
+            }
+        }
+
+        covered_area_by_extruder.resize(extruder_count_);
+        cura::parallel_for<size_t>(
+            0,
+            extruder_count_,
+            [&](const size_t other_extruder_nr)
+            {
+                if (! extruders_configs_[other_extruder_nr].extruder_is_used_)
+                {
+                    return;
+                }
+
                 // Gather models/support/prime tower areas separately to apply different margins
-                ExtruderOutlines& extruder_outlines = covered_area_by_extruder[extruder_nr];
+                ExtruderOutlines& extruder_outlines = covered_area_by_extruder[other_extruder_nr];
                 constexpr bool external_polys_only = false;
+                Shape supports_outlines;
                 {
                     constexpr bool include_support = false;
                     constexpr bool include_prime_tower = false;
                     constexpr bool include_model = true;
-                    extruder_outlines.models_outlines = storage_.getLayerOutlines(layer_nr, include_support, include_prime_tower, external_polys_only, extruder_nr, include_model);
+                    extruder_outlines.models_outlines
+                        = storage_.getLayerOutlines(layer_nr, include_support, include_prime_tower, external_polys_only, other_extruder_nr, include_model);
                 }
                 {
                     constexpr bool include_support = true;
                     constexpr bool include_prime_tower = true;
                     constexpr bool include_model = false;
-                    extruder_outlines.supports_outlines
-                        = storage_.getLayerOutlines(layer_nr, include_support, include_prime_tower, external_polys_only, extruder_nr, include_model);
+                    supports_outlines = storage_.getLayerOutlines(layer_nr, include_support, include_prime_tower, external_polys_only, other_extruder_nr, include_model);
                 }
-            }
-        }
+
+                // Every extruder keeps its own margin from the same outlines, so prepare each outline once and offset it by all of those margins.
+                std::vector<coord_t> margins(extruder_count_);
+                for (const Polygon& covered_surface : extruder_outlines.models_outlines)
+                {
+                    const double covered_area = covered_surface.area();
+                    for (size_t extruder_nr = 0; extruder_nr < extruder_count_; extruder_nr++)
+                    {
+                        const ExtruderConfig& extruder_config = extruders_configs_[extruder_nr];
+                        if (! extruder_config.extruder_is_used_)
+                        {
+                            margins[extruder_nr] = 0; // Not needed, and offsetting by zero just copies the outline.
+                            continue;
+                        }
+                        coord_t offset = extruder_config.line_width_ / 2;
+                        if ((other_extruder_nr == extruder_nr || static_cast<int>(extruder_nr) == skirt_brim_extruder_nr_)
+                            && ((covered_area > 0 && extruder_config.outside_polys_) || (covered_area < 0 && extruder_config.inside_polys_)))
+                        {
+                            // This is an area we are gonna intentionnally print brim in, use the actual gap
+                            offset += extruder_config.gap_ - 50; // Lower margin a bit to avoid discarding legitimate lines
+                        }
+                        else
+                        {
+                            // This is an area we do not expect brim to be printed in, use a larger gap to keep the printed surface clean
+                            offset += hole_brim_distances[extruder_nr];
+                        }
+                        margins[extruder_nr] = covered_area < 0 ? -offset : offset; // Invert offset to make holes grow inside
+                    }
+                    extruder_outlines.models_offsets.push_back(OffsetEngine(covered_surface, ClipperLib::jtRound).offsets(margins));
+                }
+
+                // Remove areas covered by support, with a low margin because we don't care if the brim touches it
+                for (size_t extruder_nr = 0; extruder_nr < extruder_count_; extruder_nr++)
+                {
+                    margins[extruder_nr] = extruders_configs_[extruder_nr].extruder_is_used_ ? extruders_configs_[extruder_nr].line_width_ / 2 - 50 : 0;
+                }
+                extruder_outlines.supports_offsets = OffsetEngine(supports_outlines).offsets(margins);
+            });
     }
 
+    // The allowed areas of the extruders don't depend on each other.
     std::vector<Shape> allowed_areas_per_extruder(extruder_count_);
-    for (size_t extruder_nr = 0; extruder_nr < extruder_count_; extruder_nr++)
-    {
-        const ExtruderConfig& extruder_config = extruders_configs_[extruder_nr];
-
-        if (! extruder_config.extruder_is_used_)
+    cura::parallel_for<size_t>(
+        0,
+        extruder_count_,
+        [&](const size_t extruder_nr)
         {
-            continue;
-        }
+            const ExtruderConfig& extruder_config = extruders_configs_[extruder_nr];
 
-        // Initialize allowed area to full build plate, then remove disallowed areas
-        Shape& allowed_areas = allowed_areas_per_extruder[extruder_nr];
-        allowed_areas = storage_.getMachineBorder(extruder_nr);
+            if (! extruder_config.extruder_is_used_)
+            {
+                return;
+            }
 
-        if (adhesion_type_ == EPlatformAdhesion::BRIM)
-        {
-            const Settings& settings = Application::getInstance().current_slice_->scene.extruders[extruder_nr].settings_;
-            const coord_t hole_brim_distance = settings.get<coord_t>("brim_inside_margin");
+            // Initialize allowed area to full build plate, then remove disallowed areas
+            Shape& allowed_areas = allowed_areas_per_extruder[extruder_nr];
+            allowed_areas = storage_.getMachineBorder(extruder_nr);
 
-            for (size_t other_extruder_nr = 0; other_extruder_nr < covered_area_by_extruder.size(); ++other_extruder_nr)
+            for (const ExtruderOutlines& extruder_outlines : covered_area_by_extruder)
             {
-                const ExtruderOutlines& extruder_outlines = covered_area_by_extruder[other_extruder_nr];
-                const coord_t base_offset = extruder_config.line_width_ / 2;
-
                 // Remove areas covered by models
-                for (const Polygon& covered_surface : extruder_outlines.models_outlines)
+                for (size_t surface_idx = 0; surface_idx < extruder_outlines.models_outlines.size(); surface_idx++)
                 {
-                    coord_t offset = base_offset;
-                    const double covered_area = covered_surface.area();
-
-                    if ((other_extruder_nr == extruder_nr || extruder_nr == skirt_brim_extruder_nr_)
-                        && ((covered_area > 0 && extruder_config.outside_polys_) || (covered_area < 0 && extruder_config.inside_polys_)))
-                    {
-                        // This is an area we are gonna intentionnally print brim in, use the actual gap
-                        offset += extruder_config.gap_ - 50; // Lower margin a bit to avoid discarding legitimate lines
-                    }
-                    else
-                    {
-                        // This is an area we do not expect brim to be printed in, use a larger gap to keep the printed surface clean
-                        offset += hole_brim_distance;
-                    }
-
-                    if (covered_area < 0)
+                    const Shape& covered_surface_offset = extruder_outlines.models_offsets[surface_idx][extruder_nr];
+                    if (extruder_outlines.models_outlines[surface_idx].area() < 0)
                     {
-                        // Invert offset to make holes grow inside
-                        allowed_areas.push_back(covered_surface.offset(-offset, ClipperLib::jtRound));
+                        allowed_areas.push_back(covered_surface_offset);
                     }
                     else
                     {
-                        allowed_areas = allowed_areas.difference(covered_surface.offset(offset, ClipperLib::jtRound));
+                        allowed_areas = allowed_areas.difference(covered_surface_offset);
                     }
                 }
 
-                // Remove areas covered by support, with a low margin because we don't care if the brim touches it
-                allowed_areas = allowed_areas.difference(extruder_outlines.supports_outlines.offset(base_offset - 50));
+                if (! extruder_outlines.supports_offsets.empty())
+                {
+                    allowed_areas = allowed_areas.difference(extruder_outlines.supports_offsets[extruder_nr]);
+                }
             }
-        }
 
-        // Anyway, don't allow a brim/skirt to grow inside itself, which may happen e.g. with ooze shield+skirt
-        allowed_areas = allowed_areas.difference(starting_outlines[extruder_nr].offset(extruder_config.gap_ - 50, ClipperLib::jtRound));
-    }
+            // Anyway, don't allow a brim/skirt to grow inside itself, which may happen e.g. with ooze shield+skirt
+            allowed_areas = allowed_areas.difference(starting_outlines[extruder_nr].offset(extruder_config.gap_ - 50, ClipperLib::jtRound));
+        });
 
     return allowed_areas_per_extruder;
 }
@@ -679,12 +790,13 @@ void SkirtBrim::generateSupportBrim()
     const Shape brim_area = support_outline.difference(support_outline.offset(-brim_width));
     support_layer.excludeAreasFromSupportInfillAreas(brim_area, AABB(brim_area));
 
+    OffsetEngine support_outline_offsetter(support_outline, ClipperLib::jtRound); // Every brim line is an offset of the same outline.
     coord_t offset_distance = brim_line_width / 2;
     for (size_t skirt_brim_number = 0; skirt_brim_number < line_count; skirt_brim_number++)
     {
         offset_distance -= brim_line_width;
 
-        Shape brim_line = support_outline.offset(offset_distance, ClipperLib::jtRound);
+        Shape brim_line = support_outline_offsetter.offset(offset_distance);
 
         // Remove small inner skirt and brim holes. Holes have a negative area, remove anything smaller then multiplier x extrusion "area"
         for (size_t n = 0; n < brim_line.size(); n++)
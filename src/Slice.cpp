@@ -9,6 +9,7 @@
 #endif
 
 #include "ExtruderTrain.h"
+#include "utils/CancellationToken.h"
 
 namespace cura
 {
@@ -34,7 +35,15 @@ void Slice::compute()
         {
             extruder.settings_.setParent(&scene.current_mesh_group->settings);
         }
-        scene.processMeshGroup(*mesh_group);
+        try
+        {
+            scene.processMeshGroup(*mesh_group);
+        }
+        catch (const CancelledException&)
+        {
+            spdlog::info("Slicing was cancelled.");
+            break;
+        }
     }
 }
 
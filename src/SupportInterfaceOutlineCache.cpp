@@ -0,0 +1,50 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "SupportInterfaceOutlineCache.h"
+
+#include <algorithm>
+
+#include "sliceDataStorage.h"
+
+namespace cura
+{
+
+SupportInterfaceOutlineCache::SupportInterfaceOutlineCache(const SliceMeshStorage& mesh)
+    : tree_(
+        mesh.layers.size(),
+        [&mesh](const size_t layer_idx)
+        {
+            return mesh.layers[layer_idx].getOutlines().unionPolygons();
+        },
+        [](const Shape& below, const Shape& above)
+        {
+            return below.unionPolygons(above);
+        })
+{
+}
+
+Shape SupportInterfaceOutlineCache::unionOf(const LayerIndex first, const LayerIndex last)
+{
+    // Only the layers of the mesh have outlines.
+    const int64_t begin = std::max<int64_t>(first, 0);
+    const int64_t end = std::min<int64_t>(last + 1, tree_.layerCount());
+    if (end <= begin)
+    {
+        return {};
+    }
+
+    const std::vector<const Shape*> covering_nodes = tree_.cover(static_cast<size_t>(begin), static_cast<size_t>(end));
+    if (covering_nodes.size() == 1)
+    {
+        return *covering_nodes.front();
+    }
+    Shape result;
+    for (const Shape* covering_node : covering_nodes)
+    {
+        result.push_back(*covering_node);
+    }
+    return result.unionPolygons();
+}
+
+} // namespace cura
@@ -0,0 +1,193 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "TimeEstimateWorker.h"
+
+#include "Application.h" //To look up settings in the slice that started the thread.
+
+namespace cura
+{
+
+TimeEstimateWorker::~TimeEstimateWorker()
+{
+    if (! worker_.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+    worker_.join();
+}
+
+void TimeEstimateWorker::startThread()
+{
+    if (! isThreaded())
+    {
+        worker_ = std::thread(
+            [this, slice = Application::current_slice_]()
+            {
+                CurrentSliceScope slice_scope(slice);
+                estimateLayers();
+            });
+    }
+}
+
+bool TimeEstimateWorker::isThreaded() const
+{
+    return worker_.joinable();
+}
+
+void TimeEstimateWorker::setFirmwareDefaults(const Settings& settings)
+{
+    record(Command{ .type = Command::Type::SET_FIRMWARE_DEFAULTS, .settings = &settings });
+}
+
+void TimeEstimateWorker::setLookahead(const size_t lookahead)
+{
+    record(Command{ .type = Command::Type::SET_LOOKAHEAD, .value = static_cast<double>(lookahead) });
+}
+
+void TimeEstimateWorker::plan(const TimeEstimateCalculator::Position& new_position, const Velocity& feedrate, const PrintFeatureType feature)
+{
+    record(Command{ .type = Command::Type::PLAN, .value = feedrate, .position = new_position, .feature = feature });
+}
+
+void TimeEstimateWorker::addTime(const Duration& time)
+{
+    record(Command{ .type = Command::Type::ADD_TIME, .value = time });
+}
+
+void TimeEstimateWorker::setAcceleration(const Acceleration& acceleration)
+{
+    record(Command{ .type = Command::Type::SET_ACCELERATION, .value = acceleration });
+}
+
+void TimeEstimateWorker::setMaxXyJerk(const Velocity& jerk)
+{
+    record(Command{ .type = Command::Type::SET_MAX_XY_JERK, .value = jerk });
+}
+
+void TimeEstimateWorker::reset()
+{
+    record(Command{ .type = Command::Type::RESET });
+}
+
+void TimeEstimateWorker::endLayer()
+{
+    if (! isThreaded())
+    {
+        estimates_.push_back(calculator_.calculate());
+        calculator_.reset();
+        return;
+    }
+    {
+        std::lock_guard lock(mutex_);
+        pending_layers_.push_back(std::move(current_layer_));
+        layers_in_progress_++;
+    }
+    condition_.notify_all();
+    current_layer_ = std::vector<Command>();
+}
+
+std::optional<std::vector<Duration>> TimeEstimateWorker::takeEstimate(const bool wait)
+{
+    std::unique_lock lock(mutex_);
+    if (wait)
+    {
+        condition_.wait(
+            lock,
+            [this]()
+            {
+                return ! estimates_.empty() || layers_in_progress_ == 0;
+            });
+    }
+    if (estimates_.empty())
+    {
+        return std::nullopt;
+    }
+    std::vector<Duration> estimate = std::move(estimates_.front());
+    estimates_.pop_front();
+    return estimate;
+}
+
+void TimeEstimateWorker::record(Command&& command)
+{
+    if (isThreaded())
+    {
+        current_layer_.push_back(std::move(command));
+    }
+    else
+    {
+        apply(command);
+    }
+}
+
+void TimeEstimateWorker::apply(const Command& command)
+{
+    switch (command.type)
+    {
+    case Command::Type::SET_FIRMWARE_DEFAULTS:
+        calculator_.setFirmwareDefaults(*command.settings);
+        break;
+    case Command::Type::SET_LOOKAHEAD:
+        calculator_.setLookahead(static_cast<size_t>(command.value));
+        break;
+    case Command::Type::PLAN:
+        calculator_.plan(command.position, command.value, command.feature);
+        break;
+    case Command::Type::ADD_TIME:
+        calculator_.addTime(command.value);
+        break;
+    case Command::Type::SET_ACCELERATION:
+        calculator_.setAcceleration(command.value);
+        break;
+    case Command::Type::SET_MAX_XY_JERK:
+        calculator_.setMaxXyJerk(command.value);
+        break;
+    case Command::Type::RESET:
+        calculator_.reset();
+        break;
+    }
+}
+
+void TimeEstimateWorker::estimateLayers()
+{
+    while (true)
+    {
+        std::vector<Command> layer;
+        {
+            std::unique_lock lock(mutex_);
+            condition_.wait(
+                lock,
+                [this]()
+                {
+                    return ! pending_layers_.empty() || stopping_;
+                });
+            if (stopping_)
+            {
+                return;
+            }
+            layer = std::move(pending_layers_.front());
+            pending_layers_.pop_front();
+        }
+
+        for (const Command& command : layer)
+        {
+            apply(command);
+        }
+        std::vector<Duration> estimate = calculator_.calculate();
+        calculator_.reset();
+
+        {
+            std::lock_guard lock(mutex_);
+            estimates_.push_back(std::move(estimate));
+            layers_in_progress_--;
+        }
+        condition_.notify_all();
+    }
+}
+
+} // namespace cura
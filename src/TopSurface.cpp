@@ -41,24 +41,37 @@ void TopSurface::setAreasFromMeshAndLayerNumber(SliceMeshStorage& mesh, size_t l
     }
 }
 
-bool TopSurface::ironing(const SliceDataStorage& storage, const SliceMeshStorage& mesh, const GCodePathConfig& line_config, LayerPlan& layer, const FffGcodeWriter& gcode_writer)
-    const
+namespace
+{
+
+//! The direction of the ironing lines on a layer, which is always perpendicular to the skin lines.
+AngleDegrees getIroningDirection(const SliceMeshStorage& mesh, const LayerIndex layer_nr)
+{
+    const size_t roofing_layer_count = std::min(mesh.settings.get<size_t>("roofing_layer_count"), mesh.settings.get<size_t>("top_layers"));
+    const std::vector<AngleDegrees>& top_most_skin_angles = (roofing_layer_count > 0) ? mesh.roofing_angles : mesh.skin_angles;
+    assert(top_most_skin_angles.size() > 0);
+    return top_most_skin_angles[layer_nr % top_most_skin_angles.size()] + AngleDegrees(90.0);
+}
+
+} // namespace
+
+void TopSurface::generateIroning(const SliceMeshStorage& mesh, const LayerIndex layer_nr)
 {
+    ironed_areas.clear();
+    ironing_paths.clear();
+    ironing_polygons.clear();
+    ironing_lines.clear();
     if (areas.empty())
     {
-        return false; // Nothing to do.
+        return; // Nothing to do.
     }
     // Generate the lines to cover the surface.
-    const int extruder_nr = mesh.settings.get<ExtruderTrain&>("top_bottom_extruder_nr").extruder_nr_;
     const EFillMethod pattern = mesh.settings.get<EFillMethod>("ironing_pattern");
     const bool zig_zaggify_infill = pattern == EFillMethod::ZIG_ZAG;
     constexpr bool connect_polygons = false; // midway connections can make the surface less smooth
     const coord_t line_spacing = mesh.settings.get<coord_t>("ironing_line_spacing");
-    const coord_t line_width = line_config.getLineWidth();
-    const size_t roofing_layer_count = std::min(mesh.settings.get<size_t>("roofing_layer_count"), mesh.settings.get<size_t>("top_layers"));
-    const std::vector<AngleDegrees>& top_most_skin_angles = (roofing_layer_count > 0) ? mesh.roofing_angles : mesh.skin_angles;
-    assert(top_most_skin_angles.size() > 0);
-    const AngleDegrees direction = top_most_skin_angles[layer.getLayerNr() % top_most_skin_angles.size()] + AngleDegrees(90.0); // Always perpendicular to the skin lines.
+    const coord_t line_width = line_spacing; // The line width of the ironing config.
+    const AngleDegrees direction = getIroningDirection(mesh, layer_nr);
     constexpr coord_t infill_overlap = 0;
     constexpr int infill_multiplier = 1;
     constexpr coord_t shift = 0;
@@ -87,7 +100,7 @@ bool TopSurface::ironing(const SliceDataStorage& storage, const SliceMeshStorage
         // Align the edge of the ironing line with the edge of the outer wall
         ironing_inset -= ironing_flow * line_width / 2;
     }
-    Shape ironed_areas = areas.offset(ironing_inset);
+    ironed_areas = areas.offset(ironing_inset);
 
     Infill infill_generator(
         pattern,
@@ -99,7 +112,7 @@ bool TopSurface::ironing(const SliceDataStorage& storage, const SliceMeshStorage
         infill_overlap,
         infill_multiplier,
         direction,
-        layer.z_ - 10,
+        mesh.layers[layer_nr].printZ - 10,
         shift,
         max_resolution,
         max_deviation,
@@ -107,15 +120,21 @@ bool TopSurface::ironing(const SliceDataStorage& storage, const SliceMeshStorage
         small_area_width,
         infill_origin,
         skip_line_stitching);
-    std::vector<VariableWidthLines> ironing_paths;
-    Shape ironing_polygons;
-    OpenLinesSet ironing_lines;
-    infill_generator.generate(ironing_paths, ironing_polygons, ironing_lines, mesh.settings, layer.getLayerNr(), SectionType::IRONING);
+    infill_generator.generate(ironing_paths, ironing_polygons, ironing_lines, mesh.settings, layer_nr, SectionType::IRONING);
+}
 
+bool TopSurface::ironing(const SliceDataStorage& storage, const SliceMeshStorage& mesh, const GCodePathConfig& line_config, LayerPlan& layer, const FffGcodeWriter& gcode_writer)
+    const
+{
     if (ironing_polygons.empty() && ironing_lines.empty() && ironing_paths.empty())
     {
         return false; // Nothing to do.
     }
+    const int extruder_nr = mesh.settings.get<ExtruderTrain&>("top_bottom_extruder_nr").extruder_nr_;
+    const EFillMethod pattern = mesh.settings.get<EFillMethod>("ironing_pattern");
+    const coord_t line_spacing = mesh.settings.get<coord_t>("ironing_line_spacing");
+    const AngleDegrees direction = getIroningDirection(mesh, layer.getLayerNr());
+    const bool enforce_monotonic_order = mesh.settings.get<bool>("ironing_monotonic");
 
     layer.mode_skip_agressive_merge_ = true;
 
@@ -27,7 +27,8 @@ TreeModelVolumes::TreeModelVolumes(
     size_t current_mesh_idx,
     double progress_multiplier,
     double progress_offset,
-    const std::vector<Shape>& additional_excluded_areas)
+    const std::vector<Shape>& additional_excluded_areas,
+    std::shared_ptr<const LayerOutlines> layer_outlines)
     : max_move_{ std::max(max_move - 2, coord_t(0)) }
     , // -2 to avoid rounding errors
     max_move_slow_{ std::max(max_move_slow - 2, coord_t(0)) }
@@ -49,14 +50,17 @@ TreeModelVolumes::TreeModelVolumes(
     coord_t min_maximum_deviation = std::numeric_limits<coord_t>::max();
     coord_t min_maximum_area_deviation = std::numeric_limits<coord_t>::max();
 
+    // The shared outlines were grouped from the same meshes, so the groups are found in the same order.
+    std::shared_ptr<LayerOutlines> new_layer_outlines = layer_outlines ? nullptr : std::make_shared<LayerOutlines>();
+    std::vector<const Settings*> outline_settings;
     support_rests_on_model_ = false;
     for (auto [mesh_idx, mesh_ptr] : storage.meshes | ranges::views::enumerate)
     {
         auto& mesh = *mesh_ptr;
         bool added = false;
-        for (auto [idx, layer_outline] : layer_outlines_ | ranges::views::enumerate)
+        for (auto [idx, settings] : outline_settings | ranges::views::enumerate)
         {
-            if (checkSettingsEquality(layer_outline.first, mesh.settings))
+            if (checkSettingsEquality(*settings, mesh.settings))
             {
                 added = true;
                 mesh_to_layeroutline_idx[mesh_idx] = idx;
@@ -64,12 +68,55 @@ TreeModelVolumes::TreeModelVolumes(
         }
         if (! added)
         {
-            mesh_to_layeroutline_idx[mesh_idx] = layer_outlines_.size();
-            layer_outlines_.emplace_back(mesh.settings, std::vector<Shape>(storage.support.supportLayers.size(), Shape()));
+            mesh_to_layeroutline_idx[mesh_idx] = outline_settings.size();
+            outline_settings.push_back(&mesh.settings);
+            if (new_layer_outlines)
+            {
+                new_layer_outlines->emplace_back(mesh.settings, std::vector<Shape>(storage.support.supportLayers.size(), Shape()));
+            }
+        }
+    }
+
+    if (new_layer_outlines)
+    {
+        // Retrieve all layer outlines. Done in this way because normally we don't do this per mesh, but for the whole buildplate.
+        // (So we can handle some settings on a per-mesh basis.)
+        for (auto [mesh_idx, mesh] : storage.meshes | ranges::views::enumerate)
+        {
+            // Workaround for compiler bug on apple-clang -- Closure won't properly capture variables in capture lists in outer scope.
+            const auto& mesh_idx_l = mesh_idx;
+            const auto& mesh_l = *mesh;
+            // ^^^ Remove when fixed (and rename accordingly in the below parallel-for).
+
+            cura::parallel_for<coord_t>(
+                0,
+                LayerIndex((*new_layer_outlines)[mesh_to_layeroutline_idx[mesh_idx_l]].second.size()),
+                [&](const LayerIndex layer_idx)
+                {
+                    if (mesh_l.layer_nr_max_filled_layer < layer_idx)
+                    {
+                        return; // Can't break as parallel_for wont allow it, this is equivalent to a continue.
+                    }
+                    Shape outline = extractOutlineFromMesh(mesh_l, layer_idx);
+                    (*new_layer_outlines)[mesh_to_layeroutline_idx[mesh_idx_l]].second[layer_idx].push_back(outline);
+                });
+        }
+        // Merge all the layer outlines together.
+        for (auto& layer_outline : *new_layer_outlines)
+        {
+            cura::parallel_for<coord_t>(
+                0,
+                LayerIndex(storage.support.supportLayers.size()),
+                [&](const LayerIndex layer_idx)
+                {
+                    layer_outline.second[layer_idx] = layer_outline.second[layer_idx].unionPolygons();
+                });
         }
+        layer_outlines = std::move(new_layer_outlines);
     }
+    layer_outlines_ = std::move(layer_outlines);
 
-    for (const auto data_pair : layer_outlines_)
+    for (const auto& data_pair : *layer_outlines_)
     {
         support_rests_on_model_ |= data_pair.first.get<ESupportType>("support_type") == ESupportType::EVERYWHERE;
         min_maximum_deviation = std::min(min_maximum_deviation, data_pair.first.get<coord_t>("meshfix_maximum_deviation"));
@@ -79,7 +126,7 @@ TreeModelVolumes::TreeModelVolumes(
 
     // Figure out the rest of the setting(-like variable)s relevant to the class a whole.
     current_outline_idx_ = mesh_to_layeroutline_idx[current_mesh_idx];
-    const TreeSupportSettings config(layer_outlines_[current_outline_idx_].first);
+    const TreeSupportSettings config((*layer_outlines_)[current_outline_idx_].first);
 
     if (config.support_overrides == SupportDistPriority::Z_OVERRIDES_XY)
     {
@@ -99,40 +146,6 @@ TreeModelVolumes::TreeModelVolumes(
     }
     increase_until_radius_ = config.increase_radius_until_radius;
 
-    // Retrieve all layer outlines. Done in this way because normally we don't do this per mesh, but for the whole buildplate.
-    // (So we can handle some settings on a per-mesh basis.)
-    for (auto [mesh_idx, mesh] : storage.meshes | ranges::views::enumerate)
-    {
-        // Workaround for compiler bug on apple-clang -- Closure won't properly capture variables in capture lists in outer scope.
-        const auto& mesh_idx_l = mesh_idx;
-        const auto& mesh_l = *mesh;
-        // ^^^ Remove when fixed (and rename accordingly in the below parallel-for).
-
-        cura::parallel_for<coord_t>(
-            0,
-            LayerIndex(layer_outlines_[mesh_to_layeroutline_idx[mesh_idx_l]].second.size()),
-            [&](const LayerIndex layer_idx)
-            {
-                if (mesh_l.layer_nr_max_filled_layer < layer_idx)
-                {
-                    return; // Can't break as parallel_for wont allow it, this is equivalent to a continue.
-                }
-                Shape outline = extractOutlineFromMesh(mesh_l, layer_idx);
-                layer_outlines_[mesh_to_layeroutline_idx[mesh_idx_l]].second[layer_idx].push_back(outline);
-            });
-    }
-    // Merge all the layer outlines together.
-    for (auto& layer_outline : layer_outlines_)
-    {
-        cura::parallel_for<coord_t>(
-            0,
-            LayerIndex(anti_overhang_.size()),
-            [&](const LayerIndex layer_idx)
-            {
-                layer_outline.second[layer_idx] = layer_outline.second[layer_idx].unionPolygons();
-            });
-    }
-
     // Gather all excluded areas, like support-blockers and trees that where already generated.
     cura::parallel_for<coord_t>(
         0,
@@ -177,7 +190,7 @@ void TreeModelVolumes::precalculate(coord_t max_layer)
 
     // Get the config corresponding to one mesh that is in the current group. Which one has to be irrelevant.
     // Not the prettiest way to do this, but it ensures some calculations that may be a bit more complex like initial layer diameter are only done in once.
-    const TreeSupportSettings config(layer_outlines_[current_outline_idx_].first);
+    const TreeSupportSettings config((*layer_outlines_)[current_outline_idx_].first);
 
     // Calculate which radius each layer in the tip may have.
     std::unordered_set<coord_t> possible_tip_radiis;
@@ -329,6 +342,21 @@ void TreeModelVolumes::precalculate(coord_t max_layer)
         dur_col_avo);
 }
 
+void TreeModelVolumes::evictAvoidancesAbove(LayerIndex layer_idx)
+{
+    for (RadiusLayerCache* cache : { &avoidance_cache_,
+                                     &avoidance_cache_slow_,
+                                     &avoidance_cache_hole_,
+                                     &avoidance_cache_to_model_,
+                                     &avoidance_cache_to_model_slow_,
+                                     &avoidance_cache_hole_to_model_,
+                                     &wall_restrictions_cache_,
+                                     &wall_restrictions_cache_min_ })
+    {
+        cache->evictAbove(layer_idx);
+    }
+}
+
 const Shape& TreeModelVolumes::getCollision(coord_t radius, LayerIndex layer_idx, bool min_xy_dist)
 {
     const coord_t orig_radius = radius;
@@ -346,10 +374,7 @@ const Shape& TreeModelVolumes::getCollision(coord_t radius, LayerIndex layer_idx
     }
     RadiusLayerPair key{ radius, layer_idx };
 
-    {
-        std::lock_guard<std::mutex> critical_section_support_max_layer_nr(*critical_avoidance_cache_);
-        result = getArea(collision_cache_, key);
-    }
+    result = collision_cache_.get(key.first, key.second);
     if (result)
     {
         return result.value().get();
@@ -376,10 +401,7 @@ const Shape& TreeModelVolumes::getCollisionHolefree(coord_t radius, LayerIndex l
     }
     RadiusLayerPair key{ radius, layer_idx };
 
-    {
-        std::lock_guard<std::mutex> critical_section_support_max_layer_nr(*critical_collision_cache_holefree_);
-        result = getArea(collision_cache_holefree_, key);
-    }
+    result = collision_cache_holefree_.get(key.first, key.second);
     if (result)
     {
         return result.value().get();
@@ -394,12 +416,9 @@ const Shape& TreeModelVolumes::getCollisionHolefree(coord_t radius, LayerIndex l
 
 const Shape& TreeModelVolumes::getAccumulatedPlaceable0(LayerIndex layer_idx)
 {
+    if (const auto result = accumulated_placeables_cache_radius_0_.get(0, layer_idx))
     {
-        std::lock_guard<std::mutex> critical_section_support_max_layer_nr(*critical_accumulated_placeables_cache_radius_0_);
-        if (accumulated_placeables_cache_radius_0_.count(layer_idx))
-        {
-            return accumulated_placeables_cache_radius_0_[layer_idx];
-        }
+        return result.value().get();
     }
     calculateAccumulatedPlaceable0(layer_idx);
     return getAccumulatedPlaceable0(layer_idx);
@@ -426,21 +445,17 @@ const Shape& TreeModelVolumes::getAvoidance(coord_t radius, LayerIndex layer_idx
 
     const RadiusLayerPair key{ radius, layer_idx };
 
-    std::unordered_map<RadiusLayerPair, Shape>* cache_ptr = nullptr;
-    std::mutex* mutex_ptr = nullptr;
+    const RadiusLayerCache* cache_ptr = nullptr;
     switch (type)
     {
     case AvoidanceType::FAST:
         cache_ptr = to_model ? &avoidance_cache_to_model_ : &avoidance_cache_;
-        mutex_ptr = to_model ? critical_avoidance_cache_to_model_.get() : critical_avoidance_cache_.get();
         break;
     case AvoidanceType::SLOW:
         cache_ptr = to_model ? &avoidance_cache_to_model_slow_ : &avoidance_cache_slow_;
-        mutex_ptr = to_model ? critical_avoidance_cache_to_model_slow_.get() : critical_avoidance_cache_slow_.get();
         break;
     case AvoidanceType::FAST_SAFE:
         cache_ptr = to_model ? &avoidance_cache_hole_to_model_ : &avoidance_cache_hole_;
-        mutex_ptr = to_model ? critical_avoidance_cache_holefree_to_model_.get() : critical_avoidance_cache_holefree_.get();
         break;
     case AvoidanceType::COLLISION:
         if (layer_idx <= max_layer_idx_without_blocker_)
@@ -450,7 +465,6 @@ const Shape& TreeModelVolumes::getAvoidance(coord_t radius, LayerIndex layer_idx
         else
         {
             cache_ptr = &avoidance_cache_collision_;
-            mutex_ptr = critical_avoidance_cache_collision_.get();
         }
         break;
     default:
@@ -458,10 +472,7 @@ const Shape& TreeModelVolumes::getAvoidance(coord_t radius, LayerIndex layer_idx
         break;
     }
 
-    {
-        std::lock_guard<std::mutex> critical_section(*mutex_ptr);
-        result = getArea(*cache_ptr, key);
-    }
+    result = cache_ptr->get(key.first, key.second);
     if (result)
     {
         return result.value().get();
@@ -497,10 +508,7 @@ const Shape& TreeModelVolumes::getPlaceableAreas(coord_t radius, LayerIndex laye
     radius = ceilRadius(radius);
     RadiusLayerPair key{ radius, layer_idx };
 
-    {
-        std::lock_guard<std::mutex> critical_section(*critical_placeable_areas_cache_);
-        result = getArea(placeable_areas_cache_, key);
-    }
+    result = placeable_areas_cache_.get(key.first, key.second);
     if (result)
     {
         return result.value().get();
@@ -536,11 +544,8 @@ const Shape& TreeModelVolumes::getWallRestriction(coord_t radius, LayerIndex lay
     radius = ceilRadius(radius);
     const RadiusLayerPair key{ radius, layer_idx };
 
-    std::unordered_map<RadiusLayerPair, Shape>* cache_ptr = min_xy_dist ? &wall_restrictions_cache_min_ : &wall_restrictions_cache_;
-    {
-        std::lock_guard<std::mutex> critical_section(min_xy_dist ? *critical_wall_restrictions_cache_min_ : *critical_wall_restrictions_cache_);
-        result = getArea(*cache_ptr, key);
-    }
+    const RadiusLayerCache& cache = min_xy_dist ? wall_restrictions_cache_min_ : wall_restrictions_cache_;
+    result = cache.get(key.first, key.second);
     if (result)
     {
         return result.value().get();
@@ -593,25 +598,6 @@ Shape TreeModelVolumes::extractOutlineFromMesh(const SliceMeshStorage& mesh, Lay
     return Simplify(maximum_resolution, maximum_deviation, maximum_area_deviation).polygon(total);
 }
 
-LayerIndex TreeModelVolumes::getMaxCalculatedLayer(coord_t radius, const std::unordered_map<RadiusLayerPair, Shape>& map) const
-{
-    LayerIndex max_layer = -1;
-
-    // the placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
-    const RadiusLayerPair key_layer_1(radius, 1);
-    if (getArea(map, key_layer_1))
-    {
-        max_layer = 1;
-    }
-
-    while (map.count(RadiusLayerPair(radius, max_layer + 1)))
-    {
-        max_layer++;
-    }
-
-    return max_layer;
-}
-
 void TreeModelVolumes::calculateCollision(const std::deque<RadiusLayerPair>& keys)
 {
     cura::parallel_for<size_t>(
@@ -623,28 +609,24 @@ void TreeModelVolumes::calculateCollision(const std::deque<RadiusLayerPair>& key
             RadiusLayerPair key(radius, 0);
             std::unordered_map<RadiusLayerPair, Shape> data_outer;
             std::unordered_map<RadiusLayerPair, Shape> data_placeable_outer;
-            for (const auto outline_idx : ranges::views::iota(0UL, layer_outlines_.size()))
+            for (const auto outline_idx : ranges::views::iota(0UL, layer_outlines_->size()))
             {
                 std::unordered_map<RadiusLayerPair, Shape> data;
                 std::unordered_map<RadiusLayerPair, Shape> data_placeable;
 
-                const coord_t layer_height = layer_outlines_[outline_idx].first.get<coord_t>("layer_height");
-                const bool support_rests_on_this_model = layer_outlines_[outline_idx].first.get<ESupportType>("support_type") == ESupportType::EVERYWHERE;
-                const coord_t z_distance_bottom = layer_outlines_[outline_idx].first.get<coord_t>("support_bottom_distance");
+                const coord_t layer_height = (*layer_outlines_)[outline_idx].first.get<coord_t>("layer_height");
+                const bool support_rests_on_this_model = (*layer_outlines_)[outline_idx].first.get<ESupportType>("support_type") == ESupportType::EVERYWHERE;
+                const coord_t z_distance_bottom = (*layer_outlines_)[outline_idx].first.get<coord_t>("support_bottom_distance");
                 const size_t z_distance_bottom_layers = round_up_divide(z_distance_bottom, layer_height);
-                const coord_t z_distance_top_layers = round_up_divide(layer_outlines_[outline_idx].first.get<coord_t>("support_top_distance"), layer_height);
+                const coord_t z_distance_top_layers = round_up_divide((*layer_outlines_)[outline_idx].first.get<coord_t>("support_top_distance"), layer_height);
                 const LayerIndex max_anti_overhang_layer = anti_overhang_.size() - 1;
                 const LayerIndex max_required_layer = keys[i].second + std::max(coord_t(1), z_distance_top_layers);
-                const coord_t xy_distance = outline_idx == current_outline_idx_ ? current_min_xy_dist_ : layer_outlines_[outline_idx].first.get<coord_t>("support_xy_distance");
+                const coord_t xy_distance = outline_idx == current_outline_idx_ ? current_min_xy_dist_ : (*layer_outlines_)[outline_idx].first.get<coord_t>("support_xy_distance");
                 // Technically this causes collision for the normal xy_distance to be larger by current_min_xy_dist_delta for all not currently processing meshes as this delta will
                 // be added at request time. Avoiding this would require saving each collision for each outline_idx separately,
                 //   and later for each avoidance... But avoidance calculation has to be for the whole scene and can NOT be done for each outline_idx separately and combined later.
                 // So avoiding this inaccuracy seems infeasible as it would require 2x the avoidance calculations => 0.5x the performance.
-                coord_t min_layer_bottom;
-                {
-                    std::lock_guard<std::mutex> critical_section(*critical_collision_cache_);
-                    min_layer_bottom = getMaxCalculatedLayer(radius, collision_cache_) - z_distance_bottom_layers;
-                }
+                coord_t min_layer_bottom = collision_cache_.getMaxCalculatedLayer(radius) - z_distance_bottom_layers;
 
                 if (min_layer_bottom < 0)
                 {
@@ -654,9 +636,9 @@ void TreeModelVolumes::calculateCollision(const std::deque<RadiusLayerPair>& key
                 {
                     key.second = layer_idx;
                     Shape collision_areas = machine_border_;
-                    if (size_t(layer_idx) < layer_outlines_[outline_idx].second.size())
+                    if (size_t(layer_idx) < (*layer_outlines_)[outline_idx].second.size())
                     {
-                        collision_areas.push_back(layer_outlines_[outline_idx].second[layer_idx]);
+                        collision_areas.push_back((*layer_outlines_)[outline_idx].second[layer_idx]);
                     }
                     collision_areas = collision_areas.offset(
                         radius
@@ -691,7 +673,7 @@ void TreeModelVolumes::calculateCollision(const std::deque<RadiusLayerPair>& key
                 {
                     key.second = layer_idx;
                     for (coord_t layer_offset = 1; layer_offset <= z_distance_top_layers
-                                                   && layer_offset + layer_idx < std::min(coord_t(layer_outlines_[outline_idx].second.size()), coord_t(max_required_layer + 1));
+                                                   && layer_offset + layer_idx < std::min(coord_t((*layer_outlines_)[outline_idx].second.size()), coord_t(max_required_layer + 1));
                          layer_offset++)
                     {
                         // If just the collision (including the xy distance) of the layers above is accumulated, it leads to the following issue:
@@ -720,7 +702,7 @@ void TreeModelVolumes::calculateCollision(const std::deque<RadiusLayerPair>& key
                         const coord_t required_range_x = coord_t(xy_distance - ((layer_offset - (z_distance_top_layers == 1 ? 0.5 : 0)) * xy_distance / z_distance_top_layers));
                         // ^^^ The conditional -0.5 ensures that plastic can never touch on the diagonal downward when the z_distance_top_layers = 1.
                         //      It is assumed to be better to not support an overhang<90� than to risk fusing to it.
-                        data[key].push_back(layer_outlines_[outline_idx].second[layer_idx + layer_offset].offset(radius + required_range_x));
+                        data[key].push_back((*layer_outlines_)[outline_idx].second[layer_idx + layer_offset].offset(radius + required_range_x));
                     }
                     data[key] = data[key].unionPolygons(max_anti_overhang_layer >= layer_idx ? anti_overhang_[layer_idx].offset(radius) : Shape());
                 }
@@ -755,16 +737,10 @@ void TreeModelVolumes::calculateCollision(const std::deque<RadiusLayerPair>& key
                 }
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_collision_cache_);
-                collision_cache_.insert(data_outer.begin(), data_outer.end());
-            }
+            collision_cache_.insert(data_outer);
             if (radius == 0)
             {
-                {
-                    std::lock_guard<std::mutex> critical_section(*critical_placeable_areas_cache_);
-                    placeable_areas_cache_.insert(data_placeable_outer.begin(), data_placeable_outer.end());
-                }
+                placeable_areas_cache_.insert(data_placeable_outer);
             }
         });
 }
@@ -794,10 +770,7 @@ void TreeModelVolumes::calculateCollisionHolefree(const std::deque<RadiusLayerPa
                 data[RadiusLayerPair(radius, layer_idx)] = col;
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_collision_cache_holefree_);
-                collision_cache_holefree_.insert(data.begin(), data.end());
-            }
+            collision_cache_holefree_.insert(data);
         });
 }
 
@@ -806,14 +779,11 @@ void TreeModelVolumes::calculateAccumulatedPlaceable0(const LayerIndex max_layer
     LayerIndex start_layer = -1;
 
     // the placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
+    while (accumulated_placeables_cache_radius_0_.contains(0, start_layer + 1))
     {
-        std::lock_guard<std::mutex> critical_section(*critical_accumulated_placeables_cache_radius_0_);
-        while (accumulated_placeables_cache_radius_0_.count(start_layer + 1))
-        {
-            start_layer++;
-        }
-        start_layer = std::max(LayerIndex{ start_layer + 1 }, LayerIndex{ 1 });
+        start_layer++;
     }
+    start_layer = std::max(LayerIndex{ start_layer + 1 }, LayerIndex{ 1 });
     if (start_layer > max_layer)
     {
         spdlog::debug("Requested calculation for value already calculated ?");
@@ -829,7 +799,6 @@ void TreeModelVolumes::calculateAccumulatedPlaceable0(const LayerIndex max_layer
     for (LayerIndex layer = start_layer; layer <= max_layer; layer++)
     {
         accumulated_placeable_0 = accumulated_placeable_0.unionPolygons(getPlaceableAreas(0, layer).offset(FUDGE_LENGTH)).difference(anti_overhang_[layer]);
-        std::lock_guard<std::mutex> critical_section(*critical_accumulated_placeables_cache_radius_0_);
         accumulated_placeable_0 = simplifier_.polygon(accumulated_placeable_0);
         data[layer] = std::pair(layer, accumulated_placeable_0);
     }
@@ -840,9 +809,9 @@ void TreeModelVolumes::calculateAccumulatedPlaceable0(const LayerIndex max_layer
         {
             data[layer_idx].second = data[layer_idx].second.offset(-(current_min_xy_dist_ + current_min_xy_dist_delta_));
         });
+    for (const auto& [layer_idx, placeable] : data)
     {
-        std::lock_guard<std::mutex> critical_section(*critical_accumulated_placeables_cache_radius_0_);
-        accumulated_placeables_cache_radius_0_.insert(data.begin(), data.end());
+        accumulated_placeables_cache_radius_0_.insert(0, layer_idx, placeable);
     }
 }
 
@@ -857,11 +826,7 @@ void TreeModelVolumes::calculateCollisionAvoidance(const std::deque<RadiusLayerP
             const coord_t radius = keys[key_idx].first;
             const LayerIndex max_required_layer = keys[key_idx].second;
             const coord_t max_step_move = std::max(1.9 * radius, current_min_xy_dist_ * 1.9);
-            LayerIndex start_layer = 0;
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_avoidance_cache_collision_);
-                start_layer = 1 + std::max(getMaxCalculatedLayer(radius, avoidance_cache_collision_), max_layer_idx_without_blocker_);
-            }
+            LayerIndex start_layer = 1 + std::max(avoidance_cache_collision_.getMaxCalculatedLayer(radius), max_layer_idx_without_blocker_);
 
             if (start_layer > max_required_layer)
             {
@@ -890,10 +855,7 @@ void TreeModelVolumes::calculateCollisionAvoidance(const std::deque<RadiusLayerP
                 data[layer] = std::pair<RadiusLayerPair, Shape>(key, latest_avoidance);
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_avoidance_cache_collision_);
-                avoidance_cache_collision_.insert(data.begin(), data.end());
-            }
+            avoidance_cache_collision_.insert(data);
         });
 }
 
@@ -946,11 +908,8 @@ void TreeModelVolumes::calculateAvoidance(const std::deque<RadiusLayerPair>& key
             const coord_t max_step_move = std::max(1.9 * radius, current_min_xy_dist_ * 1.9);
             RadiusLayerPair key(radius, 0);
             Shape latest_avoidance;
-            LayerIndex start_layer;
-            {
-                std::lock_guard<std::mutex> critical_section(*(slow ? critical_avoidance_cache_slow_ : holefree ? critical_avoidance_cache_holefree_ : critical_avoidance_cache_));
-                start_layer = 1 + getMaxCalculatedLayer(radius, slow ? avoidance_cache_slow_ : holefree ? avoidance_cache_hole_ : avoidance_cache_);
-            }
+            RadiusLayerCache& cache = slow ? avoidance_cache_slow_ : holefree ? avoidance_cache_hole_ : avoidance_cache_;
+            LayerIndex start_layer = 1 + cache.getMaxCalculatedLayer(radius);
             if (start_layer > max_required_layer)
             {
                 spdlog::debug("Requested calculation for value already calculated ?");
@@ -996,10 +955,7 @@ void TreeModelVolumes::calculateAvoidance(const std::deque<RadiusLayerPair>& key
                 }
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*(slow ? critical_avoidance_cache_slow_ : holefree ? critical_avoidance_cache_holefree_ : critical_avoidance_cache_));
-                (slow ? avoidance_cache_slow_ : holefree ? avoidance_cache_hole_ : avoidance_cache_).insert(data.begin(), data.end());
-            }
+            cache.insert(data);
         });
 }
 
@@ -1017,11 +973,7 @@ void TreeModelVolumes::calculatePlaceables(const std::deque<RadiusLayerPair>& ke
             std::vector<std::pair<RadiusLayerPair, Shape>> data(max_required_layer + 1, std::pair<RadiusLayerPair, Shape>(RadiusLayerPair(radius, -1), Shape()));
             RadiusLayerPair key(radius, 0);
 
-            LayerIndex start_layer;
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_placeable_areas_cache_);
-                start_layer = 1 + getMaxCalculatedLayer(radius, placeable_areas_cache_);
-            }
+            LayerIndex start_layer = 1 + placeable_areas_cache_.getMaxCalculatedLayer(radius);
             if (start_layer > max_required_layer)
             {
                 spdlog::debug("Requested calculation for value already calculated ?");
@@ -1053,10 +1005,7 @@ void TreeModelVolumes::calculatePlaceables(const std::deque<RadiusLayerPair>& ke
                 }
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_placeable_areas_cache_);
-                placeable_areas_cache_.insert(data.begin(), data.end());
-            }
+            placeable_areas_cache_.insert(data);
         });
 }
 
@@ -1091,15 +1040,8 @@ void TreeModelVolumes::calculateAvoidanceToModel(const std::deque<RadiusLayerPai
             std::vector<std::pair<RadiusLayerPair, Shape>> data(max_required_layer + 1, std::pair<RadiusLayerPair, Shape>(RadiusLayerPair(radius, -1), Shape()));
             RadiusLayerPair key(radius, 0);
 
-            LayerIndex start_layer;
-
-            {
-                std::lock_guard<std::mutex> critical_section(
-                    *(slow       ? critical_avoidance_cache_to_model_slow_
-                      : holefree ? critical_avoidance_cache_holefree_to_model_
-                                 : critical_avoidance_cache_to_model_));
-                start_layer = 1 + getMaxCalculatedLayer(radius, slow ? avoidance_cache_to_model_slow_ : holefree ? avoidance_cache_hole_to_model_ : avoidance_cache_to_model_);
-            }
+            RadiusLayerCache& cache = slow ? avoidance_cache_to_model_slow_ : holefree ? avoidance_cache_hole_to_model_ : avoidance_cache_to_model_;
+            LayerIndex start_layer = 1 + cache.getMaxCalculatedLayer(radius);
             start_layer = std::max(start_layer, LayerIndex(1));
             if (start_layer > max_required_layer)
             {
@@ -1145,13 +1087,7 @@ void TreeModelVolumes::calculateAvoidanceToModel(const std::deque<RadiusLayerPai
                 }
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(
-                    *(slow       ? critical_avoidance_cache_to_model_slow_
-                      : holefree ? critical_avoidance_cache_holefree_to_model_
-                                 : critical_avoidance_cache_to_model_));
-                (slow ? avoidance_cache_to_model_slow_ : holefree ? avoidance_cache_hole_to_model_ : avoidance_cache_to_model_).insert(data.begin(), data.end());
-            }
+            cache.insert(data);
         });
 }
 
@@ -1202,15 +1138,10 @@ void TreeModelVolumes::calculateWallRestrictions(const std::deque<RadiusLayerPai
         {
             const coord_t radius = keys[key_idx].first;
             RadiusLayerPair key(radius, 0);
-            coord_t min_layer_bottom;
+            coord_t min_layer_bottom = wall_restrictions_cache_.getMaxCalculatedLayer(radius);
             std::unordered_map<RadiusLayerPair, Shape> data;
             std::unordered_map<RadiusLayerPair, Shape> data_min;
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_wall_restrictions_cache_);
-                min_layer_bottom = getMaxCalculatedLayer(radius, wall_restrictions_cache_);
-            }
-
             if (min_layer_bottom < 1)
             {
                 min_layer_bottom = 1;
@@ -1229,15 +1160,8 @@ void TreeModelVolumes::calculateWallRestrictions(const std::deque<RadiusLayerPai
                 }
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_wall_restrictions_cache_);
-                wall_restrictions_cache_.insert(data.begin(), data.end());
-            }
-
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_wall_restrictions_cache_min_);
-                wall_restrictions_cache_min_.insert(data_min.begin(), data_min.end());
-            }
+            wall_restrictions_cache_.insert(data);
+            wall_restrictions_cache_min_.insert(data_min);
         });
 }
 
@@ -1271,20 +1195,6 @@ coord_t TreeModelVolumes::ceilRadius(coord_t radius) const
     return exponential_result;
 }
 
-template<typename KEY>
-const std::optional<std::reference_wrapper<const Shape>> TreeModelVolumes::getArea(const std::unordered_map<KEY, Shape>& cache, const KEY key) const
-{
-    const auto it = cache.find(key);
-    if (it != cache.end())
-    {
-        return std::optional<std::reference_wrapper<const Shape>>{ it->second };
-    }
-    else
-    {
-        return std::optional<std::reference_wrapper<const Shape>>();
-    }
-}
-
 Shape TreeModelVolumes::calculateMachineBorderCollision(const Shape&& machine_border)
 {
     Shape machine_volume_border = machine_border.offset(MM2INT(1000.0)); // Put a border of 1 meter around the print volume so that we don't collide.
@@ -5,15 +5,18 @@
 
 #include <chrono>
 #include <fstream>
+#include <memory>
 #include <optional>
 #include <stdio.h>
 #include <string>
 #include <thread>
 
+#include <range/v3/view/drop.hpp>
 #include <range/v3/view/drop_last.hpp>
 #include <range/v3/view/enumerate.hpp>
 #include <range/v3/view/iota.hpp>
 #include <range/v3/view/reverse.hpp>
+#include <range/v3/view/zip.hpp>
 #include <scripta/logger.h>
 #include <spdlog/spdlog.h>
 
@@ -23,10 +26,13 @@
 #include "infill.h"
 #include "infill/SierpinskiFillProvider.h"
 #include "progress/Progress.h"
+#include "progress/TimingReport.h"
 #include "settings/EnumSettings.h"
 #include "support.h" //For precomputeCrossInfillTree
 #include "utils/Simplify.h"
+#include "utils/SquareGrid.h"
 #include "utils/ThreadPool.h"
+#include "utils/TraceSpan.h"
 #include "utils/algorithm.h"
 #include "utils/math.h" //For round_up_divide and PI.
 #include "utils/polygonUtils.h" //For moveInside.
@@ -99,6 +105,7 @@ TreeSupport::TreeSupport(const SliceDataStorage& storage)
 
 void TreeSupport::generateSupportAreas(SliceDataStorage& storage)
 {
+    CURA_TRACE_SPAN("TreeSupport::generateSupportAreas");
     if (grouped_meshes.empty())
     {
         return;
@@ -122,7 +129,8 @@ void TreeSupport::generateSupportAreas(SliceDataStorage& storage)
 
         spdlog::info("Processing support tree mesh group {} of {} containing {} meshes.", counter + 1, grouped_meshes.size(), grouped_meshes[counter].second.size());
         std::vector<Shape> exclude(storage.support.supportLayers.size());
-        auto t_start = std::chrono::high_resolution_clock::now();
+        const size_t first_stage_time = stage_times_.getRegisteredTimes().size();
+        stage_times_.restart();
 
         // get all already existing support areas and exclude them
         cura::parallel_for<coord_t>(
@@ -152,52 +160,63 @@ void TreeSupport::generateSupportAreas(SliceDataStorage& storage)
             processing.second.front(),
             progress_multiplier,
             progress_offset,
-            exclude);
+            exclude,
+            volumes_.getLayerOutlines()); // The outlines of the model are the same for every group, so only the first group extracts them.
 
         // ### Precalculate avoidances, collision etc.
-        const LayerIndex max_required_layer = precalculate(storage, processing.second);
+        // Setting up the tip generators doesn't need the volumes (it mostly builds the cross infill pattern of the roofs), so it's done while the volumes are calculated.
+        LayerIndex max_required_layer = -1;
+        std::vector<std::unique_ptr<TreeSupportTipGenerator>> tip_generators(processing.second.size());
+        cura::parallel_for<size_t>(
+            0,
+            tip_generators.size() + 1,
+            [&](const size_t task_idx)
+            {
+                if (task_idx == tip_generators.size())
+                {
+                    max_required_layer = precalculate(storage, processing.second);
+                    return;
+                }
+                tip_generators[task_idx] = std::make_unique<TreeSupportTipGenerator>(*storage.meshes[processing.second[task_idx]], volumes_, element_arena_);
+            });
         if (max_required_layer < 0)
         {
             spdlog::info("Support tree mesh group {} does not have any overhang. Skipping tree support generation for this support tree mesh group.", counter + 1);
             continue; // If there is no overhang to support, skip these meshes
         }
-        const auto t_precalc = std::chrono::high_resolution_clock::now();
+        stage_times_.registerTime("precalculate", 0);
 
         // ### Place tips of the support tree
-        for (size_t mesh_idx : processing.second)
+        for (const auto [tip_gen, mesh_idx] : ranges::views::zip(tip_generators, processing.second))
         {
-            generateInitialAreas(*storage.meshes[mesh_idx], move_bounds, storage);
+            generateInitialAreas(*tip_gen, *storage.meshes[mesh_idx], move_bounds, storage);
         }
-        const auto t_gen = std::chrono::high_resolution_clock::now();
+        stage_times_.registerTime("generateInitialAreas", 0);
 
         // ### Propagate the influence areas downwards.
         createLayerPathing(move_bounds);
-        const auto t_path = std::chrono::high_resolution_clock::now();
+        stage_times_.registerTime("createLayerPathing", 0);
 
         // ### Set a point in each influence area
         createNodesFromArea(move_bounds);
-        const auto t_place = std::chrono::high_resolution_clock::now();
+        stage_times_.registerTime("createNodesFromArea", 0);
 
         // ### draw these points as circles
         drawAreas(move_bounds, storage);
 
-        const auto t_draw = std::chrono::high_resolution_clock::now();
-        const auto dur_pre_gen = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_precalc - t_start).count();
-        const auto dur_gen = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_gen - t_precalc).count();
-        const auto dur_path = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_path - t_gen).count();
-        const auto dur_place = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_place - t_path).count();
-        const auto dur_draw = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_draw - t_place).count();
-        const auto dur_total = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_draw - t_start).count();
-        spdlog::info(
-            "Total time used creating Tree support for the currently grouped meshes: {} ms. Different subtasks:\n"
-            "Calculating Avoidance: {} ms Creating inital influence areas: {} ms Influence area creation: {} ms Placement of Points in InfluenceAreas: {} ms Drawing result as "
-            "support {} ms",
-            dur_total,
-            dur_pre_gen,
-            dur_gen,
-            dur_path,
-            dur_place,
-            dur_draw);
+        double total_time = 0;
+        std::string stage_summary;
+        for (const TimeKeeper::RegisteredTime& stage_time : stage_times_.getRegisteredTimes() | ranges::views::drop(first_stage_time))
+        {
+            total_time += stage_time.duration;
+            stage_summary += fmt::format(" {}: {:.3f} s", stage_time.stage, stage_time.duration);
+        }
+        spdlog::info("Total time used creating Tree support for the currently grouped meshes: {:.3f} s. Different subtasks:{}", total_time, stage_summary);
+        if (TimingReport::getInstance().isEnabled())
+        {
+            const TimeKeeper::RegisteredTimes& registered_times = stage_times_.getRegisteredTimes();
+            TimingReport::getInstance().recordSubStages(TimeKeeper::RegisteredTimes(registered_times.begin() + first_stage_time, registered_times.end()));
+        }
 
 
         for (auto& layer : move_bounds)
@@ -205,9 +224,9 @@ void TreeSupport::generateSupportAreas(SliceDataStorage& storage)
             for (auto elem : layer)
             {
                 delete elem->area_;
-                delete elem;
             }
         }
+        element_arena_.clear();
     }
 
     storage.support.generated = true;
@@ -253,9 +272,13 @@ LayerIndex TreeSupport::precalculate(const SliceDataStorage& storage, std::vecto
 }
 
 
-void TreeSupport::generateInitialAreas(const SliceMeshStorage& mesh, std::vector<std::set<TreeSupportElement*>>& move_bounds, SliceDataStorage& storage)
+void TreeSupport::generateInitialAreas(
+    TreeSupportTipGenerator& tip_gen,
+    const SliceMeshStorage& mesh,
+    std::vector<std::set<TreeSupportElement*>>& move_bounds,
+    SliceDataStorage& storage)
 {
-    TreeSupportTipGenerator tip_gen(mesh, volumes_);
+    CURA_TRACE_SPAN("TreeSupport::generateInitialAreas");
     tip_gen.generateTips(storage, mesh, move_bounds, additional_required_support_area, fake_roof_areas);
 }
 
@@ -276,12 +299,113 @@ void TreeSupport::mergeHelper(
     {
         return config.getRadius(distance_to_top, buildplate_radius_increases);
     };
+
+    // Index the reduced areas in a grid, so that each influence area is only checked against the reduced areas it may hit, instead of against all of them.
+    // The cells are about as large as the average area, so most areas are in only a few cells. The odd area that spans many cells is kept aside and always checked.
+    using ReducedIterator = std::map<TreeSupportElement, AABB>::iterator;
+    constexpr coord_t max_cells_per_area = 64;
+    coord_t total_extent = 0;
+    size_t extent_count = 0;
+    for (const auto* aabbs : { &reduced_aabb, &input_aabb })
+    {
+        for (const auto& [element, aabb] : *aabbs)
+        {
+            if (aabb.min_.X <= aabb.max_.X && aabb.min_.Y <= aabb.max_.Y)
+            {
+                total_extent += std::max(aabb.max_.X - aabb.min_.X, aabb.max_.Y - aabb.min_.Y);
+                extent_count++;
+            }
+        }
+    }
+    const SquareGrid grid(std::max(coord_t(1), extent_count == 0 ? coord_t(1) : total_extent / coord_t(extent_count)));
+    std::unordered_map<SquareGrid::GridPoint, std::vector<ReducedIterator>> reduced_cells;
+    std::vector<ReducedIterator> large_reduced;
+    const auto forEachCell = [&grid](const AABB& aabb, const std::function<void(SquareGrid::GridPoint)>& process_cell) -> bool
+    {
+        if (aabb.min_.X > aabb.max_.X || aabb.min_.Y > aabb.max_.Y)
+        {
+            return true; // An empty box doesn't hit anything.
+        }
+        const SquareGrid::GridPoint min_cell = grid.toGridPoint(aabb.min_);
+        const SquareGrid::GridPoint max_cell = grid.toGridPoint(aabb.max_);
+        if ((max_cell.X - min_cell.X + 1) * (max_cell.Y - min_cell.Y + 1) > max_cells_per_area)
+        {
+            return false;
+        }
+        for (coord_t x = min_cell.X; x <= max_cell.X; x++)
+        {
+            for (coord_t y = min_cell.Y; y <= max_cell.Y; y++)
+            {
+                process_cell(SquareGrid::GridPoint(x, y));
+            }
+        }
+        return true;
+    };
+    const auto addReduced = [&](const ReducedIterator reduced)
+    {
+        if (! forEachCell(
+                reduced->second,
+                [&](const SquareGrid::GridPoint cell)
+                {
+                    reduced_cells[cell].push_back(reduced);
+                }))
+        {
+            large_reduced.push_back(reduced);
+        }
+    };
+    const auto removeReduced = [&](const ReducedIterator reduced)
+    {
+        if (! forEachCell(
+                reduced->second,
+                [&](const SquareGrid::GridPoint cell)
+                {
+                    std::erase(reduced_cells[cell], reduced);
+                }))
+        {
+            std::erase(large_reduced, reduced);
+        }
+    };
+    for (ReducedIterator reduced = reduced_aabb.begin(); reduced != reduced_aabb.end(); ++reduced)
+    {
+        addReduced(reduced);
+    }
+
+    std::vector<ReducedIterator> candidates;
     for (auto& influence : input_aabb)
     {
         bool merged = false;
         AABB influence_aabb = influence.second;
-        for (const auto& reduced_check : reduced_aabb)
+
+        // Gather the reduced areas that may hit this one, in the order of the map, as the first possible merge is the one that is done.
+        candidates = large_reduced;
+        if (! forEachCell(
+                influence_aabb,
+                [&](const SquareGrid::GridPoint cell)
+                {
+                    if (const auto cell_it = reduced_cells.find(cell); cell_it != reduced_cells.end())
+                    {
+                        candidates.insert(candidates.end(), cell_it->second.begin(), cell_it->second.end());
+                    }
+                }))
+        {
+            candidates.clear();
+            for (ReducedIterator reduced = reduced_aabb.begin(); reduced != reduced_aabb.end(); ++reduced)
+            {
+                candidates.push_back(reduced);
+            }
+        }
+        std::sort(
+            candidates.begin(),
+            candidates.end(),
+            [&](const ReducedIterator& a, const ReducedIterator& b)
+            {
+                return reduced_aabb.key_comp()(a->first, b->first);
+            });
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        for (const ReducedIterator reduced : candidates)
         {
+            const auto& reduced_check = *reduced;
             // As every area has to be checked for overlaps with other areas, some fast heuristic is needed to abort early if clearly possible
             // This is so performance critical that using a map lookup instead of the direct access of the cached AABBs can have a surprisingly large performance impact
             AABB aabb = reduced_check.second;
@@ -478,8 +602,12 @@ void TreeSupport::mergeHelper(
                     // negative area.).
                     //     And if this area disappears because of rounding errors, the only downside is that it can not merge again on this layer.
 
-                    reduced_aabb.erase(reduced_check.first); // This invalidates reduced_check.
-                    reduced_aabb.emplace(key, AABB(merge));
+                    removeReduced(reduced);
+                    reduced_aabb.erase(reduced); // This invalidates reduced_check.
+                    if (const auto [merged_reduced, inserted] = reduced_aabb.emplace(key, AABB(merge)); inserted)
+                    {
+                        addReduced(merged_reduced);
+                    }
 
                     merged = true;
                     break;
@@ -489,7 +617,13 @@ void TreeSupport::mergeHelper(
 
         if (! merged)
         {
-            reduced_aabb[influence.first] = influence_aabb;
+            const auto [unmerged_reduced, inserted] = reduced_aabb.try_emplace(influence.first, influence_aabb);
+            if (! inserted)
+            {
+                removeReduced(unmerged_reduced);
+                unmerged_reduced->second = influence_aabb;
+            }
+            addReduced(unmerged_reduced);
         }
     }
 }
@@ -644,7 +778,8 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
     Shape& to_model_data,
     Shape& increased,
     const coord_t overspeed,
-    const bool mergelayer)
+    const bool mergelayer,
+    AreaIncreaseCache& cache)
 {
     TreeSupportElement current_elem(parent); // Also increases DTT by one.
     Shape check_layer_data;
@@ -654,7 +789,30 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
     }
     coord_t radius = config.getCollisionRadius(current_elem);
 
-    if (settings.move_)
+    // With errors the area is moved from an area that is recreated for every try, so it can't be told apart from another one.
+    const bool use_cache = settings.no_error_;
+    const Shape* moved_from = settings.move_ ? &relevant_offset : parent->area_;
+    const coord_t moved_overspeed = settings.move_ ? overspeed : 0;
+    const coord_t moved_radius = moved_overspeed > 0 ? radius : 0;
+    std::optional<size_t> moved_idx;
+    if (use_cache)
+    {
+        for (const auto [idx, moved] : cache.moved | ranges::views::enumerate)
+        {
+            if (moved.from == moved_from && moved.overspeed == moved_overspeed && moved.radius == moved_radius)
+            {
+                moved_idx = idx;
+                increased = moved.area;
+                break;
+            }
+        }
+    }
+
+    if (moved_idx)
+    {
+        // Moved by an earlier try.
+    }
+    else if (settings.move_)
     {
         increased = relevant_offset;
         if (overspeed > 0)
@@ -682,10 +840,35 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
     {
         increased = *parent->area_;
     }
+    if (use_cache && ! moved_idx)
+    {
+        moved_idx = cache.moved.size();
+        cache.moved.push_back({ moved_from, moved_overspeed, moved_radius, increased });
+    }
+
+    const auto outsideAvoidance = [&](const coord_t avoidance_radius, const AvoidanceType type, const bool to_model)
+    {
+        if (! use_cache)
+        {
+            return TreeSupportUtils::safeUnion(increased.difference(volumes_.getAvoidance(avoidance_radius, layer_idx - 1, type, to_model, settings.use_min_distance_)));
+        }
+        const coord_t ceiled_radius = volumes_.ceilRadius(avoidance_radius, settings.use_min_distance_);
+        for (const AreaIncreaseCache::OutsideAvoidance& outside : cache.outside_avoidance)
+        {
+            if (outside.moved_idx == *moved_idx && outside.ceiled_radius == ceiled_radius && outside.type == type && outside.to_model == to_model
+                && outside.min_xy_dist == settings.use_min_distance_)
+            {
+                return outside.area;
+            }
+        }
+        Shape area = TreeSupportUtils::safeUnion(increased.difference(volumes_.getAvoidance(avoidance_radius, layer_idx - 1, type, to_model, settings.use_min_distance_)));
+        cache.outside_avoidance.push_back({ *moved_idx, ceiled_radius, type, to_model, settings.use_min_distance_, area });
+        return area;
+    };
 
     if ((mergelayer || current_elem.to_buildplate_) && config.support_rest_preference == RestPreference::BUILDPLATE)
     {
-        to_bp_data = TreeSupportUtils::safeUnion(increased.difference(volumes_.getAvoidance(radius, layer_idx - 1, settings.type_, false, settings.use_min_distance_)));
+        to_bp_data = outsideAvoidance(radius, settings.type_, false);
         if (! current_elem.to_buildplate_ && to_bp_data.area() > 1) // mostly happening in the tip, but with merges one should check every time, just to be sure.
         {
             current_elem.to_buildplate_ = true; // sometimes nodes that can reach the buildplate are marked as cant reach, tainting subtrees. This corrects it.
@@ -696,7 +879,7 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
     {
         if (mergelayer || current_elem.to_model_gracious_)
         {
-            to_model_data = TreeSupportUtils::safeUnion(increased.difference(volumes_.getAvoidance(radius, layer_idx - 1, settings.type_, true, settings.use_min_distance_)));
+            to_model_data = outsideAvoidance(radius, settings.type_, true);
         }
 
         if (! current_elem.to_model_gracious_)
@@ -708,8 +891,7 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
             }
             else
             {
-                to_model_data
-                    = TreeSupportUtils::safeUnion(increased.difference(volumes_.getAvoidance(radius, layer_idx - 1, AvoidanceType::COLLISION, true, settings.use_min_distance_)));
+                to_model_data = outsideAvoidance(radius, AvoidanceType::COLLISION, true);
             }
         }
     }
@@ -825,12 +1007,11 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
         {
             if (current_elem.to_buildplate_)
             {
-                to_bp_data = TreeSupportUtils::safeUnion(increased.difference(volumes_.getAvoidance(radius, layer_idx - 1, settings.type_, false, settings.use_min_distance_)));
+                to_bp_data = outsideAvoidance(radius, settings.type_, false);
             }
             if (config.support_rests_on_model && (! current_elem.to_buildplate_ || mergelayer))
             {
-                to_model_data = TreeSupportUtils::safeUnion(increased.difference(
-                    volumes_.getAvoidance(radius, layer_idx - 1, current_elem.to_model_gracious_ ? settings.type_ : AvoidanceType::COLLISION, true, settings.use_min_distance_)));
+                to_model_data = outsideAvoidance(radius, current_elem.to_model_gracious_ ? settings.type_ : AvoidanceType::COLLISION, true);
             }
             check_layer_data = current_elem.to_buildplate_ ? to_bp_data : to_model_data;
             if (check_layer_data.area() < 1)
@@ -1096,6 +1277,7 @@ void TreeSupport::increaseAreas(
             // calculate the fast one. Calculated by comparing the steps saved when calculating independently with the saved steps when not.
             const bool offset_independent_faster = (radius / safe_movement_distance - (((config.maximum_move_distance + extra_speed) < (radius + safe_movement_distance)) ? 1 : 0))
                                                  > (round_up_divide((extra_speed + extra_slow_speed + config.maximum_move_distance_slow), safe_movement_distance));
+            AreaIncreaseCache area_increase_cache;
             for (AreaIncreaseSettings settings : order)
             {
                 if (settings.move_)
@@ -1155,7 +1337,17 @@ void TreeSupport::increaseAreas(
                     // it still actually has an area that can be increased
                     Shape lines_offset = TreeSupportUtils::toPolylines(*parent->area_).offset(EPSILON);
                     Shape base_error_area = parent->area_->unionPolygons(lines_offset);
-                    result = increaseSingleArea(settings, layer_idx, parent, base_error_area, to_bp_data, to_model_data, inc_wo_collision, settings.increase_speed_, mergelayer);
+                    result = increaseSingleArea(
+                        settings,
+                        layer_idx,
+                        parent,
+                        base_error_area,
+                        to_bp_data,
+                        to_model_data,
+                        inc_wo_collision,
+                        settings.increase_speed_,
+                        mergelayer,
+                        area_increase_cache);
 
                     if (fast_speed < settings.increase_speed_)
                     {
@@ -1199,7 +1391,8 @@ void TreeSupport::increaseAreas(
                         to_model_data,
                         inc_wo_collision,
                         std::max(settings.increase_speed_ - fast_speed, coord_t(0)),
-                        mergelayer);
+                        mergelayer,
+                        area_increase_cache);
                 }
 
                 if (result)
@@ -1251,7 +1444,7 @@ void TreeSupport::increaseAreas(
                     if (bypass_merge)
                     {
                         Shape* new_area = new Shape(max_influence_area);
-                        TreeSupportElement* next = new TreeSupportElement(elem, new_area);
+                        TreeSupportElement* next = element_arena_.emplace(elem, new_area);
                         bypass_merge_areas.emplace_back(next);
                     }
                     else
@@ -1280,6 +1473,7 @@ void TreeSupport::increaseAreas(
 
 void TreeSupport::createLayerPathing(std::vector<std::set<TreeSupportElement*>>& move_bounds)
 {
+    CURA_TRACE_SPAN("TreeSupport::createLayerPathing");
     const double data_size_inverse = 1 / double(move_bounds.size());
     double progress_total = TREE_PROGRESS_PRECALC_AVO + TREE_PROGRESS_PRECALC_COLL + TREE_PROGRESS_GENERATE_NODES;
 
@@ -1351,7 +1545,7 @@ void TreeSupport::createLayerPathing(std::vector<std::set<TreeSupportElement*>>&
         {
             const TreeSupportElement elem = tup.first;
             Shape* new_area = new Shape(TreeSupportUtils::safeUnion(tup.second));
-            TreeSupportElement* next = new TreeSupportElement(elem, new_area);
+            TreeSupportElement* next = element_arena_.emplace(elem, new_area);
             move_bounds[layer_idx - 1].emplace(next);
 
             if (new_area->area() < 1)
@@ -1370,6 +1564,9 @@ void TreeSupport::createLayerPathing(std::vector<std::set<TreeSupportElement*>>&
             move_bounds[layer_idx - 1].emplace(elem);
         }
 
+        // The layers below only need the avoidances of this layer and lower.
+        volumes_.evictAvoidancesAbove(layer_idx);
+
         progress_total += data_size_inverse * TREE_PROGRESS_AREA_CALC;
         Progress::messageProgress(Progress::Stage::SUPPORT, progress_total * progress_multiplier + progress_offset, TREE_PROGRESS_TOTAL);
     }
@@ -1547,6 +1744,7 @@ bool TreeSupport::setToModelContact(std::vector<std::set<TreeSupportElement*>>&
 
 void TreeSupport::createNodesFromArea(std::vector<std::set<TreeSupportElement*>>& move_bounds)
 {
+    CURA_TRACE_SPAN("TreeSupport::createNodesFromArea");
     // Initialize points on layer 0, with a "random" point in the influence area. Point is chosen based on an inaccurate estimate where the branches will split into two, but every
     // point inside the influence area would produce a valid result.
     std::unordered_set<TreeSupportElement*> remove;
@@ -1718,17 +1916,18 @@ void TreeSupport::generateBranchAreas(
                         used_scale * (0 + moveX * moveY * vsize_inv),
                         used_scale * (1 + moveY * moveY * vsize_inv),
                     };
-                    Polygon circle;
+                    Polygon& circle = poly.newLine();
+                    circle.reserve(branch_circle.size());
                     for (Point2LL vertex : branch_circle)
                     {
                         vertex = Point2LL(matrix[0] * vertex.X + matrix[1] * vertex.Y, matrix[2] * vertex.X + matrix[3] * vertex.Y);
                         circle.push_back(center_position + vertex);
                     }
-                    poly.push_back(circle.offset(0));
                 }
 
-                poly = poly.unionPolygons()
-                           .offset(std::min(static_cast<coord_t>(FUDGE_LENGTH), config.support_line_width / 4))
+                // Offsetting unites the overlapping ellipses before growing them, so they don't need to be united separately.
+                const coord_t fudge_offset = std::min(static_cast<coord_t>(FUDGE_LENGTH), config.support_line_width / 4);
+                poly = (fudge_offset != 0 ? poly.offset(fudge_offset) : poly.unionPolygons())
                            .difference(volumes_.getCollision(0, linear_data[idx].first, parent_uses_min || elem->use_min_xy_dist_));
                 // ^^^ There seem to be some rounding errors, causing a branch to be a tiny bit further away from the model that it has to be. This can cause the tip to be slightly
                 // further away front the overhang (x/y wise) than optimal.
@@ -1756,12 +1955,13 @@ void TreeSupport::generateBranchAreas(
                     // if larger area did not fix the problem, all parts off the nozzle path that do not contain the center point are removed, hoping for the best
                     if (nozzle_path.splitIntoParts(false).size() > 1)
                     {
+                        // The parts don't overlap, so they are only united once, by the offset below.
                         Shape polygons_with_correct_center;
                         for (SingleShape part : nozzle_path.splitIntoParts(false))
                         {
                             if (part.inside(elem->result_on_layer_, true))
                             {
-                                polygons_with_correct_center = polygons_with_correct_center.unionPolygons(part);
+                                polygons_with_correct_center.push_back(part);
                             }
                             else
                             {
@@ -1770,14 +1970,13 @@ void TreeSupport::generateBranchAreas(
                                 PolygonUtils::moveInside(part, from, 0);
                                 if (vSize2(elem->result_on_layer_ - from) < (FUDGE_LENGTH * FUDGE_LENGTH) / 4)
                                 {
-                                    polygons_with_correct_center = polygons_with_correct_center.unionPolygons(part);
+                                    polygons_with_correct_center.push_back(part);
                                 }
                             }
                         }
                         // Increase the area again, to ensure the nozzle path when calculated later is very similar to the one assumed above.
-                        linear_inserts[idx] = polygons_with_correct_center.offset(config.support_line_width / 2).unionPolygons();
-                        linear_inserts[idx]
-                            = linear_inserts[idx].difference(volumes_.getCollision(0, linear_data[idx].first, parent_uses_min || elem->use_min_xy_dist_)).unionPolygons();
+                        linear_inserts[idx] = polygons_with_correct_center.offset(config.support_line_width / 2)
+                                                  .difference(volumes_.getCollision(0, linear_data[idx].first, parent_uses_min || elem->use_min_xy_dist_));
                     }
                 }
             }
@@ -1876,27 +2075,30 @@ void TreeSupport::smoothBranchAreas(std::vector<std::unordered_map<TreeSupportEl
             {
                 std::pair<TreeSupportElement*, Shape> data_pair = processing[processing_idx];
                 bool do_something = false;
-                Shape max_allowed_area;
-                for (size_t idx = 0; idx < data_pair.first->parents_.size(); idx++)
+                for (TreeSupportElement* parent : data_pair.first->parents_)
                 {
-                    TreeSupportElement* parent = data_pair.first->parents_[idx];
-                    const coord_t max_outer_line_increase = max_radius_change_per_layer;
-                    Shape result = layer_tree_polygons[layer_idx + 1][parent].offset(max_outer_line_increase);
-                    const Point2LL direction = data_pair.first->result_on_layer_ - parent->result_on_layer_;
-                    // Move the polygons object.
-                    for (auto& outer : result)
-                    {
-                        for (Point2LL& p : outer)
-                        {
-                            p += direction;
-                        }
-                    }
-                    max_allowed_area.push_back(result);
                     do_something = do_something || updated_last_iteration.count(parent) || config.getCollisionRadius(*parent) != config.getRadius(*parent);
                 }
 
                 if (do_something)
                 {
+                    // Only grow the areas of the parents for the elements that can change.
+                    Shape max_allowed_area;
+                    for (TreeSupportElement* parent : data_pair.first->parents_)
+                    {
+                        const coord_t max_outer_line_increase = max_radius_change_per_layer;
+                        Shape result = layer_tree_polygons[layer_idx + 1][parent].offset(max_outer_line_increase);
+                        const Point2LL direction = data_pair.first->result_on_layer_ - parent->result_on_layer_;
+                        // Move the polygons object.
+                        for (auto& outer : result)
+                        {
+                            for (Point2LL& p : outer)
+                            {
+                                p += direction;
+                            }
+                        }
+                        max_allowed_area.push_back(result);
+                    }
                     const Shape result = max_allowed_area.unionPolygons().intersection(data_pair.second);
                     if (result.area() < data_pair.second.area())
                     {
@@ -1964,8 +2166,8 @@ void TreeSupport::filterFloatingLines(std::vector<Shape>& support_layer_storage)
     };
 
 
-    std::vector<Shape> support_holes(support_layer_storage.size(), Shape());
-    // Extract all holes as polygon objects
+    std::vector<std::vector<Shape>> holeparts(support_layer_storage.size());
+    // Extract all holes as polygon objects and split them into parts
     cura::parallel_for<coord_t>(
         0,
         support_layer_storage.size(),
@@ -1991,46 +2193,47 @@ void TreeSupport::filterFloatingLines(std::vector<Shape>& support_layer_storage)
                 reversePolygon(area);
                 holes_original.push_back(area);
             }
-            support_holes[layer_idx] = holes_original;
-        });
-
-    const auto t_union = std::chrono::high_resolution_clock::now();
-
-    std::vector<std::vector<Shape>> holeparts(support_layer_storage.size());
-    // Split all holes into parts
-    cura::parallel_for<coord_t>(
-        0,
-        support_layer_storage.size(),
-        [&](const LayerIndex layer_idx)
-        {
-            for (Shape hole : support_holes[layer_idx].splitIntoParts())
+            for (Shape hole : holes_original.splitIntoParts())
             {
                 holeparts[layer_idx].emplace_back(hole);
             }
         });
-    std::vector<std::map<size_t, std::vector<size_t>>> hole_rest_map(holeparts.size());
-    std::vector<std::set<size_t>> holes_resting_outside(holeparts.size());
 
+    const auto t_union = std::chrono::high_resolution_clock::now();
 
-    // Figure out which hole rests on which other hole
-    cura::parallel_for<coord_t>(
+    //! Which holes of a layer rest on which holes of the layer below, or on something else.
+    struct HoleRests
+    {
+        size_t layer_idx;
+        std::map<size_t, std::vector<size_t>> hole_rest_map;
+        std::set<size_t> holes_resting_outside;
+    };
+
+    std::unordered_set<size_t> removed_holes_by_idx;
+    std::vector<Shape> valid_holes(support_layer_storage.size(), Shape());
+    // Figure out which hole rests on which other hole in parallel. Then check which holes have to be removed as they do not rest on anything, which needs the holes removed
+    // from the layer below, so it's done in order while the next layers are evaluated. Only keep holes that have to be removed
+    run_multiple_producers_ordered_consumer(
         1,
         support_layer_storage.size(),
-        [&](const LayerIndex layer_idx)
+        [&](const size_t layer_idx)
         {
+            auto rests = std::make_unique<HoleRests>();
+            rests->layer_idx = layer_idx;
             if (holeparts[layer_idx].empty())
             {
-                return;
+                return rests;
             }
 
             const Shape& relevant_forbidden = volumes_.getCollision(0, layer_idx, true);
             Shape outer_walls = TreeSupportUtils::toPolylines(support_layer_storage[layer_idx - 1].getOutsidePolygons()).createTubeShape(closing_dist, 0);
 
-            Shape holes_below;
-
-            for (auto poly : holeparts[layer_idx - 1])
+            // Every hole of this layer is checked against all holes of the layer below, so their bounding boxes are only computed once.
+            std::vector<AABB> hole_below_aabbs;
+            hole_below_aabbs.reserve(holeparts[layer_idx - 1].size());
+            for (const Shape& hole2 : holeparts[layer_idx - 1])
             {
-                holes_below.push_back(poly);
+                hole_below_aabbs.emplace_back(hole2);
             }
 
             for (auto [idx, hole] : holeparts[layer_idx] | ranges::views::enumerate)
@@ -2039,69 +2242,64 @@ void TreeSupport::filterFloatingLines(std::vector<Shape>& support_layer_storage)
                 hole_aabb.expand(EPSILON);
                 if (! hole.intersection(PolygonUtils::clipPolygonWithAABB(outer_walls, hole_aabb)).empty())
                 {
-                    holes_resting_outside[layer_idx].emplace(idx);
+                    rests->holes_resting_outside.emplace(idx);
                 }
                 else if (hole.intersection(PolygonUtils::clipPolygonWithAABB(relevant_forbidden, hole_aabb)).area() > hole.length() * EPSILON)
                 {
-                    holes_resting_outside[layer_idx].emplace(
-                        idx); // technically not resting outside, also not valid, but the alternative is potentially having lines go though the model
+                    rests->holes_resting_outside.emplace(idx); // technically not resting outside, also not valid, but the alternative is potentially having lines go though the model
                 }
                 else
                 {
                     for (auto [idx2, hole2] : holeparts[layer_idx - 1] | ranges::views::enumerate)
                     {
-                        if (hole_aabb.hit(AABB(hole2))
+                        if (hole_aabb.hit(hole_below_aabbs[idx2])
                             && ! hole.intersection(hole2).empty()) // TODO should technically be outline: Check if this is fine either way as it would save an offset
                         {
-                            hole_rest_map[layer_idx][idx].emplace_back(idx2);
+                            rests->hole_rest_map[idx].emplace_back(idx2);
                         }
                     }
                 }
             }
-        });
-
-    const auto t_hole_rest_ordering = std::chrono::high_resolution_clock::now();
-
-    std::unordered_set<size_t> removed_holes_by_idx;
-    std::vector<Shape> valid_holes(support_holes.size(), Shape());
-    // Check which holes have to be removed as they do not rest on anything. Only keep holes that have to be removed
-    for (const size_t layer_idx : ranges::views::iota(1UL, support_holes.size()))
-    {
-        std::unordered_set<size_t> next_removed_holes_by_idx;
-
-        for (auto [idx, hole] : holeparts[layer_idx] | ranges::views::enumerate)
+            return rests;
+        },
+        [&](std::unique_ptr<HoleRests> rests)
         {
-            bool found = false;
-            if (holes_resting_outside[layer_idx].contains(idx))
-            {
-                found = true;
-            }
-            else
+            const size_t layer_idx = rests->layer_idx;
+            std::unordered_set<size_t> next_removed_holes_by_idx;
+
+            for (auto [idx, hole] : holeparts[layer_idx] | ranges::views::enumerate)
             {
-                if (hole_rest_map[layer_idx].contains(idx))
+                bool found = false;
+                if (rests->holes_resting_outside.contains(idx))
                 {
-                    for (size_t resting_idx : hole_rest_map[layer_idx][idx])
+                    found = true;
+                }
+                else
+                {
+                    if (rests->hole_rest_map.contains(idx))
                     {
-                        if (! removed_holes_by_idx.contains(resting_idx))
+                        for (size_t resting_idx : rests->hole_rest_map[idx])
                         {
-                            found = true;
-                            break;
+                            if (! removed_holes_by_idx.contains(resting_idx))
+                            {
+                                found = true;
+                                break;
+                            }
                         }
                     }
                 }
+                if (! found)
+                {
+                    next_removed_holes_by_idx.emplace(idx);
+                }
+                else
+                {
+                    // The holes stay as they are, since the layer above may still be evaluated against them.
+                    valid_holes[layer_idx].push_back(hole);
+                }
             }
-            if (! found)
-            {
-                next_removed_holes_by_idx.emplace(idx);
-            }
-            else
-            {
-                valid_holes[layer_idx].push_back(hole);
-                holeparts[layer_idx][idx] = Shape(); // all remaining holes will have to be removed later, so removing the hole means it is confirmed valid!
-            }
-        }
-        removed_holes_by_idx = next_removed_holes_by_idx;
-    }
+            removed_holes_by_idx = next_removed_holes_by_idx;
+        });
     const auto t_hole_removal_tagging = std::chrono::high_resolution_clock::now();
 
     // Check if holes are so close to each other that two lines will be printed directly next to each other, which is assumed stable (as otherwise the simulated support pattern
@@ -2125,15 +2323,13 @@ void TreeSupport::filterFloatingLines(std::vector<Shape>& support_layer_storage)
     const auto t_end = std::chrono::high_resolution_clock::now();
 
     const auto dur_union = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_union - t_start).count();
-    const auto dur_hole_rest_ordering = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_hole_rest_ordering - t_union).count();
-    const auto dur_hole_removal_tagging = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_hole_removal_tagging - t_hole_rest_ordering).count();
+    const auto dur_hole_removal_tagging = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_hole_removal_tagging - t_union).count();
 
     const auto dur_hole_removal = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_hole_removal_tagging).count();
     spdlog::debug(
-        "Time to union areas: {} ms Time to evaluate which hole rest on which other hole: {} ms Time to see which holes are not resting on anything valid: {} ms remove all holes "
+        "Time to union areas: {} ms Time to evaluate which hole rest on which other hole and which holes are not resting on anything valid: {} ms remove all holes "
         "that are invalid and not close enough to a valid hole: {} ms",
         dur_union,
-        dur_hole_rest_ordering,
         dur_hole_removal_tagging,
         dur_hole_removal);
 }
@@ -2300,6 +2496,7 @@ void TreeSupport::finalizeInterfaceAndSupportAreas(
 
 void TreeSupport::drawAreas(std::vector<std::set<TreeSupportElement*>>& move_bounds, SliceDataStorage& storage)
 {
+    CURA_TRACE_SPAN("TreeSupport::drawAreas");
     std::vector<Shape> support_layer_storage(move_bounds.size());
     std::vector<Shape> support_layer_storage_fractional(move_bounds.size());
     std::vector<Shape> support_roof_storage_fractional(move_bounds.size());
@@ -2336,21 +2533,21 @@ void TreeSupport::drawAreas(std::vector<std::set<TreeSupportElement*>>& move_bou
 
     // Reorder the processed data by layers again. The map also could be a vector<pair<SupportElement*,Shape>>:
     std::vector<std::unordered_map<TreeSupportElement*, Shape>> layer_tree_polygons(move_bounds.size());
-    const auto t_start = std::chrono::high_resolution_clock::now();
+    stage_times_.registerTime("drawAreas preparation", 0);
 
     // Generate the circles that will be the branches.
     generateBranchAreas(linear_data, layer_tree_polygons, inverse_tree_order);
-    const auto t_generate = std::chrono::high_resolution_clock::now();
+    stage_times_.registerTime("generateBranchAreas", 0);
 
     // In some edge-cases a branch may go through a hole, where the regular radius does not fit. This can result in an apparent jump in branch radius. As such this cases need to be
     // caught and smoothed out.
     smoothBranchAreas(layer_tree_polygons);
-    const auto t_smooth = std::chrono::high_resolution_clock::now();
+    stage_times_.registerTime("smoothBranchAreas", 0);
 
     // Drop down all trees that connect non gracefully with the model.
     std::vector<std::vector<std::pair<LayerIndex, Shape>>> dropped_down_areas(linear_data.size());
     dropNonGraciousAreas(layer_tree_polygons, linear_data, dropped_down_areas, inverse_tree_order);
-    const auto t_drop = std::chrono::high_resolution_clock::now();
+    stage_times_.registerTime("dropNonGraciousAreas", 0);
 
     // single threaded combining all dropped down support areas to the right layers. ONLY COPYS DATA!
     for (const coord_t i : ranges::views::iota(0UL, dropped_down_areas.size()))
@@ -2420,34 +2617,22 @@ void TreeSupport::drawAreas(std::vector<std::set<TreeSupportElement*>>& move_bou
             }
         });
 
-    for (const auto layer_idx : ranges::views::iota(0UL, additional_required_support_area.size()))
-    {
-        if (support_layer_storage.size() > layer_idx)
+    cura::parallel_for<size_t>(
+        0,
+        std::min(additional_required_support_area.size(), support_layer_storage.size()),
+        [&](const size_t layer_idx)
         {
             support_layer_storage[layer_idx].push_back(additional_required_support_area[layer_idx]);
-        }
-        scripta::log("tree_support_layer_storage", support_layer_storage[layer_idx], SectionType::SUPPORT, layer_idx);
-    }
+            scripta::log("tree_support_layer_storage", support_layer_storage[layer_idx], SectionType::SUPPORT, layer_idx);
+        });
+
+    stage_times_.registerTime("sorting branch areas into roof and support", 0);
 
     filterFloatingLines(support_layer_storage);
-    const auto t_filter = std::chrono::high_resolution_clock::now();
+    stage_times_.registerTime("filterFloatingLines", 0);
 
     finalizeInterfaceAndSupportAreas(support_layer_storage, support_roof_storage, support_layer_storage_fractional, storage);
-    const auto t_end = std::chrono::high_resolution_clock::now();
-
-    const auto dur_gen_tips = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_generate - t_start).count();
-    const auto dur_smooth = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_smooth - t_generate).count();
-    const auto dur_drop = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_drop - t_smooth).count();
-    const auto dur_filter = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_filter - t_drop).count();
-    const auto dur_finalize = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_filter).count();
-    spdlog::info(
-        "Time used for drawing subfuctions: generateBranchAreas: {} ms smoothBranchAreas: {} ms dropNonGraciousAreas: {} ms filterFloatingLines: {} ms "
-        "finalizeInterfaceAndSupportAreas {} ms",
-        dur_gen_tips,
-        dur_smooth,
-        dur_drop,
-        dur_filter,
-        dur_finalize);
+    stage_times_.registerTime("finalizeInterfaceAndSupportAreas", 0);
 }
 
 } // namespace cura
@@ -3,9 +3,11 @@
 
 #include "TreeSupportTipGenerator.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <fstream>
+#include <iterator>
 #include <numbers>
 #include <string>
 
@@ -19,6 +21,7 @@
 #include "geometry/OpenPolyline.h"
 #include "infill/SierpinskiFillProvider.h"
 #include "settings/EnumSettings.h"
+#include "utils/ShapeCoordinates.h"
 #include "utils/ThreadPool.h"
 #include "utils/algorithm.h"
 #include "utils/math.h" //For round_up_divide and PI.
@@ -28,10 +31,11 @@
 namespace cura
 {
 
-TreeSupportTipGenerator::TreeSupportTipGenerator(const SliceMeshStorage& mesh, TreeModelVolumes& volumes_s)
+TreeSupportTipGenerator::TreeSupportTipGenerator(const SliceMeshStorage& mesh, TreeModelVolumes& volumes_s, TreeSupportElementArena& element_arena)
     : config_(mesh.settings)
     , use_fake_roof_(! mesh.settings.get<bool>("support_roof_enable"))
     , volumes_(volumes_s)
+    , element_arena_(element_arena)
     , minimum_support_area_(mesh.settings.get<double>("minimum_support_area"))
     , minimum_roof_area_(! use_fake_roof_ ? mesh.settings.get<double>("minimum_roof_area") : std::max(SUPPORT_TREE_MINIMUM_FAKE_ROOF_AREA, minimum_support_area_))
     , support_roof_layers_(
@@ -500,7 +504,7 @@ void TreeSupportTipGenerator::calculateRoofAreas(const cura::SliceMeshStorage& m
             // replaced with another setting. It should still work in most cases, but it should be possible to create a situation where a overhang outset lags though a wall. I will
             // take a look at this later.
             Shape full_overhang_area = TreeSupportUtils::safeOffsetInc(
-                mesh.full_overhang_areas[layer_idx + z_distance_delta_].unionPolygons(dropped_overhangs[layer_idx]),
+                mesh.full_overhang_areas[layer_idx + z_distance_delta_].decode().unionPolygons(dropped_overhangs[layer_idx]),
                 roof_outset_,
                 forbidden_here,
                 config_.support_line_width,
@@ -624,7 +628,7 @@ void TreeSupportTipGenerator::calculateRoofAreas(const cura::SliceMeshStorage& m
 
 
 void TreeSupportTipGenerator::addPointAsInfluenceArea(
-    std::vector<std::set<TreeSupportElement*>>& move_bounds,
+    GeneratedTips& generated,
     std::pair<Point2LL, TreeSupportTipGenerator::LineStatus> p,
     size_t dtt,
     LayerIndex insert_layer,
@@ -647,42 +651,64 @@ void TreeSupportTipGenerator::addPointAsInfluenceArea(
     {
         circle.push_back(p.first + corner);
     }
-    Shape area = circle.offset(0);
+    generated.tips_.push_back(TipCandidate{ .location_ = p.first,
+                                            .to_bp_ = to_bp,
+                                            .gracious_ = gracious,
+                                            .safe_radius_ = safe_radius,
+                                            .dtt_ = dtt,
+                                            .insert_layer_ = insert_layer,
+                                            .dont_move_until_ = dont_move_until,
+                                            .roof_ = roof,
+                                            .skip_ovalisation_ = skip_ovalisation,
+                                            .additional_ovalization_targets_ = std::move(additional_ovalization_targets),
+                                            .area_ = circle.offset(0) });
+}
+
+void TreeSupportTipGenerator::insertTips(GeneratedTips& generated, std::vector<std::set<TreeSupportElement*>>& move_bounds)
+{
+    for (TipCandidate& tip : generated.tips_)
     {
-        std::lock_guard<std::mutex> critical_section_movebounds(critical_move_bounds_);
-        if (! already_inserted_[insert_layer].count(p.first / ((config_.min_radius + 1) / 10)))
+        // Normalize the point a bit to also catch points which are so close that inserting it would achieve nothing.
+        if (! already_inserted_[tip.insert_layer_].emplace(tip.location_ / ((config_.min_radius + 1) / 10)).second)
         {
-            // Normalize the point a bit to also catch points which are so close that inserting it would achieve nothing.
-            already_inserted_[insert_layer].emplace(p.first / ((config_.min_radius + 1) / 10));
-            TreeSupportElement* elem = new TreeSupportElement(
-                dtt,
-                insert_layer,
-                p.first,
-                to_bp,
-                gracious,
-                ! xy_overrides_,
-                dont_move_until,
-                roof,
-                safe_radius,
-                ! roof && force_tip_to_roof_,
-                skip_ovalisation,
-                support_tree_limit_branch_reach_,
-                support_tree_branch_reach_limit_);
-            elem->area_ = new Shape(area);
-
-            for (Point2LL target : additional_ovalization_targets)
-            {
-                elem->additional_ovalization_targets_.emplace_back(target);
-            }
-
-            move_bounds[insert_layer].emplace(elem);
+            continue;
         }
+        TreeSupportElement* elem = element_arena_.emplace(
+            tip.dtt_,
+            tip.insert_layer_,
+            tip.location_,
+            tip.to_bp_,
+            tip.gracious_,
+            ! xy_overrides_,
+            tip.dont_move_until_,
+            tip.roof_,
+            tip.safe_radius_,
+            ! tip.roof_ && force_tip_to_roof_,
+            tip.skip_ovalisation_,
+            support_tree_limit_branch_reach_,
+            support_tree_branch_reach_limit_);
+        elem->area_ = new Shape(std::move(tip.area_));
+
+        for (Point2LL target : tip.additional_ovalization_targets_)
+        {
+            elem->additional_ovalization_targets_.emplace_back(target);
+        }
+
+        move_bounds[tip.insert_layer_].emplace(elem);
+    }
+    for (auto& [layer_idx, roof_tips] : generated.roof_tips_)
+    {
+        roof_tips_drawn_[layer_idx].push_back(std::move(roof_tips));
+    }
+    for (auto& [layer_idx, fractional_roof] : generated.fractional_roofs_)
+    {
+        support_roof_drawn_fractional_[layer_idx].push_back(std::move(fractional_roof));
     }
 }
 
 
 void TreeSupportTipGenerator::addLinesAsInfluenceAreas(
-    std::vector<std::set<TreeSupportElement*>>& move_bounds,
+    GeneratedTips& generated,
     std::vector<TreeSupportTipGenerator::LineInformation> lines,
     size_t roof_tip_layers,
     LayerIndex insert_layer_idx,
@@ -716,7 +742,7 @@ void TreeSupportTipGenerator::addLinesAsInfluenceAreas(
             {
                 for (std::pair<Point2LL, TreeSupportTipGenerator::LineStatus> point_data : line)
                 {
-                    addPointAsInfluenceArea(move_bounds, point_data, 0, insert_layer_idx - dtt_roof_tip, roof_tip_layers - dtt_roof_tip, dtt_roof_tip != 0, false);
+                    addPointAsInfluenceArea(generated, point_data, 0, insert_layer_idx - dtt_roof_tip, roof_tip_layers - dtt_roof_tip, dtt_roof_tip != 0, false);
                 }
             }
 
@@ -728,7 +754,7 @@ void TreeSupportTipGenerator::addLinesAsInfluenceAreas(
             {
                 for (std::pair<Point2LL, TreeSupportTipGenerator::LineStatus> point_data : line)
                 {
-                    addPointAsInfluenceArea(move_bounds, point_data, 0, insert_layer_idx - dtt_roof_tip, roof_tip_layers - dtt_roof_tip, dtt_roof_tip != 0, false);
+                    addPointAsInfluenceArea(generated, point_data, 0, insert_layer_idx - dtt_roof_tip, roof_tip_layers - dtt_roof_tip, dtt_roof_tip != 0, false);
                 }
             }
 
@@ -747,15 +773,11 @@ void TreeSupportTipGenerator::addLinesAsInfluenceAreas(
                 }
             }
             added_roofs = added_roofs.unionPolygons();
+            if (dtt_roof_tip == 0)
             {
-                std::lock_guard<std::mutex> critical_section_roof(critical_roof_tips_);
-                roof_tips_drawn_[insert_layer_idx - dtt_roof_tip].push_back(added_roofs);
-
-                if (dtt_roof_tip == 0)
-                {
-                    support_roof_drawn_fractional_[insert_layer_idx].push_back(added_roofs);
-                }
+                generated.fractional_roofs_.emplace_back(insert_layer_idx, added_roofs);
             }
+            generated.roof_tips_.emplace_back(insert_layer_idx - dtt_roof_tip, std::move(added_roofs));
         }
     }
 
@@ -780,7 +802,7 @@ void TreeSupportTipGenerator::addLinesAsInfluenceAreas(
                 }
             }
             addPointAsInfluenceArea(
-                move_bounds,
+                generated,
                 point_data,
                 0,
                 insert_layer_idx - dtt_roof_tip,
@@ -836,13 +858,189 @@ void TreeSupportTipGenerator::removeUselessAddedPoints(
                 {
                     move_bounds[layer_idx].erase(elem);
                     delete elem->area_;
-                    delete elem;
                 }
             }
         });
 }
 
 
+OpenLinesSet TreeSupportTipGenerator::generateTipLines(const Shape& area, bool roof, LayerIndex generate_layer_idx) const
+{
+    coord_t upper_line_distance = support_supporting_branch_distance_;
+    coord_t line_distance = std::max(roof ? support_roof_line_distance_ : support_tree_branch_distance_, upper_line_distance);
+
+    return TreeSupportUtils::generateSupportInfillLines(
+        area,
+        config_,
+        roof && ! use_fake_roof_,
+        generate_layer_idx,
+        line_distance,
+        cross_fill_provider_,
+        roof && ! use_fake_roof_,
+        line_distance == upper_line_distance);
+}
+
+
+TreeSupportTipGenerator::GeneratedTips TreeSupportTipGenerator::generateRegionTips(const OverhangRegion& region, const Shape& relevant_forbidden)
+{
+    GeneratedTips generated;
+    const LayerIndex layer_idx = region.layer_idx_;
+
+    // If the xy distance overrides the z distance, some support needs to be inserted further down.
+    //=> Analyze which support points do not fit on this layer and check if they will fit a few layers down
+    //   (while adding them an infinite amount of layers down would technically be closer the setting description, it would not produce reasonable results. )
+    if (region.insert_below_)
+    {
+        std::vector<LineInformation> overhang_lines;
+        OpenLinesSet polylines = ensureMaximumDistancePolyline(generateTipLines(region.area_, false, layer_idx), config_.min_radius, 1, false);
+        // ^^^ Support_line_width to form a line here as otherwise most will be unsupported.
+        // Technically this violates branch distance, but not only is this the only reasonable choice,
+        //   but it ensures consistent behavior as some infill patterns generate each line segment as its own polyline part causing a similar line forming behavior.
+        // Also it is assumed that the area that is valid a layer below is to small for support roof.
+        if (polylines.pointCount() <= 3)
+        {
+            // Add the outer wall to ensure it is correct supported instead.
+            polylines = ensureMaximumDistancePolyline(TreeSupportUtils::toPolylines(region.area_), connect_length_, 3, true);
+        }
+
+        for (auto line : polylines)
+        {
+            LineInformation res_line;
+            for (Point2LL p : line)
+            {
+                res_line.emplace_back(p, LineStatus::INVALID);
+            }
+            overhang_lines.emplace_back(res_line);
+        }
+
+        for (size_t lag_ctr = 1; lag_ctr <= max_overhang_insert_lag_ && ! overhang_lines.empty() && layer_idx - coord_t(lag_ctr) >= 1; lag_ctr++)
+        {
+            // get least restricted avoidance for layer_idx-lag_ctr
+            Shape relevant_forbidden_below = volumes_.getAvoidance(
+                config_.getRadius(0),
+                layer_idx - lag_ctr,
+                (only_gracious_ || ! config_.support_rests_on_model) ? AvoidanceType::FAST : AvoidanceType::COLLISION,
+                config_.support_rests_on_model,
+                ! xy_overrides_);
+            // It is not required to offset the forbidden area here as the points won't change:
+            // If points here are not inside the forbidden area neither will they be later when placing these points, as these are the same points.
+            // All points of the overhang lines are tested against the same areas, so prepare those for it once.
+            constexpr bool index_edges = true;
+            const ShapeCoordinates forbidden_below_coordinates(relevant_forbidden_below, index_edges);
+            std::function<bool(std::pair<Point2LL, LineStatus>)> evaluatePoint = [&](std::pair<Point2LL, LineStatus> p)
+            {
+                return forbidden_below_coordinates.inside(p.first, true);
+            };
+
+            if (support_roof_layers_)
+            {
+                // Remove all points that are for some reason part of a roof area, as the point is already supported by roof
+                const ShapeCoordinates roof_coordinates(support_roof_drawn_[layer_idx - lag_ctr], index_edges);
+                std::function<bool(std::pair<Point2LL, LineStatus>)> evaluatePartOfRoof = [&](std::pair<Point2LL, LineStatus> p)
+                {
+                    return roof_coordinates.inside(p.first, true);
+                };
+
+                overhang_lines = splitLines(overhang_lines, evaluatePartOfRoof).second;
+            }
+            std::pair<std::vector<TreeSupportTipGenerator::LineInformation>, std::vector<TreeSupportTipGenerator::LineInformation>> split
+                = splitLines(overhang_lines, evaluatePoint); // Keep all lines that are invalid.
+            overhang_lines = split.first;
+            std::vector<LineInformation> fresh_valid_points = convertLinesToInternal(convertInternalToLines(split.second), layer_idx - lag_ctr);
+            // ^^^ Set all now valid lines to their correct LineStatus. Easiest way is to just discard Avoidance information for each point and evaluate them again.
+
+            addLinesAsInfluenceAreas(
+                generated,
+                fresh_valid_points,
+                (force_tip_to_roof_ && lag_ctr <= support_roof_layers_) ? support_roof_layers_ : 0,
+                layer_idx - lag_ctr,
+                false,
+                support_roof_layers_,
+                false);
+        }
+        return generated;
+    }
+
+    const bool roof_allowed_for_this_part = region.supports_roof_;
+    const Shape& overhang_outset = region.area_;
+    const size_t min_support_points = std::max(coord_t(1), std::min(coord_t(EPSILON), overhang_outset.length() / connect_length_));
+    std::vector<LineInformation> overhang_lines;
+
+    bool only_lines = true;
+
+    // The tip positions are determined here.
+    // todo can cause inconsistent support density if a line exactly aligns with the model
+    OpenLinesSet polylines = ensureMaximumDistancePolyline(
+        generateTipLines(overhang_outset, roof_allowed_for_this_part, layer_idx + roof_allowed_for_this_part),
+        ! roof_allowed_for_this_part ? config_.min_radius * 2
+        : use_fake_roof_             ? support_supporting_branch_distance_
+                                     : connect_length_,
+        1,
+        false);
+
+
+    // support_line_width to form a line here as otherwise most will be unsupported.
+    // Technically this violates branch distance, but not only is this the only reasonable choice,
+    //   but it ensures consistent behaviour as some infill patterns generate each line segment as its own polyline part causing a similar line forming behaviour.
+    // This is not done when a roof is above as the roof will support the model and the trees only need to support the roof
+
+    if (polylines.pointCount() <= min_support_points)
+    {
+        only_lines = false;
+        // Add the outer wall (of the overhang) to ensure it is correct supported instead.
+        // Try placing the support points in a way that they fully support the outer wall, instead of just the with half of the support line width.
+        Shape reduced_overhang_outset = overhang_outset.offset(-config_.support_line_width / 2.2);
+        // ^^^ It's assumed that even small overhangs are over one line width wide, so lets try to place the support points in a way that the full support area
+        // generated from them will support the overhang.
+        //     (If this is not done it may only be half). This WILL NOT be the case when supporting an angle of about < 60� so there is a fallback, as some support is
+        //     better than none.)
+        if (! reduced_overhang_outset.empty()
+            && overhang_outset.difference(reduced_overhang_outset.offset(std::max(config_.support_line_width, connect_length_))).area() < 1)
+        {
+            polylines = ensureMaximumDistancePolyline(TreeSupportUtils::toPolylines(reduced_overhang_outset), connect_length_, min_support_points, true);
+        }
+        else
+        {
+            polylines = ensureMaximumDistancePolyline(TreeSupportUtils::toPolylines(overhang_outset), connect_length_, min_support_points, true);
+        }
+    }
+
+    if (roof_allowed_for_this_part) // Some roof may only be supported by a part of a tip
+    {
+        polylines = TreeSupportUtils::movePointsOutside(polylines, relevant_forbidden, config_.getRadius(0) + FUDGE_LENGTH / 2);
+    }
+
+    overhang_lines = convertLinesToInternal(polylines, layer_idx);
+
+    if (overhang_lines.empty()) // some error handling and logging
+    {
+        Shape enlarged_overhang_outset = overhang_outset.offset(config_.getRadius(0) + FUDGE_LENGTH / 2, ClipperLib::jtRound).difference(relevant_forbidden);
+        polylines = ensureMaximumDistancePolyline(TreeSupportUtils::toPolylines(enlarged_overhang_outset), connect_length_, min_support_points, true);
+        overhang_lines = convertLinesToInternal(polylines, layer_idx);
+
+        if (! overhang_lines.empty())
+        {
+            spdlog::debug("Compensated for overhang area that had no valid tips. Now has a tip.");
+        }
+        else
+        {
+            spdlog::warn("Overhang area has no valid tips! Was roof: {} On Layer: {}", roof_allowed_for_this_part, layer_idx);
+        }
+    }
+
+    size_t dont_move_for_layers = support_roof_layers_ ? (force_tip_to_roof_ ? support_roof_layers_ : (roof_allowed_for_this_part ? 0 : support_roof_layers_)) : 0;
+    addLinesAsInfluenceAreas(
+        generated,
+        overhang_lines,
+        force_tip_to_roof_ ? support_roof_layers_ : 0,
+        layer_idx,
+        roof_allowed_for_this_part,
+        dont_move_for_layers,
+        only_lines);
+    return generated;
+}
+
+
 void TreeSupportTipGenerator::generateTips(
     SliceDataStorage& storage,
     const SliceMeshStorage& mesh,
@@ -868,6 +1066,10 @@ void TreeSupportTipGenerator::generateTips(
         calculateRoofAreas(mesh);
     }
 
+    // The overhang of each layer is split into regions first. The tips of all regions are then generated at once, so that a layer with a lot of overhang doesn't hold up the
+    // others.
+    std::vector<Shape> relevant_forbidden_per_layer(mesh.overhang_areas.size());
+    std::vector<std::vector<OverhangRegion>> regions_per_layer(mesh.overhang_areas.size());
     cura::parallel_for<coord_t>(
         1,
         mesh.overhang_areas.size() - z_distance_delta_,
@@ -889,24 +1091,8 @@ void TreeSupportTipGenerator::generateTips(
                 = relevant_forbidden.offset(EPSILON)
                       .unionPolygons(); // Prevent rounding errors down the line, points placed directly on the line of the forbidden area may not be added otherwise.
 
-            std::function<OpenLinesSet(const Shape&, bool, LayerIndex)> generateLines = [&](const Shape& area, bool roof, LayerIndex generate_layer_idx)
-            {
-                coord_t upper_line_distance = support_supporting_branch_distance_;
-                coord_t line_distance = std::max(roof ? support_roof_line_distance_ : support_tree_branch_distance_, upper_line_distance);
-
-                return TreeSupportUtils::generateSupportInfillLines(
-                    area,
-                    config_,
-                    roof && ! use_fake_roof_,
-                    generate_layer_idx,
-                    line_distance,
-                    cross_fill_provider_,
-                    roof && ! use_fake_roof_,
-                    line_distance == upper_line_distance);
-            };
-
-
-            std::vector<std::pair<Shape, bool>> overhang_processing;
+            std::vector<OverhangRegion>& regions = regions_per_layer[layer_idx];
+            std::vector<OverhangRegion> roof_regions;
             // ^^^ Every overhang has saved if a roof should be generated for it.
             //     This can NOT be done in the for loop as an area may NOT have a roof even if it is larger than the minimum_roof_area when it is only larger because of the support
             //     horizontal expansion and it would not have a roof if the overhang is offset by support roof horizontal expansion instead. (At least this is the current behavior
@@ -924,7 +1110,7 @@ void TreeSupportTipGenerator::generateTips(
                 {
                     //^^^Technically one should also subtract the avoidance of radius 0 (similarly how calculated in calculateRoofArea), as there can be some rounding errors
                     // introduced since then. But this does not fully prevent some rounding errors either way, so just handle the error later.
-                    overhang_processing.emplace_back(roof_part, true);
+                    roof_regions.push_back(OverhangRegion{ .layer_idx_ = layer_idx, .area_ = std::move(roof_part), .supports_roof_ = true, .insert_below_ = false });
                 }
             }
 
@@ -974,9 +1160,7 @@ void TreeSupportTipGenerator::generateTips(
                 overhang_regular = overhang_regular.unionPolygons(next_overhang.difference(relevant_forbidden));
             }
 
-            // If the xy distance overrides the z distance, some support needs to be inserted further down.
-            //=> Analyze which support points do not fit on this layer and check if they will fit a few layers down
-            //   (while adding them an infinite amount of layers down would technically be closer the setting description, it would not produce reasonable results. )
+            // The parts of the overhang that don't fit on this layer come first, then the roofs and then the regular overhang, like they were always added.
             if (xy_overrides_)
             {
                 for (Shape& remaining_overhang_part : remaining_overhang.splitIntoParts(false))
@@ -985,161 +1169,45 @@ void TreeSupportTipGenerator::generateTips(
                     {
                         continue;
                     }
-
-                    std::vector<LineInformation> overhang_lines;
-                    OpenLinesSet polylines = ensureMaximumDistancePolyline(generateLines(remaining_overhang_part, false, layer_idx), config_.min_radius, 1, false);
-                    // ^^^ Support_line_width to form a line here as otherwise most will be unsupported.
-                    // Technically this violates branch distance, but not only is this the only reasonable choice,
-                    //   but it ensures consistent behavior as some infill patterns generate each line segment as its own polyline part causing a similar line forming behavior.
-                    // Also it is assumed that the area that is valid a layer below is to small for support roof.
-                    if (polylines.pointCount() <= 3)
-                    {
-                        // Add the outer wall to ensure it is correct supported instead.
-                        polylines = ensureMaximumDistancePolyline(TreeSupportUtils::toPolylines(remaining_overhang_part), connect_length_, 3, true);
-                    }
-
-                    for (auto line : polylines)
-                    {
-                        LineInformation res_line;
-                        for (Point2LL p : line)
-                        {
-                            res_line.emplace_back(p, LineStatus::INVALID);
-                        }
-                        overhang_lines.emplace_back(res_line);
-                    }
-
-                    for (size_t lag_ctr = 1; lag_ctr <= max_overhang_insert_lag_ && ! overhang_lines.empty() && layer_idx - coord_t(lag_ctr) >= 1; lag_ctr++)
-                    {
-                        // get least restricted avoidance for layer_idx-lag_ctr
-                        Shape relevant_forbidden_below = volumes_.getAvoidance(
-                            config_.getRadius(0),
-                            layer_idx - lag_ctr,
-                            (only_gracious_ || ! config_.support_rests_on_model) ? AvoidanceType::FAST : AvoidanceType::COLLISION,
-                            config_.support_rests_on_model,
-                            ! xy_overrides_);
-                        // It is not required to offset the forbidden area here as the points won't change:
-                        // If points here are not inside the forbidden area neither will they be later when placing these points, as these are the same points.
-                        std::function<bool(std::pair<Point2LL, LineStatus>)> evaluatePoint = [&](std::pair<Point2LL, LineStatus> p)
-                        {
-                            return relevant_forbidden_below.inside(p.first, true);
-                        };
-
-                        if (support_roof_layers_)
-                        {
-                            // Remove all points that are for some reason part of a roof area, as the point is already supported by roof
-                            std::function<bool(std::pair<Point2LL, LineStatus>)> evaluatePartOfRoof = [&](std::pair<Point2LL, LineStatus> p)
-                            {
-                                return support_roof_drawn_[layer_idx - lag_ctr].inside(p.first, true);
-                            };
-
-                            overhang_lines = splitLines(overhang_lines, evaluatePartOfRoof).second;
-                        }
-                        std::pair<std::vector<TreeSupportTipGenerator::LineInformation>, std::vector<TreeSupportTipGenerator::LineInformation>> split
-                            = splitLines(overhang_lines, evaluatePoint); // Keep all lines that are invalid.
-                        overhang_lines = split.first;
-                        std::vector<LineInformation> fresh_valid_points = convertLinesToInternal(convertInternalToLines(split.second), layer_idx - lag_ctr);
-                        // ^^^ Set all now valid lines to their correct LineStatus. Easiest way is to just discard Avoidance information for each point and evaluate them again.
-
-                        addLinesAsInfluenceAreas(
-                            new_tips,
-                            fresh_valid_points,
-                            (force_tip_to_roof_ && lag_ctr <= support_roof_layers_) ? support_roof_layers_ : 0,
-                            layer_idx - lag_ctr,
-                            false,
-                            support_roof_layers_,
-                            false);
-                    }
+                    regions.push_back(OverhangRegion{ .layer_idx_ = layer_idx, .area_ = std::move(remaining_overhang_part), .supports_roof_ = false, .insert_below_ = true });
                 }
             }
+            std::move(roof_regions.begin(), roof_regions.end(), std::back_inserter(regions));
 
             overhang_regular.removeSmallAreas(minimum_support_area_);
 
             for (Shape support_part : overhang_regular.splitIntoParts(true))
             {
-                overhang_processing.emplace_back(support_part, false);
+                regions.push_back(OverhangRegion{ .layer_idx_ = layer_idx, .area_ = std::move(support_part), .supports_roof_ = false, .insert_below_ = false });
             }
+            relevant_forbidden_per_layer[layer_idx] = std::move(relevant_forbidden);
+        });
 
-            for (std::pair<Shape, bool> overhang_pair : overhang_processing)
-            {
-                const bool roof_allowed_for_this_part = overhang_pair.second;
-                Shape overhang_outset = overhang_pair.first;
-                const size_t min_support_points = std::max(coord_t(1), std::min(coord_t(EPSILON), overhang_outset.length() / connect_length_));
-                std::vector<LineInformation> overhang_lines;
-
-                bool only_lines = true;
-
-                // The tip positions are determined here.
-                // todo can cause inconsistent support density if a line exactly aligns with the model
-                OpenLinesSet polylines = ensureMaximumDistancePolyline(
-                    generateLines(overhang_outset, roof_allowed_for_this_part, layer_idx + roof_allowed_for_this_part),
-                    ! roof_allowed_for_this_part ? config_.min_radius * 2
-                    : use_fake_roof_             ? support_supporting_branch_distance_
-                                                 : connect_length_,
-                    1,
-                    false);
-
-
-                // support_line_width to form a line here as otherwise most will be unsupported.
-                // Technically this violates branch distance, but not only is this the only reasonable choice,
-                //   but it ensures consistent behaviour as some infill patterns generate each line segment as its own polyline part causing a similar line forming behaviour.
-                // This is not done when a roof is above as the roof will support the model and the trees only need to support the roof
-
-                if (polylines.pointCount() <= min_support_points)
-                {
-                    only_lines = false;
-                    // Add the outer wall (of the overhang) to ensure it is correct supported instead.
-                    // Try placing the support points in a way that they fully support the outer wall, instead of just the with half of the support line width.
-                    Shape reduced_overhang_outset = overhang_outset.offset(-config_.support_line_width / 2.2);
-                    // ^^^ It's assumed that even small overhangs are over one line width wide, so lets try to place the support points in a way that the full support area
-                    // generated from them will support the overhang.
-                    //     (If this is not done it may only be half). This WILL NOT be the case when supporting an angle of about < 60� so there is a fallback, as some support is
-                    //     better than none.)
-                    if (! reduced_overhang_outset.empty()
-                        && overhang_outset.difference(reduced_overhang_outset.offset(std::max(config_.support_line_width, connect_length_))).area() < 1)
-                    {
-                        polylines = ensureMaximumDistancePolyline(TreeSupportUtils::toPolylines(reduced_overhang_outset), connect_length_, min_support_points, true);
-                    }
-                    else
-                    {
-                        polylines = ensureMaximumDistancePolyline(TreeSupportUtils::toPolylines(overhang_outset), connect_length_, min_support_points, true);
-                    }
-                }
-
-                if (roof_allowed_for_this_part) // Some roof may only be supported by a part of a tip
-                {
-                    polylines = TreeSupportUtils::movePointsOutside(polylines, relevant_forbidden, config_.getRadius(0) + FUDGE_LENGTH / 2);
-                }
-
-                overhang_lines = convertLinesToInternal(polylines, layer_idx);
-
-                if (overhang_lines.empty()) // some error handling and logging
-                {
-                    Shape enlarged_overhang_outset = overhang_outset.offset(config_.getRadius(0) + FUDGE_LENGTH / 2, ClipperLib::jtRound).difference(relevant_forbidden);
-                    polylines = ensureMaximumDistancePolyline(TreeSupportUtils::toPolylines(enlarged_overhang_outset), connect_length_, min_support_points, true);
-                    overhang_lines = convertLinesToInternal(polylines, layer_idx);
-
-                    if (! overhang_lines.empty())
-                    {
-                        spdlog::debug("Compensated for overhang area that had no valid tips. Now has a tip.");
-                    }
-                    else
-                    {
-                        spdlog::warn("Overhang area has no valid tips! Was roof: {} On Layer: {}", roof_allowed_for_this_part, layer_idx);
-                    }
-                }
+    std::vector<OverhangRegion> regions;
+    for (std::vector<OverhangRegion>& regions_on_layer : regions_per_layer)
+    {
+        std::move(regions_on_layer.begin(), regions_on_layer.end(), std::back_inserter(regions));
+    }
+    regions_per_layer.clear();
 
-                size_t dont_move_for_layers = support_roof_layers_ ? (force_tip_to_roof_ ? support_roof_layers_ : (roof_allowed_for_this_part ? 0 : support_roof_layers_)) : 0;
-                addLinesAsInfluenceAreas(
-                    new_tips,
-                    overhang_lines,
-                    force_tip_to_roof_ ? support_roof_layers_ : 0,
-                    layer_idx,
-                    roof_allowed_for_this_part,
-                    dont_move_for_layers,
-                    only_lines);
-            }
+    std::vector<GeneratedTips> generated_tips(regions.size());
+    cura::parallel_for<size_t>(
+        0,
+        regions.size(),
+        [&](const size_t region_idx)
+        {
+            const OverhangRegion& region = regions[region_idx];
+            generated_tips[region_idx] = generateRegionTips(region, relevant_forbidden_per_layer[region.layer_idx_]);
         });
 
+    // Adding the tips in the order of the regions makes the result independent of the order in which the regions were done.
+    for (GeneratedTips& generated : generated_tips)
+    {
+        insertTips(generated, new_tips);
+    }
+    generated_tips.clear();
+    relevant_forbidden_per_layer.clear();
+
     cura::parallel_for<coord_t>(
         0,
         support_roof_drawn_.size(),
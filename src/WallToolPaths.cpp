@@ -4,24 +4,148 @@
 #include "WallToolPaths.h"
 
 #include <algorithm> //For std::partition_copy and std::min_element.
+#include <cmath>
+#include <iterator>
+#include <optional>
 #include <unordered_set>
 
-#include <range/v3/range/conversion.hpp>
-#include <range/v3/view/filter.hpp>
-#include <range/v3/view/transform.hpp>
 #include <scripta/logger.h>
 
 #include "ExtruderTrain.h"
 #include "SkeletalTrapezoidation.h"
+#include "geometry/SingleShape.h"
 #include "utils/ExtrusionLineStitcher.h"
 #include "utils/Simplify.h"
 #include "utils/SparsePointGrid.h" //To stitch the inner contour.
+#include "utils/ThreadPool.h"
 #include "utils/actions/smooth.h"
 #include "utils/polygonUtils.h"
 
 namespace cura
 {
 
+namespace
+{
+
+//! Outlines with more walls than this always get the skeletal trapezoidation, which also keeps the wall thickness below from overflowing.
+constexpr size_t max_trivial_inset_count = 100;
+
+/*!
+ * The corners of a convex, counter-clockwise polygon, offset inward by a distance, with their edges kept parallel to the original edges.
+ * \return The offset corners, or nothing if the polygon isn't convex, has corners sharper than 90 degrees, or loses an edge at that distance.
+ */
+std::optional<std::vector<Point2LL>> offsetTrivialPolygon(const Polygon& polygon, const coord_t distance)
+{
+    const size_t point_count = polygon.size();
+    std::vector<std::pair<double, double>> directions; // The unit vector along each edge.
+    directions.reserve(point_count);
+    for (size_t point_idx = 0; point_idx < point_count; point_idx++)
+    {
+        const Point2LL edge = polygon[(point_idx + 1) % point_count] - polygon[point_idx];
+        const double length = std::hypot(static_cast<double>(edge.X), static_cast<double>(edge.Y));
+        if (length == 0.0)
+        {
+            return std::nullopt;
+        }
+        directions.emplace_back(static_cast<double>(edge.X) / length, static_cast<double>(edge.Y) / length);
+    }
+
+    std::vector<std::pair<double, double>> offset_points;
+    offset_points.reserve(point_count);
+    for (size_t point_idx = 0; point_idx < point_count; point_idx++)
+    {
+        const auto [previous_x, previous_y] = directions[(point_idx + point_count - 1) % point_count];
+        const auto [next_x, next_y] = directions[point_idx];
+        // Every corner needs to turn left (convex), by at most 90 degrees (no sharp corners, where the skeleton would start to make transitions).
+        if (previous_x * next_y - previous_y * next_x <= 0.0 || previous_x * next_x + previous_y * next_y < 0.0)
+        {
+            return std::nullopt;
+        }
+        // The corner moves along its bisector, so far that both of its edges move inward (to their left) by the distance.
+        const double scale = static_cast<double>(distance) / (1.0 + previous_x * next_x + previous_y * next_y);
+        offset_points.emplace_back(
+            static_cast<double>(polygon[point_idx].X) - (previous_y + next_y) * scale,
+            static_cast<double>(polygon[point_idx].Y) + (previous_x + next_x) * scale);
+    }
+
+    std::vector<Point2LL> result;
+    result.reserve(point_count);
+    for (size_t point_idx = 0; point_idx < point_count; point_idx++)
+    {
+        const auto [start_x, start_y] = offset_points[point_idx];
+        const auto [end_x, end_y] = offset_points[(point_idx + 1) % point_count];
+        const auto [direction_x, direction_y] = directions[point_idx];
+        if ((end_x - start_x) * direction_x + (end_y - start_y) * direction_y <= 0.0) // This edge has shrunk away, so the corners of its neighbours meet.
+        {
+            return std::nullopt;
+        }
+        result.emplace_back(std::llround(start_x), std::llround(start_y));
+    }
+    return result;
+}
+
+/*!
+ * Generate the walls of an outline that is so simple that its skeleton doesn't need to be computed: a single convex polygon without sharp corners,
+ * which is everywhere so wide that only the maximum number of walls fits, with their widths unchanged. Those walls are the offsets of the outline,
+ * like the skeletal trapezoidation would make them, apart from the extra junctions the latter adds along the edges.
+ *
+ * The walls are made like the skeletal trapezoidation makes them: polylines that end where they start, which are stitched into closed lines later.
+ * \param outline The prepared outline of a single part.
+ * \param beading_strategy The beading strategy that the skeletal trapezoidation would otherwise use.
+ * \param inset_count The maximum number of walls.
+ * \param margin How much wider than the maximum number of walls the outline needs to be, so that the skeleton wouldn't have any transitions.
+ * \param toolpaths Where to put the walls, per inset, with the 0-width inner contour after them.
+ * \return Whether the outline was simple enough. If not, nothing was generated.
+ */
+bool generateTrivialToolpaths(
+    const Shape& outline,
+    const BeadingStrategy& beading_strategy,
+    const size_t inset_count,
+    const coord_t margin,
+    std::vector<VariableWidthLines>& toolpaths)
+{
+    if (outline.size() != 1 || inset_count > max_trivial_inset_count || outline.front().size() < 3 || outline.front().area() <= 0)
+    {
+        return false;
+    }
+    const Polygon& polygon = outline.front();
+    const auto max_bead_count = static_cast<coord_t>(2 * inset_count);
+
+    // Everywhere inside, the skeleton needs to be so far from the outline that it gets more beads than the maximum, which are then limited and won't change.
+    const coord_t min_depth = beading_strategy.getTransitionThickness(max_bead_count) / 2 + margin;
+    if (! offsetTrivialPolygon(polygon, min_depth))
+    {
+        return false;
+    }
+
+    // The beads from the outline up to the 0-width inner contour, when there are more than the maximum.
+    const BeadingStrategy::Beading beading = beading_strategy.compute(min_depth * 2, max_bead_count + 1);
+    if (beading.toolpath_locations.size() <= inset_count || beading.bead_widths[inset_count] != 0)
+    {
+        return false;
+    }
+    std::vector<VariableWidthLines> result(inset_count + 1);
+    for (size_t inset_idx = 0; inset_idx <= inset_count; inset_idx++)
+    {
+        const std::optional<std::vector<Point2LL>> points = offsetTrivialPolygon(polygon, beading.toolpath_locations[inset_idx]);
+        if (! points)
+        {
+            return false;
+        }
+        constexpr bool is_odd = false;
+        ExtrusionLine& line = result[inset_idx].emplace_back(inset_idx, is_odd);
+        for (const Point2LL& point : *points)
+        {
+            line.emplace_back(point, beading.bead_widths[inset_idx], inset_idx);
+        }
+        line.emplace_back(points->front(), beading.bead_widths[inset_idx], inset_idx);
+    }
+    toolpaths = std::move(result);
+    return true;
+}
+
+} // namespace
+
 WallToolPaths::WallToolPaths(
     const Shape& outline,
     const coord_t nominal_bead_width,
@@ -147,17 +271,63 @@ const std::vector<VariableWidthLines>& WallToolPaths::generate()
         wall_distribution_count);
     const auto transition_filter_dist = settings_.get<coord_t>("wall_transition_filter_distance");
     const auto allowed_filter_deviation = settings_.get<coord_t>("wall_transition_filter_deviation");
-    SkeletalTrapezoidation wall_maker(
-        prepared_outline,
-        *beading_strat,
-        beading_strat->getTransitioningAngle(),
-        discretization_step_size,
-        transition_filter_dist,
-        allowed_filter_deviation,
-        wall_transition_length,
-        layer_idx_,
-        section_type_);
-    wall_maker.generateToolpaths(toolpaths_);
+    const auto generate_part_toolpaths = [&](const Shape& part_outline, std::vector<VariableWidthLines>& part_toolpaths)
+    {
+        // Most parts are simple enough that their walls are just offsets of their outline, which is much cheaper than their skeleton.
+        if (generateTrivialToolpaths(part_outline, *beading_strat, inset_count_, std::max(bead_width_x_, wall_transition_length), part_toolpaths))
+        {
+            return;
+        }
+        SkeletalTrapezoidation wall_maker(
+            part_outline,
+            *beading_strat,
+            beading_strat->getTransitioningAngle(),
+            discretization_step_size,
+            transition_filter_dist,
+            allowed_filter_deviation,
+            wall_transition_length,
+            layer_idx_,
+            section_type_);
+        wall_maker.generateToolpaths(part_toolpaths);
+    };
+
+    // The skeleton inside a part only depends on the outline of that part, so large layers with many parts can have their parts trapezoidated in parallel.
+    // Smaller layers aren't worth the overhead, since the layers themselves are already processed in parallel.
+    constexpr size_t min_parallel_point_count = 4000;
+    std::vector<SingleShape> parts;
+    if (prepared_outline.pointCount() >= min_parallel_point_count)
+    {
+        parts = prepared_outline.splitIntoParts();
+    }
+    if (parts.size() > 1)
+    {
+        std::vector<std::vector<VariableWidthLines>> part_toolpaths(parts.size());
+        cura::parallel_for<size_t>(
+            0,
+            parts.size(),
+            [&](const size_t part_idx)
+            {
+                generate_part_toolpaths(parts[part_idx], part_toolpaths[part_idx]);
+            });
+
+        // Merge the parts in the order they were split in, so that the result doesn't depend on which thread finished first.
+        for (std::vector<VariableWidthLines>& toolpaths : part_toolpaths)
+        {
+            if (toolpaths.size() > toolpaths_.size())
+            {
+                toolpaths_.resize(toolpaths.size());
+            }
+            for (size_t inset_idx = 0; inset_idx < toolpaths.size(); inset_idx++)
+            {
+                VariableWidthLines& merged = toolpaths_[inset_idx];
+                merged.insert(merged.end(), std::make_move_iterator(toolpaths[inset_idx].begin()), std::make_move_iterator(toolpaths[inset_idx].end()));
+            }
+        }
+    }
+    else
+    {
+        generate_part_toolpaths(prepared_outline, toolpaths_);
+    }
     scripta::log(
         "toolpaths_0",
         toolpaths_,
@@ -254,7 +424,7 @@ void WallToolPaths::stitchToolPaths(std::vector<VariableWidthLines>& toolpaths,
         VariableWidthLines stitched_polylines;
         VariableWidthLines closed_polygons;
         ExtrusionLineStitcher::stitch(wall_lines, stitched_polylines, closed_polygons, stitch_distance);
-        wall_lines = stitched_polylines; // replace input toolpaths with stitched polylines
+        wall_lines = std::move(stitched_polylines); // replace input toolpaths with stitched polylines
 
         for (ExtrusionLine& wall_polygon : closed_polygons)
         {
@@ -305,24 +475,14 @@ void WallToolPaths::simplifyToolPaths(std::vector<VariableWidthLines>& toolpaths
     const Simplify simplifier(settings);
     for (auto& toolpath : toolpaths)
     {
-        toolpath = toolpath
-                 | ranges::views::transform(
-                       [&simplifier](auto& line)
-                       {
-                           auto line_ = line.is_closed_ ? simplifier.polygon(line) : simplifier.polyline(line);
-
-                           if (line_.is_closed_ && line_.size() >= 2 && line_.front() != line_.back())
-                           {
-                               line_.emplace_back(line_.front());
-                           }
-                           return line_;
-                       })
-                 | ranges::views::filter(
-                       [](const auto& line)
-                       {
-                           return ! line.empty();
-                       })
-                 | ranges::to_vector;
+        toolpath = simplifier.lines(toolpath);
+        for (ExtrusionLine& line : toolpath)
+        {
+            if (line.is_closed_ && line.size() >= 2 && line.front() != line.back())
+            {
+                line.emplace_back(line.front());
+            }
+        }
     }
 }
 
@@ -352,7 +512,7 @@ void WallToolPaths::separateOutInnerContour()
     std::vector<VariableWidthLines> contour_paths;
     contour_paths.reserve(toolpaths_.size() / inset_count_);
     inner_contour_.clear();
-    for (const VariableWidthLines& inset : toolpaths_)
+    for (VariableWidthLines& inset : toolpaths_)
     {
         if (inset.empty())
         {
@@ -401,7 +561,7 @@ void WallToolPaths::separateOutInnerContour()
         }
         else
         {
-            actual_toolpaths.emplace_back(inset);
+            actual_toolpaths.emplace_back(std::move(inset));
         }
     }
     if (! actual_toolpaths.empty())
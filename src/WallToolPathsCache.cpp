@@ -0,0 +1,117 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "WallToolPathsCache.h"
+
+#include "geometry/Polygon.h"
+
+namespace cura
+{
+
+WallToolPathsCache::WallToolPathsCache(size_t max_entries)
+    : max_entries_(max_entries)
+{
+}
+
+std::optional<WallToolPathsCache::Walls> WallToolPathsCache::find(const Shape& outline, const Parameters& parameters) const
+{
+    const uint64_t key = hash(outline, parameters);
+    std::vector<std::shared_ptr<const Entry>> candidates;
+    {
+        std::lock_guard lock(mutex_);
+        const auto [begin, end] = entries_.equal_range(key);
+        for (auto it = begin; it != end; ++it)
+        {
+            candidates.push_back(it->second);
+        }
+    }
+
+    // Compare the outlines outside of the lock. The entries are immutable, and the shared pointers keep them alive if they are evicted meanwhile.
+    for (const std::shared_ptr<const Entry>& candidate : candidates)
+    {
+        if (candidate->parameters == parameters && isSameOutline(candidate->outline, outline))
+        {
+            return candidate->walls;
+        }
+    }
+    return std::nullopt;
+}
+
+void WallToolPathsCache::store(const Shape& outline, const Parameters& parameters, const Walls& walls)
+{
+    if (max_entries_ == 0)
+    {
+        return;
+    }
+    const uint64_t key = hash(outline, parameters);
+    auto entry = std::make_shared<const Entry>(Entry{ outline, parameters, walls });
+
+    std::lock_guard lock(mutex_);
+    const auto [begin, end] = entries_.equal_range(key);
+    for (auto it = begin; it != end; ++it)
+    {
+        if (it->second->parameters == parameters && isSameOutline(it->second->outline, outline))
+        {
+            return; // Another layer with the same outline was faster.
+        }
+    }
+
+    if (order_.size() >= max_entries_)
+    {
+        const std::shared_ptr<const Entry> oldest = order_.front();
+        order_.pop_front();
+        const auto [oldest_begin, oldest_end] = entries_.equal_range(hash(oldest->outline, oldest->parameters));
+        for (auto it = oldest_begin; it != oldest_end; ++it)
+        {
+            if (it->second == oldest)
+            {
+                entries_.erase(it);
+                break;
+            }
+        }
+    }
+    order_.push_back(entry);
+    entries_.emplace(key, std::move(entry));
+}
+
+uint64_t WallToolPathsCache::hash(const Shape& outline, const Parameters& parameters)
+{
+    uint64_t result = 0xcbf29ce484222325ULL;
+    const auto mix = [&result](const uint64_t value)
+    {
+        result ^= value + 0x9E3779B97F4A7C15ULL + (result << 6) + (result >> 2);
+    };
+    mix(static_cast<uint64_t>(parameters.line_width_0));
+    mix(static_cast<uint64_t>(parameters.line_width_x));
+    mix(parameters.wall_count);
+    mix(static_cast<uint64_t>(parameters.wall_0_inset));
+    mix(static_cast<uint64_t>(parameters.section_type));
+    for (const Polygon& polygon : outline)
+    {
+        mix(polygon.size());
+        for (const Point2LL& point : polygon)
+        {
+            mix(static_cast<uint64_t>(point.X));
+            mix(static_cast<uint64_t>(point.Y));
+        }
+    }
+    return result;
+}
+
+bool WallToolPathsCache::isSameOutline(const Shape& a, const Shape& b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (size_t polygon_idx = 0; polygon_idx < a.size(); polygon_idx++)
+    {
+        if (a[polygon_idx].getPoints() != b[polygon_idx].getPoints())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace cura
@@ -16,16 +16,19 @@
 #include "ExtruderTrain.h"
 #include "Slice.h"
 #include "WallToolPaths.h"
+#include "settings/EnumSettings.h"
 #include "settings/types/Ratio.h"
 #include "sliceDataStorage.h"
 #include "utils/Simplify.h" // We're simplifying the spiralized insets.
+#include "utils/TraceSpan.h"
 
 namespace cura
 {
 
-WallsComputation::WallsComputation(const Settings& settings, const LayerIndex layer_nr)
+WallsComputation::WallsComputation(const Settings& settings, const LayerIndex layer_nr, WallToolPathsCache* cache)
     : settings_(settings)
     , layer_nr_(layer_nr)
+    , cache_(cache)
 {
 }
 
@@ -73,16 +76,12 @@ void WallsComputation::generateWalls(SliceLayerPart* part, SectionType section_t
         generateSpiralInsets(part, line_width_0, wall_0_inset, recompute_outline_based_on_outer_wall);
         if (layer_nr_ <= static_cast<LayerIndex>(settings_.get<size_t>("initial_bottom_layers")))
         {
-            WallToolPaths wall_tool_paths(part->outline, line_width_0, line_width_x, wall_count, wall_0_inset, settings_, layer_nr_, section_type);
-            part->wall_toolpaths = wall_tool_paths.getToolPaths();
-            part->inner_area = wall_tool_paths.getInnerContour();
+            generateWallToolPaths(part, line_width_0, line_width_x, wall_count, wall_0_inset, section_type);
         }
     }
     else
     {
-        WallToolPaths wall_tool_paths(part->outline, line_width_0, line_width_x, wall_count, wall_0_inset, settings_, layer_nr_, section_type);
-        part->wall_toolpaths = wall_tool_paths.getToolPaths();
-        part->inner_area = wall_tool_paths.getInnerContour();
+        generateWallToolPaths(part, line_width_0, line_width_x, wall_count, wall_0_inset, section_type);
     }
 
     part->outline = SingleShape{ Simplify(settings_).polygon(part->outline) };
@@ -97,6 +96,7 @@ void WallsComputation::generateWalls(SliceLayerPart* part, SectionType section_t
  */
 void WallsComputation::generateWalls(SliceLayer* layer, SectionType section)
 {
+    CURA_TRACE_SPAN("WallsComputation::generateWalls");
     for (SliceLayerPart& part : layer->parts)
     {
         generateWalls(&part, section);
@@ -121,6 +121,53 @@ void WallsComputation::generateWalls(SliceLayer* layer, SectionType section)
     }
 }
 
+void WallsComputation::generateWallToolPaths(
+    SliceLayerPart* part,
+    coord_t line_width_0,
+    coord_t line_width_x,
+    size_t wall_count,
+    coord_t wall_0_inset,
+    SectionType section_type)
+{
+    const WallToolPathsCache::Parameters parameters{ line_width_0, line_width_x, wall_count, wall_0_inset, section_type };
+    if (cache_)
+    {
+        if (std::optional<WallToolPathsCache::Walls> walls = cache_->find(part->outline, parameters))
+        {
+            part->wall_toolpaths = std::move(walls->toolpaths);
+            part->inner_area = std::move(walls->inner_contour);
+            return;
+        }
+    }
+
+    WallToolPaths wall_tool_paths(part->outline, line_width_0, line_width_x, wall_count, wall_0_inset, settings_, layer_nr_, section_type);
+    part->wall_toolpaths = wall_tool_paths.getToolPaths();
+    part->inner_area = wall_tool_paths.getInnerContour();
+    computeCornerAngles(part->wall_toolpaths);
+    if (cache_)
+    {
+        cache_->store(part->outline, parameters, WallToolPathsCache::Walls{ part->wall_toolpaths, part->inner_area });
+    }
+}
+
+void WallsComputation::computeCornerAngles(std::vector<VariableWidthLines>& toolpaths) const
+{
+    if (settings_.get<EZSeamType>("z_seam_type") == EZSeamType::RANDOM || settings_.get<EZSeamCornerPrefType>("z_seam_corner") == EZSeamCornerPrefType::Z_SEAM_CORNER_PREF_NONE)
+    {
+        return;
+    }
+    for (VariableWidthLines& lines : toolpaths)
+    {
+        for (ExtrusionLine& line : lines)
+        {
+            if (line.is_closed_)
+            {
+                line.computeCornerAngles();
+            }
+        }
+    }
+}
+
 void WallsComputation::generateSpiralInsets(SliceLayerPart* part, coord_t line_width_0, coord_t wall_0_inset, bool recompute_outline_based_on_outer_wall)
 {
     part->spiral_wall = part->outline.offset(-line_width_0 / 2 - wall_0_inset);
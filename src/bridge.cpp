@@ -29,7 +29,13 @@ double bridgeAngle(
     //  This gives us the islands that the layer rests on.
     Shape islands;
 
-    Shape prev_layer_outline; // we also want the complete outline of the previous layer
+    Shape prev_layer_outline; // we also want the complete outline of the previous layer, around the skin
+
+    // The outline of the previous layer is only used to find the air below the edges of the skin, after shrinking that air a bit. Parts that are farther away
+    // from the skin don't change that, so they're skipped before computing anything with them.
+    constexpr coord_t nearby_distance = 100;
+    AABB nearby_box = boundary_box;
+    nearby_box.expand(nearby_distance);
 
     const Ratio sparse_infill_max_density = settings.get<Ratio>("bridge_sparse_infill_max_density");
 
@@ -46,6 +52,10 @@ double bridgeAngle(
 
             for (const SliceLayerPart& prev_layer_part : mesh.layers[layer_nr - bridge_layer].parts)
             {
+                if (! nearby_box.hit(prev_layer_part.boundaryBox))
+                {
+                    continue;
+                }
                 Shape solid_below(prev_layer_part.outline);
                 if (bridge_layer == 1 && part_has_sparse_infill)
                 {
@@ -88,6 +98,10 @@ double bridgeAngle(
         {
             for (const SupportInfillPart& support_part : support_layer->support_infill_parts)
             {
+                if (! boundary_box.hit(support_part.outline_boundary_box_)) // The infill area is inside the outline.
+                {
+                    continue;
+                }
                 AABB support_part_bb(support_part.getInfillArea());
                 if (boundary_box.hit(support_part_bb))
                 {
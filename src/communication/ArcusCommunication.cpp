@@ -17,6 +17,8 @@
 #include <sentry.h>
 #endif
 
+#include <cstdint>
+#include <string>
 #include <thread> //To sleep while waiting for the connection.
 #include <unordered_map> //To map settings to their extruder numbers for limit_to_extruder.
 
@@ -64,8 +66,7 @@ class ArcusCommunication::PathCompiler
     std::vector<float> line_widths; //!< Line widths for the line segments stored, the size of this vector is N.
     std::vector<float> line_thicknesses; //!< Line thicknesses for the line segments stored, the size of this vector is N.
     std::vector<float> line_velocities; //!< Line feedrates for the line segments stored, the size of this vector is N.
-    std::vector<float> points; //!< The points used to define the line segments, the size of this vector is D*(N+1) as each line segment is defined from one point to the next. D is
-                               //!< the dimensionality of the point.
+    std::vector<Point2LL> points; //!< The points used to define the line segments, the size of this vector is N+1 as each line segment is defined from one point to the next.
 
     Point2LL last_point;
 
@@ -172,13 +173,34 @@ public:
         path_segment->set_extruder(extruder);
         path_segment->set_point_type(data_point_type);
 
+        if (_cs_private_data.compact_path_segments)
+        {
+            path_segment->set_encoding(proto::PathSegment::Compact);
+            path_segment->set_line_type(encodeRuns(line_types));
+            path_segment->set_points(encodeDeltas(points));
+            path_segment->set_line_width(encodeRuns(line_widths));
+            path_segment->set_line_thickness(encodeRuns(line_thicknesses));
+            path_segment->set_line_feedrate(encodeRuns(line_velocities));
+            line_types.clear();
+            points.clear();
+            line_widths.clear();
+            line_thicknesses.clear();
+            line_velocities.clear();
+            return;
+        }
+
         std::string line_type_data;
         line_type_data.append(reinterpret_cast<const char*>(line_types.data()), line_types.size() * sizeof(PrintFeatureType));
         line_types.clear();
         path_segment->set_line_type(line_type_data);
 
         std::string polygon_data;
-        polygon_data.append(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(float));
+        polygon_data.reserve(points.size() * 2 * sizeof(float));
+        for (const Point2LL& point : points)
+        {
+            const float coordinates[2] = { static_cast<float>(INT2MM(point.X)), static_cast<float>(INT2MM(point.Y)) };
+            polygon_data.append(reinterpret_cast<const char*>(coordinates), sizeof(coordinates));
+        }
         points.clear();
         path_segment->set_points(polygon_data);
 
@@ -265,18 +287,76 @@ public:
 
 private:
     /*!
-     * \brief Convert and add a point to the points buffer.
+     * \brief Add a point to the points buffer.
      *
-     * Each point is represented as two consecutive floats. All members adding a
-     * 2D point to the data should use this function.
+     * All members adding a 2D point to the data should use this function.
      */
     void addPoint2D(const Point2LL& point)
     {
-        points.push_back(INT2MM(point.X));
-        points.push_back(INT2MM(point.Y));
+        points.push_back(point);
         last_point = point;
     }
 
+    //! Append \p value as a varint: seven bits per byte, least significant first, with the top bit set on all but the last byte.
+    static void appendVarint(std::string& data, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        data.push_back(static_cast<char>(value));
+    }
+
+    /*!
+     * \brief Encode the points as the zigzag encoded differences between
+     * consecutive coordinates, for the compact encoding.
+     *
+     * Consecutive points are close together, so most differences fit in one
+     * or two bytes.
+     */
+    static std::string encodeDeltas(const std::vector<Point2LL>& points)
+    {
+        std::string data;
+        data.reserve(points.size() * 4);
+        Point2LL previous{ 0, 0 };
+        for (const Point2LL& point : points)
+        {
+            for (const coord_t delta : { point.X - previous.X, point.Y - previous.Y })
+            {
+                appendVarint(data, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+            }
+            previous = point;
+        }
+        return data;
+    }
+
+    /*!
+     * \brief Encode the values as runs of equal values, for the compact
+     * encoding.
+     *
+     * The line types, widths, thicknesses and feedrates are mostly the same
+     * along a path, so there are few runs.
+     */
+    template<typename T>
+    static std::string encodeRuns(const std::vector<T>& values)
+    {
+        std::string data;
+        size_t run_start = 0;
+        while (run_start < values.size())
+        {
+            size_t run_end = run_start + 1;
+            while (run_end < values.size() && values[run_end] == values[run_start])
+            {
+                run_end++;
+            }
+            appendVarint(data, run_end - run_start);
+            data.append(reinterpret_cast<const char*>(&values[run_start]), sizeof(T));
+            run_start = run_end;
+        }
+        return data;
+    }
+
     /*!
      * \brief Implements the functionality of adding a single 2D line segment to
      * the path data.
@@ -361,11 +441,8 @@ void ArcusCommunication::flushGCode()
     {
         return;
     }
-    std::shared_ptr<proto::GCodeLayer> message = std::make_shared<proto::GCodeLayer>();
-    message->set_data(message_str);
-
     // Send the g-code to the front-end! Yay!
-    private_data->socket->sendMessage(message);
+    private_data->sendGCode(message_str);
 
     private_data->gcode_output_stream.str("");
 }
@@ -375,6 +452,11 @@ bool ArcusCommunication::isSequential() const
     return false; // We don't necessarily need to send the start g-code before the rest. We can send it afterwards when we have more accurate print statistics.
 }
 
+bool ArcusCommunication::wantsLayerView() const
+{
+    return true;
+}
+
 bool ArcusCommunication::hasSlice() const
 {
     return private_data->socket->getState() != Arcus::SocketState::Closed && private_data->socket->getState() != Arcus::SocketState::Error
@@ -487,7 +569,7 @@ void ArcusCommunication::sendPrintTimeMaterialEstimates() const
     spdlog::debug("Done sending print time and material estimates.");
 }
 
-void ArcusCommunication::sendProgress(double progress) const
+void ArcusCommunication::sendProgress(double progress, std::optional<Duration> remaining_time) const
 {
     const int rounded_amount = 1000 * progress;
     if (private_data->last_sent_progress == rounded_amount) // No need to send another tiny update step.
@@ -499,6 +581,17 @@ void ArcusCommunication::sendProgress(double progress) const
     double progress_all_objects = progress / private_data->object_count;
     progress_all_objects += private_data->optimized_layers.sliced_objects * (1.0 / private_data->object_count);
     message->set_amount(progress_all_objects);
+    if (remaining_time && progress < 1.0)
+    {
+        // The other objects are assumed to take as long as this one will have taken.
+        const size_t sliced_objects = private_data->optimized_layers.sliced_objects;
+        const size_t objects_after_this = private_data->object_count > sliced_objects + 1 ? private_data->object_count - sliced_objects - 1 : 0;
+        message->set_remaining_time(*remaining_time + objects_after_this * *remaining_time / (1.0 - progress));
+    }
+    else
+    {
+        message->set_remaining_time(-1);
+    }
     private_data->socket->sendMessage(message);
 
     private_data->last_sent_progress = rounded_amount;
@@ -555,6 +648,7 @@ void ArcusCommunication::sliceNext()
 
     Slice slice(slice_message->object_lists().size());
     Application::getInstance().current_slice_ = &slice;
+    private_data->compact_path_segments = slice_message->compact_path_segments();
 
     private_data->readGlobalSettingsMessage(slice_message->global_settings());
     private_data->readExtruderSettingsMessage(slice_message->extruders());
@@ -575,6 +669,7 @@ void ArcusCommunication::sliceNext()
         ExtruderTrain& extruder = slice.scene.extruders[setting_extruder.extruder()];
         slice.scene.limit_to_extruder.emplace(setting_extruder.name(), &extruder);
     }
+    Settings::invalidateCaches(); // Settings looked up so far may have been resolved without the limiting.
 
     // Load all mesh groups, meshes and their settings.
     private_data->object_count = 0;
@@ -5,6 +5,11 @@
 
 #include "communication/ArcusCommunicationPrivate.h"
 
+#include <cstring> //To copy the vertices out of the message.
+#include <thread> //To wait for the socket to send g-code.
+#include <vector>
+
+#include <Arcus/Socket.h> //To check whether the socket is still connected.
 #include <spdlog/spdlog.h>
 
 #include "Application.h"
@@ -13,6 +18,7 @@
 #include "settings/types/LayerIndex.h"
 #include "utils/Matrix4x3D.h" //To convert vertices to integer-points.
 #include "utils/Point3F.h" //To accept vertices (which are provided in floating point).
+#include "utils/ThreadPool.h" //To convert the vertices in parallel.
 
 namespace cura
 {
@@ -20,12 +26,53 @@ namespace cura
 ArcusCommunication::Private::Private()
     : socket(nullptr)
     , object_count(0)
+    , compact_path_segments(false)
+    , gcode_in_flight_size(0)
     , last_sent_progress(-1)
     , slice_count(0)
     , millisecUntilNextTry(100)
 {
 }
 
+void ArcusCommunication::Private::sendGCode(const std::string& gcode)
+{
+    size_t start = 0;
+    while (start < gcode.size())
+    {
+        size_t end = gcode.size();
+        if (end - start > max_gcode_message_size)
+        {
+            const size_t last_line_break = gcode.rfind('\n', start + max_gcode_message_size - 1);
+            end = (last_line_break != std::string::npos && last_line_break >= start) ? last_line_break + 1 : start + max_gcode_message_size;
+        }
+        const size_t message_size = end - start;
+
+        releaseSentGCode();
+        while (gcode_in_flight_size + message_size > max_gcode_in_flight && ! gcode_in_flight.empty() && socket->getState() == Arcus::SocketState::Connected)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10)); // The front-end is slower than we are. Give it some time.
+            releaseSentGCode();
+        }
+
+        std::shared_ptr<proto::GCodeLayer> message = std::make_shared<proto::GCodeLayer>();
+        message->set_data(gcode.substr(start, message_size));
+        gcode_in_flight.emplace_back(message, message_size);
+        gcode_in_flight_size += message_size;
+        socket->sendMessage(message);
+        start = end;
+    }
+}
+
+void ArcusCommunication::Private::releaseSentGCode()
+{
+    // The socket sends the messages in order, so the oldest message goes first.
+    while (! gcode_in_flight.empty() && gcode_in_flight.front().first.expired())
+    {
+        gcode_in_flight_size -= gcode_in_flight.front().second;
+        gcode_in_flight.pop_front();
+    }
+}
+
 std::shared_ptr<proto::LayerOptimized> ArcusCommunication::Private::getOptimizedLayerById(LayerIndex::value_type layer_nr)
 {
     layer_nr += optimized_layers.current_layer_offset;
@@ -122,17 +169,22 @@ void ArcusCommunication::Private::readMeshGroupMessage(const proto::ObjectList&
         ExtruderTrain& extruder = mesh.settings_.get<ExtruderTrain&>("extruder_nr"); // Set the parent setting to the correct extruder.
         mesh.settings_.setParent(&extruder.settings_);
 
-        for (size_t face = 0; face < face_count; face++)
-        {
-            const std::string data = object.vertices().substr(face * bytes_per_face, bytes_per_face);
-            const Point3F* float_vertices = reinterpret_cast<const Point3F*>(data.data());
-
-            Point3LL verts[3];
-            verts[0] = matrix.apply(float_vertices[0].toPoint3d());
-            verts[1] = matrix.apply(float_vertices[1].toPoint3d());
-            verts[2] = matrix.apply(float_vertices[2].toPoint3d());
-            mesh.addFace(verts[0], verts[1], verts[2]);
-        }
+        // The vertices are read from the message in place. The faces are independent of each other, so they are converted in parallel, like when loading a binary STL file.
+        const char* vertex_data = object.vertices().data();
+        std::vector<Point3LL> corners(face_count * 3);
+        cura::parallel_for<size_t>(
+            0,
+            face_count,
+            [&](const size_t face_idx)
+            {
+                Point3F float_vertices[3];
+                std::memcpy(float_vertices, vertex_data + face_idx * bytes_per_face, bytes_per_face);
+                corners[face_idx * 3 + 0] = matrix.apply(float_vertices[0].toPoint3d());
+                corners[face_idx * 3 + 1] = matrix.apply(float_vertices[1].toPoint3d());
+                corners[face_idx * 3 + 2] = matrix.apply(float_vertices[2].toPoint3d());
+            },
+            1024);
+        mesh.addFaces(std::move(corners));
 
         mesh.mesh_name_ = object.name();
         mesh.finish();
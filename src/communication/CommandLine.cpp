@@ -3,10 +3,17 @@
 
 #include "communication/CommandLine.h"
 
+#include <cctype>
 #include <cerrno> // error number when trying to read file
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib> //For strtod.
 #include <cstring> //For strtok and strcopy.
+#include <deque>
 #include <filesystem>
 #include <fstream> //To check if files exist.
+#include <mutex>
 #include <numeric> //For std::accumulate.
 #include <optional>
 #include <rapidjson/error/en.h> //Loading JSON documents to get settings from them.
@@ -15,10 +22,12 @@
 #include <rapidjson/writer.h>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
+#include <fmt/format.h>
 #include <range/v3/all.hpp>
 #include <spdlog/details/os.h>
 #include <spdlog/spdlog.h>
@@ -29,6 +38,15 @@
 #include "MeshGroup.h"
 #include "Slice.h"
 #include "utils/Matrix4x3D.h" //For the mesh_rotation_matrix setting.
+#ifdef SETTINGS_PROFILING
+#include "settings/SettingsProfiler.h"
+#endif
+#ifdef ALLOCATION_PROFILING
+#include "utils/AllocationProfiler.h"
+#endif
+#include "progress/SlowLayerCapture.h"
+#include "progress/TimingReport.h"
+#include "utils/ThreadPoolProfiler.h"
 #include "utils/format/filesystem_path.h"
 #include "utils/views/split_paths.h"
 
@@ -39,6 +57,74 @@
 namespace cura
 {
 
+struct CommandLine::JobQueue
+{
+    std::mutex mutex;
+    std::condition_variable job_added;
+    std::deque<std::vector<std::string>> jobs; //!< The arguments of each job, as they would be given to the executable.
+    bool closed = false; //!< Whether the input ended, so no more jobs will be added.
+};
+
+namespace
+{
+
+/*!
+ * Split a line into arguments at the spaces, except for spaces between double
+ * quotes. A backslash in quotes escapes the next character.
+ */
+std::vector<std::string> splitArguments(const std::string_view line)
+{
+    std::vector<std::string> arguments;
+    std::string argument;
+    bool in_argument = false;
+    bool in_quotes = false;
+    for (size_t i = 0; i < line.size(); i++)
+    {
+        const char character = line[i];
+        if (in_quotes)
+        {
+            if (character == '"')
+            {
+                in_quotes = false;
+            }
+            else if (character == '\\' && i + 1 < line.size())
+            {
+                argument += line[++i];
+            }
+            else
+            {
+                argument += character;
+            }
+        }
+        else if (character == '"')
+        {
+            in_quotes = true;
+            in_argument = true;
+        }
+        else if (std::isspace(static_cast<unsigned char>(character)))
+        {
+            if (in_argument)
+            {
+                arguments.push_back(std::move(argument));
+                argument.clear();
+                in_argument = false;
+            }
+        }
+        else
+        {
+            argument += character;
+            in_argument = true;
+        }
+    }
+    if (in_argument)
+    {
+        arguments.push_back(std::move(argument));
+    }
+    return arguments;
+}
+
+} // namespace
+
 CommandLine::CommandLine(const std::vector<std::string>& arguments)
     : arguments_{ arguments }
     , last_shown_progress_{ 0 }
@@ -47,6 +133,10 @@ CommandLine::CommandLine(const std::vector<std::string>& arguments)
     {
         search_directories_ = search_paths | views::split_paths | ranges::to<std::vector<std::filesystem::path>>();
     };
+    if (auto cache_directory = spdlog::details::os::getenv("CURAENGINE_DEFINITION_CACHE"); ! cache_directory.empty())
+    {
+        definition_cache_.emplace(cache_directory);
+    }
 }
 
 // These are not applicable to command line slicing.
@@ -84,9 +174,57 @@ void CommandLine::setLayerForSend(const LayerIndex::value_type&)
 {
 }
 
+void CommandLine::readJobs(std::istream& input)
+{
+    job_queue_ = std::make_shared<JobQueue>();
+    initial_search_directories_ = search_directories_;
+    if (! definition_cache_)
+    {
+        definition_cache_.emplace(std::filesystem::path{}); // Only keep the definitions in memory, for the next jobs.
+    }
+
+    // Detached, since it may be waiting for input when the engine exits.
+    std::thread(
+        [&input, job_queue = job_queue_]()
+        {
+            std::string line;
+            while (std::getline(input, line))
+            {
+                std::vector<std::string> job_arguments = splitArguments(line);
+                if (job_arguments.empty())
+                {
+                    continue;
+                }
+                job_arguments.insert(job_arguments.begin(), { "CuraEngine", "slice" }); // Slicing starts interpreting the arguments after these.
+                std::lock_guard lock(job_queue->mutex);
+                job_queue->jobs.push_back(std::move(job_arguments));
+                job_queue->job_added.notify_one();
+            }
+            std::lock_guard lock(job_queue->mutex);
+            job_queue->closed = true;
+            job_queue->job_added.notify_one();
+        })
+        .detach();
+}
+
 bool CommandLine::hasSlice() const
 {
-    return ! arguments_.empty();
+    if (! arguments_.empty())
+    {
+        return true;
+    }
+    if (! job_queue_)
+    {
+        return false;
+    }
+    std::unique_lock lock(job_queue_->mutex);
+    job_queue_->job_added.wait(
+        lock,
+        [this]()
+        {
+            return ! job_queue_->jobs.empty() || job_queue_->closed;
+        });
+    return ! job_queue_->jobs.empty();
 }
 
 bool CommandLine::isSequential() const
@@ -94,6 +232,11 @@ bool CommandLine::isSequential() const
     return true; // We have to receive the g-code in sequential order. Start g-code before the rest and so on.
 }
 
+bool CommandLine::wantsLayerView() const
+{
+    return false; // All the layer view data would be dropped anyway.
+}
+
 void CommandLine::sendGCodePrefix(const std::string&) const
 {
     // TODO: Right now this is done directly in the g-code writer. For consistency it should be moved here?
@@ -117,13 +260,19 @@ void CommandLine::sendPrintTimeMaterialEstimates() const
     }
 }
 
-void CommandLine::sendProgress(double progress) const
+void CommandLine::sendProgress(double progress, std::optional<Duration> remaining_time) const
 {
     const unsigned int rounded_amount = 100 * progress;
     if (last_shown_progress_ == rounded_amount) // No need to send another tiny update step.
     {
         return;
     }
+    last_shown_progress_ = rounded_amount;
+    if (job_queue_) // Let whoever gives the jobs know when to expect this one to be done.
+    {
+        fmt::print("job {} progress {:.2f} remaining {:.1f}\n", job_number_, progress, remaining_time ? static_cast<double>(*remaining_time) : -1.0);
+        std::fflush(stdout);
+    }
     // TODO: Do we want to print a progress bar? We'd need a better solution to not have that progress bar be ruined by any logging.
 #ifdef __EMSCRIPTEN__
     // Call progress handler with progress
@@ -135,6 +284,20 @@ void CommandLine::sendProgress(double progress) const
 
 void CommandLine::sliceNext()
 {
+    if (arguments_.empty() && job_queue_)
+    {
+        std::lock_guard lock(job_queue_->mutex);
+        if (job_queue_->jobs.empty())
+        {
+            return;
+        }
+        arguments_ = std::move(job_queue_->jobs.front());
+        job_queue_->jobs.pop_front();
+        job_number_++;
+        last_shown_progress_ = 0;
+        search_directories_ = initial_search_directories_; // Loading definition files adds their directories, which shouldn't carry over to the next job.
+        Application::getInstance().cancellation_.clearTimeLimit();
+    }
     FffProcessor::getInstance()->time_keeper.restart();
 
     // Count the number of mesh groups to slice for.
@@ -203,6 +366,63 @@ void CommandLine::sliceNext()
                     force_read_parent = false;
                     force_read_nondefault = false;
                 }
+                else if (argument.starts_with("--profile-settings"))
+                {
+#ifdef SETTINGS_PROFILING
+                    const size_t equals = argument.find('=');
+                    SettingsProfiler::getInstance().enable(equals == std::string::npos ? "" : argument.substr(equals + 1));
+#else
+                    spdlog::warn("Settings profiling is not compiled in. Build with ENABLE_SETTINGS_PROFILING to use --profile-settings.");
+#endif
+                }
+                else if (argument.starts_with("--profile-allocations"))
+                {
+#ifdef ALLOCATION_PROFILING
+                    const size_t equals = argument.find('=');
+                    AllocationProfiler::getInstance().enable(equals == std::string::npos ? "" : argument.substr(equals + 1));
+#else
+                    spdlog::warn("Allocation profiling is not compiled in. Build with ENABLE_ALLOCATION_PROFILING to use --profile-allocations.");
+#endif
+                }
+                else if (argument.starts_with("--profile-threads"))
+                {
+                    const size_t equals = argument.find('=');
+                    ThreadPoolProfiler::getInstance().enable(equals == std::string::npos ? "" : argument.substr(equals + 1));
+                }
+                else if (argument.starts_with("--timing-report="))
+                {
+                    TimingReport::getInstance().enable(argument.substr(std::string_view("--timing-report=").size()));
+                }
+                else if (argument.starts_with("--capture-slow-layers="))
+                {
+                    const std::string capture = argument.substr(std::string_view("--capture-slow-layers=").size());
+                    const size_t comma = capture.rfind(',');
+                    double threshold = 10.0;
+                    if (comma != std::string::npos)
+                    {
+                        const std::string threshold_text = capture.substr(comma + 1);
+                        char* end;
+                        threshold = std::strtod(threshold_text.c_str(), &end);
+                        if (threshold_text.empty() || *end != '\0' || threshold < 0)
+                        {
+                            spdlog::error("Invalid slow layer threshold: {}", threshold_text);
+                            exit(1);
+                        }
+                    }
+                    SlowLayerCapture::getInstance().enable(capture.substr(0, comma), threshold);
+                }
+                else if (argument.starts_with("--time-limit="))
+                {
+                    const std::string time_limit = argument.substr(std::string_view("--time-limit=").size());
+                    char* end;
+                    const double seconds = std::strtod(time_limit.c_str(), &end);
+                    if (time_limit.empty() || *end != '\0' || seconds <= 0)
+                    {
+                        spdlog::error("Invalid time limit: {}", time_limit);
+                        exit(1);
+                    }
+                    Application::getInstance().cancellation_.setTimeLimit(std::chrono::duration<double>(seconds));
+                }
 #ifdef __EMSCRIPTEN__
                 else if (argument.find("--progress") == 0)
                 {
@@ -259,7 +479,7 @@ void CommandLine::sliceNext()
                         exit(1);
                     }
                     argument = arguments_[argument_index];
-                    if (loadJSON(std::filesystem::path{ argument }, *last_settings, force_read_parent, force_read_nondefault) != 0)
+                    if (loadDefinition(std::filesystem::path{ argument }, *last_settings, force_read_parent, force_read_nondefault) != 0)
                     {
                         spdlog::error("Failed to load JSON file: {}", argument);
                         exit(1);
@@ -499,6 +719,7 @@ void CommandLine::sliceNext()
                             slice.scene.limit_to_extruder[key] = &slice.scene.extruders[extruder_nr];
                         }
                     }
+                    Settings::invalidateCaches(); // Settings looked up so far may have been resolved without the limiting.
 
                     break;
                 }
@@ -546,6 +767,78 @@ void CommandLine::sliceNext()
 
     // Finalize the processor. This adds the end g-code and reports statistics.
     FffProcessor::getInstance()->finalize();
+
+    if (job_queue_)
+    {
+        FffProcessor::getInstance()->closeTargetFile();
+        fmt::print("job {} {}\n", job_number_, Application::getInstance().cancellation_.isCancelled() ? "cancelled" : "done");
+        std::fflush(stdout);
+    }
+}
+
+int CommandLine::loadDefinition(const std::filesystem::path& json_filename, Settings& settings, bool force_read_parent, bool force_read_nondefault)
+{
+    // The forced reads are for debugging. With force_read_nondefault, what is read even depends on the settings that were there before.
+    if (! definition_cache_ || force_read_parent || force_read_nondefault)
+    {
+        return loadJSON(json_filename, settings, force_read_parent, force_read_nondefault);
+    }
+
+    Scene& scene = Application::getInstance().current_slice_->scene;
+    if (const std::optional<DefinitionCache::Snapshot> snapshot = definition_cache_->load(json_filename, search_directories_))
+    {
+        while (scene.extruders.size() < snapshot->extruder_count)
+        {
+            scene.extruders.emplace_back(scene.extruders.size(), &scene.settings);
+        }
+        for (const DefinitionCache::Setting& setting : snapshot->settings)
+        {
+            Settings& target = setting.extruder_nr < 0 ? settings : scene.extruders[setting.extruder_nr].settings_;
+            target.add(setting.key, setting.value);
+        }
+        search_directories_.insert(search_directories_.end(), snapshot->added_search_directories.begin(), snapshot->added_search_directories.end());
+        spdlog::debug("Loaded {} from the definition cache.", json_filename);
+        return 0;
+    }
+
+    DefinitionCache::Snapshot snapshot;
+    const std::vector<std::filesystem::path> search_directories = search_directories_;
+    recording_ = &snapshot;
+    recording_settings_ = &settings;
+    recording_complete_ = true;
+    const int error_code = loadJSON(json_filename, settings, force_read_parent, force_read_nondefault);
+    recording_ = nullptr;
+    recording_settings_ = nullptr;
+
+    if (error_code == 0 && recording_complete_)
+    {
+        snapshot.added_search_directories.assign(search_directories_.begin() + search_directories.size(), search_directories_.end());
+        snapshot.extruder_count = scene.extruders.size();
+        definition_cache_->store(json_filename, search_directories, snapshot);
+    }
+    return error_code;
+}
+
+void CommandLine::recordSetting(const Settings& settings, const std::string& key, const std::string& value)
+{
+    int64_t extruder_nr = -1;
+    if (&settings != recording_settings_)
+    {
+        const std::vector<ExtruderTrain>& extruders = Application::getInstance().current_slice_->scene.extruders;
+        const auto extruder = ranges::find_if(
+            extruders,
+            [&settings](const ExtruderTrain& extruder_train)
+            {
+                return &extruder_train.settings_ == &settings;
+            });
+        if (extruder == extruders.end())
+        {
+            recording_complete_ = false; // Can't tell where the setting should go when loading the snapshot.
+            return;
+        }
+        extruder_nr = std::distance(extruders.begin(), extruder);
+    }
+    recording_->settings.push_back(DefinitionCache::Setting{ .extruder_nr = extruder_nr, .key = key, .value = value });
 }
 
 int CommandLine::loadJSON(const std::filesystem::path& json_filename, Settings& settings, bool force_read_parent, bool force_read_nondefault)
@@ -556,6 +849,17 @@ int CommandLine::loadJSON(const std::filesystem::path& json_filename, Settings&
         spdlog::error("Couldn't open JSON file: {}", json_filename);
         return 1;
     }
+    if (recording_ != nullptr)
+    {
+        if (std::optional<DefinitionCache::File> described_file = DefinitionCache::describeFile(json_filename))
+        {
+            recording_->files.push_back(std::move(*described_file));
+        }
+        else
+        {
+            recording_complete_ = false;
+        }
+    }
 
     std::vector<char> read_buffer(std::istreambuf_iterator<char>(file), {});
     rapidjson::MemoryStream memory_stream(read_buffer.data(), read_buffer.size());
@@ -583,6 +887,11 @@ int CommandLine::loadJSON(
     if (document.HasMember("inherits") && document["inherits"].IsString())
     {
         std::string parent_file = findDefinitionFile(document["inherits"].GetString(), search_directories);
+        if (recording_ != nullptr)
+        {
+            recording_->lookups.push_back(
+                DefinitionCache::Lookup{ .definition_id = document["inherits"].GetString(), .search_directory_count = search_directories.size(), .file = parent_file });
+        }
         if (parent_file.empty())
         {
             spdlog::error("Inherited JSON file: {} not found.", document["inherits"].GetString());
@@ -623,6 +932,12 @@ int CommandLine::loadJSON(
                 }
                 const std::string extruder_definition_id(extruder_id.GetString());
                 const std::string extruder_file = findDefinitionFile(extruder_definition_id, search_directories);
+                if (recording_ != nullptr)
+                {
+                    recording_->lookups.push_back(
+                        DefinitionCache::Lookup{ .definition_id = extruder_definition_id, .search_directory_count = search_directories.size(), .file = extruder_file });
+                    recording_complete_ &= ! extruder_file.empty();
+                }
                 loadJSON(extruder_file, scene.extruders[extruder_nr].settings_, force_read_parent, force_read_nondefault);
             }
         }
@@ -731,6 +1046,10 @@ void CommandLine::loadJSONSettings(const rapidjson::Value& element, Settings& se
             continue;
         }
         settings.add(name, value_string);
+        if (recording_ != nullptr)
+        {
+            recordSetting(settings, name, value_string);
+        }
     }
 }
 
@@ -0,0 +1,328 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "communication/DefinitionCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <system_error>
+#include <type_traits>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "utils/format/filesystem_path.h"
+
+namespace cura
+{
+
+namespace
+{
+
+constexpr char snapshot_magic[8] = { 'C', 'U', 'R', 'A', 'D', 'E', 'F', 'S' };
+
+//! Writes the fields of a snapshot one after another, in the byte order of this machine.
+class SnapshotWriter
+{
+public:
+    template<typename T>
+    requires std::is_arithmetic_v<T>
+    void write(const T value)
+    {
+        data_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(const std::string& value)
+    {
+        write(static_cast<uint64_t>(value.size()));
+        data_.append(value);
+    }
+
+    void writeMagic(const uint32_t version)
+    {
+        data_.append(snapshot_magic, sizeof(snapshot_magic));
+        write(version);
+    }
+
+    [[nodiscard]] const std::string& data() const
+    {
+        return data_;
+    }
+
+private:
+    std::string data_;
+};
+
+//! Reads the fields written by the SnapshotWriter. Once anything is missing, everything reads as failed.
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(const std::string& data)
+        : data_(data)
+    {
+    }
+
+    template<typename T>
+    requires std::is_arithmetic_v<T>
+    bool read(T& value)
+    {
+        if (data_.size() - position_ < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value, data_.data() + position_, sizeof(T));
+        position_ += sizeof(T);
+        return true;
+    }
+
+    bool read(std::string& value)
+    {
+        uint64_t size;
+        if (! read(size) || data_.size() - position_ < size)
+        {
+            return false;
+        }
+        value.assign(data_.data() + position_, size);
+        position_ += size;
+        return true;
+    }
+
+    //! Read the size of a list, which can't be larger than the data that is left, since every element takes at least a byte.
+    bool readCount(size_t& count)
+    {
+        uint64_t value;
+        if (! read(value) || value > data_.size() - position_)
+        {
+            return false;
+        }
+        count = value;
+        return true;
+    }
+
+    bool readMagic(const uint32_t version)
+    {
+        uint32_t read_version;
+        if (data_.size() < sizeof(snapshot_magic) || std::memcmp(data_.data(), snapshot_magic, sizeof(snapshot_magic)) != 0)
+        {
+            return false;
+        }
+        position_ = sizeof(snapshot_magic);
+        return read(read_version) && read_version == version;
+    }
+
+    [[nodiscard]] bool atEnd() const
+    {
+        return position_ == data_.size();
+    }
+
+private:
+    const std::string& data_;
+    size_t position_ = 0;
+};
+
+} // namespace
+
+DefinitionCache::DefinitionCache(std::filesystem::path directory)
+    : directory_(std::move(directory))
+{
+}
+
+std::optional<DefinitionCache::Snapshot> DefinitionCache::load(const std::filesystem::path& json_filename, const std::vector<std::filesystem::path>& search_directories)
+{
+    const std::filesystem::path snapshot_path = snapshotPath(json_filename, search_directories);
+    if (const auto remembered = remembered_.find(snapshot_path.string()); remembered != remembered_.end())
+    {
+        if (isValid(remembered->second, search_directories))
+        {
+            return remembered->second;
+        }
+        remembered_.erase(remembered);
+    }
+    if (directory_.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::ifstream file(snapshot_path, std::ios::binary);
+    if (! file)
+    {
+        return std::nullopt;
+    }
+    const std::string data(std::istreambuf_iterator<char>(file), {});
+
+    SnapshotReader reader(data);
+    Snapshot snapshot;
+    size_t count;
+    bool complete = reader.readMagic(format_version);
+    complete = complete && reader.readCount(count);
+    for (size_t i = 0; complete && i < count; i++)
+    {
+        File& read_file = snapshot.files.emplace_back();
+        complete = reader.read(read_file.path) && reader.read(read_file.size) && reader.read(read_file.modified);
+    }
+    complete = complete && reader.readCount(count);
+    for (size_t i = 0; complete && i < count; i++)
+    {
+        Lookup& lookup = snapshot.lookups.emplace_back();
+        uint64_t search_directory_count;
+        complete = reader.read(lookup.definition_id) && reader.read(search_directory_count) && reader.read(lookup.file);
+        lookup.search_directory_count = search_directory_count;
+    }
+    complete = complete && reader.readCount(count);
+    for (size_t i = 0; complete && i < count; i++)
+    {
+        std::string directory;
+        complete = reader.read(directory);
+        snapshot.added_search_directories.emplace_back(directory);
+    }
+    uint64_t extruder_count;
+    complete = complete && reader.read(extruder_count);
+    snapshot.extruder_count = extruder_count;
+    complete = complete && reader.readCount(count);
+    if (complete)
+    {
+        snapshot.settings.reserve(count);
+    }
+    for (size_t i = 0; complete && i < count; i++)
+    {
+        Setting& setting = snapshot.settings.emplace_back();
+        complete = reader.read(setting.extruder_nr) && reader.read(setting.key) && reader.read(setting.value);
+    }
+
+    if (! complete || ! reader.atEnd())
+    {
+        spdlog::warn("Definition cache {} is damaged, loading {} from the JSON instead.", snapshot_path, json_filename);
+        return std::nullopt;
+    }
+    if (! isValid(snapshot, search_directories))
+    {
+        spdlog::debug("Definition cache {} is outdated.", snapshot_path);
+        return std::nullopt;
+    }
+    remembered_.emplace(snapshot_path.string(), snapshot);
+    return snapshot;
+}
+
+void DefinitionCache::store(const std::filesystem::path& json_filename, const std::vector<std::filesystem::path>& search_directories, const Snapshot& snapshot)
+{
+    const std::filesystem::path snapshot_path = snapshotPath(json_filename, search_directories);
+    remembered_.insert_or_assign(snapshot_path.string(), snapshot);
+    if (directory_.empty())
+    {
+        return;
+    }
+
+    SnapshotWriter writer;
+    writer.writeMagic(format_version);
+    writer.write(static_cast<uint64_t>(snapshot.files.size()));
+    for (const File& file : snapshot.files)
+    {
+        writer.write(file.path);
+        writer.write(file.size);
+        writer.write(file.modified);
+    }
+    writer.write(static_cast<uint64_t>(snapshot.lookups.size()));
+    for (const Lookup& lookup : snapshot.lookups)
+    {
+        writer.write(lookup.definition_id);
+        writer.write(static_cast<uint64_t>(lookup.search_directory_count));
+        writer.write(lookup.file);
+    }
+    writer.write(static_cast<uint64_t>(snapshot.added_search_directories.size()));
+    for (const std::filesystem::path& directory : snapshot.added_search_directories)
+    {
+        writer.write(directory.string());
+    }
+    writer.write(static_cast<uint64_t>(snapshot.extruder_count));
+    writer.write(static_cast<uint64_t>(snapshot.settings.size()));
+    for (const Setting& setting : snapshot.settings)
+    {
+        writer.write(setting.extruder_nr);
+        writer.write(setting.key);
+        writer.write(setting.value);
+    }
+
+    // Write to a temporary file first, so that other processes never read half a snapshot.
+    const std::filesystem::path temporary_path = std::filesystem::path(snapshot_path).concat(fmt::format(".{}.tmp", std::hash<std::string>{}(writer.data())));
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (! file || ! file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size())))
+        {
+            spdlog::debug("Couldn't write the definition cache {}.", temporary_path);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary_path, snapshot_path, error);
+    if (error)
+    {
+        spdlog::debug("Couldn't write the definition cache {}: {}", snapshot_path, error.message());
+        std::filesystem::remove(temporary_path, error);
+    }
+}
+
+std::optional<DefinitionCache::File> DefinitionCache::describeFile(const std::filesystem::path& path)
+{
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    const std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    return File{ .path = path.string(), .size = size, .modified = static_cast<int64_t>(modified.time_since_epoch().count()) };
+}
+
+std::filesystem::path DefinitionCache::snapshotPath(const std::filesystem::path& json_filename, const std::vector<std::filesystem::path>& search_directories) const
+{
+    std::error_code error;
+    std::string key = std::filesystem::absolute(json_filename, error).string();
+    for (const std::filesystem::path& search_directory : search_directories)
+    {
+        key += '\n';
+        key += std::filesystem::absolute(search_directory, error).string();
+    }
+    return directory_ / fmt::format("{}-{:016x}.defcache", json_filename.stem().string(), std::hash<std::string>{}(key));
+}
+
+bool DefinitionCache::isValid(const Snapshot& snapshot, const std::vector<std::filesystem::path>& search_directories)
+{
+    for (const File& file : snapshot.files)
+    {
+        const std::optional<File> current = describeFile(file.path);
+        if (! current || current->size != file.size || current->modified != file.modified)
+        {
+            return false;
+        }
+    }
+
+    // A definition might now be found elsewhere, if a file with the same ID was added to an earlier search directory.
+    std::vector<std::filesystem::path> all_search_directories = search_directories;
+    all_search_directories.insert(all_search_directories.end(), snapshot.added_search_directories.begin(), snapshot.added_search_directories.end());
+    for (const Lookup& lookup : snapshot.lookups)
+    {
+        std::string found;
+        for (size_t i = 0; i < std::min(lookup.search_directory_count, all_search_directories.size()); i++)
+        {
+            if (auto candidate = all_search_directories[i] / (lookup.definition_id + ".def.json"); std::filesystem::exists(candidate))
+            {
+                found = candidate.string();
+                break;
+            }
+        }
+        if (found != lookup.file)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace cura
@@ -6,14 +6,18 @@
 #include <Arcus/Error.h> //To process error codes.
 #include <spdlog/spdlog.h>
 
+#include "Application.h" //To cancel the slice when the front-end is gone.
 #include "communication/Listener.h"
 
 namespace cura
 {
 
-void Listener::stateChanged(Arcus::SocketState)
+void Listener::stateChanged(Arcus::SocketState state)
 {
-    // Do nothing.
+    if (state == Arcus::SocketState::Closed || state == Arcus::SocketState::Error)
+    { // Nobody is waiting for the result any more.
+        Application::getInstance().cancellation_.cancel();
+    }
 }
 
 void Listener::messageReceived()
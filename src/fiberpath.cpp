@@ -1,5 +1,18 @@
 #include "fiberpath.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <spdlog/spdlog.h>
+
+#include "utils/Point3D.h"
+#include "utils/Simplify.h"
+#include "utils/ThreadPool.h"
+
 namespace cura
 {
 FiberPath::FiberPath()
@@ -9,8 +22,424 @@ FiberPath::FiberPath(coord_t z)
     : z_(z)
 {
 }
+Shape FiberPath::path2shape()
+{
+    Shape result;
+    for (const OpenPolyline& polyline : paths)
+    {
+        result.emplace_back(polyline.getPoints(), true);
+    }
+    return result;
+}
+
+void FiberPath::translate(Point3LL offset)
+{
+    for (OpenPolyline& polyline : paths)
+    {
+        polyline.translate(Point2LL(offset.x_, offset.y_));
+    }
+    z_ += offset.z_;
+}
+
+void FiberPath::transform(const Matrix4x3D& transformation)
+{
+    const double z = INT2MM(z_);
+    for (OpenPolyline& polyline : paths)
+    {
+        transformation.applyXY(polyline.getPoints(), z);
+    }
+    z_ = transformation.apply(Point3D(0.0, 0.0, z)).z_;
+}
+
+FiberPathGrid::FiberPathGrid(const OpenLinesSet& polylines, const coord_t cell_size)
+    : polylines_(polylines)
+    , grid_(cell_size, polylines.pointCount())
+{
+    for (size_t polyline_idx = 0; polyline_idx < polylines.size(); polyline_idx++)
+    {
+        for (size_t point_idx = 0; point_idx + 1 < polylines[polyline_idx].size(); point_idx++)
+        {
+            grid_.insert(SegmentIndex(&polylines, polyline_idx, point_idx));
+        }
+    }
+}
+
+OpenLinesSet FiberPathGrid::getPolylinesNear(const AABB& box) const
+{
+    std::vector<std::pair<size_t, size_t>> segments; // Polyline index and point index of each segment near the box.
+    const Point2LL middle = box.getMiddle();
+    const coord_t radius = std::max(box.max_.X - box.min_.X, box.max_.Y - box.min_.Y) / 2 + 1;
+    grid_.processNearby(
+        middle,
+        radius,
+        [this, &box, &segments](const SegmentIndex& segment)
+        {
+            const std::pair<Point2LL, Point2LL> line = SegmentLocator()(segment);
+            const AABB segment_box(
+                Point2LL(std::min(line.first.X, line.second.X), std::min(line.first.Y, line.second.Y)),
+                Point2LL(std::max(line.first.X, line.second.X), std::max(line.first.Y, line.second.Y)));
+            if (segment_box.hit(box))
+            {
+                segments.emplace_back(segment.poly_idx_, segment.point_idx_);
+            }
+            return true;
+        });
+    // Segments crossing multiple cells are found multiple times.
+    std::sort(segments.begin(), segments.end());
+    segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+
+    OpenLinesSet result;
+    for (size_t run_start = 0; run_start < segments.size();)
+    {
+        size_t run_end = run_start + 1;
+        while (run_end < segments.size() && segments[run_end].first == segments[run_start].first && segments[run_end].second == segments[run_end - 1].second + 1)
+        {
+            run_end++;
+        }
+        const OpenPolyline& polyline = polylines_[segments[run_start].first];
+        const auto first_point = polyline.begin() + segments[run_start].second;
+        const auto last_point = polyline.begin() + segments[run_end - 1].second + 2; // One past the end point of the last segment.
+        result.emplace_back(ClipperLib::Path(first_point, last_point));
+        run_start = run_end;
+    }
+    return result;
+}
+
 FiberPaths::FiberPaths()
 {
     sorted = false;
 }
+
+void FiberPaths::transform(const Matrix4x3D& transformation)
+{
+    for (FiberPath& path : paths)
+    {
+        if (path.loaded_)
+        {
+            path.transform(transformation);
+        }
+        else
+        {
+            path.z_ = transformation.apply(Point3D(0.0, 0.0, INT2MM(path.z_))).z_;
+        }
+    }
+    source_transformation = transformation.compose(source_transformation);
+    sorted = false;
+}
+
+void FiberPaths::sort()
+{
+    if (sorted)
+    {
+        return;
+    }
+    std::stable_sort(
+        paths.begin(),
+        paths.end(),
+        [](const FiberPath& a, const FiberPath& b)
+        {
+            return a.z_ < b.z_;
+        });
+    z_index.clear();
+    z_index.reserve(paths.size());
+    for (const FiberPath& path : paths)
+    {
+        z_index.push_back(path.z_);
+    }
+    sorted = true;
+}
+
+FiberPath* FiberPaths::getFiberPath(const coord_t z, const coord_t tolerance)
+{
+    sort();
+    if (z_index.empty())
+    {
+        return nullptr;
+    }
+    const auto upper = std::lower_bound(z_index.begin(), z_index.end(), z);
+    auto closest = upper;
+    if (upper == z_index.end() || (upper != z_index.begin() && z - *(upper - 1) < *upper - z))
+    {
+        closest = upper - 1;
+    }
+    if (std::abs(*closest - z) > tolerance)
+    {
+        return nullptr;
+    }
+    return &paths[closest - z_index.begin()];
+}
+
+std::pair<size_t, size_t> FiberPaths::getFiberPathRange(const coord_t z, const coord_t tolerance)
+{
+    sort();
+    const auto first = std::upper_bound(z_index.begin(), z_index.end(), z - tolerance);
+    const auto last = std::lower_bound(first, z_index.end(), z + tolerance);
+    return { first - z_index.begin(), last - z_index.begin() };
+}
+
+const OpenLinesSet& FiberPaths::getPolylines(const size_t path_idx, OpenLinesSet& decoded) const
+{
+    const FiberPath& path = paths[path_idx];
+    if (path.loaded_ || ! source)
+    {
+        return path.paths;
+    }
+    decoded = source->decodeLayer(path.source_layer_idx_);
+    if (! (source_transformation == Matrix4x3D()))
+    {
+        const double z = INT2MM(source->layer(path.source_layer_idx_).z);
+        for (OpenPolyline& polyline : decoded)
+        {
+            source_transformation.applyXY(polyline.getPoints(), z);
+        }
+    }
+    if (simplify_resolution > 0)
+    {
+        decoded = Simplify(simplify_resolution, simplify_deviation, simplify_area_deviation).polyline(decoded);
+    }
+    return decoded;
+}
+
+void FiberPaths::simplify(const coord_t max_resolution, const coord_t max_deviation, const coord_t max_area_deviation)
+{
+    simplify_resolution = max_resolution;
+    simplify_deviation = max_deviation;
+    simplify_area_deviation = max_area_deviation;
+    if (max_resolution <= 0)
+    {
+        return;
+    }
+    const Simplify simplifier(max_resolution, max_deviation, max_area_deviation);
+    cura::parallel_for<size_t>(
+        0,
+        paths.size(),
+        [this, &simplifier](const size_t path_idx)
+        {
+            FiberPath& path = paths[path_idx];
+            if (path.loaded_)
+            {
+                path.paths = simplifier.polyline(path.paths);
+            }
+        });
+}
+
+AABB FiberPaths::getBoundingBox(const size_t path_idx) const
+{
+    const FiberPath& path = paths[path_idx];
+    if (! path.loaded_ && source)
+    {
+        const FiberPathBinaryFile::LayerEntry& entry = source->layer(path.source_layer_idx_);
+        if (source_transformation == Matrix4x3D())
+        {
+            return AABB(Point2LL(entry.min_x, entry.min_y), Point2LL(entry.max_x, entry.max_y));
+        }
+        // The transformation is affine, so the transformed corners of the box contain all transformed points.
+        AABB box;
+        const double z = INT2MM(entry.z);
+        for (const coord_t x : { entry.min_x, entry.max_x })
+        {
+            for (const coord_t y : { entry.min_y, entry.max_y })
+            {
+                const Point3LL corner = source_transformation.apply(Point3D(INT2MM(x), INT2MM(y), z));
+                box.include(Point2LL(corner.x_, corner.y_));
+            }
+        }
+        return box;
+    }
+    AABB box;
+    for (const OpenPolyline& polyline : path.paths)
+    {
+        for (const Point2LL& point : polyline)
+        {
+            box.include(point);
+        }
+    }
+    return box;
+}
+
+struct FiberPathBinaryFile::Mapping
+{
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+};
+
+FiberPathBinaryFile::~FiberPathBinaryFile() = default;
+
+std::shared_ptr<FiberPathBinaryFile> FiberPathBinaryFile::open(const std::string& filename)
+{
+    std::shared_ptr<FiberPathBinaryFile> file(new FiberPathBinaryFile());
+    try
+    {
+        file->mapping_ = std::make_unique<Mapping>();
+        file->mapping_->file = boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only);
+        file->mapping_->region = boost::interprocess::mapped_region(file->mapping_->file, boost::interprocess::read_only);
+    }
+    catch (const boost::interprocess::interprocess_exception& exception)
+    {
+        spdlog::error("Failed to map FiberPath file {}: {}", filename, exception.what());
+        return nullptr;
+    }
+    file->data_ = static_cast<const char*>(file->mapping_->region.get_address());
+    file->size_ = file->mapping_->region.get_size();
+
+    Header header;
+    if (file->size_ < sizeof(Header))
+    {
+        spdlog::error("FiberPath file {} is too small to be a binary fiber path file.", filename);
+        return nullptr;
+    }
+    std::memcpy(&header, file->data_, sizeof(Header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+    {
+        spdlog::error("FiberPath file {} is not a binary fiber path file.", filename);
+        return nullptr;
+    }
+    if (header.version != version)
+    {
+        spdlog::error("FiberPath file {} has version {}, but only version {} is supported.", filename, header.version, version);
+        return nullptr;
+    }
+    if (header.layer_count > (file->size_ - sizeof(Header)) / sizeof(LayerEntry))
+    {
+        spdlog::error("FiberPath file {} is truncated: its layer table is incomplete.", filename);
+        return nullptr;
+    }
+
+    file->layers_.resize(header.layer_count);
+    std::memcpy(file->layers_.data(), file->data_ + sizeof(Header), header.layer_count * sizeof(LayerEntry));
+    for (const LayerEntry& entry : file->layers_)
+    {
+        // Check each bound separately to not overflow on corrupt counts.
+        const uint64_t max_count = file->size_ / sizeof(int64_t);
+        if (entry.offset > file->size_ || entry.polyline_count > max_count || entry.point_count > max_count
+            || (entry.polyline_count + entry.point_count * 2) * sizeof(int64_t) > file->size_ - entry.offset)
+        {
+            spdlog::error("FiberPath file {} is truncated: the data of the layer at z={} is incomplete.", filename, entry.z);
+            return nullptr;
+        }
+    }
+    return file;
+}
+
+bool FiberPathBinaryFile::write(FiberPaths& fiberpaths, const std::string& filename)
+{
+    fiberpaths.sort();
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (! out)
+    {
+        spdlog::error("Failed to open {} for writing.", filename);
+        return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.layer_count = fiberpaths.paths.size();
+
+    std::vector<LayerEntry> layers;
+    layers.reserve(fiberpaths.paths.size());
+    uint64_t offset = sizeof(Header) + fiberpaths.paths.size() * sizeof(LayerEntry);
+    for (size_t path_idx = 0; path_idx < fiberpaths.paths.size(); path_idx++)
+    {
+        OpenLinesSet decoded;
+        const OpenLinesSet& polylines = fiberpaths.getPolylines(path_idx, decoded);
+        const AABB box = fiberpaths.getBoundingBox(path_idx);
+        LayerEntry& entry = layers.emplace_back();
+        entry.z = fiberpaths.paths[path_idx].z_;
+        entry.min_x = box.min_.X;
+        entry.min_y = box.min_.Y;
+        entry.max_x = box.max_.X;
+        entry.max_y = box.max_.Y;
+        entry.offset = offset;
+        entry.polyline_count = polylines.size();
+        entry.point_count = polylines.pointCount();
+        offset += (entry.polyline_count + entry.point_count * 2) * sizeof(int64_t);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    out.write(reinterpret_cast<const char*>(layers.data()), layers.size() * sizeof(LayerEntry));
+
+    std::vector<int64_t> layer_data;
+    for (size_t path_idx = 0; path_idx < fiberpaths.paths.size(); path_idx++)
+    {
+        OpenLinesSet decoded;
+        const OpenLinesSet& polylines = fiberpaths.getPolylines(path_idx, decoded);
+        layer_data.clear();
+        for (const OpenPolyline& polyline : polylines)
+        {
+            layer_data.push_back(static_cast<int64_t>(polyline.size()));
+        }
+        for (const OpenPolyline& polyline : polylines)
+        {
+            for (const Point2LL& point : polyline)
+            {
+                layer_data.push_back(point.X);
+                layer_data.push_back(point.Y);
+            }
+        }
+        out.write(reinterpret_cast<const char*>(layer_data.data()), layer_data.size() * sizeof(int64_t));
+    }
+    out.close();
+    if (! out)
+    {
+        spdlog::error("Failed to write {}.", filename);
+        return false;
+    }
+    return true;
+}
+
+size_t FiberPathBinaryFile::layerCount() const
+{
+    return layers_.size();
+}
+
+const FiberPathBinaryFile::LayerEntry& FiberPathBinaryFile::layer(const size_t layer_idx) const
+{
+    return layers_[layer_idx];
+}
+
+OpenLinesSet FiberPathBinaryFile::decodeLayer(const size_t layer_idx) const
+{
+    const LayerEntry& entry = layers_[layer_idx];
+    const char* polyline_sizes = data_ + entry.offset;
+    const char* points = polyline_sizes + entry.polyline_count * sizeof(int64_t);
+    const char* points_end = points + entry.point_count * 2 * sizeof(int64_t);
+
+    OpenLinesSet result;
+    result.reserve(entry.polyline_count);
+    for (uint64_t polyline_idx = 0; polyline_idx < entry.polyline_count; polyline_idx++)
+    {
+        int64_t polyline_size;
+        std::memcpy(&polyline_size, polyline_sizes + polyline_idx * sizeof(int64_t), sizeof(int64_t));
+        if (polyline_size < 0 || static_cast<uint64_t>(polyline_size) > static_cast<uint64_t>(points_end - points) / (2 * sizeof(int64_t)))
+        {
+            spdlog::warn("Corrupt polyline in the fiber layer at z={}, skipping the rest of the layer.", entry.z);
+            break;
+        }
+        ClipperLib::Path path(polyline_size);
+        for (ClipperLib::IntPoint& point : path)
+        {
+            int64_t coordinates[2];
+            std::memcpy(coordinates, points, sizeof(coordinates));
+            point.X = coordinates[0];
+            point.Y = coordinates[1];
+            points += sizeof(coordinates);
+        }
+        result.emplace_back(std::move(path));
+    }
+    return result;
+}
+
+void FiberPathBinaryFile::addTo(const std::shared_ptr<FiberPathBinaryFile>& file, FiberPaths& fiberpaths)
+{
+    fiberpaths.paths.reserve(fiberpaths.paths.size() + file->layerCount());
+    for (size_t layer_idx = 0; layer_idx < file->layerCount(); layer_idx++)
+    {
+        FiberPath& path = fiberpaths.paths.emplace_back(file->layer(layer_idx).z);
+        path.loaded_ = false;
+        path.source_layer_idx_ = layer_idx;
+    }
+    fiberpaths.source = file;
+    fiberpaths.sorted = false;
+}
+
 } // namespace cura
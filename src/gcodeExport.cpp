@@ -3,14 +3,19 @@
 
 #include "gcodeExport.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <initializer_list>
 #include <iomanip>
 #include <numbers>
+#include <numeric>
 
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
 
 #include "Application.h" //To send layer view data.
+#include "BinaryGCodeWriter.h"
 #include "ExtruderTrain.h"
 #include "PrintFeature.h"
 #include "RetractionConfig.h"
@@ -25,16 +30,39 @@
 namespace cura
 {
 
-std::string transliterate(const std::string& text)
+/*!
+ * Find where an optional setting is given: in the current mesh group, or else
+ * on the command line.
+ * \param key The setting to look for.
+ * \return The settings that contain it, or nullptr if it isn't given.
+ */
+static const Settings* findOptionalSetting(const std::string& key)
 {
-    // For now, just replace all non-ascii characters with '?'.
-    // This function can be expanded if we need more complex transliteration.
-    std::ostringstream stream;
-    for (const char& c : text)
+    const Scene& scene = Application::getInstance().current_slice_->scene;
+    for (const Settings* settings : std::initializer_list<const Settings*>{ &scene.current_mesh_group->settings, &scene.settings })
     {
-        stream << ((c >= 0) ? c : '?');
+        if (settings->has(key))
+        {
+            return settings;
+        }
     }
-    return stream.str();
+    return nullptr;
+}
+
+std::string transliterate(const std::string_view text)
+{
+    // For now, just replace all non-ascii characters with '?'.
+    // This function can be expanded if we need more complex transliteration.
+    std::string result(text);
+    std::replace_if(
+        result.begin(),
+        result.end(),
+        [](const char c)
+        {
+            return c < 0;
+        },
+        '?');
+    return result;
 }
 
 GCodeExport::GCodeExport()
@@ -108,6 +136,8 @@ void GCodeExport::preSetup(const size_t start_extruder)
             extruder_attr_[extruder_nr].nozzle_offset_ = Point2LL(0, 0);
         }
         extruder_attr_[extruder_nr].machine_firmware_retract_ = extruder_settings.get<bool>("machine_firmware_retract");
+        extruder_attr_[extruder_nr].switch_settings_.reset();
+        extruder_attr_[extruder_nr].z_hop_speed_.reset();
     }
 
     machine_name_ = mesh_group->settings.get<std::string>("machine_name");
@@ -124,10 +154,33 @@ void GCodeExport::preSetup(const size_t start_extruder)
         new_line_ = "\n";
     }
 
-    estimate_calculator_.setFirmwareDefaults(mesh_group->settings);
+    time_estimates_.setFirmwareDefaults(mesh_group->settings);
+    if (const Settings* lookahead_settings = findOptionalSetting("machine_planner_buffer_size"))
+    {
+        time_estimates_.setLookahead(lookahead_settings->get<size_t>("machine_planner_buffer_size"));
+    }
 
     if (mesh_group == scene.mesh_groups.begin())
     {
+        const Settings* binary_settings = findOptionalSetting("machine_gcode_binary");
+        if (binary_settings && binary_settings->get<bool>("machine_gcode_binary") && ! binary_writer_)
+        {
+            startBinaryOutput();
+        }
+
+        const Settings* arc_settings = findOptionalSetting("machine_arc_fitting_tolerance");
+        const bool supports_arcs = flavor_ != EGCodeFlavor::BFB && flavor_ != EGCodeFlavor::MAKERBOT;
+        arc_fitting_tolerance_ = (arc_settings && supports_arcs) ? arc_settings->get<coord_t>("machine_arc_fitting_tolerance") : 0;
+
+        const Settings* comment_settings = findOptionalSetting("machine_gcode_minimal_comments");
+        minimal_comments_ = comment_settings && comment_settings->get<bool>("machine_gcode_minimal_comments");
+
+        const Settings* background_settings = findOptionalSetting("time_estimate_background_thread");
+        if (background_settings && background_settings->get<bool>("time_estimate_background_thread"))
+        {
+            time_estimates_.startThread();
+        }
+
         if (! scene.current_mesh_group->settings.get<bool>("material_bed_temp_prepend"))
         {
             // Current bed temperature is the one of the first layer (has already been set in header)
@@ -514,6 +567,7 @@ double GCodeExport::getTotalFilamentUsed(size_t extruder_nr)
 
 std::vector<Duration> GCodeExport::getTotalPrintTimePerFeature()
 {
+    writeEstimatedLayers(true);
     return total_print_times_;
 }
 
@@ -529,6 +583,7 @@ double GCodeExport::getSumTotalPrintTimes()
 
 void GCodeExport::resetTotalPrintTimeAndFilament()
 {
+    writeEstimatedLayers(true);
     for (size_t i = 0; i < total_print_times_.size(); i++)
     {
         total_print_times_[i] = 0.0;
@@ -540,22 +595,83 @@ void GCodeExport::resetTotalPrintTimeAndFilament()
         extruder_attr_[e].waited_for_temperature_ = false;
     }
     current_e_value_ = 0.0;
-    estimate_calculator_.reset();
+    time_estimates_.reset();
 }
 
 void GCodeExport::updateTotalPrintTime()
 {
-    std::vector<Duration> estimates = estimate_calculator_.calculate();
-    for (size_t i = 0; i < estimates.size(); i++)
+    time_estimates_.endLayer();
+    if (! time_estimates_.isThreaded())
+    {
+        const std::vector<Duration> estimates = *time_estimates_.takeEstimate(true);
+        for (size_t i = 0; i < estimates.size(); i++)
+        {
+            total_print_times_[i] += estimates[i];
+        }
+        writeTimeComment(getSumTotalPrintTimes());
+        return;
+    }
+
+    // The time comment can only be written once the estimate is done, so hold on to the g-code of this layer until then.
+    if (unestimated_layers_.empty())
+    {
+        // Everything up to here has been written to the target directly.
+        estimated_target_ = output_stream_;
+        unestimated_output_.str("");
+        unestimated_output_.copyfmt(*estimated_target_);
+        output_stream_ = &unestimated_output_;
+    }
+    unestimated_layers_.push_back(unestimated_output_.str());
+    unestimated_output_.str("");
+    writeEstimatedLayers(false);
+}
+
+void GCodeExport::writeEstimatedLayers(const bool wait)
+{
+    while (! unestimated_layers_.empty())
+    {
+        const std::optional<std::vector<Duration>> estimates = time_estimates_.takeEstimate(wait || unestimated_layers_.size() > max_unestimated_layers);
+        if (! estimates)
+        {
+            return;
+        }
+        for (size_t i = 0; i < estimates->size(); i++)
+        {
+            total_print_times_[i] += (*estimates)[i];
+        }
+        *estimated_target_ << unestimated_layers_.front();
+        unestimated_layers_.pop_front();
+
+        output_stream_ = estimated_target_;
+        writeTimeComment(std::accumulate(total_print_times_.begin(), total_print_times_.end(), Duration(0.0)));
+        output_stream_ = &unestimated_output_;
+    }
+    if (estimated_target_)
     {
-        total_print_times_[i] += estimates[i];
+        // Nothing waits any more, so the g-code can go to the target directly again.
+        *estimated_target_ << unestimated_output_.str();
+        unestimated_output_.str("");
+        output_stream_ = estimated_target_;
+        estimated_target_ = nullptr;
     }
-    estimate_calculator_.reset();
-    writeTimeComment(getSumTotalPrintTimes());
 }
 
-void GCodeExport::writeComment(const std::string& unsanitized_comment)
+void GCodeExport::writeComment(const std::string_view unsanitized_comment)
 {
+    const bool is_plain = std::all_of(
+        unsanitized_comment.begin(),
+        unsanitized_comment.end(),
+        [](const char c)
+        {
+            return c >= 0 && c != '\n';
+        });
+    if (is_plain)
+    {
+        // Most comments are a single line of ASCII, which needs no transliteration.
+        *output_stream_ << ';' << unsanitized_comment << new_line_;
+        return;
+    }
+
     const std::string comment = transliterate(unsanitized_comment);
 
     *output_stream_ << ";";
@@ -573,49 +689,61 @@ void GCodeExport::writeComment(const std::string& unsanitized_comment)
     *output_stream_ << new_line_;
 }
 
+void GCodeExport::writeDetailComment(const std::string_view comment)
+{
+    if (! minimal_comments_)
+    {
+        writeComment(comment);
+    }
+}
+
 void GCodeExport::writeTimeComment(const Duration time)
 {
     *output_stream_ << ";TIME_ELAPSED:" << time << new_line_;
 }
 
-void GCodeExport::writeTypeComment(const PrintFeatureType& type)
+std::string_view GCodeExport::typeComment(const PrintFeatureType type)
 {
     switch (type)
     {
     case PrintFeatureType::OuterWall:
-        *output_stream_ << ";TYPE:WALL-OUTER" << new_line_;
-        break;
+        return ";TYPE:WALL-OUTER";
     case PrintFeatureType::InnerWall:
-        *output_stream_ << ";TYPE:WALL-INNER" << new_line_;
-        break;
+        return ";TYPE:WALL-INNER";
     case PrintFeatureType::Skin:
-        *output_stream_ << ";TYPE:SKIN" << new_line_;
-        break;
+        return ";TYPE:SKIN";
     case PrintFeatureType::Support:
-        *output_stream_ << ";TYPE:SUPPORT" << new_line_;
-        break;
+        return ";TYPE:SUPPORT";
     case PrintFeatureType::SkirtBrim:
-        *output_stream_ << ";TYPE:SKIRT" << new_line_;
-        break;
+        return ";TYPE:SKIRT";
     case PrintFeatureType::Infill:
-        *output_stream_ << ";TYPE:FILL" << new_line_;
-        break;
+        return ";TYPE:FILL";
     case PrintFeatureType::SupportInfill:
-        *output_stream_ << ";TYPE:SUPPORT" << new_line_;
-        break;
+        return ";TYPE:SUPPORT";
     case PrintFeatureType::SupportInterface:
-        *output_stream_ << ";TYPE:SUPPORT-INTERFACE" << new_line_;
-        break;
+        return ";TYPE:SUPPORT-INTERFACE";
     case PrintFeatureType::PrimeTower:
-        *output_stream_ << ";TYPE:PRIME-TOWER" << new_line_;
-        break;
+        return ";TYPE:PRIME-TOWER";
+    case PrintFeatureType::Fiber:
+        return ";TYPE:FIBER";
     case PrintFeatureType::MoveCombing:
     case PrintFeatureType::MoveRetraction:
     case PrintFeatureType::NoneType:
     case PrintFeatureType::NumPrintFeatureTypes:
-        // do nothing
         break;
     }
+    return "";
+}
+
+void GCodeExport::writeTypeComment(const PrintFeatureType& type)
+{
+    const std::string_view comment = typeComment(type);
+    if (comment.empty() || minimal_comments_)
+    {
+        return;
+    }
+    output_stream_->write(comment.data(), static_cast<std::streamsize>(comment.size()));
+    *output_stream_ << new_line_;
 }
 
 
@@ -715,7 +843,7 @@ bool GCodeExport::initializeExtruderTrains(const SliceDataStorage& storage, cons
 
     if (getFlavor() == EGCodeFlavor::BFB)
     {
-        writeComment("enable auto-retraction");
+        writeDetailComment("enable auto-retraction");
         std::ostringstream tmp;
         tmp << "M227 S" << (mesh_group_settings.get<coord_t>("retraction_amount") * 2560 / 1000) << " P" << (mesh_group_settings.get<coord_t>("retraction_amount") * 2560 / 1000);
         writeLine(tmp.str().c_str());
@@ -858,7 +986,7 @@ bool GCodeExport::needPrimeBlob() const
 void GCodeExport::writeDelay(const Duration& time_amount)
 {
     *output_stream_ << "G4 P" << int(time_amount * 1000) << new_line_;
-    estimate_calculator_.addTime(time_amount);
+    time_estimates_.addTime(time_amount);
 }
 
 void GCodeExport::writeTravel(const Point2LL& p, const Velocity& speed)
@@ -952,7 +1080,7 @@ void GCodeExport::writeMoveBFB(const int x, const int y, const int z, const Velo
     *output_stream_ << " F" << PrecisionedDouble{ 1, fspeed } << new_line_;
 
     current_position_ = Point3LL(x, y, z);
-    estimate_calculator_.plan(
+    time_estimates_.plan(
         TimeEstimateCalculator::Position(INT2MM(current_position_.x_), INT2MM(current_position_.y_), INT2MM(current_position_.z_), eToMm(current_e_value_)),
         speed,
         feature);
@@ -973,12 +1101,14 @@ void GCodeExport::writeTravel(const coord_t x, const coord_t y, const coord_t z,
 #endif // ASSERT_INSANE_OUTPUT
 
     const PrintFeatureType travel_move_type = extruder_attr_[current_extruder_].retraction_e_amount_current_ ? PrintFeatureType::MoveRetraction : PrintFeatureType::MoveCombing;
-    const int display_width = extruder_attr_[current_extruder_].retraction_e_amount_current_ ? MM2INT(0.2) : MM2INT(0.1);
-    const double layer_height = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<double>("layer_height");
-    Application::getInstance().communication_->sendLineTo(travel_move_type, Point2LL(x, y), display_width, layer_height, speed);
+    if (Application::getInstance().communication_->wantsLayerView())
+    {
+        const int display_width = extruder_attr_[current_extruder_].retraction_e_amount_current_ ? MM2INT(0.2) : MM2INT(0.1);
+        const double layer_height = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<double>("layer_height");
+        Application::getInstance().communication_->sendLineTo(travel_move_type, Point2LL(x, y), display_width, layer_height, speed);
+    }
 
-    *output_stream_ << "G0";
-    writeFXYZE(speed, x, y, z, current_e_value_, travel_move_type);
+    writeFXYZE("G0", speed, x, y, z, current_e_value_, travel_move_type);
 }
 
 void GCodeExport::writeExtrusion(
@@ -1023,8 +1153,6 @@ void GCodeExport::writeExtrusion(
     }
 #endif
 
-    const double extrusion_per_mm = mm3ToE(extrusion_mm3_per_mm);
-
     if (is_z_hopped_ > 0)
     {
         writeZhopEnd();
@@ -1033,11 +1161,25 @@ void GCodeExport::writeExtrusion(
     const Point3LL diff = Point3LL(x, y, z) - current_position_;
     const double diff_length = diff.vSizeMM();
 
+    const double new_e_value = startExtrusion(diff_length, speed, extrusion_mm3_per_mm, update_extrusion_offset);
+
+    writeFXYZE("G1", speed, x, y, z, new_e_value, feature);
+}
+
+coord_t GCodeExport::getArcFittingTolerance() const
+{
+    return arc_fitting_tolerance_;
+}
+
+double GCodeExport::startExtrusion(const double length, const Velocity& speed, const double extrusion_mm3_per_mm, const bool update_extrusion_offset)
+{
+    const double extrusion_per_mm = mm3ToE(extrusion_mm3_per_mm);
+
     writeUnretractionAndPrime();
 
     // flow rate compensation
     double extrusion_offset = 0;
-    if (diff_length)
+    if (length)
     {
         extrusion_offset = speed * extrusion_mm3_per_mm * extrusion_offset_factor_;
         if (extrusion_offset > max_extrusion_offset_)
@@ -1052,39 +1194,179 @@ void GCodeExport::writeExtrusion(
         *output_stream_ << ";FLOW_RATE_COMPENSATED_OFFSET = " << current_e_offset_ << new_line_;
     }
 
-    extruder_attr_[current_extruder_].last_e_value_after_wipe_ += extrusion_per_mm * diff_length;
-    const double new_e_value = current_e_value_ + extrusion_per_mm * diff_length;
+    extruder_attr_[current_extruder_].last_e_value_after_wipe_ += extrusion_per_mm * length;
+    return current_e_value_ + extrusion_per_mm * length;
+}
+
+void GCodeExport::writeArcExtrusion(
+    const Point2LL& p,
+    const Point2LL& center,
+    const bool counter_clockwise,
+    const Velocity& speed,
+    const double extrusion_mm3_per_mm,
+    const PrintFeatureType& feature,
+    const bool update_extrusion_offset)
+{
+    if (is_z_hopped_ > 0)
+    {
+        writeZhopEnd();
+    }
+
+    const Point2LL start_offset = Point2LL(current_position_.x_, current_position_.y_) - center;
+    const Point2LL end_offset = p - center;
+    double sweep = std::atan2(static_cast<double>(cross(start_offset, end_offset)), static_cast<double>(dot(start_offset, end_offset)));
+    if (counter_clockwise && sweep <= 0)
+    {
+        sweep += 2 * std::numbers::pi;
+    }
+    else if (! counter_clockwise && sweep >= 0)
+    {
+        sweep -= 2 * std::numbers::pi;
+    }
+    const double radius = vSizeMM(start_offset);
+    const double length = std::hypot(std::abs(sweep) * radius, INT2MM(current_layer_z_ - current_position_.z_));
+
+    const double new_e_value = startExtrusion(length, speed, extrusion_mm3_per_mm, update_extrusion_offset);
+
+    // The line is put together in a buffer and written to the stream at once, like in writeFXYZE.
+    constexpr size_t line_size = 1024;
+    char line[line_size];
+    char* const line_limit = line + line_size;
+    char* end = line;
+    *end++ = 'G';
+    *end++ = counter_clockwise ? '3' : '2';
+    if (current_speed_ != speed)
+    {
+        *end++ = ' ';
+        *end++ = 'F';
+        end = writeDoubleToBuffer(1, speed * 60, end, line_limit);
+        current_speed_ = speed;
+    }
+    const Point2LL gcode_pos = getGcodePos(p.X, p.Y, current_extruder_);
+    *end++ = ' ';
+    *end++ = 'X';
+    end = writeInt2mm(gcode_pos.X, end);
+    *end++ = ' ';
+    *end++ = 'Y';
+    end = writeInt2mm(gcode_pos.Y, end);
+    if (current_layer_z_ != current_position_.z_)
+    {
+        *end++ = ' ';
+        *end++ = 'Z';
+        end = writeInt2mm(current_layer_z_, end);
+    }
+    // The centre is relative to the start, so it isn't affected by the nozzle offset.
+    *end++ = ' ';
+    *end++ = 'I';
+    end = writeInt2mm(-start_offset.X, end);
+    *end++ = ' ';
+    *end++ = 'J';
+    end = writeInt2mm(-start_offset.Y, end);
+    if (new_e_value + current_e_offset_ != current_e_value_)
+    {
+        const double output_e = (relative_extrusion_) ? new_e_value + current_e_offset_ - current_e_value_ : new_e_value + current_e_offset_;
+        *end++ = ' ';
+        *end++ = extruder_attr_[current_extruder_].extruder_character_;
+        end = writeDoubleToBuffer(5, output_e, end, line_limit - new_line_.size());
+    }
+    end = std::copy(new_line_.begin(), new_line_.end(), end);
+    output_stream_->write(line, end - line);
+
+    // The arc may bulge out beyond its ends, where it crosses the axes through its centre.
+    const Point2LL gcode_center = getGcodePos(center.X, center.Y, current_extruder_);
+    const coord_t radius_int = vSize(start_offset);
+    const double start_angle = std::atan2(static_cast<double>(start_offset.Y), static_cast<double>(start_offset.X));
+    total_bounding_box_.include(Point3LL(gcode_pos.X, gcode_pos.Y, current_layer_z_));
+    for (int quadrant = 0; quadrant < 4; quadrant++)
+    {
+        const double axis_angle = quadrant * std::numbers::pi / 2;
+        double angle_from_start = std::fmod(axis_angle - start_angle, 2 * std::numbers::pi);
+        if (counter_clockwise ? angle_from_start < 0 : angle_from_start > 0)
+        {
+            angle_from_start += counter_clockwise ? 2 * std::numbers::pi : -2 * std::numbers::pi;
+        }
+        if (std::abs(angle_from_start) < std::abs(sweep))
+        {
+            const Point2LL axis_direction = (quadrant == 0) ? Point2LL(1, 0) : (quadrant == 1) ? Point2LL(0, 1) : (quadrant == 2) ? Point2LL(-1, 0) : Point2LL(0, -1);
+            const Point2LL extreme = gcode_center + axis_direction * radius_int;
+            total_bounding_box_.include(Point3LL(extreme.X, extreme.Y, current_layer_z_));
+        }
+    }
+
+    // Firmware splits arcs into short segments, so estimate the time of such segments rather than of a straight line.
+    constexpr double estimate_segment_length = 1.0;
+    const size_t segment_count = std::max(size_t(1), static_cast<size_t>(std::ceil(length / estimate_segment_length)));
+    const double start_e = current_e_value_;
+    const double start_z = INT2MM(current_position_.z_);
+    for (size_t segment = 1; segment <= segment_count; segment++)
+    {
+        const double fraction = static_cast<double>(segment) / segment_count;
+        const double angle = start_angle + sweep * fraction;
+        time_estimates_.plan(
+            TimeEstimateCalculator::Position(
+                INT2MM(center.X) + radius * std::cos(angle),
+                INT2MM(center.Y) + radius * std::sin(angle),
+                start_z + (INT2MM(current_layer_z_) - start_z) * fraction,
+                eToMm(start_e + (new_e_value - start_e) * fraction)),
+            speed,
+            feature);
+    }
 
-    *output_stream_ << "G1";
-    writeFXYZE(speed, x, y, z, new_e_value, feature);
+    current_position_ = Point3LL(p.X, p.Y, current_layer_z_);
+    current_e_value_ = new_e_value;
 }
 
-void GCodeExport::writeFXYZE(const Velocity& speed, const coord_t x, const coord_t y, const coord_t z, const double e, const PrintFeatureType& feature)
+void GCodeExport::writeFXYZE(
+    const std::string_view command,
+    const Velocity& speed,
+    const coord_t x,
+    const coord_t y,
+    const coord_t z,
+    const double e,
+    const PrintFeatureType& feature)
 {
+    // The line is put together in a buffer and written to the stream at once, since this is done for every single move.
+    constexpr size_t line_size = 1024; // Room for both doubles even if they are absurdly large.
+    char line[line_size];
+    char* const line_limit = line + line_size;
+    char* end = std::copy(command.begin(), command.end(), line);
+
     if (current_speed_ != speed)
     {
-        *output_stream_ << " F" << PrecisionedDouble{ 1, speed * 60 };
+        *end++ = ' ';
+        *end++ = 'F';
+        end = writeDoubleToBuffer(1, speed * 60, end, line_limit);
         current_speed_ = speed;
     }
 
     Point2LL gcode_pos = getGcodePos(x, y, current_extruder_);
     total_bounding_box_.include(Point3LL(gcode_pos.X, gcode_pos.Y, z));
 
-    *output_stream_ << " X" << MMtoStream{ gcode_pos.X } << " Y" << MMtoStream{ gcode_pos.Y };
+    *end++ = ' ';
+    *end++ = 'X';
+    end = writeInt2mm(gcode_pos.X, end);
+    *end++ = ' ';
+    *end++ = 'Y';
+    end = writeInt2mm(gcode_pos.Y, end);
     if (z != current_position_.z_)
     {
-        *output_stream_ << " Z" << MMtoStream{ z };
+        *end++ = ' ';
+        *end++ = 'Z';
+        end = writeInt2mm(z, end);
     }
     if (e + current_e_offset_ != current_e_value_)
     {
         const double output_e = (relative_extrusion_) ? e + current_e_offset_ - current_e_value_ : e + current_e_offset_;
-        *output_stream_ << " " << extruder_attr_[current_extruder_].extruder_character_ << PrecisionedDouble{ 5, output_e };
+        *end++ = ' ';
+        *end++ = extruder_attr_[current_extruder_].extruder_character_;
+        end = writeDoubleToBuffer(5, output_e, end, line_limit - new_line_.size());
     }
-    *output_stream_ << new_line_;
+    end = std::copy(new_line_.begin(), new_line_.end(), end);
+    output_stream_->write(line, end - line);
 
     current_position_ = Point3LL(x, y, z);
     current_e_value_ = e;
-    estimate_calculator_.plan(TimeEstimateCalculator::Position(INT2MM(x), INT2MM(y), INT2MM(z), eToMm(e)), speed, feature);
+    time_estimates_.plan(TimeEstimateCalculator::Position(INT2MM(x), INT2MM(y), INT2MM(z), eToMm(e)), speed, feature);
 }
 
 void GCodeExport::writeUnretractionAndPrime()
@@ -1101,11 +1383,10 @@ void GCodeExport::writeUnretractionAndPrime()
             if (prime_volume != 0)
             {
                 const double output_e = (relative_extrusion_) ? prime_volume_e : current_e_value_;
-                *output_stream_ << "G1 F" << PrecisionedDouble{ 1, extruder_attr_[current_extruder_].last_retraction_prime_speed_ * 60 } << " "
-                                << extruder_attr_[current_extruder_].extruder_character_ << PrecisionedDouble{ 5, output_e } << new_line_;
+                writeFilamentMove(extruder_attr_[current_extruder_].last_retraction_prime_speed_, output_e);
                 current_speed_ = extruder_attr_[current_extruder_].last_retraction_prime_speed_;
             }
-            estimate_calculator_.plan(
+            time_estimates_.plan(
                 TimeEstimateCalculator::Position(INT2MM(current_position_.x_), INT2MM(current_position_.y_), INT2MM(current_position_.z_), eToMm(current_e_value_)),
                 25.0,
                 PrintFeatureType::MoveRetraction);
@@ -1114,10 +1395,9 @@ void GCodeExport::writeUnretractionAndPrime()
         {
             current_e_value_ += extruder_attr_[current_extruder_].retraction_e_amount_current_;
             const double output_e = (relative_extrusion_) ? extruder_attr_[current_extruder_].retraction_e_amount_current_ + prime_volume_e : current_e_value_;
-            *output_stream_ << "G1 F" << PrecisionedDouble{ 1, extruder_attr_[current_extruder_].last_retraction_prime_speed_ * 60 } << " "
-                            << extruder_attr_[current_extruder_].extruder_character_ << PrecisionedDouble{ 5, output_e } << new_line_;
+            writeFilamentMove(extruder_attr_[current_extruder_].last_retraction_prime_speed_, output_e);
             current_speed_ = extruder_attr_[current_extruder_].last_retraction_prime_speed_;
-            estimate_calculator_.plan(
+            time_estimates_.plan(
                 TimeEstimateCalculator::Position(INT2MM(current_position_.x_), INT2MM(current_position_.y_), INT2MM(current_position_.z_), eToMm(current_e_value_)),
                 current_speed_,
                 PrintFeatureType::MoveRetraction);
@@ -1126,11 +1406,9 @@ void GCodeExport::writeUnretractionAndPrime()
     else if (prime_volume != 0.0)
     {
         const double output_e = (relative_extrusion_) ? prime_volume_e : current_e_value_;
-        *output_stream_ << "G1 F" << PrecisionedDouble{ 1, extruder_attr_[current_extruder_].last_retraction_prime_speed_ * 60 } << " "
-                        << extruder_attr_[current_extruder_].extruder_character_;
-        *output_stream_ << PrecisionedDouble{ 5, output_e } << new_line_;
+        writeFilamentMove(extruder_attr_[current_extruder_].last_retraction_prime_speed_, output_e);
         current_speed_ = extruder_attr_[current_extruder_].last_retraction_prime_speed_;
-        estimate_calculator_.plan(
+        time_estimates_.plan(
             TimeEstimateCalculator::Position(INT2MM(current_position_.x_), INT2MM(current_position_.y_), INT2MM(current_position_.z_), eToMm(current_e_value_)),
             current_speed_,
             PrintFeatureType::NoneType);
@@ -1212,7 +1490,7 @@ void GCodeExport::writeRetraction(const RetractionConfig& config, bool force, bo
         }
         *output_stream_ << new_line_;
         // Assume default UM2 retraction settings.
-        estimate_calculator_.plan(
+        time_estimates_.plan(
             TimeEstimateCalculator::Position(
                 INT2MM(current_position_.x_),
                 INT2MM(current_position_.y_),
@@ -1226,9 +1504,9 @@ void GCodeExport::writeRetraction(const RetractionConfig& config, bool force, bo
         double speed = ((retraction_diff_e_amount < 0.0) ? config.speed : extr_attr.last_retraction_prime_speed_);
         current_e_value_ += retraction_diff_e_amount;
         const double output_e = (relative_extrusion_) ? retraction_diff_e_amount : current_e_value_;
-        *output_stream_ << "G1 F" << PrecisionedDouble{ 1, speed * 60 } << " " << extr_attr.extruder_character_ << PrecisionedDouble{ 5, output_e } << new_line_;
+        writeFilamentMove(speed, output_e);
         current_speed_ = speed;
-        estimate_calculator_.plan(
+        time_estimates_.plan(
             TimeEstimateCalculator::Position(INT2MM(current_position_.x_), INT2MM(current_position_.y_), INT2MM(current_position_.z_), eToMm(current_e_value_)),
             current_speed_,
             PrintFeatureType::MoveRetraction);
@@ -1245,12 +1523,11 @@ void GCodeExport::writeZhopStart(const coord_t hop_height, Velocity speed /*= 0*
     {
         if (speed == 0)
         {
-            const ExtruderTrain& extruder = Application::getInstance().current_slice_->scene.extruders[current_extruder_];
-            speed = extruder.settings_.get<Velocity>("speed_z_hop");
+            speed = getZHopSpeed();
         }
         is_z_hopped_ = hop_height;
         current_speed_ = speed;
-        *output_stream_ << "G1 F" << PrecisionedDouble{ 1, speed * 60 } << " Z" << MMtoStream{ current_layer_z_ + is_z_hopped_ } << new_line_;
+        writeZMove(speed, current_layer_z_ + is_z_hopped_);
         total_bounding_box_.includeZ(current_layer_z_ + is_z_hopped_);
         assert(speed > 0.0 && "Z hop speed should be positive.");
     }
@@ -1262,17 +1539,69 @@ void GCodeExport::writeZhopEnd(Velocity speed /*= 0*/)
     {
         if (speed == 0)
         {
-            const ExtruderTrain& extruder = Application::getInstance().current_slice_->scene.extruders[current_extruder_];
-            speed = extruder.settings_.get<Velocity>("speed_z_hop");
+            speed = getZHopSpeed();
         }
         is_z_hopped_ = 0;
         current_position_.z_ = current_layer_z_;
         current_speed_ = speed;
-        *output_stream_ << "G1 F" << PrecisionedDouble{ 1, speed * 60 } << " Z" << MMtoStream{ current_layer_z_ } << new_line_;
+        writeZMove(speed, current_layer_z_);
         assert(speed > 0.0 && "Z hop speed should be positive.");
     }
 }
 
+void GCodeExport::writeFilamentMove(const Velocity& speed, const double output_e)
+{
+    constexpr size_t line_size = 64;
+    char line[line_size];
+    char* const line_limit = line + line_size;
+    char* end = std::copy_n("G1 F", 4, line);
+    end = writeDoubleToBuffer(1, speed * 60, end, line_limit);
+    *end++ = ' ';
+    *end++ = extruder_attr_[current_extruder_].extruder_character_;
+    end = writeDoubleToBuffer(5, output_e, end, line_limit - new_line_.size());
+    end = std::copy(new_line_.begin(), new_line_.end(), end);
+    output_stream_->write(line, end - line);
+}
+
+void GCodeExport::writeZMove(const Velocity& speed, const coord_t z)
+{
+    constexpr size_t line_size = 64;
+    char line[line_size];
+    char* const line_limit = line + line_size;
+    char* end = std::copy_n("G1 F", 4, line);
+    end = writeDoubleToBuffer(1, speed * 60, end, line_limit - int2mm_max_chars - new_line_.size());
+    *end++ = ' ';
+    *end++ = 'Z';
+    end = writeInt2mm(z, end);
+    end = std::copy(new_line_.begin(), new_line_.end(), end);
+    output_stream_->write(line, end - line);
+}
+
+const GCodeExport::ExtruderTrainAttributes::SwitchSettings& GCodeExport::getSwitchSettings(const size_t extruder_nr)
+{
+    std::optional<ExtruderTrainAttributes::SwitchSettings>& switch_settings = extruder_attr_[extruder_nr].switch_settings_;
+    if (! switch_settings)
+    {
+        const Settings& extruder_settings = Application::getInstance().current_slice_->scene.extruders[extruder_nr].settings_;
+        switch_settings = ExtruderTrainAttributes::SwitchSettings{ .retraction_enable = extruder_settings.get<bool>("retraction_enable"),
+                                                                   .start_code = extruder_settings.get<std::string>("machine_extruder_start_code"),
+                                                                   .start_code_duration = extruder_settings.get<Duration>("machine_extruder_start_code_duration"),
+                                                                   .end_code = extruder_settings.get<std::string>("machine_extruder_end_code"),
+                                                                   .end_code_duration = extruder_settings.get<Duration>("machine_extruder_end_code_duration") };
+    }
+    return *switch_settings;
+}
+
+Velocity GCodeExport::getZHopSpeed()
+{
+    std::optional<Velocity>& z_hop_speed = extruder_attr_[current_extruder_].z_hop_speed_;
+    if (! z_hop_speed)
+    {
+        z_hop_speed = Application::getInstance().current_slice_->scene.extruders[current_extruder_].settings_.get<Velocity>("speed_z_hop");
+    }
+    return *z_hop_speed;
+}
+
 void GCodeExport::startExtruder(const size_t new_extruder)
 {
     extruder_attr_[new_extruder].is_used_ = true;
@@ -1293,8 +1622,8 @@ void GCodeExport::startExtruder(const size_t new_extruder)
     assert(getCurrentExtrudedVolume() == 0.0 && "Just after an extruder switch we haven't extruded anything yet!");
     resetExtrusionValue(); // zero the E value on the new extruder, just to be sure
 
-    const auto extruder_settings = Application::getInstance().current_slice_->scene.extruders[new_extruder].settings_;
-    const auto start_code = extruder_settings.get<std::string>("machine_extruder_start_code");
+    const ExtruderTrainAttributes::SwitchSettings& switch_settings = getSwitchSettings(new_extruder);
+    const std::string& start_code = switch_settings.start_code;
     if (! start_code.empty())
     {
         if (relative_extrusion_)
@@ -1310,8 +1639,7 @@ void GCodeExport::startExtruder(const size_t new_extruder)
         }
     }
 
-    const auto start_code_duration = extruder_settings.get<Duration>("machine_extruder_start_code_duration");
-    estimate_calculator_.addTime(start_code_duration);
+    time_estimates_.addTime(switch_settings.start_code_duration);
 
     Application::getInstance().communication_->setExtruderForSend(Application::getInstance().current_slice_->scene.extruders[new_extruder]);
     Application::getInstance().communication_->sendCurrentPosition(getPositionXY());
@@ -1327,8 +1655,8 @@ void GCodeExport::switchExtruder(size_t new_extruder, const RetractionConfig& re
         return;
     }
 
-    const Settings& old_extruder_settings = Application::getInstance().current_slice_->scene.extruders[current_extruder_].settings_;
-    if (old_extruder_settings.get<bool>("retraction_enable"))
+    const ExtruderTrainAttributes::SwitchSettings& old_switch_settings = getSwitchSettings(current_extruder_);
+    if (old_switch_settings.retraction_enable)
     {
         constexpr bool force = true;
         constexpr bool extruder_switch = true;
@@ -1342,7 +1670,7 @@ void GCodeExport::switchExtruder(size_t new_extruder, const RetractionConfig& re
 
     resetExtrusionValue(); // zero the E value on the old extruder, so that the current_e_value is registered on the old extruder
 
-    const auto end_code = old_extruder_settings.get<std::string>("machine_extruder_end_code");
+    const std::string& end_code = old_switch_settings.end_code;
 
     if (! end_code.empty())
     {
@@ -1359,8 +1687,7 @@ void GCodeExport::switchExtruder(size_t new_extruder, const RetractionConfig& re
         }
     }
 
-    const auto end_code_duration = old_extruder_settings.get<Duration>("machine_extruder_end_code_duration");
-    estimate_calculator_.addTime(end_code_duration);
+    time_estimates_.addTime(old_switch_settings.end_code_duration);
 
     startExtruder(new_extruder);
 }
@@ -1661,7 +1988,7 @@ void GCodeExport::writePrintAcceleration(const Acceleration& acceleration)
         break;
     }
     current_print_acceleration_ = acceleration;
-    estimate_calculator_.setAcceleration(acceleration);
+    time_estimates_.setAcceleration(acceleration);
 }
 
 void GCodeExport::writeTravelAcceleration(const Acceleration& acceleration)
@@ -1686,7 +2013,7 @@ void GCodeExport::writeTravelAcceleration(const Acceleration& acceleration)
         break;
     }
     current_travel_acceleration_ = acceleration;
-    estimate_calculator_.setAcceleration(acceleration);
+    time_estimates_.setAcceleration(acceleration);
 }
 
 void GCodeExport::writeJerk(const Velocity& jerk)
@@ -1706,7 +2033,7 @@ void GCodeExport::writeJerk(const Velocity& jerk)
             break;
         }
         current_jerk_ = jerk;
-        estimate_calculator_.setMaxXyJerk(jerk);
+        time_estimates_.setMaxXyJerk(jerk);
     }
 }
 
@@ -1725,6 +2052,81 @@ void GCodeExport::finalize(const char* endCode)
     output_stream_->flush();
 }
 
+void GCodeExport::startBinaryOutput()
+{
+    if (! Application::getInstance().communication_->isSequential())
+    {
+        // The front-end receives the g-code in chunks of text while slicing, and puts the header in front of it afterwards.
+        spdlog::warn("Binary g-code can only be written when slicing from the command line. Writing text instead.");
+        return;
+    }
+    binary_target_ = output_stream_;
+    binary_writer_ = std::make_unique<BinaryGCodeWriter>(*output_stream_, BinaryGCodeWriter::Compression::HEATSHRINK_12_4);
+    binary_stream_ = std::make_unique<std::ostream>(binary_writer_.get());
+    setOutputStream(binary_stream_.get());
+}
+
+void GCodeExport::finishBinaryOutput()
+{
+    if (! binary_writer_)
+    {
+        return;
+    }
+    writeEstimatedLayers(true);
+    output_stream_->flush();
+
+    const Scene& scene = Application::getInstance().current_slice_->scene;
+    const auto per_extruder = [&scene](const auto& get_value)
+    {
+        std::ostringstream values;
+        for (size_t extruder_nr = 0; extruder_nr < scene.extruders.size(); extruder_nr++)
+        {
+            values << (extruder_nr > 0 ? "," : "") << get_value(extruder_nr);
+        }
+        return values.str();
+    };
+
+    BinaryGCodeWriter::Metadata printer_metadata;
+    printer_metadata.emplace_back("printer_model", transliterate(machine_name_));
+    printer_metadata.emplace_back("extruder_count", std::to_string(scene.extruders.size()));
+    printer_metadata.emplace_back(
+        "nozzle_diameter",
+        per_extruder(
+            [&scene](const size_t extruder_nr)
+            {
+                return scene.extruders[extruder_nr].settings_.get<double>("machine_nozzle_size");
+            }));
+    printer_metadata.emplace_back(
+        "filament_type",
+        per_extruder(
+            [&scene](const size_t extruder_nr)
+            {
+                return scene.extruders[extruder_nr].settings_.get<std::string>("material_type");
+            }));
+
+    const int print_time = static_cast<int>(getSumTotalPrintTimes());
+    BinaryGCodeWriter::Metadata print_metadata;
+    print_metadata.emplace_back(
+        "filament used [mm3]",
+        per_extruder(
+            [this](const size_t extruder_nr)
+            {
+                return static_cast<int>(getTotalFilamentUsed(extruder_nr));
+            }));
+    print_metadata.emplace_back("estimated printing time (normal mode)", fmt::format("{}h {}m {}s", print_time / 60 / 60, (print_time / 60) % 60, print_time % 60));
+    print_metadata.emplace_back("print_time", std::to_string(print_time));
+
+    BinaryGCodeWriter::Metadata slicer_metadata;
+    slicer_metadata.emplace_back("generator", "Cura_SteamEngine " CURA_ENGINE_VERSION);
+    slicer_metadata.emplace_back("flavor", flavorToString(flavor_));
+    slicer_metadata.emplace_back("slice_uuid", slice_uuid_);
+
+    binary_writer_->finish(printer_metadata, print_metadata, slicer_metadata);
+    output_stream_ = binary_target_;
+    binary_stream_.reset();
+    binary_writer_.reset();
+}
+
 double GCodeExport::getExtrudedVolumeAfterLastWipe(size_t extruder)
 {
     return eToMm3(extruder_attr_[extruder].last_e_value_after_wipe_, extruder);
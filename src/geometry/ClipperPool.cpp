@@ -0,0 +1,72 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "geometry/ClipperPool.h"
+
+#include <type_traits>
+
+namespace cura
+{
+
+namespace
+{
+
+//! Take an unused object from the pool of this thread, or make a new one.
+template<typename T>
+std::unique_ptr<T> take(std::vector<std::unique_ptr<T>>& pool)
+{
+    if (pool.empty())
+    {
+        return std::make_unique<T>();
+    }
+    std::unique_ptr<T> object = std::move(pool.back());
+    pool.pop_back();
+    return object;
+}
+
+} // namespace
+
+ClipperPool::Lease<ClipperLib::Clipper> ClipperPool::clipper()
+{
+    thread_local std::vector<std::unique_ptr<ClipperLib::Clipper>> pool;
+    return { take(pool), pool };
+}
+
+ClipperPool::Lease<ClipperLib::ClipperOffset> ClipperPool::offsetter(double miter_limit, double arc_tolerance)
+{
+    thread_local std::vector<std::unique_ptr<ClipperLib::ClipperOffset>> pool;
+    std::unique_ptr<ClipperLib::ClipperOffset> offsetter = take(pool);
+    offsetter->MiterLimit = miter_limit;
+    offsetter->ArcTolerance = arc_tolerance;
+    return { std::move(offsetter), pool };
+}
+
+ClipperPool::Lease<ClipperLib::PolyTree> ClipperPool::polyTree()
+{
+    thread_local std::vector<std::unique_ptr<ClipperLib::PolyTree>> pool;
+    return { take(pool), pool };
+}
+
+template<typename T>
+void ClipperPool::release(std::unique_ptr<T> object, std::vector<std::unique_ptr<T>>& pool)
+{
+    if (pool.size() >= max_pooled)
+    {
+        return;
+    }
+    object->Clear();
+    if constexpr (std::is_same_v<T, ClipperLib::Clipper>)
+    {
+        // Restore the default options, in case the previous user changed them.
+        object->ReverseSolution(false);
+        object->StrictlySimple(false);
+        object->PreserveCollinear(false);
+    }
+    pool.push_back(std::move(object));
+}
+
+template void ClipperPool::release(std::unique_ptr<ClipperLib::Clipper>, std::vector<std::unique_ptr<ClipperLib::Clipper>>&);
+template void ClipperPool::release(std::unique_ptr<ClipperLib::ClipperOffset>, std::vector<std::unique_ptr<ClipperLib::ClipperOffset>>&);
+template void ClipperPool::release(std::unique_ptr<ClipperLib::PolyTree>, std::vector<std::unique_ptr<ClipperLib::PolyTree>>&);
+
+} // namespace cura
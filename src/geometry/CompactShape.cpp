@@ -0,0 +1,74 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "geometry/CompactShape.h"
+
+#include <limits>
+
+#include "geometry/Polygon.h"
+#include "utils/AABB.h"
+
+namespace cura
+{
+
+CompactShape::CompactShape(const Shape& shape)
+{
+    if (shape.empty())
+    {
+        return;
+    }
+
+    const AABB box(shape);
+    constexpr coord_t max_span = std::numeric_limits<uint32_t>::max();
+    if (box.max_.X - box.min_.X > max_span || box.max_.Y - box.min_.Y > max_span)
+    {
+        wide_ = shape;
+        return;
+    }
+
+    origin_ = box.min_;
+    size_t point_count = 0;
+    for (const Polygon& polygon : shape)
+    {
+        point_count += polygon.size();
+    }
+    points_.reserve(point_count);
+    path_ends_.reserve(shape.size());
+    explicitely_closed_.reserve(shape.size());
+    for (const Polygon& polygon : shape)
+    {
+        for (const Point2LL& point : polygon)
+        {
+            points_.push_back(Offset{ .x = static_cast<uint32_t>(point.X - origin_.X), .y = static_cast<uint32_t>(point.Y - origin_.Y) });
+        }
+        path_ends_.push_back(points_.size());
+        explicitely_closed_.push_back(polygon.isExplicitelyClosed());
+    }
+}
+
+Shape CompactShape::decode() const
+{
+    if (! wide_.empty())
+    {
+        return wide_;
+    }
+
+    Shape result;
+    result.reserve(path_ends_.size());
+    size_t begin = 0;
+    for (size_t path_idx = 0; path_idx < path_ends_.size(); path_idx++)
+    {
+        const size_t end = path_ends_[path_idx];
+        ClipperLib::Path path;
+        path.reserve(end - begin);
+        for (size_t point_idx = begin; point_idx < end; point_idx++)
+        {
+            path.emplace_back(origin_.X + static_cast<coord_t>(points_[point_idx].x), origin_.Y + static_cast<coord_t>(points_[point_idx].y));
+        }
+        result.emplace_back(std::move(path), explicitely_closed_[path_idx]);
+        begin = end;
+    }
+    return result;
+}
+
+} // namespace cura
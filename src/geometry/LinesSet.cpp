@@ -3,13 +3,20 @@
 
 #include "geometry/LinesSet.h"
 
+#include <algorithm>
+#include <limits>
 #include <numeric>
+#include <utility>
+#include <vector>
 
+#include "geometry/ClipperPool.h"
 #include "geometry/ClosedLinesSet.h"
 #include "geometry/OpenLinesSet.h"
 #include "geometry/OpenPolyline.h"
 #include "geometry/Polygon.h"
 #include "geometry/Shape.h"
+#include "utils/AABB.h"
+#include "utils/linearAlg2D.h"
 
 namespace cura
 {
@@ -164,7 +171,8 @@ Shape LinesSet<ClosedPolyline>::offset(coord_t distance, ClipperLib::JoinType jo
         return result;
     }
     ClipperLib::Paths ret;
-    ClipperLib::ClipperOffset clipper(miter_limit, 10.0);
+    auto clipper_lease = ClipperPool::offsetter(miter_limit);
+    ClipperLib::ClipperOffset& clipper = *clipper_lease;
     addPaths(clipper, join_type, ClipperLib::etClosedLine);
     clipper.MiterLimit = miter_limit;
     clipper.Execute(ret, static_cast<double>(distance));
@@ -183,7 +191,8 @@ Shape LinesSet<Polygon>::offset(coord_t distance, ClipperLib::JoinType join_type
         return { getLines() };
     }
     ClipperLib::Paths ret;
-    ClipperLib::ClipperOffset clipper(miter_limit, 10.0);
+    auto clipper_lease = ClipperPool::offsetter(miter_limit);
+    ClipperLib::ClipperOffset& clipper = *clipper_lease;
     Shape(getLines()).unionPolygons().addPaths(clipper, join_type, ClipperLib::etClosedPolygon);
     clipper.MiterLimit = miter_limit;
     clipper.Execute(ret, static_cast<double>(distance));
@@ -198,7 +207,8 @@ Shape OpenLinesSet::offset(coord_t distance, ClipperLib::JoinType join_type, dou
         return {};
     }
 
-    ClipperLib::ClipperOffset clipper(miter_limit, 10.0);
+    auto clipper_lease = ClipperPool::offsetter(miter_limit);
+    ClipperLib::ClipperOffset& clipper = *clipper_lease;
     const ClipperLib::EndType end_type{ join_type == ClipperLib::jtMiter ? ClipperLib::etOpenSquare : ClipperLib::etOpenRound };
     addPaths(clipper, join_type, end_type);
     clipper.MiterLimit = miter_limit;
@@ -215,8 +225,10 @@ OpenLinesSet OpenLinesSet::lineCut(const Shape& other) const
         return {};
     }
     ClipperLib::Paths ret;
-    ClipperLib::PolyTree resultPolyTree;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto result_lease = ClipperPool::polyTree();
+    ClipperLib::PolyTree& resultPolyTree = *result_lease;
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     other.addPaths(clipper, ClipperLib::ptClip);
     clipper.Execute(ClipperLib::ctIntersection, resultPolyTree);
@@ -225,6 +237,100 @@ OpenLinesSet OpenLinesSet::lineCut(const Shape& other) const
 
 }
 
+namespace
+{
+//! How far along \p line the point of it that is closest to \p point lies.
+coord_t distanceAlong(const OpenPolyline& line, const Point2LL& point)
+{
+    coord_t best_distance2 = std::numeric_limits<coord_t>::max();
+    coord_t best_along = 0;
+    coord_t walked = 0;
+    for (size_t point_idx = 0; point_idx + 1 < line.size(); point_idx++)
+    {
+        const Point2LL& start = line[point_idx];
+        const Point2LL& end = line[point_idx + 1];
+        const Point2LL closest = LinearAlg2D::getClosestOnLineSegment(point, start, end);
+        const coord_t distance2 = vSize2(point - closest);
+        if (distance2 < best_distance2)
+        {
+            best_distance2 = distance2;
+            best_along = walked + vSize(closest - start);
+        }
+        walked += vSize(end - start);
+    }
+    return best_along;
+}
+
+//! Whether two bounding boxes overlap, including when they only touch, since a fiber may run along the border of a shape.
+bool touches(const AABB& a, const AABB& b)
+{
+    return a.min_.X <= b.max_.X && b.min_.X <= a.max_.X && a.min_.Y <= b.max_.Y && b.min_.Y <= a.max_.Y;
+}
+} // namespace
+
+template<>
+OpenLinesSet OpenLinesSet::fiberCut(const Shape& other) const
+{
+    if (empty() || other.empty())
+    {
+        return {};
+    }
+    std::vector<AABB> polygon_boxes;
+    polygon_boxes.reserve(other.size());
+    for (const Polygon& polygon : other)
+    {
+        polygon_boxes.emplace_back(polygon);
+    }
+
+    OpenLinesSet result;
+    for (const OpenPolyline& line : lines_)
+    {
+        AABB line_box;
+        for (const Point2LL& point : line)
+        {
+            line_box.include(point);
+        }
+        // Only the polygons around the fiber can change what's inside at its points, so the others don't need to be clipped with.
+        Shape nearby;
+        for (size_t polygon_idx = 0; polygon_idx < other.size(); polygon_idx++)
+        {
+            if (touches(polygon_boxes[polygon_idx], line_box))
+            {
+                nearby.push_back(other[polygon_idx]);
+            }
+        }
+        if (nearby.empty())
+        {
+            continue; // The fiber is outside of the shape.
+        }
+
+        // Restitching the pieces may turn them around, so put them back in the direction and order of the fiber.
+        std::vector<std::pair<coord_t, OpenPolyline>> pieces;
+        for (OpenPolyline& piece : nearby.intersection(OpenLinesSet(line)))
+        {
+            coord_t start = distanceAlong(line, piece.front());
+            const coord_t end = distanceAlong(line, piece.back());
+            if (end < start)
+            {
+                piece.reverse();
+                start = end;
+            }
+            pieces.emplace_back(start, std::move(piece));
+        }
+        std::stable_sort(
+            pieces.begin(),
+            pieces.end(),
+            [](const auto& a, const auto& b)
+            {
+                return a.first < b.first;
+            });
+        for (auto& [start, piece] : pieces)
+        {
+            result.push_back(std::move(piece));
+        }
+    }
+    return result;
+}
 
 template<class LineType>
 void LinesSet<LineType>::removeDegenerateVerts()
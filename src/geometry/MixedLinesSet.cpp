@@ -5,6 +5,7 @@
 
 #include <numeric>
 
+#include "geometry/ClipperPool.h"
 #include "geometry/OpenPolyline.h"
 #include "geometry/Polygon.h"
 #include "geometry/Shape.h"
@@ -31,7 +32,8 @@ Shape MixedLinesSet::offset(coord_t distance, ClipperLib::JoinType join_type, do
         return result;
     }
     Shape polygons;
-    ClipperLib::ClipperOffset clipper(miter_limit, 10.0);
+    auto clipper_lease = ClipperPool::offsetter(miter_limit);
+    ClipperLib::ClipperOffset& clipper = *clipper_lease;
 
     for (const PolylinePtr& line : (*this))
     {
@@ -0,0 +1,106 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "geometry/OffsetEngine.h"
+
+#include "geometry/Polygon.h"
+#include "utils/ThreadPool.h"
+
+namespace cura
+{
+
+OffsetEngine::OffsetEngine(const Shape& shape, ClipperLib::JoinType join_type, double miter_limit)
+    : original_(shape)
+    , join_type_(join_type)
+    , miter_limit_(miter_limit)
+{
+    if (! shape.empty())
+    {
+        for (const Polygon& polygon : shape.unionPolygons())
+        {
+            paths_.push_back(polygon.getPoints());
+        }
+    }
+}
+
+OffsetEngine::OffsetEngine(const Polygon& polygon, ClipperLib::JoinType join_type, double miter_limit)
+    : original_({ polygon })
+    , paths_({ polygon.getPoints() })
+    , join_type_(join_type)
+    , miter_limit_(miter_limit)
+{
+}
+
+OffsetEngine::~OffsetEngine() = default;
+
+Shape OffsetEngine::offset(coord_t distance)
+{
+    if (! clipper_)
+    {
+        clipper_ = makeClipper();
+    }
+    return offset(*clipper_, distance);
+}
+
+std::vector<Shape> OffsetEngine::offsets(const std::vector<coord_t>& distances, bool parallel)
+{
+    std::vector<Shape> ret(distances.size());
+    if (! parallel || distances.size() < 2)
+    {
+        for (size_t distance_idx = 0; distance_idx < distances.size(); distance_idx++)
+        {
+            ret[distance_idx] = offset(distances[distance_idx]);
+        }
+        return ret;
+    }
+
+    cura::parallel_for<size_t>(
+        0,
+        distances.size(),
+        [&](const size_t distance_idx)
+        {
+            std::unique_ptr<ClipperLib::ClipperOffset> clipper;
+            {
+                std::lock_guard lock(spare_clippers_mutex_);
+                if (! spare_clippers_.empty())
+                {
+                    clipper = std::move(spare_clippers_.back());
+                    spare_clippers_.pop_back();
+                }
+            }
+            if (! clipper)
+            {
+                clipper = makeClipper();
+            }
+            ret[distance_idx] = offset(*clipper, distances[distance_idx]);
+
+            std::lock_guard lock(spare_clippers_mutex_);
+            spare_clippers_.push_back(std::move(clipper));
+        });
+    return ret;
+}
+
+std::unique_ptr<ClipperLib::ClipperOffset> OffsetEngine::makeClipper() const
+{
+    auto clipper = std::make_unique<ClipperLib::ClipperOffset>(miter_limit_, 10.0);
+    clipper->AddPaths(paths_, join_type_, ClipperLib::etClosedPolygon);
+    clipper->MiterLimit = miter_limit_;
+    return clipper;
+}
+
+Shape OffsetEngine::offset(ClipperLib::ClipperOffset& clipper, coord_t distance) const
+{
+    if (distance == 0)
+    {
+        return original_;
+    }
+    if (paths_.empty())
+    {
+        return {};
+    }
+    ClipperLib::Paths ret;
+    clipper.Execute(ret, static_cast<double>(distance));
+    return Shape{ std::move(ret) };
+}
+
+} // namespace cura
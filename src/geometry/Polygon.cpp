@@ -6,6 +6,7 @@
 #include <cstddef>
 #include <numbers>
 
+#include "geometry/ClipperPool.h"
 #include "geometry/Point3Matrix.h"
 #include "geometry/Shape.h"
 #include "utils/ListPolyIt.h"
@@ -17,7 +18,8 @@ namespace cura
 Shape Polygon::intersection(const Polygon& other) const
 {
     ClipperLib::Paths ret_paths;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     clipper.AddPath(getPoints(), ClipperLib::ptSubject, true);
     clipper.AddPath(other.getPoints(), ClipperLib::ptClip, true);
     clipper.Execute(ClipperLib::ctIntersection, ret_paths);
@@ -589,7 +591,8 @@ Shape Polygon::offset(int distance, ClipperLib::JoinType join_type, double miter
         return Shape({ *this });
     }
     ClipperLib::Paths ret;
-    ClipperLib::ClipperOffset clipper(miter_limit, 10.0);
+    auto clipper_lease = ClipperPool::offsetter(miter_limit);
+    ClipperLib::ClipperOffset& clipper = *clipper_lease;
     clipper.AddPath(getPoints(), join_type, ClipperLib::etClosedPolygon);
     clipper.MiterLimit = miter_limit;
     clipper.Execute(ret, distance);
@@ -4,7 +4,9 @@
 #include "geometry/Shape.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <iterator>
 #include <mapbox/geometry/wagyu/wagyu.hpp>
 #include <numeric>
 #include <unordered_set>
@@ -25,13 +27,18 @@
 #include <range/v3/view/filter.hpp>
 #include <range/v3/view/sliding.hpp>
 
+#include "Application.h" // To get the number of threads.
+#include "geometry/ClipperPool.h"
 #include "geometry/MixedLinesSet.h"
 #include "geometry/OpenPolyline.h"
 #include "geometry/PartsView.h"
 #include "geometry/Polygon.h"
 #include "geometry/SingleShape.h"
 #include "settings/types/Ratio.h"
+#include "utils/AABB.h"
 #include "utils/OpenPolylineStitcher.h"
+#include "utils/ShapeCoordinates.h"
+#include "utils/ThreadPool.h"
 #include "utils/linearAlg2D.h"
 
 namespace cura
@@ -77,7 +84,8 @@ Shape Shape::approxConvexHull(int extra_outset) const
     for (const Polygon& polygon : (*this))
     {
         ClipperLib::Paths offset_result;
-        ClipperLib::ClipperOffset offsetter(1.2, 10.0);
+        auto offsetter_lease = ClipperPool::offsetter(1.2);
+        ClipperLib::ClipperOffset& offsetter = *offsetter_lease;
         offsetter.AddPath(polygon.getPoints(), ClipperLib::jtRound, ClipperLib::etClosedPolygon);
         offsetter.Execute(offset_result, overshoot);
         convex_hull.emplace_back(std::move(offset_result));
@@ -145,12 +153,13 @@ Shape Shape::difference(const Shape& other) const
     {
         return {};
     }
-    if (other.empty())
+    if (other.empty() || ! AABB(*this).hit(AABB(other)))
     {
         return *this;
     }
     ClipperLib::Paths ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     other.addPaths(clipper, ClipperLib::ptClip);
     clipper.Execute(ClipperLib::ctDifference, ret);
@@ -163,18 +172,55 @@ Shape Shape::difference(const Polygon& other) const
     {
         return {};
     }
-    if (other.empty())
+    if (other.empty() || ! AABB(*this).hit(AABB(other)))
     {
         return *this;
     }
     ClipperLib::Paths ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     addPath(clipper, other, ClipperLib::ptClip);
     clipper.Execute(ClipperLib::ctDifference, ret);
     return Shape(std::move(ret));
 }
 
+Shape Shape::difference(const std::vector<Shape>& others) const
+{
+    if (empty())
+    {
+        return {};
+    }
+    const AABB aabb(*this);
+    std::vector<const Shape*> overlapping;
+    for (const Shape& other : others)
+    {
+        if (! other.empty() && aabb.hit(AABB(other)))
+        {
+            overlapping.push_back(&other);
+        }
+    }
+    if (overlapping.empty())
+    {
+        return *this;
+    }
+    if (overlapping.size() == 1)
+    {
+        return difference(*overlapping.front());
+    }
+    ClipperLib::Paths ret;
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
+    addPaths(clipper, ClipperLib::ptSubject);
+    for (const Shape* other : overlapping)
+    {
+        other->addPaths(clipper, ClipperLib::ptClip);
+    }
+    // Overlapping clip shapes must add up rather than cancel each other out, so the clip shapes are filled non-zero.
+    clipper.Execute(ClipperLib::ctDifference, ret, ClipperLib::pftEvenOdd, ClipperLib::pftNonZero);
+    return Shape(std::move(ret));
+}
+
 Shape Shape::unionPolygons(const Shape& other, ClipperLib::PolyFillType fill_type) const
 {
     if (empty() && other.empty())
@@ -183,7 +229,8 @@ Shape Shape::unionPolygons(const Shape& other, ClipperLib::PolyFillType fill_typ
     }
     // No further early outs, as shapes should be able to be 'unioned' with themselves, which will resolve certain issues like self-overlapping polygons.
     ClipperLib::Paths ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     other.addPaths(clipper, ClipperLib::ptSubject);
     clipper.Execute(ClipperLib::ctUnion, ret, fill_type, fill_type);
@@ -198,26 +245,118 @@ Shape Shape::unionPolygons(const Polygon& polygon, ClipperLib::PolyFillType fill
     }
     // No further early outs, as unioning even with another empty polygon has some beneficial side-effects, such as removing self-overlapping polygons.
     ClipperLib::Paths ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     addPath(clipper, polygon, ClipperLib::ptSubject);
     clipper.Execute(ClipperLib::ctUnion, ret, fill_type, fill_type);
     return Shape{ std::move(ret) };
 }
 
+Shape Shape::unionPolygons(const std::vector<Shape>& others, ClipperLib::PolyFillType fill_type) const
+{
+    ClipperLib::Paths ret;
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
+    bool any_paths = ! empty();
+    addPaths(clipper, ClipperLib::ptSubject);
+    for (const Shape& other : others)
+    {
+        any_paths |= ! other.empty();
+        other.addPaths(clipper, ClipperLib::ptSubject);
+    }
+    if (! any_paths)
+    {
+        return {};
+    }
+    clipper.Execute(ClipperLib::ctUnion, ret, fill_type, fill_type);
+    return Shape{ std::move(ret) };
+}
+
 Shape Shape::unionPolygons() const
 {
     return unionPolygons(Shape());
 }
 
+Shape Shape::unionPolygonsParallel(const size_t parallel_vertex_count) const
+{
+    const ThreadPool* thread_pool = Application::getInstance().thread_pool_;
+    const size_t worker_count = thread_pool != nullptr ? thread_pool->thread_count() + 1 : 1;
+    if (worker_count < 2 || size() < 2 || pointCount() < parallel_vertex_count)
+    {
+        return unionPolygons();
+    }
+
+    // Only the polygons that overlap a tile can change which part of it is filled, so each tile only needs those.
+    std::vector<AABB> polygon_boxes;
+    polygon_boxes.reserve(size());
+    AABB total_box;
+    for (const Polygon& polygon : *this)
+    {
+        polygon_boxes.emplace_back(polygon);
+        total_box.include(polygon_boxes.back());
+    }
+    const size_t tiles_per_side = static_cast<size_t>(std::ceil(std::sqrt(2.0 * static_cast<double>(worker_count))));
+    const auto tile_border = [tiles_per_side](const coord_t min, const coord_t max, const size_t idx)
+    {
+        // One past the maximum, so that the polygons on the far border of the bounding box are inside the last tile.
+        return min + static_cast<coord_t>(static_cast<double>(max + 1 - min) * static_cast<double>(idx) / static_cast<double>(tiles_per_side));
+    };
+
+    std::vector<Shape> tiles(tiles_per_side * tiles_per_side);
+    cura::parallel_for<size_t>(
+        0,
+        tiles.size(),
+        [&](const size_t tile_idx)
+        {
+            const size_t column = tile_idx % tiles_per_side;
+            const size_t row = tile_idx / tiles_per_side;
+            const AABB tile_box(
+                Point2LL(tile_border(total_box.min_.X, total_box.max_.X, column), tile_border(total_box.min_.Y, total_box.max_.Y, row)),
+                Point2LL(tile_border(total_box.min_.X, total_box.max_.X, column + 1), tile_border(total_box.min_.Y, total_box.max_.Y, row + 1)));
+            auto clipper_lease = ClipperPool::clipper();
+            ClipperLib::Clipper& clipper = *clipper_lease;
+            bool any_paths = false;
+            for (size_t polygon_idx = 0; polygon_idx < size(); polygon_idx++)
+            {
+                if (polygon_boxes[polygon_idx].hit(tile_box))
+                {
+                    addPath(clipper, (*this)[polygon_idx], ClipperLib::ptSubject);
+                    any_paths = true;
+                }
+            }
+            if (! any_paths)
+            {
+                return;
+            }
+            clipper.AddPath(tile_box.toPolygon().getPoints(), ClipperLib::ptClip, true);
+            ClipperLib::Paths ret;
+            clipper.Execute(ClipperLib::ctIntersection, ret, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+            tiles[tile_idx] = Shape{ std::move(ret) };
+        });
+
+    // The tiles only touch along their borders, so merging them joins the parts that were cut apart.
+    std::vector<Shape> rows(tiles_per_side);
+    cura::parallel_for<size_t>(
+        0,
+        tiles_per_side,
+        [&](const size_t row)
+        {
+            const auto row_begin = tiles.begin() + static_cast<std::ptrdiff_t>(row * tiles_per_side);
+            rows[row] = Shape().unionPolygons(std::vector<Shape>(std::make_move_iterator(row_begin), std::make_move_iterator(row_begin + static_cast<std::ptrdiff_t>(tiles_per_side))));
+        });
+    return Shape().unionPolygons(rows);
+}
+
 Shape Shape::intersection(const Shape& other) const
 {
-    if (empty() || other.empty())
+    if (empty() || other.empty() || ! AABB(*this).hit(AABB(other)))
     {
         return {};
     }
     ClipperLib::Paths ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     other.addPaths(clipper, ClipperLib::ptClip);
     clipper.Execute(ClipperLib::ctIntersection, ret);
@@ -236,7 +375,8 @@ Shape Shape::offset(coord_t distance, ClipperLib::JoinType join_type, double mit
     }
 
     ClipperLib::Paths ret;
-    ClipperLib::ClipperOffset clipper(miter_limit, 10.0);
+    auto clipper_lease = ClipperPool::offsetter(miter_limit);
+    ClipperLib::ClipperOffset& clipper = *clipper_lease;
     unionPolygons().addPaths(clipper, join_type, ClipperLib::etClosedPolygon);
     clipper.MiterLimit = miter_limit;
     clipper.Execute(ret, static_cast<double>(distance));
@@ -258,6 +398,12 @@ bool Shape::inside(const Point2LL& p, bool border_result) const
     return (poly_count_inside % 2) == 1;
 }
 
+std::vector<bool> Shape::inside(std::span<const Point2LL> points, bool border_result) const
+{
+    constexpr bool index_edges = true;
+    return ShapeCoordinates(*this, index_edges).inside(points, border_result);
+}
+
 size_t Shape::findInside(const Point2LL& p, bool border_result) const
 {
     if (empty())
@@ -330,8 +476,10 @@ OpenLinesSet Shape::intersection(const LinesSet<LineType>& polylines, bool resti
 
     OpenLinesSet split_polylines = polylines.splitIntoSegments();
 
-    ClipperLib::PolyTree result;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto result_lease = ClipperPool::polyTree();
+    ClipperLib::PolyTree& result = *result_lease;
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     split_polylines.addPaths(clipper, ClipperLib::ptSubject);
     addPaths(clipper, ClipperLib::ptClip);
     clipper.Execute(ClipperLib::ctIntersection, result);
@@ -377,7 +525,8 @@ Shape Shape::xorPolygons(const Shape& other, ClipperLib::PolyFillType pft) const
         return *this;
     }
     ClipperLib::Paths ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     other.addPaths(clipper, ClipperLib::ptClip);
     clipper.Execute(ClipperLib::ctXor, ret, pft);
@@ -387,7 +536,8 @@ Shape Shape::xorPolygons(const Shape& other, ClipperLib::PolyFillType pft) const
 Shape Shape::execute(ClipperLib::PolyFillType pft) const
 {
     ClipperLib::Paths ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     clipper.Execute(ClipperLib::ctXor, ret, pft);
     return Shape{ std::move(ret) };
@@ -453,8 +603,10 @@ Shape Shape::getOutsidePolygons() const
     }
 
     Shape ret;
-    ClipperLib::Clipper clipper(clipper_init);
-    ClipperLib::PolyTree poly_tree;
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
+    auto poly_tree_lease = ClipperPool::polyTree();
+    ClipperLib::PolyTree& poly_tree = *poly_tree_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     clipper.Execute(ClipperLib::ctUnion, poly_tree);
 
@@ -606,7 +758,8 @@ Shape Shape::removePolygon(const Shape& to_be_removed, int same_distance) const
 Shape Shape::processEvenOdd(ClipperLib::PolyFillType poly_fill_type) const
 {
     ClipperLib::Paths ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     clipper.Execute(ClipperLib::ctUnion, ret, poly_fill_type);
     return Shape{ std::move(ret) };
@@ -715,8 +868,10 @@ double Shape::area() const
 std::vector<SingleShape> Shape::splitIntoParts(bool union_all) const
 {
     std::vector<SingleShape> ret;
-    ClipperLib::Clipper clipper(clipper_init);
-    ClipperLib::PolyTree result_poly_tree;
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
+    auto result_poly_tree_lease = ClipperPool::polyTree();
+    ClipperLib::PolyTree& result_poly_tree = *result_poly_tree_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     if (union_all)
     {
@@ -750,8 +905,10 @@ void Shape::splitIntoPartsProcessPolyTreeNode(ClipperLib::PolyNode* node, std::v
 std::vector<Shape> Shape::sortByNesting() const
 {
     std::vector<Shape> ret;
-    ClipperLib::Clipper clipper(clipper_init);
-    ClipperLib::PolyTree result_poly_tree;
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
+    auto result_poly_tree_lease = ClipperPool::polyTree();
+    ClipperLib::PolyTree& result_poly_tree = *result_poly_tree_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     clipper.Execute(ClipperLib::ctUnion, result_poly_tree);
 
@@ -777,8 +934,10 @@ PartsView Shape::splitIntoPartsView(bool union_all)
 {
     Shape reordered;
     PartsView parts_view(*this);
-    ClipperLib::Clipper clipper(clipper_init);
-    ClipperLib::PolyTree result_poly_tree;
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
+    auto result_poly_tree_lease = ClipperPool::polyTree();
+    ClipperLib::PolyTree& result_poly_tree = *result_poly_tree_lease;
     addPaths(clipper, ClipperLib::ptSubject);
     if (union_all)
     {
@@ -874,7 +1033,8 @@ void Shape::simplify(ClipperLib::PolyFillType fill_type)
 
     // This is the actual content from clipper.cpp::SimplifyPolygons, but rewritten here in order
     // to avoid having to put all the polygons in a transitory list
-    ClipperLib::Clipper clipper;
+    auto clipper_lease = ClipperPool::clipper();
+    ClipperLib::Clipper& clipper = *clipper_lease;
     ClipperLib::Paths ret;
     clipper.StrictlySimple(true);
     addPaths(clipper, ClipperLib::ptSubject);
@@ -4,6 +4,7 @@
 #include "infill.h"
 
 #include <algorithm> //For std::sort.
+#include <cmath>
 #include <functional>
 #include <numbers>
 #include <unordered_set>
@@ -437,29 +438,42 @@ void Infill::generateLightningInfill(const std::shared_ptr<LightningLayer>& tree
 
 void Infill::generateConcentricInfill(std::vector<VariableWidthLines>& toolpaths, const Settings& settings)
 {
-    const coord_t min_area = infill_line_width_ * infill_line_width_;
+    if (inner_contour_.area() < infill_line_width_ * infill_line_width_) // So small that it's inconsequential.
+    {
+        return;
+    }
 
-    Shape current_inset = inner_contour_;
-    Simplify simplifier(settings);
-    while (true)
+    // All rings come from one skeletal trapezoidation of the area, with beads as wide as the line distance, so that their centers are a line distance apart.
+    // Ring k then lies at k line distances minus half a line width from the contour, where the loop of one wall at a time that this replaces put it.
+    // That loop made a new skeleton for every ring, so its time grew with the area times the number of rings.
+    const coord_t half_spacing_offset = (infill_line_width_ - line_distance_) / 2;
+    const Shape area = inner_contour_.offset(half_spacing_offset);
+    const AABB bounding_box(area);
+    const coord_t max_radius = std::min(bounding_box.max_.X - bounding_box.min_.X, bounding_box.max_.Y - bounding_box.min_.Y) / 2;
+    const size_t ring_count = static_cast<size_t>(std::max<coord_t>(0, max_radius / line_distance_)) + 2; // Enough to fill the widest part, Arachne stops when it's full.
+
+    constexpr coord_t wall_0_inset = 0; // Don't apply any outer wall inset for these. That's just for the outer wall.
+    WallToolPaths wall_toolpaths(area, line_distance_, ring_count, wall_0_inset, settings, 0, SectionType::CONCENTRIC_INFILL); // FIXME: @jellespijker pass the correct layer
+    const std::vector<VariableWidthLines>& rings = wall_toolpaths.getToolPaths();
+
+    // The beads are as wide as the spacing between them, while the lines are printed as wide as the infill lines.
+    // Each ring is kept as a separate bin with inset index 0, like every ring of the loop was, so that they are ordered the same way.
+    const double width_ratio = static_cast<double>(infill_line_width_) / static_cast<double>(line_distance_);
+    for (const VariableWidthLines& ring : rings)
     {
-        // If line_distance is 0, start from the same contour as the previous line, except where the previous line closed up the shape.
-        // So we add the whole nominal line width first (to allow lines to be closer together than 1 line width if the line distance is smaller) and then subtract line_distance.
-        current_inset = current_inset.offset(infill_line_width_ - line_distance_);
-        current_inset = simplifier.polygon(current_inset); // Many insets lead to increasingly detailed shapes. Simplify to speed up processing.
-        if (current_inset.area() < min_area) // So small that it's inconsequential. Stop here.
+        if (ring.empty())
         {
-            break;
+            continue;
+        }
+        VariableWidthLines& lines = toolpaths.emplace_back(ring);
+        for (ExtrusionLine& line : lines)
+        {
+            line.inset_idx_ = 0;
+            for (ExtrusionJunction& junction : line.junctions_)
+            {
+                junction.w_ = std::llrint(static_cast<double>(junction.w_) * width_ratio);
+            }
         }
-
-        constexpr size_t inset_wall_count = 1; // 1 wall at a time.
-        constexpr coord_t wall_0_inset = 0; // Don't apply any outer wall inset for these. That's just for the outer wall.
-        WallToolPaths wall_toolpaths(current_inset, infill_line_width_, inset_wall_count, wall_0_inset, settings, 0, SectionType::CONCENTRIC_INFILL); // FIXME: @jellespijker pass
-                                                                                                                                                      // the correct layer
-        const std::vector<VariableWidthLines> inset_paths = wall_toolpaths.getToolPaths();
-        toolpaths.insert(toolpaths.end(), inset_paths.begin(), inset_paths.end());
-
-        current_inset = wall_toolpaths.getInnerContour();
     }
 }
 
@@ -558,6 +572,13 @@ void Infill::addLineInfill(
 {
     assert(! connect_lines_ && "connectLines() should add the infill lines, not addLineInfill");
 
+    size_t max_segment_count = 0;
+    for (const std::vector<coord_t>& crossings : cut_list)
+    {
+        max_segment_count += crossings.size() / 2;
+    }
+    result.reserve(result.size() + max_segment_count);
+
     unsigned int scanline_idx = 0;
     for (coord_t x = scanline_min_idx * line_distance + shift; x < boundary.max_.X; x += line_distance)
     {
@@ -662,7 +683,8 @@ void Infill::generateLinearBasedInfill(
     int scanline_min_idx = computeScanSegmentIdx(boundary.min_.X - shift, line_distance);
     int line_count = computeScanSegmentIdx(boundary.max_.X - shift, line_distance) + 1 - scanline_min_idx;
 
-    std::vector<std::vector<coord_t>> cut_list(line_count); // mapping from scanline to all intersections with polygon segments
+    // Only one of the two data structures below is used, depending on whether the lines get connected, so the other is left empty.
+    std::vector<std::vector<coord_t>> cut_list(connect_lines_ ? 0 : line_count); // mapping from scanline to all intersections with polygon segments
 
     // When we find crossings, keep track of which crossing belongs to which scanline and to which polygon line segment.
     // Then we can later join two crossings together to form lines and still know what polygon line segments that infill line connected to.
@@ -687,9 +709,9 @@ void Infill::generateLinearBasedInfill(
     std::vector<std::vector<Crossing>> crossings_per_scanline; // For each scanline, a list of crossings.
     const int min_scanline_index = computeScanSegmentIdx(boundary.min_.X - shift, line_distance) + 1;
     const int max_scanline_index = computeScanSegmentIdx(boundary.max_.X - shift, line_distance) + 1;
-    crossings_per_scanline.resize(max_scanline_index - min_scanline_index);
     if (connect_lines_)
     {
+        crossings_per_scanline.resize(max_scanline_index - min_scanline_index);
         crossings_on_line_.resize(outline.size()); // One for each polygon.
     }
 
@@ -739,11 +761,17 @@ void Infill::generateLinearBasedInfill(
             {
                 const int x = scanline_idx * line_distance + shift;
                 const int y = p1.Y + (p0.Y - p1.Y) * (x - p1.X) / (p0.X - p1.X);
-                assert(scanline_idx - scanline_min_idx >= 0 && scanline_idx - scanline_min_idx < int(cut_list.size()) && "reading infill cutlist index out of bounds!");
-                cut_list[scanline_idx - scanline_min_idx].push_back(y);
                 Point2LL scanline_linesegment_intersection(x, y);
                 zigzag_connector_processor.registerScanlineSegmentIntersection(scanline_linesegment_intersection, scanline_idx, line_distance / 4);
-                crossings_per_scanline[scanline_idx - min_scanline_index].emplace_back(scanline_linesegment_intersection, poly_idx, point_idx);
+                if (connect_lines_)
+                {
+                    crossings_per_scanline[scanline_idx - min_scanline_index].emplace_back(scanline_linesegment_intersection, poly_idx, point_idx);
+                }
+                else
+                {
+                    assert(scanline_idx - scanline_min_idx >= 0 && scanline_idx - scanline_min_idx < int(cut_list.size()) && "reading infill cutlist index out of bounds!");
+                    cut_list[scanline_idx - scanline_min_idx].push_back(y);
+                }
             }
             zigzag_connector_processor.registerVertex(p1);
             p0 = p1;
@@ -772,7 +800,7 @@ void Infill::generateLinearBasedInfill(
                     continue;
                 }
                 InfillLineSegment* new_segment
-                    = new InfillLineSegment(unrotated_first, first.vertex_index_, first.polygon_index_, unrotated_second, second.vertex_index_, second.polygon_index_);
+                    = &line_segments_.emplace_back(unrotated_first, first.vertex_index_, first.polygon_index_, unrotated_second, second.vertex_index_, second.polygon_index_);
                 // Put the same line segment in the data structure twice: Once for each of the polygon line segment that it crosses.
                 crossings_on_line_[first.polygon_index_][first.vertex_index_].push_back(new_segment);
                 crossings_on_line_[second.polygon_index_][second.vertex_index_].push_back(new_segment);
@@ -848,18 +876,9 @@ void Infill::resolveIntersection(const coord_t at_distance, const Point2LL& inte
 void Infill::connectLines(OpenLinesSet& result_lines)
 {
     UnionFind<InfillLineSegment*> connected_lines; // Keeps track of which lines are connected to which.
-    for (const std::vector<std::vector<InfillLineSegment*>>& crossings_on_polygon : crossings_on_line_)
+    for (InfillLineSegment& infill_line : line_segments_) // So far these are exactly the lines in crossings_on_line_, each once.
     {
-        for (const std::vector<InfillLineSegment*>& crossings_on_polygon_segment : crossings_on_polygon)
-        {
-            for (InfillLineSegment* infill_line : crossings_on_polygon_segment)
-            {
-                if (connected_lines.find(infill_line) == (size_t)-1)
-                {
-                    connected_lines.add(infill_line); // Put every line in there as a separate set.
-                }
-            }
-        }
+        connected_lines.add(&infill_line); // Put every line in there as a separate set.
     }
 
     const auto half_line_distance_squared = (line_distance_ * line_distance_) / 4;
@@ -892,7 +911,7 @@ void Infill::connectLines(OpenLinesSet& result_lines)
                     const bool choose_right = (right_hand_side->start_segment_ == vertex_index && right_hand_side->start_polygon_ == polygon_index);
                     const Point2LL left_hand_point = choose_left ? left_hand_side->start_ : left_hand_side->end_;
                     const Point2LL right_hand_point = choose_right ? right_hand_side->start_ : right_hand_side->end_;
-                    return vSize(left_hand_point - vertex_before) < vSize(right_hand_point - vertex_before);
+                    return vSize2(left_hand_point - vertex_before) < vSize2(right_hand_point - vertex_before);
                 });
 
             for (InfillLineSegment* crossing : crossings_on_polygon_segment)
@@ -941,7 +960,7 @@ void Infill::connectLines(OpenLinesSet& result_lines)
                         }
 
                         // A connecting line between them.
-                        new_segment = new InfillLineSegment(previous_point, vertex_index, polygon_index, next_point, vertex_index, polygon_index);
+                        new_segment = &line_segments_.emplace_back(previous_point, vertex_index, polygon_index, next_point, vertex_index, polygon_index);
                         new_segment->altered_start_ = previous_point;
                         new_segment->altered_end_ = next_point;
                         new_segment->previous_ = previous_segment;
@@ -971,8 +990,8 @@ void Infill::connectLines(OpenLinesSet& result_lines)
                 }
                 else
                 {
-                    new_segment
-                        = new InfillLineSegment(previous_side, vertex_index, polygon_index, vertex_after, (vertex_index + 1) % inner_contour_[polygon_index].size(), polygon_index);
+                    new_segment = &line_segments_
+                                       .emplace_back(previous_side, vertex_index, polygon_index, vertex_after, (vertex_index + 1) % inner_contour_[polygon_index].size(), polygon_index);
                     (choose_side ? previous_segment->previous_ : previous_segment->next_) = new_segment;
                     new_segment->previous_ = previous_segment;
                     previous_segment = new_segment;
@@ -1008,7 +1027,6 @@ void Infill::connectLines(OpenLinesSet& result_lines)
 
         // Now go along the linked list of infill lines and output the infill lines to the actual result.
         OpenPolyline& result_line = result_lines.newLine();
-        InfillLineSegment* old_line = current_infill_line;
         if (current_infill_line->previous_)
         {
             current_infill_line->swapDirection();
@@ -1016,10 +1034,8 @@ void Infill::connectLines(OpenLinesSet& result_lines)
         current_infill_line->appendTo(result_line);
         previous_vertex = current_infill_line->end_;
         current_infill_line = current_infill_line->next_;
-        delete old_line;
         while (current_infill_line)
         {
-            old_line = current_infill_line; // We'll delete this after we've traversed to the next line.
             if (previous_vertex != current_infill_line->start_)
             {
                 current_infill_line->swapDirection();
@@ -1029,11 +1045,11 @@ void Infill::connectLines(OpenLinesSet& result_lines)
             current_infill_line->appendTo(result_line, polyline_break);
             current_infill_line = current_infill_line->next_;
             previous_vertex = next_vertex;
-            delete old_line;
         }
 
         completed_groups.insert(group);
     }
+    line_segments_.clear();
 }
 
 bool Infill::InfillLineSegment::operator==(const InfillLineSegment& other) const
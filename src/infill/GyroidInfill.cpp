@@ -4,6 +4,7 @@
 #include "infill/GyroidInfill.h"
 
 #include <numbers>
+#include <vector>
 
 #include "geometry/OpenPolyline.h"
 #include "geometry/Polygon.h"
@@ -14,6 +15,39 @@
 namespace cura
 {
 
+namespace
+{
+
+/*!
+ * Whether a point is inside or on the border of the outline, like
+ * Shape::inside.
+ *
+ * The pattern is tested point by point against the outline, and most polygons
+ * of an infill area are nowhere near most of those points. Polygons whose
+ * bounding box doesn't contain the point can't contain it, so they are skipped.
+ * \param polygon_boxes The bounding box of each polygon of the outline.
+ */
+bool insideOutline(const Shape& outline, const std::vector<AABB>& polygon_boxes, const Point2LL& point)
+{
+    int poly_count_inside = 0;
+    for (size_t poly_idx = 0; poly_idx < outline.size(); poly_idx++)
+    {
+        if (! polygon_boxes[poly_idx].contains(point))
+        {
+            continue;
+        }
+        const int is_inside_this_poly = ClipperLib::PointInPolygon(point, outline[poly_idx].getPoints());
+        if (is_inside_this_poly == -1)
+        {
+            return true;
+        }
+        poly_count_inside += is_inside_this_poly;
+    }
+    return (poly_count_inside % 2) == 1;
+}
+
+} // namespace
+
 GyroidInfill::GyroidInfill()
 {
 }
@@ -28,6 +62,12 @@ void GyroidInfill::generateTotalGyroidInfill(OpenLinesSet& result_lines, bool zi
     // kudos to the author of the Slic3r implementation equation code, the equation code here is based on that
 
     const AABB aabb(in_outline);
+    std::vector<AABB> polygon_boxes;
+    polygon_boxes.reserve(in_outline.size());
+    for (const Polygon& poly : in_outline)
+    {
+        polygon_boxes.emplace_back(poly);
+    }
 
     int pitch = line_distance * 2.41; // this produces similar density to the "line" infill pattern
     int num_steps = 4;
@@ -78,7 +118,7 @@ void GyroidInfill::generateTotalGyroidInfill(OpenLinesSet& result_lines, bool zi
                 for (unsigned i = 0; i < num_coords; ++i)
                 {
                     Point2LL current(x + ((num_columns & 1) ? odd_line_coords[i] : even_line_coords[i]) / 2 + pitch, y + (coord_t)(i * step));
-                    bool current_inside = in_outline.inside(current, true);
+                    bool current_inside = insideOutline(in_outline, polygon_boxes, current);
                     if (! is_first_point)
                     {
                         if (last_inside && current_inside)
@@ -170,7 +210,7 @@ void GyroidInfill::generateTotalGyroidInfill(OpenLinesSet& result_lines, bool zi
                 for (unsigned i = 0; i < num_coords; ++i)
                 {
                     Point2LL current(x + (coord_t)(i * step), y + ((num_rows & 1) ? odd_line_coords[i] : even_line_coords[i]) / 2);
-                    bool current_inside = in_outline.inside(current, true);
+                    bool current_inside = insideOutline(in_outline, polygon_boxes, current);
                     if (! is_first_point)
                     {
                         if (last_inside && current_inside)
@@ -5,6 +5,9 @@
 #define STB_IMAGE_IMPLEMENTATION // needed in order to enable the implementation of libs/std_image.h
 #include "infill/ImageBasedDensityProvider.h"
 
+#include <map>
+#include <mutex>
+
 #include <stb_image.h>
 
 #include <spdlog/spdlog.h>
@@ -18,13 +21,21 @@ namespace cura
 static constexpr bool diagonal = true;
 static constexpr bool straight = false;
 
-ImageBasedDensityProvider::ImageBasedDensityProvider(const std::string filename, const AABB model_aabb)
+std::shared_ptr<const ImageBasedDensityProvider::SummedAreaTable> ImageBasedDensityProvider::loadImage(const std::string& filename)
 {
+    static std::mutex cache_mutex;
+    static std::map<std::string, std::weak_ptr<const SummedAreaTable>> cache;
+
+    std::lock_guard lock(cache_mutex);
+    if (std::shared_ptr<const SummedAreaTable> cached = cache[filename].lock())
+    {
+        return cached;
+    }
+
     int desired_channel_count = 0; // keep original amount of channels
     int img_x, img_y, img_z; // stbi requires pointer to int rather than to coord_t
-    image = stbi_load(filename.c_str(), &img_x, &img_y, &img_z, desired_channel_count);
-    image_size = Point3LL(img_x, img_y, img_z);
-    if (! image)
+    unsigned char* pixels = stbi_load(filename.c_str(), &img_x, &img_y, &img_z, desired_channel_count);
+    if (! pixels)
     {
         const char* reason = "[unknown reason]";
         if (stbi_failure_reason())
@@ -34,6 +45,40 @@ ImageBasedDensityProvider::ImageBasedDensityProvider(const std::string filename,
         spdlog::error("Cannot load image {}: {}", filename, reason);
         std::exit(-1);
     }
+
+    auto table = std::make_shared<SummedAreaTable>();
+    table->image_size = Point3LL(img_x, img_y, img_z);
+    const size_t row_size = img_x + 1;
+    table->sums.assign(row_size * (img_y + 1), 0);
+    for (int y = 0; y < img_y; y++)
+    {
+        const unsigned char* row = pixels + size_t(img_y - 1 - y) * img_x * img_z; // The image is stored top row first.
+        uint64_t row_total = 0;
+        for (int x = 0; x < img_x; x++)
+        {
+            for (int z = 0; z < img_z; z++)
+            {
+                row_total += row[x * img_z + z];
+            }
+            table->sums[(y + 1) * row_size + x + 1] = table->sums[y * row_size + x + 1] + row_total;
+        }
+    }
+    stbi_image_free(pixels);
+
+    cache[filename] = table;
+    return table;
+}
+
+uint64_t ImageBasedDensityProvider::SummedAreaTable::total(coord_t min_x, coord_t min_y, coord_t max_x, coord_t max_y) const
+{
+    const size_t row_size = image_size.x_ + 1;
+    return sums[(max_y + 1) * row_size + max_x + 1] - sums[min_y * row_size + max_x + 1] - sums[(max_y + 1) * row_size + min_x] + sums[min_y * row_size + min_x];
+}
+
+ImageBasedDensityProvider::ImageBasedDensityProvider(const std::string filename, const AABB model_aabb)
+    : image(loadImage(filename))
+    , image_size(image->image_size)
+{
     { // compute aabb
         Point2LL middle = model_aabb.getMiddle();
         Point2LL model_aabb_size = model_aabb.max_ - model_aabb.min_;
@@ -57,10 +102,6 @@ ImageBasedDensityProvider::ImageBasedDensityProvider(const std::string filename,
 
 ImageBasedDensityProvider::~ImageBasedDensityProvider()
 {
-    if (image)
-    {
-        stbi_image_free(image);
-    }
 }
 
 double ImageBasedDensityProvider::operator()(const AABB3D& query_cube) const
@@ -68,30 +109,24 @@ double ImageBasedDensityProvider::operator()(const AABB3D& query_cube) const
     AABB query_box(Point2LL(query_cube.min_.x_, query_cube.min_.y_), Point2LL(query_cube.max_.x_, query_cube.max_.y_));
     Point2LL img_min = (query_box.min_ - print_aabb.min_ - Point2LL(1, 1)) * image_size.x_ / (print_aabb.max_.X - print_aabb.min_.X);
     Point2LL img_max = (query_box.max_ - print_aabb.min_ + Point2LL(1, 1)) * image_size.y_ / (print_aabb.max_.Y - print_aabb.min_.Y);
-    long total_lightness = 0;
-    int value_count = 0;
-    for (int x = std::max((coord_t)0, img_min.X); x <= std::min((coord_t)image_size.x_ - 1, img_max.X); x++)
+    const coord_t min_x = std::max((coord_t)0, img_min.X);
+    const coord_t min_y = std::max((coord_t)0, img_min.Y);
+    const coord_t max_x = std::min((coord_t)image_size.x_ - 1, img_max.X);
+    const coord_t max_y = std::min((coord_t)image_size.y_ - 1, img_max.Y);
+    uint64_t total_lightness;
+    int64_t value_count;
+    if (min_x <= max_x && min_y <= max_y)
     {
-        for (int y = std::max((coord_t)0, img_min.Y); y <= std::min((coord_t)image_size.y_ - 1, img_max.Y); y++)
-        {
-            for (int z = 0; z < image_size.z_; z++)
-            {
-                total_lightness += image[((image_size.y_ - 1 - y) * image_size.x_ + x) * image_size.z_ + z];
-                value_count++;
-            }
-        }
+        total_lightness = image->total(min_x, min_y, max_x, max_y);
+        value_count = (max_x - min_x + 1) * (max_y - min_y + 1) * image_size.z_;
     }
-    if (value_count == 0)
+    else
     { // triangle falls outside of image or in between pixels, so we return the closest pixel
         Point2LL closest_pixel = (img_min + img_max) / 2;
         closest_pixel.X = std::max((coord_t)0, std::min((coord_t)image_size.x_ - 1, (coord_t)closest_pixel.X));
         closest_pixel.Y = std::max((coord_t)0, std::min((coord_t)image_size.y_ - 1, (coord_t)closest_pixel.Y));
-        assert(total_lightness == 0);
-        for (int z = 0; z < image_size.z_; z++)
-        {
-            total_lightness += image[((image_size.y_ - 1 - closest_pixel.Y) * image_size.x_ + closest_pixel.X) * image_size.z_ + z];
-            value_count++;
-        }
+        total_lightness = image->total(closest_pixel.X, closest_pixel.Y, closest_pixel.X, closest_pixel.Y);
+        value_count = image_size.z_;
     }
     return 1.0 - ((double)total_lightness) / value_count / 255.0;
 }
@@ -3,6 +3,7 @@
 
 #include "infill/LightningDistanceField.h" //Class we're implementing.
 
+#include "utils/ShapeCoordinates.h" //To find the closest point on the outline for each of the dots.
 #include "utils/polygonUtils.h" //For spreadDotsArea helper function.
 
 namespace cura
@@ -18,9 +19,10 @@ LightningDistanceField::LightningDistanceField(const coord_t& radius, const Shap
     , current_overhang_(current_overhang)
 {
     std::vector<Point2LL> regular_dots = PolygonUtils::spreadDotsArea(current_overhang, cell_size_);
+    const ShapeCoordinates outline_coordinates(current_outline);
     for (const auto& p : regular_dots)
     {
-        const ClosestPointPolygon cpp = PolygonUtils::findClosest(p, current_outline);
+        const ClosestPointPolygon cpp = outline_coordinates.findClosest(p);
         const coord_t dist_to_boundary = vSize(p - cpp.p());
         unsupported_points_.emplace_back(p, dist_to_boundary);
     }
@@ -4,10 +4,12 @@
 #include "infill/LightningGenerator.h"
 
 #include "ExtruderTrain.h"
+#include "infill/LightningDistanceField.h"
 #include "infill/LightningLayer.h"
 #include "infill/LightningTreeNode.h"
 #include "sliceDataStorage.h"
 #include "utils/SparsePointGridInclusive.h"
+#include "utils/ThreadPool.h"
 #include "utils/linearAlg2D.h"
 
 /* Possible future tasks/optimizations,etc.:
@@ -37,34 +39,46 @@ LightningGenerator::LightningGenerator(const SliceMeshStorage& mesh)
     prune_length = layer_thickness * std::tan(infill_extruder.settings_.get<AngleRadians>("lightning_infill_prune_angle"));
     straightening_max_distance = layer_thickness * std::tan(infill_extruder.settings_.get<AngleRadians>("lightning_infill_straightening_angle"));
 
-    generateInitialInternalOverhangs(mesh);
-    generateTrees(mesh);
+    const std::vector<Shape> infill_outlines = computeInfillOutlines(mesh);
+    generateInitialInternalOverhangs(infill_outlines);
+    generateTrees(infill_outlines);
 }
 
-void LightningGenerator::generateInitialInternalOverhangs(const SliceMeshStorage& mesh)
+std::vector<Shape> LightningGenerator::computeInfillOutlines(const SliceMeshStorage& mesh)
 {
-    overhang_per_layer.resize(mesh.layers.size());
     const auto infill_wall_line_count = static_cast<coord_t>(mesh.settings.get<size_t>("infill_wall_line_count"));
     const auto infill_line_width = mesh.settings.get<coord_t>("infill_line_width");
     const coord_t infill_wall_offset = -infill_wall_line_count * infill_line_width;
 
-    Shape infill_area_above;
-    // Iterate from top to bottom, to subtract the overhang areas above from the overhang areas on the layer below, to get only overhang in the top layer where it is overhanging.
-    for (int layer_nr = mesh.layers.size() - 1; layer_nr >= 0; layer_nr--)
-    {
-        const SliceLayer& current_layer = mesh.layers[layer_nr];
-        Shape infill_area_here;
-        for (auto& part : current_layer.parts)
+    std::vector<Shape> infill_outlines(mesh.layers.size());
+    cura::parallel_for<size_t>(
+        0,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
         {
-            infill_area_here.push_back(part.getOwnInfillArea().offset(infill_wall_offset));
-        }
-
-        // Remove the part of the infill area that is already supported by the walls.
-        Shape overhang = infill_area_here.offset(-wall_supporting_radius).difference(infill_area_above);
+            for (const SliceLayerPart& part : mesh.layers[layer_nr].parts)
+            {
+                infill_outlines[layer_nr].push_back(part.getOwnInfillArea().offset(infill_wall_offset));
+            }
+        });
+    return infill_outlines;
+}
 
-        overhang_per_layer[layer_nr] = overhang;
-        infill_area_above = std::move(infill_area_here);
-    }
+void LightningGenerator::generateInitialInternalOverhangs(const std::vector<Shape>& infill_outlines)
+{
+    overhang_per_layer.resize(infill_outlines.size());
+
+    // Subtract the infill areas above from the overhang areas on the layer below, to get only overhang in the top layer where it is overhanging.
+    // Every layer only depends on the infill area of the layer above it, so the layers can be computed in parallel.
+    cura::parallel_for<size_t>(
+        0,
+        infill_outlines.size(),
+        [&](const size_t layer_nr)
+        {
+            // Remove the part of the infill area that is already supported by the walls.
+            const Shape overhang = infill_outlines[layer_nr].offset(-wall_supporting_radius);
+            overhang_per_layer[layer_nr] = layer_nr + 1 < infill_outlines.size() ? overhang.difference(infill_outlines[layer_nr + 1]) : overhang;
+        });
 }
 
 const LightningLayer& LightningGenerator::getTreesForLayer(const size_t& layer_id) const
@@ -73,56 +87,59 @@ const LightningLayer& LightningGenerator::getTreesForLayer(const size_t& layer_i
     return lightning_layers[layer_id];
 }
 
-void LightningGenerator::generateTrees(const SliceMeshStorage& mesh)
+void LightningGenerator::generateTrees(const std::vector<Shape>& infill_outlines)
 {
-    lightning_layers.resize(mesh.layers.size());
-    const auto infill_wall_line_count = static_cast<coord_t>(mesh.settings.get<size_t>("infill_wall_line_count"));
-    const auto infill_line_width = mesh.settings.get<coord_t>("infill_line_width");
-    const coord_t infill_wall_offset = -infill_wall_line_count * infill_line_width;
-
-    std::vector<Shape> infill_outlines;
-    infill_outlines.insert(infill_outlines.end(), mesh.layers.size(), Shape());
+    lightning_layers.resize(infill_outlines.size());
 
-    // For-each layer from top to bottom:
-    for (int layer_id = mesh.layers.size() - 1; layer_id >= 0; layer_id--)
+    // What can be prepared for a layer before the trees have propagated to it.
+    struct PreparedLayer
     {
-        for (const auto& part : mesh.layers[layer_id].parts)
-        {
-            infill_outlines[layer_id].push_back(part.getOwnInfillArea().offset(infill_wall_offset));
-        }
-    }
-
-    // For various operations its beneficial to quickly locate nearby features on the polygon:
-    const size_t top_layer_id = mesh.layers.size() - 1;
-    auto outlines_locator_ptr = PolygonUtils::createLocToLineGrid(infill_outlines[top_layer_id], locator_cell_size);
-
-    // For-each layer from top to bottom:
-    for (int layer_id = top_layer_id; layer_id >= 0; layer_id--)
-    {
-        LightningLayer& current_lightning_layer = lightning_layers[layer_id];
-        Shape& current_outlines = infill_outlines[layer_id];
-        const auto& outlines_locator = *outlines_locator_ptr;
-
-        // register all trees propagated from the previous layer as to-be-reconnected
-        std::vector<LightningTreeNodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
-
-        current_lightning_layer.generateNewTrees(overhang_per_layer[layer_id], current_outlines, outlines_locator, supporting_radius, wall_supporting_radius);
-
-        current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, outlines_locator, supporting_radius, wall_supporting_radius);
-
-        // Initialize trees for next lower layer from the current one.
-        if (layer_id == 0)
+        size_t layer_id;
+        ShapeLocator outlines_locator; //!< To quickly locate nearby features on the outlines.
+        LightningDistanceField distance_field;
+    };
+
+    // Only the propagation of the trees needs to go from top to bottom. The locators and distance fields of the layers below are prepared in parallel, ahead of the
+    // propagation front. The layers are produced and consumed from the top down.
+    const size_t top_layer_id = infill_outlines.size() - 1;
+    run_multiple_producers_ordered_consumer(
+        0,
+        infill_outlines.size(),
+        [&](const size_t index)
         {
-            return;
-        }
-        const Shape& below_outlines = infill_outlines[layer_id - 1];
-        outlines_locator_ptr = PolygonUtils::createLocToLineGrid(below_outlines, locator_cell_size);
-        const auto& below_outlines_locator = *outlines_locator_ptr;
-
-        std::vector<LightningTreeNodeSPtr>& lower_trees = lightning_layers[layer_id - 1].tree_roots;
-        for (auto& tree : current_lightning_layer.tree_roots)
+            const size_t layer_id = top_layer_id - index;
+            return std::make_unique<PreparedLayer>(
+                layer_id,
+                ShapeLocator(infill_outlines[layer_id], locator_cell_size),
+                LightningDistanceField(supporting_radius, infill_outlines[layer_id], overhang_per_layer[layer_id]));
+        },
+        [&](std::unique_ptr<PreparedLayer> prepared)
         {
-            tree->propagateToNextLayer(lower_trees, below_outlines, below_outlines_locator, prune_length, straightening_max_distance, locator_cell_size / 2);
-        }
-    }
+            const size_t layer_id = prepared->layer_id;
+            LightningLayer& current_lightning_layer = lightning_layers[layer_id];
+            const Shape& current_outlines = infill_outlines[layer_id];
+            const ShapeLocator& outlines_locator = prepared->outlines_locator;
+
+            // Initialize the trees of this layer from the layer above.
+            if (layer_id < top_layer_id)
+            {
+                for (auto& tree : lightning_layers[layer_id + 1].tree_roots)
+                {
+                    tree->propagateToNextLayer(
+                        current_lightning_layer.tree_roots,
+                        current_outlines,
+                        outlines_locator.grid(),
+                        prune_length,
+                        straightening_max_distance,
+                        locator_cell_size / 2);
+                }
+            }
+
+            // register all trees propagated from the previous layer as to-be-reconnected
+            std::vector<LightningTreeNodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
+
+            current_lightning_layer.generateNewTrees(prepared->distance_field, current_outlines, outlines_locator, supporting_radius, wall_supporting_radius);
+
+            current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, outlines_locator, supporting_radius, wall_supporting_radius);
+        });
 }
@@ -35,7 +35,7 @@ Point2LL GroundingLocation::p() const
 
 void LightningLayer::fillLocator(SparseLightningTreeNodeGrid& tree_node_locator)
 {
-    std::function<void(LightningTreeNodeSPtr)> add_node_to_locator_func = [&tree_node_locator](LightningTreeNodeSPtr node)
+    const std::function<void(const LightningTreeNodeSPtr&)> add_node_to_locator_func = [&tree_node_locator](const LightningTreeNodeSPtr& node)
     {
         tree_node_locator.insert(node->getLocation(), node);
     };
@@ -46,14 +46,12 @@ void LightningLayer::fillLocator(SparseLightningTreeNodeGrid& tree_node_locator)
 }
 
 void LightningLayer::generateNewTrees(
-    const Shape& current_overhang,
+    LightningDistanceField& distance_field,
     const Shape& current_outlines,
-    const LocToLineGrid& outlines_locator,
+    const ShapeLocator& outlines_locator,
     const coord_t supporting_radius,
     const coord_t wall_supporting_radius)
 {
-    LightningDistanceField distance_field(supporting_radius, current_outlines, current_overhang);
-
     SparseLightningTreeNodeGrid tree_node_locator(locator_cell_size);
     fillLocator(tree_node_locator);
 
@@ -82,13 +80,13 @@ void LightningLayer::generateNewTrees(
 GroundingLocation LightningLayer::getBestGroundingLocation(
     const Point2LL& unsupported_location,
     const Shape& current_outlines,
-    const LocToLineGrid& outline_locator,
+    const ShapeLocator& outline_locator,
     const coord_t supporting_radius,
     const coord_t wall_supporting_radius,
     const SparseLightningTreeNodeGrid& tree_node_locator,
     const LightningTreeNodeSPtr& exclude_tree)
 {
-    ClosestPointPolygon cpp = PolygonUtils::findClosest(unsupported_location, current_outlines);
+    ClosestPointPolygon cpp = outline_locator.findClosest(unsupported_location);
     Point2LL node_location = cpp.p();
     const coord_t within_dist = vSize(node_location - unsupported_location);
 
@@ -103,7 +101,7 @@ GroundingLocation LightningLayer::getBestGroundingLocation(
         {
             auto candidate_sub_tree = candidate_wptr.lock();
             if ((candidate_sub_tree && candidate_sub_tree != exclude_tree) && ! (exclude_tree && exclude_tree->hasOffspring(candidate_sub_tree))
-                && ! PolygonUtils::polygonCollidesWithLineSegment(unsupported_location, candidate_sub_tree->getLocation(), outline_locator, &dummy))
+                && ! PolygonUtils::polygonCollidesWithLineSegment(unsupported_location, candidate_sub_tree->getLocation(), outline_locator.grid(), &dummy))
             {
                 const coord_t candidate_dist = candidate_sub_tree->getWeightedDistance(unsupported_location, supporting_radius);
                 if (candidate_dist < current_dist)
@@ -145,7 +143,7 @@ bool LightningLayer::attach(const Point2LL& unsupported_location, const Groundin
 void LightningLayer::reconnectRoots(
     std::vector<LightningTreeNodeSPtr>& to_be_reconnected_tree_roots,
     const Shape& current_outlines,
-    const LocToLineGrid& outline_locator,
+    const ShapeLocator& outline_locator,
     const coord_t supporting_radius,
     const coord_t wall_supporting_radius)
 {
@@ -154,8 +152,8 @@ void LightningLayer::reconnectRoots(
     SparseLightningTreeNodeGrid tree_node_locator(locator_cell_size);
     fillLocator(tree_node_locator);
 
-    const coord_t within_max_dist = outline_locator.getCellSize() * 2;
-    for (auto root_ptr : to_be_reconnected_tree_roots)
+    const coord_t within_max_dist = outline_locator.grid().getCellSize() * 2;
+    for (const LightningTreeNodeSPtr& root_ptr : to_be_reconnected_tree_roots)
     {
         auto old_root_it = std::find(tree_roots.begin(), tree_roots.end(), root_ptr);
 
@@ -165,7 +163,7 @@ void LightningLayer::reconnectRoots(
             if (ground_loc != root_ptr->getLocation())
             {
                 Point2LL new_root_pt;
-                if (PolygonUtils::lineSegmentPolygonsIntersection(root_ptr->getLocation(), ground_loc, current_outlines, outline_locator, new_root_pt, within_max_dist))
+                if (PolygonUtils::lineSegmentPolygonsIntersection(root_ptr->getLocation(), ground_loc, current_outlines, outline_locator.grid(), new_root_pt, within_max_dist))
                 {
                     auto new_root = LightningTreeNode::create(new_root_pt, new_root_pt);
                     root_ptr->addChild(new_root);
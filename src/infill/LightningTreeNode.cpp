@@ -94,7 +94,7 @@ void LightningTreeNode::visitBranches(const std::function<void(const Point2LL&,
 }
 
 // NOTE: Depth-first, as currently implemented.
-void LightningTreeNode::visitNodes(const std::function<void(LightningTreeNodeSPtr)>& visitor)
+void LightningTreeNode::visitNodes(const std::function<void(const LightningTreeNodeSPtr&)>& visitor)
 {
     visitor(shared_from_this());
     for (const auto& node : children_)
@@ -57,6 +57,8 @@ SierpinskiFill::SierpinskiFill(const DensityProvider& density_provider, const AA
     settleErrors();
 
     diffuseError();
+
+    compactSequence();
 }
 
 SierpinskiFill::~SierpinskiFill()
@@ -618,14 +620,26 @@ double SierpinskiFill::getSubdivisionError(std::list<SierpinskiTriangle*>::itera
 }
 
 
+void SierpinskiFill::compactSequence()
+{
+    curve_.reserve(sequence_.size());
+    for (const SierpinskiTriangle* node : sequence_)
+    {
+        curve_.emplace_back(node->straight_corner_, node->a_, node->b_, node->dir_, node->straight_corner_is_left_, node->depth_);
+    }
+    total_requested_length_ = root_.requested_length_;
+
+    sequence_.clear();
+    std::vector<SierpinskiTriangle>().swap(root_.children);
+}
+
 void SierpinskiFill::debugOutput(SVG& svg)
 {
     svg.writePolygon(aabb_.toPolygon(), SVG::Color::RED);
 
     // draw triangles
-    for (SierpinskiTriangle* node : sequence_)
+    for (const SierpinskiTriangle& triangle : curve_)
     {
-        SierpinskiTriangle& triangle = *node;
         svg.writeLine(triangle.a_, triangle.b_, SVG::Color::GRAY);
         svg.writeLine(triangle.a_, triangle.straight_corner_, SVG::Color::GRAY);
         svg.writeLine(triangle.b_, triangle.straight_corner_, SVG::Color::GRAY);
@@ -633,7 +647,7 @@ void SierpinskiFill::debugOutput(SVG& svg)
 }
 
 
-SierpinskiFill::Edge SierpinskiFill::SierpinskiTriangle::getFromEdge()
+SierpinskiFill::Edge SierpinskiFill::SierpinskiTriangle::getFromEdge() const
 {
     Edge ret;
     switch (dir_)
@@ -655,7 +669,7 @@ SierpinskiFill::Edge SierpinskiFill::SierpinskiTriangle::getFromEdge()
     return ret;
 }
 
-SierpinskiFill::Edge SierpinskiFill::SierpinskiTriangle::getToEdge()
+SierpinskiFill::Edge SierpinskiFill::SierpinskiTriangle::getToEdge() const
 {
     Edge ret;
     switch (dir_)
@@ -702,9 +716,8 @@ Polygon SierpinskiFill::generateCross() const
 {
     Polygon ret;
 
-    for (SierpinskiTriangle* max_level_it : sequence_)
+    for (const SierpinskiTriangle& triangle : curve_)
     {
-        SierpinskiTriangle& triangle = *max_level_it;
         Point2LL edge_middle = triangle.a_ + triangle.b_ + triangle.straight_corner_;
         switch (triangle.dir_)
         {
@@ -722,7 +735,7 @@ Polygon SierpinskiFill::generateCross() const
     }
 
     double realized_length = INT2MM(ret.length());
-    double requested_length = root_.requested_length_;
+    double requested_length = total_requested_length_;
     double error = (realized_length - requested_length) / requested_length;
     spdlog::debug("realized_length: {}, requested_length: {}  :: {}% error", realized_length, requested_length, 0.01 * static_cast<int>(10000 * error));
     return ret;
@@ -745,10 +758,9 @@ Polygon SierpinskiFill::generateCross(coord_t z, coord_t min_dist_to_side, coord
         return e.l + normal(e.r - e.l, from_l);
     };
 
-    SierpinskiTriangle* last_triangle = nullptr;
-    for (SierpinskiTriangle* node : sequence_)
+    const SierpinskiTriangle* last_triangle = nullptr;
+    for (const SierpinskiTriangle& triangle : curve_)
     {
-        SierpinskiTriangle& triangle = *node;
 
         /* The length of a side of the triangle is used as the period of
         repetition. That way the edges overhang by not more than 45 degrees.
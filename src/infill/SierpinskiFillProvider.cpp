@@ -42,7 +42,13 @@ Polygon SierpinskiFillProvider::generate(EFillMethod pattern, coord_t z, coord_t
         }
         else
         {
-            return fill_pattern_for_all_layers->generateCross();
+            std::call_once(
+                cross_pattern_generated_,
+                [this]()
+                {
+                    cross_pattern_ = fill_pattern_for_all_layers->generateCross();
+                });
+            return cross_pattern_;
         }
     }
     else
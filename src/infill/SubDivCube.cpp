@@ -10,6 +10,7 @@
 #include "geometry/Shape.h"
 #include "settings/types/Angle.h" //For the infill angle.
 #include "sliceDataStorage.h"
+#include "utils/ThreadPool.h"
 #include "utils/math.h"
 #include "utils/polygonUtils.h"
 
@@ -83,7 +84,22 @@ void SubDivCube::precomputeOctree(SliceMeshStorage& mesh, const Point2LL& infill
 
     rotation_matrix_ = infill_angle_mat.compose(tilt);
 
-    mesh.base_subdiv_cube = std::make_shared<SubDivCube>(mesh, center, curr_recursion_depth - 1);
+    // Every cube tests the infill areas of several layers, so gather the areas of each layer only once.
+    OctreeInput input;
+    input.layer_height = mesh.settings.get<coord_t>("layer_height");
+    input.infill_areas.resize(mesh.layers.size());
+    cura::parallel_for<size_t>(
+        0,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
+        {
+            for (const SliceLayerPart& part : mesh.layers[layer_nr].parts)
+            {
+                input.infill_areas[layer_nr].push_back(part.infill_area);
+            }
+        });
+
+    mesh.base_subdiv_cube = std::make_shared<SubDivCube>(input, center, curr_recursion_depth - 1);
 }
 
 void SubDivCube::generateSubdivisionLines(const coord_t z, OpenLinesSet& result)
@@ -148,7 +164,7 @@ void SubDivCube::generateSubdivisionLines(const coord_t z, OpenLinesSet (&direct
     }
 }
 
-SubDivCube::SubDivCube(SliceMeshStorage& mesh, Point3LL& center, size_t depth)
+SubDivCube::SubDivCube(const OctreeInput& input, Point3LL& center, size_t depth)
     : depth_(depth)
     , center_(center)
 {
@@ -162,31 +178,52 @@ SubDivCube::SubDivCube(SliceMeshStorage& mesh, Point3LL& center, size_t depth)
     }
 
     CubeProperties cube_properties = cube_properties_per_recursion_step_[depth];
-    Point3LL child_center;
     coord_t radius = double(cube_properties.height) / 4.0 + radius_addition_;
 
-    int child_nr = 0;
-    std::vector<Point3LL> rel_child_centers;
-    rel_child_centers.emplace_back(1, 1, 1); // top
-    rel_child_centers.emplace_back(-1, 1, 1); // top three
-    rel_child_centers.emplace_back(1, -1, 1);
-    rel_child_centers.emplace_back(1, 1, -1);
-    rel_child_centers.emplace_back(-1, -1, -1); // bottom
-    rel_child_centers.emplace_back(1, -1, -1); // bottom three
-    rel_child_centers.emplace_back(-1, 1, -1);
-    rel_child_centers.emplace_back(-1, -1, 1);
-    for (Point3LL rel_child_center : rel_child_centers)
+    const std::array<Point3LL, 8> rel_child_centers{
+        Point3LL(1, 1, 1), // top
+        Point3LL(-1, 1, 1), // top three
+        Point3LL(1, -1, 1),
+        Point3LL(1, 1, -1),
+        Point3LL(-1, -1, -1), // bottom
+        Point3LL(1, -1, -1), // bottom three
+        Point3LL(-1, 1, -1),
+        Point3LL(-1, -1, 1),
+    };
+    std::array<std::shared_ptr<SubDivCube>, 8> candidates;
+    const auto make_child = [&](const size_t idx)
+    {
+        Point3LL child_center = center + rotation_matrix_.apply(rel_child_centers[idx] * int32_t(cube_properties.side_length / 4));
+        if (isValidSubdivision(input, child_center, radius))
+        {
+            candidates[idx] = std::make_shared<SubDivCube>(input, child_center, depth - 1);
+        }
+    };
+    if (depth_ >= min_parallel_depth)
+    {
+        cura::parallel_for<size_t>(0, rel_child_centers.size(), make_child);
+    }
+    else
+    {
+        for (size_t idx = 0; idx < rel_child_centers.size(); idx++)
+        {
+            make_child(idx);
+        }
+    }
+
+    // Keep the children packed at the front, in the same order as before.
+    size_t child_nr = 0;
+    for (std::shared_ptr<SubDivCube>& candidate : candidates)
     {
-        child_center = center + rotation_matrix_.apply(rel_child_center * int32_t(cube_properties.side_length / 4));
-        if (isValidSubdivision(mesh, child_center, radius))
+        if (candidate != nullptr)
         {
-            children_[child_nr] = std::make_shared<SubDivCube>(mesh, child_center, depth - 1);
+            children_[child_nr] = std::move(candidate);
             child_nr++;
         }
     }
 }
 
-bool SubDivCube::isValidSubdivision(SliceMeshStorage& mesh, Point3LL& center, coord_t radius)
+bool SubDivCube::isValidSubdivision(const OctreeInput& input, Point3LL& center, coord_t radius)
 {
     coord_t distance2 = 0;
     coord_t sphere_slice_radius2; //!< squared radius of bounding sphere slice on target layer
@@ -194,7 +231,7 @@ bool SubDivCube::isValidSubdivision(SliceMeshStorage& mesh, Point3LL& center, co
     bool outside_somewhere = false;
     int inside;
     Ratio part_dist; // what percentage of the radius the target layer is away from the center along the z axis. 0 - 1
-    const coord_t layer_height = mesh.settings.get<coord_t>("layer_height");
+    const coord_t layer_height = input.layer_height;
     int bottom_layer = (center.z_ - radius) / layer_height;
     int top_layer = (center.z_ + radius) / layer_height;
     for (int test_layer = bottom_layer; test_layer <= top_layer; test_layer += 3) // steps of three. Low-hanging speed gain.
@@ -203,7 +240,7 @@ bool SubDivCube::isValidSubdivision(SliceMeshStorage& mesh, Point3LL& center, co
         sphere_slice_radius2 = radius * radius * (1.0 - (part_dist * part_dist));
         Point2LL loc(center.x_, center.y_);
 
-        inside = distanceFromPointToMesh(mesh, test_layer, loc, &distance2);
+        inside = distanceFromPointToMesh(input, test_layer, loc, &distance2);
         if (inside == 1)
         {
             inside_somewhere = true;
@@ -224,18 +261,14 @@ bool SubDivCube::isValidSubdivision(SliceMeshStorage& mesh, Point3LL& center, co
     return false;
 }
 
-coord_t SubDivCube::distanceFromPointToMesh(SliceMeshStorage& mesh, const LayerIndex layer_nr, Point2LL& location, coord_t* distance2)
+coord_t SubDivCube::distanceFromPointToMesh(const OctreeInput& input, const LayerIndex layer_nr, Point2LL& location, coord_t* distance2)
 {
-    if (layer_nr < 0 || (unsigned int)layer_nr >= mesh.layers.size()) //!< this layer is outside of valid range
+    if (layer_nr < 0 || (unsigned int)layer_nr >= input.infill_areas.size()) //!< this layer is outside of valid range
     {
-        return 2;
         *distance2 = 0;
+        return 2;
     }
-    Shape collide;
-    for (const SliceLayerPart& part : mesh.layers[layer_nr].parts)
-    {
-        collide.push_back(part.infill_area);
-    }
+    const Shape& collide = input.infill_areas[layer_nr];
 
     Point2LL centerpoint = location;
     bool inside = collide.inside(centerpoint);
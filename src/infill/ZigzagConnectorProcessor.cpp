@@ -165,12 +165,15 @@ void ZigzagConnectorProcessor::addZagConnector(std::vector<Point2LL>& points, bo
     {
         return;
     }
-    OpenPolyline polyline(points);
-    if (is_endpiece && ! connected_endpieces_)
+    const size_t point_count = (is_endpiece && ! connected_endpieces_) ? points.size() - 1 : points.size();
+
+    // Write the points straight into the result, so that the polyline is only allocated once.
+    OpenPolyline& polyline = result_.newLine();
+    polyline.reserve(point_count);
+    for (size_t point_idx = 0; point_idx < point_count; point_idx++)
     {
-        polyline.pop_back();
+        polyline.push_back(rotation_matrix_.unapply(points[point_idx]));
     }
-    addPolyline(polyline);
 }
 
 void cura::ZigzagConnectorProcessor::reset()
@@ -181,12 +184,3 @@ void cura::ZigzagConnectorProcessor::reset()
     first_connector_.clear();
     current_connector_.clear();
 }
-
-void cura::ZigzagConnectorProcessor::addPolyline(const OpenPolyline& polyline)
-{
-    result_.emplace_back(polyline);
-    for (Point2LL& p : result_.back())
-    {
-        p = rotation_matrix_.unapply(p);
-    }
-}
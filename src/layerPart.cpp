@@ -3,15 +3,19 @@
 
 #include "layerPart.h"
 
+#include <optional>
+
 #include "geometry/OpenPolyline.h"
 #include "progress/Progress.h"
 #include "settings/EnumSettings.h" //For ESurfaceMode.
 #include "settings/Settings.h"
 #include "sliceDataStorage.h"
 #include "slicer.h"
+#include "utils/AABB.h"
 #include "utils/OpenPolylineStitcher.h"
 #include "utils/Simplify.h" //Simplifying the layers after creating them.
 #include "utils/ThreadPool.h"
+#include "utils/TraceSpan.h"
 #include "fiberpath.h"
 /*
 The layer-part creation step is the first step in creating actual useful data for 3D printing.
@@ -83,30 +87,73 @@ void createLayerWithParts(const Settings& settings, SliceLayer& storageLayer, Sl
 
 void insertFiberPath(SliceMeshStorage& meshStorage, FiberPaths& fiberpath)
 {
-    for (LayerIndex layer_nr = 0; layer_nr < meshStorage.layers.size() - 1; layer_nr++)
+    if (fiberpath.paths.empty())
     {
-        SliceLayer& layer = meshStorage.layers[layer_nr];
-        size_t z_height = layer.printZ;
-        for (FiberPath& path : fiberpath.paths)
+        return;
+    }
+    fiberpath.sort(); // Build the z index before the layers start querying it in parallel.
+
+    // Bounding boxes of the fiber layers, to skip the clipping for parts that can't intersect the fiber layer at all.
+    std::vector<AABB> fiber_boxes(fiberpath.paths.size());
+    cura::parallel_for<size_t>(
+        0,
+        fiberpath.paths.size(),
+        [&fiberpath, &fiber_boxes](const size_t fiber_idx)
         {
-            size_t match_z = path.z_;
-            if (std::fabs(match_z - z_height) < (layer.thickness / 2 - 1))
+            fiber_boxes[fiber_idx] = fiberpath.getBoundingBox(fiber_idx);
+        });
+
+    cura::parallel_for<size_t>(
+        0,
+        meshStorage.layers.size(),
+        [&meshStorage, &fiberpath, &fiber_boxes](const size_t layer_nr)
+        {
+            SliceLayer& layer = meshStorage.layers[layer_nr];
+            const auto [first, last] = fiberpath.getFiberPathRange(layer.printZ, layer.thickness / 2 - 1);
+            for (size_t fiber_idx = first; fiber_idx < last; fiber_idx++)
             {
+                std::vector<SliceLayerPart*> hit_parts;
                 for (SliceLayerPart& part : layer.parts)
                 {
-                    OpenLinesSet resLines = path.paths.lineCut(part.outline);
+                    if (part.boundaryBox.hit(fiber_boxes[fiber_idx]))
+                    {
+                        hit_parts.push_back(&part);
+                    }
+                }
+                if (hit_parts.empty())
+                {
+                    continue;
+                }
+
+                // Fiber layers from a binary file are decoded here, so that only this layer's fibers are in memory.
+                OpenLinesSet decoded;
+                const OpenLinesSet& polylines = fiberpath.getPolylines(fiber_idx, decoded);
+
+                // With multiple parts, only clip each part with the pieces of the fibers near it.
+                std::optional<FiberPathGrid> grid;
+                if (hit_parts.size() > 1)
+                {
+                    const AABB& fiber_box = fiber_boxes[fiber_idx];
+                    constexpr coord_t cells_per_side = 64;
+                    const coord_t cell_size = std::max(MM2INT(1.0), std::max(fiber_box.max_.X - fiber_box.min_.X, fiber_box.max_.Y - fiber_box.min_.Y) / cells_per_side);
+                    grid.emplace(polylines, cell_size);
+                }
+                for (SliceLayerPart* part : hit_parts)
+                {
+                    // Every end of a piece of fiber is a cut, so keep the pieces as long as the outline allows.
+                    OpenLinesSet resLines = grid ? grid->getPolylinesNear(part->boundaryBox).fiberCut(part->outline) : polylines.fiberCut(part->outline);
                     if (resLines.size() > 0)
                     {
-                        part.fiberpath.push_back(resLines);
+                        part->fiberpath.push_back(resLines);
                     }
                 }
             }
-
-        }
-    }
+        });
 }
+
 void createLayerParts(SliceMeshStorage& mesh, Slicer* slicer)
 {
+    CURA_TRACE_SPAN("createLayerParts");
     const auto total_layers = slicer->layers.size();
     assert(mesh.layers.size() == total_layers);
 
@@ -118,6 +165,10 @@ void createLayerParts(SliceMeshStorage& mesh, Slicer* slicer)
             SliceLayer& layer_storage = mesh.layers[layer_nr];
             SlicerLayer& slice_layer = slicer->layers[layer_nr];
             createLayerWithParts(mesh.settings, layer_storage, &slice_layer);
+
+            // The outlines now live on in the layer parts, so the slicer's copy can go right away instead of when the whole slicer is deleted.
+            slice_layer.polygons_ = Shape();
+            slice_layer.open_polylines_ = OpenLinesSet();
         });
 
     for (LayerIndex layer_nr = total_layers - 1; layer_nr >= 0; layer_nr--)
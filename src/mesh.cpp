@@ -3,24 +3,29 @@
 
 #include "mesh.h"
 
+#include <algorithm>
+#include <cassert>
+#include <limits>
 #include <numbers>
+#include <tuple>
 
 #include <spdlog/spdlog.h>
 
 #include "utils/Point3D.h"
+#include "utils/ThreadPool.h"
+#include "utils/math.h"
 
 namespace cura
 {
 
 const int vertex_meld_distance = MM2INT(0.03);
 /*!
- * returns a hash for the location, but first divides by the vertex_meld_distance,
- * so that any point within a box of vertex_meld_distance by vertex_meld_distance would get mapped to the same hash.
+ * Quantizes a location by dividing by the vertex_meld_distance,
+ * so that any point within a box of vertex_meld_distance by vertex_meld_distance would get mapped to the same cell.
  */
-static inline uint32_t pointHash(const Point3LL& p)
+static inline int32_t meldCell(const coord_t c)
 {
-    return ((p.x_ + vertex_meld_distance / 2) / vertex_meld_distance) ^ (((p.y_ + vertex_meld_distance / 2) / vertex_meld_distance) << 10)
-         ^ (((p.z_ + vertex_meld_distance / 2) / vertex_meld_distance) << 20);
+    return static_cast<int32_t>((c + vertex_meld_distance / 2) / vertex_meld_distance);
 }
 
 Mesh::Mesh(Settings& parent)
@@ -39,34 +44,69 @@ Mesh::Mesh()
 
 void Mesh::addFace(Point3LL& v0, Point3LL& v1, Point3LL& v2)
 {
-    int vi0 = findIndexOfVertex(v0);
-    int vi1 = findIndexOfVertex(v1);
-    int vi2 = findIndexOfVertex(v2);
-    if (vi0 == vi1 || vi1 == vi2 || vi0 == vi2)
-        return; // the face has two vertices which get assigned the same location. Don't add the face.
-
-    int idx = faces_.size(); // index of face to be added
-    faces_.emplace_back();
-    MeshFace& face = faces_[idx];
-    face.vertex_index_[0] = vi0;
-    face.vertex_index_[1] = vi1;
-    face.vertex_index_[2] = vi2;
-    vertices_[face.vertex_index_[0]].connected_faces_.push_back(idx);
-    vertices_[face.vertex_index_[1]].connected_faces_.push_back(idx);
-    vertices_[face.vertex_index_[2]].connected_faces_.push_back(idx);
+    pending_corners_.push_back(v0);
+    pending_corners_.push_back(v1);
+    pending_corners_.push_back(v2);
+}
+
+void Mesh::addFaces(std::vector<Point3LL>&& corners)
+{
+    assert(corners.size() % 3 == 0);
+    if (pending_corners_.empty())
+    {
+        pending_corners_ = std::move(corners);
+    }
+    else
+    {
+        pending_corners_.insert(pending_corners_.end(), corners.begin(), corners.end());
+    }
+}
+
+void Mesh::addIndexedFaces(const std::vector<Point3LL>& vertices, const std::vector<std::array<uint32_t, 3>>& faces)
+{
+    weldPendingCorners(); // Keep the faces in the order they were added.
+
+    const size_t base = vertices_.size();
+    assert(base + vertices.size() <= static_cast<size_t>(std::numeric_limits<int>::max()));
+    vertices_.reserve(base + vertices.size());
+    for (const Point3LL& p : vertices)
+    {
+        vertices_.emplace_back(p);
+        aabb_.include(p);
+    }
+
+    faces_.reserve(faces_.size() + faces.size());
+    for (const std::array<uint32_t, 3>& corners : faces)
+    {
+        assert(corners[0] < vertices.size() && corners[1] < vertices.size() && corners[2] < vertices.size());
+        const Point3LL& p0 = vertices[corners[0]];
+        const Point3LL& p1 = vertices[corners[1]];
+        const Point3LL& p2 = vertices[corners[2]];
+        if (p0 == p1 || p1 == p2 || p0 == p2)
+        {
+            continue; // Degenerate face, which addFace would drop as well.
+        }
+
+        const int idx = faces_.size(); // index of face to be added
+        MeshFace& face = faces_.emplace_back();
+        for (size_t corner_idx = 0; corner_idx < 3; corner_idx++)
+        {
+            face.vertex_index_[corner_idx] = static_cast<int>(base + corners[corner_idx]);
+            vertices_[face.vertex_index_[corner_idx]].connected_faces_.push_back(idx);
+        }
+    }
 }
 
 void Mesh::clear()
 {
     faces_.clear();
     vertices_.clear();
-    vertex_hash_map_.clear();
+    pending_corners_.clear();
 }
 
 void Mesh::finish()
 {
-    // Finish up the mesh, clear the vertex_hash_map, as it's no longer needed from this point on and uses quite a bit of memory.
-    vertex_hash_map_.clear();
+    weldPendingCorners();
 
     // For each face, store which other face is connected with it.
     for (unsigned int i = 0; i < faces_.size(); i++)
@@ -120,23 +160,156 @@ bool Mesh::canInterlock() const
     return ! settings_.get<bool>("infill_mesh") && ! settings_.get<bool>("anti_overhang_mesh");
 }
 
-int Mesh::findIndexOfVertex(const Point3LL& v)
+void Mesh::weldPendingCorners()
 {
-    uint32_t hash = pointHash(v);
+    if (pending_corners_.empty())
+    {
+        return;
+    }
+
+    // Points are identified by id: the existing vertices come first, followed by the pending corners.
+    // Sorting the points by (cell, id) puts all candidates for welding next to each other, in order of appearance.
+    struct CellKey
+    {
+        int32_t x;
+        int32_t y;
+        int32_t z;
+        uint32_t id;
+
+        bool operator<(const CellKey& other) const
+        {
+            return std::tie(x, y, z, id) < std::tie(other.x, other.y, other.z, other.id);
+        }
+        bool sameCell(const CellKey& other) const
+        {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    const size_t existing_count = vertices_.size();
+    const size_t corner_count = pending_corners_.size();
+    const size_t point_count = existing_count + corner_count;
+    assert(point_count <= std::numeric_limits<uint32_t>::max());
+    const auto point = [&](const size_t id) -> const Point3LL&
+    {
+        return id < existing_count ? vertices_[id].p_ : pending_corners_[id - existing_count];
+    };
+
+    std::vector<CellKey> keys(point_count);
+    cura::parallel_for<size_t>(
+        0,
+        point_count,
+        [&](const size_t id)
+        {
+            const Point3LL& p = point(id);
+            keys[id] = CellKey{ meldCell(p.x_), meldCell(p.y_), meldCell(p.z_), static_cast<uint32_t>(id) };
+        },
+        4096);
+
+    // Sort blocks of keys in parallel, then merge them pairwise.
+    constexpr size_t block_size = 1 << 16;
+    const size_t block_count = round_up_divide(point_count, block_size);
+    cura::parallel_for<size_t>(
+        0,
+        block_count,
+        [&](const size_t block_idx)
+        {
+            std::sort(keys.begin() + block_idx * block_size, keys.begin() + std::min(point_count, (block_idx + 1) * block_size));
+        });
+    for (size_t width = block_size; width < point_count; width *= 2)
+    {
+        cura::parallel_for<size_t>(
+            0,
+            round_up_divide(point_count, 2 * width),
+            [&](const size_t pair_idx)
+            {
+                const size_t first = pair_idx * 2 * width;
+                const size_t middle = std::min(point_count, first + width);
+                const size_t last = std::min(point_count, first + 2 * width);
+                std::inplace_merge(keys.begin() + first, keys.begin() + middle, keys.begin() + last);
+            });
+    }
 
-    for (unsigned int idx = 0; idx < vertex_hash_map_[hash].size(); idx++)
+    // Walk each cell in order of appearance and merge every point into the first representative it is close enough to.
+    std::vector<uint32_t> representative(point_count);
+    std::vector<uint32_t> new_vertices; // Ids of the corners that become new vertices.
+    std::vector<uint32_t> cell_representatives;
+    for (size_t cell_start = 0; cell_start < point_count;)
     {
-        if ((vertices_[vertex_hash_map_[hash][idx]].p_ - v).testLength(vertex_meld_distance))
+        size_t cell_end = cell_start + 1;
+        while (cell_end < point_count && keys[cell_end].sameCell(keys[cell_start]))
         {
-            return vertex_hash_map_[hash][idx];
+            cell_end++;
         }
+
+        cell_representatives.clear();
+        for (size_t key_idx = cell_start; key_idx < cell_end; key_idx++)
+        {
+            const uint32_t id = keys[key_idx].id;
+            const Point3LL& p = point(id);
+            representative[id] = id;
+            if (id >= existing_count) // Existing vertices have been welded before, so they always stay.
+            {
+                for (const uint32_t candidate : cell_representatives)
+                {
+                    if ((point(candidate) - p).testLength(vertex_meld_distance))
+                    {
+                        representative[id] = candidate;
+                        break;
+                    }
+                }
+            }
+            if (representative[id] == id)
+            {
+                cell_representatives.push_back(id);
+                if (id >= existing_count)
+                {
+                    new_vertices.push_back(id);
+                }
+            }
+        }
+        cell_start = cell_end;
     }
-    vertex_hash_map_[hash].push_back(vertices_.size());
-    vertices_.emplace_back(v);
 
-    aabb_.include(v);
+    // Number the new vertices in order of appearance.
+    std::sort(new_vertices.begin(), new_vertices.end());
+    std::vector<int> vertex_index(point_count);
+    for (size_t id = 0; id < existing_count; id++)
+    {
+        vertex_index[id] = static_cast<int>(id);
+    }
+    vertices_.reserve(existing_count + new_vertices.size());
+    for (const uint32_t id : new_vertices)
+    {
+        vertex_index[id] = static_cast<int>(vertices_.size());
+        vertices_.emplace_back(point(id));
+        aabb_.include(point(id));
+    }
+
+    faces_.reserve(faces_.size() + corner_count / 3);
+    for (size_t corner_idx = 0; corner_idx + 2 < corner_count; corner_idx += 3)
+    {
+        const size_t id = existing_count + corner_idx;
+        const int vi0 = vertex_index[representative[id]];
+        const int vi1 = vertex_index[representative[id + 1]];
+        const int vi2 = vertex_index[representative[id + 2]];
+        if (vi0 == vi1 || vi1 == vi2 || vi0 == vi2)
+        {
+            continue; // the face has two vertices which get assigned the same location. Don't add the face.
+        }
+
+        const int idx = faces_.size(); // index of face to be added
+        MeshFace& face = faces_.emplace_back();
+        face.vertex_index_[0] = vi0;
+        face.vertex_index_[1] = vi1;
+        face.vertex_index_[2] = vi2;
+        vertices_[vi0].connected_faces_.push_back(idx);
+        vertices_[vi1].connected_faces_.push_back(idx);
+        vertices_[vi2].connected_faces_.push_back(idx);
+    }
 
-    return vertices_.size() - 1;
+    // Release the memory of the corners, as they are no longer needed from this point on.
+    pending_corners_ = std::vector<Point3LL>();
 }
 
 /*!
@@ -4,6 +4,7 @@
 #include "multiVolumes.h"
 
 #include <algorithm>
+#include <optional>
 
 #include "Application.h"
 #include "Slice.h"
@@ -12,7 +13,9 @@
 #include "settings/EnumSettings.h"
 #include "settings/types/LayerIndex.h"
 #include "slicer.h"
+#include "utils/AABB.h"
 #include "utils/OpenPolylineStitcher.h"
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -29,31 +32,70 @@ void carveMultipleVolumes(std::vector<Slicer*>& volumes)
         {
             return volume_1->mesh->settings_.get<int>("infill_mesh_order") < volume_2->mesh->settings_.get<int>("infill_mesh_order");
         });
-    for (unsigned int volume_1_idx = 1; volume_1_idx < volumes.size(); volume_1_idx++)
+
+    // The settings of the volumes don't change per layer, so find the pairs that carve each other beforehand.
+    const auto carves = [](const Slicer& volume)
+    {
+        return ! volume.mesh->settings_.get<bool>("infill_mesh") && ! volume.mesh->settings_.get<bool>("anti_overhang_mesh") && ! volume.mesh->settings_.get<bool>("support_mesh")
+            && volume.mesh->settings_.get<ESurfaceMode>("magic_mesh_surface_mode") != ESurfaceMode::SURFACE;
+    };
+    struct CarvePair
+    {
+        size_t volume_1_idx;
+        size_t volume_2_idx;
+        bool same_order; //!< Whether both have the same infill mesh order, so that they may take turns in which one is carved.
+    };
+    std::vector<CarvePair> pairs;
+    for (size_t volume_1_idx = 1; volume_1_idx < ranked_volumes.size(); volume_1_idx++)
     {
-        Slicer& volume_1 = *ranked_volumes[volume_1_idx];
-        if (volume_1.mesh->settings_.get<bool>("infill_mesh") || volume_1.mesh->settings_.get<bool>("anti_overhang_mesh") || volume_1.mesh->settings_.get<bool>("support_mesh")
-            || volume_1.mesh->settings_.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::SURFACE)
+        const Slicer& volume_1 = *ranked_volumes[volume_1_idx];
+        if (! carves(volume_1))
         {
             continue;
         }
-        for (unsigned int volume_2_idx = 0; volume_2_idx < volume_1_idx; volume_2_idx++)
+        for (size_t volume_2_idx = 0; volume_2_idx < volume_1_idx; volume_2_idx++)
         {
-            Slicer& volume_2 = *ranked_volumes[volume_2_idx];
-            if (volume_2.mesh->settings_.get<bool>("infill_mesh") || volume_2.mesh->settings_.get<bool>("anti_overhang_mesh") || volume_2.mesh->settings_.get<bool>("support_mesh")
-                || volume_2.mesh->settings_.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::SURFACE)
+            const Slicer& volume_2 = *ranked_volumes[volume_2_idx];
+            if (! carves(volume_2) || ! volume_1.mesh->getAABB().hit(volume_2.mesh->getAABB()))
             {
                 continue;
             }
-            if (! volume_1.mesh->getAABB().hit(volume_2.mesh->getAABB()))
+            pairs.push_back(CarvePair{ .volume_1_idx = volume_1_idx,
+                                       .volume_2_idx = volume_2_idx,
+                                       .same_order = volume_1.mesh->settings_.get<int>("infill_mesh_order") == volume_2.mesh->settings_.get<int>("infill_mesh_order") });
+        }
+    }
+    if (pairs.empty())
+    {
+        return;
+    }
+
+    // The layers don't depend on each other, only the order of the pairs within a layer matters.
+    cura::parallel_for<size_t>(
+        0,
+        ranked_volumes.front()->layers.size(),
+        [&](const size_t layer_nr)
+        {
+            // Carving only shrinks the outlines, so their bounding boxes from before carving remain valid to skip the pairs that don't overlap in this layer.
+            std::vector<std::optional<AABB>> boxes(ranked_volumes.size());
+            const auto box = [&](const size_t volume_idx) -> const AABB&
             {
-                continue;
-            }
-            for (LayerIndex layerNr = 0; layerNr < volume_1.layers.size(); layerNr++)
+                std::optional<AABB>& volume_box = boxes[volume_idx];
+                if (! volume_box)
+                {
+                    volume_box = AABB(ranked_volumes[volume_idx]->layers[layer_nr].polygons_);
+                }
+                return *volume_box;
+            };
+            for (const CarvePair& pair : pairs)
             {
-                SlicerLayer& layer1 = volume_1.layers[layerNr];
-                SlicerLayer& layer2 = volume_2.layers[layerNr];
-                if (alternate_carve_order && layerNr % 2 == 0 && volume_1.mesh->settings_.get<int>("infill_mesh_order") == volume_2.mesh->settings_.get<int>("infill_mesh_order"))
+                if (! box(pair.volume_1_idx).hit(box(pair.volume_2_idx)))
+                {
+                    continue;
+                }
+                SlicerLayer& layer1 = ranked_volumes[pair.volume_1_idx]->layers[layer_nr];
+                SlicerLayer& layer2 = ranked_volumes[pair.volume_2_idx]->layers[layer_nr];
+                if (alternate_carve_order && layer_nr % 2 == 0 && pair.same_order)
                 {
                     layer2.polygons_ = layer2.polygons_.difference(layer1.polygons_);
                 }
@@ -62,8 +104,7 @@ void carveMultipleVolumes(std::vector<Slicer*>& volumes)
                     layer1.polygons_ = layer1.polygons_.difference(layer2.polygons_);
                 }
             }
-        }
-    }
+        });
 }
 
 // Expand each layer a bit and then keep the extra overlapping parts that overlap with other volumes.
@@ -75,112 +116,177 @@ void generateMultipleVolumesOverlap(std::vector<Slicer*>& volumes)
         return;
     }
 
-    int offset_to_merge_other_merged_volumes = 20;
-    for (Slicer* volume : volumes)
+    const auto is_overlapped = [](const Slicer* volume)
     {
-        ClipperLib::PolyFillType fill_type = volume->mesh->settings_.get<bool>("meshfix_union_all") ? ClipperLib::pftNonZero : ClipperLib::pftEvenOdd;
+        return ! volume->mesh->settings_.get<bool>("infill_mesh") && ! volume->mesh->settings_.get<bool>("anti_overhang_mesh")
+            && ! volume->mesh->settings_.get<bool>("support_mesh");
+    };
 
-        coord_t overlap = volume->mesh->settings_.get<coord_t>("multiple_mesh_overlap");
-        if (volume->mesh->settings_.get<bool>("infill_mesh") || volume->mesh->settings_.get<bool>("anti_overhang_mesh") || volume->mesh->settings_.get<bool>("support_mesh")
-            || overlap == 0)
+    // The settings of the volumes don't change per layer, so find which volumes each volume grows into beforehand.
+    struct OverlapVolume
+    {
+        Slicer* volume;
+        ClipperLib::PolyFillType fill_type;
+        coord_t overlap;
+        std::vector<Slicer*> other_volumes; //!< The volumes that are close enough to overlap with.
+    };
+    std::vector<OverlapVolume> overlap_volumes;
+    for (Slicer* volume : volumes)
+    {
+        const coord_t overlap = volume->mesh->settings_.get<coord_t>("multiple_mesh_overlap");
+        if (! is_overlapped(volume) || overlap == 0)
         {
             continue;
         }
         AABB3D aabb(volume->mesh->getAABB());
         aabb.expandXY(overlap); // expand to account for the case where two models and their bounding boxes are adjacent along the X or Y-direction
-        for (LayerIndex layer_nr = 0; layer_nr < volume->layers.size(); layer_nr++)
+        OverlapVolume& overlap_volume = overlap_volumes.emplace_back(
+            OverlapVolume{ .volume = volume,
+                           .fill_type = volume->mesh->settings_.get<bool>("meshfix_union_all") ? ClipperLib::pftNonZero : ClipperLib::pftEvenOdd,
+                           .overlap = overlap,
+                           .other_volumes = {} });
+        for (Slicer* other_volume : volumes)
         {
-            Shape all_other_volumes;
-            for (Slicer* other_volume : volumes)
+            if (other_volume != volume && is_overlapped(other_volume) && other_volume->mesh->getAABB().hit(aabb))
             {
-                if (other_volume->mesh->settings_.get<bool>("infill_mesh") || other_volume->mesh->settings_.get<bool>("anti_overhang_mesh")
-                    || other_volume->mesh->settings_.get<bool>("support_mesh") || ! other_volume->mesh->getAABB().hit(aabb) || other_volume == volume)
-                {
-                    continue;
-                }
-                SlicerLayer& other_volume_layer = other_volume->layers[layer_nr];
-                all_other_volumes = all_other_volumes.unionPolygons(other_volume_layer.polygons_.offset(offset_to_merge_other_merged_volumes), fill_type);
+                overlap_volume.other_volumes.push_back(other_volume);
             }
-
-            SlicerLayer& volume_layer = volume->layers[layer_nr];
-            volume_layer.polygons_ = volume_layer.polygons_.unionPolygons(all_other_volumes.intersection(volume_layer.polygons_.offset(overlap / 2)), fill_type);
         }
     }
+    if (overlap_volumes.empty())
+    {
+        return;
+    }
+
+    // The layers don't depend on each other. Within a layer, a volume grows into the volumes that grew before it, so keep their order.
+    constexpr coord_t offset_to_merge_other_merged_volumes = 20;
+    cura::parallel_for<size_t>(
+        0,
+        volumes.front()->layers.size(),
+        [&](const size_t layer_nr)
+        {
+            for (const OverlapVolume& overlap_volume : overlap_volumes)
+            {
+                Shape all_other_volumes;
+                for (Slicer* other_volume : overlap_volume.other_volumes)
+                {
+                    SlicerLayer& other_volume_layer = other_volume->layers[layer_nr];
+                    all_other_volumes = all_other_volumes.unionPolygons(other_volume_layer.polygons_.offset(offset_to_merge_other_merged_volumes), overlap_volume.fill_type);
+                }
+
+                SlicerLayer& volume_layer = overlap_volume.volume->layers[layer_nr];
+                volume_layer.polygons_
+                    = volume_layer.polygons_.unionPolygons(all_other_volumes.intersection(volume_layer.polygons_.offset(overlap_volume.overlap / 2)), overlap_volume.fill_type);
+            }
+        });
 }
 
 void MultiVolumes::carveCuttingMeshes(std::vector<Slicer*>& volumes, const std::vector<Mesh>& meshes)
 {
-    for (unsigned int carving_mesh_idx = 0; carving_mesh_idx < volumes.size(); carving_mesh_idx++)
+    // The settings of the meshes don't change per layer, so find the cutting meshes and the meshes they cut beforehand.
+    struct CuttingMesh
     {
-        const Mesh& cutting_mesh = meshes[carving_mesh_idx];
-        if (! cutting_mesh.settings_.get<bool>("cutting_mesh"))
+        Slicer* volume;
+        ESurfaceMode surface_mode;
+        coord_t surface_line_width;
+    };
+    std::vector<CuttingMesh> cutting_meshes;
+    std::vector<Slicer*> carved_volumes;
+    for (size_t mesh_idx = 0; mesh_idx < volumes.size(); mesh_idx++)
+    {
+        const Mesh& mesh = meshes[mesh_idx];
+        if (mesh.settings_.get<bool>("cutting_mesh"))
         {
-            continue;
+            cutting_meshes.push_back(CuttingMesh{ .volume = volumes[mesh_idx],
+                                                  .surface_mode = mesh.settings_.get<ESurfaceMode>("magic_mesh_surface_mode"),
+                                                  .surface_line_width = mesh.settings_.get<coord_t>("wall_line_width_0") });
         }
-        Slicer& cutting_mesh_volume = *volumes[carving_mesh_idx];
-        for (LayerIndex layer_nr = 0; layer_nr < cutting_mesh_volume.layers.size(); layer_nr++)
+        // Do not apply cutting_mesh for meshes which have settings (cutting_mesh, anti_overhang_mesh, support_mesh).
+        else if (! mesh.settings_.get<bool>("anti_overhang_mesh") && ! mesh.settings_.get<bool>("support_mesh"))
         {
-            Shape& cutting_mesh_polygons = cutting_mesh_volume.layers[layer_nr].polygons_;
-            OpenLinesSet& cutting_mesh_polylines = cutting_mesh_volume.layers[layer_nr].open_polylines_;
-            Shape cutting_mesh_area_recomputed;
-            Shape* cutting_mesh_area;
-            coord_t surface_line_width = cutting_mesh.settings_.get<coord_t>("wall_line_width_0");
-            { // compute cutting_mesh_area
-                if (cutting_mesh.settings_.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::BOTH)
-                {
-                    cutting_mesh_area_recomputed = cutting_mesh_polygons.unionPolygons(cutting_mesh_polylines.offset(surface_line_width / 2));
-                    cutting_mesh_area = &cutting_mesh_area_recomputed;
-                }
-                else if (cutting_mesh.settings_.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::SURFACE)
-                {
-                    // break up polygons into polylines
-                    // they have to be polylines, because they might break up further when doing the cutting
-                    for (Polygon& poly : cutting_mesh_polygons)
+            carved_volumes.push_back(volumes[mesh_idx]);
+        }
+    }
+    if (cutting_meshes.empty())
+    {
+        return;
+    }
+
+    // The layers don't depend on each other. Within a layer, each cutting mesh only gets what the cutting meshes before it left over, so keep their order.
+    cura::parallel_for<size_t>(
+        0,
+        cutting_meshes.front().volume->layers.size(),
+        [&](const size_t layer_nr)
+        {
+            // Carving only shrinks the outlines, so their bounding boxes from before carving remain valid to skip the meshes that the cutting mesh doesn't touch.
+            std::vector<std::optional<AABB>> carved_boxes(carved_volumes.size());
+            for (const CuttingMesh& cutting_mesh : cutting_meshes)
+            {
+                Shape& cutting_mesh_polygons = cutting_mesh.volume->layers[layer_nr].polygons_;
+                OpenLinesSet& cutting_mesh_polylines = cutting_mesh.volume->layers[layer_nr].open_polylines_;
+                Shape cutting_mesh_area_recomputed;
+                Shape* cutting_mesh_area;
+                const coord_t surface_line_width = cutting_mesh.surface_line_width;
+                { // compute cutting_mesh_area
+                    if (cutting_mesh.surface_mode == ESurfaceMode::BOTH)
                     {
-                        poly.push_back(poly.front());
-                        cutting_mesh_polylines.emplace_back(poly.getPoints());
+                        cutting_mesh_area_recomputed = cutting_mesh_polygons.unionPolygons(cutting_mesh_polylines.offset(surface_line_width / 2));
+                        cutting_mesh_area = &cutting_mesh_area_recomputed;
                     }
+                    else if (cutting_mesh.surface_mode == ESurfaceMode::SURFACE)
+                    {
+                        // break up polygons into polylines
+                        // they have to be polylines, because they might break up further when doing the cutting
+                        for (Polygon& poly : cutting_mesh_polygons)
+                        {
+                            poly.push_back(poly.front());
+                            cutting_mesh_polylines.emplace_back(poly.getPoints());
+                        }
 
-                    cutting_mesh_polygons.clear();
-                    cutting_mesh_area_recomputed = cutting_mesh_polylines.offset(surface_line_width / 2);
-                    cutting_mesh_area = &cutting_mesh_area_recomputed;
-                }
-                else
-                {
-                    cutting_mesh_area = &cutting_mesh_polygons;
+                        cutting_mesh_polygons.clear();
+                        cutting_mesh_area_recomputed = cutting_mesh_polylines.offset(surface_line_width / 2);
+                        cutting_mesh_area = &cutting_mesh_area_recomputed;
+                    }
+                    else
+                    {
+                        cutting_mesh_area = &cutting_mesh_polygons;
+                    }
                 }
-            }
+                // The cut area contains the outlines and the polylines, so the meshes outside its box are neither cut nor carved.
+                const AABB cutting_box(*cutting_mesh_area);
 
-            Shape new_outlines;
-            OpenLinesSet new_polylines;
-            for (unsigned int carved_mesh_idx = 0; carved_mesh_idx < volumes.size(); carved_mesh_idx++)
-            {
-                const Mesh& carved_mesh = meshes[carved_mesh_idx];
-                // Do not apply cutting_mesh for meshes which have settings (cutting_mesh, anti_overhang_mesh, support_mesh).
-                if (carved_mesh.settings_.get<bool>("cutting_mesh") || carved_mesh.settings_.get<bool>("anti_overhang_mesh") || carved_mesh.settings_.get<bool>("support_mesh"))
+                Shape new_outlines;
+                OpenLinesSet new_polylines;
+                for (size_t carved_idx = 0; carved_idx < carved_volumes.size(); carved_idx++)
                 {
-                    continue;
-                }
-                Slicer& carved_volume = *volumes[carved_mesh_idx];
-                Shape& carved_mesh_layer = carved_volume.layers[layer_nr].polygons_;
+                    Shape& carved_mesh_layer = carved_volumes[carved_idx]->layers[layer_nr].polygons_;
+                    std::optional<AABB>& carved_box = carved_boxes[carved_idx];
+                    if (! carved_box)
+                    {
+                        carved_box = AABB(carved_mesh_layer);
+                    }
+                    if (! cutting_box.hit(*carved_box))
+                    {
+                        continue;
+                    }
 
-                Shape intersection = cutting_mesh_polygons.intersection(carved_mesh_layer);
-                new_outlines.push_back(intersection);
-                if (cutting_mesh.settings_.get<ESurfaceMode>("magic_mesh_surface_mode") != ESurfaceMode::NORMAL) // niet te geleuven
+                    Shape intersection = cutting_mesh_polygons.intersection(carved_mesh_layer);
+                    new_outlines.push_back(intersection);
+                    if (cutting_mesh.surface_mode != ESurfaceMode::NORMAL) // niet te geleuven
+                    {
+                        new_polylines.push_back(carved_mesh_layer.intersection(cutting_mesh_polylines));
+                    }
+
+                    carved_mesh_layer = carved_mesh_layer.difference(*cutting_mesh_area);
+                }
+                cutting_mesh_polygons = new_outlines.unionPolygons();
+                if (cutting_mesh.surface_mode != ESurfaceMode::NORMAL)
                 {
-                    new_polylines.push_back(carved_mesh_layer.intersection(cutting_mesh_polylines));
+                    cutting_mesh_polylines.clear();
+                    OpenPolylineStitcher::stitch(new_polylines, cutting_mesh_polylines, cutting_mesh_polygons, surface_line_width);
                 }
-
-                carved_mesh_layer = carved_mesh_layer.difference(*cutting_mesh_area);
             }
-            cutting_mesh_polygons = new_outlines.unionPolygons();
-            if (cutting_mesh.settings_.get<ESurfaceMode>("magic_mesh_surface_mode") != ESurfaceMode::NORMAL)
-            {
-                cutting_mesh_polylines.clear();
-                OpenPolylineStitcher::stitch(new_polylines, cutting_mesh_polylines, cutting_mesh_polygons, surface_line_width);
-            }
-        }
-    }
+        });
 }
 
 
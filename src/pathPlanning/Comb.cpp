@@ -79,8 +79,8 @@ Comb::Comb(
     , boundary_inside_optimal_(comb_boundary_inside_optimal) // copy the boundary, because the partsView_inside will reorder the polygons
     , parts_view_inside_minimum_(boundary_inside_minimum_.splitIntoPartsView()) // WARNING !! changes the order of boundary_inside !!
     , parts_view_inside_optimal_(boundary_inside_optimal_.splitIntoPartsView()) // WARNING !! changes the order of boundary_inside !!
-    , inside_loc_to_line_minimum_(PolygonUtils::createLocToLineGrid(boundary_inside_minimum_, comb_boundary_offset))
-    , inside_loc_to_line_optimal_(PolygonUtils::createLocToLineGrid(boundary_inside_optimal_, comb_boundary_offset))
+    , inside_locator_minimum_(boundary_inside_minimum_, comb_boundary_offset)
+    , inside_locator_optimal_(boundary_inside_optimal_, comb_boundary_offset)
     , move_inside_distance_(move_inside_distance)
 {
 }
@@ -101,13 +101,21 @@ bool Comb::calc(
     {
         return true;
     }
+    if (_start_inside && _end_inside && isDirectTravelInside(start_point, end_point))
+    {
+        comb_paths.emplace_back();
+        comb_paths.back().push_back(start_point);
+        comb_paths.back().push_back(end_point);
+        unretract_before_last_travel_move = false;
+        return true;
+    }
     const Point2LL travel_end_point_before_combing = end_point;
     // Move start and end point inside the optimal comb boundary
     size_t start_inside_poly = NO_INDEX;
-    const bool start_inside = moveInside(boundary_inside_optimal_, _start_inside, inside_loc_to_line_optimal_.get(), start_point, start_inside_poly);
+    const bool start_inside = moveInside(inside_locator_optimal_, _start_inside, start_point, start_inside_poly);
 
     size_t end_inside_poly = NO_INDEX;
-    const bool end_inside = moveInside(boundary_inside_optimal_, _end_inside, inside_loc_to_line_optimal_.get(), end_point, end_inside_poly);
+    const bool end_inside = moveInside(inside_locator_optimal_, _end_inside, end_point, end_inside_poly);
 
     size_t start_part_boundary_poly_idx = NO_INDEX; // Added initial value to stop MSVC throwing an exception in debug mode
     size_t end_part_boundary_poly_idx = NO_INDEX;
@@ -123,7 +131,7 @@ bool Comb::calc(
         comb_paths.emplace_back();
         const bool combing_succeeded = LinePolygonsCrossings::comb(
             part,
-            *inside_loc_to_line_optimal_,
+            inside_locator_optimal_.grid(),
             start_point,
             end_point,
             comb_paths.back(),
@@ -138,10 +146,10 @@ bool Comb::calc(
 
     // Move start and end point inside the minimum comb boundary
     size_t start_inside_poly_min = NO_INDEX;
-    const bool start_inside_min = moveInside(boundary_inside_minimum_, _start_inside, inside_loc_to_line_minimum_.get(), start_point, start_inside_poly_min);
+    const bool start_inside_min = moveInside(inside_locator_minimum_, _start_inside, start_point, start_inside_poly_min);
 
     size_t end_inside_poly_min = NO_INDEX;
-    const bool end_inside_min = moveInside(boundary_inside_minimum_, _end_inside, inside_loc_to_line_minimum_.get(), end_point, end_inside_poly_min);
+    const bool end_inside_min = moveInside(inside_locator_minimum_, _end_inside, end_point, end_inside_poly_min);
 
     size_t start_part_boundary_poly_idx_min{};
     size_t end_part_boundary_poly_idx_min{};
@@ -160,7 +168,7 @@ bool Comb::calc(
 
         comb_result = LinePolygonsCrossings::comb(
             part,
-            *inside_loc_to_line_minimum_,
+            inside_locator_minimum_.grid(),
             start_point,
             end_point,
             result_path,
@@ -188,8 +196,8 @@ bool Comb::calc(
 
     // Find the crossings using the minimum comb boundary, since it's guaranteed to be as close as we can get to the destination.
     // Getting as close as possible prevents exiting the polygon in the wrong direction (e.g. into a hole instead of to the outside).
-    Crossing start_crossing(start_point, start_inside_min, start_part_idx_min, start_part_boundary_poly_idx_min, boundary_inside_minimum_, *inside_loc_to_line_minimum_);
-    Crossing end_crossing(end_point, end_inside_min, end_part_idx_min, end_part_boundary_poly_idx_min, boundary_inside_minimum_, *inside_loc_to_line_minimum_);
+    Crossing start_crossing(start_point, start_inside_min, start_part_idx_min, start_part_boundary_poly_idx_min, boundary_inside_minimum_, inside_locator_minimum_.grid());
+    Crossing end_crossing(end_point, end_inside_min, end_part_idx_min, end_part_boundary_poly_idx_min, boundary_inside_minimum_, inside_locator_minimum_.grid());
 
     { // find crossing over the in-between area between inside and outside
         start_crossing.findCrossingInOrMid(parts_view_inside_minimum_, end_point);
@@ -231,7 +239,7 @@ bool Comb::calc(
         bool combing_succeeded = start_inside
                               && LinePolygonsCrossings::comb(
                                      boundary_inside_optimal_,
-                                     *inside_loc_to_line_optimal_,
+                                     inside_locator_optimal_.grid(),
                                      start_point,
                                      start_crossing.in_or_mid_,
                                      comb_paths.back(),
@@ -242,7 +250,7 @@ bool Comb::calc(
         {
             combing_succeeded = LinePolygonsCrossings::comb(
                 start_crossing.dest_part_,
-                *inside_loc_to_line_minimum_,
+                inside_locator_minimum_.grid(),
                 start_point,
                 start_crossing.in_or_mid_,
                 comb_paths.back(),
@@ -318,7 +326,7 @@ bool Comb::calc(
         {
             if (start_inside)
             { // both start and end are inside
-                comb_paths.back().cross_boundary = PolygonUtils::polygonCollidesWithLineSegment(start_point, end_point, *inside_loc_to_line_optimal_);
+                comb_paths.back().cross_boundary = PolygonUtils::polygonCollidesWithLineSegment(start_point, end_point, inside_locator_optimal_.grid());
             }
             else
             { // both start and end are outside
@@ -341,7 +349,7 @@ bool Comb::calc(
         bool combing_succeeded = end_inside
                               && LinePolygonsCrossings::comb(
                                      boundary_inside_optimal_,
-                                     *inside_loc_to_line_optimal_,
+                                     inside_locator_optimal_.grid(),
                                      end_crossing.in_or_mid_,
                                      end_point,
                                      comb_paths.back(),
@@ -352,7 +360,7 @@ bool Comb::calc(
         {
             combing_succeeded = LinePolygonsCrossings::comb(
                 end_crossing.dest_part_,
-                *inside_loc_to_line_minimum_,
+                inside_locator_minimum_.grid(),
                 end_crossing.in_or_mid_,
                 end_point,
                 comb_paths.back(),
@@ -424,12 +432,28 @@ Comb::Crossing::Crossing(
     }
 }
 
-bool Comb::moveInside(Shape& boundary_inside, bool is_inside, LocToLineGrid* inside_loc_to_line, Point2LL& dest_point, size_t& inside_poly)
+bool Comb::isDirectTravelInside(const Point2LL& start_point, const Point2LL& end_point) const
+{
+    const std::function<bool(const PolygonsPointIndex&)> stop_at_any_segment = [](const PolygonsPointIndex&)
+    {
+        return false;
+    };
+    // Moving the endpoints inside would move them away from boundary segments that are this close.
+    if (! inside_locator_optimal_.grid().processNearby(start_point, offset_extra_start_end_, stop_at_any_segment)
+        || ! inside_locator_optimal_.grid().processNearby(end_point, offset_extra_start_end_, stop_at_any_segment)
+        || ! inside_locator_optimal_.grid().processLine(std::make_pair(start_point, end_point), stop_at_any_segment))
+    {
+        return false;
+    }
+    // No boundary is crossed, so both endpoints are inside if one of them is.
+    return boundary_inside_optimal_.inside(start_point);
+}
+
+bool Comb::moveInside(const ShapeLocator& inside_locator, bool is_inside, Point2LL& dest_point, size_t& inside_poly)
 {
     if (is_inside)
     {
-        ClosestPointPolygon cpp
-            = PolygonUtils::ensureInsideOrOutside(boundary_inside, dest_point, offset_extra_start_end_, max_moveInside_distance2_, &boundary_inside, inside_loc_to_line);
+        ClosestPointPolygon cpp = inside_locator.ensureInsideOrOutside(dest_point, offset_extra_start_end_, max_moveInside_distance2_);
         if (! cpp.isValid())
         {
             return false;
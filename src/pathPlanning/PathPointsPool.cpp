@@ -0,0 +1,54 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "pathPlanning/PathPointsPool.h"
+
+#include <algorithm>
+
+namespace cura
+{
+
+PathPointsPool& PathPointsPool::getInstance()
+{
+    static PathPointsPool instance;
+    return instance;
+}
+
+PathPointsPool::Buffers PathPointsPool::take()
+{
+    std::lock_guard lock(mutex_);
+    if (batches_.empty())
+    {
+        return {};
+    }
+    Buffers buffers = std::move(batches_.back());
+    batches_.pop_back();
+    return buffers;
+}
+
+void PathPointsPool::give(Buffers buffers)
+{
+    // Buffers that never allocated are not worth keeping.
+    std::erase_if(
+        buffers,
+        [](const std::vector<Point2LL>& buffer)
+        {
+            return buffer.capacity() == 0;
+        });
+    if (buffers.empty())
+    {
+        return;
+    }
+    for (std::vector<Point2LL>& buffer : buffers)
+    {
+        buffer.clear();
+    }
+
+    std::lock_guard lock(mutex_);
+    if (batches_.size() < max_batches)
+    {
+        batches_.push_back(std::move(buffers));
+    }
+}
+
+} // namespace cura
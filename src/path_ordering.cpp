@@ -43,6 +43,17 @@ const PointsSet& PathOrdering<const ExtrusionLine*>::getVertexData()
     return *cached_vertices_;
 }
 
+template<>
+const std::vector<double>* PathOrdering<const ExtrusionLine*>::getCornerAngles() const
+{
+    // The junctions may have changed since the angles were computed, like when a seam point was inserted.
+    if (vertices_->corner_angles_.size() != vertices_->junctions_.size() || vertices_->junctions_.empty())
+    {
+        return nullptr;
+    }
+    return &vertices_->corner_angles_;
+}
+
 template const PointsSet& PathOrdering<Polygon*>::getVertexData();
 template const PointsSet& PathOrdering<Polygon const*>::getVertexData();
 template const PointsSet& PathOrdering<const OpenPolyline*>::getVertexData();
@@ -21,6 +21,36 @@
 namespace cura::plugins
 {
 
+namespace
+{
+
+//! Writes points to a repeated field of point messages, allocating the room for all of them at once.
+void addPoints(const auto& points, auto* msg_points)
+{
+    msg_points->Reserve(msg_points->size() + static_cast<int>(std::size(points)));
+    for (const auto& point : points)
+    {
+        auto* msg_point = msg_points->Add();
+        msg_point->set_x(point.X);
+        msg_point->set_y(point.Y);
+    }
+}
+
+//! Reads a repeated field of point messages into a polygon or polyline, allocating it at once.
+template<typename T>
+T readPoints(const auto& msg_points)
+{
+    T points;
+    points.reserve(msg_points.size());
+    for (const auto& msg_point : msg_points)
+    {
+        points.emplace_back(msg_point.x(), msg_point.y());
+    }
+    return points;
+}
+
+} // namespace
+
 empty::value_type empty::operator()() const
 {
     return {};
@@ -103,23 +133,13 @@ simplify_request::value_type simplify_request::operator()(
     auto* msg_polygon = msg_polygons->add_polygons();
     auto* msg_outline = msg_polygon->mutable_outline();
 
-    for (const auto& point : ranges::front(polygons))
-    {
-        auto* msg_outline_path = msg_outline->add_path();
-        msg_outline_path->set_x(point.X);
-        msg_outline_path->set_y(point.Y);
-    }
+    addPoints(ranges::front(polygons), msg_outline->mutable_path());
 
     auto* msg_holes = msg_polygon->mutable_holes();
+    msg_holes->Reserve(static_cast<int>(polygons.size()) - 1);
     for (const auto& polygon : polygons | ranges::views::drop(1))
     {
-        auto* msg_hole = msg_holes->Add();
-        for (const auto& point : polygon)
-        {
-            auto* msg_path = msg_hole->add_path();
-            msg_path->set_x(point.X);
-            msg_path->set_y(point.Y);
-        }
+        addPoints(polygon, msg_holes->Add()->mutable_path());
     }
 
     message.set_max_resolution(max_resolution);
@@ -134,21 +154,10 @@ simplify_response::native_value_type
     native_value_type poly{};
     for (const auto& paths : message.polygons().polygons())
     {
-        Polygon o{};
-        for (const auto& point : paths.outline().path())
-        {
-            o.push_back(Point2LL{ point.x(), point.y() });
-        }
-        poly.push_back(o);
-
+        poly.push_back(readPoints<Polygon>(paths.outline().path()));
         for (const auto& hole : paths.holes())
         {
-            Polygon h{};
-            for (const auto& point : hole.path())
-            {
-                h.push_back(Point2LL{ point.x(), point.y() });
-            }
-            poly.push_back(h);
+            poly.push_back(readPoints<Polygon>(hole.path()));
         }
     }
     return poly;
@@ -187,23 +196,13 @@ infill_generate_request::value_type
     auto* msg_polygon = msg_polygons->add_polygons();
     auto* msg_outline = msg_polygon->mutable_outline();
 
-    for (const auto& point : ranges::front(inner_contour))
-    {
-        auto* msg_outline_path = msg_outline->add_path();
-        msg_outline_path->set_x(point.X);
-        msg_outline_path->set_y(point.Y);
-    }
+    addPoints(ranges::front(inner_contour), msg_outline->mutable_path());
 
     auto* msg_holes = msg_polygon->mutable_holes();
+    msg_holes->Reserve(static_cast<int>(inner_contour.size()) - 1);
     for (const auto& polygon : inner_contour | ranges::views::drop(1))
     {
-        auto* msg_hole = msg_holes->Add();
-        for (const auto& point : polygon)
-        {
-            auto* msg_path = msg_hole->add_path();
-            msg_path->set_x(point.X);
-            msg_path->set_y(point.Y);
-        }
+        addPoints(polygon, msg_holes->Add()->mutable_path());
     }
 
     return message;
@@ -215,9 +214,11 @@ infill_generate_response::native_value_type infill_generate_response::operator()
     Shape result_polygons;
     OpenLinesSet result_lines;
 
+    toolpaths.reserve(message.tool_paths().tool_paths_size());
     for (auto& tool_path : message.tool_paths().tool_paths())
     {
         ExtrusionLine lines;
+        lines.junctions_.reserve(tool_path.junctions_size());
         for (auto& msg_junction : tool_path.junctions())
         {
             auto& p = msg_junction.point();
@@ -225,48 +226,28 @@ infill_generate_response::native_value_type infill_generate_response::operator()
             lines.emplace_back(junction);
         }
 
-        toolpaths.push_back(lines);
+        toolpaths.push_back(std::move(lines));
     }
 
     std::vector<VariableWidthLines> toolpaths_;
-    toolpaths_.push_back(toolpaths);
+    toolpaths_.push_back(std::move(toolpaths));
 
     for (auto& polygon_msg : message.polygons().polygons())
     {
-        Shape polygon{};
-
-        Polygon outline{};
-        for (auto& path_msg : polygon_msg.outline().path())
-        {
-            outline.push_back(Point2LL{ path_msg.x(), path_msg.y() });
-        }
-        polygon.push_back(outline);
-
-
+        result_polygons.push_back(readPoints<Polygon>(polygon_msg.outline().path()));
         for (auto& hole_msg : polygon_msg.holes())
         {
-            Polygon hole{};
-            for (auto& path_msg : hole_msg.path())
-            {
-                hole.emplace_back(path_msg.x(), path_msg.y());
-            }
-            polygon.push_back(hole);
+            result_polygons.push_back(readPoints<Polygon>(hole_msg.path()));
         }
-
-        result_polygons.push_back(polygon);
     }
 
+    result_lines.reserve(message.poly_lines().paths_size());
     for (auto& polygon : message.poly_lines().paths())
     {
-        OpenPolyline poly_line;
-        for (auto& p : polygon.path())
-        {
-            poly_line.emplace_back(p.x(), p.y());
-        }
-        result_lines.emplace_back(poly_line);
+        result_lines.emplace_back(readPoints<OpenPolyline>(polygon.path()));
     }
 
-    return { toolpaths_, result_polygons, result_lines };
+    return { std::move(toolpaths_), std::move(result_polygons), std::move(result_lines) };
 }
 
 [[nodiscard]] constexpr v0::SpaceFillType gcode_paths_modify_request::getSpaceFillType(const cura::SpaceFillType space_fill_type) noexcept
@@ -314,6 +295,8 @@ infill_generate_response::native_value_type infill_generate_response::operator()
         return v0::PrintFeature::SUPPORTINTERFACE;
     case PrintFeatureType::PrimeTower:
         return v0::PrintFeature::PRIMETOWER;
+    case PrintFeatureType::Fiber: // Not part of the plugin protocol (yet).
+        return v0::PrintFeature::NONETYPE;
     case PrintFeatureType::NumPrintFeatureTypes:
         return v0::PrintFeature::NUMPRINTFEATURETYPES;
     default:
@@ -330,16 +313,12 @@ gcode_paths_modify_request::value_type
 
     // Construct the repeated GCodepath message
     auto* gcode_paths = message.mutable_gcode_paths();
+    gcode_paths->Reserve(static_cast<int>(paths.size()));
     for (const auto& path : paths)
     {
         auto* gcode_path = gcode_paths->Add();
         // Construct the OpenPath from the points in a GCodePath
-        for (const auto& point : path.points)
-        {
-            auto* points = gcode_path->mutable_path()->add_path();
-            points->set_x(point.X);
-            points->set_y(point.Y);
-        }
+        addPoints(path.points, gcode_path->mutable_path()->mutable_path());
         gcode_path->set_space_fill_type(getSpaceFillType(path.space_fill_type));
         gcode_path->set_flow(path.flow);
         gcode_path->set_width_factor(path.width_factor);
@@ -356,9 +335,10 @@ gcode_paths_modify_request::value_type
         gcode_path->set_fan_speed(path.getFanSpeed());
         gcode_path->set_mesh_name(path.mesh ? path.mesh->mesh_name : "");
         gcode_path->set_feature(getPrintFeature(path.config.type));
-        gcode_path->mutable_speed_derivatives()->set_velocity(path.config.getSpeed());
-        gcode_path->mutable_speed_derivatives()->set_acceleration(path.config.getAcceleration());
-        gcode_path->mutable_speed_derivatives()->set_jerk(path.config.getJerk());
+        auto* speed_derivatives = gcode_path->mutable_speed_derivatives();
+        speed_derivatives->set_velocity(path.config.getSpeed());
+        speed_derivatives->set_acceleration(path.config.getAcceleration());
+        speed_derivatives->set_jerk(path.config.getJerk());
         gcode_path->set_line_width(path.config.getLineWidth());
         gcode_path->set_layer_thickness(path.config.getLayerThickness());
         gcode_path->set_flow_ratio(path.config.getFlowRatio());
@@ -438,6 +418,7 @@ gcode_paths_modify_response::native_value_type
     gcode_paths_modify_response::operator()(gcode_paths_modify_response::native_value_type& original_value, const gcode_paths_modify_response::value_type& message) const
 {
     std::vector<GCodePath> paths;
+    paths.reserve(message.gcode_paths_size());
     using map_t = std::unordered_map<std::string, std::shared_ptr<const SliceMeshStorage>>;
     auto meshes = original_value
                 | ranges::views::filter(
@@ -482,7 +463,7 @@ gcode_paths_modify_response::native_value_type
                           })
                     | ranges::to_vector;
 
-        paths.emplace_back(path);
+        paths.emplace_back(std::move(path));
     }
 
     return paths;
@@ -3,7 +3,9 @@
 
 #include "progress/Progress.h"
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
 #include <optional>
 
 #include <range/v3/view/enumerate.hpp>
@@ -11,6 +13,11 @@
 
 #include "Application.h" //To get the communication channel to send progress through.
 #include "communication/Communication.h" //To send progress through the communication channel.
+#include "progress/TimingReport.h"
+#ifdef ALLOCATION_PROFILING
+#include "utils/AllocationProfiler.h"
+#endif
+#include "utils/ThreadPoolProfiler.h" //To show the stages in the thread pool trace.
 #include "utils/gettime.h"
 
 namespace cura
@@ -18,6 +25,10 @@ namespace cura
 std::array<double, N_PROGRESS_STAGES> Progress::accumulated_times = { -1 };
 double Progress::total_timing = -1;
 std::optional<LayerIndex> Progress::first_skipped_layer{};
+Progress::clock_t::time_point Progress::stage_start = Progress::clock_t::now();
+std::array<double, N_PROGRESS_STAGES> Progress::measured_times = { 0 };
+std::vector<double> Progress::export_workload{};
+LayerIndex Progress::first_export_layer{ 0 };
 
 double Progress::calcOverallProgress(Stage stage, double stage_progress)
 {
@@ -26,6 +37,29 @@ double Progress::calcOverallProgress(Stage stage, double stage_progress)
     return (accumulated_times.at(static_cast<size_t>(stage)) + stage_progress * times.at(static_cast<size_t>(stage))) / total_timing;
 }
 
+std::optional<Duration> Progress::estimateRemainingTime(Stage stage, double stage_progress)
+{
+    // Before this much time was measured, the estimate would mostly be noise.
+    constexpr double min_measured_time = 0.5;
+    // Only extrapolate the current stage on its own once it has made some progress.
+    constexpr double min_stage_progress = 0.05;
+
+    const size_t stage_idx = static_cast<size_t>(stage);
+    const double stage_time = std::chrono::duration<double>(clock_t::now() - stage_start).count();
+    const double time_done = std::accumulate(measured_times.begin(), measured_times.begin() + stage_idx, 0.0) + stage_time;
+    const double weight_done = accumulated_times.at(stage_idx) + stage_progress * times.at(stage_idx);
+    if (time_done < min_measured_time || weight_done <= 0.0)
+    {
+        return std::nullopt;
+    }
+
+    const double seconds_per_weight = time_done / weight_done; // How much faster or slower this slice goes than the reference timing.
+    const double remaining_in_stage
+        = stage_progress >= min_stage_progress ? stage_time * (1.0 - stage_progress) / stage_progress : seconds_per_weight * times.at(stage_idx) * (1.0 - stage_progress);
+    const double remaining_after_stage = seconds_per_weight * (total_timing - accumulated_times.at(stage_idx) - times.at(stage_idx));
+    return Duration(remaining_in_stage + remaining_after_stage);
+}
+
 void Progress::init()
 {
     double accumulated_time = 0;
@@ -39,17 +73,43 @@ void Progress::init()
 
 void Progress::messageProgress(Progress::Stage stage, int progress_in_stage, int progress_in_stage_max)
 {
-    double percentage = calcOverallProgress(stage, static_cast<double>(progress_in_stage / static_cast<double>(progress_in_stage_max)));
-    Application::getInstance().communication_->sendProgress(percentage);
+    const double stage_progress = std::clamp(progress_in_stage / static_cast<double>(progress_in_stage_max), 0.0, 1.0);
+    double percentage = calcOverallProgress(stage, stage_progress);
+    Application::getInstance().communication_->sendProgress(percentage, estimateRemainingTime(stage, stage_progress));
+}
+
+void Progress::setExportWorkload(LayerIndex first_layer, const std::vector<double>& workload_per_layer)
+{
+    first_export_layer = first_layer;
+    export_workload.resize(workload_per_layer.size());
+    std::partial_sum(workload_per_layer.begin(), workload_per_layer.end(), export_workload.begin());
 }
 
 void Progress::messageProgressStage(Progress::Stage stage, TimeKeeper* time_keeper)
 {
+    const clock_t::time_point now = clock_t::now();
+    if (stage == Stage::START || stage == Stage::SLICING) // The stages start over for each mesh group.
+    {
+        measured_times.fill(0.0);
+    }
+    else
+    {
+        measured_times.at(static_cast<size_t>(stage) - 1) += std::chrono::duration<double>(now - stage_start).count();
+    }
+    stage_start = now;
+#ifdef ALLOCATION_PROFILING
+    AllocationProfiler::getInstance().startStage(static_cast<size_t>(stage), names.at(static_cast<size_t>(stage)));
+#endif
+
     if (time_keeper != nullptr)
     {
         if (static_cast<int>(stage) > 0)
         {
-            spdlog::info("Progress: {} accomplished in {:03.3f}s", names.at(static_cast<size_t>(stage) - 1), time_keeper->restart());
+            const std::string_view previous_stage = names.at(static_cast<size_t>(stage) - 1);
+            const double duration = time_keeper->restart();
+            spdlog::info("Progress: {} accomplished in {:03.3f}s", previous_stage, duration);
+            ThreadPoolProfiler::getInstance().recordStage(previous_stage, std::chrono::duration<double>(duration));
+            TimingReport::getInstance().recordStage(previous_stage, duration);
         }
         else
         {
@@ -80,7 +140,16 @@ void Progress::messageProgressLayer(LayerIndex layer_nr, size_t total_layers, do
             first_skipped_layer.reset();
         }
 
-        messageProgress(Stage::EXPORT, std::max(layer_nr.value, LayerIndex::value_type(0)) + 1, total_layers);
+        const LayerIndex::value_type workload_idx = layer_nr.value - first_export_layer.value;
+        if (! export_workload.empty() && export_workload.back() > 0.0 && workload_idx >= 0 && static_cast<size_t>(workload_idx) < export_workload.size())
+        {
+            const double stage_progress = export_workload[workload_idx] / export_workload.back();
+            Application::getInstance().communication_->sendProgress(calcOverallProgress(Stage::EXPORT, stage_progress), estimateRemainingTime(Stage::EXPORT, stage_progress));
+        }
+        else
+        {
+            messageProgress(Stage::EXPORT, std::max(layer_nr.value, LayerIndex::value_type(0)) + 1, total_layers);
+        }
 
         spdlog::info("┌ Layer export [{}] accomplished in {:03.3f}s", layer_nr, total_time);
 
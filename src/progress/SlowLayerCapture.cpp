@@ -0,0 +1,193 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "progress/SlowLayerCapture.h"
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "geometry/Polygon.h"
+#include "settings/Settings.h"
+#include "utils/format/filesystem_path.h"
+
+namespace cura
+{
+
+namespace
+{
+
+//! Write the outlines as a WKT multipolygon, with one polygon per part, which repeats the first point of each ring at its end.
+void writeMultiPolygon(std::ostream& out, const std::vector<SingleShape>& outlines)
+{
+    out << "MULTIPOLYGON (";
+    bool first_polygon = true;
+    for (const SingleShape& outline : outlines)
+    {
+        if (outline.empty())
+        {
+            continue;
+        }
+        out << (first_polygon ? "(" : ", (");
+        first_polygon = false;
+        bool first_ring = true;
+        for (const Polygon& ring : outline)
+        {
+            out << (first_ring ? "(" : ", (");
+            first_ring = false;
+            for (const Point2LL& point : ring)
+            {
+                out << point.X << ' ' << point.Y << ", ";
+            }
+            if (! ring.empty())
+            {
+                out << ring.front().X << ' ' << ring.front().Y;
+            }
+            out << ')';
+        }
+        out << ')';
+    }
+    out << ")\n";
+}
+
+//! Escape the backslashes and line breaks of a setting value, so that it fits on one line.
+std::string escapeValue(const std::string& value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const char character : value)
+    {
+        switch (character)
+        {
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\r':
+            escaped += "\\r";
+            break;
+        default:
+            escaped += character;
+        }
+    }
+    return escaped;
+}
+
+//! The reverse of \ref escapeValue. A backslash before any other character is kept as it is.
+std::string unescapeValue(const std::string& escaped)
+{
+    std::string value;
+    value.reserve(escaped.size());
+    for (size_t char_idx = 0; char_idx < escaped.size(); char_idx++)
+    {
+        if (escaped[char_idx] != '\\' || char_idx + 1 == escaped.size())
+        {
+            value += escaped[char_idx];
+            continue;
+        }
+        switch (escaped[char_idx + 1])
+        {
+        case '\\':
+            value += '\\';
+            break;
+        case 'n':
+            value += '\n';
+            break;
+        case 'r':
+            value += '\r';
+            break;
+        default:
+            value += escaped[char_idx];
+            continue;
+        }
+        char_idx++;
+    }
+    return value;
+}
+
+} // namespace
+
+SlowLayerCapture& SlowLayerCapture::getInstance()
+{
+    static SlowLayerCapture instance;
+    return instance;
+}
+
+void SlowLayerCapture::enable(std::filesystem::path directory, const double threshold)
+{
+    directory_ = std::move(directory);
+    threshold_ = threshold;
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void SlowLayerCapture::captureWalls(const std::vector<SingleShape>& outlines, const Settings& settings, const LayerIndex layer_nr, const double duration)
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error)
+    {
+        spdlog::error("Couldn't create the directory {} to capture slow layers in: {}", directory_, error.message());
+        return;
+    }
+
+    const std::string stem = fmt::format("walls_{:03}_layer_{}", capture_count_.fetch_add(1, std::memory_order_relaxed), layer_nr.value);
+    const std::filesystem::path wkt_file = directory_ / (stem + ".wkt");
+    const std::filesystem::path settings_file = directory_ / (stem + ".settings");
+    std::ofstream wkt(wkt_file);
+    std::ofstream settings_out(settings_file);
+    if (! wkt || ! settings_out)
+    {
+        spdlog::error("Couldn't write the slow layer {} to {}.", layer_nr.value, directory_);
+        return;
+    }
+    writeMultiPolygon(wkt, outlines);
+
+    writeSettings(settings_out, settings);
+    spdlog::info("The walls of layer {} took {:.1f} s, captured them as {}.", layer_nr.value, duration, directory_ / stem);
+}
+
+void SlowLayerCapture::writeSettings(std::ostream& out, const Settings& settings)
+{
+    // In a fixed order, so that captures of the same layer can be compared.
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (auto& [key, value] : settings.getFlattendSettings())
+    {
+        entries.emplace_back(key, std::move(value));
+    }
+    std::sort(entries.begin(), entries.end());
+    for (const auto& [key, value] : entries)
+    {
+        out << key << '=' << escapeValue(value) << '\n';
+    }
+}
+
+Settings SlowLayerCapture::readSettings(std::istream& in)
+{
+    Settings settings;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        const size_t separator = line.find('=');
+        if (separator == std::string::npos)
+        {
+            continue;
+        }
+        settings.add(line.substr(0, separator), unescapeValue(line.substr(separator + 1)));
+    }
+    return settings;
+}
+
+} // namespace cura
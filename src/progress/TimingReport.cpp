@@ -0,0 +1,342 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "progress/TimingReport.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <unordered_map>
+
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/writer.h>
+#include <spdlog/spdlog.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "Application.h" //To get the number of threads.
+#include "utils/ThreadPool.h"
+
+namespace cura
+{
+
+namespace
+{
+
+//! The most memory the process used so far, in bytes.
+std::optional<uint64_t> peakResidentSetSize()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return std::nullopt;
+    }
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss); // Already in bytes.
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // In kilobytes.
+#endif
+#else
+    return std::nullopt;
+#endif
+}
+
+//! The upper bounds of the bins of the histograms of how long a part of the layer planning took, in seconds. The last bin holds everything above.
+constexpr std::array<double, 12> histogram_bounds{ 0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0, 2.0, 5.0 };
+
+} // namespace
+
+TimingReport& TimingReport::getInstance()
+{
+    static TimingReport instance;
+    return instance;
+}
+
+void TimingReport::enable(std::string report_file)
+{
+    report_file_ = std::move(report_file);
+    origin_ = clock_t::now();
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void TimingReport::recordStage(std::string_view name, double duration)
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+    const double end = std::chrono::duration<double>(clock_t::now() - origin_).count();
+    std::lock_guard lock(mutex_);
+    stages_.push_back(Stage{ .name = std::string(name),
+                             .start = end - duration,
+                             .duration = duration,
+                             .peak_rss = peakResidentSetSize(),
+                             .sub_stages = std::move(pending_sub_stages_),
+                             .footprint = std::move(pending_footprint_) });
+    pending_sub_stages_.clear();
+    pending_footprint_.clear();
+}
+
+void TimingReport::recordFootprint(std::string_view field, uint64_t points, uint64_t bytes)
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+    std::lock_guard lock(mutex_);
+    pending_footprint_.push_back(Footprint{ .field = std::string(field), .points = points, .bytes = bytes });
+}
+
+void TimingReport::recordSubStages(const TimeKeeper::RegisteredTimes& times)
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+    std::lock_guard lock(mutex_);
+    pending_sub_stages_.insert(pending_sub_stages_.end(), times.begin(), times.end());
+}
+
+void TimingReport::recordLayer(LayerIndex layer_nr, coord_t z, coord_t thickness, size_t part_count, double duration, const TimeKeeper::RegisteredTimes& times)
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+    std::lock_guard lock(mutex_);
+    layers_.push_back(Layer{ .layer_nr = layer_nr, .z = z, .thickness = thickness, .part_count = part_count, .duration = duration, .stages = times });
+}
+
+void TimingReport::report()
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+
+    std::lock_guard lock(mutex_);
+    std::ofstream file(report_file_);
+    if (! file)
+    {
+        spdlog::error("Couldn't write the timing report to {}.", report_file_);
+    }
+    else
+    {
+        rapidjson::OStreamWrapper stream(file);
+        rapidjson::Writer<rapidjson::OStreamWrapper> writer(stream);
+        const auto write_times = [&writer](const TimeKeeper::RegisteredTimes& times)
+        {
+            writer.StartArray();
+            for (const TimeKeeper::RegisteredTime& time : times)
+            {
+                writer.StartObject();
+                writer.Key("name");
+                writer.String(time.stage.c_str(), static_cast<rapidjson::SizeType>(time.stage.size()));
+                writer.Key("duration");
+                writer.Double(time.duration);
+                writer.EndObject();
+            }
+            writer.EndArray();
+        };
+        const auto write_rss = [&writer](const std::optional<uint64_t> rss)
+        {
+            if (rss)
+            {
+                writer.Uint64(*rss);
+            }
+            else
+            {
+                writer.Null();
+            }
+        };
+
+        const ThreadPool* thread_pool = Application::getInstance().thread_pool_;
+        writer.StartObject();
+        writer.Key("version");
+        writer.String(CURA_ENGINE_VERSION);
+        writer.Key("threads");
+        writer.Uint64(thread_pool != nullptr ? thread_pool->thread_count() + 1 : 1); // The workers and the main thread.
+        writer.Key("duration");
+        writer.Double(std::chrono::duration<double>(clock_t::now() - origin_).count());
+        writer.Key("peak_rss");
+        write_rss(peakResidentSetSize());
+
+        writer.Key("stages");
+        writer.StartArray();
+        for (const Stage& stage : stages_)
+        {
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(stage.name.c_str(), static_cast<rapidjson::SizeType>(stage.name.size()));
+            writer.Key("start");
+            writer.Double(stage.start);
+            writer.Key("duration");
+            writer.Double(stage.duration);
+            writer.Key("peak_rss");
+            write_rss(stage.peak_rss);
+            writer.Key("stages");
+            write_times(stage.sub_stages);
+            if (! stage.footprint.empty())
+            {
+                writer.Key("footprint");
+                writer.StartArray();
+                for (const Footprint& footprint : stage.footprint)
+                {
+                    writer.StartObject();
+                    writer.Key("field");
+                    writer.String(footprint.field.c_str(), static_cast<rapidjson::SizeType>(footprint.field.size()));
+                    writer.Key("points");
+                    writer.Uint64(footprint.points);
+                    writer.Key("bytes");
+                    writer.Uint64(footprint.bytes);
+                    writer.EndObject();
+                }
+                writer.EndArray();
+            }
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.Key("layers");
+        writer.StartArray();
+        for (const Layer& layer : layers_)
+        {
+            writer.StartObject();
+            writer.Key("layer");
+            writer.Int64(layer.layer_nr.value);
+            writer.Key("z");
+            writer.Int64(layer.z);
+            writer.Key("thickness");
+            writer.Int64(layer.thickness);
+            writer.Key("parts");
+            writer.Uint64(layer.part_count);
+            writer.Key("duration");
+            writer.Double(layer.duration);
+            writer.Key("stages");
+            write_times(layer.stages);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        // Per part of the layer planning, and for the layers as a whole, which layers were the slowest.
+        struct StageTimes
+        {
+            std::string name;
+            std::vector<std::pair<double, size_t>> durations; //!< Per layer that has this part, how long it took and the index of the layer.
+        };
+        std::vector<StageTimes> stage_times{ StageTimes{ .name = "Layer" } };
+        std::unordered_map<std::string, size_t> stage_indices;
+        for (size_t layer_idx = 0; layer_idx < layers_.size(); layer_idx++)
+        {
+            stage_times.front().durations.emplace_back(layers_[layer_idx].duration, layer_idx);
+            for (const TimeKeeper::RegisteredTime& time : layers_[layer_idx].stages)
+            {
+                const auto [it, inserted] = stage_indices.emplace(time.stage, stage_times.size());
+                if (inserted)
+                {
+                    stage_times.push_back(StageTimes{ .name = time.stage });
+                }
+                std::vector<std::pair<double, size_t>>& durations = stage_times[it->second].durations;
+                if (! durations.empty() && durations.back().second == layer_idx) // Some parts are timed once per extruder.
+                {
+                    durations.back().first += time.duration;
+                }
+                else
+                {
+                    durations.emplace_back(time.duration, layer_idx);
+                }
+            }
+        }
+
+        writer.Key("hot_spots");
+        writer.StartArray();
+        for (StageTimes& stage : stage_times)
+        {
+            double total = 0.0;
+            std::array<uint64_t, histogram_bounds.size() + 1> histogram{};
+            for (const auto& [duration, layer_idx] : stage.durations)
+            {
+                total += duration;
+                histogram[std::lower_bound(histogram_bounds.begin(), histogram_bounds.end(), duration) - histogram_bounds.begin()]++;
+            }
+            const size_t slowest_count = std::min(hot_spot_count, stage.durations.size());
+            std::partial_sort(
+                stage.durations.begin(),
+                stage.durations.begin() + slowest_count,
+                stage.durations.end(),
+                [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b)
+                {
+                    return a.first > b.first;
+                });
+            if (slowest_count > 0)
+            {
+                const Layer& slowest = layers_[stage.durations.front().second];
+                spdlog::info(
+                    "{}: {:03.3f}s in {} layers, slowest in layer {} ({:03.3f}s, {} parts)",
+                    stage.name,
+                    total,
+                    stage.durations.size(),
+                    slowest.layer_nr,
+                    stage.durations.front().first,
+                    slowest.part_count);
+            }
+
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(stage.name.c_str(), static_cast<rapidjson::SizeType>(stage.name.size()));
+            writer.Key("duration");
+            writer.Double(total);
+            writer.Key("slowest_layers");
+            writer.StartArray();
+            for (size_t slowest_idx = 0; slowest_idx < slowest_count; slowest_idx++)
+            {
+                const Layer& layer = layers_[stage.durations[slowest_idx].second];
+                writer.StartObject();
+                writer.Key("layer");
+                writer.Int64(layer.layer_nr.value);
+                writer.Key("z");
+                writer.Int64(layer.z);
+                writer.Key("thickness");
+                writer.Int64(layer.thickness);
+                writer.Key("parts");
+                writer.Uint64(layer.part_count);
+                writer.Key("duration");
+                writer.Double(stage.durations[slowest_idx].first);
+                writer.EndObject();
+            }
+            writer.EndArray();
+            writer.Key("histogram");
+            writer.StartObject();
+            writer.Key("upper_bounds");
+            writer.StartArray();
+            for (const double bound : histogram_bounds)
+            {
+                writer.Double(bound);
+            }
+            writer.EndArray();
+            writer.Key("counts"); // One more than the bounds, for the layers that took longer than the last bound.
+            writer.StartArray();
+            for (const uint64_t count : histogram)
+            {
+                writer.Uint64(count);
+            }
+            writer.EndArray();
+            writer.EndObject();
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+        spdlog::info("Wrote the timing report to {}.", report_file_);
+    }
+
+    stages_.clear();
+    pending_sub_stages_.clear();
+    pending_footprint_.clear();
+    layers_.clear();
+    origin_ = clock_t::now();
+}
+
+} // namespace cura
@@ -3,6 +3,9 @@
 
 #include "raft.h"
 
+#include <array>
+#include <vector>
+
 #include <polyclipping/clipper.hpp>
 
 #include <spdlog/spdlog.h>
@@ -10,8 +13,10 @@
 #include "Application.h" //To get settings.
 #include "ExtruderTrain.h"
 #include "Slice.h"
+#include "geometry/OffsetEngine.h"
 #include "settings/EnumSettings.h" //For EPlatformAdhesion.
 #include "sliceDataStorage.h"
+#include "utils/ThreadPool.h"
 #include "utils/math.h"
 
 namespace cura
@@ -29,10 +34,14 @@ void Raft::generate(SliceDataStorage& storage)
     const auto raft_interface_margin = settings.get<coord_t>("raft_interface_margin");
     const auto raft_surface_margin = settings.get<coord_t>("raft_surface_margin");
 
-    storage.raft_base_outline = storage.raft_surface_outline = storage.raft_interface_outline = storage.getLayerOutlines(0, include_support, dont_include_prime_tower);
-    storage.raft_base_outline = storage.raft_base_outline.offset(raft_base_margin, ClipperLib::jtRound);
-    storage.raft_interface_outline = storage.raft_interface_outline.offset(raft_interface_margin, ClipperLib::jtRound);
-    storage.raft_surface_outline = storage.raft_surface_outline.offset(raft_surface_margin, ClipperLib::jtRound);
+    // The outlines of the first layer span the whole build plate, so they are unioned on the thread pool, and only once for all three margins.
+    const Shape first_layer_outline = storage.getLayerOutlines(0, include_support, dont_include_prime_tower).unionPolygonsParallel();
+    OffsetEngine first_layer_offsets(first_layer_outline, ClipperLib::jtRound);
+    constexpr bool parallel = true;
+    std::vector<Shape> raft_outlines = first_layer_offsets.offsets({ raft_base_margin, raft_interface_margin, raft_surface_margin }, parallel);
+    storage.raft_base_outline = std::move(raft_outlines[0]);
+    storage.raft_interface_outline = std::move(raft_outlines[1]);
+    storage.raft_surface_outline = std::move(raft_outlines[2]);
 
     const coord_t shield_line_width_layer0 = settings.get<coord_t>("skirt_brim_line_width");
     const coord_t max_raft_distance = std::max(std::max(raft_base_margin, raft_interface_margin), raft_surface_margin);
@@ -114,17 +123,21 @@ void Raft::generate(SliceDataStorage& storage)
         }
     };
     const auto nominal_raft_line_width = settings.get<coord_t>("skirt_brim_line_width");
-    remove_inside_corners(storage.raft_base_outline, settings.get<bool>("raft_base_remove_inside_corners"), settings.get<coord_t>("raft_base_smoothing"), nominal_raft_line_width);
-    remove_inside_corners(
-        storage.raft_interface_outline,
-        settings.get<bool>("raft_interface_remove_inside_corners"),
-        settings.get<coord_t>("raft_interface_smoothing"),
-        nominal_raft_line_width);
-    remove_inside_corners(
-        storage.raft_surface_outline,
-        settings.get<bool>("raft_surface_remove_inside_corners"),
-        settings.get<coord_t>("raft_surface_smoothing"),
-        nominal_raft_line_width);
+    // The three outlines don't depend on each other.
+    const std::array<Shape*, 3> outlines{ &storage.raft_base_outline, &storage.raft_interface_outline, &storage.raft_surface_outline };
+    const std::array<bool, 3> remove_inside_corners_per_outline{ settings.get<bool>("raft_base_remove_inside_corners"),
+                                                                 settings.get<bool>("raft_interface_remove_inside_corners"),
+                                                                 settings.get<bool>("raft_surface_remove_inside_corners") };
+    const std::array<coord_t, 3> smoothing_per_outline{ settings.get<coord_t>("raft_base_smoothing"),
+                                                        settings.get<coord_t>("raft_interface_smoothing"),
+                                                        settings.get<coord_t>("raft_surface_smoothing") };
+    cura::parallel_for<size_t>(
+        0,
+        outlines.size(),
+        [&](const size_t outline_idx)
+        {
+            remove_inside_corners(*outlines[outline_idx], remove_inside_corners_per_outline[outline_idx], smoothing_per_outline[outline_idx], nominal_raft_line_width);
+        });
 }
 
 coord_t Raft::getTotalThickness()
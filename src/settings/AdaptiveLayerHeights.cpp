@@ -7,12 +7,15 @@
 #include <cmath>
 #include <limits>
 #include <numbers>
+#include <numeric>
+#include <span>
 
 #include "Application.h"
 #include "Slice.h"
 #include "settings/EnumSettings.h"
 #include "settings/types/Angle.h"
 #include "utils/Point3D.h"
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -64,11 +67,15 @@ void AdaptiveLayerHeights::calculateLayers()
     const coord_t minimum_layer_height = *std::min_element(allowed_layer_heights_.begin(), allowed_layer_heights_.end());
     Settings const& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     auto slicing_tolerance = mesh_group_settings.get<SlicingTolerance>("slicing_tolerance");
-    std::vector<size_t> triangles_of_interest;
     const coord_t model_max_z = meshgroup_->max().z_;
     coord_t z_level = 0;
     coord_t previous_layer_height = 0;
 
+    // The triangles that start below the top of the thickest potential layer and end above the current z level, ordered by their minimum z.
+    // Both bounds only ever go up, so triangles are added to and removed from this sweep exactly once.
+    std::vector<size_t> active_triangles;
+    size_t next_triangle = 0; // The first triangle in the order of face_min_z_values_ that hasn't been added yet.
+
     // the first layer has it's own independent height set, so we always add that
     const auto initial_layer_height = mesh_group_settings.get<coord_t>("layer_height_0");
     z_level += initial_layer_height;
@@ -93,34 +100,31 @@ void AdaptiveLayerHeights::calculateLayers()
 
             if (layer_height == allowed_layer_heights_[0])
             {
-                // this is the max layer thickness, search through all of the triangles in the mesh to find those
-                // that intersect with a layer this thick
-                triangles_of_interest.clear();
-
-                for (size_t i = 0; i < face_min_z_values_.size(); ++i)
+                // this is the max layer thickness, advance the sweep to the triangles that intersect with a layer this thick
+                std::erase_if(
+                    active_triangles,
+                    [this, lower_bound](const size_t i)
+                    {
+                        return face_max_z_values_[i] < lower_bound;
+                    });
+                for (; next_triangle < face_min_z_values_.size() && face_min_z_values_[next_triangle] <= upper_bound; ++next_triangle)
                 {
-                    if (face_min_z_values_[i] <= upper_bound && face_max_z_values_[i] >= lower_bound)
+                    if (face_max_z_values_[next_triangle] >= lower_bound)
                     {
-                        triangles_of_interest.push_back(i);
+                        active_triangles.push_back(next_triangle);
                     }
                 }
             }
-            else
-            {
-                // this is a reduced thickness layer, just search those triangles that intersected with the layer
-                // in the previous iteration
-                const std::vector<size_t> last_triangles_of_interest = triangles_of_interest;
 
-                triangles_of_interest.clear();
-
-                for (const auto& i : last_triangles_of_interest)
+            // A reduced thickness layer only sees the triangles that start below its top, which is a prefix of the sweep.
+            const auto triangles_of_interest_end = std::find_if(
+                active_triangles.begin(),
+                active_triangles.end(),
+                [this, upper_bound](const size_t i)
                 {
-                    if (face_min_z_values_[i] <= upper_bound)
-                    {
-                        triangles_of_interest.push_back(i);
-                    }
-                }
-            }
+                    return face_min_z_values_[i] > upper_bound;
+                });
+            const std::span<const size_t> triangles_of_interest(active_triangles.begin(), triangles_of_interest_end);
 
             // when there not interesting triangles in this potential layer go to the next one
             if (triangles_of_interest.empty())
@@ -187,7 +191,8 @@ void AdaptiveLayerHeights::calculateLayers()
 
 void AdaptiveLayerHeights::calculateMeshTriangleSlopes()
 {
-    // loop over all mesh faces (triangles) and find their slopes
+    std::vector<const Mesh*> meshes;
+    std::vector<size_t> mesh_face_offsets{ 0 };
     for (const Mesh& mesh : Application::getInstance().current_slice_->scene.current_mesh_group->meshes)
     {
         // Skip meshes that are not printable
@@ -195,39 +200,77 @@ void AdaptiveLayerHeights::calculateMeshTriangleSlopes()
         {
             continue;
         }
+        meshes.push_back(&mesh);
+        mesh_face_offsets.push_back(mesh_face_offsets.back() + mesh.faces_.size());
+    }
 
-        for (const MeshFace& face : mesh.faces_)
-        {
-            const MeshVertex& v0 = mesh.vertices_[face.vertex_index_[0]];
-            const MeshVertex& v1 = mesh.vertices_[face.vertex_index_[1]];
-            const MeshVertex& v2 = mesh.vertices_[face.vertex_index_[2]];
-
-            const Point3D p0 = v0.p_;
-            const Point3D p1 = v1.p_;
-            const Point3D p2 = v2.p_;
-
-            double min_z = p0.z_;
-            min_z = std::min(min_z, p1.z_);
-            min_z = std::min(min_z, p2.z_);
-            double max_z = p0.z_;
-            max_z = std::max(max_z, p1.z_);
-            max_z = std::max(max_z, p2.z_);
-
-            // calculate the angle of this triangle in the z direction
-            const Point3D n = (p1 - p0).cross(p2 - p0);
-            const Point3D normal = n.normalized();
-            AngleRadians z_angle = std::acos(std::abs(normal.z_));
-
-            // prevent flat surfaces from influencing the algorithm
-            if (z_angle == 0)
+    const size_t face_count = mesh_face_offsets.back();
+    std::vector<double> face_slopes(face_count);
+    std::vector<int> face_min_z_values(face_count);
+    std::vector<int> face_max_z_values(face_count);
+
+    // loop over all mesh faces (triangles) and find their slopes
+    for (size_t mesh_idx = 0; mesh_idx < meshes.size(); ++mesh_idx)
+    {
+        const Mesh& mesh = *meshes[mesh_idx];
+        const size_t offset = mesh_face_offsets[mesh_idx];
+        cura::parallel_for<size_t>(
+            0,
+            mesh.faces_.size(),
+            [&](const size_t face_idx)
             {
-                z_angle = std::numbers::pi;
-            }
+                const MeshFace& face = mesh.faces_[face_idx];
+                const MeshVertex& v0 = mesh.vertices_[face.vertex_index_[0]];
+                const MeshVertex& v1 = mesh.vertices_[face.vertex_index_[1]];
+                const MeshVertex& v2 = mesh.vertices_[face.vertex_index_[2]];
 
-            face_min_z_values_.push_back(MM2INT(min_z));
-            face_max_z_values_.push_back(MM2INT(max_z));
-            face_slopes_.push_back(z_angle);
-        }
+                const Point3D p0 = v0.p_;
+                const Point3D p1 = v1.p_;
+                const Point3D p2 = v2.p_;
+
+                double min_z = p0.z_;
+                min_z = std::min(min_z, p1.z_);
+                min_z = std::min(min_z, p2.z_);
+                double max_z = p0.z_;
+                max_z = std::max(max_z, p1.z_);
+                max_z = std::max(max_z, p2.z_);
+
+                // calculate the angle of this triangle in the z direction
+                const Point3D n = (p1 - p0).cross(p2 - p0);
+                const Point3D normal = n.normalized();
+                AngleRadians z_angle = std::acos(std::abs(normal.z_));
+
+                // prevent flat surfaces from influencing the algorithm
+                if (z_angle == 0)
+                {
+                    z_angle = std::numbers::pi;
+                }
+
+                face_min_z_values[offset + face_idx] = MM2INT(min_z);
+                face_max_z_values[offset + face_idx] = MM2INT(max_z);
+                face_slopes[offset + face_idx] = z_angle;
+            },
+            1024);
+    }
+
+    // Order the faces by their minimum z, so that calculateLayers can sweep through them.
+    std::vector<size_t> order(face_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(),
+        order.end(),
+        [&face_min_z_values](const size_t a, const size_t b)
+        {
+            return face_min_z_values[a] < face_min_z_values[b];
+        });
+    face_slopes_.resize(face_count);
+    face_min_z_values_.resize(face_count);
+    face_max_z_values_.resize(face_count);
+    for (size_t i = 0; i < face_count; ++i)
+    {
+        face_slopes_[i] = face_slopes[order[i]];
+        face_min_z_values_[i] = face_min_z_values[order[i]];
+        face_max_z_values_[i] = face_max_z_values[order[i]];
     }
 }
 
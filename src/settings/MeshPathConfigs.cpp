@@ -125,6 +125,14 @@ MeshPathConfigs::MeshPathConfigs(const SliceMeshStorage& mesh, const coord_t lay
                       .speed_derivatives = { .speed = mesh.settings.get<Velocity>("speed_ironing"),
                                              .acceleration = mesh.settings.get<Acceleration>("acceleration_ironing"),
                                              .jerk = mesh.settings.get<Velocity>("jerk_ironing") } }
+    , fiber_config{ .type = PrintFeatureType::Fiber,
+                    .line_width = static_cast<coord_t>(
+                        mesh.settings.get<coord_t>("wall_line_width_0") * line_width_factor_per_extruder[mesh.settings.get<ExtruderTrain&>("wall_0_extruder_nr").extruder_nr_]),
+                    .layer_thickness = layer_thickness,
+                    .flow = mesh.settings.get<Ratio>("wall_0_material_flow") * (layer_nr == 0 ? mesh.settings.get<Ratio>("wall_0_material_flow_layer_0") : Ratio{ 1.0 }),
+                    .speed_derivatives = { .speed = mesh.settings.get<Velocity>("speed_wall_0"),
+                                           .acceleration = mesh.settings.get<Acceleration>("acceleration_wall_0"),
+                                           .jerk = mesh.settings.get<Velocity>("jerk_wall_0") } }
 
 {
     infill_config.reserve(MAX_INFILL_COMBINE);
@@ -143,4 +151,28 @@ MeshPathConfigs::MeshPathConfigs(const SliceMeshStorage& mesh, const coord_t lay
     }
 }
 
+void MeshPathConfigs::setLayerThickness(const coord_t layer_thickness)
+{
+    for (GCodePathConfig* config : { &inset0_config,
+                                     &insetX_config,
+                                     &inset0_roofing_config,
+                                     &insetX_roofing_config,
+                                     &bridge_inset0_config,
+                                     &bridge_insetX_config,
+                                     &skin_config,
+                                     &bridge_skin_config,
+                                     &bridge_skin_config2,
+                                     &bridge_skin_config3,
+                                     &roofing_config,
+                                     &ironing_config,
+                                     &fiber_config })
+    {
+        config->layer_thickness = layer_thickness;
+    }
+    for (GCodePathConfig& config : infill_config)
+    {
+        config.layer_thickness = layer_thickness;
+    }
+}
+
 } // namespace cura
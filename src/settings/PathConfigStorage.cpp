@@ -167,12 +167,40 @@ PathConfigStorage::PathConfigStorage(const SliceDataStorage& storage, const Laye
     support_fractional_roof_config.flow *= Ratio(layer_height - leftover_support_distance, layer_height);
 }
 
+PathConfigStorage::PathConfigStorage(const PathConfigStorage& layer_invariant_configs, const coord_t layer_thickness)
+    : PathConfigStorage(layer_invariant_configs)
+{
+    // The raft configs have their own thickness and travel moves have none.
+    for (std::vector<GCodePathConfig>* configs :
+         { &skirt_brim_config_per_extruder, &prime_tower_config_per_extruder, &support_infill_config, &support_fractional_infill_config })
+    {
+        for (GCodePathConfig& config : *configs)
+        {
+            config.layer_thickness = layer_thickness;
+        }
+    }
+    support_roof_config.layer_thickness = layer_thickness;
+    support_fractional_roof_config.layer_thickness = layer_thickness;
+    support_bottom_config.layer_thickness = layer_thickness;
+    for (MeshPathConfigs& mesh_config : mesh_configs)
+    {
+        mesh_config.setLayerThickness(layer_thickness);
+    }
+}
+
+bool PathConfigStorage::isLayerInvariant(const LayerIndex& layer_nr)
+{
+    const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
+    return layer_nr > 0 && layer_nr >= static_cast<LayerIndex>(mesh_group_settings.get<size_t>("speed_slowdown_layers"));
+}
+
 void MeshPathConfigs::smoothAllSpeeds(const SpeedDerivatives& first_layer_config, const LayerIndex layer_nr, const LayerIndex max_speed_layer)
 {
     inset0_config.speed_derivatives.smoothSpeed(first_layer_config, layer_nr, max_speed_layer);
     insetX_config.speed_derivatives.smoothSpeed(first_layer_config, layer_nr, max_speed_layer);
     skin_config.speed_derivatives.smoothSpeed(first_layer_config, layer_nr, max_speed_layer);
     ironing_config.speed_derivatives.smoothSpeed(first_layer_config, layer_nr, max_speed_layer);
+    fiber_config.speed_derivatives.smoothSpeed(first_layer_config, layer_nr, max_speed_layer);
     for (size_t idx = 0; idx < MAX_INFILL_COMBINE; idx++)
     {
         // Infill speed (per combine part per mesh).
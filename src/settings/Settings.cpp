@@ -10,6 +10,7 @@
 #include <regex> // regex parsing for temp flow graph
 #include <sstream> // ostringstream
 #include <string> //Parsing strings (stod, stoul).
+#include <type_traits>
 
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view/map.hpp>
@@ -32,10 +33,48 @@
 #include "utils/Matrix4x3D.h"
 #include "utils/string.h" //For Escaped.
 #include "utils/types/string_switch.h" //For string switch.
+#ifdef SETTINGS_PROFILING
+#include "settings/SettingsProfiler.h"
+#endif
 
 namespace cura
 {
 
+std::atomic<uint64_t> Settings::cache_generation_{ 1 };
+
+#ifdef SETTINGS_PROFILING
+namespace
+{
+//! How many parents up the current string lookup of this thread is.
+thread_local size_t lookup_depth = 0;
+
+template<typename T>
+constexpr const char* settingTypeName()
+{
+    if constexpr (std::is_same_v<T, std::string>)
+    {
+        return "string";
+    }
+    else if constexpr (std::is_same_v<T, double>)
+    {
+        return "double";
+    }
+    else if constexpr (std::is_same_v<T, size_t>)
+    {
+        return "size_t";
+    }
+    else if constexpr (std::is_same_v<T, int>)
+    {
+        return "int";
+    }
+    else
+    {
+        return "bool";
+    }
+}
+} // namespace
+#endif
+
 Settings::Settings()
 {
     parent = nullptr; // Needs to be properly initialised because we check against this if the parent is not set.
@@ -51,64 +90,151 @@ void Settings::add(const std::string& key, const std::string value)
     {
         settings.emplace(key, value);
     }
+    invalidateCaches(); // Other containers may inherit this setting, so their caches are outdated as well.
 }
 
-template<>
-std::string Settings::get<std::string>(const std::string& key) const
+void Settings::invalidateCaches()
 {
-    // If this settings base has a setting value for it, look that up.
-    if (settings.find(key) != settings.end())
-    {
-        return settings.at(key);
-    }
+    cache_generation_.fetch_add(1, std::memory_order_acq_rel);
+}
 
-    const std::unordered_map<std::string, ExtruderTrain*>& limit_to_extruder = Application::getInstance().current_slice_->scene.limit_to_extruder;
-    if (limit_to_extruder.find(key) != limit_to_extruder.end())
+template<typename T, typename F>
+T Settings::getCached(SettingKey::Map<T> ValueCache::*values, const SettingKey& key, F&& compute) const
+{
+#ifdef SETTINGS_PROFILING
+    SettingsProfiler::Scope profile_scope(settingTypeName<T>(), key);
+#endif
+    const uint64_t generation = cache_generation_.load(std::memory_order_acquire);
     {
-        return limit_to_extruder.at(key)->settings_.getWithoutLimiting(key);
+        std::shared_lock lock(cache_.mutex);
+        if (cache_.generation == generation)
+        {
+            const auto it = (cache_.*values).find(key);
+            if (it != (cache_.*values).end())
+            {
+#ifdef SETTINGS_PROFILING
+                profile_scope.cacheHit();
+                if constexpr (std::is_same_v<T, std::string>)
+                {
+                    SettingsProfiler::getInstance().recordDepth(key, lookup_depth);
+                }
+#endif
+                return it->second;
+            }
+        }
     }
 
-    if (parent)
+    T value = compute();
+
+    std::unique_lock lock(cache_.mutex);
+    if (cache_.generation != generation)
     {
-        return parent->get<std::string>(key);
+        cache_.clear();
+        cache_.generation = generation;
     }
+    (cache_.*values).emplace(key.str(), value);
+    return value;
+}
+
+template<>
+std::string Settings::get<std::string>(const SettingKey& key) const
+{
+    return getCached(
+        &ValueCache::strings,
+        key,
+        [this, &key]() -> std::string
+        {
+            // If this settings base has a setting value for it, look that up.
+            if (const auto it = settings.find(key); it != settings.end())
+            {
+#ifdef SETTINGS_PROFILING
+                SettingsProfiler::getInstance().recordDepth(key, lookup_depth);
+#endif
+                return it->second;
+            }
+
+            const std::unordered_map<std::string, ExtruderTrain*>& limit_to_extruder = Application::getInstance().current_slice_->scene.limit_to_extruder;
+            if (const auto it = limit_to_extruder.find(key.str()); it != limit_to_extruder.end())
+            {
+#ifdef SETTINGS_PROFILING
+                SettingsProfiler::getInstance().recordDepth(key, lookup_depth);
+#endif
+                return it->second->settings_.getWithoutLimiting(key);
+            }
+
+            if (parent)
+            {
+#ifdef SETTINGS_PROFILING
+                lookup_depth++;
+                std::string value = parent->get<std::string>(key);
+                lookup_depth--;
+                return value;
+#else
+                return parent->get<std::string>(key);
+#endif
+            }
 
-    spdlog::error("Trying to retrieve setting with no value given: {}", key);
-    std::exit(2);
+            spdlog::error("Trying to retrieve setting with no value given: {}", key.view());
+            std::exit(2);
+        });
 }
 
 template<>
-double Settings::get<double>(const std::string& key) const
+double Settings::get<double>(const SettingKey& key) const
 {
-    return atof(get<std::string>(key).c_str());
+    return getCached(
+        &ValueCache::doubles,
+        key,
+        [this, &key]()
+        {
+            return atof(get<std::string>(key).c_str());
+        });
 }
 
 template<>
-size_t Settings::get<size_t>(const std::string& key) const
+size_t Settings::get<size_t>(const SettingKey& key) const
 {
-    return std::stoul(get<std::string>(key).c_str());
+    return getCached(
+        &ValueCache::size_ts,
+        key,
+        [this, &key]()
+        {
+            return static_cast<size_t>(std::stoul(get<std::string>(key).c_str()));
+        });
 }
 
 template<>
-int Settings::get<int>(const std::string& key) const
+int Settings::get<int>(const SettingKey& key) const
 {
-    return atoi(get<std::string>(key).c_str());
+    return getCached(
+        &ValueCache::ints,
+        key,
+        [this, &key]()
+        {
+            return atoi(get<std::string>(key).c_str());
+        });
 }
 
 template<>
-bool Settings::get<bool>(const std::string& key) const
+bool Settings::get<bool>(const SettingKey& key) const
 {
-    const std::string& value = get<std::string>(key);
-    if (value == "on" || value == "yes" || value == "true" || value == "True")
-    {
-        return true;
-    }
-    const int num = atoi(value.c_str());
-    return num != 0;
+    return getCached(
+        &ValueCache::bools,
+        key,
+        [this, &key]()
+        {
+            const std::string& value = get<std::string>(key);
+            if (value == "on" || value == "yes" || value == "true" || value == "True")
+            {
+                return true;
+            }
+            const int num = atoi(value.c_str());
+            return num != 0;
+        });
 }
 
 template<>
-ExtruderTrain& Settings::get<ExtruderTrain&>(const std::string& key) const
+ExtruderTrain& Settings::get<ExtruderTrain&>(const SettingKey& key) const
 {
     int extruder_nr = std::atoi(get<std::string>(key).c_str());
     if (extruder_nr < 0)
@@ -119,7 +245,7 @@ ExtruderTrain& Settings::get<ExtruderTrain&>(const std::string& key) const
 }
 
 template<>
-std::vector<ExtruderTrain*> Settings::get<std::vector<ExtruderTrain*>>(const std::string& key) const
+std::vector<ExtruderTrain*> Settings::get<std::vector<ExtruderTrain*>>(const SettingKey& key) const
 {
     int extruder_nr = std::atoi(get<std::string>(key).c_str());
     std::vector<ExtruderTrain*> ret;
@@ -138,62 +264,62 @@ std::vector<ExtruderTrain*> Settings::get<std::vector<ExtruderTrain*>>(const std
 }
 
 template<>
-LayerIndex Settings::get<LayerIndex>(const std::string& key) const
+LayerIndex Settings::get<LayerIndex>(const SettingKey& key) const
 {
     // For the user we display layer numbers starting from 1, but we start counting from 0. Still it may be negative for Raft layers.
     return std::atoi(get<std::string>(key).c_str()) - 1;
 }
 
 template<>
-coord_t Settings::get<coord_t>(const std::string& key) const
+coord_t Settings::get<coord_t>(const SettingKey& key) const
 {
     return MM2INT(get<double>(key)); // The settings are all in millimetres, but we need to interpret them as microns.
 }
 
 template<>
-AngleRadians Settings::get<AngleRadians>(const std::string& key) const
+AngleRadians Settings::get<AngleRadians>(const SettingKey& key) const
 {
     return get<double>(key) * std::numbers::pi / 180; // The settings are all in degrees, but we need to interpret them as radians.
 }
 
 template<>
-AngleDegrees Settings::get<AngleDegrees>(const std::string& key) const
+AngleDegrees Settings::get<AngleDegrees>(const SettingKey& key) const
 {
     return get<double>(key);
 }
 
 template<>
-Temperature Settings::get<Temperature>(const std::string& key) const
+Temperature Settings::get<Temperature>(const SettingKey& key) const
 {
     return get<double>(key);
 }
 
 template<>
-Velocity Settings::get<Velocity>(const std::string& key) const
+Velocity Settings::get<Velocity>(const SettingKey& key) const
 {
     return get<double>(key);
 }
 
 template<>
-Acceleration Settings::get<Acceleration>(const std::string& key) const
+Acceleration Settings::get<Acceleration>(const SettingKey& key) const
 {
     return get<double>(key);
 }
 
 template<>
-Ratio Settings::get<Ratio>(const std::string& key) const
+Ratio Settings::get<Ratio>(const SettingKey& key) const
 {
     return get<double>(key) / 100.0; // The settings are all in percentages, but we need to interpret them as radians.
 }
 
 template<>
-Duration Settings::get<Duration>(const std::string& key) const
+Duration Settings::get<Duration>(const SettingKey& key) const
 {
     return get<double>(key);
 }
 
 template<>
-DraftShieldHeightLimitation Settings::get<DraftShieldHeightLimitation>(const std::string& key) const
+DraftShieldHeightLimitation Settings::get<DraftShieldHeightLimitation>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -211,7 +337,7 @@ DraftShieldHeightLimitation Settings::get<DraftShieldHeightLimitation>(const std
 }
 
 template<>
-FlowTempGraph Settings::get<FlowTempGraph>(const std::string& key) const
+FlowTempGraph Settings::get<FlowTempGraph>(const SettingKey& key) const
 {
     std::string value_string = get<std::string>(key);
 
@@ -251,7 +377,7 @@ FlowTempGraph Settings::get<FlowTempGraph>(const std::string& key) const
         }
         catch (const std::invalid_argument& e)
         {
-            spdlog::error("Couldn't read 2D graph element [{},{}] in setting {}. Ignored.", first_substring, second_substring, key);
+            spdlog::error("Couldn't read 2D graph element [{},{}] in setting {}. Ignored.", first_substring, second_substring, key.view());
         }
     }
 
@@ -259,7 +385,7 @@ FlowTempGraph Settings::get<FlowTempGraph>(const std::string& key) const
 }
 
 template<>
-Shape Settings::get<Shape>(const std::string& key) const
+Shape Settings::get<Shape>(const SettingKey& key) const
 {
     std::string value_string = get<std::string>(key);
 
@@ -307,7 +433,7 @@ Shape Settings::get<Shape>(const std::string& key) const
                 }
                 catch (const std::invalid_argument& e)
                 {
-                    spdlog::error("Couldn't read 2D graph element [{},{}] in setting '{}'. Ignored.\n", first_substring.c_str(), second_substring.c_str(), key.c_str());
+                    spdlog::error("Couldn't read 2D graph element [{},{}] in setting '{}'. Ignored.\n", first_substring.c_str(), second_substring.c_str(), key.view());
                 }
                 if (match_iter == rend)
                 {
@@ -320,7 +446,7 @@ Shape Settings::get<Shape>(const std::string& key) const
 }
 
 template<>
-Matrix4x3D Settings::get<Matrix4x3D>(const std::string& key) const
+Matrix4x3D Settings::get<Matrix4x3D>(const SettingKey& key) const
 {
     const std::string value_string = get<std::string>(key);
 
@@ -361,7 +487,7 @@ Matrix4x3D Settings::get<Matrix4x3D>(const std::string& key) const
 }
 
 template<>
-EGCodeFlavor Settings::get<EGCodeFlavor>(const std::string& key) const
+EGCodeFlavor Settings::get<EGCodeFlavor>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -393,7 +519,7 @@ EGCodeFlavor Settings::get<EGCodeFlavor>(const std::string& key) const
 }
 
 template<>
-EFillMethod Settings::get<EFillMethod>(const std::string& key) const
+EFillMethod Settings::get<EFillMethod>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -437,7 +563,7 @@ EFillMethod Settings::get<EFillMethod>(const std::string& key) const
 }
 
 template<>
-EPlatformAdhesion Settings::get<EPlatformAdhesion>(const std::string& key) const
+EPlatformAdhesion Settings::get<EPlatformAdhesion>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -459,7 +585,7 @@ EPlatformAdhesion Settings::get<EPlatformAdhesion>(const std::string& key) const
 }
 
 template<>
-ESupportType Settings::get<ESupportType>(const std::string& key) const
+ESupportType Settings::get<ESupportType>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -479,7 +605,7 @@ ESupportType Settings::get<ESupportType>(const std::string& key) const
 }
 
 template<>
-ESupportStructure Settings::get<ESupportStructure>(const std::string& key) const
+ESupportStructure Settings::get<ESupportStructure>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -498,7 +624,7 @@ ESupportStructure Settings::get<ESupportStructure>(const std::string& key) const
 
 
 template<>
-EZSeamType Settings::get<EZSeamType>(const std::string& key) const
+EZSeamType Settings::get<EZSeamType>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -520,7 +646,7 @@ EZSeamType Settings::get<EZSeamType>(const std::string& key) const
 }
 
 template<>
-EZSeamCornerPrefType Settings::get<EZSeamCornerPrefType>(const std::string& key) const
+EZSeamCornerPrefType Settings::get<EZSeamCornerPrefType>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -544,7 +670,7 @@ EZSeamCornerPrefType Settings::get<EZSeamCornerPrefType>(const std::string& key)
 }
 
 template<>
-ESurfaceMode Settings::get<ESurfaceMode>(const std::string& key) const
+ESurfaceMode Settings::get<ESurfaceMode>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -564,7 +690,7 @@ ESurfaceMode Settings::get<ESurfaceMode>(const std::string& key) const
 }
 
 template<>
-FillPerimeterGapMode Settings::get<FillPerimeterGapMode>(const std::string& key) const
+FillPerimeterGapMode Settings::get<FillPerimeterGapMode>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -582,7 +708,7 @@ FillPerimeterGapMode Settings::get<FillPerimeterGapMode>(const std::string& key)
 }
 
 template<>
-BuildPlateShape Settings::get<BuildPlateShape>(const std::string& key) const
+BuildPlateShape Settings::get<BuildPlateShape>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -600,7 +726,7 @@ BuildPlateShape Settings::get<BuildPlateShape>(const std::string& key) const
 }
 
 template<>
-CombingMode Settings::get<CombingMode>(const std::string& key) const
+CombingMode Settings::get<CombingMode>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -624,7 +750,7 @@ CombingMode Settings::get<CombingMode>(const std::string& key) const
 }
 
 template<>
-SupportDistPriority Settings::get<SupportDistPriority>(const std::string& key) const
+SupportDistPriority Settings::get<SupportDistPriority>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -642,7 +768,7 @@ SupportDistPriority Settings::get<SupportDistPriority>(const std::string& key) c
 }
 
 template<>
-SlicingTolerance Settings::get<SlicingTolerance>(const std::string& key) const
+SlicingTolerance Settings::get<SlicingTolerance>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -662,7 +788,7 @@ SlicingTolerance Settings::get<SlicingTolerance>(const std::string& key) const
 }
 
 template<>
-InsetDirection Settings::get<InsetDirection>(const std::string& key) const
+InsetDirection Settings::get<InsetDirection>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     using namespace cura::utils;
@@ -680,7 +806,7 @@ InsetDirection Settings::get<InsetDirection>(const std::string& key) const
 }
 
 template<>
-PrimeTowerMode Settings::get<PrimeTowerMode>(const std::string& key) const
+PrimeTowerMode Settings::get<PrimeTowerMode>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     if (value == "interleaved")
@@ -692,7 +818,7 @@ PrimeTowerMode Settings::get<PrimeTowerMode>(const std::string& key) const
 }
 
 template<>
-BrimLocation Settings::get<BrimLocation>(const std::string& key) const
+BrimLocation Settings::get<BrimLocation>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     if (value == "everywhere")
@@ -710,7 +836,7 @@ BrimLocation Settings::get<BrimLocation>(const std::string& key) const
 }
 
 template<>
-CoolDuringExtruderSwitch Settings::get<CoolDuringExtruderSwitch>(const std::string& key) const
+CoolDuringExtruderSwitch Settings::get<CoolDuringExtruderSwitch>(const SettingKey& key) const
 {
     const std::string& value = get<std::string>(key);
     if (value == "all_fans")
@@ -728,7 +854,7 @@ CoolDuringExtruderSwitch Settings::get<CoolDuringExtruderSwitch>(const std::stri
 }
 
 template<>
-std::vector<double> Settings::get<std::vector<double>>(const std::string& key) const
+std::vector<double> Settings::get<std::vector<double>>(const SettingKey& key) const
 {
     const std::string& value_string = get<std::string>(key);
 
@@ -762,7 +888,7 @@ std::vector<double> Settings::get<std::vector<double>>(const std::string& key) c
             }
             catch (const std::invalid_argument& e)
             {
-                spdlog::error("Couldn't read floating point value ({}) in setting {}. Ignored.", value, key);
+                spdlog::error("Couldn't read floating point value ({}) in setting {}. Ignored.", value, key.view());
             }
         }
     }
@@ -770,7 +896,7 @@ std::vector<double> Settings::get<std::vector<double>>(const std::string& key) c
 }
 
 template<>
-std::vector<int> Settings::get<std::vector<int>>(const std::string& key) const
+std::vector<int> Settings::get<std::vector<int>>(const SettingKey& key) const
 {
     std::vector<double> values_doubles = get<std::vector<double>>(key);
     std::vector<int> values_ints;
@@ -783,7 +909,7 @@ std::vector<int> Settings::get<std::vector<int>>(const std::string& key) const
 }
 
 template<>
-std::vector<AngleDegrees> Settings::get<std::vector<AngleDegrees>>(const std::string& key) const
+std::vector<AngleDegrees> Settings::get<std::vector<AngleDegrees>>(const SettingKey& key) const
 {
     std::vector<double> values_doubles = get<std::vector<double>>(key);
     return std::vector<AngleDegrees>(values_doubles.begin(), values_doubles.end()); // Cast them to AngleDegrees.
@@ -801,7 +927,7 @@ const std::string Settings::getAllSettingsString() const
     return sstream.str();
 }
 
-bool Settings::has(const std::string& key) const
+bool Settings::has(const SettingKey& key) const
 {
     return settings.find(key) != settings.end();
 }
@@ -809,13 +935,14 @@ bool Settings::has(const std::string& key) const
 void Settings::setParent(Settings* new_parent)
 {
     parent = new_parent;
+    invalidateCaches();
 }
 
-std::string Settings::getWithoutLimiting(const std::string& key) const
+std::string Settings::getWithoutLimiting(const SettingKey& key) const
 {
-    if (settings.find(key) != settings.end())
+    if (const auto it = settings.find(key); it != settings.end())
     {
-        return settings.at(key);
+        return it->second;
     }
     else if (parent)
     {
@@ -823,7 +950,7 @@ std::string Settings::getWithoutLimiting(const std::string& key) const
     }
     else
     {
-        spdlog::error("Trying to retrieve setting with no value given: {}", key);
+        spdlog::error("Trying to retrieve setting with no value given: {}", key.view());
         std::exit(2);
     }
 }
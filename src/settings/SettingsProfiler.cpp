@@ -0,0 +1,191 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "settings/SettingsProfiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+#include <spdlog/spdlog.h>
+
+namespace cura
+{
+
+SettingsProfiler::Scope::Scope(const char* type, const SettingKey& key)
+    : type_(type)
+    , key_(key)
+    , active_(SettingsProfiler::getInstance().isEnabled())
+{
+    if (active_)
+    {
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+SettingsProfiler::Scope::~Scope()
+{
+    if (! active_)
+    {
+        return;
+    }
+    const auto duration = std::chrono::steady_clock::now() - start_;
+
+    ThreadTables& tables = SettingsProfiler::getInstance().threadTables();
+    std::lock_guard lock(tables.mutex);
+    SettingKey::Map<Stats>& per_key = tables.forType(type_);
+    auto it = per_key.find(key_);
+    if (it == per_key.end())
+    {
+        it = per_key.emplace(key_.str(), Stats{}).first;
+    }
+    it->second.calls++;
+    it->second.cache_hits += cache_hit_ ? 1 : 0;
+    it->second.duration += std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+}
+
+SettingsProfiler& SettingsProfiler::getInstance()
+{
+    static SettingsProfiler instance;
+    return instance;
+}
+
+void SettingsProfiler::enable(std::string report_file)
+{
+    report_file_ = std::move(report_file);
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void SettingsProfiler::recordDepth(const SettingKey& key, size_t depth)
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+    ThreadTables& tables = threadTables();
+    std::lock_guard lock(tables.mutex);
+    auto it = tables.depths.find(key);
+    if (it == tables.depths.end())
+    {
+        it = tables.depths.emplace(key.str(), Depths{}).first;
+    }
+    it->second[std::min(depth, max_depth)]++;
+}
+
+SettingKey::Map<SettingsProfiler::Stats>& SettingsProfiler::ThreadTables::forType(const char* type)
+{
+    for (auto& [table_type, per_key] : per_type)
+    {
+        if (table_type == type || std::strcmp(table_type, type) == 0)
+        {
+            return per_key;
+        }
+    }
+    return per_type.emplace_back(type, SettingKey::Map<Stats>{}).second;
+}
+
+SettingsProfiler::ThreadTables& SettingsProfiler::threadTables()
+{
+    thread_local std::shared_ptr<ThreadTables> tables;
+    if (! tables)
+    {
+        tables = std::make_shared<ThreadTables>();
+        std::lock_guard lock(tables_mutex_);
+        tables_.push_back(tables);
+    }
+    return *tables;
+}
+
+void SettingsProfiler::report()
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+
+    // Merge the tables of all threads.
+    std::map<std::pair<std::string, std::string>, Stats> stats; // Per key and type.
+    std::map<std::string, Depths> depths;
+    {
+        std::lock_guard lock(tables_mutex_);
+        for (const std::shared_ptr<ThreadTables>& tables : tables_)
+        {
+            std::lock_guard tables_lock(tables->mutex);
+            for (auto& [type, per_key] : tables->per_type)
+            {
+                for (const auto& [key, key_stats] : per_key)
+                {
+                    Stats& merged = stats[{ key, type }];
+                    merged.calls += key_stats.calls;
+                    merged.cache_hits += key_stats.cache_hits;
+                    merged.duration += key_stats.duration;
+                }
+                per_key.clear();
+            }
+            for (const auto& [key, key_depths] : tables->depths)
+            {
+                Depths& merged = depths[key];
+                for (size_t depth = 0; depth <= max_depth; depth++)
+                {
+                    merged[depth] += key_depths[depth];
+                }
+            }
+            tables->depths.clear();
+        }
+    }
+
+    std::vector<std::pair<std::pair<std::string, std::string>, Stats>> sorted(stats.begin(), stats.end());
+    std::sort(
+        sorted.begin(),
+        sorted.end(),
+        [](const auto& a, const auto& b)
+        {
+            return std::tie(a.second.duration, a.second.calls) > std::tie(b.second.duration, b.second.calls);
+        });
+
+    constexpr size_t logged_count = 25;
+    spdlog::info("Settings lookups, the {} most expensive of {}:", std::min(logged_count, sorted.size()), sorted.size());
+    for (size_t i = 0; i < std::min(logged_count, sorted.size()); i++)
+    {
+        const auto& [key_type, key_stats] = sorted[i];
+        spdlog::info(
+            "  {} as {}: {} calls, {} cache hits, {:.3f} ms",
+            key_type.first,
+            key_type.second,
+            key_stats.calls,
+            key_stats.cache_hits,
+            std::chrono::duration<double, std::milli>(key_stats.duration).count());
+    }
+
+    if (report_file_.empty())
+    {
+        return;
+    }
+    std::ofstream file(report_file_);
+    if (! file)
+    {
+        spdlog::error("Couldn't write the settings profile to {}.", report_file_);
+        return;
+    }
+    file << "key,type,calls,cache_hits,total_ns";
+    for (size_t depth = 0; depth <= max_depth; depth++)
+    {
+        file << ",depth_" << depth;
+    }
+    file << "\n";
+    for (const auto& [key_type, key_stats] : sorted)
+    {
+        file << key_type.first << ',' << key_type.second << ',' << key_stats.calls << ',' << key_stats.cache_hits << ',' << key_stats.duration.count();
+        const Depths key_depths = depths.contains(key_type.first) ? depths[key_type.first] : Depths{};
+        for (const uint64_t count : key_depths)
+        {
+            file << ',' << count;
+        }
+        file << "\n";
+    }
+    spdlog::info("Wrote the settings profile to {}.", report_file_);
+}
+
+} // namespace cura
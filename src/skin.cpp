@@ -4,9 +4,12 @@
 #include "skin.h"
 
 #include <cmath> // std::ceil
+#include <optional>
+#include <vector>
 
 #include "Application.h" //To get settings.
 #include "ExtruderTrain.h"
+#include "SkinOutlineCache.h"
 #include "Slice.h"
 #include "WallToolPaths.h"
 #include "infill.h"
@@ -15,6 +18,8 @@
 #include "settings/types/Ratio.h"
 #include "sliceDataStorage.h"
 #include "utils/Simplify.h"
+#include "utils/ThreadPool.h"
+#include "utils/TraceSpan.h"
 #include "utils/math.h"
 #include "utils/polygonUtils.h"
 
@@ -34,7 +39,7 @@ coord_t SkinInfillAreaComputation::getSkinLineWidth(const SliceMeshStorage& mesh
     return skin_line_width;
 }
 
-SkinInfillAreaComputation::SkinInfillAreaComputation(const LayerIndex& layer_nr, SliceMeshStorage& mesh, bool process_infill)
+SkinInfillAreaComputation::SkinInfillAreaComputation(const LayerIndex& layer_nr, SliceMeshStorage& mesh, bool process_infill, SkinOutlineCache* outline_cache)
     : layer_nr_(layer_nr)
     , mesh_(mesh)
     , bottom_layer_count_(mesh.settings.get<size_t>("bottom_layers"))
@@ -47,6 +52,7 @@ SkinInfillAreaComputation::SkinInfillAreaComputation(const LayerIndex& layer_nr,
     , bottom_skin_preshrink_(mesh.settings.get<coord_t>("bottom_skin_preshrink"))
     , top_skin_expand_distance_(mesh.settings.get<coord_t>("top_skin_expand_distance"))
     , bottom_skin_expand_distance_(mesh.settings.get<coord_t>("bottom_skin_expand_distance"))
+    , outline_cache_(outline_cache)
 {
 }
 
@@ -74,6 +80,35 @@ Shape SkinInfillAreaComputation::getOutlineOnLayer(const SliceLayerPart& part_he
     return result;
 }
 
+/*
+ * This function is executed in a parallel region based on layer_nr.
+ * When modifying make sure any changes does not introduce data races.
+ *
+ * this function may only read/write the skin and infill from the *current* layer.
+ */
+void SkinInfillAreaComputation::intersectOutlinesOnLayers(const SliceLayerPart& part_here, const LayerIndex first, const LayerIndex last, Shape& outlines)
+{
+    if (outline_cache_ == nullptr || last - first < 1)
+    {
+        for (LayerIndex layer2_nr = first; layer2_nr <= last; layer2_nr++)
+        {
+            outlines = outlines.intersection(getOutlineOnLayer(part_here, layer2_nr));
+        }
+        return;
+    }
+
+    // The outlines of the parts that are nowhere near this part don't change the result here, so leave them out of the intersection.
+    Shape outlines_on_layers;
+    for (Polygon& polygon : outline_cache_->intersection(first, last))
+    {
+        if (part_here.boundaryBox.hit(AABB(polygon)))
+        {
+            outlines_on_layers.push_back(std::move(polygon));
+        }
+    }
+    outlines = outlines.intersection(outlines_on_layers);
+}
+
 /*
  * This function is executed in a parallel region based on layer_nr.
  * When modifying make sure any changes does not introduce data races.
@@ -85,6 +120,7 @@ Shape SkinInfillAreaComputation::getOutlineOnLayer(const SliceLayerPart& part_he
  */
 void SkinInfillAreaComputation::generateSkinsAndInfill()
 {
+    CURA_TRACE_SPAN("SkinInfillAreaComputation::generateSkinsAndInfill");
     generateSkinAndInfillAreas();
 
     SliceLayer* layer = &mesh_.layers[layer_nr_];
@@ -186,10 +222,7 @@ void SkinInfillAreaComputation::calculateBottomSkin(const SliceLayerPart& part,
     Shape not_air = getOutlineOnLayer(part, bottom_check_start_layer_idx);
     if (! no_small_gaps_heuristic_)
     {
-        for (int downskin_layer_nr = bottom_check_start_layer_idx + 1; downskin_layer_nr < layer_nr_; downskin_layer_nr++)
-        {
-            not_air = not_air.intersection(getOutlineOnLayer(part, downskin_layer_nr));
-        }
+        intersectOutlinesOnLayers(part, bottom_check_start_layer_idx + 1, layer_nr_ - 1, not_air);
     }
     const double min_infill_area = mesh_.settings.get<double>("min_infill_area");
     if (min_infill_area > 0.0)
@@ -211,10 +244,7 @@ void SkinInfillAreaComputation::calculateTopSkin(const SliceLayerPart& part, Sha
     Shape not_air = getOutlineOnLayer(part, layer_nr_ + top_layer_count_);
     if (! no_small_gaps_heuristic_)
     {
-        for (int upskin_layer_nr = layer_nr_ + 1; upskin_layer_nr < layer_nr_ + top_layer_count_; upskin_layer_nr++)
-        {
-            not_air = not_air.intersection(getOutlineOnLayer(part, upskin_layer_nr));
-        }
+        intersectOutlinesOnLayers(part, layer_nr_ + 1, layer_nr_ + top_layer_count_ - 1, not_air);
     }
 
     const double min_infill_area = mesh_.settings.get<double>("min_infill_area");
@@ -314,6 +344,7 @@ void SkinInfillAreaComputation::applySkinExpansion(const Shape& original_outline
  */
 void SkinInfillAreaComputation::generateInfill(SliceLayerPart& part)
 {
+    CURA_TRACE_SPAN("SkinInfillAreaComputation::generateInfill");
     // Generate infill everywhere where there wasn't any skin.
     part.infill_area.removeSmallAreas(MIN_AREA_SIZE);
 }
@@ -354,11 +385,7 @@ Shape SkinInfillAreaComputation::generateFilledAreaAbove(SliceLayerPart& part, s
     Shape filled_area_above = getOutlineOnLayer(part, layer_nr_ + roofing_layer_count);
     if (! no_small_gaps_heuristic_)
     {
-        for (int layer_nr_above = layer_nr_ + 1; layer_nr_above < layer_nr_ + roofing_layer_count; layer_nr_above++)
-        {
-            Shape outlines_above = getOutlineOnLayer(part, layer_nr_above);
-            filled_area_above = filled_area_above.intersection(outlines_above);
-        }
+        intersectOutlinesOnLayers(part, layer_nr_ + 1, layer_nr_ + roofing_layer_count - 1, filled_area_above);
     }
     if (layer_nr_ > 0)
     {
@@ -396,12 +423,7 @@ Shape SkinInfillAreaComputation::generateFilledAreaBelow(SliceLayerPart& part, s
 
     if (! no_small_gaps_heuristic_)
     {
-        const int next_lowest_flooring_layer = lowest_flooring_layer + 1;
-        for (int layer_nr_below = next_lowest_flooring_layer; layer_nr_below < layer_nr_; layer_nr_below++)
-        {
-            Shape outlines_below = getOutlineOnLayer(part, layer_nr_below);
-            filled_area_below = filled_area_below.intersection(outlines_below);
-        }
+        intersectOutlinesOnLayers(part, lowest_flooring_layer + 1, layer_nr_ - 1, filled_area_below);
     }
     return filled_area_below;
 }
@@ -471,78 +493,130 @@ void SkinInfillAreaComputation::generateGradualInfill(SliceMeshStorage& mesh)
     const auto infill_wall_count = mesh.settings.get<size_t>("infill_wall_line_count");
     const auto infill_wall_width = mesh.settings.get<coord_t>("infill_line_width");
     const auto is_connected = mesh.settings.get<bool>("zig_zaggify_infill") || mesh.settings.get<EFillMethod>("infill_pattern") == EFillMethod::ZIG_ZAG;
-    for (LayerIndex layer_idx = 0; layer_idx < static_cast<LayerIndex>(mesh.layers.size()); layer_idx++)
-    { // loop also over layers which don't contain infill cause of bottom_ and top_layer to initialize their infill_area_per_combine_per_density
-        SliceLayer& layer = mesh.layers[layer_idx];
 
-        for (SliceLayerPart& part : layer.parts)
+    /* Each step of less dense infill is where the infill is below infill on all layers of the step above it. Which layers those are only depends on the layer that
+    the step starts at, so the infill on all of them is computed once for every layer that a step can start at, and shared by all layers with a step starting there.
+    They only read the own infill areas of the layers, so they can all be computed concurrently. Nothing means that the step has no layers to limit the infill. */
+    const auto layer_count = static_cast<LayerIndex>(mesh.layers.size());
+    const LayerIndex first_step_start = std::max(mesh_min_layer, LayerIndex(0));
+    const LayerIndex last_step_start = max_infill_steps == 0
+                                         ? first_step_start - 1
+                                         : std::min(layer_count - 1, mesh_max_layer + static_cast<LayerIndex>((max_infill_steps - 1) * gradual_infill_step_layer_count));
+    const size_t step_start_count = last_step_start >= first_step_start ? static_cast<size_t>(last_step_start - first_step_start + 1) : 0;
+    std::vector<std::optional<Shape>> infill_above_step(step_start_count);
+    std::vector<std::vector<AABB>> infill_above_step_boxes(step_start_count); // The bounding box of each polygon of infill_above_step, to only intersect with those nearby.
+    cura::parallel_for<size_t>(
+        0,
+        step_start_count,
+        [&](const size_t step_start_idx)
         {
-            assert((part.infill_area_per_combine_per_density.empty() && "infill_area_per_combine_per_density is supposed to be uninitialized"));
-
-            const Shape& infill_area = Infill::generateWallToolPaths(
-                part.infill_wall_toolpaths,
-                part.getOwnInfillArea(),
-                infill_wall_count,
-                infill_wall_width,
-                mesh.settings,
-                layer_idx,
-                SectionType::SKIN);
-
-            if (infill_area.empty() || layer_idx < mesh_min_layer || layer_idx > mesh_max_layer)
-            { // initialize infill_area_per_combine_per_density empty
-                part.infill_area_per_combine_per_density.emplace_back(); // create a new infill_area_per_combine
-                part.infill_area_per_combine_per_density.back().emplace_back(); // put empty infill area in the newly constructed infill_area_per_combine
-                // note: no need to copy part.infill_area, cause it's the empty vector anyway
-                continue;
+            const LayerIndex step_start = first_step_start + static_cast<LayerIndex>(step_start_idx);
+            const LayerIndex min_layer = step_start + static_cast<size_t>(layer_skip_count);
+            const LayerIndex max_layer = step_start + gradual_infill_step_layer_count;
+            std::optional<Shape>& infill_above = infill_above_step[step_start_idx];
+            for (double upper_layer_idx = min_layer; upper_layer_idx <= max_layer; upper_layer_idx += layer_skip_count)
+            {
+                if (upper_layer_idx >= mesh.layers.size())
+                {
+                    infill_above = Shape();
+                    break;
+                }
+                Shape upper_infill;
+                for (const SliceLayerPart& upper_layer_part : mesh.layers[static_cast<size_t>(upper_layer_idx)].parts)
+                {
+                    upper_infill.push_back(upper_layer_part.getOwnInfillArea());
+                }
+                infill_above = infill_above ? infill_above->intersection(upper_infill) : std::move(upper_infill);
+                if (infill_above->empty())
+                {
+                    break;
+                }
             }
-            Shape less_dense_infill = infill_area; // one step less dense with each infill_step
-            Shape sum_more_dense; // NOTE: Only used for zig-zag or connected fills.
-            for (size_t infill_step = 0; infill_step < max_infill_steps; infill_step++)
+            if (infill_above)
             {
-                LayerIndex min_layer = layer_idx + infill_step * gradual_infill_step_layer_count + static_cast<size_t>(layer_skip_count);
-                LayerIndex max_layer = layer_idx + (infill_step + 1) * gradual_infill_step_layer_count;
-
-                for (double upper_layer_idx = min_layer; upper_layer_idx <= max_layer; upper_layer_idx += layer_skip_count)
+                infill_above_step_boxes[step_start_idx].reserve(infill_above->size());
+                for (const Polygon& polygon : *infill_above)
+                {
+                    infill_above_step_boxes[step_start_idx].emplace_back(polygon);
+                }
+            }
+        });
+
+    // With the steps above every layer known, the layers don't depend on each other any more.
+    cura::parallel_for<size_t>(
+        0,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
+        { // loop also over layers which don't contain infill cause of bottom_ and top_layer to initialize their infill_area_per_combine_per_density
+            const auto layer_idx = static_cast<LayerIndex>(layer_nr);
+            SliceLayer& layer = mesh.layers[layer_idx];
+
+            for (SliceLayerPart& part : layer.parts)
+            {
+                assert((part.infill_area_per_combine_per_density.empty() && "infill_area_per_combine_per_density is supposed to be uninitialized"));
+
+                const Shape& infill_area = Infill::generateWallToolPaths(
+                    part.infill_wall_toolpaths,
+                    part.getOwnInfillArea(),
+                    infill_wall_count,
+                    infill_wall_width,
+                    mesh.settings,
+                    layer_idx,
+                    SectionType::SKIN);
+
+                if (infill_area.empty() || layer_idx < mesh_min_layer || layer_idx > mesh_max_layer)
+                { // initialize infill_area_per_combine_per_density empty
+                    part.infill_area_per_combine_per_density.emplace_back(); // create a new infill_area_per_combine
+                    part.infill_area_per_combine_per_density.back().emplace_back(); // put empty infill area in the newly constructed infill_area_per_combine
+                    // note: no need to copy part.infill_area, cause it's the empty vector anyway
+                    continue;
+                }
+                Shape less_dense_infill = infill_area; // one step less dense with each infill_step
+                Shape sum_more_dense; // NOTE: Only used for zig-zag or connected fills.
+                for (size_t infill_step = 0; infill_step < max_infill_steps; infill_step++)
                 {
-                    if (upper_layer_idx >= mesh.layers.size())
+                    const LayerIndex step_start = layer_idx + infill_step * gradual_infill_step_layer_count;
+                    if (step_start > last_step_start)
                     {
-                        less_dense_infill.clear();
+                        less_dense_infill.clear(); // The step reaches past the top of the mesh.
                         break;
                     }
-                    const SliceLayer& upper_layer = mesh.layers[static_cast<size_t>(upper_layer_idx)];
-                    Shape relevent_upper_polygons;
-                    for (const SliceLayerPart& upper_layer_part : upper_layer.parts)
+                    const size_t step_start_idx = static_cast<size_t>(step_start - first_step_start);
+                    if (const std::optional<Shape>& infill_above = infill_above_step[step_start_idx])
                     {
-                        if (! upper_layer_part.boundaryBox.hit(part.boundaryBox))
+                        Shape relevant_infill_above;
+                        for (size_t polygon_idx = 0; polygon_idx < infill_above->size(); polygon_idx++)
                         {
-                            continue;
+                            if (infill_above_step_boxes[step_start_idx][polygon_idx].hit(part.boundaryBox))
+                            {
+                                relevant_infill_above.push_back((*infill_above)[polygon_idx]);
+                            }
                         }
-                        relevent_upper_polygons.push_back(upper_layer_part.getOwnInfillArea());
+                        less_dense_infill = less_dense_infill.intersection(relevant_infill_above);
+                    }
+                    if (less_dense_infill.empty())
+                    {
+                        break;
+                    }
+                    // add new infill_area_per_combine for the current density
+                    part.infill_area_per_combine_per_density.emplace_back();
+                    std::vector<Shape>& infill_area_per_combine_current_density = part.infill_area_per_combine_per_density.back();
+                    const Shape more_dense_infill = infill_area.difference(less_dense_infill);
+                    infill_area_per_combine_current_density.push_back(
+                        simplifier.polygon(more_dense_infill.difference(sum_more_dense).offset(-infill_wall_width).offset(infill_wall_width)));
+                    if (is_connected)
+                    {
+                        sum_more_dense = sum_more_dense.unionPolygons(more_dense_infill);
                     }
-                    less_dense_infill = less_dense_infill.intersection(relevent_upper_polygons);
-                }
-                if (less_dense_infill.empty())
-                {
-                    break;
                 }
-                // add new infill_area_per_combine for the current density
                 part.infill_area_per_combine_per_density.emplace_back();
                 std::vector<Shape>& infill_area_per_combine_current_density = part.infill_area_per_combine_per_density.back();
-                const Shape more_dense_infill = infill_area.difference(less_dense_infill);
                 infill_area_per_combine_current_density.push_back(
-                    simplifier.polygon(more_dense_infill.difference(sum_more_dense).offset(-infill_wall_width).offset(infill_wall_width)));
-                if (is_connected)
-                {
-                    sum_more_dense = sum_more_dense.unionPolygons(more_dense_infill);
-                }
+                    simplifier.polygon(infill_area.difference(sum_more_dense).offset(-infill_wall_width).offset(infill_wall_width)));
+                part.infill_area_own = std::nullopt; // clear infill_area_own, it's not needed any more.
+                assert(! part.infill_area_per_combine_per_density.empty() && "infill_area_per_combine_per_density is now initialized");
             }
-            part.infill_area_per_combine_per_density.emplace_back();
-            std::vector<Shape>& infill_area_per_combine_current_density = part.infill_area_per_combine_per_density.back();
-            infill_area_per_combine_current_density.push_back(simplifier.polygon(infill_area.difference(sum_more_dense).offset(-infill_wall_width).offset(infill_wall_width)));
-            part.infill_area_own = std::nullopt; // clear infill_area_own, it's not needed any more.
-            assert(! part.infill_area_per_combine_per_density.empty() && "infill_area_per_combine_per_density is now initialized");
-        }
-    }
+        });
 }
 
 void SkinInfillAreaComputation::combineInfillLayers(SliceMeshStorage& mesh)
@@ -573,65 +647,184 @@ void SkinInfillAreaComputation::combineInfillLayers(SliceMeshStorage& mesh)
     min_layer -= min_layer % amount; // Round upwards to the nearest layer divisible by infill_sparse_combine.
     LayerIndex max_layer = static_cast<LayerIndex>(mesh.layers.size()) - 1 - mesh.settings.get<size_t>("top_layers");
     max_layer -= max_layer % amount; // Round downwards to the nearest layer divisible by infill_sparse_combine.
-    for (LayerIndex layer_idx = min_layer; layer_idx <= max_layer; layer_idx += amount) // Skip every few layers, but extrude more.
+    if (max_layer < min_layer)
     {
-        SliceLayer* layer = &mesh.layers[layer_idx];
-        for (size_t combine_count_here = 1; combine_count_here < amount; combine_count_here++)
+        return;
+    }
+    /* Each group of combined layers only touches its top layer and the amount - 1 layers below it, which are above the top layer of the group below.
+    So the groups are independent and can be combined concurrently, while each group is still combined in the same order. */
+    const size_t group_count = static_cast<size_t>(max_layer.value - min_layer.value) / amount + 1;
+    cura::parallel_for<size_t>(
+        0,
+        group_count,
+        [&](const size_t group_idx)
         {
-            if (layer_idx < static_cast<LayerIndex>(combine_count_here))
+            const LayerIndex layer_idx = min_layer + static_cast<LayerIndex>(group_idx * amount); // Skip every few layers, but extrude more.
+            SliceLayer* layer = &mesh.layers[layer_idx];
+            for (size_t combine_count_here = 1; combine_count_here < amount; combine_count_here++)
             {
-                break;
-            }
+                if (layer_idx < static_cast<LayerIndex>(combine_count_here))
+                {
+                    break;
+                }
 
-            LayerIndex lower_layer_idx = layer_idx - combine_count_here;
-            if (lower_layer_idx < min_layer)
-            {
-                break;
+                LayerIndex lower_layer_idx = layer_idx - combine_count_here;
+                if (lower_layer_idx < min_layer)
+                {
+                    break;
+                }
+                SliceLayer* lower_layer = &mesh.layers[lower_layer_idx];
+                for (SliceLayerPart& part : layer->parts)
+                {
+                    for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density.size(); density_idx++)
+                    { // go over each density of gradual infill (these density areas overlap!)
+                        std::vector<Shape>& infill_area_per_combine = part.infill_area_per_combine_per_density[density_idx];
+                        Shape result;
+                        for (SliceLayerPart& lower_layer_part : lower_layer->parts)
+                        {
+                            if (part.boundaryBox.hit(lower_layer_part.boundaryBox))
+                            {
+                                Shape intersection = infill_area_per_combine[combine_count_here - 1].intersection(lower_layer_part.infill_area).offset(-200).offset(200);
+                                result.push_back(intersection); // add area to be thickened
+                                infill_area_per_combine[combine_count_here - 1]
+                                    = infill_area_per_combine[combine_count_here - 1].difference(intersection); // remove thickened area from less thick layer here
+                                unsigned int max_lower_density_idx = density_idx;
+                                // Generally: remove only from *same density* areas on layer below
+                                // If there are no same density areas, then it's ok to print them anyway
+                                // Don't remove other density areas
+                                if (density_idx == part.infill_area_per_combine_per_density.size() - 1)
+                                {
+                                    // For the most dense areas on a given layer the density of that area is doubled.
+                                    // This means that - if the lower layer has more densities -
+                                    // all those lower density lines are included in the most dense of this layer.
+                                    // We therefore compare the most dense are on this layer with all densities
+                                    // of the lower layer with the same or higher density index
+                                    max_lower_density_idx = lower_layer_part.infill_area_per_combine_per_density.size() - 1;
+                                }
+                                for (size_t lower_density_idx = density_idx;
+                                     lower_density_idx <= max_lower_density_idx && lower_density_idx < lower_layer_part.infill_area_per_combine_per_density.size();
+                                     lower_density_idx++)
+                                {
+                                    std::vector<Shape>& lower_infill_area_per_combine = lower_layer_part.infill_area_per_combine_per_density[lower_density_idx];
+                                    lower_infill_area_per_combine[0]
+                                        = lower_infill_area_per_combine[0].difference(intersection); // remove thickened area from lower (single thickness) layer
+                                }
+                            }
+                        }
+
+                        infill_area_per_combine.push_back(result);
+                    }
+                }
             }
-            SliceLayer* lower_layer = &mesh.layers[lower_layer_idx];
-            for (SliceLayerPart& part : layer->parts)
+        });
+}
+
+void SkinInfillAreaComputation::combineSkinAbove(SliceMeshStorage& mesh)
+{
+    const auto skin_edge_support_layers = mesh.settings.get<size_t>("skin_edge_support_layers");
+    if (skin_edge_support_layers == 0 || mesh.settings.get<coord_t>("infill_line_distance") == 0)
+    {
+        return;
+    }
+    constexpr coord_t tiny_infill_offset = 20;
+
+    // Each layer only writes the skin_above of its own parts and reads the skin parts of the layers above, which are already complete.
+    cura::parallel_for<size_t>(
+        0,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
+        {
+            for (SliceLayerPart& part : mesh.layers[layer_nr].parts)
             {
-                for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density.size(); density_idx++)
-                { // go over each density of gradual infill (these density areas overlap!)
-                    std::vector<Shape>& infill_area_per_combine = part.infill_area_per_combine_per_density[density_idx];
-                    Shape result;
-                    for (SliceLayerPart& lower_layer_part : lower_layer->parts)
+                Shape skin_above_combined; // skin regions on the layers above combined with small gaps between
+
+                // working from the highest layer downwards, combine the regions of skin on all the layers
+                // but don't let the regions merge together
+                // otherwise "terraced" skin regions on separate layers will look like a single region of unbroken skin
+                for (size_t i = skin_edge_support_layers; i > 0; --i)
+                {
+                    const size_t skin_layer_nr = layer_nr + i;
+                    if (skin_layer_nr >= mesh.layers.size())
                     {
-                        if (part.boundaryBox.hit(lower_layer_part.boundaryBox))
+                        continue;
+                    }
+                    for (const SliceLayerPart& part_i : mesh.layers[skin_layer_nr].parts)
+                    {
+                        if (! part_i.boundaryBox.hit(part.boundaryBox))
                         {
-                            Shape intersection = infill_area_per_combine[combine_count_here - 1].intersection(lower_layer_part.infill_area).offset(-200).offset(200);
-                            result.push_back(intersection); // add area to be thickened
-                            infill_area_per_combine[combine_count_here - 1]
-                                = infill_area_per_combine[combine_count_here - 1].difference(intersection); // remove thickened area from less thick layer here
-                            unsigned int max_lower_density_idx = density_idx;
-                            // Generally: remove only from *same density* areas on layer below
-                            // If there are no same density areas, then it's ok to print them anyway
-                            // Don't remove other density areas
-                            if (density_idx == part.infill_area_per_combine_per_density.size() - 1)
+                            continue; // Its skin can't overlap with the infill of this part.
+                        }
+                        for (const SkinPart& skin_part : part_i.skin_parts)
+                        {
+                            // Limit considered areas to the ones that should have infill underneath at the current layer.
+                            const Shape relevant_outline = skin_part.outline.intersection(part.getOwnInfillArea());
+
+                            if (! skin_above_combined.empty())
                             {
-                                // For the most dense areas on a given layer the density of that area is doubled.
-                                // This means that - if the lower layer has more densities -
-                                // all those lower density lines are included in the most dense of this layer.
-                                // We therefore compare the most dense are on this layer with all densities
-                                // of the lower layer with the same or higher density index
-                                max_lower_density_idx = lower_layer_part.infill_area_per_combine_per_density.size() - 1;
+                                // does this skin part overlap with any of the skin parts on the layers above?
+                                const Shape overlap = skin_above_combined.intersection(relevant_outline);
+                                if (! overlap.empty())
+                                {
+                                    // yes, it overlaps, need to leave a gap between this skin part and the others
+                                    if (i > 1) // this layer is the 2nd or higher layer above the layer whose infill we're printing
+                                    {
+                                        // looking from the side, if the combined regions so far look like this...
+                                        //
+                                        //     ----------------------------------
+                                        //
+                                        // and the new skin part looks like this...
+                                        //
+                                        //             -------------------------------------
+                                        //
+                                        // the result should be like this...
+                                        //
+                                        //     ------- -------------------------- ----------
+
+                                        // expand the overlap region slightly to make a small gap
+                                        const Shape overlap_expanded = overlap.offset(tiny_infill_offset);
+                                        // subtract the expanded overlap region from the regions accumulated from higher layers
+                                        skin_above_combined = skin_above_combined.difference(overlap_expanded);
+                                        // subtract the expanded overlap region from this skin part and add the remainder to the overlap region
+                                        skin_above_combined.push_back(relevant_outline.difference(overlap_expanded));
+                                        // and add the overlap area as well
+                                        skin_above_combined.push_back(overlap);
+                                    }
+                                    else // this layer is the 1st layer above the layer whose infill we're printing
+                                    {
+                                        // add this layer's skin region without subtracting the overlap but still make a gap between this skin region and what has been accumulated
+                                        // so far we do this so that these skin region edges will definitely have infill walls below them
+
+                                        // looking from the side, if the combined regions so far look like this...
+                                        //
+                                        //     ----------------------------------
+                                        //
+                                        // and the new skin part looks like this...
+                                        //
+                                        //             -------------------------------------
+                                        //
+                                        // the result should be like this...
+                                        //
+                                        //     ------- -------------------------------------
+
+                                        skin_above_combined = skin_above_combined.difference(relevant_outline.offset(tiny_infill_offset));
+                                        skin_above_combined.push_back(relevant_outline);
+                                    }
+                                }
+                                else // no overlap
+                                {
+                                    skin_above_combined.push_back(relevant_outline);
+                                }
                             }
-                            for (size_t lower_density_idx = density_idx;
-                                 lower_density_idx <= max_lower_density_idx && lower_density_idx < lower_layer_part.infill_area_per_combine_per_density.size();
-                                 lower_density_idx++)
+                            else // this is the first skin region we have looked at
                             {
-                                std::vector<Shape>& lower_infill_area_per_combine = lower_layer_part.infill_area_per_combine_per_density[lower_density_idx];
-                                lower_infill_area_per_combine[0]
-                                    = lower_infill_area_per_combine[0].difference(intersection); // remove thickened area from lower (single thickness) layer
+                                skin_above_combined.push_back(relevant_outline);
                             }
                         }
                     }
-
-                    infill_area_per_combine.push_back(result);
                 }
+                part.skin_above = std::move(skin_above_combined);
             }
-        }
-    }
+        });
 }
 
 /*
@@ -3,7 +3,11 @@
 
 #include "sliceDataStorage.h"
 
+#include <algorithm>
+#include <cstring>
+#include <map>
 #include <numbers>
+#include <type_traits>
 
 #include <spdlog/spdlog.h>
 
@@ -19,11 +23,217 @@
 #include "infill/SubDivCube.h" // For the destructor
 #include "raft.h"
 #include "utils/ExtrusionLine.h"
+#include "utils/ThreadPool.h"
 #include "utils/math.h" //For PI.
 
 namespace cura
 {
 
+namespace
+{
+
+//! Append a value to data that is spilled, in the byte order of this machine.
+template<typename T>
+requires std::is_arithmetic_v<T>
+void appendValue(std::string& data, const T value)
+{
+    data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//! Reads the values added with appendValue. Once anything is missing, everything reads as failed.
+class SpillReader
+{
+public:
+    explicit SpillReader(const std::string& data)
+        : data_(data)
+    {
+    }
+
+    template<typename T>
+    requires std::is_arithmetic_v<T>
+    bool read(T& value)
+    {
+        if (data_.size() - position_ < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value, data_.data() + position_, sizeof(T));
+        position_ += sizeof(T);
+        return true;
+    }
+
+    [[nodiscard]] bool atEnd() const
+    {
+        return position_ == data_.size();
+    }
+
+private:
+    const std::string& data_;
+    size_t position_ = 0;
+};
+
+std::string encodeWalls(const std::vector<VariableWidthLines>& walls)
+{
+    std::string data;
+    appendValue(data, static_cast<uint64_t>(walls.size()));
+    for (const VariableWidthLines& lines : walls)
+    {
+        appendValue(data, static_cast<uint64_t>(lines.size()));
+        for (const ExtrusionLine& line : lines)
+        {
+            appendValue(data, static_cast<uint64_t>(line.inset_idx_));
+            appendValue(data, static_cast<uint8_t>(line.is_odd_));
+            appendValue(data, static_cast<uint8_t>(line.is_closed_));
+            appendValue(data, static_cast<uint64_t>(line.junctions_.size()));
+            for (const ExtrusionJunction& junction : line.junctions_)
+            {
+                appendValue(data, junction.p_.X);
+                appendValue(data, junction.p_.Y);
+                appendValue(data, junction.w_);
+                appendValue(data, static_cast<uint64_t>(junction.perimeter_index_));
+            }
+            appendValue(data, static_cast<uint64_t>(line.corner_angles_.size()));
+            for (const double angle : line.corner_angles_)
+            {
+                appendValue(data, angle);
+            }
+        }
+    }
+    return data;
+}
+
+std::optional<std::vector<VariableWidthLines>> decodeWalls(const std::string& data)
+{
+    SpillReader reader(data);
+    std::vector<VariableWidthLines> walls;
+    uint64_t wall_count;
+    bool complete = reader.read(wall_count);
+    for (uint64_t wall_idx = 0; complete && wall_idx < wall_count; wall_idx++)
+    {
+        VariableWidthLines& lines = walls.emplace_back();
+        uint64_t line_count;
+        complete = reader.read(line_count);
+        for (uint64_t line_idx = 0; complete && line_idx < line_count; line_idx++)
+        {
+            uint64_t inset_idx;
+            uint8_t is_odd;
+            uint8_t is_closed;
+            uint64_t junction_count;
+            complete = reader.read(inset_idx) && reader.read(is_odd) && reader.read(is_closed) && reader.read(junction_count);
+            if (! complete)
+            {
+                break;
+            }
+            ExtrusionLine& line = lines.emplace_back(inset_idx, is_odd != 0, is_closed != 0);
+            for (uint64_t junction_idx = 0; complete && junction_idx < junction_count; junction_idx++)
+            {
+                coord_t x;
+                coord_t y;
+                coord_t width;
+                uint64_t perimeter_index;
+                complete = reader.read(x) && reader.read(y) && reader.read(width) && reader.read(perimeter_index);
+                if (complete)
+                {
+                    line.junctions_.emplace_back(Point2LL(x, y), width, static_cast<coord_t>(perimeter_index));
+                }
+            }
+            uint64_t angle_count;
+            complete = complete && reader.read(angle_count);
+            for (uint64_t angle_idx = 0; complete && angle_idx < angle_count; angle_idx++)
+            {
+                double angle;
+                complete = reader.read(angle);
+                if (complete)
+                {
+                    line.corner_angles_.push_back(angle);
+                }
+            }
+        }
+    }
+    if (! complete || ! reader.atEnd())
+    {
+        return std::nullopt;
+    }
+    return walls;
+}
+
+//! Sums the points and bytes of the geometry in the slice data, per member.
+class FootprintCounter
+{
+public:
+    template<class LineType>
+    void add(const std::string_view field, const LinesSet<LineType>& lines)
+    {
+        count(field, lines.pointCount(), lines.pointCount() * sizeof(Point2LL) + lines.size() * sizeof(LineType));
+    }
+
+    void add(const std::string_view field, const CompactShape& shape)
+    {
+        count(field, shape.pointCount(), shape.byteSize());
+    }
+
+    void add(const std::string_view field, const MixedLinesSet& lines)
+    {
+        for (const PolylinePtr& line : lines)
+        {
+            count(field, line->size(), line->size() * sizeof(Point2LL) + sizeof(Polyline));
+        }
+    }
+
+    void add(const std::string_view field, const VariableWidthLines& lines)
+    {
+        for (const ExtrusionLine& line : lines)
+        {
+            count(field, line.size(), line.size() * sizeof(ExtrusionJunction) + line.corner_angles_.size() * sizeof(double) + sizeof(ExtrusionLine));
+        }
+    }
+
+    template<typename T>
+    void add(const std::string_view field, const std::vector<T>& items)
+    {
+        for (const T& item : items)
+        {
+            add(field, item);
+        }
+    }
+
+    std::vector<StorageFootprint> result() const
+    {
+        std::vector<StorageFootprint> footprints;
+        for (const auto& [field, footprint] : footprints_)
+        {
+            if (footprint.points > 0)
+            {
+                footprints.push_back(footprint);
+            }
+        }
+        std::stable_sort(
+            footprints.begin(),
+            footprints.end(),
+            [](const StorageFootprint& a, const StorageFootprint& b)
+            {
+                return a.bytes > b.bytes;
+            });
+        return footprints;
+    }
+
+private:
+    void count(const std::string_view field, const size_t points, const size_t bytes)
+    {
+        auto found = footprints_.find(field);
+        if (found == footprints_.end())
+        {
+            found = footprints_.emplace(std::string(field), StorageFootprint{ .field = std::string(field) }).first;
+        }
+        found->second.points += points;
+        found->second.bytes += bytes;
+    }
+
+    std::map<std::string, StorageFootprint, std::less<>> footprints_;
+};
+
+} // namespace
+
 SupportStorage::SupportStorage()
     : generated(false)
     , layer_nr_max_filled_layer(-1)
@@ -55,6 +265,10 @@ const Shape& SliceLayerPart::getOwnInfillArea() const
 
 bool SliceLayerPart::hasWallAtInsetIndex(size_t inset_idx) const
 {
+    if (spilled_walls)
+    {
+        return inset_idx < spilled_wall_insets.size() && spilled_wall_insets[inset_idx];
+    }
     for (const VariableWidthLines& lines : wall_toolpaths)
     {
         for (const ExtrusionLine& line : lines)
@@ -94,6 +308,25 @@ void SliceLayer::getOutlines(Shape& result, bool external_polys_only) const
     }
 }
 
+void SliceLayer::releasePlannedGeometry()
+{
+    for (SliceLayerPart& part : parts)
+    {
+        part.infill_area = Shape();
+        part.infill_area_own.reset();
+        part.infill_area_per_combine_per_density = {};
+        part.skin_above = Shape();
+        part.infill_wall_toolpaths = {};
+        part.skin_parts = {};
+        part.wall_toolpaths = {};
+    }
+    open_polylines = OpenLinesSet();
+    top_surface.ironed_areas = Shape();
+    top_surface.ironing_paths = {};
+    top_surface.ironing_polygons = Shape();
+    top_surface.ironing_lines = OpenLinesSet();
+}
+
 SliceMeshStorage::SliceMeshStorage(Mesh* mesh, const size_t slice_layer_count)
     : settings(mesh->settings_)
     , mesh_name(mesh->mesh_name_)
@@ -230,6 +463,65 @@ bool SliceMeshStorage::getExtruderIsUsed(const size_t extruder_nr, const LayerIn
     return false;
 }
 
+void SliceMeshStorage::spillWalls(const LayerIndex layer_nr)
+{
+    if (! wall_spill)
+    {
+        return;
+    }
+    for (SliceLayerPart& part : layers[layer_nr].parts)
+    {
+        if (part.spilled_walls || part.wall_toolpaths.empty())
+        {
+            continue;
+        }
+        const std::optional<SpillFile::Record> record = wall_spill->write(encodeWalls(part.wall_toolpaths));
+        if (! record)
+        {
+            continue; // Keep them in memory then.
+        }
+        part.spilled_wall_insets.clear();
+        for (const VariableWidthLines& lines : part.wall_toolpaths)
+        {
+            for (const ExtrusionLine& line : lines)
+            {
+                if (line.inset_idx_ >= part.spilled_wall_insets.size())
+                {
+                    part.spilled_wall_insets.resize(line.inset_idx_ + 1, false);
+                }
+                part.spilled_wall_insets[line.inset_idx_] = true;
+            }
+        }
+        part.spilled_walls = record;
+        part.wall_toolpaths = {};
+    }
+}
+
+void SliceMeshStorage::restoreWalls(const LayerIndex layer_nr)
+{
+    for (SliceLayerPart& part : layers[layer_nr].parts)
+    {
+        if (! part.spilled_walls)
+        {
+            continue;
+        }
+        std::optional<std::vector<VariableWidthLines>> walls = readSpilledWalls(part);
+        if (! walls)
+        {
+            spdlog::error("Lost the walls of a part of mesh {} on layer {}, which were spilled to disk.", mesh_name, layer_nr.value);
+        }
+        part.wall_toolpaths = walls ? std::move(*walls) : std::vector<VariableWidthLines>();
+        part.spilled_walls.reset();
+        part.spilled_wall_insets = {};
+    }
+}
+
+std::optional<std::vector<VariableWidthLines>> SliceMeshStorage::readSpilledWalls(const SliceLayerPart& part) const
+{
+    const std::optional<std::string> data = wall_spill->read(*part.spilled_walls);
+    return data ? decodeWalls(*data) : std::nullopt;
+}
+
 bool SliceMeshStorage::isPrinted() const
 {
     return ! settings.get<bool>("infill_mesh") && ! settings.get<bool>("cutting_mesh") && ! settings.get<bool>("anti_overhang_mesh");
@@ -394,6 +686,45 @@ AABB3D SliceDataStorage::getModelBoundingBox() const
 }
 
 std::vector<bool> SliceDataStorage::getExtrudersUsed() const
+{
+    if (extruders_used_)
+    {
+        return *extruders_used_;
+    }
+    return computeExtrudersUsed();
+}
+
+std::vector<bool> SliceDataStorage::getExtrudersUsed(const LayerIndex layer_nr) const
+{
+    if (const auto cached = extruders_used_per_layer_.iterator_at(layer_nr); cached != extruders_used_per_layer_.end())
+    {
+        return *cached;
+    }
+    return computeExtrudersUsed(layer_nr);
+}
+
+void SliceDataStorage::cacheExtrudersUsed()
+{
+    extruders_used_ = computeExtrudersUsed();
+
+    extruders_used_per_layer_.init(true);
+    const LayerIndex first_layer = -static_cast<LayerIndex>(Raft::getTotalExtraLayers());
+    std::vector<std::vector<bool>> used_per_layer(Raft::getTotalExtraLayers() + print_layer_count);
+    cura::parallel_for<size_t>(
+        0,
+        used_per_layer.size(),
+        [&](const size_t layer_idx)
+        {
+            used_per_layer[layer_idx] = computeExtrudersUsed(first_layer + static_cast<LayerIndex>(layer_idx));
+        });
+    extruders_used_per_layer_.reserve(used_per_layer.size());
+    for (std::vector<bool>& used : used_per_layer)
+    {
+        extruders_used_per_layer_.push_back(std::move(used));
+    }
+}
+
+std::vector<bool> SliceDataStorage::computeExtrudersUsed() const
 {
     std::vector<bool> ret;
     ret.resize(Application::getInstance().current_slice_->scene.extruders.size(), false);
@@ -462,7 +793,137 @@ std::vector<bool> SliceDataStorage::getExtrudersUsed() const
     return ret;
 }
 
-std::vector<bool> SliceDataStorage::getExtrudersUsed(const LayerIndex layer_nr) const
+void SliceDataStorage::releaseSupportInputs()
+{
+    for (const std::shared_ptr<SliceMeshStorage>& mesh : meshes)
+    {
+        mesh->overhang_areas = {};
+        mesh->full_overhang_areas = {};
+        mesh->overhang_points = {};
+    }
+    for (SupportLayer& support_layer : support.supportLayers)
+    {
+        support_layer.support_mesh_drop_down = Shape();
+        support_layer.support_mesh = Shape();
+        support_layer.anti_overhang = Shape();
+    }
+}
+
+void SliceDataStorage::releasePlannedLayer(const LayerIndex layer_nr)
+{
+    if (layer_nr < 0)
+    {
+        return;
+    }
+    for (const std::shared_ptr<SliceMeshStorage>& mesh : meshes)
+    {
+        if (static_cast<size_t>(layer_nr) < mesh->layers.size())
+        {
+            mesh->layers[layer_nr].releasePlannedGeometry();
+        }
+    }
+}
+
+void SliceDataStorage::restoreSpilledLayer(const LayerIndex layer_nr)
+{
+    if (layer_nr < 0)
+    {
+        return;
+    }
+    for (const std::shared_ptr<SliceMeshStorage>& mesh : meshes)
+    {
+        if (mesh->wall_spill && static_cast<size_t>(layer_nr) < mesh->layers.size())
+        {
+            mesh->restoreWalls(layer_nr);
+        }
+    }
+}
+
+std::vector<StorageFootprint> SliceDataStorage::memoryReport() const
+{
+    FootprintCounter counter;
+    for (const std::shared_ptr<SliceMeshStorage>& mesh : meshes)
+    {
+        for (const SliceLayer& layer : mesh->layers)
+        {
+            counter.add("layer.open_polylines", layer.open_polylines);
+            counter.add("layer.top_surface.areas", layer.top_surface.areas);
+            counter.add("layer.top_surface.ironed_areas", layer.top_surface.ironed_areas);
+            counter.add("layer.top_surface.ironing_paths", layer.top_surface.ironing_paths);
+            counter.add("layer.top_surface.ironing_polygons", layer.top_surface.ironing_polygons);
+            counter.add("layer.top_surface.ironing_lines", layer.top_surface.ironing_lines);
+            counter.add("layer.bottom_surface", layer.bottom_surface);
+            for (const SliceLayerPart& part : layer.parts)
+            {
+                counter.add("part.outline", part.outline);
+                counter.add("part.print_outline", part.print_outline);
+                counter.add("part.spiral_wall", part.spiral_wall);
+                counter.add("part.inner_area", part.inner_area);
+                for (const SkinPart& skin_part : part.skin_parts)
+                {
+                    counter.add("part.skin_parts.outline", skin_part.outline);
+                    counter.add("part.skin_parts.skin_fill", skin_part.skin_fill);
+                    counter.add("part.skin_parts.roofing_fill", skin_part.roofing_fill);
+                    counter.add("part.skin_parts.top_most_surface_fill", skin_part.top_most_surface_fill);
+                    counter.add("part.skin_parts.bottom_most_surface_fill", skin_part.bottom_most_surface_fill);
+                }
+                counter.add("part.wall_toolpaths", part.wall_toolpaths);
+                counter.add("part.infill_wall_toolpaths", part.infill_wall_toolpaths);
+                counter.add("part.fiberpath", part.fiberpath);
+                counter.add("part.infill_area", part.infill_area);
+                if (part.infill_area_own)
+                {
+                    counter.add("part.infill_area_own", *part.infill_area_own);
+                }
+                counter.add("part.infill_area_per_combine_per_density", part.infill_area_per_combine_per_density);
+                counter.add("part.skin_above", part.skin_above);
+            }
+        }
+        counter.add("mesh.overhang_areas", mesh->overhang_areas);
+        counter.add("mesh.full_overhang_areas", mesh->full_overhang_areas);
+        counter.add("mesh.overhang_points", mesh->overhang_points);
+    }
+
+    for (const SupportLayer& support_layer : support.supportLayers)
+    {
+        for (const SupportInfillPart& part : support_layer.support_infill_parts)
+        {
+            counter.add("support.infill_parts.outline", part.outline_);
+            counter.add("support.infill_parts.infill_area_per_combine_per_density", part.infill_area_per_combine_per_density_);
+            counter.add("support.infill_parts.wall_toolpaths", part.wall_toolpaths_);
+        }
+        counter.add("support.support_bottom", support_layer.support_bottom);
+        counter.add("support.support_roof", support_layer.support_roof);
+        counter.add("support.support_fractional_roof", support_layer.support_fractional_roof);
+        counter.add("support.support_mesh_drop_down", support_layer.support_mesh_drop_down);
+        counter.add("support.support_mesh", support_layer.support_mesh);
+        counter.add("support.anti_overhang", support_layer.anti_overhang);
+    }
+
+    for (const std::vector<MixedLinesSet>& extruder_skirt_brim : skirt_brim)
+    {
+        counter.add("skirt_brim", extruder_skirt_brim);
+    }
+    counter.add("support_brim", support_brim);
+    counter.add("raft_base_outline", raft_base_outline);
+    counter.add("raft_interface_outline", raft_interface_outline);
+    counter.add("raft_surface_outline", raft_surface_outline);
+    counter.add("ooze_shield", ooze_shield);
+    counter.add("draft_protection_shield", draft_protection_shield);
+    const LayerCombBoundaries* previous_boundaries = nullptr;
+    for (const std::shared_ptr<const LayerCombBoundaries>& boundaries : comb_boundaries)
+    {
+        if (boundaries && boundaries.get() != previous_boundaries) // Consecutive layers share their boundaries, which only take memory once.
+        {
+            counter.add("comb_boundaries.minimum", boundaries->minimum);
+            counter.add("comb_boundaries.preferred", boundaries->preferred);
+        }
+        previous_boundaries = boundaries.get();
+    }
+    return counter.result();
+}
+
+std::vector<bool> SliceDataStorage::computeExtrudersUsed(const LayerIndex layer_nr) const
 {
     const std::vector<ExtruderTrain>& extruders = Application::getInstance().current_slice_->scene.extruders;
     std::vector<bool> ret;
@@ -4,9 +4,17 @@
 #include "slicer.h"
 
 #include <algorithm> // remove_if
+#include <cassert>
 #include <cstdio>
+#include <initializer_list>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <numbers>
+#include <numeric> // partial_sum
 
+#include <fmt/format.h>
 #include <scripta/logger.h>
 #include <spdlog/spdlog.h>
 
@@ -22,6 +30,7 @@
 #include "utils/Simplify.h"
 #include "utils/SparsePointGridInclusive.h"
 #include "utils/ThreadPool.h"
+#include "utils/TraceSpan.h"
 #include "utils/gettime.h"
 #include "utils/section_type.h"
 
@@ -31,21 +40,24 @@ namespace cura
 constexpr int largest_neglected_gap_first_phase = MM2INT(0.01); //!< distance between two line segments regarded as connected
 constexpr int largest_neglected_gap_second_phase = MM2INT(0.02); //!< distance between two line segments regarded as connected
 constexpr int max_stitch1 = MM2INT(10.0); //!< maximal distance stitched between open polylines to form polygons
+constexpr coord_t gap_closer_snap_distance = MM2INT(0.1); //!< maximal distance from the end of an open polyline to a closed polygon along which its gap is closed
 
 void SlicerLayer::makeBasicPolygonLoops(OpenLinesSet& open_polylines)
 {
+    std::optional<SparsePointGridInclusive<int>> segment_start_grid; // Only needed when the face adjacency turns out to be broken.
     for (size_t start_segment_idx = 0; start_segment_idx < segments_.size(); start_segment_idx++)
     {
         if (! segments_[start_segment_idx].addedToPolygon)
         {
-            makeBasicPolygonLoop(open_polylines, start_segment_idx);
+            makeBasicPolygonLoop(open_polylines, start_segment_idx, segment_start_grid);
         }
     }
-    // Clear the segmentList to save memory, it is no longer needed after this point.
-    segments_.clear();
+    // Release the segments and their topology to save memory, they are no longer needed after this point.
+    segments_ = std::vector<SlicerSegment>();
+    face_idx_to_segment_idx_ = std::unordered_map<int, int>();
 }
 
-void SlicerLayer::makeBasicPolygonLoop(OpenLinesSet& open_polylines, const size_t start_segment_idx)
+void SlicerLayer::makeBasicPolygonLoop(OpenLinesSet& open_polylines, const size_t start_segment_idx, std::optional<SparsePointGridInclusive<int>>& segment_start_grid)
 {
     Polygon poly(true);
     poly.push_back(segments_[start_segment_idx].start);
@@ -56,6 +68,10 @@ void SlicerLayer::makeBasicPolygonLoop(OpenLinesSet& open_polylines, const size_
         poly.push_back(segment.end);
         segment.addedToPolygon = true;
         segment_idx = getNextSegmentIdx(segment, start_segment_idx);
+        if (segment_idx == -1)
+        {
+            segment_idx = findNearbyNextSegmentIdx(segment, start_segment_idx, segment_start_grid);
+        }
         if (segment_idx == static_cast<int>(start_segment_idx))
         { // polyon is closed
             polygons_.push_back(std::move(poly));
@@ -130,6 +146,42 @@ int SlicerLayer::getNextSegmentIdx(const SlicerSegment& segment, const size_t st
     return next_segment_idx;
 }
 
+int SlicerLayer::findNearbyNextSegmentIdx(const SlicerSegment& segment, const size_t start_segment_idx, std::optional<SparsePointGridInclusive<int>>& segment_start_grid) const
+{
+    if (! segment_start_grid)
+    {
+        segment_start_grid.emplace(largest_neglected_gap_first_phase * 2, segments_.size());
+        for (size_t segment_idx = 0; segment_idx < segments_.size(); segment_idx++)
+        {
+            segment_start_grid->insert(segments_[segment_idx].start, static_cast<int>(segment_idx));
+        }
+    }
+
+    int best_segment_idx = -1;
+    coord_t best_dist2 = std::numeric_limits<coord_t>::max();
+    const auto process_func = [&](const SparsePointGridInclusiveImpl::SparsePointGridInclusiveElem<int>& elem)
+    {
+        const coord_t dist2 = vSize2(elem.point - segment.end);
+        if (dist2 > largest_neglected_gap_first_phase * largest_neglected_gap_first_phase)
+        {
+            return true;
+        }
+        if (elem.val == static_cast<int>(start_segment_idx))
+        {
+            best_segment_idx = elem.val;
+            return false; // Closing the loop always wins.
+        }
+        if (! segments_[elem.val].addedToPolygon && (dist2 < best_dist2 || (dist2 == best_dist2 && elem.val < best_segment_idx)))
+        {
+            best_segment_idx = elem.val;
+            best_dist2 = dist2;
+        }
+        return true;
+    };
+    segment_start_grid->processNearby(segment.end, largest_neglected_gap_first_phase, process_func);
+    return best_segment_idx;
+}
+
 void SlicerLayer::connectOpenPolylines(OpenLinesSet& open_polylines)
 {
     constexpr bool allow_reverse = false;
@@ -543,8 +595,17 @@ void SlicerLayer::stitch_extensive(OpenLinesSet& open_polylines)
     //  And generate a path over this shortest bit to link up the 2 open polygons.
     //  (If these 2 open polygons are the same polygon, then the final result is a closed polyon)
 
+    if (open_polylines.empty())
+    {
+        return;
+    }
+    // Only the segments near an end of an open polyline can close its gap, so look them up in a grid instead of testing all of them, every time.
+    // The polygons are only appended to, so only the new ones need to be added to the grid after every gap that is closed.
+    const std::unique_ptr<LocToLineGrid> polygon_grid = PolygonUtils::createLocToLineGrid(polygons_, gap_closer_snap_distance * 2);
+
     while (1)
     {
+        const size_t polygon_count = polygons_.size();
         unsigned int best_polyline_1_idx = -1;
         unsigned int best_polyline_2_idx = -1;
         std::optional<GapCloserResult> best_result;
@@ -556,7 +617,7 @@ void SlicerLayer::stitch_extensive(OpenLinesSet& open_polylines)
                 continue;
 
             {
-                std::optional<GapCloserResult> res = findPolygonGapCloser(polyline_1[0], polyline_1.back());
+                std::optional<GapCloserResult> res = findPolygonGapCloser(polyline_1[0], polyline_1.back(), *polygon_grid);
                 if (res && (! best_result || res->len < best_result->len))
                 {
                     best_polyline_1_idx = polyline_1_idx;
@@ -571,7 +632,7 @@ void SlicerLayer::stitch_extensive(OpenLinesSet& open_polylines)
                 if (polyline_2.size() < 1 || polyline_1_idx == polyline_2_idx)
                     continue;
 
-                std::optional<GapCloserResult> res = findPolygonGapCloser(polyline_1[0], polyline_2.back());
+                std::optional<GapCloserResult> res = findPolygonGapCloser(polyline_1[0], polyline_2.back(), *polygon_grid);
                 if (res && (! best_result || res->len < best_result->len))
                 {
                     best_polyline_1_idx = polyline_1_idx;
@@ -636,6 +697,13 @@ void SlicerLayer::stitch_extensive(OpenLinesSet& open_polylines)
                     open_polylines[best_polyline_1_idx].clear();
                 }
             }
+            for (size_t poly_idx = polygon_count; poly_idx < polygons_.size(); poly_idx++)
+            {
+                for (size_t point_idx = 0; point_idx < polygons_[poly_idx].size(); point_idx++)
+                {
+                    polygon_grid->insert(PolygonsPointIndex(&polygons_, poly_idx, point_idx));
+                }
+            }
         }
         else
         {
@@ -644,10 +712,10 @@ void SlicerLayer::stitch_extensive(OpenLinesSet& open_polylines)
     }
 }
 
-std::optional<GapCloserResult> SlicerLayer::findPolygonGapCloser(Point2LL ip0, Point2LL ip1)
+std::optional<GapCloserResult> SlicerLayer::findPolygonGapCloser(Point2LL ip0, Point2LL ip1, const LocToLineGrid& polygon_grid)
 {
-    std::optional<ClosePolygonResult> c1 = findPolygonPointClosestTo(ip0);
-    std::optional<ClosePolygonResult> c2 = findPolygonPointClosestTo(ip1);
+    std::optional<ClosePolygonResult> c1 = findPolygonPointClosestTo(ip0, polygon_grid);
+    std::optional<ClosePolygonResult> c2 = findPolygonPointClosestTo(ip1, polygon_grid);
     if (! c1 || ! c2 || c1->polygonIdx != c2->polygonIdx)
     {
         return std::nullopt;
@@ -701,38 +769,41 @@ std::optional<GapCloserResult> SlicerLayer::findPolygonGapCloser(Point2LL ip0, P
     return ret;
 }
 
-std::optional<ClosePolygonResult> SlicerLayer::findPolygonPointClosestTo(Point2LL input)
+std::optional<ClosePolygonResult> SlicerLayer::findPolygonPointClosestTo(Point2LL input, const LocToLineGrid& polygon_grid)
 {
-    for (size_t n = 0; n < polygons_.size(); n++)
+    // Of all segments that are close enough, take the first one, like when they would all be tested in order.
+    std::optional<ClosePolygonResult> result;
+    for (const PolygonsPointIndex& segment_start : polygon_grid.getNearby(input, gap_closer_snap_distance))
     {
-        Point2LL p0 = polygons_[n][polygons_[n].size() - 1];
-        for (size_t i = 0; i < polygons_[n].size(); i++)
+        const size_t n = segment_start.poly_idx_;
+        const size_t i = (segment_start.point_idx_ + 1) % polygons_[n].size(); // The segment ending in point i.
+        if (result && (n > result->polygonIdx || (n == result->polygonIdx && i >= result->pointIdx)))
         {
-            Point2LL p1 = polygons_[n][i];
+            continue;
+        }
+        const Point2LL p0 = polygons_[n][segment_start.point_idx_];
+        const Point2LL p1 = polygons_[n][i];
 
-            // Q = A + Normal( B - A ) * ((( B - A ) dot ( P - A )) / VSize( A - B ));
-            Point2LL pDiff = p1 - p0;
-            int64_t lineLength = vSize(pDiff);
-            if (lineLength > 1)
+        // Q = A + Normal( B - A ) * ((( B - A ) dot ( P - A )) / VSize( A - B ));
+        Point2LL pDiff = p1 - p0;
+        int64_t lineLength = vSize(pDiff);
+        if (lineLength > 1)
+        {
+            int64_t distOnLine = dot(pDiff, input - p0) / lineLength;
+            if (distOnLine >= 0 && distOnLine <= lineLength)
             {
-                int64_t distOnLine = dot(pDiff, input - p0) / lineLength;
-                if (distOnLine >= 0 && distOnLine <= lineLength)
+                Point2LL q = p0 + pDiff * distOnLine / lineLength;
+                if (shorterThen(q - input, gap_closer_snap_distance))
                 {
-                    Point2LL q = p0 + pDiff * distOnLine / lineLength;
-                    if (shorterThen(q - input, MM2INT(0.1)))
-                    {
-                        ClosePolygonResult ret;
-                        ret.polygonIdx = n;
-                        ret.pointIdx = i;
-                        return ret;
-                    }
+                    ClosePolygonResult ret;
+                    ret.polygonIdx = n;
+                    ret.pointIdx = i;
+                    result = ret;
                 }
             }
-            p0 = p1;
         }
     }
-
-    return std::nullopt;
+    return result;
 }
 
 void SlicerLayer::makePolygons(const Mesh* mesh)
@@ -798,6 +869,193 @@ void SlicerLayer::makePolygons(const Mesh* mesh)
     open_polylines_.removeDegenerateVerts();
 }
 
+namespace
+{
+/*!
+ * Keeps the sliced outlines of recently sliced meshes, so that slicing the
+ * same mesh again with the same slicing settings can skip building the
+ * segments and polygons. This happens a lot with consecutive --next slices
+ * that only change settings which are used after slicing, like infill or
+ * speeds.
+ *
+ * The key is a hash of the mesh data (which already has the mesh rotation
+ * matrix applied) and of the layer heights, plus the values of all settings
+ * that the slicing step reads.
+ *
+ * The cache is off unless the slicer_cache_max_mb setting is given, since it
+ * keeps a copy of the outlines around for the lifetime of the engine. It's
+ * bounded by that many megabytes, and emptied when it's turned off again.
+ */
+class SlicerCache
+{
+public:
+    struct Layers
+    {
+        size_t bytes = 0; //!< Estimated size of the outlines, in bytes.
+        std::vector<Shape> polygons;
+        std::vector<OpenLinesSet> open_polylines;
+    };
+
+    static SlicerCache& getInstance()
+    {
+        static SlicerCache instance;
+        return instance;
+    }
+
+    //! How many bytes of outlines may be cached, or 0 if the cache is off.
+    static size_t maxBytes()
+    {
+        const Scene& scene = Application::getInstance().current_slice_->scene;
+        for (const Settings* settings : std::initializer_list<const Settings*>{ &scene.current_mesh_group->settings, &scene.settings })
+        {
+            if (settings->has("slicer_cache_max_mb"))
+            {
+                return settings->get<size_t>("slicer_cache_max_mb") * 1024 * 1024;
+            }
+        }
+        return 0;
+    }
+
+    /*!
+     * Get the key under which the outlines of a mesh are cached.
+     * \param mesh The mesh to slice.
+     * \param layers The layers to slice it at, with their heights filled in.
+     * \param thickness The layer thickness (apart from the first layer).
+     * \param initial_layer_thickness The thickness of the first layer.
+     */
+    static std::string makeKey(const Mesh& mesh, const std::vector<SlicerLayer>& layers, const coord_t thickness, const coord_t initial_layer_thickness)
+    {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        const auto add = [&hash](const uint64_t value)
+        {
+            // Combine like boost::hash_combine, then mix with the finalizer of splitmix64.
+            hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+            hash ^= hash >> 31;
+        };
+        for (const MeshVertex& vertex : mesh.vertices_)
+        {
+            add(vertex.p_.x_);
+            add(vertex.p_.y_);
+            add(vertex.p_.z_);
+        }
+        for (const MeshFace& face : mesh.faces_)
+        {
+            add(face.vertex_index_[0]);
+            add(face.vertex_index_[1]);
+            add(face.vertex_index_[2]);
+        }
+        for (const SlicerLayer& layer : layers)
+        {
+            add(layer.z_);
+        }
+
+        std::string key = fmt::format("{:016x}/{}/{}/{}/{}/{}", hash, mesh.vertices_.size(), mesh.faces_.size(), layers.size(), thickness, initial_layer_thickness);
+        for (const char* setting : { "slicing_tolerance",
+                                     "magic_mesh_surface_mode",
+                                     "meshfix_extensive_stitching",
+                                     "meshfix_keep_open_polygons",
+                                     "minimum_polygon_circumference",
+                                     "meshfix_maximum_resolution",
+                                     "meshfix_maximum_deviation",
+                                     "meshfix_maximum_extrusion_area_deviation",
+                                     "support_mesh",
+                                     "anti_overhang_mesh",
+                                     "cutting_mesh",
+                                     "infill_mesh",
+                                     "xy_offset",
+                                     "xy_offset_layer_0",
+                                     "hole_xy_offset",
+                                     "hole_xy_offset_max_diameter" })
+        {
+            key += '/';
+            key += mesh.settings_.get<std::string>(setting);
+        }
+        return key;
+    }
+
+    /*!
+     * Fill in the outlines of the layers from the cache, if they are there.
+     * \return Whether the layers were found in the cache.
+     */
+    bool get(const std::string& key, std::vector<SlicerLayer>& layers)
+    {
+        std::lock_guard lock(mutex_);
+        const auto entry = std::find_if(
+            entries_.begin(),
+            entries_.end(),
+            [&key](const auto& cached)
+            {
+                return cached.first == key;
+            });
+        if (entry == entries_.end())
+        {
+            return false;
+        }
+        entries_.splice(entries_.begin(), entries_, entry); // Mark as most recently used.
+        const Layers& cached = entry->second;
+        assert(cached.polygons.size() == layers.size());
+        for (size_t layer_nr = 0; layer_nr < layers.size(); layer_nr++)
+        {
+            layers[layer_nr].polygons_ = cached.polygons[layer_nr];
+            layers[layer_nr].open_polylines_ = cached.open_polylines[layer_nr];
+        }
+        return true;
+    }
+
+    /*!
+     * Store the outlines of sliced layers, evicting the least recently used
+     * entries until the cache fits in \p max_bytes. Outlines that are bigger
+     * than that on their own aren't stored.
+     */
+    void put(std::string key, const std::vector<SlicerLayer>& layers, const size_t max_bytes)
+    {
+        size_t bytes = key.size();
+        for (const SlicerLayer& layer : layers)
+        {
+            bytes += sizeof(Shape) + sizeof(OpenLinesSet) + (layer.polygons_.size() + layer.open_polylines_.size()) * sizeof(Polygon)
+                   + (layer.polygons_.pointCount() + layer.open_polylines_.pointCount()) * sizeof(Point2LL);
+        }
+        if (bytes > max_bytes)
+        {
+            return;
+        }
+
+        Layers cached{ .bytes = bytes };
+        cached.polygons.reserve(layers.size());
+        cached.open_polylines.reserve(layers.size());
+        for (const SlicerLayer& layer : layers)
+        {
+            cached.polygons.push_back(layer.polygons_);
+            cached.open_polylines.push_back(layer.open_polylines_);
+        }
+
+        std::lock_guard lock(mutex_);
+        total_bytes_ += bytes;
+        entries_.emplace_front(std::move(key), std::move(cached));
+        while (total_bytes_ > max_bytes)
+        {
+            total_bytes_ -= entries_.back().second.bytes;
+            entries_.pop_back();
+        }
+    }
+
+    //! Forget all cached outlines.
+    void clear()
+    {
+        std::lock_guard lock(mutex_);
+        entries_.clear();
+        total_bytes_ = 0;
+    }
+
+private:
+    std::mutex mutex_;
+    std::list<std::pair<std::string, Layers>> entries_; //!< Most recently used first.
+    size_t total_bytes_ = 0; //!< The estimated size of all entries.
+};
+} // namespace
+
 Slicer::Slicer(Mesh* i_mesh, const coord_t thickness, const size_t slice_layer_count, bool use_variable_layer_heights, std::vector<AdaptiveLayer>* adaptive_layers)
     : mesh(i_mesh)
 {
@@ -821,6 +1079,24 @@ Slicer::Slicer(Mesh* i_mesh, const coord_t thickness, const size_t slice_layer_c
         mesh->settings_.get<coord_t>("layer_0_z_overlap"),
         Raft::getFillerLayerCount());
 
+    const size_t cache_max_bytes = SlicerCache::maxBytes();
+    std::string cache_key;
+    if (cache_max_bytes > 0)
+    {
+        cache_key = SlicerCache::makeKey(*mesh, layers, thickness, initial_layer_thickness);
+    }
+    else
+    {
+        SlicerCache::getInstance().clear(); // It may have been turned off since the previous slice.
+    }
+    if (! cache_key.empty() && SlicerCache::getInstance().get(cache_key, layers))
+    {
+        i_mesh->expandXY(mesh->settings_.get<coord_t>("xy_offset"));
+        scripta::log("sliced_polygons", layers, SectionType::NA);
+        spdlog::info("Reused the slices of an identical earlier mesh, took {:03.3f} seconds", slice_timer.restart());
+        return;
+    }
+
     std::vector<std::pair<int32_t, int32_t>> zbbox = buildZHeightsForFaces(*mesh);
 
     buildSegments(*mesh, zbbox, slicing_tolerance, layers);
@@ -830,25 +1106,33 @@ Slicer::Slicer(Mesh* i_mesh, const coord_t thickness, const size_t slice_layer_c
     makePolygons(*i_mesh, slicing_tolerance, layers);
     scripta::log("sliced_polygons", layers, SectionType::NA);
     spdlog::info("Make polygons took {:03.3f} seconds", slice_timer.restart());
+
+    if (cache_max_bytes > 0)
+    {
+        SlicerCache::getInstance().put(std::move(cache_key), layers, cache_max_bytes);
+    }
 }
 
 void Slicer::buildSegments(const Mesh& mesh, const std::vector<std::pair<int32_t, int32_t>>& zbbox, const SlicingTolerance& slicing_tolerance, std::vector<SlicerLayer>& layers)
 {
+    CURA_TRACE_SPAN("Slicer::buildSegments");
+    std::vector<size_t> bucket_start;
+    std::vector<unsigned int> bucket_faces;
+    buildFaceBuckets(zbbox, layers, bucket_start, bucket_faces);
+
     cura::parallel_for(
         layers,
         [&](auto layer_it)
         {
             SlicerLayer& layer = *layer_it;
             const int32_t& z = layer.z_;
-            layer.segments_.reserve(100);
+            const size_t layer_nr = std::distance(layers.begin(), layer_it);
+            layer.segments_.reserve(bucket_start[layer_nr + 1] - bucket_start[layer_nr]);
 
-            // loop over all mesh faces
-            for (unsigned int mesh_idx = 0; mesh_idx < mesh.faces_.size(); mesh_idx++)
+            // loop over the mesh faces that cross this layer
+            for (size_t bucket_idx = bucket_start[layer_nr]; bucket_idx < bucket_start[layer_nr + 1]; bucket_idx++)
             {
-                if ((z < zbbox[mesh_idx].first) || (z > zbbox[mesh_idx].second))
-                {
-                    continue;
-                }
+                const unsigned int mesh_idx = bucket_faces[bucket_idx];
 
                 // get all vertices per face
                 const MeshFace& face = mesh.faces_[mesh_idx];
@@ -964,6 +1248,63 @@ void Slicer::buildSegments(const Mesh& mesh, const std::vector<std::pair<int32_t
         });
 }
 
+void Slicer::buildFaceBuckets(
+    const std::vector<std::pair<int32_t, int32_t>>& zbbox,
+    const std::vector<SlicerLayer>& layers,
+    std::vector<size_t>& bucket_start,
+    std::vector<unsigned int>& bucket_faces)
+{
+    assert(std::is_sorted(
+        layers.begin(),
+        layers.end(),
+        [](const SlicerLayer& a, const SlicerLayer& b)
+        {
+            return a.z_ < b.z_;
+        }));
+
+    // The range of layers [first, last) whose z lies within the z bounding box of each face.
+    std::vector<std::pair<size_t, size_t>> face_layers(zbbox.size());
+    std::vector<size_t> counts(layers.size() + 1, 0);
+    for (size_t face_idx = 0; face_idx < zbbox.size(); face_idx++)
+    {
+        const auto first = std::lower_bound(
+            layers.begin(),
+            layers.end(),
+            zbbox[face_idx].first,
+            [](const SlicerLayer& layer, const int32_t z)
+            {
+                return layer.z_ < z;
+            });
+        const auto last = std::upper_bound(
+            first,
+            layers.end(),
+            zbbox[face_idx].second,
+            [](const int32_t z, const SlicerLayer& layer)
+            {
+                return z < layer.z_;
+            });
+        face_layers[face_idx] = { static_cast<size_t>(first - layers.begin()), static_cast<size_t>(last - layers.begin()) };
+        for (size_t layer_nr = face_layers[face_idx].first; layer_nr < face_layers[face_idx].second; layer_nr++)
+        {
+            counts[layer_nr + 1]++;
+        }
+    }
+
+    bucket_start.resize(layers.size() + 1);
+    std::partial_sum(counts.begin(), counts.end(), bucket_start.begin());
+    bucket_faces.resize(bucket_start.back());
+
+    // Faces are visited in index order, so every bucket lists its faces in the same order as a full scan would.
+    std::vector<size_t> fill(bucket_start.begin(), bucket_start.end() - 1);
+    for (size_t face_idx = 0; face_idx < zbbox.size(); face_idx++)
+    {
+        for (size_t layer_nr = face_layers[face_idx].first; layer_nr < face_layers[face_idx].second; layer_nr++)
+        {
+            bucket_faces[fill[layer_nr]++] = static_cast<unsigned int>(face_idx);
+        }
+    }
+}
+
 std::vector<SlicerLayer> Slicer::buildLayersWithHeight(
     size_t slice_layer_count,
     SlicingTolerance slicing_tolerance,
@@ -1107,43 +1448,20 @@ void Slicer::makePolygons(Mesh& mesh, SlicingTolerance slicing_tolerance, std::v
 
 std::vector<std::pair<int32_t, int32_t>> Slicer::buildZHeightsForFaces(const Mesh& mesh)
 {
-    std::vector<std::pair<int32_t, int32_t>> zHeights;
-    zHeights.reserve(mesh.faces_.size());
-    for (const auto& face : mesh.faces_)
-    {
-        // const MeshFace& face = mesh.faces[mesh_idx];
-        const MeshVertex& v0 = mesh.vertices_[face.vertex_index_[0]];
-        const MeshVertex& v1 = mesh.vertices_[face.vertex_index_[1]];
-        const MeshVertex& v2 = mesh.vertices_[face.vertex_index_[2]];
-
-        // get all vertices represented as 3D point
-        Point3LL p0 = v0.p_;
-        Point3LL p1 = v1.p_;
-        Point3LL p2 = v2.p_;
-
-        // find the minimum and maximum z point
-        int32_t minZ = p0.z_;
-        if (p1.z_ < minZ)
-        {
-            minZ = p1.z_;
-        }
-        if (p2.z_ < minZ)
-        {
-            minZ = p2.z_;
-        }
-
-        int32_t maxZ = p0.z_;
-        if (p1.z_ > maxZ)
-        {
-            maxZ = p1.z_;
-        }
-        if (p2.z_ > maxZ)
+    std::vector<std::pair<int32_t, int32_t>> zHeights(mesh.faces_.size());
+    cura::parallel_for<size_t>(
+        0,
+        mesh.faces_.size(),
+        [&](const size_t face_idx)
         {
-            maxZ = p2.z_;
-        }
+            const MeshFace& face = mesh.faces_[face_idx];
+            const int32_t z0 = mesh.vertices_[face.vertex_index_[0]].p_.z_;
+            const int32_t z1 = mesh.vertices_[face.vertex_index_[1]].p_.z_;
+            const int32_t z2 = mesh.vertices_[face.vertex_index_[2]].p_.z_;
 
-        zHeights.emplace_back(std::make_pair(minZ, maxZ));
-    }
+            // find the minimum and maximum z point
+            zHeights[face_idx] = std::make_pair(std::min({ z0, z1, z2 }), std::max({ z0, z1, z2 }));
+        });
 
     return zHeights;
 }
@@ -3,9 +3,12 @@
 
 #include "support.h"
 
+#include <atomic>
 #include <cmath> // sqrt, round
 #include <deque>
 #include <fstream> // ifstream.good()
+#include <mutex>
+#include <optional>
 #include <utility> // pair
 
 #include <range/v3/view/concat.hpp>
@@ -24,6 +27,7 @@
 #include "ExtruderTrain.h"
 #include "SkeletalTrapezoidation.h"
 #include "Slice.h"
+#include "SupportInterfaceOutlineCache.h"
 #include "infill.h"
 #include "infill/SierpinskiFillProvider.h"
 #include "infill/UniformDensityProvider.h"
@@ -35,6 +39,7 @@
 #include "slicer.h"
 #include "utils/Simplify.h"
 #include "utils/ThreadPool.h"
+#include "utils/TraceSpan.h"
 #include "utils/linearAlg2D.h"
 #include "utils/math.h"
 
@@ -94,34 +99,38 @@ void AreaSupport::splitGlobalSupportAreasIntoSupportInfillParts(SliceDataStorage
     // The wall line count is used for calculating insets, and we generate support infill patterns within the insets
     const size_t wall_line_count = infill_extruder.settings_.get<size_t>("support_wall_count");
 
-    // Generate separate support islands
-    for (LayerIndex layer_nr = 0; layer_nr < total_layer_count - 1; ++layer_nr)
-    {
-        unsigned int wall_line_count_this_layer = wall_line_count;
-        if (layer_nr == 0 && (support_pattern == EFillMethod::LINES || support_pattern == EFillMethod::ZIG_ZAG))
-        { // The first layer will be printed with a grid pattern
-            wall_line_count_this_layer++;
-        }
-
-        const Shape& global_support_areas = global_support_areas_per_layer[layer_nr];
-        if (global_support_areas.size() == 0 || layer_nr < min_layer || layer_nr > max_layer)
+    // Generate separate support islands. Each layer only fills its own parts, so the layers can be split in parallel.
+    const coord_t layer_height = infill_extruder.settings_.get<coord_t>("layer_height");
+    const bool is_raft = mesh_group_settings.get<EPlatformAdhesion>("adhesion_type") == EPlatformAdhesion::RAFT;
+    cura::parallel_for<size_t>(
+        0,
+        total_layer_count - 1,
+        [&](const size_t layer_nr)
         {
-            // Initialize support_infill_parts empty
-            storage.support.supportLayers[layer_nr].support_infill_parts.clear();
-            continue;
-        }
+            unsigned int wall_line_count_this_layer = wall_line_count;
+            if (layer_nr == 0 && (support_pattern == EFillMethod::LINES || support_pattern == EFillMethod::ZIG_ZAG))
+            { // The first layer will be printed with a grid pattern
+                wall_line_count_this_layer++;
+            }
 
-        coord_t support_line_width_here = support_line_width;
-        if (layer_nr == 0 && mesh_group_settings.get<EPlatformAdhesion>("adhesion_type") != EPlatformAdhesion::RAFT)
-        {
-            support_line_width_here *= infill_extruder.settings_.get<Ratio>("initial_layer_line_width_factor");
-        }
-        // We don't generate insets and infill area for the parts yet because later the skirt/brim and prime
-        // tower will remove themselves from the support, so the outlines of the parts can be changed.
-        const coord_t layer_height = infill_extruder.settings_.get<coord_t>("layer_height");
-        storage.support.supportLayers[layer_nr]
-            .fillInfillParts(layer_nr, global_support_areas_per_layer, layer_height, storage.meshes, support_line_width_here, wall_line_count_this_layer);
-    }
+            const Shape& global_support_areas = global_support_areas_per_layer[layer_nr];
+            if (global_support_areas.size() == 0 || layer_nr < min_layer || layer_nr > max_layer)
+            {
+                // Initialize support_infill_parts empty
+                storage.support.supportLayers[layer_nr].support_infill_parts.clear();
+                return;
+            }
+
+            coord_t support_line_width_here = support_line_width;
+            if (layer_nr == 0 && ! is_raft)
+            {
+                support_line_width_here *= infill_extruder.settings_.get<Ratio>("initial_layer_line_width_factor");
+            }
+            // We don't generate insets and infill area for the parts yet because later the skirt/brim and prime
+            // tower will remove themselves from the support, so the outlines of the parts can be changed.
+            storage.support.supportLayers[layer_nr]
+                .fillInfillParts(layer_nr, global_support_areas_per_layer, layer_height, storage.meshes, support_line_width_here, wall_line_count_this_layer);
+        });
 }
 
 
@@ -202,116 +211,121 @@ void AreaSupport::generateGradualSupport(SliceDataStorage& storage)
     LayerIndex max_layer = total_layer_count - 1;
 
     // compute different density areas for each support island
-    for (LayerIndex layer_nr = 0; layer_nr < total_layer_count - 1; layer_nr++)
-    {
-        if (layer_nr < min_layer || layer_nr > max_layer)
-        {
-            continue;
-        }
-
-        // generate separate support islands and calculate density areas for each island
-        std::vector<SupportInfillPart>& support_infill_parts = storage.support.supportLayers[layer_nr].support_infill_parts;
-        for (unsigned int part_idx = 0; part_idx < support_infill_parts.size(); ++part_idx)
+    // Each layer only writes to its own parts and only reads the outlines of the parts above, which are left alone here, so the layers are independent.
+    const size_t layer_end = total_layer_count > 0 ? total_layer_count - 1 : 0;
+    cura::parallel_for<size_t>(
+        0,
+        layer_end,
+        [&](const LayerIndex layer_nr)
         {
-            SupportInfillPart& support_infill_part = support_infill_parts[part_idx];
-
-            Shape original_area = support_infill_part.getInfillArea();
-            if (original_area.empty())
+            if (layer_nr < min_layer || layer_nr > max_layer)
             {
-                continue;
+                return;
             }
-            // NOTE: This both generates the walls _and_ returns the _actual_ infill area (the one _without_ walls) for use in the rest of the method.
-            const Shape infill_area = Infill::generateWallToolPaths(
-                support_infill_part.wall_toolpaths_,
-                original_area,
-                support_infill_part.inset_count_to_generate_,
-                wall_width,
-                infill_extruder.settings_,
-                layer_nr,
-                SectionType::SUPPORT);
-            const AABB& this_part_boundary_box = support_infill_part.outline_boundary_box_;
-
-            // calculate density areas for this island
-            Shape less_dense_support = infill_area; // one step less dense with each density_step
-            Shape sum_more_dense; // NOTE: Only used for zig-zag or connected fills.
-            for (unsigned int density_step = 0; density_step < max_density_steps; ++density_step)
+
+            // generate separate support islands and calculate density areas for each island
+            std::vector<SupportInfillPart>& support_infill_parts = storage.support.supportLayers[layer_nr].support_infill_parts;
+            for (unsigned int part_idx = 0; part_idx < support_infill_parts.size(); ++part_idx)
             {
-                LayerIndex actual_min_layer{ layer_nr + density_step * gradual_support_step_layer_count + static_cast<LayerIndex::value_type>(layer_skip_count) };
-                LayerIndex actual_max_layer{ layer_nr + (density_step + 1) * gradual_support_step_layer_count };
+                SupportInfillPart& support_infill_part = support_infill_parts[part_idx];
 
-                for (double upper_layer_idx = actual_min_layer; upper_layer_idx <= actual_max_layer; upper_layer_idx += layer_skip_count)
+                Shape original_area = support_infill_part.getInfillArea();
+                if (original_area.empty())
                 {
-                    if (static_cast<unsigned int>(upper_layer_idx) >= total_layer_count)
-                    {
-                        less_dense_support.clear();
-                        break;
-                    }
+                    continue;
+                }
+                // NOTE: This both generates the walls _and_ returns the _actual_ infill area (the one _without_ walls) for use in the rest of the method.
+                const Shape infill_area = Infill::generateWallToolPaths(
+                    support_infill_part.wall_toolpaths_,
+                    original_area,
+                    support_infill_part.inset_count_to_generate_,
+                    wall_width,
+                    infill_extruder.settings_,
+                    layer_nr,
+                    SectionType::SUPPORT);
+                const AABB& this_part_boundary_box = support_infill_part.outline_boundary_box_;
+
+                // calculate density areas for this island
+                Shape less_dense_support = infill_area; // one step less dense with each density_step
+                Shape sum_more_dense; // NOTE: Only used for zig-zag or connected fills.
+                for (unsigned int density_step = 0; density_step < max_density_steps; ++density_step)
+                {
+                    LayerIndex actual_min_layer{ layer_nr + density_step * gradual_support_step_layer_count + static_cast<LayerIndex::value_type>(layer_skip_count) };
+                    LayerIndex actual_max_layer{ layer_nr + (density_step + 1) * gradual_support_step_layer_count };
 
-                    // compute intersections with relevant upper parts
-                    const std::vector<SupportInfillPart> upper_infill_parts = storage.support.supportLayers[upper_layer_idx].support_infill_parts;
-                    Shape relevant_upper_polygons;
-                    for (unsigned int upper_part_idx = 0; upper_part_idx < upper_infill_parts.size(); ++upper_part_idx)
+                    for (double upper_layer_idx = actual_min_layer; upper_layer_idx <= actual_max_layer; upper_layer_idx += layer_skip_count)
                     {
-                        if (support_infill_part.outline_.empty())
+                        if (static_cast<unsigned int>(upper_layer_idx) >= total_layer_count)
                         {
-                            continue;
+                            less_dense_support.clear();
+                            break;
                         }
 
-                        // we compute intersection based on support infill areas
-                        const AABB& upper_part_boundary_box = upper_infill_parts[upper_part_idx].outline_boundary_box_;
-                        //
-                        // Here we are comparing the **outlines** of the infill areas
-                        //
-                        // legend:
-                        //   ^ support roof
-                        //   | support wall
-                        //   # dense support
-                        //   + less dense support
-                        //
-                        //     comparing infill            comparing with outline (this is our approach)
-                        //    ^^^^^^        ^^^^^^            ^^^^^^            ^^^^^^
-                        //    ####||^^      ####||^^          ####||^^          ####||^^
-                        //    ######||^^    #####||^^         ######||^^        #####||^^
-                        //    ++++####||    ++++##||^         ++++++##||        ++++++||^
-                        //    ++++++####    +++++##||         ++++++++##        +++++++||
-                        //
-                        if (upper_part_boundary_box.hit(this_part_boundary_box))
+                        // compute intersections with relevant upper parts
+                        const std::vector<SupportInfillPart>& upper_infill_parts = storage.support.supportLayers[upper_layer_idx].support_infill_parts;
+                        Shape relevant_upper_polygons;
+                        for (unsigned int upper_part_idx = 0; upper_part_idx < upper_infill_parts.size(); ++upper_part_idx)
                         {
-                            relevant_upper_polygons.push_back(upper_infill_parts[upper_part_idx].outline_);
+                            if (support_infill_part.outline_.empty())
+                            {
+                                continue;
+                            }
+
+                            // we compute intersection based on support infill areas
+                            const AABB& upper_part_boundary_box = upper_infill_parts[upper_part_idx].outline_boundary_box_;
+                            //
+                            // Here we are comparing the **outlines** of the infill areas
+                            //
+                            // legend:
+                            //   ^ support roof
+                            //   | support wall
+                            //   # dense support
+                            //   + less dense support
+                            //
+                            //     comparing infill            comparing with outline (this is our approach)
+                            //    ^^^^^^        ^^^^^^            ^^^^^^            ^^^^^^
+                            //    ####||^^      ####||^^          ####||^^          ####||^^
+                            //    ######||^^    #####||^^         ######||^^        #####||^^
+                            //    ++++####||    ++++##||^         ++++++##||        ++++++||^
+                            //    ++++++####    +++++##||         ++++++++##        +++++++||
+                            //
+                            if (upper_part_boundary_box.hit(this_part_boundary_box))
+                            {
+                                relevant_upper_polygons.push_back(upper_infill_parts[upper_part_idx].outline_);
+                            }
                         }
+
+                        less_dense_support = less_dense_support.intersection(relevant_upper_polygons);
+                    }
+                    if (less_dense_support.size() == 0)
+                    {
+                        break;
                     }
 
-                    less_dense_support = less_dense_support.intersection(relevant_upper_polygons);
-                }
-                if (less_dense_support.size() == 0)
-                {
-                    break;
+                    // add new infill_area_per_combine_per_density for the current density
+                    support_infill_part.infill_area_per_combine_per_density_.emplace_back();
+                    std::vector<Shape>& support_area_current_density = support_infill_part.infill_area_per_combine_per_density_.back();
+                    const Shape more_dense_support = infill_area.difference(less_dense_support);
+                    support_area_current_density.push_back(simplifier.polygon(more_dense_support.difference(sum_more_dense)));
+                    if (is_connected)
+                    {
+                        sum_more_dense = sum_more_dense.unionPolygons(more_dense_support);
+                    }
                 }
 
-                // add new infill_area_per_combine_per_density for the current density
                 support_infill_part.infill_area_per_combine_per_density_.emplace_back();
                 std::vector<Shape>& support_area_current_density = support_infill_part.infill_area_per_combine_per_density_.back();
-                const Shape more_dense_support = infill_area.difference(less_dense_support);
-                support_area_current_density.push_back(simplifier.polygon(more_dense_support.difference(sum_more_dense)));
-                if (is_connected)
-                {
-                    sum_more_dense = sum_more_dense.unionPolygons(more_dense_support);
-                }
-            }
+                support_area_current_density.push_back(simplifier.polygon(infill_area.difference(sum_more_dense)));
 
-            support_infill_part.infill_area_per_combine_per_density_.emplace_back();
-            std::vector<Shape>& support_area_current_density = support_infill_part.infill_area_per_combine_per_density_.back();
-            support_area_current_density.push_back(simplifier.polygon(infill_area.difference(sum_more_dense)));
-
-            assert(support_infill_part.infill_area_per_combine_per_density_.size() != 0 && "support_infill_part.infill_area_per_combine_per_density should now be initialized");
+                assert(support_infill_part.infill_area_per_combine_per_density_.size() != 0 && "support_infill_part.infill_area_per_combine_per_density should now be initialized");
 #ifdef DEBUG
-            for (unsigned int part_i = 0; part_i < support_infill_part.infill_area_per_combine_per_density_.size(); ++part_i)
-            {
-                assert(support_infill_part.infill_area_per_combine_per_density_[part_i].size() != 0);
-            }
+                for (unsigned int part_i = 0; part_i < support_infill_part.infill_area_per_combine_per_density_.size(); ++part_i)
+                {
+                    assert(support_infill_part.infill_area_per_combine_per_density_[part_i].size() != 0);
+                }
 #endif // DEBUG
-        }
-    }
+            }
+        });
 }
 
 
@@ -339,83 +353,90 @@ void AreaSupport::combineSupportInfillLayers(SliceDataStorage& storage)
     max_layer = max_layer - 1;
     max_layer -= max_layer % combine_layers_amount; // Round downwards to the nearest layer divisible by infill_sparse_combine.
 
-    for (size_t layer_idx = min_layer; layer_idx <= max_layer; layer_idx += combine_layers_amount) // Skip every few layers, but extrude more.
+    if (max_layer < min_layer || max_layer >= storage.support.supportLayers.size())
     {
-        if (layer_idx >= storage.support.supportLayers.size())
-        {
-            break;
-        }
+        return;
+    }
 
-        SupportLayer& layer = storage.support.supportLayers[layer_idx];
-        for (unsigned int combine_count_here = 1; combine_count_here < combine_layers_amount; ++combine_count_here)
+    // A layer that is extruded thicker only takes area from the layers below it, down to the previous such layer. These groups of layers don't overlap, so
+    // they are combined in parallel, while the layers within a group are combined one after another.
+    const size_t group_count = (max_layer - min_layer) / combine_layers_amount + 1;
+    cura::parallel_for<size_t>(
+        0,
+        group_count,
+        [&](const size_t group_idx)
         {
-            if (layer_idx < combine_count_here)
-            {
-                break;
-            }
-
-            size_t lower_layer_idx = layer_idx - combine_count_here;
-            if (lower_layer_idx < min_layer)
+            const size_t layer_idx = min_layer + group_idx * combine_layers_amount; // Skip every few layers, but extrude more.
+            SupportLayer& layer = storage.support.supportLayers[layer_idx];
+            for (unsigned int combine_count_here = 1; combine_count_here < combine_layers_amount; ++combine_count_here)
             {
-                break;
-            }
-            SupportLayer& lower_layer = storage.support.supportLayers[lower_layer_idx];
+                if (layer_idx < combine_count_here)
+                {
+                    break;
+                }
 
-            for (SupportInfillPart& part : layer.support_infill_parts)
-            {
-                if (part.getInfillArea().empty())
+                size_t lower_layer_idx = layer_idx - combine_count_here;
+                if (lower_layer_idx < min_layer)
                 {
-                    continue;
+                    break;
                 }
-                for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density_.size(); ++density_idx)
-                { // go over each density of gradual infill (these density areas overlap!)
-                    std::vector<Shape>& infill_area_per_combine = part.infill_area_per_combine_per_density_[density_idx];
-                    Shape result;
-                    for (SupportInfillPart& lower_layer_part : lower_layer.support_infill_parts)
-                    {
-                        if (! part.outline_boundary_box_.hit(lower_layer_part.outline_boundary_box_))
-                        {
-                            continue;
-                        }
+                SupportLayer& lower_layer = storage.support.supportLayers[lower_layer_idx];
 
-                        Shape intersection = infill_area_per_combine[combine_count_here - 1].intersection(lower_layer_part.getInfillArea()).offset(-200).offset(200);
-                        if (intersection.size() <= 0)
+                for (SupportInfillPart& part : layer.support_infill_parts)
+                {
+                    if (part.getInfillArea().empty())
+                    {
+                        continue;
+                    }
+                    for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density_.size(); ++density_idx)
+                    { // go over each density of gradual infill (these density areas overlap!)
+                        std::vector<Shape>& infill_area_per_combine = part.infill_area_per_combine_per_density_[density_idx];
+                        Shape result;
+                        for (SupportInfillPart& lower_layer_part : lower_layer.support_infill_parts)
                         {
-                            continue;
+                            if (! part.outline_boundary_box_.hit(lower_layer_part.outline_boundary_box_))
+                            {
+                                continue;
+                            }
+
+                            Shape intersection = infill_area_per_combine[combine_count_here - 1].intersection(lower_layer_part.getInfillArea()).offset(-200).offset(200);
+                            if (intersection.size() <= 0)
+                            {
+                                continue;
+                            }
+
+                            result.push_back(intersection); // add area to be thickened
+                            infill_area_per_combine[combine_count_here - 1]
+                                = infill_area_per_combine[combine_count_here - 1].difference(intersection); // remove thickened area from less thick layer here
+
+                            unsigned int max_lower_density_idx = density_idx;
+                            // Generally: remove only from *same density* areas on layer below
+                            // If there are no same density areas, then it's ok to print them anyway
+                            // Don't remove other density areas
+                            if (density_idx == part.infill_area_per_combine_per_density_.size() - 1)
+                            {
+                                // For the most dense areas on a given layer the density of that area is doubled.
+                                // This means that - if the lower layer has more densities -
+                                // all those lower density lines are included in the most dense of this layer.
+                                // We therefore compare the most dense are on this layer with all densities
+                                // of the lower layer with the same or higher density index
+                                max_lower_density_idx = lower_layer_part.infill_area_per_combine_per_density_.size() - 1;
+                            }
+                            for (unsigned int lower_density_idx = density_idx;
+                                 lower_density_idx <= max_lower_density_idx && lower_density_idx < lower_layer_part.infill_area_per_combine_per_density_.size();
+                                 lower_density_idx++)
+                            {
+                                std::vector<Shape>& lower_infill_area_per_combine = lower_layer_part.infill_area_per_combine_per_density_[lower_density_idx];
+                                lower_infill_area_per_combine[0]
+                                    = lower_infill_area_per_combine[0].difference(intersection); // remove thickened area from lower (single thickness) layer
+                            }
                         }
 
-                        result.push_back(intersection); // add area to be thickened
-                        infill_area_per_combine[combine_count_here - 1]
-                            = infill_area_per_combine[combine_count_here - 1].difference(intersection); // remove thickened area from less thick layer here
-
-                        unsigned int max_lower_density_idx = density_idx;
-                        // Generally: remove only from *same density* areas on layer below
-                        // If there are no same density areas, then it's ok to print them anyway
-                        // Don't remove other density areas
-                        if (density_idx == part.infill_area_per_combine_per_density_.size() - 1)
-                        {
-                            // For the most dense areas on a given layer the density of that area is doubled.
-                            // This means that - if the lower layer has more densities -
-                            // all those lower density lines are included in the most dense of this layer.
-                            // We therefore compare the most dense are on this layer with all densities
-                            // of the lower layer with the same or higher density index
-                            max_lower_density_idx = lower_layer_part.infill_area_per_combine_per_density_.size() - 1;
-                        }
-                        for (unsigned int lower_density_idx = density_idx;
-                             lower_density_idx <= max_lower_density_idx && lower_density_idx < lower_layer_part.infill_area_per_combine_per_density_.size();
-                             lower_density_idx++)
-                        {
-                            std::vector<Shape>& lower_infill_area_per_combine = lower_layer_part.infill_area_per_combine_per_density_[lower_density_idx];
-                            lower_infill_area_per_combine[0]
-                                = lower_infill_area_per_combine[0].difference(intersection); // remove thickened area from lower (single thickness) layer
-                        }
+                        infill_area_per_combine.push_back(result);
                     }
-
-                    infill_area_per_combine.push_back(result);
                 }
             }
-        }
-    }
+        });
 }
 
 void AreaSupport::cleanup(SliceDataStorage& storage)
@@ -607,6 +628,7 @@ void AreaSupport::generateOverhangAreas(SliceDataStorage& storage)
 
 void AreaSupport::generateSupportAreas(SliceDataStorage& storage)
 {
+    CURA_TRACE_SPAN("AreaSupport::generateSupportAreas");
     std::vector<Shape> global_support_areas_per_layer;
     global_support_areas_per_layer.resize(storage.print_layer_count);
 
@@ -635,6 +657,17 @@ void AreaSupport::generateSupportAreas(SliceDataStorage& storage)
     }
 
     // generate support areas
+    // The meshes are processed concurrently and then merged in order, as most of the work for a mesh is a loop over the layers from the top down.
+    struct SupportAreasJob
+    {
+        size_t mesh_idx;
+        const Settings* infill_settings;
+        const Settings* roof_settings;
+        const Settings* bottom_settings;
+        std::vector<Shape> support_areas_per_layer;
+        bool generated = false;
+    };
+    std::vector<SupportAreasJob> jobs;
     bool support_meshes_drop_down_handled = false;
     bool support_meshes_handled = false;
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
@@ -670,14 +703,46 @@ void AreaSupport::generateSupportAreas(SliceDataStorage& storage)
                 support_meshes_handled = true;
             }
         }
-        std::vector<Shape> mesh_support_areas_per_layer;
-        mesh_support_areas_per_layer.resize(storage.print_layer_count, Shape());
+        jobs.push_back(SupportAreasJob{ mesh_idx, infill_settings, roof_settings, bottom_settings, std::vector<Shape>(storage.print_layer_count, Shape()) });
+    }
+
+    std::atomic<size_t> layers_done = 0;
+    cura::parallel_for<size_t>(
+        0,
+        jobs.size(),
+        [&](const size_t job_idx)
+        {
+            SupportAreasJob& job = jobs[job_idx];
+            job.generated = generateSupportAreasForMesh(
+                storage,
+                *job.infill_settings,
+                *job.roof_settings,
+                *job.bottom_settings,
+                job.mesh_idx,
+                storage.print_layer_count,
+                job.support_areas_per_layer,
+                layers_done);
+        });
 
-        generateSupportAreasForMesh(storage, *infill_settings, *roof_settings, *bottom_settings, mesh_idx, storage.print_layer_count, mesh_support_areas_per_layer);
+    for (SupportAreasJob& job : jobs)
+    {
         for (size_t layer_idx = 0; layer_idx < storage.print_layer_count; layer_idx++)
         {
-            global_support_areas_per_layer[layer_idx].push_back(mesh_support_areas_per_layer[layer_idx]);
+            global_support_areas_per_layer[layer_idx].push_back(job.support_areas_per_layer[layer_idx]);
+        }
+        if (! job.generated)
+        {
+            continue;
         }
+        for (size_t layer_idx = job.support_areas_per_layer.size() - 1; layer_idx != static_cast<size_t>(std::max(-1, storage.support.layer_nr_max_filled_layer)); layer_idx--)
+        {
+            if (job.support_areas_per_layer[layer_idx].size() > 0)
+            {
+                storage.support.layer_nr_max_filled_layer = layer_idx;
+                break;
+            }
+        }
+        storage.support.generated = true;
     }
 
     for (Shape& support_areas : global_support_areas_per_layer)
@@ -693,13 +758,14 @@ void AreaSupport::generateSupportAreas(SliceDataStorage& storage)
             continue;
         }
 
+        SupportInterfaceOutlineCache mesh_outlines(*mesh); // Shared by the roofs and the bottoms, since both unite the outlines of ranges of layers.
         if (mesh->settings.get<bool>("support_roof_enable"))
         {
-            generateSupportRoof(storage, *mesh, global_support_areas_per_layer);
+            generateSupportRoof(storage, *mesh, mesh_outlines, global_support_areas_per_layer);
         }
         if (mesh->settings.get<bool>("support_bottom_enable"))
         {
-            generateSupportBottom(storage, *mesh, global_support_areas_per_layer);
+            generateSupportBottom(storage, *mesh, mesh_outlines, global_support_areas_per_layer);
         }
     }
 
@@ -808,25 +874,40 @@ void AreaSupport::generateOverhangAreasForMesh(SliceDataStorage& storage, SliceM
         {
             std::pair<Shape, Shape> basic_and_full_overhang = computeBasicAndFullOverhang(storage, mesh, layer_idx);
             mesh.overhang_areas[layer_idx] = basic_and_full_overhang.first; // Store the results.
-            mesh.full_overhang_areas[layer_idx] = basic_and_full_overhang.second;
+            mesh.full_overhang_areas[layer_idx] = CompactShape(basic_and_full_overhang.second);
             scripta::log("support_basic_overhang_area", basic_and_full_overhang.first, SectionType::SUPPORT, layer_idx);
             scripta::log("support_full_overhang_area", basic_and_full_overhang.second, SectionType::SUPPORT, layer_idx);
         });
 }
 
-Shape AreaSupport::generateVaryingXYDisallowedArea(const SliceMeshStorage& storage, const LayerIndex layer_idx)
+std::vector<Shape> AreaSupport::generateClosedOutlines(const SliceMeshStorage& storage)
 {
     const auto& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     const Simplify simplify{ mesh_group_settings };
+
+    constexpr auto close_dist = 20;
+
+    std::vector<Shape> closed_outlines(storage.layers.size());
+    cura::parallel_for<size_t>(
+        0,
+        storage.layers.size(),
+        [&](const size_t layer_idx)
+        {
+            closed_outlines[layer_idx] = simplify.polygon(storage.layers[layer_idx].getOutlines().offset(-close_dist).offset(close_dist));
+        });
+    return closed_outlines;
+}
+
+Shape AreaSupport::generateVaryingXYDisallowedArea(const SliceMeshStorage& storage, const std::vector<Shape>& closed_outlines, const LayerIndex layer_idx)
+{
+    const auto& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     const auto layer_thickness = mesh_group_settings.get<coord_t>("layer_height");
     const auto support_distance_top = static_cast<double>(mesh_group_settings.get<coord_t>("support_top_distance"));
     const auto support_distance_bot = static_cast<double>(mesh_group_settings.get<coord_t>("support_bottom_distance"));
     const auto overhang_angle = mesh_group_settings.get<AngleRadians>("support_angle");
     const auto xy_distance = static_cast<double>(mesh_group_settings.get<coord_t>("support_xy_distance"));
 
-    constexpr auto close_dist = 20;
-
-    Shape layer_current = simplify.polygon(storage.layers[layer_idx].getOutlines().offset(-close_dist).offset(close_dist));
+    const Shape& layer_current = closed_outlines[layer_idx];
 
     using point_pair_t = std::pair<size_t, double>;
     using poly_point_key = std::tuple<unsigned int, unsigned int>;
@@ -839,7 +920,7 @@ Shape AreaSupport::generateVaryingXYDisallowedArea(const SliceMeshStorage& stora
     {
         double support_distance;
         double delta_z;
-        Shape layer_delta;
+        const Shape& layer_delta;
     };
 
     std::vector<z_delta_poly_t> z_distances_layer_deltas;
@@ -851,7 +932,7 @@ Shape AreaSupport::generateVaryingXYDisallowedArea(const SliceMeshStorage& stora
     const LayerIndex layer_idx_below{ std::max(LayerIndex{ layer_idx - layer_index_offset }, LayerIndex{ 0 }) };
     if (layer_idx_below != layer_idx)
     {
-        const auto layer_below = simplify.polygon(storage.layers[layer_idx_below].getOutlines().offset(-close_dist).offset(close_dist));
+        const Shape& layer_below = closed_outlines[layer_idx_below];
         z_distances_layer_deltas.emplace_back(z_delta_poly_t{
             .support_distance = support_distance_bot,
             .delta_z = -static_cast<double>(layer_index_offset * layer_thickness),
@@ -862,7 +943,7 @@ Shape AreaSupport::generateVaryingXYDisallowedArea(const SliceMeshStorage& stora
     const LayerIndex layer_idx_above{ std::min(LayerIndex{ layer_idx + layer_index_offset }, LayerIndex{ storage.layers.size() - 1 }) };
     if (layer_idx_above != layer_idx)
     {
-        const auto layer_above = simplify.polygon(storage.layers[layer_idx_above].getOutlines().offset(-close_dist).offset(close_dist));
+        const Shape& layer_above = closed_outlines[layer_idx_above];
         z_distances_layer_deltas.emplace_back(z_delta_poly_t{
             .support_distance = support_distance_top,
             .delta_z = static_cast<double>(layer_index_offset * layer_thickness),
@@ -887,7 +968,7 @@ Shape AreaSupport::generateVaryingXYDisallowedArea(const SliceMeshStorage& stora
     {
         const auto support_distance = z_delta_poly.support_distance;
         const auto delta_z = z_delta_poly.delta_z;
-        const auto layer_delta = z_delta_poly.layer_delta;
+        const Shape& layer_delta = z_delta_poly.layer_delta;
         const auto xy_distance_natural = support_distance * boundedTan(overhang_angle);
 
         for (auto [current_poly_idx, current_poly] : layer_current | ranges::views::enumerate)
@@ -979,14 +1060,15 @@ Shape AreaSupport::generateVaryingXYDisallowedArea(const SliceMeshStorage& stora
  *
  * for support buildplate only: purge all support not connected to build plate
  */
-void AreaSupport::generateSupportAreasForMesh(
-    SliceDataStorage& storage,
+bool AreaSupport::generateSupportAreasForMesh(
+    const SliceDataStorage& storage,
     const Settings& infill_settings,
     const Settings& roof_settings,
     const Settings& bottom_settings,
     const size_t mesh_idx,
     const size_t layer_count,
-    std::vector<Shape>& support_areas)
+    std::vector<Shape>& support_areas,
+    std::atomic<size_t>& layers_done)
 {
     SliceMeshStorage& mesh = *storage.meshes[mesh_idx];
 
@@ -995,13 +1077,13 @@ void AreaSupport::generateSupportAreasForMesh(
         = mesh.settings.get<bool>("support_mesh"); // whether this mesh has empty SliceMeshStorage and this function is now called to only generate support for all support meshes
     if ((! mesh.settings.get<bool>("support_enable") || support_structure != ESupportStructure::NORMAL) && ! is_support_mesh_place_holder)
     {
-        return;
+        return false;
     }
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     const ESupportType support_type = mesh_group_settings.get<ESupportType>("support_type");
     if (support_type == ESupportType::NONE && ! is_support_mesh_place_holder)
     {
-        return;
+        return false;
     }
 
     // early out
@@ -1010,7 +1092,7 @@ void AreaSupport::generateSupportAreasForMesh(
     const size_t layer_z_distance_top = (z_distance_top / layer_thickness) + 1;
     if (layer_z_distance_top + 1 > layer_count)
     {
-        return;
+        return false;
     }
 
     // Compute the areas that are disallowed by the X/Y distance.
@@ -1036,6 +1118,8 @@ void AreaSupport::generateSupportAreasForMesh(
     // The maximum width of an odd wall = 2 * minimum even wall width.
     auto half_min_feature_width = min_even_wall_line_width + 10;
 
+    const std::vector<Shape> closed_outlines = use_xy_distance_overhang && ! is_support_mesh_place_holder ? generateClosedOutlines(mesh) : std::vector<Shape>();
+
     cura::parallel_for<size_t>(
         1,
         layer_count,
@@ -1073,7 +1157,7 @@ void AreaSupport::generateSupportAreasForMesh(
                     // layer below that protrudes beyond the current layer's area and combine it with the current layer's overhang disallowed area
 
                     Shape minimum_xy_disallowed_areas = mesh.layers[layer_idx].getOutlines().offset(xy_distance_overhang);
-                    Shape varying_xy_disallowed_areas = generateVaryingXYDisallowedArea(mesh, layer_idx);
+                    Shape varying_xy_disallowed_areas = generateVaryingXYDisallowedArea(mesh, closed_outlines, layer_idx);
                     xy_disallowed_per_layer[layer_idx] = minimum_xy_disallowed_areas.unionPolygons(varying_xy_disallowed_areas);
                     scripta::log("support_xy_disallowed_areas", xy_disallowed_per_layer[layer_idx], SectionType::SUPPORT, layer_idx);
                 }
@@ -1126,36 +1210,51 @@ void AreaSupport::generateSupportAreasForMesh(
             bottom_stair_step_layer_count);
     }
 
-    for (size_t layer_idx = layer_count - 1 - layer_z_distance_top; layer_idx != static_cast<size_t>(-1); layer_idx--)
-    {
-        Shape layer_this = mesh.full_overhang_areas[layer_idx + layer_z_distance_top];
-
-        if (extension_offset && ! is_support_mesh_place_holder)
+    // The horizontal expansion and the wall struts only depend on the overhang of the layer itself, so they're done for all layers in parallel before the layers are joined.
+    std::vector<Shape> overhang_per_layer(layer_count - layer_z_distance_top);
+    cura::parallel_for<size_t>(
+        0,
+        overhang_per_layer.size(),
+        [&](const size_t layer_idx)
         {
-            // To avoid that the support is folding around the model, the support horizontal expansion should not cause
-            // the support to grow towards the model. Stepwise applying the support horizontal expansion to both the
-            // model outline and the support is effectively calculating a voronoi. The offset is first applied to
-            // the support and next to the model to ensure that the expanded support area is connected to the original
-            // support area. Please note that the horizontal expansion is rounded down to an integer offset_per_step.
-            Shape model_outline = storage.getLayerOutlines(layer_idx, no_support, no_prime_tower);
-            const coord_t offset_per_step = support_line_width / 2;
-
-            // perform a small offset we don't enlarge small features of the support
-            Shape horizontal_expansion = layer_this;
-            for (coord_t offset_cumulative = 0; offset_cumulative <= extension_offset; offset_cumulative += offset_per_step)
+            Shape& layer_this = overhang_per_layer[layer_idx];
+            layer_this = mesh.full_overhang_areas[layer_idx + layer_z_distance_top].decode();
+
+            if (extension_offset && ! is_support_mesh_place_holder)
+            {
+                // To avoid that the support is folding around the model, the support horizontal expansion should not cause
+                // the support to grow towards the model. Stepwise applying the support horizontal expansion to both the
+                // model outline and the support is effectively calculating a voronoi. The offset is first applied to
+                // the support and next to the model to ensure that the expanded support area is connected to the original
+                // support area. Please note that the horizontal expansion is rounded down to an integer offset_per_step.
+                Shape model_outline = storage.getLayerOutlines(layer_idx, no_support, no_prime_tower);
+                const coord_t offset_per_step = support_line_width / 2;
+
+                // perform a small offset we don't enlarge small features of the support
+                Shape horizontal_expansion = layer_this;
+                for (coord_t offset_cumulative = 0; offset_cumulative <= extension_offset; offset_cumulative += offset_per_step)
+                {
+                    horizontal_expansion = horizontal_expansion.offset(offset_per_step);
+                    model_outline = model_outline.difference(horizontal_expansion);
+                    model_outline = model_outline.offset(offset_per_step);
+                    horizontal_expansion = horizontal_expansion.difference(model_outline);
+                }
+                layer_this = layer_this.unionPolygons(horizontal_expansion);
+            }
+
+            if (use_towers && ! is_support_mesh_place_holder)
             {
-                horizontal_expansion = horizontal_expansion.offset(offset_per_step);
-                model_outline = model_outline.difference(horizontal_expansion);
-                model_outline = model_outline.offset(offset_per_step);
-                horizontal_expansion = horizontal_expansion.difference(model_outline);
+                // handle straight walls
+                AreaSupport::handleWallStruts(infill_settings, layer_this);
             }
-            layer_this = layer_this.unionPolygons(horizontal_expansion);
-        }
+        });
+
+    for (size_t layer_idx = layer_count - 1 - layer_z_distance_top; layer_idx != static_cast<size_t>(-1); layer_idx--)
+    {
+        Shape layer_this = std::move(overhang_per_layer[layer_idx]);
 
         if (use_towers && ! is_support_mesh_place_holder)
         {
-            // handle straight walls
-            AreaSupport::handleWallStruts(infill_settings, layer_this);
             // handle towers
             AreaSupport::handleTowers(infill_settings, xy_disallowed_per_layer[layer_idx], layer_this, tower_roofs, mesh.overhang_points, layer_idx, layer_count);
         }
@@ -1213,7 +1312,11 @@ void AreaSupport::generateSupportAreasForMesh(
             bottom_stair_step_width);
 
         support_areas[layer_idx] = layer_this;
-        Progress::messageProgress(Progress::Stage::SUPPORT, layer_count * (mesh_idx + 1) - layer_idx, layer_count * storage.meshes.size());
+        {
+            static std::mutex progress_mutex;
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            Progress::messageProgress(Progress::Stage::SUPPORT, ++layers_done, layer_count * storage.meshes.size());
+        }
     }
 
     // Removal of the x/y distance needs to be outside the main loop
@@ -1221,20 +1324,26 @@ void AreaSupport::generateSupportAreasForMesh(
     // structure. However, it would also remove polygon-parts close to the
     // model. For surfaces close to the maximum overhang angle no support
     // would be generated at all.
-    for (auto [support_layer, xy_disallowed_area] : ranges::views::zip(support_areas, xy_disallowed_per_layer))
-    {
-        // inset using X/Y distance
-        if (! support_layer.empty() && ! xy_disallowed_area.empty())
+    cura::parallel_for<size_t>(
+        0,
+        std::min(support_areas.size(), xy_disallowed_per_layer.size()),
+        [&](const size_t layer_idx)
         {
-            support_layer = support_layer.difference(xy_disallowed_area);
-        }
+            Shape& support_layer = support_areas[layer_idx];
+            const Shape& xy_disallowed_area = xy_disallowed_per_layer[layer_idx];
 
-        // Perform close operation to remove areas from support area that are unprintable
-        support_layer = support_layer.offset(-half_min_feature_width).offset(half_min_feature_width);
+            // inset using X/Y distance
+            if (! support_layer.empty() && ! xy_disallowed_area.empty())
+            {
+                support_layer = support_layer.difference(xy_disallowed_area);
+            }
 
-        // remove areas smaller than the minimum support area
-        support_layer.removeSmallAreas(minimum_support_area);
-    }
+            // Perform close operation to remove areas from support area that are unprintable
+            support_layer = support_layer.offset(-half_min_feature_width).offset(half_min_feature_width);
+
+            // remove areas smaller than the minimum support area
+            support_layer.removeSmallAreas(minimum_support_area);
+        });
 
     // do stuff for when support on buildplate only
     if (support_type == ESupportType::PLATFORM_ONLY)
@@ -1315,16 +1424,7 @@ void AreaSupport::generateSupportAreasForMesh(
         }
     }
 
-    for (size_t layer_idx = support_areas.size() - 1; layer_idx != static_cast<size_t>(std::max(-1, storage.support.layer_nr_max_filled_layer)); layer_idx--)
-    {
-        if (support_areas[layer_idx].size() > 0)
-        {
-            storage.support.layer_nr_max_filled_layer = layer_idx;
-            break;
-        }
-    }
-
-    storage.support.generated = true;
+    return true;
 }
 
 void AreaSupport::moveUpFromModel(
@@ -1455,10 +1555,14 @@ std::pair<Shape, Shape> AreaSupport::computeBasicAndFullOverhang(const SliceData
     // is taken over smooth_height. The smooth_height is currently an educated guess
     // that we might want to expose to the frontend in the future.
     Shape outlines_below = storage.getLayerOutlines(layer_idx - 1, no_support, no_prime_tower).offset(max_dist_from_lower_layer);
+    std::vector<Shape> further_outlines_below;
     for (int layer_idx_offset = 2; layer_idx - layer_idx_offset >= 0 && layer_idx_offset <= layers_below; layer_idx_offset++)
     {
-        auto outlines_below_ = storage.getLayerOutlines(layer_idx - layer_idx_offset, no_support, no_prime_tower).offset(max_dist_from_lower_layer * layer_idx_offset);
-        outlines_below = outlines_below.unionPolygons(outlines_below_);
+        further_outlines_below.push_back(storage.getLayerOutlines(layer_idx - layer_idx_offset, no_support, no_prime_tower).offset(max_dist_from_lower_layer * layer_idx_offset));
+    }
+    if (! further_outlines_below.empty())
+    {
+        outlines_below = outlines_below.unionPolygons(further_outlines_below);
     }
 
     Shape basic_overhang = outlines.difference(outlines_below);
@@ -1489,37 +1593,45 @@ void AreaSupport::detectOverhangPoints(const SliceDataStorage& storage, SliceMes
 
     mesh.overhang_points.resize(storage.print_layer_count);
 
-    for (size_t layer_idx = 1; layer_idx < storage.print_layer_count; layer_idx++)
-    {
-        const SliceLayer& layer = mesh.layers[layer_idx];
-        const SliceLayer& layer_below = mesh.layers[layer_idx - 1];
-
-        for (const SliceLayerPart& part : layer.parts)
+    // Every layer only looks at itself and the layer below, so they can all be done at once.
+    cura::parallel_for<size_t>(
+        1,
+        storage.print_layer_count,
+        [&](const size_t layer_idx)
         {
-            if (part.outline.empty())
-            {
-                continue;
-            }
-            if (part.outline.outerPolygon().area() >= max_tower_supported_area)
-            {
-                // area is too big for support towers, should be supported by normal overhang detection
-                continue;
-            }
+            const SliceLayer& layer = mesh.layers[layer_idx];
+            std::optional<Shape> outlines_below; // Only computed once a part is small enough for a tower.
 
-            auto has_support_below = ! layer_below.getOutlines().intersection(part.outline).empty();
-            if (has_support_below)
+            for (const SliceLayerPart& part : layer.parts)
             {
-                continue;
-            }
+                if (part.outline.empty())
+                {
+                    continue;
+                }
+                if (part.outline.outerPolygon().area() >= max_tower_supported_area)
+                {
+                    // area is too big for support towers, should be supported by normal overhang detection
+                    continue;
+                }
 
-            const Shape overhang = part.outline.difference(storage.support.supportLayers[layer_idx].anti_overhang);
-            if (! overhang.empty())
-            {
-                scripta::log("support_overhangs", overhang, SectionType::SUPPORT, layer_idx);
-                mesh.overhang_points[layer_idx].push_back(overhang);
+                if (! outlines_below)
+                {
+                    outlines_below = mesh.layers[layer_idx - 1].getOutlines();
+                }
+                auto has_support_below = ! outlines_below->intersection(part.outline).empty();
+                if (has_support_below)
+                {
+                    continue;
+                }
+
+                const Shape overhang = part.outline.difference(storage.support.supportLayers[layer_idx].anti_overhang);
+                if (! overhang.empty())
+                {
+                    scripta::log("support_overhangs", overhang, SectionType::SUPPORT, layer_idx);
+                    mesh.overhang_points[layer_idx].push_back(overhang);
+                }
             }
-        }
-    }
+        });
 }
 
 void AreaSupport::handleTowers(
@@ -1545,12 +1657,15 @@ void AreaSupport::handleTowers(
         {
             const auto max_tower_supported_diameter = settings.get<coord_t>("support_tower_maximum_supported_diameter");
             std::vector<Shape>& overhang_points_below = overhang_points[layer_overhang_point - 1];
+            std::vector<Shape> overhang_points_below_expanded;
+            overhang_points_below_expanded.reserve(overhang_points_below.size());
+            for (const Shape& poly_below : overhang_points_below)
+            {
+                overhang_points_below_expanded.push_back(poly_below.offset(max_tower_supported_diameter * 2));
+            }
             for (Shape& poly_here : overhang_points_here)
             {
-                for (const Shape& poly_below : overhang_points_below)
-                {
-                    poly_here = poly_here.difference(poly_below.offset(max_tower_supported_diameter * 2));
-                }
+                poly_here = poly_here.difference(overhang_points_below_expanded);
             }
         }
         for (Shape& poly : overhang_points_here)
@@ -1580,6 +1695,7 @@ void AreaSupport::handleTowers(
         tower_roof_expansion_distance = layer_thickness / tan_tower_roof_angle;
     }
 
+    std::vector<Shape> roofs_to_add; // Unioned with the support all at once, which is much faster than one by one.
     for (Shape& tower_roof : tower_roofs
                                  | ranges::views::filter(
                                      [](const auto& poly)
@@ -1587,7 +1703,7 @@ void AreaSupport::handleTowers(
                                          return ! poly.empty();
                                      }))
     {
-        supportLayer_this = supportLayer_this.unionPolygons(tower_roof);
+        roofs_to_add.push_back(tower_roof);
 
         if (tower_roof.area() < tower_diameter * tower_diameter)
         {
@@ -1614,7 +1730,7 @@ void AreaSupport::handleTowers(
                 {
                     // the desired size of the roof tower is reached, add the support tower to the
                     // current layer and clear the support tower itself
-                    supportLayer_this = supportLayer_this.unionPolygons(tower_roof);
+                    roofs_to_add.push_back(std::move(tower_roof));
                     tower_roof.clear();
                     break;
                 }
@@ -1625,6 +1741,10 @@ void AreaSupport::handleTowers(
             tower_roof.clear();
         }
     }
+    if (! roofs_to_add.empty())
+    {
+        supportLayer_this = supportLayer_this.unionPolygons(roofs_to_add);
+    }
 }
 
 void AreaSupport::handleWallStruts(const Settings& settings, Shape& supportLayer_this)
@@ -1672,7 +1792,11 @@ void AreaSupport::handleWallStruts(const Settings& settings, Shape& supportLayer
     }
 }
 
-void AreaSupport::generateSupportBottom(SliceDataStorage& storage, const SliceMeshStorage& mesh, std::vector<Shape>& global_support_areas_per_layer)
+void AreaSupport::generateSupportBottom(
+    SliceDataStorage& storage,
+    const SliceMeshStorage& mesh,
+    SupportInterfaceOutlineCache& mesh_outlines,
+    std::vector<Shape>& global_support_areas_per_layer)
 {
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     const coord_t layer_height = mesh_group_settings.get<coord_t>("layer_height");
@@ -1688,22 +1812,26 @@ void AreaSupport::generateSupportBottom(SliceDataStorage& storage, const SliceMe
     const double minimum_bottom_area = mesh.settings.get<double>("minimum_bottom_area");
 
     std::vector<SupportLayer>& support_layers = storage.support.supportLayers;
-    for (LayerIndex layer_idx = support_layers.size() - 1; layer_idx >= static_cast<int>(z_distance_bottom); --layer_idx)
-    {
-        const unsigned int bottom_layer_idx_below = std::max(0, int(layer_idx) - int(bottom_layer_count) - int(z_distance_bottom));
-        Shape mesh_outlines;
-        for (auto layer_idx_below = bottom_layer_idx_below; layer_idx_below < layer_idx - z_distance_bottom + 1; layer_idx_below += 1)
+    // Every layer only changes its own support, so they can all be done at once.
+    cura::parallel_for<size_t>(
+        std::min(static_cast<size_t>(z_distance_bottom), support_layers.size()),
+        support_layers.size(),
+        [&](const size_t layer_idx)
         {
-            mesh_outlines.push_back(mesh.layers[layer_idx_below].getOutlines());
-        }
-        Shape bottoms;
-        generateSupportInterfaceLayer(global_support_areas_per_layer[layer_idx], mesh_outlines, bottom_line_width, bottom_outline_offset, minimum_bottom_area, bottoms);
-        support_layers[layer_idx].support_bottom.push_back(bottoms);
-        scripta::log("support_interface_bottoms", bottoms, SectionType::SUPPORT, layer_idx);
-    }
+            const LayerIndex bottom_layer_idx_below = std::max(0, int(layer_idx) - int(bottom_layer_count) - int(z_distance_bottom));
+            const Shape model = mesh_outlines.unionOf(bottom_layer_idx_below, LayerIndex(layer_idx) - z_distance_bottom);
+            Shape bottoms;
+            generateSupportInterfaceLayer(global_support_areas_per_layer[layer_idx], model, bottom_line_width, bottom_outline_offset, minimum_bottom_area, bottoms);
+            support_layers[layer_idx].support_bottom.push_back(bottoms);
+            scripta::log("support_interface_bottoms", bottoms, SectionType::SUPPORT, layer_idx);
+        });
 }
 
-void AreaSupport::generateSupportRoof(SliceDataStorage& storage, const SliceMeshStorage& mesh, std::vector<Shape>& global_support_areas_per_layer)
+void AreaSupport::generateSupportRoof(
+    SliceDataStorage& storage,
+    const SliceMeshStorage& mesh,
+    SupportInterfaceOutlineCache& mesh_outlines,
+    std::vector<Shape>& global_support_areas_per_layer)
 {
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     const coord_t layer_height = mesh_group_settings.get<coord_t>("layer_height");
@@ -1719,25 +1847,34 @@ void AreaSupport::generateSupportRoof(SliceDataStorage& storage, const SliceMesh
     const double minimum_roof_area = mesh.settings.get<double>("minimum_roof_area");
 
     std::vector<SupportLayer>& support_layers = storage.support.supportLayers;
-    for (LayerIndex layer_idx = static_cast<int>(support_layers.size() - z_distance_top) - 1; layer_idx >= 0; --layer_idx)
-    {
-        const LayerIndex top_layer_idx_above{
-            std::min(LayerIndex{ support_layers.size() - 1 }, LayerIndex{ layer_idx + roof_layer_count + z_distance_top })
-        }; // Maximum layer of the model that generates support roof.
-        Shape mesh_outlines;
-        for (auto layer_idx_above = top_layer_idx_above; layer_idx_above > layer_idx + z_distance_top - 1; layer_idx_above -= 1)
+    const size_t roof_support_layer_count = std::max(static_cast<int>(support_layers.size() - z_distance_top), 0);
+    // Every layer only changes its own support, so they can all be done at once.
+    cura::parallel_for<size_t>(
+        0,
+        roof_support_layer_count,
+        [&](const size_t layer_idx)
         {
-            mesh_outlines.push_back(mesh.layers[layer_idx_above].getOutlines());
-        }
-        Shape roofs;
-        generateSupportInterfaceLayer(global_support_areas_per_layer[layer_idx], mesh_outlines, roof_line_width, roof_outline_offset, minimum_roof_area, roofs);
-        support_layers[layer_idx].support_roof.push_back(roofs);
-        if (layer_idx > 0 && layer_idx < support_layers.size() - 1)
+            const LayerIndex top_layer_idx_above{
+                std::min(LayerIndex{ support_layers.size() - 1 }, LayerIndex{ layer_idx + roof_layer_count + z_distance_top })
+            }; // Maximum layer of the model that generates support roof.
+            const Shape model = mesh_outlines.unionOf(LayerIndex(layer_idx) + z_distance_top, top_layer_idx_above);
+            Shape roofs;
+            generateSupportInterfaceLayer(global_support_areas_per_layer[layer_idx], model, roof_line_width, roof_outline_offset, minimum_roof_area, roofs);
+            support_layers[layer_idx].support_roof.push_back(roofs);
+            scripta::log("support_interface_roofs", roofs, SectionType::SUPPORT, layer_idx);
+        });
+    // The fractional roof is the part of the roof that the layer above doesn't have, so it needs the roofs of both layers.
+    cura::parallel_for<size_t>(
+        1,
+        std::min(roof_support_layer_count, support_layers.size() - 1),
+        [&](const size_t layer_idx)
         {
-            support_layers[layer_idx].support_fractional_roof.push_back(roofs.difference(support_layers[layer_idx + 1].support_roof));
-        }
-        scripta::log("support_interface_roofs", roofs, SectionType::SUPPORT, layer_idx);
-    }
+            const Shape& roofs = support_layers[layer_idx].support_roof;
+            if (! roofs.empty())
+            {
+                support_layers[layer_idx].support_fractional_roof.push_back(roofs.difference(support_layers[layer_idx + 1].support_roof));
+            }
+        });
 
     // Remove support in between the support roof and the model. Subtracts the roof polygons from the support polygons on the layers above it.
     for (auto [layer_idx, support_layer] : support_layers | ranges::views::enumerate | ranges::views::drop(1) | ranges::views::drop_last(z_distance_top))
@@ -1758,13 +1895,12 @@ void AreaSupport::generateSupportRoof(SliceDataStorage& storage, const SliceMesh
 
 void AreaSupport::generateSupportInterfaceLayer(
     Shape& support_areas,
-    const Shape colliding_mesh_outlines,
+    const Shape& model,
     const coord_t safety_offset,
     const coord_t outline_offset,
     const double minimum_interface_area,
     Shape& interface_polygons)
 {
-    Shape model = colliding_mesh_outlines.unionPolygons();
     interface_polygons = support_areas.offset(safety_offset / 2).intersection(model);
     interface_polygons = interface_polygons.offset(safety_offset).intersection(support_areas); // Make sure we don't generate any models that are not printable.
     if (outline_offset != 0)
@@ -54,10 +54,16 @@ void TimeEstimateCalculator::setMaxXyJerk(const Velocity& jerk)
     max_xy_jerk = jerk;
 }
 
+void TimeEstimateCalculator::setLookahead(const size_t new_lookahead)
+{
+    lookahead = new_lookahead;
+}
+
 void TimeEstimateCalculator::reset()
 {
     extra_time = 0.0;
     blocks.clear();
+    std::fill(finalized_times.begin(), finalized_times.end(), Duration(0.0));
 }
 
 // Calculates the maximum allowable speed at this point when you must be able to reach target_velocity using the
@@ -268,6 +274,36 @@ void TimeEstimateCalculator::plan(Position newPos, Velocity feedrate, PrintFeatu
     calculateTrapezoidForBlock(&block, Ratio(block.entry_speed / block.nominal_feedrate), Ratio(safe_speed / block.nominal_feedrate));
 
     blocks.push_back(block);
+
+    // Finalizing in batches lets every finalized block see at least lookahead blocks ahead, while each block is only planned about twice.
+    if (lookahead > 0 && blocks.size() >= 2 * lookahead)
+    {
+        finalizeOldestBlocks(blocks.size() - lookahead);
+    }
+}
+
+// Adds the time it takes to execute a planned block to the total of its feature.
+static inline void addBlockTime(std::vector<Duration>& totals, const TimeEstimateCalculator::Block& block)
+{
+    const double plateau_distance = block.decelerate_after - block.accelerate_until;
+
+    totals[static_cast<unsigned char>(block.feature)] += accelerationTimeFromDistance(block.initial_feedrate, block.accelerate_until, block.acceleration);
+    totals[static_cast<unsigned char>(block.feature)] += plateau_distance / block.nominal_feedrate;
+    totals[static_cast<unsigned char>(block.feature)] += accelerationTimeFromDistance(block.final_feedrate, (block.distance - block.decelerate_after), block.acceleration);
+}
+
+void TimeEstimateCalculator::finalizeOldestBlocks(const size_t count)
+{
+    reversePass();
+    forwardPass();
+    recalculateTrapezoids();
+
+    for (size_t n = 0; n < count; n++)
+    {
+        addBlockTime(finalized_times, blocks[n]);
+    }
+    // The last finalized block ends at the entry speed of the new first block. The planner never changes the entry speed of the first block, so that stays consistent.
+    blocks.erase(blocks.begin(), blocks.begin() + count);
 }
 
 std::vector<Duration> TimeEstimateCalculator::calculate()
@@ -278,14 +314,13 @@ std::vector<Duration> TimeEstimateCalculator::calculate()
 
     std::vector<Duration> totals(static_cast<unsigned char>(PrintFeatureType::NumPrintFeatureTypes), 0.0);
     totals[static_cast<unsigned char>(PrintFeatureType::NoneType)] = extra_time; // Extra time (pause for minimum layer time, etc) is marked as NoneType
+    for (size_t feature = 0; feature < totals.size(); feature++)
+    {
+        totals[feature] += finalized_times[feature];
+    }
     for (unsigned int n = 0; n < blocks.size(); n++)
     {
-        const Block& block = blocks[n];
-        const double plateau_distance = block.decelerate_after - block.accelerate_until;
-
-        totals[static_cast<unsigned char>(block.feature)] += accelerationTimeFromDistance(block.initial_feedrate, block.accelerate_until, block.acceleration);
-        totals[static_cast<unsigned char>(block.feature)] += plateau_distance / block.nominal_feedrate;
-        totals[static_cast<unsigned char>(block.feature)] += accelerationTimeFromDistance(block.final_feedrate, (block.distance - block.decelerate_after), block.acceleration);
+        addBlockTime(totals, blocks[n]);
     }
     return totals;
 }
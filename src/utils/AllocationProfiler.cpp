@@ -0,0 +1,317 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/AllocationProfiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace cura
+{
+
+namespace
+{
+
+thread_local uint64_t thread_allocations = 0;
+thread_local uint64_t thread_bytes = 0;
+thread_local uint64_t thread_bytes_since_peak_sample = 0;
+
+std::atomic<size_t> next_thread_slot{ 0 };
+
+//! Which set of counters the calling thread counts in.
+size_t threadSlot()
+{
+    thread_local const size_t slot = next_thread_slot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+double toMebibytes(const uint64_t bytes)
+{
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+AllocationProfiler& AllocationProfiler::getInstance()
+{
+    // Never destroyed, since memory is still freed after the static objects are destroyed.
+    alignas(AllocationProfiler) static unsigned char storage[sizeof(AllocationProfiler)];
+    static AllocationProfiler* instance = new (storage) AllocationProfiler();
+    return *instance;
+}
+
+void AllocationProfiler::enable(std::string report_file)
+{
+    report_file_ = std::move(report_file);
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void AllocationProfiler::startStage(const size_t stage_idx, const std::string_view name)
+{
+    const size_t idx = std::min(stage_idx, max_stages - 1);
+    stage_names_[idx] = name;
+    samplePeak(idx);
+    stage_idx_.store(idx, std::memory_order_relaxed);
+}
+
+AllocationProfiler::ThreadCounts AllocationProfiler::threadCounts()
+{
+    return ThreadCounts{ .allocations = thread_allocations, .bytes = thread_bytes };
+}
+
+void AllocationProfiler::recordSubStage(const std::string_view name, const ThreadCounts& start)
+{
+    if (! isEnabled() || thread_allocations < start.allocations || thread_bytes < start.bytes) // Started before the profiler was enabled or on another thread.
+    {
+        return;
+    }
+    const ThreadCounts counts{ .allocations = thread_allocations - start.allocations, .bytes = thread_bytes - start.bytes };
+    std::lock_guard lock(sub_stages_mutex_);
+    ThreadCounts& total = sub_stages_[{ stage_idx_.load(std::memory_order_relaxed), std::string(name) }];
+    total.allocations += counts.allocations;
+    total.bytes += counts.bytes;
+}
+
+void AllocationProfiler::recordAllocation(const size_t size)
+{
+    Slot& slot = slots_[threadSlot() % counter_slots];
+    // The live bytes are counted even when disabled, since what was allocated before is freed later.
+    slot.live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    if (! isEnabled())
+    {
+        return;
+    }
+    thread_allocations++;
+    thread_bytes += size;
+    const size_t stage_idx = stage_idx_.load(std::memory_order_relaxed);
+    slot.allocations[stage_idx].fetch_add(1, std::memory_order_relaxed);
+    slot.bytes[stage_idx].fetch_add(size, std::memory_order_relaxed);
+    thread_bytes_since_peak_sample += size;
+    if (thread_bytes_since_peak_sample >= peak_sample_bytes)
+    {
+        thread_bytes_since_peak_sample = 0;
+        samplePeak(stage_idx);
+    }
+}
+
+void AllocationProfiler::recordDeallocation(const size_t size)
+{
+    slots_[threadSlot() % counter_slots].live_bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+
+int64_t AllocationProfiler::liveBytes() const
+{
+    int64_t live = 0;
+    for (const Slot& slot : slots_)
+    {
+        live += slot.live_bytes.load(std::memory_order_relaxed);
+    }
+    return live;
+}
+
+void AllocationProfiler::samplePeak(const size_t stage_idx)
+{
+    const int64_t live = liveBytes();
+    int64_t peak = peak_live_bytes_[stage_idx].load(std::memory_order_relaxed);
+    while (live > peak && ! peak_live_bytes_[stage_idx].compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+}
+
+void AllocationProfiler::report()
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+
+    std::array<Stats, max_stages> stages{};
+    for (Slot& slot : slots_)
+    {
+        for (size_t stage_idx = 0; stage_idx < max_stages; stage_idx++)
+        {
+            stages[stage_idx].allocations += slot.allocations[stage_idx].exchange(0, std::memory_order_relaxed);
+            stages[stage_idx].bytes += slot.bytes[stage_idx].exchange(0, std::memory_order_relaxed);
+        }
+    }
+    samplePeak(stage_idx_.load(std::memory_order_relaxed));
+    const int64_t live = liveBytes();
+    for (size_t stage_idx = 0; stage_idx < max_stages; stage_idx++)
+    {
+        stages[stage_idx].peak_live_bytes = peak_live_bytes_[stage_idx].exchange(live, std::memory_order_relaxed);
+    }
+    std::vector<std::pair<std::pair<size_t, std::string>, ThreadCounts>> sub_stages;
+    {
+        std::lock_guard lock(sub_stages_mutex_);
+        sub_stages.assign(sub_stages_.begin(), sub_stages_.end());
+        sub_stages_.clear();
+    }
+    std::stable_sort(
+        sub_stages.begin(),
+        sub_stages.end(),
+        [](const auto& a, const auto& b)
+        {
+            return a.first.first < b.first.first || (a.first.first == b.first.first && a.second.allocations > b.second.allocations);
+        });
+
+    constexpr size_t logged_sub_stages = 5;
+    spdlog::info("Allocations per stage:");
+    for (size_t stage_idx = 0; stage_idx < max_stages; stage_idx++)
+    {
+        const Stats& stats = stages[stage_idx];
+        if (stats.allocations == 0)
+        {
+            continue;
+        }
+        spdlog::info(
+            "  {}: {} allocations, {:.1f} MiB, peak {:.1f} MiB live",
+            stage_names_[stage_idx],
+            stats.allocations,
+            toMebibytes(stats.bytes),
+            toMebibytes(static_cast<uint64_t>(std::max<int64_t>(0, stats.peak_live_bytes))));
+        size_t logged = 0;
+        for (const auto& [key, counts] : sub_stages)
+        {
+            if (key.first == stage_idx && logged++ < logged_sub_stages)
+            {
+                spdlog::info("    {}: {} allocations, {:.1f} MiB", key.second, counts.allocations, toMebibytes(counts.bytes));
+            }
+        }
+    }
+
+    if (report_file_.empty())
+    {
+        return;
+    }
+    std::ofstream file(report_file_);
+    if (! file)
+    {
+        spdlog::error("Couldn't write the allocation profile to {}.", report_file_);
+        return;
+    }
+    file << "stage,sub_stage,allocations,bytes,peak_live_bytes\n";
+    for (size_t stage_idx = 0; stage_idx < max_stages; stage_idx++)
+    {
+        const Stats& stats = stages[stage_idx];
+        if (stats.allocations == 0)
+        {
+            continue;
+        }
+        file << stage_names_[stage_idx] << ",," << stats.allocations << ',' << stats.bytes << ',' << stats.peak_live_bytes << "\n";
+        for (const auto& [key, counts] : sub_stages)
+        {
+            if (key.first == stage_idx)
+            {
+                file << stage_names_[stage_idx] << ',' << key.second << ',' << counts.allocations << ',' << counts.bytes << ",\n";
+            }
+        }
+    }
+    spdlog::info("Wrote the allocation profile to {}.", report_file_);
+}
+
+} // namespace cura
+
+#ifdef ALLOCATION_PROFILING
+namespace
+{
+
+// Every allocation is preceded by its size, so that the live bytes can be counted down again when it's freed.
+constexpr size_t header_size = alignof(std::max_align_t);
+
+void* allocate(const size_t size) noexcept
+{
+    void* block = std::malloc(size + header_size);
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+    *static_cast<size_t*>(block) = size;
+    cura::AllocationProfiler::getInstance().recordAllocation(size);
+    return static_cast<char*>(block) + header_size;
+}
+
+void* allocateOrThrow(const size_t size)
+{
+    while (true)
+    {
+        if (void* pointer = allocate(size))
+        {
+            return pointer;
+        }
+        const std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void deallocate(void* pointer) noexcept
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+    void* block = static_cast<char*>(pointer) - header_size;
+    cura::AllocationProfiler::getInstance().recordDeallocation(*static_cast<size_t*>(block));
+    std::free(block);
+}
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    return allocateOrThrow(size);
+}
+
+void* operator new[](size_t size)
+{
+    return allocateOrThrow(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
+#endif // ALLOCATION_PROFILING
@@ -0,0 +1,112 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/ArcFitter.h"
+
+#include <cmath>
+#include <numbers>
+
+namespace cura
+{
+
+ArcFitter::ArcFitter(const coord_t tolerance)
+    : tolerance_(tolerance)
+{
+}
+
+std::vector<ArcFitter::Arc> ArcFitter::fit(const Point2LL& start, const std::vector<Point2LL>& points) const
+{
+    std::vector<Arc> arcs;
+    const size_t last_idx = points.size(); // The start is index 0, so the last point has the index of the number of points.
+    size_t first = 0;
+    while (first + min_segments <= last_idx)
+    {
+        std::optional<Arc> best;
+        for (size_t last = first + min_segments; last <= last_idx && last - first <= max_segments; last++)
+        {
+            std::optional<Arc> arc = fitArc(start, points, first, last);
+            if (! arc)
+            {
+                break;
+            }
+            best = arc;
+        }
+        if (best)
+        {
+            arcs.push_back(*best);
+            first = best->last_point_idx + 1;
+        }
+        else
+        {
+            first++;
+        }
+    }
+    return arcs;
+}
+
+std::optional<ArcFitter::Arc> ArcFitter::fitArc(const Point2LL& start, const std::vector<Point2LL>& points, const size_t first, const size_t last) const
+{
+    const auto point = [&start, &points](const size_t idx)
+    {
+        return idx == 0 ? start : points[idx - 1];
+    };
+
+    // The circle through the first, middle and last point, relative to the first point to keep the numbers small.
+    const Point2LL origin = point(first);
+    const Point2LL middle = point((first + last) / 2) - origin;
+    const Point2LL end = point(last) - origin;
+    const double determinant = 2.0 * (static_cast<double>(middle.X) * end.Y - static_cast<double>(middle.Y) * end.X);
+    if (std::abs(determinant) < 1.0)
+    {
+        return std::nullopt; // Practically on a straight line.
+    }
+    const double middle_squared = static_cast<double>(middle.X) * middle.X + static_cast<double>(middle.Y) * middle.Y;
+    const double end_squared = static_cast<double>(end.X) * end.X + static_cast<double>(end.Y) * end.Y;
+    const double center_x = (end.Y * middle_squared - middle.Y * end_squared) / determinant;
+    const double center_y = (middle.X * end_squared - end.X * middle_squared) / determinant;
+    const double radius = std::hypot(center_x, center_y);
+    if (radius < min_radius || radius > max_radius)
+    {
+        return std::nullopt;
+    }
+    const bool counter_clockwise = determinant > 0;
+
+    double sweep = 0.0;
+    double previous_x = -center_x;
+    double previous_y = -center_y;
+    for (size_t idx = first + 1; idx <= last; idx++)
+    {
+        const Point2LL relative = point(idx) - origin;
+        const double x = relative.X - center_x;
+        const double y = relative.Y - center_y;
+        if (std::abs(std::hypot(x, y) - radius) > tolerance_)
+        {
+            return std::nullopt;
+        }
+        const double cross = previous_x * y - previous_y * x;
+        const double dot = previous_x * x + previous_y * y;
+        if ((cross > 0) != counter_clockwise || dot <= 0)
+        {
+            return std::nullopt; // Going back, or too big a step to tell.
+        }
+        const double half_chord = std::hypot(x - previous_x, y - previous_y) / 2.0;
+        const double sagitta = radius - std::sqrt(std::max(0.0, radius * radius - half_chord * half_chord));
+        if (sagitta > tolerance_)
+        {
+            return std::nullopt;
+        }
+        sweep += std::abs(std::atan2(cross, dot));
+        previous_x = x;
+        previous_y = y;
+    }
+    constexpr double max_sweep = 2.0 * std::numbers::pi - 0.1; // A full circle would end where it starts, which doesn't define an arc.
+    if (sweep > max_sweep)
+    {
+        return std::nullopt;
+    }
+
+    const Point2LL center = origin + Point2LL(std::llrint(center_x), std::llrint(center_y));
+    return Arc{ .first_point_idx = first, .last_point_idx = last - 1, .center = center, .counter_clockwise = counter_clockwise };
+}
+
+} // namespace cura
@@ -0,0 +1,257 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/CompressingStreamBuf.h"
+
+#include <array>
+
+#include <spdlog/spdlog.h>
+#include <zlib.h>
+#ifdef ZSTD_COMPRESSION
+#include <zstd.h>
+#endif
+
+namespace cura
+{
+
+namespace
+{
+
+//! Room for the compressed data of a single call, before it's written to the target.
+constexpr size_t output_buffer_size = 1 << 16;
+
+class GzipCompressor : public CompressingStreamBuf::Compressor
+{
+public:
+    GzipCompressor()
+    {
+        constexpr int window_bits = 15 + 16; // The largest window, with a gzip header instead of a zlib header.
+        constexpr int memory_level = 8;
+        if (deflateInit2(&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, memory_level, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            spdlog::error("Couldn't start gzip compression.");
+        }
+    }
+
+    ~GzipCompressor() override
+    {
+        deflateEnd(&stream_);
+    }
+
+    void compress(const std::string_view data, const bool finish, std::ostream& target) override
+    {
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream_.avail_in = static_cast<uInt>(data.size());
+        int result;
+        do
+        {
+            stream_.next_out = reinterpret_cast<Bytef*>(output_.data());
+            stream_.avail_out = static_cast<uInt>(output_.size());
+            result = deflate(&stream_, finish ? Z_FINISH : Z_NO_FLUSH);
+            if (result == Z_STREAM_ERROR)
+            {
+                spdlog::error("Error while compressing with gzip.");
+                return;
+            }
+            target.write(output_.data(), output_.size() - stream_.avail_out);
+        } while (stream_.avail_out == 0 || (finish && result != Z_STREAM_END));
+    }
+
+private:
+    z_stream stream_{};
+    std::array<char, output_buffer_size> output_;
+};
+
+#ifdef ZSTD_COMPRESSION
+class ZstdCompressor : public CompressingStreamBuf::Compressor
+{
+public:
+    ZstdCompressor()
+        : context_(ZSTD_createCCtx())
+    {
+        ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+        ZSTD_CCtx_setParameter(context_, ZSTD_c_checksumFlag, 1);
+    }
+
+    ~ZstdCompressor() override
+    {
+        ZSTD_freeCCtx(context_);
+    }
+
+    void compress(const std::string_view data, const bool finish, std::ostream& target) override
+    {
+        ZSTD_inBuffer input{ data.data(), data.size(), 0 };
+        size_t remaining;
+        do
+        {
+            ZSTD_outBuffer output{ output_.data(), output_.size(), 0 };
+            remaining = ZSTD_compressStream2(context_, &output, &input, finish ? ZSTD_e_end : ZSTD_e_continue);
+            if (ZSTD_isError(remaining))
+            {
+                spdlog::error("Error while compressing with zstd: {}", ZSTD_getErrorName(remaining));
+                return;
+            }
+            target.write(output_.data(), output.pos);
+        } while (finish ? remaining != 0 : input.pos < input.size);
+    }
+
+private:
+    ZSTD_CCtx* context_;
+    std::array<char, output_buffer_size> output_;
+};
+#endif
+
+} // namespace
+
+std::optional<CompressingStreamBuf::Format> CompressingStreamBuf::formatFromFileName(const std::string_view file_name)
+{
+    if (file_name.ends_with(".gz"))
+    {
+        return Format::GZIP;
+    }
+    if (file_name.ends_with(".zst"))
+    {
+#ifdef ZSTD_COMPRESSION
+        return Format::ZSTD;
+#else
+        spdlog::warn("CuraEngine was built without zstd, so {} is written uncompressed.", file_name);
+#endif
+    }
+    return std::nullopt;
+}
+
+std::unique_ptr<CompressingStreamBuf::Compressor> CompressingStreamBuf::makeCompressor(const Format format)
+{
+    switch (format)
+    {
+    case Format::GZIP:
+        return std::make_unique<GzipCompressor>();
+    case Format::ZSTD:
+#ifdef ZSTD_COMPRESSION
+        return std::make_unique<ZstdCompressor>();
+#else
+        spdlog::error("CuraEngine was built without zstd compression.");
+        return nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+CompressingStreamBuf::CompressingStreamBuf(std::ostream& target, const Format format)
+    : target_(target)
+    , compressor_(makeCompressor(format))
+    , put_area_(chunk_size)
+{
+    setp(put_area_.data(), put_area_.data() + put_area_.size());
+    worker_ = std::thread(&CompressingStreamBuf::compressChunks, this);
+}
+
+CompressingStreamBuf::~CompressingStreamBuf()
+{
+    close();
+}
+
+void CompressingStreamBuf::close()
+{
+    if (closed_)
+    {
+        return;
+    }
+    submitChunk();
+    setp(nullptr, nullptr); // So that anything written after closing goes to overflow, which refuses it.
+    {
+        std::lock_guard lock(mutex_);
+        closing_ = true;
+    }
+    condition_.notify_all();
+    worker_.join();
+    target_.flush();
+    closed_ = true;
+}
+
+CompressingStreamBuf::int_type CompressingStreamBuf::overflow(int_type character)
+{
+    if (closing_)
+    {
+        // The background thread is gone, so nothing would ever make room for the data.
+        return traits_type::eof();
+    }
+    submitChunk();
+    if (traits_type::eq_int_type(character, traits_type::eof()))
+    {
+        return traits_type::not_eof(character);
+    }
+    *pptr() = traits_type::to_char_type(character);
+    pbump(1);
+    return character;
+}
+
+void CompressingStreamBuf::submitChunk()
+{
+    if (pptr() == pbase())
+    {
+        return;
+    }
+    put_area_.resize(pptr() - pbase());
+    {
+        std::unique_lock lock(mutex_);
+        condition_.wait(
+            lock,
+            [this]()
+            {
+                return pending_chunks_.size() < max_pending_chunks;
+            });
+        pending_chunks_.push_back(std::move(put_area_));
+        if (spare_chunks_.empty())
+        {
+            put_area_ = std::vector<char>();
+        }
+        else
+        {
+            put_area_ = std::move(spare_chunks_.back());
+            spare_chunks_.pop_back();
+        }
+    }
+    condition_.notify_all();
+    put_area_.resize(chunk_size);
+    setp(put_area_.data(), put_area_.data() + put_area_.size());
+}
+
+void CompressingStreamBuf::compressChunks()
+{
+    while (true)
+    {
+        std::vector<char> chunk;
+        bool finish;
+        {
+            std::unique_lock lock(mutex_);
+            condition_.wait(
+                lock,
+                [this]()
+                {
+                    return ! pending_chunks_.empty() || closing_;
+                });
+            if (! pending_chunks_.empty())
+            {
+                chunk = std::move(pending_chunks_.front());
+                pending_chunks_.pop_front();
+            }
+            finish = closing_ && pending_chunks_.empty();
+        }
+        condition_.notify_all(); // There is room for another chunk now.
+
+        if (compressor_)
+        {
+            compressor_->compress(std::string_view(chunk.data(), chunk.size()), finish, target_);
+        }
+
+        if (finish)
+        {
+            return;
+        }
+        std::lock_guard lock(mutex_);
+        spare_chunks_.push_back(std::move(chunk));
+    }
+}
+
+} // namespace cura
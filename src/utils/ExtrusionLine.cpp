@@ -7,6 +7,7 @@
 
 #include "utils/Simplify.h"
 #include "utils/linearAlg2D.h"
+#include "utils/polygonUtils.h"
 
 namespace cura
 {
@@ -44,6 +45,47 @@ coord_t ExtrusionLine::getMinimalWidth() const
         ->w_;
 }
 
+bool ExtrusionLine::inside(const Point2LL& p, const bool border_result) const
+{
+    // The crossing test of ClipperLib::PointInPolygon, which Shape::inside uses, so that both agree on every point.
+    if (junctions_.size() < 3)
+    {
+        return false;
+    }
+    bool result = false;
+    Point2LL previous = junctions_.back().p_;
+    for (const ExtrusionJunction& junction : junctions_)
+    {
+        const Point2LL& next = junction.p_;
+        if (next.Y == p.Y && (next.X == p.X || (previous.Y == p.Y && ((next.X > p.X) == (previous.X < p.X)))))
+        {
+            return border_result;
+        }
+        if ((previous.Y < p.Y) != (next.Y < p.Y))
+        {
+            if (previous.X >= p.X && next.X > p.X)
+            {
+                result = ! result;
+            }
+            else if (previous.X >= p.X || next.X > p.X)
+            {
+                const double cross = static_cast<double>(previous.X - p.X) * static_cast<double>(next.Y - p.Y)
+                                   - static_cast<double>(next.X - p.X) * static_cast<double>(previous.Y - p.Y);
+                if (cross == 0)
+                {
+                    return border_result;
+                }
+                if ((cross > 0) == (next.Y > previous.Y))
+                {
+                    result = ! result;
+                }
+            }
+        }
+        previous = next;
+    }
+    return result;
+}
+
 bool ExtrusionLine::shorterThan(const coord_t check_length) const
 {
     const ExtrusionJunction* p0 = &back();
@@ -60,4 +102,14 @@ bool ExtrusionLine::shorterThan(const coord_t check_length) const
     return true;
 }
 
+void ExtrusionLine::computeCornerAngles()
+{
+    if (! is_closed_ || junctions_.empty())
+    {
+        corner_angles_.clear();
+        return;
+    }
+    corner_angles_ = PolygonUtils::cornerAngles(toPolygon());
+}
+
 } // namespace cura
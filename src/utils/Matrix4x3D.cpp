@@ -3,6 +3,8 @@
 
 #include "utils/Matrix4x3D.h" //The definitions we're implementing.
 
+#include <algorithm>
+
 #include "geometry/Point2LL.h" //Conversion directly into integer-based coordinates.
 #include "settings/types/Ratio.h" //Scale factor.
 #include "utils/Point3D.h" //This matrix gets applied to floating point coordinates.
@@ -62,4 +64,52 @@ Point3LL Matrix4x3D::apply(const Point3LL& p) const
         m[0][2] * p.x_ + m[1][2] * p.y_ + m[2][2] * p.z_ + m[3][2]);
 }
 
+void Matrix4x3D::applyXY(std::span<Point2LL> points, const double z) const
+{
+    // Same order of operations as apply(const Point3D&), so that the results are identical.
+    const double z_x = z * m[2][0];
+    const double z_y = z * m[2][1];
+
+    // Structure-of-arrays copies of a block of points, so that the arithmetic works on contiguous doubles.
+    constexpr size_t block_size = 256;
+    double xs[block_size];
+    double ys[block_size];
+    for (size_t block_start = 0; block_start < points.size(); block_start += block_size)
+    {
+        const size_t count = std::min(block_size, points.size() - block_start);
+        Point2LL* block = points.data() + block_start;
+        for (size_t i = 0; i < count; i++)
+        {
+            xs[i] = INT2MM(block[i].X);
+            ys[i] = INT2MM(block[i].Y);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            const double x = xs[i] * m[0][0] + ys[i] * m[1][0] + z_x + m[3][0];
+            const double y = xs[i] * m[0][1] + ys[i] * m[1][1] + z_y + m[3][1];
+            xs[i] = x;
+            ys[i] = y;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            block[i].X = MM2INT(xs[i]);
+            block[i].Y = MM2INT(ys[i]);
+        }
+    }
+}
+
+Matrix4x3D Matrix4x3D::compose(const Matrix4x3D& other) const
+{
+    Matrix4x3D result;
+    for (size_t row = 0; row < 3; row++)
+    {
+        for (size_t column = 0; column < 4; column++)
+        {
+            result.m[column][row] = m[0][row] * other.m[column][0] + m[1][row] * other.m[column][1] + m[2][row] * other.m[column][2];
+        }
+        result.m[3][row] += m[3][row];
+    }
+    return result;
+}
+
 } // namespace cura
@@ -3,6 +3,11 @@
 
 #include "utils/PolylineStitcher.h"
 
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <vector>
+
 #include "geometry/ClosedLinesSet.h"
 #include "geometry/OpenLinesSet.h"
 #include "geometry/OpenPolyline.h"
@@ -75,23 +80,174 @@ bool PolylineStitcher<OpenLinesSet, ClosedLinesSet, OpenPolyline, Point2LL>::isO
 }
 
 template<>
-void ExtrusionLineStitcher::pushToClosedResult(VariableWidthLines& result_polygons, const ExtrusionLine& polyline)
+void ExtrusionLineStitcher::pushToClosedResult(VariableWidthLines& result_polygons, ExtrusionLine&& polyline)
 {
-    result_polygons.push_back(polyline);
+    result_polygons.push_back(std::move(polyline));
 }
 
 template<>
-void OpenPolylineStitcher::pushToClosedResult(Shape& result_polygons, const OpenPolyline& polyline)
+void OpenPolylineStitcher::pushToClosedResult(Shape& result_polygons, OpenPolyline&& polyline)
 {
-    result_polygons.emplace_back(polyline.getPoints(), true);
+    result_polygons.emplace_back(std::move(polyline.getPoints()), true);
 }
 
 template<>
-void PolylineStitcher<OpenLinesSet, ClosedLinesSet, OpenPolyline, Point2LL>::pushToClosedResult(ClosedLinesSet& result_polygons, const OpenPolyline& polyline)
+void PolylineStitcher<OpenLinesSet, ClosedLinesSet, OpenPolyline, Point2LL>::pushToClosedResult(ClosedLinesSet& result_polygons, OpenPolyline&& polyline)
 {
-    result_polygons.emplace_back(polyline.getPoints(), true);
+    result_polygons.emplace_back(std::move(polyline.getPoints()), true);
 }
 
+namespace
+{
+
+/*!
+ * The ends of the lines to stitch, by the cell of a square grid that they are in.
+ *
+ * The cells are found in an open addressing hash table, and the ends in each cell are stored next to each other in the order in which
+ * they were added. Looking around a point then only reads a few short ranges of memory, instead of following the nodes of the hash map
+ * of a SparsePointGrid. The ends are never removed, the stitcher skips the lines that it already used instead.
+ */
+template<typename Index>
+class EndpointGrid
+{
+public:
+    //! Forget the ends of the previous stitch, but keep the memory for the next one.
+    void reset(const coord_t cell_size)
+    {
+        cell_size_ = std::max(cell_size, coord_t(1));
+        added_.clear();
+    }
+
+    void add(const Index& index)
+    {
+        added_.push_back(Endpoint{ .location = index.p(), .index = index });
+    }
+
+    //! Sort the ends that were added into their cells. This has to be done before looking for any.
+    void build()
+    {
+        const size_t capacity = std::bit_ceil(std::max(added_.size() * 2, size_t(16)));
+        cells_.assign(capacity, Cell{});
+        mask_ = capacity - 1;
+
+        cell_of_added_.resize(added_.size());
+        for (size_t added_idx = 0; added_idx < added_.size(); added_idx++)
+        {
+            const size_t cell_idx = findOrInsert(toGridCoord(added_[added_idx].location.X), toGridCoord(added_[added_idx].location.Y));
+            cell_of_added_[added_idx] = cell_idx;
+            cells_[cell_idx].count++;
+        }
+        size_t begin = 0;
+        for (Cell& cell : cells_)
+        {
+            cell.begin = begin;
+            begin += cell.count;
+            cell.count = 0; // Counted again while placing the ends.
+        }
+        endpoints_.resize(added_.size());
+        for (size_t added_idx = 0; added_idx < added_.size(); added_idx++)
+        {
+            Cell& cell = cells_[cell_of_added_[added_idx]];
+            endpoints_[cell.begin + cell.count] = added_[added_idx];
+            cell.count++;
+        }
+    }
+
+    /*!
+     * Process the ends in the cells that are within \p radius of \p query, until \p process returns false.
+     *
+     * Like SparsePointGrid::processNearby, this may also process ends that are further away than \p radius.
+     * \param process Called with the location of each end and its index.
+     */
+    template<typename ProcessFunc>
+    void processNearby(const Point2LL& query, const coord_t radius, ProcessFunc&& process) const
+    {
+        const coord_t min_x = toGridCoord(query.X - radius);
+        const coord_t max_x = toGridCoord(query.X + radius);
+        const coord_t min_y = toGridCoord(query.Y - radius);
+        const coord_t max_y = toGridCoord(query.Y + radius);
+        for (coord_t x = min_x; x <= max_x; x++)
+        {
+            for (coord_t y = min_y; y <= max_y; y++)
+            {
+                const Cell* cell = find(x, y);
+                if (cell == nullptr)
+                {
+                    continue;
+                }
+                for (size_t endpoint_idx = cell->begin; endpoint_idx < cell->begin + cell->count; endpoint_idx++)
+                {
+                    if (! process(endpoints_[endpoint_idx].location, endpoints_[endpoint_idx].index))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    struct Endpoint
+    {
+        Point2LL location;
+        Index index;
+    };
+
+    struct Cell
+    {
+        coord_t x = 0;
+        coord_t y = 0;
+        size_t begin = 0; //!< Where the ends in this cell start in \ref endpoints_.
+        size_t count = 0; //!< How many ends are in this cell. The slots of the table that aren't used have none.
+    };
+
+    coord_t cell_size_ = 1;
+    size_t mask_ = 0; //!< The number of slots in the table minus one. The number of slots is a power of two.
+    std::vector<Cell> cells_; //!< The hash table.
+    std::vector<Endpoint> endpoints_; //!< The ends, grouped by cell.
+    std::vector<Endpoint> added_; //!< The ends in the order in which they were added.
+    std::vector<size_t> cell_of_added_; //!< For each of the added ends, the slot of its cell in the table.
+
+    //! Same mapping as the SquareGrid, which truncates towards zero.
+    coord_t toGridCoord(const coord_t coord) const
+    {
+        return coord / cell_size_;
+    }
+
+    size_t slotOf(const coord_t x, const coord_t y) const
+    {
+        uint64_t hash = static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t>(y) * 0xC2B2AE3D27D4EB4FULL;
+        hash ^= hash >> 32;
+        return static_cast<size_t>(hash) & mask_;
+    }
+
+    size_t findOrInsert(const coord_t x, const coord_t y)
+    {
+        size_t slot = slotOf(x, y);
+        while (cells_[slot].count != 0 && (cells_[slot].x != x || cells_[slot].y != y))
+        {
+            slot = (slot + 1) & mask_;
+        }
+        cells_[slot].x = x;
+        cells_[slot].y = y;
+        return slot;
+    }
+
+    const Cell* find(const coord_t x, const coord_t y) const
+    {
+        for (size_t slot = slotOf(x, y); cells_[slot].count != 0; slot = (slot + 1) & mask_)
+        {
+            if (cells_[slot].x == x && cells_[slot].y == y)
+            {
+                return &cells_[slot];
+            }
+        }
+        return nullptr;
+    }
+};
+
+} // namespace
+
 template<typename InputPaths, typename OutputPaths, typename Path, typename Junction>
 void PolylineStitcher<InputPaths, OutputPaths, Path, Junction>::stitch(
     const InputPaths& lines,
@@ -105,17 +261,22 @@ void PolylineStitcher<InputPaths, OutputPaths, Path, Junction>::stitch(
         return;
     }
 
-    SparsePointGrid<PathsPointIndex<InputPaths>, PathsPointIndexLocator<InputPaths>> grid(max_stitch_distance, lines.size() * 2);
+    // The walls of every layer are stitched, so keep the memory around for the next time this thread stitches.
+    thread_local EndpointGrid<PathsPointIndex<InputPaths>> grid;
+    thread_local std::vector<bool> processed;
+    thread_local std::vector<Junction> reverse_extension;
 
     // populate grid
+    grid.reset(max_stitch_distance);
     for (size_t line_idx = 0; line_idx < lines.size(); line_idx++)
     {
-        const auto line = lines[line_idx];
-        grid.insert(PathsPointIndex<InputPaths>(&lines, line_idx, 0));
-        grid.insert(PathsPointIndex<InputPaths>(&lines, line_idx, line.size() - 1));
+        const auto& line = lines[line_idx];
+        grid.add(PathsPointIndex<InputPaths>(&lines, line_idx, 0));
+        grid.add(PathsPointIndex<InputPaths>(&lines, line_idx, line.size() - 1));
     }
+    grid.build();
 
-    std::vector<bool> processed(lines.size(), false);
+    processed.assign(lines.size(), false);
 
     for (size_t line_idx = 0; line_idx < lines.size(); line_idx++)
     {
@@ -124,93 +285,95 @@ void PolylineStitcher<InputPaths, OutputPaths, Path, Junction>::stitch(
             continue;
         }
         processed[line_idx] = true;
-        const auto line = lines[line_idx];
+        const auto& line = lines[line_idx];
         bool should_close = isOdd(line);
 
+        // The chain keeps the direction of the line. When extending it in the reverse direction, the chain isn't reversed, but what is
+        // added to its start is collected in reverse_extension, in the order in which it is added. The two are joined at the end.
         Path chain = line;
+        reverse_extension.clear();
         bool closest_is_closing_polygon = false;
-        for (bool go_in_reverse_direction : { false, true }) // first go in the unreversed direction, to try to prevent the chain.reverse() operation.
+        for (bool go_in_reverse_direction : { false, true }) // first go in the unreversed direction, to try to prevent reversing the chain.
         { // NOTE: Implementation only works for this order; we currently only re-reverse the chain when it's closed.
-            if (go_in_reverse_direction)
-            { // try extending chain in the other direction
-                chain.reverse();
-            }
             coord_t chain_length = chain.length();
 
             while (true)
             {
-                Point2LL from = make_point(chain.back());
+                // The end that is extended and the other end, in the direction that we're going.
+                const Point2LL from = go_in_reverse_direction ? (reverse_extension.empty() ? make_point(chain.front()) : make_point(reverse_extension.back())) : make_point(chain.back());
+                const Point2LL chain_start = go_in_reverse_direction ? make_point(chain.back()) : make_point(chain.front());
+                const size_t chain_size = chain.size() + reverse_extension.size();
 
                 PathsPointIndex<InputPaths> closest;
                 coord_t closest_distance = std::numeric_limits<coord_t>::max();
                 grid.processNearby(
                     from,
                     max_stitch_distance,
-                    std::function<bool(const PathsPointIndex<InputPaths>&)>(
-                        [from,
-                         &chain,
-                         &closest,
-                         &closest_is_closing_polygon,
-                         &closest_distance,
-                         &processed,
-                         &chain_length,
-                         go_in_reverse_direction,
-                         max_stitch_distance,
-                         snap_distance,
-                         should_close](const PathsPointIndex<InputPaths>& nearby) -> bool
+                    [from,
+                     chain_start,
+                     chain_size,
+                     &chain,
+                     &closest,
+                     &closest_is_closing_polygon,
+                     &closest_distance,
+                     &chain_length,
+                     go_in_reverse_direction,
+                     max_stitch_distance,
+                     snap_distance,
+                     should_close](const Point2LL& nearby_location, const PathsPointIndex<InputPaths>& nearby) -> bool
+                    {
+                        bool is_closing_segment = false;
+                        coord_t dist = vSize(nearby_location - from);
+                        if (dist > max_stitch_distance)
                         {
-                            bool is_closing_segment = false;
-                            coord_t dist = vSize(nearby.p() - from);
-                            if (dist > max_stitch_distance)
-                            {
-                                return true; // keep looking
-                            }
-                            if (vSize2(nearby.p() - make_point(chain.front())) < snap_distance * snap_distance)
+                            return true; // keep looking
+                        }
+                        if (vSize2(nearby_location - chain_start) < snap_distance * snap_distance)
+                        {
+                            if (chain_length + dist < 3 * max_stitch_distance // prevent closing of small poly, cause it might be able to continue making a larger polyline
+                                || chain_size <= 2) // don't make 2 vert polygons
                             {
-                                if (chain_length + dist < 3 * max_stitch_distance // prevent closing of small poly, cause it might be able to continue making a larger polyline
-                                    || chain.size() <= 2) // don't make 2 vert polygons
-                                {
-                                    return true; // look for a better next line
-                                }
-                                is_closing_segment = true;
-                                if (! should_close)
-                                {
-                                    dist += 10; // prefer continuing polyline over closing a polygon; avoids closed zigzags from being printed separately
-                                    // continue to see if closing segment is also the closest
-                                    // there might be a segment smaller than [max_stitch_distance] which closes the polygon better
-                                }
-                                else
-                                {
-                                    dist -= 10; // Prefer closing the polygon if it's 100% even lines. Used to create closed contours.
-                                    // Continue to see if closing segment is also the closest.
-                                }
-                            }
-                            else if (processed[nearby.poly_idx_])
-                            { // it was already moved to output
-                                return true; // keep looking for a connection
-                            }
-                            bool nearby_would_be_reversed = nearby.point_idx_ != 0;
-                            nearby_would_be_reversed = nearby_would_be_reversed != go_in_reverse_direction; // flip nearby_would_be_reversed when searching in the reverse direction
-                            if (! canReverse(nearby) && nearby_would_be_reversed)
-                            { // connecting the segment would reverse the polygon direction
-                                return true; // keep looking for a connection
+                                return true; // look for a better next line
                             }
-                            if (! canConnect(chain, (*nearby.polygons_)[nearby.poly_idx_]))
+                            is_closing_segment = true;
+                            if (! should_close)
                             {
-                                return true; // keep looking for a connection
+                                dist += 10; // prefer continuing polyline over closing a polygon; avoids closed zigzags from being printed separately
+                                // continue to see if closing segment is also the closest
+                                // there might be a segment smaller than [max_stitch_distance] which closes the polygon better
                             }
-                            if (dist < closest_distance)
+                            else
                             {
-                                closest_distance = dist;
-                                closest = nearby;
-                                closest_is_closing_polygon = is_closing_segment;
+                                dist -= 10; // Prefer closing the polygon if it's 100% even lines. Used to create closed contours.
+                                // Continue to see if closing segment is also the closest.
                             }
-                            if (dist < snap_distance)
-                            { // we have found a good enough next line
-                                return false; // stop looking for alternatives
-                            }
-                            return true; // keep processing elements
-                        }));
+                        }
+                        else if (processed[nearby.poly_idx_])
+                        { // it was already moved to output
+                            return true; // keep looking for a connection
+                        }
+                        bool nearby_would_be_reversed = nearby.point_idx_ != 0;
+                        nearby_would_be_reversed = nearby_would_be_reversed != go_in_reverse_direction; // flip nearby_would_be_reversed when searching in the reverse direction
+                        if (! canReverse(nearby) && nearby_would_be_reversed)
+                        { // connecting the segment would reverse the polygon direction
+                            return true; // keep looking for a connection
+                        }
+                        if (! canConnect(chain, (*nearby.polygons_)[nearby.poly_idx_]))
+                        {
+                            return true; // keep looking for a connection
+                        }
+                        if (dist < closest_distance)
+                        {
+                            closest_distance = dist;
+                            closest = nearby;
+                            closest_is_closing_polygon = is_closing_segment;
+                        }
+                        if (dist < snap_distance)
+                        { // we have found a good enough next line
+                            return false; // stop looking for alternatives
+                        }
+                        return true; // keep processing elements
+                    });
 
                 if (! closest.initialized() // we couldn't find any next line
                     || closest_is_closing_polygon // we closed the polygon
@@ -220,32 +383,46 @@ void PolylineStitcher<InputPaths, OutputPaths, Path, Junction>::stitch(
                 }
 
 
-                coord_t segment_dist = vSize(make_point(chain.back()) - closest.p());
+                const Path& closest_line = (*closest.polygons_)[closest.poly_idx_];
+                coord_t segment_dist = vSize(from - closest.p());
                 assert(segment_dist <= max_stitch_distance + 10);
-                const size_t old_size = chain.size();
-                if (closest.point_idx_ == 0)
+                const auto append = [&closest, &closest_line, segment_dist, snap_distance, &chain_length, from](auto& extended)
                 {
-                    auto start_pos = (*closest.polygons_)[closest.poly_idx_].begin();
-                    if (segment_dist < snap_distance)
+                    const size_t old_size = extended.size();
+                    if (closest.point_idx_ == 0)
                     {
-                        ++start_pos;
+                        auto start_pos = closest_line.begin();
+                        if (segment_dist < snap_distance)
+                        {
+                            ++start_pos;
+                        }
+                        extended.insert(extended.end(), start_pos, closest_line.end());
                     }
-                    chain.insert(chain.end(), start_pos, (*closest.polygons_)[closest.poly_idx_].end());
-                }
-                else
-                {
-                    auto start_pos = (*closest.polygons_)[closest.poly_idx_].rbegin();
-                    if (segment_dist < snap_distance)
+                    else
+                    {
+                        auto start_pos = closest_line.rbegin();
+                        if (segment_dist < snap_distance)
+                        {
+                            ++start_pos;
+                        }
+                        extended.insert(extended.end(), start_pos, closest_line.rend());
+                    }
+                    Point2LL previous = from;
+                    for (size_t i = old_size; i < extended.size(); ++i) // Update chain length.
                     {
-                        ++start_pos;
+                        chain_length += vSize(make_point(extended[i]) - previous);
+                        previous = make_point(extended[i]);
                     }
-                    chain.insert(chain.end(), start_pos, (*closest.polygons_)[closest.poly_idx_].rend());
+                };
+                if (go_in_reverse_direction)
+                {
+                    append(reverse_extension);
                 }
-                for (size_t i = old_size; i < chain.size(); ++i) // Update chain length.
+                else
                 {
-                    chain_length += vSize(chain[i] - chain[i - 1]);
+                    append(chain);
                 }
-                should_close = should_close & ! isOdd((*closest.polygons_)[closest.poly_idx_]); // If we connect an even to an odd line, we should no longer try to close it.
+                should_close = should_close & ! isOdd(closest_line); // If we connect an even to an odd line, we should no longer try to close it.
                 assert(! processed[closest.poly_idx_]);
                 processed[closest.poly_idx_] = true;
             }
@@ -253,9 +430,9 @@ void PolylineStitcher<InputPaths, OutputPaths, Path, Junction>::stitch(
             if (closest_is_closing_polygon)
             {
                 if (go_in_reverse_direction)
-                { // re-reverse chain to retain original direction
+                { // join the extension in the original direction
                     // NOTE: not sure if this code could ever be reached, since if a polygon can be closed that should be already possible in the forward direction
-                    chain.reverse();
+                    chain.insert(chain.begin(), reverse_extension.rbegin(), reverse_extension.rend());
                 }
 
                 break; // don't consider reverse direction
@@ -263,17 +440,22 @@ void PolylineStitcher<InputPaths, OutputPaths, Path, Junction>::stitch(
         }
         if (closest_is_closing_polygon)
         {
-            pushToClosedResult(result_polygons, chain);
+            pushToClosedResult(result_polygons, std::move(chain));
         }
         else
         {
             PathsPointIndex<InputPaths> ppi_here(&lines, line_idx, 0);
-            if (! canReverse(ppi_here))
-            { // Since closest_is_closing_polygon is false we went through the second iterations of the for-loop, where go_in_reverse_direction is true
-                // the polyline isn't allowed to be reversed, so we re-reverse it.
+            if (canReverse(ppi_here))
+            { // Since closest_is_closing_polygon is false we went through the second iterations of the for-loop, where go_in_reverse_direction is true.
+                // The result goes in that direction, as if the chain had been reversed before extending it.
                 chain.reverse();
+                chain.insert(chain.end(), reverse_extension.begin(), reverse_extension.end());
+            }
+            else
+            { // the polyline isn't allowed to be reversed, so it keeps its original direction.
+                chain.insert(chain.begin(), reverse_extension.rbegin(), reverse_extension.rend());
             }
-            result_lines.emplace_back(chain);
+            result_lines.emplace_back(std::move(chain));
         }
     }
 }
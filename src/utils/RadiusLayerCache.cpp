@@ -0,0 +1,158 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/RadiusLayerCache.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <spdlog/spdlog.h>
+
+namespace cura
+{
+
+RadiusLayerCache::~RadiusLayerCache()
+{
+    for (const std::unique_ptr<Chunk>& chunk : chunks_)
+    {
+        for (std::atomic<const Shape*>& slot : *chunk)
+        {
+            delete slot.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+RadiusLayerCache::RadiusLayerCache(RadiusLayerCache&& other) noexcept
+    : head_(other.head_.exchange(nullptr))
+    , mutex_(std::move(other.mutex_))
+    , entries_(std::move(other.entries_))
+    , chunks_(std::move(other.chunks_))
+{
+}
+
+RadiusLayerCache& RadiusLayerCache::operator=(RadiusLayerCache&& other) noexcept
+{
+    std::swap(entries_, other.entries_);
+    std::swap(chunks_, other.chunks_); // The old areas are freed when other is destroyed.
+    std::swap(mutex_, other.mutex_);
+    head_.store(other.head_.exchange(head_.load()));
+    return *this;
+}
+
+std::optional<std::reference_wrapper<const Shape>> RadiusLayerCache::get(const coord_t radius, const LayerIndex layer_idx) const
+{
+    if (layer_idx < 0)
+    {
+        return std::nullopt;
+    }
+    const size_t chunk_idx = layer_idx.value / chunk_size;
+    if (chunk_idx >= max_chunks)
+    {
+        return std::nullopt;
+    }
+    const RadiusEntry* entry = findEntry(radius);
+    if (entry == nullptr)
+    {
+        return std::nullopt;
+    }
+    const Chunk* chunk = entry->chunks[chunk_idx].load(std::memory_order_acquire);
+    if (chunk == nullptr)
+    {
+        return std::nullopt;
+    }
+    const Shape* area = (*chunk)[layer_idx.value % chunk_size].load(std::memory_order_acquire);
+    if (area == nullptr)
+    {
+        return std::nullopt;
+    }
+    return std::cref(*area);
+}
+
+LayerIndex RadiusLayerCache::getMaxCalculatedLayer(const coord_t radius) const
+{
+    LayerIndex max_layer = -1;
+    if (contains(radius, 1))
+    {
+        max_layer = 1;
+    }
+    while (contains(radius, max_layer + 1))
+    {
+        max_layer++;
+    }
+    return max_layer;
+}
+
+void RadiusLayerCache::insert(const coord_t radius, const LayerIndex layer_idx, const Shape& area)
+{
+    std::lock_guard lock(*mutex_);
+    insertLocked(radius, layer_idx, area);
+}
+
+const RadiusLayerCache::RadiusEntry* RadiusLayerCache::findEntry(const coord_t radius) const
+{
+    for (const RadiusEntry* entry = head_.load(std::memory_order_acquire); entry != nullptr; entry = entry->next)
+    {
+        if (entry->radius == radius)
+        {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+void RadiusLayerCache::insertLocked(const coord_t radius, const LayerIndex layer_idx, const Shape& area)
+{
+    if (layer_idx < 0)
+    {
+        return;
+    }
+    const size_t chunk_idx = layer_idx.value / chunk_size;
+    if (chunk_idx >= max_chunks)
+    {
+        spdlog::error("Can't cache an area on layer {}, as it is above the highest layer that can be cached.", layer_idx.value);
+        assert(false);
+        return;
+    }
+
+    RadiusEntry* entry = const_cast<RadiusEntry*>(findEntry(radius)); // Only the writer, which holds the lock, modifies entries.
+    if (entry == nullptr)
+    {
+        entry = entries_.emplace_back(std::make_unique<RadiusEntry>()).get();
+        entry->radius = radius;
+        entry->next = head_.load(std::memory_order_relaxed);
+        head_.store(entry, std::memory_order_release);
+    }
+    Chunk* chunk = entry->chunks[chunk_idx].load(std::memory_order_relaxed);
+    if (chunk == nullptr)
+    {
+        chunk = chunks_.emplace_back(std::make_unique<Chunk>()).get();
+        entry->chunks[chunk_idx].store(chunk, std::memory_order_release);
+    }
+    std::atomic<const Shape*>& slot = (*chunk)[layer_idx.value % chunk_size];
+    if (slot.load(std::memory_order_relaxed) != nullptr)
+    {
+        return; // Keep the area that was there first, so that references to it stay valid.
+    }
+    slot.store(new Shape(area), std::memory_order_release);
+    entry->max_layer = std::max(entry->max_layer, layer_idx);
+}
+
+void RadiusLayerCache::evictAbove(const LayerIndex layer_idx)
+{
+    std::lock_guard lock(*mutex_);
+    const LayerIndex first_evicted = std::max(LayerIndex(layer_idx + 1), LayerIndex(0));
+    for (const std::unique_ptr<RadiusEntry>& entry : entries_)
+    {
+        for (LayerIndex evicted = first_evicted; evicted <= entry->max_layer; evicted++)
+        {
+            Chunk* chunk = entry->chunks[evicted.value / chunk_size].load(std::memory_order_relaxed);
+            if (chunk != nullptr)
+            {
+                delete (*chunk)[evicted.value % chunk_size].exchange(nullptr, std::memory_order_acq_rel);
+            }
+        }
+        entry->max_layer = std::min(entry->max_layer, layer_idx);
+    }
+}
+
+} // namespace cura
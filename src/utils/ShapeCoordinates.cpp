@@ -0,0 +1,278 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/ShapeCoordinates.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "geometry/Polygon.h"
+#include "geometry/Shape.h"
+#include "utils/linearAlg2D.h"
+
+namespace cura
+{
+
+namespace
+{
+
+struct CrossingCounts
+{
+    size_t crossings_ = 0;
+    size_t border_hits_ = 0;
+};
+
+/*!
+ * Count the edges (x0, y0) - (x1, y1) that a ray from a point towards positive
+ * X crosses, and the ones that the point is on.
+ *
+ * This is the same test as ClipperLib::PointInPolygon, but without early
+ * returns or branches, so that the edges can be tested in parallel.
+ */
+CrossingCounts countCrossings(const double* x0, const double* y0, const double* x1, const double* y1, const size_t count, const double p_x, const double p_y)
+{
+    size_t crossings = 0;
+    size_t border_hits = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const bool on_vertex_or_horizontal = (y1[i] == p_y) & ((x1[i] == p_x) | ((y0[i] == p_y) & ((x1[i] > p_x) == (x0[i] < p_x))));
+        const bool straddles = (y0[i] < p_y) != (y1[i] < p_y);
+        const double cross = (x0[i] - p_x) * (y1[i] - p_y) - (x1[i] - p_x) * (y0[i] - p_y);
+        border_hits += on_vertex_or_horizontal | (straddles & (cross == 0.0));
+        crossings += straddles & ((cross > 0.0) == (y1[i] > y0[i]));
+    }
+    return CrossingCounts{ .crossings_ = crossings, .border_hits_ = border_hits };
+}
+
+} // namespace
+
+ShapeCoordinates::ShapeCoordinates(const Shape& shape, bool index_edges)
+    : shape_(shape)
+{
+    size_t point_count = 0;
+    for (const Polygon& polygon : shape)
+    {
+        point_count += polygon.empty() ? 0 : polygon.size() + 1;
+    }
+    x_.reserve(point_count);
+    y_.reserve(point_count);
+    path_starts_.reserve(shape.size() + 1);
+    for (const Polygon& polygon : shape)
+    {
+        path_starts_.push_back(x_.size());
+        if (polygon.empty())
+        {
+            continue;
+        }
+        for (const Point2LL& point : polygon)
+        {
+            x_.push_back(static_cast<double>(point.X));
+            y_.push_back(static_cast<double>(point.Y));
+        }
+        x_.push_back(static_cast<double>(polygon.front().X));
+        y_.push_back(static_cast<double>(polygon.front().Y));
+    }
+    path_starts_.push_back(x_.size());
+
+    if (index_edges)
+    {
+        indexEdges();
+    }
+}
+
+void ShapeCoordinates::indexEdges()
+{
+    size_t edge_count = 0;
+    double min_y = std::numeric_limits<double>::infinity();
+    double max_y = -std::numeric_limits<double>::infinity();
+    for (size_t path_idx = 0; path_idx + 1 < path_starts_.size(); path_idx++)
+    {
+        const size_t start = path_starts_[path_idx];
+        const size_t end = path_starts_[path_idx + 1];
+        if (end - start < 4) // Lines and points contain nothing, so they don't need to be tested.
+        {
+            continue;
+        }
+        edge_count += end - start - 1;
+        const auto [path_min_y, path_max_y] = std::minmax_element(y_.begin() + start, y_.begin() + end);
+        min_y = std::min(min_y, *path_min_y);
+        max_y = std::max(max_y, *path_max_y);
+    }
+    if (edge_count < min_indexed_edges || max_y <= min_y)
+    {
+        return;
+    }
+
+    // With about as many bands as there are edges in each band, most tests go over a small fraction of the edges.
+    const size_t band_count = static_cast<size_t>(std::sqrt(static_cast<double>(edge_count)));
+    bands_.resize(band_count);
+    bands_min_y_ = min_y;
+    bands_max_y_ = max_y;
+    band_height_ = (max_y - min_y) / static_cast<double>(band_count);
+    const auto band_of = [this, band_count](const double y)
+    {
+        return std::min(static_cast<size_t>((y - bands_min_y_) / band_height_), band_count - 1);
+    };
+    for (size_t path_idx = 0; path_idx + 1 < path_starts_.size(); path_idx++)
+    {
+        const size_t start = path_starts_[path_idx];
+        const size_t end = path_starts_[path_idx + 1];
+        if (end - start < 4)
+        {
+            continue;
+        }
+        for (size_t i = start; i + 1 < end; i++)
+        {
+            const size_t last_band = band_of(std::max(y_[i], y_[i + 1]));
+            for (size_t band_idx = band_of(std::min(y_[i], y_[i + 1])); band_idx <= last_band; band_idx++)
+            {
+                EdgeBand& band = bands_[band_idx];
+                band.x0_.push_back(x_[i]);
+                band.y0_.push_back(y_[i]);
+                band.x1_.push_back(x_[i + 1]);
+                band.y1_.push_back(y_[i + 1]);
+            }
+        }
+    }
+}
+
+AABB ShapeCoordinates::bounds() const
+{
+    if (x_.empty())
+    {
+        return AABB();
+    }
+    const auto [min_x, max_x] = std::minmax_element(x_.begin(), x_.end());
+    const auto [min_y, max_y] = std::minmax_element(y_.begin(), y_.end());
+    return AABB(Point2LL(static_cast<coord_t>(*min_x), static_cast<coord_t>(*min_y)), Point2LL(static_cast<coord_t>(*max_x), static_cast<coord_t>(*max_y)));
+}
+
+double ShapeCoordinates::area() const
+{
+    double total = 0.0;
+    for (size_t path_idx = 0; path_idx + 1 < path_starts_.size(); path_idx++)
+    {
+        const size_t start = path_starts_[path_idx];
+        const size_t end = path_starts_[path_idx + 1];
+        if (end - start < 4) // Like ClipperLib::Area, lines and points have no area.
+        {
+            continue;
+        }
+        double twice_area = 0.0;
+        for (size_t i = start; i + 1 < end; i++)
+        {
+            twice_area += (x_[i] + x_[i + 1]) * (y_[i] - y_[i + 1]);
+        }
+        total += twice_area * 0.5;
+    }
+    return total;
+}
+
+bool ShapeCoordinates::inside(const Point2LL& p, bool border_result) const
+{
+    const double p_x = static_cast<double>(p.X);
+    const double p_y = static_cast<double>(p.Y);
+    CrossingCounts counts;
+    if (! bands_.empty())
+    {
+        // Only the edges at the height of the point can be crossed by the ray or touch the point.
+        if (p_y < bands_min_y_ || p_y > bands_max_y_)
+        {
+            return false;
+        }
+        const EdgeBand& band = bands_[std::min(static_cast<size_t>((p_y - bands_min_y_) / band_height_), bands_.size() - 1)];
+        counts = countCrossings(band.x0_.data(), band.y0_.data(), band.x1_.data(), band.y1_.data(), band.x0_.size(), p_x, p_y);
+    }
+    else
+    {
+        for (size_t path_idx = 0; path_idx + 1 < path_starts_.size(); path_idx++)
+        {
+            const size_t start = path_starts_[path_idx];
+            const size_t end = path_starts_[path_idx + 1];
+            if (end - start < 4) // Like ClipperLib::PointInPolygon, lines and points contain nothing.
+            {
+                continue;
+            }
+            const CrossingCounts path_counts = countCrossings(x_.data() + start, y_.data() + start, x_.data() + start + 1, y_.data() + start + 1, end - start - 1, p_x, p_y);
+            counts.crossings_ += path_counts.crossings_;
+            counts.border_hits_ += path_counts.border_hits_;
+        }
+    }
+    if (counts.border_hits_ > 0)
+    {
+        return border_result;
+    }
+    return counts.crossings_ % 2 == 1;
+}
+
+std::vector<bool> ShapeCoordinates::inside(std::span<const Point2LL> points, bool border_result) const
+{
+    std::vector<bool> result(points.size());
+    for (size_t point_idx = 0; point_idx < points.size(); point_idx++)
+    {
+        result[point_idx] = inside(points[point_idx], border_result);
+    }
+    return result;
+}
+
+ClosestPointPolygon ShapeCoordinates::findClosest(const Point2LL& from) const
+{
+    // The distances are computed for a chunk of segments at a time, then the closest of those is looked up.
+    constexpr size_t chunk_size = 64;
+    std::array<double, chunk_size> distances2;
+    const double from_x = static_cast<double>(from.X);
+    const double from_y = static_cast<double>(from.Y);
+
+    double best_distance2 = std::numeric_limits<double>::infinity();
+    size_t best_path_idx = NO_INDEX;
+    size_t best_point_idx = NO_INDEX;
+    for (size_t path_idx = 0; path_idx + 1 < path_starts_.size(); path_idx++)
+    {
+        const size_t start = path_starts_[path_idx];
+        const size_t end = path_starts_[path_idx + 1];
+        for (size_t chunk_start = start; chunk_start + 1 < end; chunk_start += chunk_size)
+        {
+            const size_t count = std::min(chunk_size, end - 1 - chunk_start);
+            const double* x = x_.data() + chunk_start;
+            const double* y = y_.data() + chunk_start;
+            for (size_t i = 0; i < count; i++)
+            {
+                const double x0 = x[i];
+                const double y0 = y[i];
+                const double dx = x[i + 1] - x0;
+                const double dy = y[i + 1] - y0;
+                const double length2 = dx * dx + dy * dy;
+                const double projected = (from_x - x0) * dx + (from_y - y0) * dy;
+                // Clamp the projection to the segment without branches. Segments of length 0 have a projection of 0, so avoid dividing by 0 for those.
+                const double ratio = projected / (length2 + static_cast<double>(length2 == 0.0));
+                const double t = 0.5 * (std::abs(ratio) - std::abs(ratio - 1.0) + 1.0);
+                const double offset_x = x0 + t * dx - from_x;
+                const double offset_y = y0 + t * dy - from_y;
+                distances2[i] = offset_x * offset_x + offset_y * offset_y;
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                if (distances2[i] < best_distance2)
+                {
+                    best_distance2 = distances2[i];
+                    best_path_idx = path_idx;
+                    best_point_idx = chunk_start + i - start;
+                }
+            }
+        }
+    }
+    if (best_path_idx == NO_INDEX)
+    {
+        return ClosestPointPolygon();
+    }
+
+    // Compute the point itself in integers, like PolygonUtils::findClosest does.
+    const Polygon& polygon = shape_[best_path_idx];
+    const Point2LL& p0 = polygon[best_point_idx];
+    const Point2LL& p1 = polygon[(best_point_idx + 1) % polygon.size()];
+    return ClosestPointPolygon(LinearAlg2D::getClosestOnLineSegment(from, p0, p1), best_point_idx, &polygon, best_path_idx);
+}
+
+} // namespace cura
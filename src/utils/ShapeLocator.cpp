@@ -0,0 +1,82 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/ShapeLocator.h"
+
+#include <optional>
+#include <utility>
+
+#include "geometry/Shape.h"
+
+namespace cura
+{
+
+ShapeLocator::ShapeLocator(const Shape& shape, coord_t cell_size)
+    : shape_(shape)
+    , grid_(PolygonUtils::createLocToLineGrid(shape, cell_size))
+    , coordinates_(shape)
+{
+}
+
+const Shape& ShapeLocator::shape() const
+{
+    return shape_;
+}
+
+const LocToLineGrid& ShapeLocator::grid() const
+{
+    return *grid_;
+}
+
+LocToLineGrid& ShapeLocator::grid()
+{
+    return *grid_;
+}
+
+ClosestPointPolygon ShapeLocator::findClosest(const Point2LL& from) const
+{
+    // Every segment within a cell size of the point is in the cells that are searched, so if the closest one found there is that close, no other segment is closer.
+    const coord_t cell_size = grid_->getCellSize();
+    const std::optional<ClosestPointPolygon> close = PolygonUtils::findClose(from, shape_, *grid_);
+    if (close && vSize2(close->location_ - from) <= cell_size * cell_size)
+    {
+        return *close;
+    }
+    return coordinates_.findClosest(from);
+}
+
+PolygonsPointIndex ShapeLocator::findNearestVert(const Point2LL& from) const
+{
+    // Every vertex starts a segment, so the vertices within a cell size of the point are all in the cells that are searched.
+    const coord_t cell_size = grid_->getCellSize();
+    coord_t best_dist2 = cell_size * cell_size + 1;
+    std::optional<PolygonsPointIndex> closest_vert;
+    for (const PolygonsPointIndex& segment : grid_->getNearby(from, cell_size))
+    {
+        // Of equally close vertices, take the first one of the shape, like PolygonUtils::findNearestVert does.
+        const coord_t dist2 = vSize2(segment.p() - from);
+        if (dist2 < best_dist2 || (dist2 == best_dist2 && closest_vert && std::make_pair(segment.poly_idx_, segment.point_idx_) < std::make_pair(closest_vert->poly_idx_, closest_vert->point_idx_)))
+        {
+            best_dist2 = dist2;
+            closest_vert = segment;
+        }
+    }
+    if (closest_vert)
+    {
+        return *closest_vert;
+    }
+    return PolygonUtils::findNearestVert(from, shape_);
+}
+
+ClosestPointPolygon ShapeLocator::moveInside(Point2LL& from, int distance, int64_t max_dist2) const
+{
+    return PolygonUtils::_moveInside2(findClosest(from), distance, from, max_dist2);
+}
+
+ClosestPointPolygon ShapeLocator::ensureInsideOrOutside(Point2LL& from, int preferred_dist_inside, int64_t max_dist2) const
+{
+    const ClosestPointPolygon closest_polygon_point = moveInside(from, preferred_dist_inside, max_dist2);
+    return PolygonUtils::ensureInsideOrOutside(shape_, from, closest_polygon_point, preferred_dist_inside, &shape_, grid_.get());
+}
+
+} // namespace cura
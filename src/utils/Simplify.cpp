@@ -4,18 +4,202 @@
 #include "utils/Simplify.h"
 
 #include <limits>
-#include <queue> //Priority queue to prioritise removing unimportant vertices.
 
 #include "geometry/ClosedPolyline.h"
 #include "geometry/MixedLinesSet.h"
 #include "geometry/OpenPolyline.h"
 #include "settings/Settings.h" //To load the parameters from a Settings object.
 #include "utils/ExtrusionLine.h"
+#include "utils/ThreadPool.h"
 #include "utils/linearAlg2D.h" //To calculate line deviations and intersecting lines.
 
 namespace cura
 {
 
+namespace
+{
+
+/*!
+ * A heap of the vertices by their importance, least important first, which
+ * knows where each vertex is so that it can change the importance of a vertex
+ * in place.
+ *
+ * Ties are broken by the vertex index, so the order in which the vertices come
+ * out doesn't depend on the order in which they went in.
+ */
+class ImportanceHeap
+{
+public:
+    //! Start over, empty, for a polygonal with this many vertices, keeping the allocated memory.
+    void reset(const size_t vertex_count)
+    {
+        heap_.clear();
+        heap_.reserve(vertex_count);
+        importance_.resize(vertex_count);
+        position_.resize(vertex_count);
+    }
+
+    //! Add a vertex. Call \ref heapify when done adding.
+    void add(const size_t vertex, const coord_t importance)
+    {
+        importance_[vertex] = importance;
+        position_[vertex] = heap_.size();
+        heap_.push_back(vertex);
+    }
+
+    //! Restore the heap order after adding vertices, in linear time.
+    void heapify()
+    {
+        for (size_t i = heap_.size() / 2; i-- > 0;)
+        {
+            siftDown(i);
+        }
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return heap_.empty();
+    }
+
+    [[nodiscard]] size_t top() const
+    {
+        return heap_.front();
+    }
+
+    [[nodiscard]] coord_t topImportance() const
+    {
+        return importance_[heap_.front()];
+    }
+
+    void pop()
+    {
+        moveTo(heap_.back(), 0);
+        heap_.pop_back();
+        if (! heap_.empty())
+        {
+            siftDown(0);
+        }
+    }
+
+    //! Change the importance of the least important vertex.
+    void updateTop(const coord_t importance)
+    {
+        const bool decreased = importance < importance_[heap_.front()];
+        importance_[heap_.front()] = importance;
+        if (! decreased) // The top can only go down if its importance increased.
+        {
+            siftDown(0);
+        }
+    }
+
+private:
+    std::vector<size_t> heap_; //!< The vertex indices, in heap order.
+    std::vector<coord_t> importance_; //!< For each vertex, its importance.
+    std::vector<size_t> position_; //!< For each vertex in the heap, where it is in the heap.
+
+    [[nodiscard]] bool lessImportant(const size_t vertex_a, const size_t vertex_b) const
+    {
+        return importance_[vertex_a] < importance_[vertex_b] || (importance_[vertex_a] == importance_[vertex_b] && vertex_a < vertex_b);
+    }
+
+    void moveTo(const size_t vertex, const size_t position)
+    {
+        heap_[position] = vertex;
+        position_[vertex] = position;
+    }
+
+    void siftDown(size_t position)
+    {
+        const size_t vertex = heap_[position];
+        while (true)
+        {
+            size_t child = 2 * position + 1;
+            if (child >= heap_.size())
+            {
+                break;
+            }
+            if (child + 1 < heap_.size() && lessImportant(heap_[child + 1], heap_[child]))
+            {
+                child++;
+            }
+            if (! lessImportant(heap_[child], vertex))
+            {
+                break;
+            }
+            moveTo(heap_[child], position);
+            position = child;
+        }
+        moveTo(vertex, position);
+    }
+};
+
+/*!
+ * Simplify each path of a set, on the thread pool if there is enough work.
+ * \param paths The paths to simplify.
+ * \param simplify_path Simplifies a single path.
+ * \param add Adds a simplified path to the result, if it should be kept.
+ * \param parallel_vertex_count From how many vertices on the work is spread
+ * over the thread pool.
+ */
+template<typename Result, typename Paths, typename SimplifyPath, typename Add>
+Result simplifyAll(const Paths& paths, const SimplifyPath& simplify_path, const Add& add, const size_t parallel_vertex_count)
+{
+    Result result;
+    size_t vertex_count = 0;
+    for (const auto& path : paths)
+    {
+        vertex_count += path.size();
+    }
+    if (paths.size() < 2 || vertex_count < parallel_vertex_count)
+    {
+        for (const auto& path : paths)
+        {
+            add(result, simplify_path(path));
+        }
+        return result;
+    }
+
+    std::vector<decltype(simplify_path(*paths.begin()))> simplified(paths.size());
+    cura::parallel_for<size_t>(
+        0,
+        paths.size(),
+        [&](const size_t path_idx)
+        {
+            simplified[path_idx] = simplify_path(paths[path_idx]);
+        });
+    for (auto& path : simplified)
+    {
+        add(result, std::move(path));
+    }
+    return result;
+}
+
+} // namespace
+
+Simplify::RemainingVertices::RemainingVertices(const size_t size)
+{
+    reset(size);
+}
+
+void Simplify::RemainingVertices::reset(const size_t size)
+{
+    previous.resize(size);
+    next.resize(size);
+    deleted.assign(size, false);
+    for (size_t i = 0; i < size; ++i)
+    {
+        previous[i] = (i + size - 1) % size;
+        next[i] = (i + 1) % size;
+    }
+}
+
+void Simplify::RemainingVertices::erase(const size_t index)
+{
+    deleted[index] = true;
+    next[previous[index]] = next[index];
+    previous[next[index]] = previous[index];
+}
+
 Simplify::Simplify(const coord_t max_resolution, const coord_t max_deviation, const coord_t max_area_deviation)
     : max_resolution_(max_resolution)
     , max_deviation_(max_deviation)
@@ -32,12 +216,17 @@ Simplify::Simplify(const Settings& settings)
 
 Shape Simplify::polygon(const Shape& polygons) const
 {
-    Shape result;
-    for (size_t i = 0; i < polygons.size(); ++i)
-    {
-        result.push_back(polygon(polygons[i]), CheckNonEmptyParam::OnlyIfNotEmpty);
-    }
-    return result;
+    return simplifyAll<Shape>(
+        polygons,
+        [this](const Polygon& path)
+        {
+            return polygon(path);
+        },
+        [](Shape& result, Polygon&& path)
+        {
+            result.push_back(std::move(path), CheckNonEmptyParam::OnlyIfNotEmpty);
+        },
+        parallel_vertex_count);
 }
 
 Polygon Simplify::polygon(const Polygon& polygon) const
@@ -55,12 +244,17 @@ ExtrusionLine Simplify::polygon(const ExtrusionLine& polygon) const
 template<class LineType>
 LinesSet<LineType> Simplify::polyline(const LinesSet<LineType>& polylines) const
 {
-    LinesSet<LineType> result;
-    for (size_t i = 0; i < polylines.size(); ++i)
-    {
-        result.push_back(polyline(polylines[i]), CheckNonEmptyParam::OnlyIfNotEmpty);
-    }
-    return result;
+    return simplifyAll<LinesSet<LineType>>(
+        polylines,
+        [this](const LineType& path)
+        {
+            return polyline(path);
+        },
+        [](LinesSet<LineType>& result, LineType&& path)
+        {
+            result.push_back(std::move(path), CheckNonEmptyParam::OnlyIfNotEmpty);
+        },
+        parallel_vertex_count);
 }
 
 MixedLinesSet Simplify::polyline(const MixedLinesSet& polylines) const
@@ -97,20 +291,32 @@ ExtrusionLine Simplify::polyline(const ExtrusionLine& polyline) const
     return simplify(polyline, is_closed);
 }
 
-size_t Simplify::nextNotDeleted(size_t index, const std::vector<bool>& to_delete) const
+std::vector<ExtrusionLine> Simplify::lines(const std::vector<ExtrusionLine>& lines) const
+{
+    return simplifyAll<std::vector<ExtrusionLine>>(
+        lines,
+        [this](const ExtrusionLine& line)
+        {
+            return line.is_closed_ ? polygon(line) : polyline(line);
+        },
+        [](std::vector<ExtrusionLine>& result, ExtrusionLine&& line)
+        {
+            if (! line.empty())
+            {
+                result.push_back(std::move(line));
+            }
+        },
+        parallel_vertex_count);
+}
+
+size_t Simplify::nextNotDeleted(size_t index, const RemainingVertices& remaining) const
 {
-    const size_t size = to_delete.size();
-    for (index = (index + 1) % size; to_delete[index]; index = (index + 1) % size)
-        ; // Changes the index variable in-place until we found one that is not deleted.
-    return index;
+    return remaining.next[index];
 }
 
-size_t Simplify::previousNotDeleted(size_t index, const std::vector<bool>& to_delete) const
+size_t Simplify::previousNotDeleted(size_t index, const RemainingVertices& remaining) const
 {
-    const size_t size = to_delete.size();
-    for (index = (index + size - 1) % size; to_delete[index]; index = (index + size - 1) % size)
-        ; // Changes the index variable in-place until we found one that is not deleted.
-    return index;
+    return remaining.previous[index];
 }
 
 template<>
@@ -242,12 +448,11 @@ Polygonal Simplify::simplify(const Polygonal& polygon, const bool is_closed) con
         return polygon;
     }
 
-    std::vector<bool> to_delete(polygon.size(), false);
-    auto comparator = [](const std::pair<size_t, coord_t>& vertex_a, const std::pair<size_t, coord_t>& vertex_b)
-    {
-        return vertex_a.second > vertex_b.second || (vertex_a.second == vertex_b.second && vertex_a.first > vertex_b.first);
-    };
-    std::priority_queue<std::pair<size_t, coord_t>, std::vector<std::pair<size_t, coord_t>>, decltype(comparator)> by_importance(comparator);
+    // Keep the buffers of each thread from one polygon to the next, to save allocating them each time.
+    thread_local RemainingVertices remaining(0);
+    thread_local ImportanceHeap by_importance;
+    remaining.reset(polygon.size());
+    by_importance.reset(polygon.size());
 
     Polygonal result = polygon; // Make a copy so that we can also shift vertices.
     for (int64_t current_removed = -1; (polygon.size() - current_removed) > min_size && current_removed != 0;)
@@ -257,32 +462,32 @@ Polygonal Simplify::simplify(const Polygonal& polygon, const bool is_closed) con
         // Add the initial points.
         for (size_t i = 0; i < result.size(); ++i)
         {
-            if (to_delete[i])
+            if (remaining.deleted[i])
             {
                 continue;
             }
-            const coord_t vertex_importance = importance(result, to_delete, i, is_closed);
-            by_importance.emplace(i, vertex_importance);
+            by_importance.add(i, importance(result, remaining, i, is_closed));
         }
+        by_importance.heapify();
 
         // Iteratively remove the least important point until a threshold.
         coord_t vertex_importance = 0;
         while (! by_importance.empty() && (polygon.size() - current_removed) > min_size)
         {
-            std::pair<size_t, coord_t> vertex = by_importance.top();
-            by_importance.pop();
+            const size_t vertex = by_importance.top();
             // The importance may have changed since this vertex was inserted. Re-compute it now.
             // If it doesn't change, it's safe to process.
-            vertex_importance = importance(result, to_delete, vertex.first, is_closed);
-            if (vertex_importance != vertex.second)
+            vertex_importance = importance(result, remaining, vertex, is_closed);
+            if (vertex_importance != by_importance.topImportance())
             {
-                by_importance.emplace(vertex.first, vertex_importance); // Re-insert with updated importance.
+                by_importance.updateTop(vertex_importance); // Re-order with updated importance.
                 continue;
             }
+            by_importance.pop();
 
             if (vertex_importance <= max_deviation_ * max_deviation_)
             {
-                current_removed += remove(result, to_delete, vertex.first, vertex_importance, is_closed) ? 1 : 0;
+                current_removed += remove(result, remaining, vertex, vertex_importance, is_closed) ? 1 : 0;
             }
         }
     }
@@ -291,7 +496,7 @@ Polygonal Simplify::simplify(const Polygonal& polygon, const bool is_closed) con
     Polygonal filtered = createEmpty(polygon);
     for (size_t i = 0; i < result.size(); ++i)
     {
-        if (! to_delete[i])
+        if (! remaining.deleted[i])
         {
             appendVertex(filtered, result[i]);
         }
@@ -305,7 +510,7 @@ Polygonal Simplify::simplify(const Polygonal& polygon, const bool is_closed) con
 }
 
 template<typename Polygonal>
-coord_t Simplify::importance(const Polygonal& polygon, const std::vector<bool>& to_delete, const size_t index, const bool is_closed) const
+coord_t Simplify::importance(const Polygonal& polygon, const RemainingVertices& remaining, const size_t index, const bool is_closed) const
 {
     const size_t poly_size = polygon.size();
     if (! is_closed && (index == 0 || index == poly_size - 1))
@@ -315,8 +520,8 @@ coord_t Simplify::importance(const Polygonal& polygon, const std::vector<bool>&
     // From here on out we can safely look at the vertex neighbors and assume it's a polygon. We won't go out of bounds of the polyline.
 
     const Point2LL& vertex = getPosition(polygon[index]);
-    const size_t before_index = previousNotDeleted(index, to_delete);
-    const size_t after_index = nextNotDeleted(index, to_delete);
+    const size_t before_index = previousNotDeleted(index, remaining);
+    const size_t after_index = nextNotDeleted(index, remaining);
 
     const coord_t area_deviation = getAreaDeviation(polygon[before_index], polygon[index], polygon[after_index]);
     if (area_deviation > max_area_deviation_) // Removing this line causes the variable line width to get flattened out too much.
@@ -339,18 +544,18 @@ coord_t Simplify::importance(const Polygonal& polygon, const std::vector<bool>&
 }
 
 template<typename Polygonal>
-bool Simplify::remove(Polygonal& polygon, std::vector<bool>& to_delete, const size_t vertex, const coord_t deviation2, const bool is_closed) const
+bool Simplify::remove(Polygonal& polygon, RemainingVertices& remaining, const size_t vertex, const coord_t deviation2, const bool is_closed) const
 {
     if (deviation2 <= min_resolution * min_resolution)
     {
         // At less than the minimum resolution we're always allowed to delete the vertex.
         // Even if the adjacent line segments are very long.
-        to_delete[vertex] = true;
+        remaining.erase(vertex);
         return true;
     }
 
-    const size_t before = previousNotDeleted(vertex, to_delete);
-    const size_t after = nextNotDeleted(vertex, to_delete);
+    const size_t before = previousNotDeleted(vertex, remaining);
+    const size_t after = nextNotDeleted(vertex, remaining);
     const Point2LL& vertex_position = getPosition(polygon[vertex]);
     const Point2LL& before_position = getPosition(polygon[before]);
     const Point2LL& after_position = getPosition(polygon[after]);
@@ -360,7 +565,7 @@ bool Simplify::remove(Polygonal& polygon, std::vector<bool>& to_delete, const si
     if (length2_before <= max_resolution_ * max_resolution_ && length2_after <= max_resolution_ * max_resolution_) // Both adjacent line segments are short.
     {
         // Removing this vertex does little harm. No long lines will be shifted.
-        to_delete[vertex] = true;
+        remaining.erase(vertex);
         return true;
     }
 
@@ -374,7 +579,7 @@ bool Simplify::remove(Polygonal& polygon, std::vector<bool>& to_delete, const si
         {
             return false; // Edge cannot be deleted without shifting a long edge. Don't remove anything.
         }
-        const size_t before_before = previousNotDeleted(before, to_delete);
+        const size_t before_before = previousNotDeleted(before, remaining);
         before_from = getPosition(polygon[before_before]);
         before_to = getPosition(polygon[before]);
         after_from = getPosition(polygon[vertex]);
@@ -386,7 +591,7 @@ bool Simplify::remove(Polygonal& polygon, std::vector<bool>& to_delete, const si
         {
             return false; // Edge cannot be deleted without shifting a long edge. Don't remove anything.
         }
-        const size_t after_after = nextNotDeleted(after, to_delete);
+        const size_t after_after = nextNotDeleted(after, remaining);
         before_from = getPosition(polygon[before]);
         before_to = getPosition(polygon[vertex]);
         after_from = getPosition(polygon[after]);
@@ -401,7 +606,7 @@ bool Simplify::remove(Polygonal& polygon, std::vector<bool>& to_delete, const si
     const coord_t intersection_deviation = LinearAlg2D::getDist2FromLineSegment(before_to, intersection, after_from);
     if (intersection_deviation <= max_deviation_ * max_deviation_) // Intersection point doesn't deviate too much. Use it!
     {
-        to_delete[vertex] = true;
+        remaining.erase(vertex);
         polygon[length2_before <= length2_after ? before : after] = createIntersection(polygon[before], intersection, polygon[after]);
         return true;
     }
@@ -0,0 +1,74 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/SpillFile.h"
+
+#include <random>
+#include <system_error>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "utils/format/filesystem_path.h"
+
+namespace cura
+{
+
+SpillFile::SpillFile(const std::filesystem::path& directory)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    path_ = directory / fmt::format("curaengine-{:08x}{:08x}.spill", std::random_device{}(), std::random_device{}());
+    file_.open(path_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (! file_)
+    {
+        spdlog::warn("Couldn't create the spill file {}.", path_);
+    }
+}
+
+SpillFile::~SpillFile()
+{
+    file_.close();
+    std::error_code error;
+    std::filesystem::remove(path_, error);
+}
+
+bool SpillFile::isOpen() const
+{
+    return file_.is_open();
+}
+
+std::optional<SpillFile::Record> SpillFile::write(const std::string& data)
+{
+    std::lock_guard lock(mutex_);
+    if (! file_.is_open())
+    {
+        return std::nullopt;
+    }
+    file_.seekp(static_cast<std::streamoff>(size_));
+    if (! file_.write(data.data(), static_cast<std::streamsize>(data.size())))
+    {
+        spdlog::warn("Couldn't write to the spill file {}, keeping the data in memory.", path_);
+        file_.clear();
+        return std::nullopt;
+    }
+    const Record record{ .offset = size_, .size = data.size() };
+    size_ += data.size();
+    return record;
+}
+
+std::optional<std::string> SpillFile::read(const Record& record) const
+{
+    std::lock_guard lock(mutex_);
+    std::string data(record.size, '\0');
+    file_.seekg(static_cast<std::streamoff>(record.offset));
+    if (! file_.read(data.data(), static_cast<std::streamsize>(data.size())))
+    {
+        spdlog::error("Couldn't read back from the spill file {}.", path_);
+        file_.clear();
+        return std::nullopt;
+    }
+    return data;
+}
+
+} // namespace cura
@@ -3,16 +3,63 @@
 
 #include "utils/ThreadPool.h"
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
 namespace cura
 {
 
-ThreadPool::ThreadPool(size_t nthreads)
-  : wait_for_new_tasks(true)
+namespace
+{
+
+//! Lets a thread only run on one CPU. Returns whether that succeeded.
+bool pinThread(std::thread::native_handle_type thread [[maybe_unused]], size_t cpu [[maybe_unused]])
+{
+#ifdef __linux__
+    if (cpu >= CPU_SETSIZE)
+    {
+        return false;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    return pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set) == 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t nthreads, const std::vector<size_t>& cpus)
+  : idle_threads(0)
+  , wait_for_new_tasks(true)
 {
     for (size_t i = 0 ; i < nthreads; i++)
     {
         threads.emplace_back(&ThreadPool::worker, this);
     }
+    if (cpus.empty())
+    {
+        return;
+    }
+#ifdef __linux__
+    bool pinned = pinThread(pthread_self(), cpus[0]);
+    for (size_t i = 0 ; i < nthreads; i++)
+    {
+        pinned = pinThread(threads[i].native_handle(), cpus[(i + 1) % cpus.size()]) && pinned;
+    }
+    if (! pinned)
+    {
+        spdlog::warn("Could not pin all threads to their CPUs.");
+    }
+#else
+    spdlog::warn("Pinning threads to CPUs is only supported on Linux.");
+#endif
 }
 
 void ThreadPool::worker()
@@ -22,7 +69,15 @@ void ThreadPool::worker()
         {
             while(tasks.empty() && wait_for_new_tasks)
             {  // Wait for a task. Signaled by ThreadPool::push() and ThreadPool::join()
+               idle_threads++;
+               const bool profiled = ThreadPoolProfiler::getInstance().isEnabled();
+               const ThreadPoolProfiler::clock_t::time_point idle_start = profiled ? ThreadPoolProfiler::clock_t::now() : ThreadPoolProfiler::clock_t::time_point();
                condition.wait(lock);
+               if (profiled)
+               {
+                   ThreadPoolProfiler::getInstance().recordIdle(idle_start, ThreadPoolProfiler::clock_t::now());
+               }
+               idle_threads--;
             }
             // Returns false if the queue is empty and the pool is being disposed
             return !tasks.empty() || wait_for_new_tasks;
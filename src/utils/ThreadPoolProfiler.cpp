@@ -0,0 +1,295 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/ThreadPoolProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+#include <fmt/format.h>
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/writer.h>
+#include <spdlog/spdlog.h>
+
+namespace cura
+{
+
+ThreadPoolProfiler& ThreadPoolProfiler::getInstance()
+{
+    static ThreadPoolProfiler instance;
+    return instance;
+}
+
+void ThreadPoolProfiler::enable(std::string trace_file)
+{
+    trace_file_ = std::move(trace_file);
+    origin_ = clock_t::now();
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void ThreadPoolProfiler::recordChunk(const std::source_location& location, clock_t::time_point start, clock_t::time_point end)
+{
+    ThreadTables& tables = threadTables();
+    std::lock_guard lock(tables.mutex);
+    tables.events.push_back(Event{ .kind = Event::Kind::CHUNK, .location = location, .start = start, .end = end });
+}
+
+void ThreadPoolProfiler::recordLoop(
+    const std::source_location& location,
+    size_t items,
+    clock_t::time_point start,
+    clock_t::time_point wait_start,
+    clock_t::time_point end)
+{
+    ThreadTables& tables = threadTables();
+    std::lock_guard lock(tables.mutex);
+    tables.loops.push_back(Loop{ .location = location, .items = items, .start = start, .wait_start = wait_start, .end = end });
+}
+
+void ThreadPoolProfiler::recordQueueWait(clock_t::time_point pushed, clock_t::time_point started)
+{
+    ThreadTables& tables = threadTables();
+    std::lock_guard lock(tables.mutex);
+    tables.queued_tasks++;
+    tables.queue_wait += started - pushed;
+    tables.max_queue_wait = std::max(tables.max_queue_wait, started - pushed);
+}
+
+void ThreadPoolProfiler::recordIdle(clock_t::time_point start, clock_t::time_point end)
+{
+    ThreadTables& tables = threadTables();
+    std::lock_guard lock(tables.mutex);
+    tables.events.push_back(Event{ .kind = Event::Kind::IDLE, .location = {}, .start = start, .end = end });
+}
+
+void ThreadPoolProfiler::recordSpan(const char* name, clock_t::time_point start, clock_t::time_point end)
+{
+    ThreadTables& tables = threadTables();
+    std::lock_guard lock(tables.mutex);
+    tables.events.push_back(Event{ .kind = Event::Kind::SPAN, .location = {}, .name = name, .start = start, .end = end });
+}
+
+void ThreadPoolProfiler::recordStage(std::string_view name, std::chrono::duration<double> duration)
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+    const clock_t::time_point end = clock_t::now();
+    std::lock_guard lock(tables_mutex_);
+    stages_.push_back(Stage{ .name = std::string(name), .start = end - std::chrono::duration_cast<clock_t::duration>(duration), .end = end });
+}
+
+ThreadPoolProfiler::ThreadTables& ThreadPoolProfiler::threadTables()
+{
+    thread_local std::shared_ptr<ThreadTables> tables;
+    if (! tables)
+    {
+        tables = std::make_shared<ThreadTables>();
+        std::lock_guard lock(tables_mutex_);
+        tables->thread_idx = tables_.size();
+        tables_.push_back(tables);
+    }
+    return *tables;
+}
+
+void ThreadPoolProfiler::report()
+{
+    if (! isEnabled())
+    {
+        return;
+    }
+
+    // The statistics of all the loops that are called from one place.
+    struct SiteStats
+    {
+        size_t calls = 0;
+        size_t items = 0;
+        size_t chunks = 0;
+        clock_t::duration total{ 0 };
+        clock_t::duration wait{ 0 };
+        clock_t::duration chunk_total{ 0 };
+        clock_t::duration chunk_min = clock_t::duration::max();
+        clock_t::duration chunk_max{ 0 };
+    };
+    std::map<std::tuple<std::string_view, uint_least32_t>, SiteStats> sites; // Per file and line.
+    size_t queued_tasks = 0;
+    clock_t::duration queue_wait{ 0 };
+    clock_t::duration max_queue_wait{ 0 };
+    clock_t::duration idle{ 0 };
+
+    std::lock_guard lock(tables_mutex_);
+    for (const std::shared_ptr<ThreadTables>& tables : tables_)
+    {
+        std::lock_guard tables_lock(tables->mutex);
+        for (const Event& event : tables->events)
+        {
+            if (event.kind == Event::Kind::IDLE)
+            {
+                idle += event.end - event.start;
+                continue;
+            }
+            if (event.kind == Event::Kind::SPAN)
+            {
+                continue;
+            }
+            SiteStats& site = sites[{ event.location.file_name(), event.location.line() }];
+            const clock_t::duration chunk_time = event.end - event.start;
+            site.chunks++;
+            site.chunk_total += chunk_time;
+            site.chunk_min = std::min(site.chunk_min, chunk_time);
+            site.chunk_max = std::max(site.chunk_max, chunk_time);
+        }
+        for (const Loop& loop : tables->loops)
+        {
+            SiteStats& site = sites[{ loop.location.file_name(), loop.location.line() }];
+            site.calls++;
+            site.items += loop.items;
+            site.total += loop.end - loop.start;
+            site.wait += loop.end - loop.wait_start;
+        }
+        queued_tasks += tables->queued_tasks;
+        queue_wait += tables->queue_wait;
+        max_queue_wait = std::max(max_queue_wait, tables->max_queue_wait);
+    }
+
+    std::vector<std::pair<std::tuple<std::string_view, uint_least32_t>, SiteStats>> sorted(sites.begin(), sites.end());
+    std::sort(
+        sorted.begin(),
+        sorted.end(),
+        [](const auto& a, const auto& b)
+        {
+            return a.second.total > b.second.total;
+        });
+
+    const auto ms = [](const clock_t::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+    constexpr size_t logged_count = 25;
+    spdlog::info("Parallel loops, the {} most expensive of {} call sites:", std::min(logged_count, sorted.size()), sorted.size());
+    for (size_t i = 0; i < std::min(logged_count, sorted.size()); i++)
+    {
+        const auto& [site, stats] = sorted[i];
+        spdlog::info(
+            "  {}:{}: {} calls, {} items, {:.3f} ms, {} chunks of {:.3f}/{:.3f}/{:.3f} ms (min/avg/max), {:.3f} ms waiting for the last chunks",
+            std::get<0>(site),
+            std::get<1>(site),
+            stats.calls,
+            stats.items,
+            ms(stats.total),
+            stats.chunks,
+            stats.chunks > 0 ? ms(stats.chunk_min) : 0.0,
+            stats.chunks > 0 ? ms(stats.chunk_total) / stats.chunks : 0.0,
+            ms(stats.chunk_max),
+            ms(stats.wait));
+    }
+    spdlog::info(
+        "Thread pool: {} tasks waited {:.3f} ms in the queue on average and at most {:.3f} ms. The workers were idle for {:.3f} ms in total.",
+        queued_tasks,
+        queued_tasks > 0 ? ms(queue_wait) / queued_tasks : 0.0,
+        ms(max_queue_wait),
+        ms(idle));
+
+    if (! trace_file_.empty())
+    {
+        writeTrace(tables_);
+    }
+
+    for (const std::shared_ptr<ThreadTables>& tables : tables_)
+    {
+        std::lock_guard tables_lock(tables->mutex);
+        tables->events.clear();
+        tables->loops.clear();
+        tables->queued_tasks = 0;
+        tables->queue_wait = clock_t::duration(0);
+        tables->max_queue_wait = clock_t::duration(0);
+    }
+    stages_.clear();
+}
+
+void ThreadPoolProfiler::writeTrace(const std::vector<std::shared_ptr<ThreadTables>>& tables) const
+{
+    std::ofstream file(trace_file_);
+    if (! file)
+    {
+        spdlog::error("Couldn't write the thread pool trace to {}.", trace_file_);
+        return;
+    }
+    rapidjson::OStreamWrapper stream(file);
+    rapidjson::Writer<rapidjson::OStreamWrapper> writer(stream);
+
+    constexpr int threads_pid = 0;
+    constexpr int stages_pid = 1;
+    const auto write_event = [this, &writer](const std::string& name, const char* category, const int pid, const size_t tid, clock_t::time_point start, clock_t::time_point end)
+    {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(name.c_str(), static_cast<rapidjson::SizeType>(name.size()));
+        writer.Key("cat");
+        writer.String(category);
+        writer.Key("ph");
+        writer.String("X");
+        writer.Key("ts");
+        writer.Double(std::chrono::duration<double, std::micro>(start - origin_).count());
+        writer.Key("dur");
+        writer.Double(std::chrono::duration<double, std::micro>(end - start).count());
+        writer.Key("pid");
+        writer.Int(pid);
+        writer.Key("tid");
+        writer.Uint64(tid);
+        writer.EndObject();
+    };
+    const auto write_process_name = [&writer](const int pid, const char* name)
+    {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String("process_name");
+        writer.Key("ph");
+        writer.String("M");
+        writer.Key("pid");
+        writer.Int(pid);
+        writer.Key("args");
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(name);
+        writer.EndObject();
+        writer.EndObject();
+    };
+
+    writer.StartObject();
+    writer.Key("traceEvents");
+    writer.StartArray();
+    write_process_name(threads_pid, "Threads");
+    write_process_name(stages_pid, "Stages");
+    for (const Stage& stage : stages_)
+    {
+        write_event(stage.name, "stage", stages_pid, 0, stage.start, stage.end);
+    }
+    for (const std::shared_ptr<ThreadTables>& thread_tables : tables)
+    {
+        std::lock_guard tables_lock(thread_tables->mutex);
+        for (const Event& event : thread_tables->events)
+        {
+            if (event.kind == Event::Kind::IDLE)
+            {
+                write_event("idle", "idle", threads_pid, thread_tables->thread_idx, event.start, event.end);
+            }
+            else if (event.kind == Event::Kind::SPAN)
+            {
+                write_event(event.name, "span", threads_pid, thread_tables->thread_idx, event.start, event.end);
+            }
+            else
+            {
+                write_event(fmt::format("{}:{}", event.location.file_name(), event.location.line()), "chunk", threads_pid, thread_tables->thread_idx, event.start, event.end);
+            }
+        }
+    }
+    writer.EndArray();
+    writer.EndObject();
+    spdlog::info("Wrote the thread pool trace to {}.", trace_file_);
+}
+
+} // namespace cura
@@ -118,9 +118,15 @@ const VoronoiUtils::Segment& VoronoiUtils::getSourceSegment(const vd_t::cell_typ
 }
 
 
-std::vector<Point2LL> VoronoiUtils::discretizeParabola(const Point2LL& p, const Segment& segment, Point2LL s, Point2LL e, coord_t approximate_step_size, double transitioning_angle)
+void VoronoiUtils::discretizeParabola(
+    const Point2LL& p,
+    const Segment& segment,
+    Point2LL s,
+    Point2LL e,
+    coord_t approximate_step_size,
+    double transitioning_angle,
+    std::vector<Point2LL>& discretized)
 {
-    std::vector<Point2LL> discretized;
     // x is distance of point projected on the segment ab
     // xx is point projected on the segment ab
     const Point2LL a = segment.from();
@@ -145,7 +151,7 @@ std::vector<Point2LL> VoronoiUtils::discretizeParabola(const Point2LL& p, const
     {
         discretized.emplace_back(s);
         discretized.emplace_back(e);
-        return discretized;
+        return;
     }
 
     const double marking_bound = atan(transitioning_angle * 0.5);
@@ -210,7 +216,6 @@ std::vector<Point2LL> VoronoiUtils::discretizeParabola(const Point2LL& p, const
         discretized.emplace_back(marking_end);
     }
     discretized.emplace_back(e);
-    return discretized;
 }
 
 /*
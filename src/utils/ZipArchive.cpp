@@ -0,0 +1,236 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/ZipArchive.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <spdlog/spdlog.h>
+#include <zlib.h>
+
+namespace cura
+{
+
+namespace
+{
+
+constexpr uint32_t end_of_central_directory_signature = 0x06054b50;
+constexpr uint32_t central_directory_signature = 0x02014b50;
+constexpr uint32_t local_header_signature = 0x04034b50;
+constexpr size_t end_of_central_directory_size = 22;
+constexpr size_t central_directory_header_size = 46;
+constexpr size_t local_header_size = 30;
+constexpr size_t max_comment_size = 0xFFFF;
+
+constexpr uint16_t method_stored = 0;
+constexpr uint16_t method_deflated = 8;
+
+/*!
+ * Read a little-endian number from the archive.
+ */
+template<typename T>
+T readNumber(const char* data)
+{
+    T result;
+    std::memcpy(&result, data, sizeof(T));
+    return result;
+}
+
+} // namespace
+
+struct ZipArchive::Mapping
+{
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+};
+
+ZipArchive::~ZipArchive() = default;
+
+std::unique_ptr<ZipArchive> ZipArchive::open(const std::string& filename)
+{
+    std::unique_ptr<ZipArchive> archive(new ZipArchive());
+    archive->filename_ = filename;
+    try
+    {
+        archive->mapping_ = std::make_unique<Mapping>();
+        archive->mapping_->file = boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only);
+        archive->mapping_->region = boost::interprocess::mapped_region(archive->mapping_->file, boost::interprocess::read_only);
+    }
+    catch (const boost::interprocess::interprocess_exception& exception)
+    {
+        spdlog::error("Failed to map ZIP archive {}: {}", filename, exception.what());
+        return nullptr;
+    }
+    const char* data = static_cast<const char*>(archive->mapping_->region.get_address());
+    const size_t size = archive->mapping_->region.get_size();
+    archive->data_ = data;
+    archive->size_ = size;
+
+    // The end of central directory record is at the end of the file, followed only by a comment of unknown length.
+    if (size < end_of_central_directory_size)
+    {
+        spdlog::error("File {} is too small to be a ZIP archive.", filename);
+        return nullptr;
+    }
+    const size_t search_end = size - end_of_central_directory_size;
+    const size_t search_start = search_end > max_comment_size ? search_end - max_comment_size : 0;
+    std::optional<size_t> end_record;
+    for (size_t offset = search_end + 1; offset-- > search_start;)
+    {
+        if (readNumber<uint32_t>(data + offset) == end_of_central_directory_signature)
+        {
+            end_record = offset;
+            break;
+        }
+    }
+    if (! end_record)
+    {
+        spdlog::error("File {} is not a ZIP archive.", filename);
+        return nullptr;
+    }
+
+    const uint16_t entry_count = readNumber<uint16_t>(data + *end_record + 10);
+    const uint32_t directory_size = readNumber<uint32_t>(data + *end_record + 12);
+    const uint32_t directory_offset = readNumber<uint32_t>(data + *end_record + 16);
+    if (entry_count == 0xFFFF || directory_offset == 0xFFFFFFFF)
+    {
+        spdlog::error("ZIP archive {} uses ZIP64 extensions, which aren't supported.", filename);
+        return nullptr;
+    }
+    if (static_cast<size_t>(directory_offset) + directory_size > *end_record)
+    {
+        spdlog::error("ZIP archive {} is corrupt: its central directory is out of bounds.", filename);
+        return nullptr;
+    }
+
+    const char* cursor = data + directory_offset;
+    const char* const directory_end = cursor + directory_size;
+    archive->entries_.reserve(entry_count);
+    for (uint16_t entry_idx = 0; entry_idx < entry_count; entry_idx++)
+    {
+        if (directory_end - cursor < static_cast<ptrdiff_t>(central_directory_header_size) || readNumber<uint32_t>(cursor) != central_directory_signature)
+        {
+            spdlog::error("ZIP archive {} is corrupt: its central directory is truncated.", filename);
+            return nullptr;
+        }
+        const uint16_t flags = readNumber<uint16_t>(cursor + 8);
+        const Entry entry{ .method_ = readNumber<uint16_t>(cursor + 10),
+                           .compressed_size_ = readNumber<uint32_t>(cursor + 20),
+                           .uncompressed_size_ = readNumber<uint32_t>(cursor + 24),
+                           .local_header_offset_ = readNumber<uint32_t>(cursor + 42) };
+        const uint16_t name_length = readNumber<uint16_t>(cursor + 28);
+        const uint16_t extra_length = readNumber<uint16_t>(cursor + 30);
+        const uint16_t comment_length = readNumber<uint16_t>(cursor + 32);
+        const size_t header_length = central_directory_header_size + name_length + extra_length + comment_length;
+        if (static_cast<size_t>(directory_end - cursor) < header_length)
+        {
+            spdlog::error("ZIP archive {} is corrupt: its central directory is truncated.", filename);
+            return nullptr;
+        }
+        const std::string_view name(cursor + central_directory_header_size, name_length);
+        cursor += header_length;
+
+        if (flags & 1)
+        {
+            spdlog::warn("Skipping {} in ZIP archive {}, because it's encrypted.", name, filename);
+            continue;
+        }
+        if (entry.compressed_size_ == 0xFFFFFFFF || entry.uncompressed_size_ == 0xFFFFFFFF || entry.local_header_offset_ == 0xFFFFFFFF)
+        {
+            spdlog::warn("Skipping {} in ZIP archive {}, because it uses ZIP64 extensions.", name, filename);
+            continue;
+        }
+        archive->entries_.emplace(normalizeName(name), entry);
+    }
+    return archive;
+}
+
+bool ZipArchive::contains(std::string_view name) const
+{
+    return entries_.contains(normalizeName(name));
+}
+
+std::optional<std::string> ZipArchive::read(std::string_view name) const
+{
+    const auto found = entries_.find(normalizeName(name));
+    if (found == entries_.end())
+    {
+        return std::nullopt;
+    }
+    const Entry& entry = found->second;
+
+    // The data starts after the local header, which may have a different extra field than the central directory.
+    const size_t header_offset = entry.local_header_offset_;
+    if (header_offset + local_header_size > size_ || readNumber<uint32_t>(data_ + header_offset) != local_header_signature)
+    {
+        spdlog::error("ZIP archive {} is corrupt: the header of {} is missing.", filename_, name);
+        return std::nullopt;
+    }
+    const size_t data_offset = header_offset + local_header_size + readNumber<uint16_t>(data_ + header_offset + 26) + readNumber<uint16_t>(data_ + header_offset + 28);
+    if (data_offset + entry.compressed_size_ > size_)
+    {
+        spdlog::error("ZIP archive {} is corrupt: {} is truncated.", filename_, name);
+        return std::nullopt;
+    }
+    const char* compressed = data_ + data_offset;
+
+    if (entry.method_ == method_stored)
+    {
+        if (entry.compressed_size_ != entry.uncompressed_size_)
+        {
+            spdlog::error("ZIP archive {} is corrupt: the sizes of {} don't match.", filename_, name);
+            return std::nullopt;
+        }
+        return std::string(compressed, entry.compressed_size_);
+    }
+    if (entry.method_ != method_deflated)
+    {
+        spdlog::error("{} in ZIP archive {} uses compression method {}, which isn't supported.", name, filename_, entry.method_);
+        return std::nullopt;
+    }
+
+    std::string result(entry.uncompressed_size_, '\0');
+    z_stream stream{};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) // A raw deflate stream, without zlib header.
+    {
+        spdlog::error("Failed to initialize the decompression of {} in ZIP archive {}.", name, filename_);
+        return std::nullopt;
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed));
+    stream.avail_in = entry.compressed_size_;
+    stream.next_out = reinterpret_cast<Bytef*>(result.data());
+    stream.avail_out = entry.uncompressed_size_;
+    const int status = inflate(&stream, Z_FINISH);
+    const uLong decompressed_size = stream.total_out;
+    inflateEnd(&stream);
+    if (status != Z_STREAM_END || decompressed_size != entry.uncompressed_size_)
+    {
+        spdlog::error("Failed to decompress {} in ZIP archive {}.", name, filename_);
+        return std::nullopt;
+    }
+    return result;
+}
+
+std::string ZipArchive::normalizeName(std::string_view name)
+{
+    if (name.starts_with('/'))
+    {
+        name.remove_prefix(1);
+    }
+    std::string result(name);
+    std::transform(
+        result.begin(),
+        result.end(),
+        result.begin(),
+        [](const unsigned char c)
+        {
+            return static_cast<char>(std::tolower(c));
+        });
+    return result;
+}
+
+} // namespace cura
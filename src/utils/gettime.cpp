@@ -10,17 +10,26 @@ namespace cura
 
 TimeKeeper::TimeKeeper()
 {
+#ifdef ALLOCATION_PROFILING
+    allocations_start = AllocationProfiler::threadCounts();
+#endif
 }
 
 double TimeKeeper::restart()
 {
     double ret = watch.elapsed().count();
     watch.reset();
+#ifdef ALLOCATION_PROFILING
+    allocations_start = AllocationProfiler::threadCounts();
+#endif
     return ret;
 }
 
 void TimeKeeper::registerTime(const std::string& stage, double threshold)
 {
+#ifdef ALLOCATION_PROFILING
+    AllocationProfiler::getInstance().recordSubStage(stage, allocations_start);
+#endif
     double duration = restart();
     if (duration >= threshold)
     {
@@ -853,25 +853,100 @@ unsigned int PolygonUtils::findNearestVert(const Point2LL from, const Polygon& p
     return closest_vert_idx;
 }
 
-std::unique_ptr<LocToLineGrid> PolygonUtils::createLocToLineGrid(const Shape& polygons, int square_size)
+/*!
+ * Finds a neighbour point on the path, located before or after the given reference point. The neighbour point
+ * is computed by travelling on the path and stopping when the distance has been reached, For example:
+ * |------|---------|------|--------------*---|
+ * H      A         B      C              N   D
+ * In this case, H is the start point of the path and ABCD are the actual following points of the path.
+ * The neighbour point N is found by reaching point D then going a bit backward on the previous segment.
+ * This approach gets rid of the mesh actual resolution and gives a neighbour point that is on the path
+ * at a given physical distance.
+ * \param points The vertices of the path
+ * \param here The starting point index
+ * \param distance The distance we want to travel on the path, which may be positive to go forward
+ * or negative to go backward
+ * \param segments_sizes The pre-computed sizes of the segments
+ * \return The position of the path a the given distance from the reference point
+ */
+static Point2LL findNeighbourPoint(const PointsSet& points, int here, coord_t distance, const std::vector<coord_t>& segments_sizes)
 {
-    unsigned int n_points = 0;
-    for (const auto& poly : polygons)
+    const int direction = distance > 0 ? 1 : -1;
+    const int size_delta = distance > 0 ? -1 : 0;
+    distance = std::abs(distance);
+
+    // Travel on the path until we reach the distance
+    int actual_delta = 0;
+    coord_t travelled_distance = 0;
+    coord_t segment_size = 0;
+    while (travelled_distance < distance)
     {
-        n_points += poly.size();
+        actual_delta += direction;
+        segment_size = segments_sizes[(here + actual_delta + size_delta + points.size()) % points.size()];
+        travelled_distance += segment_size;
     }
 
-    auto ret = std::make_unique<LocToLineGrid>(square_size, n_points);
+    const Point2LL& next_pos = points.at((here + actual_delta + points.size()) % points.size());
+
+    if (travelled_distance > distance) [[likely]]
+    {
+        // We have overtaken the required distance, go backward on the last segment
+        int prev = (here + actual_delta - direction + points.size()) % points.size();
+        const Point2LL& prev_pos = points.at(prev);
+
+        const Point2LL vector = next_pos - prev_pos;
+        const Point2LL unit_vector = (vector * 1000) / segment_size;
+        const Point2LL vector_delta = unit_vector * (segment_size - (travelled_distance - distance));
+        return prev_pos + vector_delta / 1000;
+    }
+    else
+    {
+        // Luckily, the required distance stops exactly on an existing point
+        return next_pos;
+    }
+}
+
+std::vector<double> PolygonUtils::cornerAngles(const PointsSet& points, const coord_t angle_query_distance)
+{
+    // Precompute segments lengths because we are going to need them multiple times
+    std::vector<coord_t> segments_sizes(points.size());
+    coord_t total_length = 0;
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        const Point2LL& here = points.at(i);
+        const Point2LL& next = points.at((i + 1) % points.size());
+        const coord_t segment_size = vSize(next - here);
+        segments_sizes[i] = segment_size;
+        total_length += segment_size;
+    }
+
+    const coord_t bounded_distance = std::min(angle_query_distance, total_length / 2);
+    std::vector<double> angles(points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        const Point2LL& here = points.at(i);
+        const Point2LL next = findNeighbourPoint(points, i, bounded_distance, segments_sizes);
+        const Point2LL previous = findNeighbourPoint(points, i, -bounded_distance, segments_sizes);
+
+        const double angle = LinearAlg2D::getAngleLeft(previous, here, next) - std::numbers::pi;
+        angles[i] = angle / std::numbers::pi;
+    }
+    return angles;
+}
 
+std::unique_ptr<LocToLineGrid> PolygonUtils::createLocToLineGrid(const Shape& polygons, int square_size)
+{
+    std::vector<PolygonsPointIndex> segments;
+    segments.reserve(polygons.pointCount());
     for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
     {
         const Polygon& poly = polygons[poly_idx];
         for (unsigned int point_idx = 0; point_idx < poly.size(); point_idx++)
         {
-            ret->insert(PolygonsPointIndex(&polygons, poly_idx, point_idx));
+            segments.emplace_back(&polygons, poly_idx, point_idx);
         }
     }
-    return ret;
+    return std::make_unique<LocToLineGrid>(square_size, segments);
 }
 
 /*
@@ -1452,16 +1527,28 @@ Shape PolygonUtils::clipPolygonWithAABB(const Shape& src, const AABB& aabb)
 {
     Shape out;
     out.reserve(src.size());
-    for (const auto path : src)
+    for (const Polygon& path : src)
     {
-        Polygon poly;
-
         const size_t cnt = path.size();
         if (cnt < 3)
         {
             return Shape();
         }
 
+        // If a polygon is entirely on one side of the box, all its points would be dropped. If it's entirely inside, all its points would be kept.
+        const AABB path_aabb(path);
+        if (! aabb.hit(path_aabb))
+        {
+            continue;
+        }
+        if (aabb.contains(path_aabb))
+        {
+            out.push_back(path);
+            continue;
+        }
+
+        Polygon poly;
+
         enum class Side
         {
             Left = 1,
@@ -1,14 +1,19 @@
 // Copyright (c) 2023 UltiMaker
 // CuraEngine is released under the terms of the AGPLv3 or higher
 
+#include <chrono>
 #include <csignal>
+#include <ctime>
 #include <docopt/docopt.h>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <string_view>
+#include <sys/resource.h>
 #include <sys/wait.h>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
@@ -19,9 +24,11 @@
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
 
+#include "Application.h"
 #include "WallsComputation.h"
 #include "geometry/OpenPolyline.h"
 #include "geometry/Polygon.h"
+#include "progress/SlowLayerCapture.h"
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
@@ -34,7 +41,7 @@ constexpr std::string_view USAGE = R"(Stress Benchmark.
 Executes a Stress Benchmark on CuraEngine.
 
 Usage:
-  stress_benchmark -o FILE
+  stress_benchmark -o FILE [--benchmark_out=FILE] [--max_threads=N] [--resources=DIR]
   stress_benchmark (-h | --help)
   stress_benchmark --version
 
@@ -42,8 +49,32 @@ Options:
   -h --help                      Show this screen.
   --version                      Show version.
   -o FILE                        Specify the output Json file.
+  --benchmark_out=FILE           Also write the wall time, the points in and out and the peak memory of every test case to
+                                 this file, in the Json format of Google Benchmark.
+  --max_threads=N                Run every test case with 1, 2, 4, ... threads, up to N [default: 1].
+  --resources=DIR                Run the test cases in this directory instead of those in the resources next to the
+                                 benchmark, e.g. the layers captured with the --capture-slow-layers option of CuraEngine.
 )";
 
+//! What the process that generated the walls of a test case measured, sent back to the main process through a pipe.
+struct Measurement
+{
+    double wall_time_ms;
+    size_t points_in;
+    size_t points_out;
+};
+
+//! The outcome of one run of a test case.
+struct Run
+{
+    std::string name;
+    size_t threads;
+    bool crashed;
+    std::optional<Measurement> measurement; //!< Missing if the process crashed or timed out.
+    double cpu_time_ms;
+    long peak_memory_kb; //!< The maximum resident set size of the process that generated the walls.
+};
+
 struct Resource
 {
     std::filesystem::path wkt_file;
@@ -102,32 +133,17 @@ struct Resource
 
     cura::Settings settings() const
     {
-        cura::Settings settings;
         std::ifstream file{ settings_file };
         if (! file)
         {
             spdlog::error("Could not read settings from: {}", settings_file.string());
         }
-
-        std::string line;
-        while (std::getline(file, line))
-        {
-            std::istringstream iss(line);
-            std::string key;
-            std::string value;
-
-            if (std::getline(std::getline(iss, key, '='), value))
-            {
-                settings.add(key, value);
-            }
-        }
-        return settings;
+        return cura::SlowLayerCapture::readSettings(file);
     }
 };
 
-std::vector<Resource> getResources()
+std::vector<Resource> getResources(const std::filesystem::path& resource_path)
 {
-    auto resource_path = std::filesystem::path(std::source_location::current().file_name()).parent_path().append("resources");
 
     std::vector<Resource> resources;
     for (const auto& p : std::filesystem::recursive_directory_iterator(resource_path))
@@ -143,24 +159,110 @@ std::vector<Resource> getResources()
     return resources;
 }
 
-void handleChildProcess(const auto& shapes, const auto& settings)
+void handleChildProcess(const auto& shapes, const auto& settings, const size_t thread_count, const int result_fd)
 {
+    cura::Application::getInstance().startThreadPool(static_cast<int>(thread_count));
+
+    Measurement measurement{ .wall_time_ms = 0.0, .points_in = 0, .points_out = 0 };
     cura::SliceLayer layer;
     for (const cura::Shape& shape : shapes)
     {
         layer.parts.emplace_back();
         cura::SliceLayerPart& part = layer.parts.back();
         part.outline.push_back(shape);
+        measurement.points_in += shape.pointCount();
     }
     cura::LayerIndex layer_idx(100);
     cura::WallsComputation walls_computation(settings, layer_idx);
+
+    const auto start = std::chrono::steady_clock::now();
     walls_computation.generateWalls(&layer, cura::SectionType::WALL);
+    measurement.wall_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    for (const cura::SliceLayerPart& part : layer.parts)
+    {
+        for (const cura::VariableWidthLines& inset : part.wall_toolpaths)
+        {
+            for (const cura::ExtrusionLine& line : inset)
+            {
+                measurement.points_out += line.size();
+            }
+        }
+    }
+    if (write(result_fd, &measurement, sizeof(measurement)) != sizeof(measurement))
+    {
+        spdlog::error("Failed to send the measurements to the main process");
+    }
     exit(EXIT_SUCCESS);
 }
 
-size_t checkCrashCount(size_t crashCount, int status, const auto& resource)
+/*!
+ * Generate the walls of a test case in a separate process, so that a crash or a hang doesn't stop the benchmark.
+ * \return The run, or nothing if a process couldn't be started.
+ */
+std::optional<Run> runTestCase(const Resource& resource, const std::vector<cura::Shape>& shapes, const cura::Settings& settings, const size_t thread_count)
+{
+    int result_pipe[2];
+    if (pipe(result_pipe) == -1)
+    {
+        spdlog::critical("Unable to create a pipe");
+        return std::nullopt;
+    }
+
+    pid_t engine_pid = fork();
+    if (engine_pid == -1)
+    {
+        spdlog::critical("Unable to fork - engine");
+        return std::nullopt;
+    }
+    if (engine_pid == 0)
+    {
+        close(result_pipe[0]);
+        handleChildProcess(shapes, settings, thread_count, result_pipe[1]);
+    }
+    close(result_pipe[1]);
+
+    pid_t waiter_pid = fork();
+    if (waiter_pid == -1)
+    {
+        spdlog::critical("Unable to fork - waiter");
+        kill(engine_pid, SIGKILL);
+        waitpid(engine_pid, nullptr, 0);
+        close(result_pipe[0]);
+        return std::nullopt;
+    }
+    if (waiter_pid == 0)
+    {
+        sleep(30);
+        kill(engine_pid, SIGKILL);
+        exit(EXIT_SUCCESS);
+    }
+
+    int status;
+    rusage usage{};
+    wait4(engine_pid, &status, 0, &usage);
+    // The waiter isn't needed anymore once the engine is done, so it can't kill an unrelated process that got the same pid later.
+    kill(waiter_pid, SIGKILL);
+    waitpid(waiter_pid, nullptr, 0);
+
+    Run run{ .name = resource.stem(),
+             .threads = thread_count,
+             .crashed = WIFSIGNALED(status),
+             .measurement = std::nullopt,
+             .cpu_time_ms = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0,
+             .peak_memory_kb = usage.ru_maxrss };
+    Measurement measurement;
+    if (! run.crashed && read(result_pipe[0], &measurement, sizeof(measurement)) == sizeof(measurement))
+    {
+        run.measurement = measurement;
+    }
+    close(result_pipe[0]);
+    return run;
+}
+
+size_t checkCrashCount(size_t crashCount, const bool crashed, const auto& resource)
 {
-    if (WIFSIGNALED(status))
+    if (crashed)
     {
         ++crashCount;
         spdlog::error("# Crash detected for: {}", resource.stem());
@@ -217,15 +319,108 @@ void createAndWriteJson(const std::filesystem::path& out_file, double stress_lev
     file.close();
 }
 
+/*!
+ * Write the runs in the Json format of Google Benchmark, with the points and the peak memory as counters.
+ */
+void writeBenchmarkJson(const std::filesystem::path& out_file, const std::vector<Run>& runs, const std::string& executable)
+{
+    rapidjson::Document doc;
+    doc.SetObject();
+    rapidjson::Document::AllocatorType& allocator = doc.GetAllocator();
+
+    const auto add_string = [&allocator](rapidjson::Value& object, const char* key, const std::string& value)
+    {
+        object.AddMember(rapidjson::Value(key, allocator), rapidjson::Value(value.c_str(), value.length(), allocator), allocator);
+    };
+
+    rapidjson::Value context(rapidjson::kObjectType);
+    const std::time_t now = std::time(nullptr);
+    std::tm local_now{};
+    localtime_r(&now, &local_now);
+    char date[32];
+    std::strftime(date, sizeof(date), "%FT%T%z", &local_now);
+    add_string(context, "date", date);
+    char host_name[256] = "";
+    gethostname(host_name, sizeof(host_name) - 1);
+    add_string(context, "host_name", host_name);
+    add_string(context, "executable", executable);
+    context.AddMember("num_cpus", std::thread::hardware_concurrency(), allocator);
+#ifdef NDEBUG
+    add_string(context, "library_build_type", "release");
+#else
+    add_string(context, "library_build_type", "debug");
+#endif
+    doc.AddMember("context", context, allocator);
+
+    rapidjson::Value benchmarks(rapidjson::kArrayType);
+    std::map<std::string, size_t> family_indices;
+    std::map<std::string, size_t> instance_counts;
+    for (const Run& run : runs)
+    {
+        if (! run.measurement)
+        {
+            continue; // Google Benchmark has no results for runs that fail either.
+        }
+        const std::string family_name = fmt::format("generateWalls/{}", run.name);
+        const std::string name = fmt::format("{}/threads:{}", family_name, run.threads);
+        const size_t family_index = family_indices.emplace(family_name, family_indices.size()).first->second;
+
+        rapidjson::Value benchmark(rapidjson::kObjectType);
+        add_string(benchmark, "name", name);
+        benchmark.AddMember("family_index", family_index, allocator);
+        benchmark.AddMember("per_family_instance_index", instance_counts[family_name]++, allocator);
+        add_string(benchmark, "run_name", name);
+        add_string(benchmark, "run_type", "iteration");
+        benchmark.AddMember("repetitions", 1, allocator);
+        benchmark.AddMember("repetition_index", 0, allocator);
+        benchmark.AddMember("threads", run.threads, allocator);
+        benchmark.AddMember("iterations", 1, allocator);
+        benchmark.AddMember("real_time", run.measurement->wall_time_ms, allocator);
+        benchmark.AddMember("cpu_time", run.cpu_time_ms, allocator);
+        add_string(benchmark, "time_unit", "ms");
+        benchmark.AddMember("points_in", run.measurement->points_in, allocator);
+        benchmark.AddMember("points_out", run.measurement->points_out, allocator);
+        benchmark.AddMember("peak_memory_kb", static_cast<int64_t>(run.peak_memory_kb), allocator);
+        benchmarks.PushBack(benchmark, allocator);
+    }
+    doc.AddMember("benchmarks", benchmarks, allocator);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    doc.Accept(writer);
+
+    spdlog::info("Writing benchmark results: {}", std::filesystem::absolute(out_file).string());
+    std::ofstream file{ out_file };
+    if (! file)
+    {
+        spdlog::critical("Failed to open the file: {}", out_file.string());
+        exit(EXIT_FAILURE);
+    }
+    file.write(buffer.GetString(), buffer.GetSize());
+    file.close();
+}
+
 int main(int argc, const char** argv)
 {
     constexpr bool show_help = true;
     constexpr std::string_view version = "0.1.0";
     const std::map<std::string, docopt::value> args = docopt::docopt(fmt::format("{}", USAGE), { argv + 1, argv + argc }, show_help, fmt::format("{}", version));
 
-    const auto resources = getResources();
+    const bool measure_performance = static_cast<bool>(args.at("--benchmark_out"));
+    const size_t max_threads = std::max(args.at("--max_threads").asLong(), 1L);
+    std::vector<size_t> thread_counts;
+    for (size_t thread_count = 1; thread_count < max_threads; thread_count *= 2)
+    {
+        thread_counts.push_back(thread_count);
+    }
+    thread_counts.push_back(max_threads);
+
+    const std::filesystem::path resource_path = args.at("--resources") ? std::filesystem::path(args.at("--resources").asString())
+                                                                        : std::filesystem::path(std::source_location::current().file_name()).parent_path().append("resources");
+    const auto resources = getResources(resource_path);
     size_t crash_count = 0;
     std::vector<std::string> extra_infos;
+    std::vector<Run> runs;
 
     for (const auto& resource : resources)
     {
@@ -233,47 +428,47 @@ int main(int argc, const char** argv)
         const auto& settings = resource.settings();
 
         spdlog::critical("Starting test case {}", resource.stem());
-        pid_t engine_pid = fork();
-        if (engine_pid == -1)
-        {
-            spdlog::critical("Unable to fork - engine");
-            return EXIT_FAILURE;
-        }
-        else if (engine_pid == 0)
+        for (const size_t thread_count : thread_counts)
         {
-            handleChildProcess(shapes, settings);
-            return EXIT_SUCCESS;
-        }
-        else
-        {
-            pid_t waiter_pid = fork();
-            if (waiter_pid == -1)
+            const std::optional<Run> run = runTestCase(resource, shapes, settings, thread_count);
+            if (! run)
             {
-                spdlog::critical("Unable to fork - waiter");
                 return EXIT_FAILURE;
             }
-            else if (waiter_pid == 0)
+            if (thread_count == thread_counts.front())
             {
-                sleep(30);
-                kill(engine_pid, SIGKILL);
-                return EXIT_SUCCESS;
-            }
-            else
-            {
-                int status;
-                waitpid(engine_pid, &status, 0);
+                // The stress level only counts the crashes of the first run, so that it doesn't depend on the number of thread counts.
                 const auto old_crash_count = crash_count;
-                crash_count = checkCrashCount(crash_count, status, resource);
+                crash_count = checkCrashCount(crash_count, run->crashed, resource);
                 if (old_crash_count != crash_count)
                 {
                     extra_infos.emplace_back(resource.stem());
                 }
             }
+            if (run->measurement)
+            {
+                spdlog::info(
+                    "  {} threads: {:.2f} ms, {} points in, {} points out, {} kB peak memory",
+                    thread_count,
+                    run->measurement->wall_time_ms,
+                    run->measurement->points_in,
+                    run->measurement->points_out,
+                    run->peak_memory_kb);
+            }
+            runs.push_back(*run);
+            if (! measure_performance)
+            {
+                break; // Only the stress level is needed, for which one run is enough.
+            }
         }
     }
     const double stress_level = static_cast<double>(crash_count) / static_cast<double>(resources.size()) * 100.0;
     spdlog::info("Stress level: {:.2f} [%]", stress_level);
 
     createAndWriteJson(std::filesystem::path{ args.at("-o").asString() }, stress_level, fmt::format("Crashes in: {}", fmt::join(extra_infos, ", ")), resources.size());
+    if (measure_performance)
+    {
+        writeBenchmarkJson(std::filesystem::path{ args.at("--benchmark_out").asString() }, runs, argv[0]);
+    }
     return EXIT_SUCCESS;
 }
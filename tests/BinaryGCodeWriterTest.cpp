@@ -0,0 +1,184 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "BinaryGCodeWriter.h" //The unit under test.
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+/*
+ * Decompress a heatshrink bit stream, the way printers do.
+ */
+std::string decompressHeatshrink(const std::string& compressed, const uint8_t window_bits, const uint8_t lookahead_bits)
+{
+    std::string result;
+    size_t bit_pos = 0;
+    bool ran_out = false;
+    const auto read = [&](const uint8_t bit_count)
+    {
+        uint32_t value = 0;
+        for (uint8_t i = 0; i < bit_count; i++)
+        {
+            if (bit_pos >= compressed.size() * 8)
+            {
+                ran_out = true;
+                return value;
+            }
+            value = (value << 1) | ((static_cast<uint8_t>(compressed[bit_pos / 8]) >> (7 - bit_pos % 8)) & 1);
+            bit_pos++;
+        }
+        return value;
+    };
+    while (true)
+    {
+        const bool is_literal = read(1);
+        const uint32_t literal_or_index = read(is_literal ? 8 : window_bits);
+        const uint32_t count = is_literal ? 0 : read(lookahead_bits);
+        if (ran_out)
+        {
+            return result;
+        }
+        if (is_literal)
+        {
+            result.push_back(static_cast<char>(literal_or_index));
+            continue;
+        }
+        const size_t distance = literal_or_index + 1;
+        EXPECT_LE(distance, result.size()) << "Back-references may not point before the start of the block.";
+        if (distance > result.size())
+        {
+            return result;
+        }
+        for (uint32_t i = 0; i <= count; i++)
+        {
+            result.push_back(result[result.size() - distance]);
+        }
+    }
+}
+
+std::string someGCode(const size_t line_count)
+{
+    std::ostringstream gcode;
+    for (size_t line = 0; line < line_count; line++)
+    {
+        gcode << "G1 X" << (line * 37) % 200 << "." << (line * 7) % 1000 << " Y" << (line * 53) % 200 << "." << (line * 11) % 100 << " E" << line << ".12345\n";
+        if (line % 100 == 0)
+        {
+            gcode << ";LAYER:" << line / 100 << "\n";
+        }
+    }
+    return gcode.str();
+}
+
+uint16_t readUInt16(const std::string& data, const size_t pos)
+{
+    uint16_t value;
+    std::memcpy(&value, data.data() + pos, sizeof(value)); // The format is little-endian, like the machines that run the tests.
+    return value;
+}
+
+uint32_t readUInt32(const std::string& data, const size_t pos)
+{
+    uint32_t value;
+    std::memcpy(&value, data.data() + pos, sizeof(value));
+    return value;
+}
+
+TEST(BinaryGCodeWriterTest, Crc32)
+{
+    EXPECT_EQ(BinaryGCodeWriter::crc32("123456789"), 0xCBF43926) << "The standard check value of CRC-32.";
+    EXPECT_EQ(BinaryGCodeWriter::crc32("6789", BinaryGCodeWriter::crc32("12345")), 0xCBF43926) << "The checksum can be computed in parts.";
+}
+
+TEST(BinaryGCodeWriterTest, HeatshrinkRoundTrip)
+{
+    const std::string gcode = someGCode(1000);
+    for (const uint8_t window_bits : { 11, 12 })
+    {
+        const std::string compressed = BinaryGCodeWriter::compressHeatshrink(gcode, window_bits, 4);
+        EXPECT_LT(compressed.size(), gcode.size() / 2) << "G-code is very repetitive, so it should compress well.";
+        EXPECT_EQ(decompressHeatshrink(compressed, window_bits, 4), gcode);
+    }
+
+    const std::string runs(1000, 'a');
+    EXPECT_EQ(decompressHeatshrink(BinaryGCodeWriter::compressHeatshrink(runs, 12, 4), 12, 4), runs) << "Back-references may overlap what they produce.";
+    EXPECT_EQ(decompressHeatshrink(BinaryGCodeWriter::compressHeatshrink("", 12, 4), 12, 4), "");
+}
+
+TEST(BinaryGCodeWriterTest, FileLayout)
+{
+    const std::string gcode = someGCode(5000); // Enough for several blocks.
+    std::ostringstream file_stream;
+    {
+        BinaryGCodeWriter writer(file_stream, BinaryGCodeWriter::Compression::HEATSHRINK_12_4);
+        std::ostream gcode_stream(&writer);
+        gcode_stream << gcode;
+        gcode_stream.flush();
+        EXPECT_TRUE(file_stream.str().empty()) << "Nothing should be written before the metadata is known.";
+        writer.finish({ { "printer_model", "Test" } }, { { "print_time", "123" } }, { { "generator", "test" } });
+    }
+    const std::string file = file_stream.str();
+
+    ASSERT_GE(file.size(), 10);
+    EXPECT_EQ(file.substr(0, 4), "GCDE");
+    EXPECT_EQ(readUInt32(file, 4), 1) << "Version.";
+    EXPECT_EQ(readUInt16(file, 8), 1) << "CRC-32 checksums.";
+
+    std::vector<BinaryGCodeWriter::BlockType> block_types;
+    std::vector<std::string> block_contents;
+    size_t pos = 10;
+    while (pos < file.size())
+    {
+        const auto type = static_cast<BinaryGCodeWriter::BlockType>(readUInt16(file, pos));
+        const auto compression = static_cast<BinaryGCodeWriter::Compression>(readUInt16(file, pos + 2));
+        const uint32_t uncompressed_size = readUInt32(file, pos + 4);
+        const size_t header_size = compression == BinaryGCodeWriter::Compression::NONE ? 8 : 12;
+        const uint32_t stored_size = compression == BinaryGCodeWriter::Compression::NONE ? uncompressed_size : readUInt32(file, pos + 8);
+        const size_t parameters_size = 2;
+        ASSERT_LE(pos + header_size + parameters_size + stored_size + 4, file.size());
+
+        EXPECT_EQ(readUInt16(file, pos + header_size), 0) << "INI metadata and plain text g-code.";
+        const std::string stored = file.substr(pos + header_size + parameters_size, stored_size);
+        const uint32_t checksum = readUInt32(file, pos + header_size + parameters_size + stored_size);
+        EXPECT_EQ(checksum, BinaryGCodeWriter::crc32(std::string_view(file).substr(pos, header_size + parameters_size + stored_size)));
+
+        std::string content = stored;
+        if (compression != BinaryGCodeWriter::Compression::NONE)
+        {
+            EXPECT_EQ(compression, BinaryGCodeWriter::Compression::HEATSHRINK_12_4);
+            content = decompressHeatshrink(stored, 12, 4);
+        }
+        EXPECT_EQ(content.size(), uncompressed_size);
+        EXPECT_LE(content.size(), BinaryGCodeWriter::max_block_size);
+        block_types.push_back(type);
+        block_contents.push_back(content);
+        pos += header_size + parameters_size + stored_size + 4;
+    }
+
+    ASSERT_GT(block_types.size(), 4) << "The g-code should be split into several blocks.";
+    EXPECT_EQ(block_types[0], BinaryGCodeWriter::BlockType::PRINTER_METADATA);
+    EXPECT_EQ(block_contents[0], "printer_model=Test\n");
+    EXPECT_EQ(block_types[1], BinaryGCodeWriter::BlockType::PRINT_METADATA);
+    EXPECT_EQ(block_contents[1], "print_time=123\n");
+    EXPECT_EQ(block_types[2], BinaryGCodeWriter::BlockType::SLICER_METADATA);
+    EXPECT_EQ(block_contents[2], "generator=test\n");
+
+    std::string decoded_gcode;
+    for (size_t block = 3; block < block_types.size(); block++)
+    {
+        EXPECT_EQ(block_types[block], BinaryGCodeWriter::BlockType::GCODE);
+        EXPECT_EQ(block_contents[block].back(), '\n') << "Blocks should be split at line ends.";
+        decoded_gcode += block_contents[block];
+    }
+    EXPECT_EQ(decoded_gcode, gcode);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
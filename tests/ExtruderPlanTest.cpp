@@ -471,6 +471,31 @@ TEST_P(ExtruderPlanPathsParameterizedTest, BackPressureCompensationHalf)
     }
 }
 
+/*!
+ * Tests that precomputing the time estimates of the paths that don't depend on
+ * the starting position gives the same estimates as computing them all at
+ * once.
+ */
+TEST_P(ExtruderPlanPathsParameterizedTest, PrecomputedTimeEstimatesMatch)
+{
+    extruder_plan.paths_ = GetParam();
+    ExtruderPlan precomputed_plan = extruder_plan;
+    const Point2LL starting_position(-500, 2000);
+
+    const TimeMaterialEstimates expected = extruder_plan.computeNaiveTimeEstimates(starting_position);
+    precomputed_plan.precomputeNaiveTimeEstimates();
+    const TimeMaterialEstimates result = precomputed_plan.computeNaiveTimeEstimates(starting_position);
+
+    EXPECT_EQ(result.extrude_time, expected.extrude_time) << "The estimates are computed in the same order, so they must be exactly the same.";
+    EXPECT_EQ(result.unretracted_travel_time, expected.unretracted_travel_time);
+    EXPECT_EQ(result.material, expected.material);
+    ASSERT_EQ(precomputed_plan.paths_.size(), extruder_plan.paths_.size());
+    for (size_t path_idx = 0; path_idx < extruder_plan.paths_.size(); path_idx++)
+    {
+        EXPECT_EQ(precomputed_plan.paths_[path_idx].estimates.extrude_time, extruder_plan.paths_[path_idx].estimates.extrude_time) << "Path " << path_idx << " differs.";
+    }
+}
+
 /*!
  * Tests back pressure compensation on an extruder plan that is completely
  * empty.
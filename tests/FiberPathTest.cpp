@@ -0,0 +1,258 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "fiberpath.h"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numbers>
+
+#include <gtest/gtest.h>
+
+#include "Application.h" // To simplify the layers on the thread pool.
+#include "geometry/OpenLinesSet.h"
+#include "geometry/OpenPolyline.h"
+#include "geometry/Shape.h"
+#include "utils/Point3D.h"
+
+namespace cura
+{
+// NOLINTBEGIN(*-magic-numbers)
+class FiberPathsTest : public testing::Test
+{
+public:
+    FiberPaths fiber_paths;
+
+    void SetUp() override
+    {
+        // Deliberately out of order, to test the sorting.
+        for (const coord_t z : { 600, 200, 1000, 400, 800 })
+        {
+            fiber_paths.paths.emplace_back(z);
+        }
+    }
+};
+
+TEST_F(FiberPathsTest, SortBuildsIndex)
+{
+    fiber_paths.sort();
+
+    ASSERT_TRUE(fiber_paths.sorted);
+    ASSERT_EQ(fiber_paths.z_index.size(), fiber_paths.paths.size());
+    for (size_t i = 0; i < fiber_paths.paths.size(); i++)
+    {
+        EXPECT_EQ(fiber_paths.z_index[i], fiber_paths.paths[i].z_) << "The index must follow the order of the paths.";
+        if (i > 0)
+        {
+            EXPECT_LT(fiber_paths.z_index[i - 1], fiber_paths.z_index[i]) << "The paths must be sorted on z.";
+        }
+    }
+}
+
+TEST_F(FiberPathsTest, GetFiberPathNearest)
+{
+    FiberPath* exact = fiber_paths.getFiberPath(400);
+    ASSERT_NE(exact, nullptr);
+    EXPECT_EQ(exact->z_, 400);
+
+    FiberPath* below = fiber_paths.getFiberPath(450, 100);
+    ASSERT_NE(below, nullptr);
+    EXPECT_EQ(below->z_, 400) << "450 is closer to 400 than to 600.";
+
+    FiberPath* above = fiber_paths.getFiberPath(570, 100);
+    ASSERT_NE(above, nullptr);
+    EXPECT_EQ(above->z_, 600) << "570 is closer to 600 than to 400.";
+
+    FiberPath* top = fiber_paths.getFiberPath(1050, 100);
+    ASSERT_NE(top, nullptr);
+    EXPECT_EQ(top->z_, 1000);
+
+    EXPECT_EQ(fiber_paths.getFiberPath(500, 50), nullptr) << "There is no fiber layer within 50 of 500.";
+    EXPECT_EQ(fiber_paths.getFiberPath(0, 100), nullptr) << "There is no fiber layer within 100 of 0.";
+}
+
+TEST_F(FiberPathsTest, GetFiberPathRange)
+{
+    const auto [first, last] = fiber_paths.getFiberPathRange(500, 150);
+    ASSERT_EQ(last - first, 2);
+    EXPECT_EQ(fiber_paths.paths[first].z_, 400);
+    EXPECT_EQ(fiber_paths.paths[first + 1].z_, 600);
+
+    const auto [empty_first, empty_last] = fiber_paths.getFiberPathRange(500, 100);
+    EXPECT_EQ(empty_first, empty_last) << "The range excludes fiber layers exactly at the tolerance.";
+}
+
+TEST_F(FiberPathsTest, ResortAfterModification)
+{
+    fiber_paths.sort();
+    fiber_paths.paths.emplace_back(300);
+    fiber_paths.sorted = false;
+
+    FiberPath* added = fiber_paths.getFiberPath(300);
+    ASSERT_NE(added, nullptr);
+    EXPECT_EQ(added->z_, 300);
+    EXPECT_EQ(fiber_paths.z_index.size(), 6);
+}
+TEST(FiberPathTest, TransformMatchesMatrix)
+{
+    // A rotation of 30 degrees around the z axis, with a translation.
+    Matrix4x3D matrix;
+    matrix.m[0][0] = std::cos(std::numbers::pi / 6);
+    matrix.m[1][0] = -std::sin(std::numbers::pi / 6);
+    matrix.m[0][1] = std::sin(std::numbers::pi / 6);
+    matrix.m[1][1] = std::cos(std::numbers::pi / 6);
+    matrix.m[3][0] = 12.5;
+    matrix.m[3][1] = -3.25;
+
+    FiberPath path(1200);
+    OpenPolyline polyline;
+    for (coord_t i = 0; i < 1000; i++) // More than one block of the batched transformation.
+    {
+        polyline.emplace_back(i * 137 - 50000, (i * i) % 70001 - 35000);
+    }
+    path.paths.push_back(polyline);
+
+    path.transform(matrix);
+
+    ASSERT_EQ(path.z_, 1200);
+    ASSERT_EQ(path.paths[0].size(), polyline.size());
+    for (size_t point_idx = 0; point_idx < polyline.size(); point_idx++)
+    {
+        const Point2LL& original = polyline[point_idx];
+        const Point3LL expected = matrix.apply(Point3D(INT2MM(original.X), INT2MM(original.Y), INT2MM(1200)));
+        EXPECT_EQ(path.paths[0][point_idx].X, expected.x_);
+        EXPECT_EQ(path.paths[0][point_idx].Y, expected.y_);
+    }
+}
+
+TEST(FiberPathTest, SimplifyRemovesDensePoints)
+{
+    Application::getInstance().startThreadPool();
+    // A corner with a point every 5 micron, much closer together than a printer can resolve.
+    OpenPolyline fiber;
+    for (coord_t x = 0; x < 10000; x += 5)
+    {
+        fiber.emplace_back(x, 0);
+    }
+    for (coord_t y = 0; y <= 10000; y += 5)
+    {
+        fiber.emplace_back(10000, y);
+    }
+    FiberPaths fiber_paths;
+    fiber_paths.paths.emplace_back(200).paths.push_back(fiber);
+    fiber_paths.paths.emplace_back(400).paths.push_back(fiber);
+
+    fiber_paths.simplify(0, 0, 0);
+    EXPECT_EQ(fiber_paths.paths[0].paths[0].size(), fiber.size()) << "A resolution of 0 keeps all points.";
+
+    fiber_paths.simplify(10, 2, 50);
+    for (const FiberPath& path : fiber_paths.paths)
+    {
+        ASSERT_EQ(path.paths.size(), 1);
+        const OpenPolyline& simplified = path.paths[0];
+        ASSERT_EQ(simplified.size(), 3) << "Only the ends and the corner are needed.";
+        EXPECT_EQ(simplified.front(), fiber.front());
+        EXPECT_EQ(simplified[1], Point2LL(10000, 0));
+        EXPECT_EQ(simplified.back(), fiber.back());
+    }
+}
+
+TEST(FiberPathBinaryFileTest, RoundTrip)
+{
+    FiberPaths original;
+    FiberPath& top = original.paths.emplace_back(400);
+    top.paths.push_back(OpenPolyline({ Point2LL(0, 0), Point2LL(1000, 0), Point2LL(1000, 1000) }));
+    FiberPath& bottom = original.paths.emplace_back(200);
+    bottom.paths.push_back(OpenPolyline({ Point2LL(-500, 20), Point2LL(300, 40) }));
+    bottom.paths.push_back(OpenPolyline({ Point2LL(10, 10), Point2LL(20, 20), Point2LL(30, 10), Point2LL(40, 20) }));
+
+    const std::string filename = (std::filesystem::temp_directory_path() / "FiberPathBinaryFileTest.fpb").string();
+    ASSERT_TRUE(FiberPathBinaryFile::write(original, filename));
+
+    std::shared_ptr<FiberPathBinaryFile> file = FiberPathBinaryFile::open(filename);
+    ASSERT_NE(file, nullptr);
+    FiberPaths loaded;
+    FiberPathBinaryFile::addTo(file, loaded);
+    ASSERT_EQ(loaded.paths.size(), original.paths.size());
+
+    for (size_t path_idx = 0; path_idx < loaded.paths.size(); path_idx++)
+    {
+        EXPECT_FALSE(loaded.paths[path_idx].loaded_) << "Layers of a binary file are only decoded when requested.";
+        EXPECT_EQ(loaded.paths[path_idx].z_, original.paths[path_idx].z_);
+
+        const AABB expected_box = original.getBoundingBox(path_idx);
+        const AABB box = loaded.getBoundingBox(path_idx);
+        EXPECT_EQ(box.min_, expected_box.min_);
+        EXPECT_EQ(box.max_, expected_box.max_);
+
+        OpenLinesSet decoded;
+        const OpenLinesSet& polylines = loaded.getPolylines(path_idx, decoded);
+        ASSERT_EQ(polylines.size(), original.paths[path_idx].paths.size());
+        for (size_t polyline_idx = 0; polyline_idx < polylines.size(); polyline_idx++)
+        {
+            EXPECT_EQ(polylines[polyline_idx].getPoints(), original.paths[path_idx].paths[polyline_idx].getPoints());
+        }
+    }
+
+    file.reset();
+    loaded.source.reset();
+    std::filesystem::remove(filename);
+}
+
+TEST(FiberPathBinaryFileTest, RejectsTextFile)
+{
+    const std::string filename = (std::filesystem::temp_directory_path() / "FiberPathBinaryFileTest.txt").string();
+    {
+        std::ofstream out(filename);
+        out << "0.0 0.0 0.2 0\n1.0 0.0 0.2 0\n";
+    }
+    EXPECT_EQ(FiberPathBinaryFile::open(filename), nullptr);
+    std::filesystem::remove(filename);
+}
+
+TEST(FiberCutTest, KeepsPiecesWhole)
+{
+    Shape square;
+    square.emplace_back(ClipperLib::Path{ { 0, 0 }, { 10000, 0 }, { 10000, 10000 }, { 0, 10000 } });
+    // Leaves the square in the middle and comes back in, with collinear points in between.
+    OpenPolyline fiber(ClipperLib::Path{ { 1000, 1000 }, { 3000, 1000 }, { 5000, 1000 }, { 5000, 12000 }, { 6000, 12000 }, { 6000, 2000 }, { 7000, 2000 }, { 9000, 2000 } });
+
+    const OpenLinesSet pieces = OpenLinesSet(fiber).fiberCut(square);
+
+    ASSERT_EQ(pieces.size(), 2) << "The fiber must only be cut where it crosses the border.";
+    EXPECT_EQ(pieces.length(), OpenLinesSet(fiber).lineCut(square).length()) << "All of the fiber inside the square must be kept.";
+}
+
+TEST(FiberCutTest, DoesNotJoinDifferentFibers)
+{
+    Shape square;
+    square.emplace_back(ClipperLib::Path{ { 0, 0 }, { 10000, 0 }, { 10000, 10000 }, { 0, 10000 } });
+    OpenLinesSet fibers;
+    fibers.push_back(OpenPolyline(ClipperLib::Path{ { 1000, 1000 }, { 5000, 1000 } }));
+    fibers.push_back(OpenPolyline(ClipperLib::Path{ { 5000, 1000 }, { 9000, 1000 } }));
+
+    const OpenLinesSet pieces = fibers.fiberCut(square);
+
+    EXPECT_EQ(pieces.size(), 2) << "Fibers that end where another starts must stay separate fibers.";
+}
+
+TEST(FiberCutTest, KeepsDirectionAndOrder)
+{
+    Shape squares;
+    squares.emplace_back(ClipperLib::Path{ { 0, 0 }, { 4000, 0 }, { 4000, 4000 }, { 0, 4000 } });
+    squares.emplace_back(ClipperLib::Path{ { 6000, 0 }, { 10000, 0 }, { 10000, 4000 }, { 6000, 4000 } });
+    squares.emplace_back(ClipperLib::Path{ { 50000, 50000 }, { 60000, 50000 }, { 60000, 60000 }, { 50000, 60000 } }); // Far away from the fiber.
+    // Runs from right to left through both squares near the fiber.
+    OpenPolyline fiber(ClipperLib::Path{ { 11000, 2000 }, { 8000, 2000 }, { 5000, 2000 }, { 2000, 2000 }, { 1000, 2000 } });
+
+    const OpenLinesSet pieces = OpenLinesSet(fiber).fiberCut(squares);
+
+    ASSERT_EQ(pieces.size(), 2);
+    EXPECT_EQ(pieces[0].front(), Point2LL(10000, 2000)) << "The piece that the fiber reaches first must come first.";
+    EXPECT_EQ(pieces[0].back(), Point2LL(6000, 2000));
+    EXPECT_EQ(pieces[1].front(), Point2LL(4000, 2000)) << "The pieces must run in the direction of the fiber.";
+    EXPECT_EQ(pieces[1].back(), Point2LL(1000, 2000));
+}
+// NOLINTEND(*-magic-numbers)
+} // namespace cura
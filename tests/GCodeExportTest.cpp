@@ -70,6 +70,7 @@ public:
         // Set up a scene so that we may request settings.
         Application::getInstance().current_slice_ = new Slice(1);
         mock_communication = new MockCommunication();
+        ON_CALL(*mock_communication, wantsLayerView()).WillByDefault(testing::Return(true));
         Application::getInstance().communication_ = mock_communication;
     }
 
@@ -124,6 +125,29 @@ TEST_F(GCodeExportTest, CommentMultiple)
         << "Semicolon before each line, and newline in between.";
 }
 
+TEST_F(GCodeExportTest, CommentNonAscii)
+{
+    gcode.writeComment("MESH:Kn\xC3\xB6" "del");
+    EXPECT_EQ(std::string(";MESH:Kn??del\n"), output.str()) << "Characters that aren't ASCII must be replaced.";
+}
+
+TEST_F(GCodeExportTest, CommentMinimal)
+{
+    gcode.writeDetailComment("BRIDGE");
+    gcode.writeTypeComment(PrintFeatureType::Infill);
+    EXPECT_EQ(std::string(";BRIDGE\n;TYPE:FILL\n"), output.str());
+    output.str("");
+
+    gcode.minimal_comments_ = true;
+    gcode.writeDetailComment("BRIDGE");
+    gcode.writeTypeComment(PrintFeatureType::Infill);
+    EXPECT_EQ(std::string(""), output.str()) << "Minimal comments leave out the comments that are only there for people.";
+    gcode.writeComment("FINAL_HEADER");
+    gcode.writeLayerComment(3);
+    gcode.writeTimeComment(5);
+    EXPECT_EQ(std::string(";FINAL_HEADER\n;LAYER:3\n;TIME_ELAPSED:5.000000\n"), output.str()) << "Other comments are still written.";
+}
+
 TEST_F(GCodeExportTest, CommentTimeZero)
 {
     gcode.writeTimeComment(0);
@@ -538,6 +562,25 @@ TEST_F(GCodeExportTest, WriteZHopEndCustomSpeed)
     EXPECT_EQ(std::string("G1 F240 Z2\n"), output.str()) << "Custom provided speed should be used.";
 }
 
+TEST_F(GCodeExportTest, WriteArcExtrusion)
+{
+    gcode.current_position_ = Point3LL(10000, 0, 0);
+    gcode.is_volumetric_ = true;
+    gcode.max_extrusion_offset_ = 0;
+    gcode.extrusion_offset_factor_ = 0;
+
+    gcode.writeArcExtrusion(Point2LL(0, 10000), Point2LL(0, 0), true, Velocity(50.0), 1.0, PrintFeatureType::OuterWall);
+    EXPECT_EQ(std::string("G3 F3000 X0.00 Y10 I-10 J0.00 E15.70796\n"), output.str()) << "The extruded amount follows the length of the arc, not of the chord.";
+    EXPECT_EQ(gcode.current_position_, Point3LL(0, 10000, 0));
+    EXPECT_EQ(gcode.total_bounding_box_.max_.x_, 10000);
+    EXPECT_EQ(gcode.total_bounding_box_.max_.y_, 10000);
+
+    output.str("");
+    gcode.writeArcExtrusion(Point2LL(-10000, 0), Point2LL(0, 0), false, Velocity(50.0), 1.0, PrintFeatureType::OuterWall);
+    EXPECT_EQ(std::string("G2 X-10 Y0.00 I0.00 J-10 E62.83185\n"), output.str()) << "Going clockwise from the top to the left is three quarters of a circle.";
+    EXPECT_EQ(gcode.total_bounding_box_.min_.y_, -10000) << "The arc bulges out below its ends.";
+}
+
 TEST_F(GCodeExportTest, insertWipeScriptSingleMove)
 {
     gcode.current_position_ = Point3LL(1000, 1000, 1000);
@@ -570,6 +613,32 @@ TEST_F(GCodeExportTest, insertWipeScriptSingleMove)
     EXPECT_EQ(std::string(";WIPE_SCRIPT_END"), token) << "Wipe script should always end with tag.";
 }
 
+TEST_F(GCodeExportTest, insertWipeScriptWithoutLayerView)
+{
+    gcode.current_position_ = Point3LL(1000, 1000, 1000);
+    gcode.current_layer_z_ = 1000;
+    gcode.use_extruder_offset_to_offset_coords_ = false;
+
+    WipeScriptConfig config;
+    config.retraction_enable = false;
+    config.hop_enable = false;
+    config.brush_pos_x = 2000;
+    config.repeat_count = 1;
+    config.move_distance = 500;
+    config.move_speed = 10.0;
+    config.pause = 0;
+
+    ON_CALL(*mock_communication, wantsLayerView()).WillByDefault(testing::Return(false));
+    EXPECT_CALL(*mock_communication, sendLineTo(testing::_, testing::_, testing::_, testing::_, testing::_)).Times(0);
+    gcode.insertWipeScript(config); // Doesn't need the layer height either, since nothing is sent to the layer view.
+
+    std::string token;
+    std::getline(output, token, '\n');
+    EXPECT_EQ(std::string(";WIPE_SCRIPT_BEGIN"), token);
+    std::getline(output, token, '\n');
+    EXPECT_EQ(std::string("G0 F600 X2 Y1"), token) << "The g-code is the same without the layer view.";
+}
+
 TEST_F(GCodeExportTest, insertWipeScriptMultipleMoves)
 {
     gcode.current_position_ = Point3LL(1000, 1000, 1000);
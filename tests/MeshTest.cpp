@@ -0,0 +1,272 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "mesh.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include "Application.h"
+#include "MeshGroup.h"
+
+namespace cura
+{
+// NOLINTBEGIN(*-magic-numbers)
+class MeshTest : public testing::Test
+{
+public:
+    Mesh mesh;
+
+    void SetUp() override
+    {
+        Application::getInstance().startThreadPool();
+    }
+};
+
+TEST_F(MeshTest, WeldsNearbyCorners)
+{
+    // Two triangles sharing an edge, where the shared corners of the second one are slightly off.
+    Point3LL a(0, 0, 0);
+    Point3LL b(10000, 0, 0);
+    Point3LL c(0, 10000, 0);
+    Point3LL b_near(10003, 2, 0);
+    Point3LL c_near(1, 9998, 0);
+    Point3LL d(10000, 10000, 0);
+    mesh.addFace(a, b, c);
+    mesh.addFace(c_near, b_near, d);
+    mesh.finish();
+
+    ASSERT_EQ(mesh.vertices_.size(), 4);
+    ASSERT_EQ(mesh.faces_.size(), 2);
+    EXPECT_EQ(mesh.vertices_[0].p_, a);
+    EXPECT_EQ(mesh.vertices_[1].p_, b);
+    EXPECT_EQ(mesh.vertices_[2].p_, c);
+    EXPECT_EQ(mesh.vertices_[3].p_, d);
+    EXPECT_EQ(mesh.faces_[1].vertex_index_[0], 2);
+    EXPECT_EQ(mesh.faces_[1].vertex_index_[1], 1);
+    EXPECT_EQ(mesh.faces_[1].vertex_index_[2], 3);
+
+    // The faces are connected through the edge between b and c.
+    EXPECT_EQ(mesh.faces_[0].connected_face_index_[1], 1);
+    EXPECT_EQ(mesh.faces_[1].connected_face_index_[0], 0);
+    EXPECT_EQ(mesh.getAABB().max_, Point3LL(10000, 10000, 0));
+}
+
+TEST_F(MeshTest, DropsDegenerateFaces)
+{
+    Point3LL a(0, 0, 0);
+    Point3LL a_near(5, 5, 5);
+    Point3LL b(10000, 0, 0);
+    mesh.addFace(a, a_near, b);
+    mesh.finish();
+
+    EXPECT_EQ(mesh.vertices_.size(), 2);
+    EXPECT_TRUE(mesh.faces_.empty());
+}
+
+TEST_F(MeshTest, WeldsAgainstExistingVertices)
+{
+    Point3LL a(0, 0, 0);
+    Point3LL b(10000, 0, 0);
+    Point3LL c(0, 10000, 0);
+    mesh.addFace(a, b, c);
+    mesh.finish();
+
+    Point3LL d(0, 0, 10000);
+    Point3LL a_near(3, 0, 0);
+    mesh.addFace(a_near, b, d);
+    mesh.finish();
+
+    ASSERT_EQ(mesh.vertices_.size(), 4);
+    ASSERT_EQ(mesh.faces_.size(), 2);
+    EXPECT_EQ(mesh.faces_[1].vertex_index_[0], 0);
+    EXPECT_EQ(mesh.faces_[1].vertex_index_[1], 1);
+    EXPECT_EQ(mesh.faces_[1].vertex_index_[2], 3);
+}
+
+TEST_F(MeshTest, AddsIndexedFaces)
+{
+    // A square of two triangles, with a vertex that no face uses and a degenerate face.
+    const std::vector<Point3LL> vertices{ Point3LL(0, 0, 0), Point3LL(10000, 0, 0), Point3LL(10000, 10000, 0), Point3LL(0, 10000, 0), Point3LL(5, 5, 5), Point3LL(0, 0, 0) };
+    const std::vector<std::array<uint32_t, 3>> faces{ { 0, 1, 2 }, { 0, 2, 3 }, { 0, 1, 5 } };
+    mesh.addIndexedFaces(vertices, faces);
+    mesh.finish();
+
+    ASSERT_EQ(mesh.vertices_.size(), 6) << "The given vertices aren't welded.";
+    ASSERT_EQ(mesh.faces_.size(), 2) << "The face with two corners at the same location is dropped.";
+    EXPECT_EQ(mesh.faces_[1].vertex_index_[0], 0);
+    EXPECT_EQ(mesh.faces_[1].vertex_index_[1], 2);
+    EXPECT_EQ(mesh.faces_[1].vertex_index_[2], 3);
+    EXPECT_EQ(mesh.faces_[0].connected_face_index_[2], 1);
+    EXPECT_EQ(mesh.faces_[1].connected_face_index_[0], 0);
+    EXPECT_EQ(mesh.vertices_[0].connected_faces_.size(), 2);
+}
+
+TEST_F(MeshTest, LoadsOBJ)
+{
+    const std::string filename = (std::filesystem::temp_directory_path() / "MeshTest.obj").string();
+    {
+        std::ofstream out(filename);
+        out << "# A square pyramid.\n"
+               "v 0 0 0\nv 10 0 0\nv 10 10 0\nv 0 10 0\n"
+               "vt 0 0\nvn 0 0 1\n"
+               "f 4/1/1 3/1/1 2/1/1 1/1/1\n" // A quad with texture coordinates and normals.
+               "v 5 5 8\n"
+               "f 1 2 -1\nf 2 3 -1\nf 3 4 -1\nf 4 1 -1\n" // Relative indices.
+               "f 1 2 7\n"; // Refers to a vertex that doesn't exist.
+    }
+    MeshGroup mesh_group;
+    Settings settings;
+    ASSERT_TRUE(loadMeshIntoMeshGroup(&mesh_group, filename.c_str(), Matrix4x3D(), settings));
+    std::filesystem::remove(filename);
+
+    ASSERT_EQ(mesh_group.meshes.size(), 1);
+    const Mesh& loaded = mesh_group.meshes[0];
+    ASSERT_EQ(loaded.vertices_.size(), 5);
+    ASSERT_EQ(loaded.faces_.size(), 6);
+    EXPECT_EQ(loaded.vertices_[4].p_, Point3LL(5000, 5000, 8000));
+    EXPECT_EQ(loaded.faces_[2].vertex_index_[2], 4);
+    EXPECT_EQ(loaded.getAABB().max_, Point3LL(10000, 10000, 8000));
+    for (const MeshFace& face : loaded.faces_)
+    {
+        for (const int connected_face : face.connected_face_index_)
+        {
+            EXPECT_NE(connected_face, -1) << "The pyramid is closed, so all faces are connected.";
+        }
+    }
+}
+
+TEST_F(MeshTest, SkipsFacesOfUnparsedOBJVertices)
+{
+    const std::string filename = (std::filesystem::temp_directory_path() / "MeshTestUnparsed.obj").string();
+    {
+        std::ofstream out(filename);
+        out << "v 0 0 0\nv 10 0 0\nv 0 10 0\nv 0 0 10\n"
+               "v 10 nan? 10\n" // Doesn't parse.
+               "f 1 3 2\nf 1 2 4\nf 1 4 3\nf 2 3 4\n"
+               "f 2 5 4\n"; // Uses the vertex that doesn't parse.
+    }
+    MeshGroup mesh_group;
+    Settings settings;
+    ASSERT_TRUE(loadMeshIntoMeshGroup(&mesh_group, filename.c_str(), Matrix4x3D(), settings));
+    std::filesystem::remove(filename);
+
+    ASSERT_EQ(mesh_group.meshes.size(), 1);
+    const Mesh& loaded = mesh_group.meshes[0];
+    EXPECT_EQ(loaded.faces_.size(), 4) << "The face with the vertex that doesn't parse must be skipped, not pulled to the origin.";
+    EXPECT_EQ(loaded.getAABB().max_, Point3LL(10000, 10000, 10000));
+}
+
+/*!
+ * Write a ZIP archive in which the files are stored without compression.
+ */
+void writeStoredZip(const std::string& filename, const std::vector<std::pair<std::string, std::string>>& files)
+{
+    std::string archive;
+    std::string directory;
+    const auto append = [](std::string& target, const uint64_t value, const size_t size)
+    {
+        for (size_t byte = 0; byte < size; byte++)
+        {
+            target += static_cast<char>((value >> (8 * byte)) & 0xFF);
+        }
+    };
+    for (const auto& [name, contents] : files)
+    {
+        const size_t offset = archive.size();
+        const uLong crc = crc32(0, reinterpret_cast<const Bytef*>(contents.data()), contents.size());
+        append(archive, 0x04034b50, 4); // Signature.
+        append(archive, 0, 2 + 2 + 2 + 4); // Version, flags, method, time and date.
+        append(archive, crc, 4);
+        append(archive, contents.size(), 4);
+        append(archive, contents.size(), 4);
+        append(archive, name.size(), 2);
+        append(archive, 0, 2); // Extra field length.
+        archive += name + contents;
+
+        append(directory, 0x02014b50, 4); // Signature.
+        append(directory, 0, 2 + 2 + 2 + 2 + 4); // Versions, flags, method, time and date.
+        append(directory, crc, 4);
+        append(directory, contents.size(), 4);
+        append(directory, contents.size(), 4);
+        append(directory, name.size(), 2);
+        append(directory, 0, 2 + 2 + 2 + 2 + 4); // Extra field and comment length, disk, attributes.
+        append(directory, offset, 4);
+        directory += name;
+    }
+    const size_t directory_offset = archive.size();
+    archive += directory;
+    append(archive, 0x06054b50, 4); // Signature.
+    append(archive, 0, 2 + 2); // Disk numbers.
+    append(archive, files.size(), 2);
+    append(archive, files.size(), 2);
+    append(archive, directory.size(), 4);
+    append(archive, directory_offset, 4);
+    append(archive, 0, 2); // Comment length.
+
+    std::ofstream out(filename, std::ios::binary);
+    out << archive;
+}
+
+TEST_F(MeshTest, Loads3MF)
+{
+    const std::string model = R"(<?xml version="1.0" encoding="UTF-8"?>
+<model unit="centimeter" xmlns="http://schemas.microsoft.com/3dmanufacturing/core/2015/02">
+  <resources>
+    <object id="1" name="Tetrahedron &amp; co" type="model">
+      <mesh>
+        <vertices>
+          <vertex x="0" y="0" z="0" /><vertex x="1" y="0" z="0" /><vertex x="0" y="1" z="0" /><vertex x="0" y="0" z="1" />
+        </vertices>
+        <triangles>
+          <triangle v1="0" v2="2" v3="1" /><triangle v1="0" v2="1" v3="3" /><triangle v1="1" v2="2" v3="3" /><triangle v1="2" v2="0" v3="3" />
+        </triangles>
+      </mesh>
+    </object>
+    <object id="2" type="model">
+      <components>
+        <component objectid="1" />
+        <component objectid="1" transform="1 0 0 0 1 0 0 0 1 5 0 0" />
+      </components>
+    </object>
+  </resources>
+  <build>
+    <item objectid="1" />
+    <item objectid="2" transform="1 0 0 0 1 0 0 0 1 0 0 2" />
+  </build>
+</model>)";
+    const std::string relationships = R"(<?xml version="1.0" encoding="UTF-8"?>
+<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">
+  <Relationship Target="/3D/object.model" Id="rel0" Type="http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel" />
+</Relationships>)";
+    const std::string filename = (std::filesystem::temp_directory_path() / "MeshTest.3mf").string();
+    writeStoredZip(filename, { { "_rels/.rels", relationships }, { "3D/object.model", model } });
+
+    MeshGroup mesh_group;
+    Settings settings;
+    ASSERT_TRUE(loadMeshIntoMeshGroup(&mesh_group, filename.c_str(), Matrix4x3D(), settings));
+    std::filesystem::remove(filename);
+
+    ASSERT_EQ(mesh_group.meshes.size(), 2) << "Each build item becomes a mesh.";
+    const Mesh& single = mesh_group.meshes[0];
+    EXPECT_EQ(single.mesh_name_, "Tetrahedron & co");
+    ASSERT_EQ(single.vertices_.size(), 4);
+    ASSERT_EQ(single.faces_.size(), 4);
+    EXPECT_EQ(single.vertices_[3].p_, Point3LL(0, 0, 10000)) << "The vertices are converted from centimeters.";
+
+    const Mesh& assembly = mesh_group.meshes[1];
+    ASSERT_EQ(assembly.vertices_.size(), 8);
+    ASSERT_EQ(assembly.faces_.size(), 8);
+    EXPECT_EQ(assembly.vertices_[5].p_, Point3LL(60000, 0, 20000)) << "The transformations of the component and the build item both apply.";
+    EXPECT_EQ(assembly.getAABB().min_, Point3LL(0, 0, 20000));
+}
+// NOLINTEND(*-magic-numbers)
+
+} // namespace cura
@@ -3,8 +3,15 @@
 
 #include "PathOrderOptimizer.h" //The code under test.
 
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+#include <vector>
+
 #include <gtest/gtest.h> //To run the tests.
 
+#include "geometry/OpenPolyline.h"
+
 // NOLINTBEGIN(*-magic-numbers)
 namespace cura
 {
@@ -73,5 +80,93 @@ TEST_F(PathOrderOptimizerTest, ThreeTrianglesShortestOrder)
     EXPECT_EQ(optimizer.paths_[2].vertices_->front(), Point2LL(1000, 1000)) << "Far triangle last.";
 }
 
+/*!
+ * Tests ordering lines that are too far apart to be found in the bucket grid.
+ * Every next line must still be the one that is nearest to the end of the
+ * previous one.
+ */
+TEST_F(PathOrderOptimizerTest, ScatteredLinesNearestOrder)
+{
+    std::vector<OpenPolyline> lines;
+    for (coord_t i = 0; i < 40; i++)
+    {
+        // Scramble the positions, so that the nearest line is rarely the next one in the input.
+        const Point2LL start((i * 7919) % 41 * 1000, (i * 104729) % 37 * 1000);
+        lines.push_back(OpenPolyline({ start, start + Point2LL(300, 100) }));
+    }
+    PathOrderOptimizer<const OpenPolyline*> line_optimizer(Point2LL(0, 0));
+    for (const OpenPolyline& line : lines)
+    {
+        line_optimizer.addPolyline(&line);
+    }
+
+    line_optimizer.optimize();
+
+    ASSERT_EQ(line_optimizer.paths_.size(), lines.size());
+    Point2LL position(0, 0);
+    std::unordered_set<const OpenPolyline*> remaining;
+    for (const OpenPolyline& line : lines)
+    {
+        remaining.insert(&line);
+    }
+    for (const auto& path : line_optimizer.paths_)
+    {
+        coord_t nearest_distance2 = std::numeric_limits<coord_t>::max();
+        for (const OpenPolyline* line : remaining)
+        {
+            nearest_distance2 = std::min({ nearest_distance2, vSize2(line->front() - position), vSize2(line->back() - position) });
+        }
+        const Point2LL start = path.backwards_ ? path.vertices_->back() : path.vertices_->front();
+        EXPECT_EQ(vSize2(start - position), nearest_distance2) << "Each line must start at the nearest endpoint of all remaining lines.";
+        remaining.erase(path.vertices_);
+        position = path.backwards_ ? path.vertices_->front() : path.vertices_->back();
+    }
+}
+
+/*!
+ * Tests that refining the order shortens the travel moves, without losing or
+ * duplicating any paths.
+ */
+TEST_F(PathOrderOptimizerTest, RefinementShortensTravel)
+{
+    std::vector<OpenPolyline> lines;
+    for (coord_t i = 0; i < 40; i++)
+    {
+        const Point2LL start((i * 7919) % 41 * 1000, (i * 104729) % 37 * 1000);
+        lines.push_back(OpenPolyline({ start, start + Point2LL(300, 100) }));
+    }
+    const auto travel_length = [](const std::vector<PathOrdering<const OpenPolyline*>>& paths)
+    {
+        double length = 0;
+        Point2LL position(0, 0);
+        for (const auto& path : paths)
+        {
+            length += vSizeMM(path.backwards_ ? path.vertices_->back() - position : path.vertices_->front() - position);
+            position = path.backwards_ ? path.vertices_->front() : path.vertices_->back();
+        }
+        return length;
+    };
+
+    PathOrderOptimizer<const OpenPolyline*> greedy(Point2LL(0, 0));
+    PathOrderOptimizer<const OpenPolyline*> refined(Point2LL(0, 0));
+    refined.setRefinementBudget(50 * lines.size());
+    for (const OpenPolyline& line : lines)
+    {
+        greedy.addPolyline(&line);
+        refined.addPolyline(&line);
+    }
+    greedy.optimize();
+    refined.optimize();
+
+    ASSERT_EQ(refined.paths_.size(), lines.size());
+    std::unordered_set<const OpenPolyline*> ordered;
+    for (const auto& path : refined.paths_)
+    {
+        ordered.insert(path.vertices_);
+    }
+    EXPECT_EQ(ordered.size(), lines.size()) << "Every line must be ordered exactly once.";
+    EXPECT_LT(travel_length(refined.paths_), travel_length(greedy.paths_)) << "The refinement must shorten the travel of this scattered set of lines.";
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
@@ -0,0 +1,157 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "slicer.h" //Unit under test.
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "geometry/OpenPolyline.h"
+#include "geometry/Polygon.h"
+#include "utils/polygonUtils.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+/*!
+ * Exposes the stitching of open polylines.
+ */
+class StitchingSlicerLayer : public SlicerLayer
+{
+public:
+    using SlicerLayer::findPolygonPointClosestTo;
+    using SlicerLayer::stitch_extensive;
+};
+
+/*!
+ * The search of the segment near a point from before the segments were put in
+ * a grid, which tests every segment of every polygon.
+ */
+std::optional<ClosePolygonResult> findPolygonPointClosestToQuadratic(const Shape& polygons, Point2LL input)
+{
+    for (size_t n = 0; n < polygons.size(); n++)
+    {
+        Point2LL p0 = polygons[n][polygons[n].size() - 1];
+        for (size_t i = 0; i < polygons[n].size(); i++)
+        {
+            Point2LL p1 = polygons[n][i];
+
+            Point2LL pDiff = p1 - p0;
+            int64_t lineLength = vSize(pDiff);
+            if (lineLength > 1)
+            {
+                int64_t distOnLine = dot(pDiff, input - p0) / lineLength;
+                if (distOnLine >= 0 && distOnLine <= lineLength)
+                {
+                    Point2LL q = p0 + pDiff * distOnLine / lineLength;
+                    if (shorterThen(q - input, MM2INT(0.1)))
+                    {
+                        ClosePolygonResult ret;
+                        ret.polygonIdx = n;
+                        ret.pointIdx = i;
+                        return ret;
+                    }
+                }
+            }
+            p0 = p1;
+        }
+    }
+    return std::nullopt;
+}
+
+/*!
+ * A grid of squares, each with an open polyline sticking out of its bottom
+ * whose ends are just below the bottom edge. Some squares overlap their
+ * neighbours, so that there are several segments near some of the ends.
+ */
+class StitchExtensiveTest : public testing::Test
+{
+public:
+    static constexpr coord_t pitch = 3000;
+    static constexpr coord_t square_size = 2000;
+    static constexpr size_t squares_per_side = 10;
+
+    StitchingSlicerLayer layer;
+    OpenLinesSet open_polylines;
+
+    void SetUp() override
+    {
+        for (size_t row = 0; row < squares_per_side; row++)
+        {
+            for (size_t column = 0; column < squares_per_side; column++)
+            {
+                const coord_t x = column * pitch;
+                const coord_t y = row * pitch;
+                const coord_t width = (row + column) % 3 == 0 ? square_size + pitch : square_size; // Overlaps the next square.
+                layer.polygons_.push_back(Polygon({ Point2LL(x, y), Point2LL(x + width, y), Point2LL(x + width, y + square_size), Point2LL(x, y + square_size) }, true));
+                // Both ends are just within reach of the bottom edge of the square.
+                open_polylines.push_back(OpenPolyline({ Point2LL(x + 500, y - 60), Point2LL(x + 500, y - 800), Point2LL(x + 1500, y - 800), Point2LL(x + 1500, y - 60) }));
+            }
+        }
+    }
+};
+
+TEST_F(StitchExtensiveTest, GridLookupMatchesQuadraticSearch)
+{
+    const std::unique_ptr<LocToLineGrid> polygon_grid = PolygonUtils::createLocToLineGrid(layer.polygons_, MM2INT(0.2));
+
+    std::vector<Point2LL> queries;
+    for (const OpenPolyline& polyline : open_polylines)
+    {
+        queries.push_back(polyline.front());
+        queries.push_back(polyline.back());
+    }
+    for (const Polygon& polygon : layer.polygons_)
+    {
+        for (const Point2LL& vertex : polygon)
+        {
+            for (const coord_t offset : { -150, -99, -40, 0, 40, 99, 150 }) // Both within and out of reach.
+            {
+                queries.emplace_back(vertex.X + offset, vertex.Y);
+                queries.emplace_back(vertex.X, vertex.Y + offset);
+                queries.emplace_back(vertex.X + 700, vertex.Y + offset);
+                queries.emplace_back(vertex.X + offset, vertex.Y + 1300);
+            }
+        }
+    }
+
+    size_t found = 0;
+    for (const Point2LL& query : queries)
+    {
+        const std::optional<ClosePolygonResult> expected = findPolygonPointClosestToQuadratic(layer.polygons_, query);
+        const std::optional<ClosePolygonResult> result = layer.findPolygonPointClosestTo(query, *polygon_grid);
+        ASSERT_EQ(result.has_value(), expected.has_value()) << "At " << query.X << ", " << query.Y;
+        if (expected)
+        {
+            found++;
+            EXPECT_EQ(result->polygonIdx, expected->polygonIdx) << "At " << query.X << ", " << query.Y;
+            EXPECT_EQ(result->pointIdx, expected->pointIdx) << "At " << query.X << ", " << query.Y;
+        }
+    }
+    EXPECT_GT(found, queries.size() / 4) << "The fixture must have many points within reach of a segment.";
+}
+
+TEST_F(StitchExtensiveTest, ClosesEveryPolyline)
+{
+    const size_t square_count = layer.polygons_.size();
+
+    layer.stitch_extensive(open_polylines);
+
+    for (const OpenPolyline& polyline : open_polylines)
+    {
+        EXPECT_TRUE(polyline.empty()) << "Both ends of every polyline are near one square, so it must be closed along it.";
+    }
+    ASSERT_EQ(layer.polygons_.size(), square_count * 2);
+    for (size_t poly_idx = square_count; poly_idx < layer.polygons_.size(); poly_idx++)
+    {
+        // Closed along the bottom edge of its square, the shortest way, into the rectangle below it.
+        EXPECT_NEAR(std::abs(layer.polygons_[poly_idx].area()), 1000.0 * 740.0, 1000.0 * 10.0);
+    }
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,40 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "progress/SlowLayerCapture.h"
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(SlowLayerCaptureTest, SettingsRoundTrip)
+{
+    Settings settings;
+    settings.add("layer_height", "0.2");
+    settings.add("machine_start_gcode", "G28 ;Home\nG1 Z15.0 F6000\r\nM117 C:\\prints\\n\\");
+    settings.add("wall_line_count", "3");
+
+    std::stringstream file;
+    SlowLayerCapture::writeSettings(file, settings);
+    const std::string written = file.str();
+
+    size_t line_count = 0;
+    for (const char character : written)
+    {
+        line_count += character == '\n';
+    }
+    EXPECT_EQ(line_count, 3) << "Every setting must be on one line, even if its value has line breaks.";
+
+    const Settings read = SlowLayerCapture::readSettings(file);
+    EXPECT_EQ(read.get<std::string>("layer_height"), "0.2");
+    EXPECT_EQ(read.get<std::string>("machine_start_gcode"), settings.get<std::string>("machine_start_gcode"));
+    EXPECT_EQ(read.get<std::string>("wall_line_count"), "3");
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -430,4 +430,66 @@ TEST_F(TimeEstimateCalculatorTest, StraightAnglePartialJerk)
     EXPECT_NEAR(Duration(first_accelerate_t + first_cruise_distance / 50.0 + first_decelerate_t + second_accelerate_t + second_cruise_distance / 50.0 + second_decelerate_t), result[static_cast<size_t>(PrintFeatureType::Infill)], EPSILON);
 }
 
+TEST_F(TimeEstimateCalculatorTest, LookaheadBeyondBrakingDistanceChangesNothing)
+{
+    // A zigzag of 11mm segments. At 3000mm/s² the nozzle can brake from 100mm/s in less than 2mm, so looking further ahead than a few segments is pointless.
+    const auto plan_path = [](TimeEstimateCalculator& calculator)
+    {
+        for (int segment = 0; segment < 500; segment++)
+        {
+            const double x = 5.0 * (segment + 1);
+            const double y = (segment % 2 == 0) ? 10.0 : 0.0;
+            calculator.plan(TimeEstimateCalculator::Position(x, y, 0, segment), 100.0, segment % 3 == 0 ? PrintFeatureType::Infill : PrintFeatureType::OuterWall);
+        }
+    };
+    calculator.setFirmwareDefaults(um3);
+    plan_path(calculator);
+    const std::vector<Duration> unbounded = calculator.calculate();
+
+    TimeEstimateCalculator bounded;
+    bounded.setFirmwareDefaults(um3);
+    bounded.setPosition(TimeEstimateCalculator::Position(0, 0, 0, 0));
+    bounded.setLookahead(16);
+    plan_path(bounded);
+    const std::vector<Duration> result = bounded.calculate();
+
+    ASSERT_EQ(result.size(), unbounded.size());
+    for (size_t feature = 0; feature < result.size(); feature++)
+    {
+        EXPECT_NEAR(result[feature], unbounded[feature], EPSILON) << "Feature " << feature;
+    }
+    EXPECT_GT(result[static_cast<size_t>(PrintFeatureType::Infill)], 0.0);
+
+    const std::vector<Duration> again = bounded.calculate();
+    EXPECT_NEAR(again[static_cast<size_t>(PrintFeatureType::Infill)], result[static_cast<size_t>(PrintFeatureType::Infill)], EPSILON) << "Calculating should not consume the finalized blocks.";
+
+    bounded.reset();
+    EXPECT_NEAR(bounded.calculate()[static_cast<size_t>(PrintFeatureType::Infill)], 0.0, EPSILON) << "Reset should also forget the finalized blocks.";
+}
+
+TEST_F(TimeEstimateCalculatorTest, ShortLookaheadLimitsSpeed)
+{
+    // Straight tiny segments without jerk. With all segments planned together there is plenty of room to accelerate, but a firmware with a short block buffer
+    // needs to be able to stop within the blocks it has seen.
+    const auto plan_path = [](TimeEstimateCalculator& calculator)
+    {
+        for (int segment = 1; segment <= 2000; segment++)
+        {
+            calculator.plan(TimeEstimateCalculator::Position(0.125 * segment, 0, 0, 0), 50.0, PrintFeatureType::Infill); // Exact in binary, so that the segments are exactly collinear.
+        }
+    };
+    calculator.setFirmwareDefaults(jerkless);
+    plan_path(calculator);
+    const Duration unbounded = calculator.calculate()[static_cast<size_t>(PrintFeatureType::Infill)];
+
+    TimeEstimateCalculator bounded;
+    bounded.setFirmwareDefaults(jerkless);
+    bounded.setPosition(TimeEstimateCalculator::Position(0, 0, 0, 0));
+    bounded.setLookahead(4);
+    plan_path(bounded);
+    const Duration result = bounded.calculate()[static_cast<size_t>(PrintFeatureType::Infill)];
+
+    EXPECT_GT(result, unbounded * 2) << "Braking within 0.5mm at 50mm/s² allows only about 7mm/s instead of 50mm/s.";
+}
+
 } // namespace cura
\ No newline at end of file
@@ -0,0 +1,108 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "TimeEstimateWorker.h" //The unit under test.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "PrintFeature.h"
+#include "settings/Settings.h" //To set firmware settings.
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class TimeEstimateWorkerTest : public testing::Test
+{
+public:
+    Settings firmware;
+
+    void SetUp() override
+    {
+        firmware.add("machine_max_feedrate_x", "300");
+        firmware.add("machine_max_feedrate_y", "300");
+        firmware.add("machine_max_feedrate_z", "40");
+        firmware.add("machine_max_feedrate_e", "45");
+        firmware.add("machine_max_acceleration_x", "9000");
+        firmware.add("machine_max_acceleration_y", "9000");
+        firmware.add("machine_max_acceleration_z", "100");
+        firmware.add("machine_max_acceleration_e", "10000");
+        firmware.add("machine_max_jerk_xy", "20");
+        firmware.add("machine_max_jerk_z", "0.4");
+        firmware.add("machine_max_jerk_e", "5");
+        firmware.add("machine_minimum_feedrate", "0");
+        firmware.add("machine_acceleration", "3000");
+    }
+
+    /*
+     * Plan some layers of zigzags, where each layer ends in the middle of a
+     * move, so that the speed and position carry over to the next layer.
+     *
+     * \return The estimate of each layer.
+     */
+    std::vector<std::vector<Duration>> estimateLayers(TimeEstimateWorker& worker, const size_t layer_count)
+    {
+        worker.setFirmwareDefaults(firmware);
+        std::vector<std::vector<Duration>> estimates;
+        double e = 0.0;
+        for (size_t layer = 0; layer < layer_count; layer++)
+        {
+            worker.setAcceleration(layer % 2 == 0 ? 1000.0 : 3000.0);
+            worker.setMaxXyJerk(layer % 3 == 0 ? 10.0 : 20.0);
+            for (size_t move = 0; move < 50; move++)
+            {
+                e += 0.1;
+                const double x = (move % 2 == 0) ? 10.0 : 0.0;
+                worker.plan(TimeEstimateCalculator::Position(x, move * 0.5, layer * 0.2, e), 60.0, move % 5 == 0 ? PrintFeatureType::MoveCombing : PrintFeatureType::Infill);
+            }
+            worker.addTime(0.5);
+            worker.endLayer();
+            if (const std::optional<std::vector<Duration>> estimate = worker.takeEstimate(layer % 2 == 0))
+            {
+                estimates.push_back(*estimate);
+            }
+        }
+        while (const std::optional<std::vector<Duration>> estimate = worker.takeEstimate(true))
+        {
+            estimates.push_back(*estimate);
+        }
+        return estimates;
+    }
+};
+
+TEST_F(TimeEstimateWorkerTest, ThreadedEqualsInline)
+{
+    TimeEstimateWorker inline_worker;
+    const std::vector<std::vector<Duration>> expected = estimateLayers(inline_worker, 20);
+
+    TimeEstimateWorker threaded_worker;
+    threaded_worker.startThread();
+    EXPECT_TRUE(threaded_worker.isThreaded());
+    const std::vector<std::vector<Duration>> result = estimateLayers(threaded_worker, 20);
+
+    ASSERT_EQ(expected.size(), 20);
+    ASSERT_EQ(result.size(), expected.size());
+    for (size_t layer = 0; layer < expected.size(); layer++)
+    {
+        for (size_t feature = 0; feature < expected[layer].size(); feature++)
+        {
+            EXPECT_EQ(result[layer][feature], expected[layer][feature]) << "The estimates of layer " << layer << " should be identical.";
+        }
+    }
+    EXPECT_GT(expected[0][static_cast<size_t>(PrintFeatureType::Infill)], 0.0);
+    EXPECT_GT(expected[0][static_cast<size_t>(PrintFeatureType::MoveCombing)], 0.0);
+}
+
+TEST_F(TimeEstimateWorkerTest, NoLayers)
+{
+    TimeEstimateWorker worker;
+    worker.startThread();
+    EXPECT_FALSE(worker.takeEstimate(true)) << "There is nothing to wait for.";
+    worker.plan(TimeEstimateCalculator::Position(10.0, 0.0, 0.0, 0.0), 60.0, PrintFeatureType::Infill);
+    EXPECT_FALSE(worker.takeEstimate(true)) << "The layer hasn't ended yet.";
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
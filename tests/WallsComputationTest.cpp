@@ -3,6 +3,7 @@
 
 #include "WallsComputation.h" //Unit under test.
 
+#include <algorithm>
 #include <unordered_set>
 
 #include <range/v3/view/join.hpp>
@@ -123,6 +124,49 @@ TEST_F(WallsComputationTest, GenerateWallsForLayerSinglePart)
     EXPECT_EQ(layer.parts.size(), 1) << "There is still just 1 part.";
 }
 
+/*!
+ * Tests if a layer with the same outline as another layer gets the same walls from the cache.
+ */
+TEST_F(WallsComputationTest, ReusesWallsForSameOutline)
+{
+    WallToolPathsCache cache;
+    WallsComputation lower_walls(settings, LayerIndex(100), &cache);
+    WallsComputation upper_walls(settings, LayerIndex(101), &cache);
+    SliceLayer lower_layer;
+    lower_layer.parts.emplace_back().outline.push_back(ff_holes);
+    SliceLayer upper_layer;
+    upper_layer.parts.emplace_back().outline.push_back(ff_holes);
+
+    // Run the test.
+    lower_walls.generateWalls(&lower_layer, SectionType::WALL);
+    upper_walls.generateWalls(&upper_layer, SectionType::WALL);
+
+    // Verify that the walls are the same as if they were generated again.
+    SliceLayer uncached_layer;
+    uncached_layer.parts.emplace_back().outline.push_back(ff_holes);
+    walls_computation.generateWalls(&uncached_layer, SectionType::WALL);
+    const SliceLayerPart& upper_part = upper_layer.parts.front();
+    const SliceLayerPart& uncached_part = uncached_layer.parts.front();
+    ASSERT_FALSE(uncached_part.wall_toolpaths.empty()) << "There must be some walls.";
+    ASSERT_EQ(upper_part.wall_toolpaths.size(), uncached_part.wall_toolpaths.size()) << "The cached walls must have the same number of insets.";
+    for (size_t inset_idx = 0; inset_idx < uncached_part.wall_toolpaths.size(); inset_idx++)
+    {
+        const VariableWidthLines& cached_lines = upper_part.wall_toolpaths[inset_idx];
+        const VariableWidthLines& uncached_lines = uncached_part.wall_toolpaths[inset_idx];
+        ASSERT_EQ(cached_lines.size(), uncached_lines.size()) << "The cached walls must have the same number of lines.";
+        for (size_t line_idx = 0; line_idx < uncached_lines.size(); line_idx++)
+        {
+            ASSERT_EQ(cached_lines[line_idx].size(), uncached_lines[line_idx].size()) << "The cached lines must have the same number of junctions.";
+            for (size_t junction_idx = 0; junction_idx < uncached_lines[line_idx].size(); junction_idx++)
+            {
+                EXPECT_EQ(cached_lines[line_idx][junction_idx].p_, uncached_lines[line_idx][junction_idx].p_);
+                EXPECT_EQ(cached_lines[line_idx][junction_idx].w_, uncached_lines[line_idx][junction_idx].w_);
+            }
+        }
+    }
+    EXPECT_EQ(upper_part.inner_area.area(), uncached_part.inner_area.area()) << "The cached inner area must be the same.";
+}
+
 /*!
  * Tests if the inner area is properly set.
  */
@@ -144,6 +188,41 @@ TEST_F(WallsComputationTest, GenerateWallsZeroWalls)
     EXPECT_EQ(layer.parts.size(), 1) << "There is still just 1 part.";
 }
 
+/*!
+ * Tests if a wide convex part gets closed walls that are offsets of its outline, with the nominal width.
+ */
+TEST_F(WallsComputationTest, GenerateWallsForConvexPartAreOffsets)
+{
+    SliceLayer layer;
+    layer.parts.emplace_back();
+    SliceLayerPart& part = layer.parts.back();
+    part.outline.push_back(square_shape);
+
+    // Run the test.
+    walls_computation.generateWalls(&layer, SectionType::WALL);
+
+    // Verify that both walls go around the square at the middle of their line width.
+    ASSERT_EQ(part.wall_toolpaths.size(), 2) << "There must be 2 insets.";
+    constexpr coord_t line_width = 400;
+    constexpr coord_t tolerance = 10;
+    for (size_t inset_idx = 0; inset_idx < part.wall_toolpaths.size(); inset_idx++)
+    {
+        ASSERT_EQ(part.wall_toolpaths[inset_idx].size(), 1) << "Every inset must be a single line.";
+        const ExtrusionLine& line = part.wall_toolpaths[inset_idx].front();
+        EXPECT_TRUE(line.is_closed_) << "The walls must be closed.";
+        EXPECT_EQ(line.inset_idx_, inset_idx);
+        const coord_t expected_depth = line_width / 2 + line_width * static_cast<coord_t>(inset_idx);
+        for (const ExtrusionJunction& junction : line)
+        {
+            EXPECT_EQ(junction.w_, line_width) << "The walls must have their nominal width.";
+            const coord_t depth = std::min({ junction.p_.X, junction.p_.Y, MM2INT(20) - junction.p_.X, MM2INT(20) - junction.p_.Y });
+            EXPECT_NEAR(depth, expected_depth, tolerance) << "The walls must be at the middle of their line width from the outline.";
+        }
+    }
+    const double inner_size = MM2INT(20) - 4 * line_width;
+    EXPECT_NEAR(part.inner_area.area(), inner_size * inner_size, inner_size * 4 * tolerance) << "The inner area must start where the inner wall ends.";
+}
+
 /*!
  * Tests if the inner area is properly set.
  */
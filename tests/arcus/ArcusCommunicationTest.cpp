@@ -1,13 +1,18 @@
 // Copyright (c) 2024 UltiMaker
 // CuraEngine is released under the terms of the AGPLv3 or higher.
 
+#include <cstdint>
+#include <cstring>
 #include <google/protobuf/message.h>
 #include <memory>
 #include <numbers>
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include "FffProcessor.h"
+#include "PrintFeature.h"
 #include "MockSocket.h" //To mock out the communication with the front-end.
 #include "communication/ArcusCommunicationPrivate.h" //To access the private fields of this communication class.
 #include "geometry/Polygon.h" //Create test shapes to send over the socket.
@@ -109,6 +114,35 @@ TEST_F(ArcusCommunicationTest, FlushGCodeTest)
     EXPECT_EQ(test_gcode, message->data());
 }
 
+TEST_F(ArcusCommunicationTest, FlushGCodeLargeLayer)
+{
+    std::string test_gcode;
+    while (test_gcode.size() < ArcusCommunication::Private::max_gcode_message_size * 5 / 2)
+    {
+        test_gcode += "G1 X" + std::to_string(test_gcode.size() % 200) + " Y100 E" + std::to_string(test_gcode.size()) + "\n";
+    }
+    ac->private_data->gcode_output_stream.write(test_gcode.c_str(), test_gcode.size());
+    ac->flushGCode();
+
+    ASSERT_EQ(socket->sent_messages.size(), 3) << "The layer should be split into messages of the maximum size.";
+    std::string received_gcode;
+    for (const Arcus::MessagePtr& sent_message : socket->sent_messages)
+    {
+        const proto::GCodeLayer* message = dynamic_cast<proto::GCodeLayer*>(sent_message.get());
+        ASSERT_NE(message, nullptr);
+        EXPECT_LE(message->data().size(), ArcusCommunication::Private::max_gcode_message_size);
+        EXPECT_EQ(message->data().back(), '\n') << "Messages should be split at line breaks.";
+        received_gcode += message->data();
+    }
+    EXPECT_EQ(received_gcode, test_gcode);
+
+    EXPECT_EQ(ac->private_data->gcode_in_flight_size, test_gcode.size()) << "The socket still holds on to all messages.";
+    socket->sent_messages.clear();
+    ac->private_data->releaseSentGCode();
+    EXPECT_EQ(ac->private_data->gcode_in_flight_size, 0) << "The socket has sent all messages.";
+    EXPECT_TRUE(ac->private_data->gcode_in_flight.empty());
+}
+
 TEST_F(ArcusCommunicationTest, IsSequential)
 {
     EXPECT_FALSE(ac->isSequential());
@@ -158,20 +192,99 @@ TEST_F(ArcusCommunicationTest, SendLayerComplete)
     EXPECT_EQ(static_cast<float>(layer_thickness), message->thickness());
 }
 
+/*
+ * Reads the varints of the compact encoding of path segments.
+ */
+std::vector<uint64_t> readVarints(const std::string& data, size_t& pos, const size_t count)
+{
+    std::vector<uint64_t> values;
+    while (values.size() < count && pos < data.size())
+    {
+        uint64_t value = 0;
+        for (int shift = 0; pos < data.size(); shift += 7)
+        {
+            const uint8_t byte = static_cast<uint8_t>(data[pos++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+        values.push_back(value);
+    }
+    return values;
+}
+
+TEST_F(ArcusCommunicationTest, CompactPathSegments)
+{
+    ac->private_data->compact_path_segments = true;
+    ac->setLayerForSend(0);
+    ac->sendCurrentPosition(Point2LL(1000, 1000));
+    ac->sendLineTo(PrintFeatureType::OuterWall, Point2LL(1200, 1000), 400, 200, 30.0);
+    ac->sendLineTo(PrintFeatureType::OuterWall, Point2LL(1200, 900), 400, 200, 30.0);
+    ac->sendLineTo(PrintFeatureType::InnerWall, Point2LL(-5000, 900), 400, 200, 30.0);
+    ac->sendOptimizedLayerData();
+
+    ASSERT_EQ(socket->sent_messages.size(), 1);
+    const auto* layer = dynamic_cast<proto::LayerOptimized*>(socket->sent_messages.back().get());
+    ASSERT_NE(layer, nullptr);
+    ASSERT_EQ(layer->path_segment_size(), 1);
+    const proto::PathSegment& segment = layer->path_segment(0);
+    EXPECT_EQ(segment.encoding(), proto::PathSegment::Compact);
+
+    size_t pos = 0;
+    const std::vector<uint64_t> deltas = readVarints(segment.points(), pos, 8);
+    EXPECT_EQ(pos, segment.points().size());
+    const std::vector<int64_t> expected_deltas = { 1000, 1000, 200, 0, 0, -100, -6200, 0 };
+    ASSERT_EQ(deltas.size(), expected_deltas.size());
+    for (size_t i = 0; i < deltas.size(); i++)
+    {
+        const int64_t delta = static_cast<int64_t>(deltas[i] >> 1) ^ -static_cast<int64_t>(deltas[i] & 1);
+        EXPECT_EQ(delta, expected_deltas[i]);
+    }
+
+    // Two runs of line types: two outer wall segments and one inner wall segment.
+    const std::string& line_types = segment.line_type();
+    ASSERT_EQ(line_types.size(), 4);
+    EXPECT_EQ(line_types[0], 2);
+    EXPECT_EQ(static_cast<PrintFeatureType>(line_types[1]), PrintFeatureType::OuterWall);
+    EXPECT_EQ(line_types[2], 1);
+    EXPECT_EQ(static_cast<PrintFeatureType>(line_types[3]), PrintFeatureType::InnerWall);
+
+    // A single run of widths.
+    const std::string& widths = segment.line_width();
+    ASSERT_EQ(widths.size(), 1 + sizeof(float));
+    EXPECT_EQ(widths[0], 3);
+    float width;
+    std::memcpy(&width, widths.data() + 1, sizeof(float));
+    EXPECT_FLOAT_EQ(width, 0.4);
+}
+
 TEST_F(ArcusCommunicationTest, SendProgress)
 {
     ac->private_data->object_count = 2; // If there are two objects, all progress should get halved.
 
-    ac->sendProgress(10);
+    ac->sendProgress(10, std::nullopt);
     ASSERT_EQ(size_t(1), socket->sent_messages.size());
     auto* message = dynamic_cast<proto::Progress*>(socket->sent_messages.back().get());
     EXPECT_EQ(float(5), message->amount());
+    EXPECT_LT(message->remaining_time(), 0) << "Without an estimate, the remaining time is negative.";
 
-    ac->sendProgress(50);
+    ac->sendProgress(50, std::nullopt);
     ASSERT_EQ(size_t(2), socket->sent_messages.size());
     message = dynamic_cast<proto::Progress*>(socket->sent_messages.back().get());
     EXPECT_EQ(float(25), message->amount());
 }
 
+TEST_F(ArcusCommunicationTest, SendProgressRemainingTime)
+{
+    ac->private_data->object_count = 2;
+
+    ac->sendProgress(0.25, Duration(30));
+    ASSERT_EQ(size_t(1), socket->sent_messages.size());
+    const auto* message = dynamic_cast<proto::Progress*>(socket->sent_messages.back().get());
+    EXPECT_FLOAT_EQ(message->remaining_time(), 30 + 40) << "The second object should take as long as the first, which takes 40s in total.";
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
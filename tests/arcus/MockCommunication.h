@@ -23,7 +23,8 @@ class MockCommunication : public Communication
 public:
     MOCK_CONST_METHOD0(hasSlice, bool());
     MOCK_CONST_METHOD0(isSequential, bool());
-    MOCK_CONST_METHOD1(sendProgress, void(double progress));
+    MOCK_CONST_METHOD0(wantsLayerView, bool());
+    MOCK_CONST_METHOD2(sendProgress, void(double progress, std::optional<Duration> remaining_time));
     MOCK_METHOD3(sendLayerComplete, void(const LayerIndex::value_type& layer_nr, const coord_t& z, const coord_t& thickness));
     MOCK_METHOD5(sendPolygons, void(const PrintFeatureType& type, const Shape& polygons, const coord_t& line_width, const coord_t& line_thickness, const Velocity& velocity));
     MOCK_METHOD5(sendPolygon, void(const PrintFeatureType& type, const Polygon& polygon, const coord_t& line_width, const coord_t& line_thickness, const Velocity& velocity));
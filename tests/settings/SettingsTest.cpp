@@ -237,6 +237,22 @@ TEST_F(SettingsTest, Inheritance)
     EXPECT_EQ(override_value, settings.get<std::string>("test_setting")) << "The new value overrides the one from the parent.";
 }
 
+TEST_F(SettingsTest, CachedValueFollowsParent)
+{
+    std::shared_ptr<Slice> current_slice = std::make_shared<Slice>(0);
+    Application::getInstance().current_slice_ = current_slice.get();
+
+    Settings parent;
+    parent.add("test_setting", "1.5");
+    settings.setParent(&parent);
+    EXPECT_DOUBLE_EQ(settings.get<double>("test_setting"), 1.5);
+    EXPECT_EQ(settings.get<coord_t>("test_setting"), 1500);
+
+    parent.add("test_setting", "2.5");
+    EXPECT_DOUBLE_EQ(settings.get<double>("test_setting"), 2.5) << "Changing a setting of the parent must not leave an outdated value in the cache of the child.";
+    EXPECT_EQ(settings.get<std::string>("test_setting"), "2.5");
+}
+
 TEST_F(SettingsTest, LimitToExtruder)
 {
     std::shared_ptr<Slice> current_slice = std::make_shared<Slice>(0);
@@ -0,0 +1,118 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/ArcFitter.h" //The unit under test.
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+/*
+ * Points on a circle, like a round wall.
+ */
+std::vector<Point2LL> circlePoints(const Point2LL& center, const coord_t radius, const double start_angle, const double sweep, const size_t segment_count)
+{
+    std::vector<Point2LL> points;
+    for (size_t segment = 0; segment <= segment_count; segment++)
+    {
+        const double angle = start_angle + sweep * segment / segment_count;
+        points.emplace_back(center.X + std::llrint(radius * std::cos(angle)), center.Y + std::llrint(radius * std::sin(angle)));
+    }
+    return points;
+}
+
+TEST(ArcFitterTest, QuarterCircle)
+{
+    const Point2LL center(10000, 20000);
+    std::vector<Point2LL> points = circlePoints(center, 5000, 0, std::numbers::pi / 2, 30);
+    const Point2LL start = points.front();
+    points.erase(points.begin());
+
+    const std::vector<ArcFitter::Arc> arcs = ArcFitter(10).fit(start, points);
+    ASSERT_EQ(arcs.size(), 1);
+    EXPECT_EQ(arcs[0].first_point_idx, 0);
+    EXPECT_EQ(arcs[0].last_point_idx, points.size() - 1) << "The whole quarter circle is a single arc.";
+    EXPECT_TRUE(arcs[0].counter_clockwise);
+    EXPECT_LE(vSize(arcs[0].center - center), 5);
+
+    std::reverse(points.begin(), points.end());
+    points.push_back(start);
+    const Point2LL reversed_start = points.front();
+    points.erase(points.begin());
+    const std::vector<ArcFitter::Arc> reversed_arcs = ArcFitter(10).fit(reversed_start, points);
+    ASSERT_EQ(reversed_arcs.size(), 1);
+    EXPECT_FALSE(reversed_arcs[0].counter_clockwise);
+}
+
+TEST(ArcFitterTest, FullCircle)
+{
+    const std::vector<Point2LL> points = circlePoints(Point2LL(0, 0), 3000, 0, 2 * std::numbers::pi, 60);
+    const std::vector<Point2LL> path(points.begin() + 1, points.end());
+
+    const std::vector<ArcFitter::Arc> arcs = ArcFitter(10).fit(points.front(), path);
+    ASSERT_FALSE(arcs.empty());
+    EXPECT_LE(arcs.size(), 2) << "A closed circle can't be a single arc, but two are enough.";
+    size_t covered = 0;
+    size_t next_idx = 0;
+    for (const ArcFitter::Arc& arc : arcs)
+    {
+        EXPECT_GE(arc.first_point_idx, next_idx) << "Arcs may not overlap.";
+        EXPECT_GE(arc.last_point_idx + 1 - arc.first_point_idx, ArcFitter::min_segments);
+        covered += arc.last_point_idx + 1 - arc.first_point_idx;
+        next_idx = arc.last_point_idx + 1;
+    }
+    EXPECT_GE(covered, path.size() - ArcFitter::min_segments);
+}
+
+TEST(ArcFitterTest, CornersOnACircle)
+{
+    // The corners of a square lie on a circle, but the sides are far from it.
+    const std::vector<Point2LL> square = { Point2LL(10000, 10000), Point2LL(0, 10000), Point2LL(0, 0), Point2LL(10000, 0) };
+    EXPECT_TRUE(ArcFitter(10).fit(Point2LL(10000, 0), square).empty());
+
+    // The same for polygons with many corners, if the tolerance is small enough.
+    const std::vector<Point2LL> octagon = circlePoints(Point2LL(0, 0), 10000, 0, 2 * std::numbers::pi, 8);
+    EXPECT_TRUE(ArcFitter(10).fit(octagon.front(), std::vector<Point2LL>(octagon.begin() + 1, octagon.end())).empty());
+}
+
+TEST(ArcFitterTest, StraightAndZigzag)
+{
+    const std::vector<Point2LL> straight = { Point2LL(1000, 0), Point2LL(2000, 0), Point2LL(3000, 0), Point2LL(4000, 0) };
+    EXPECT_TRUE(ArcFitter(10).fit(Point2LL(0, 0), straight).empty());
+
+    const std::vector<Point2LL> zigzag = { Point2LL(1000, 100), Point2LL(2000, 0), Point2LL(3000, 100), Point2LL(4000, 0), Point2LL(5000, 100) };
+    EXPECT_TRUE(ArcFitter(10).fit(Point2LL(0, 0), zigzag).empty()) << "The points don't all turn the same way.";
+}
+
+TEST(ArcFitterTest, TooFewSegments)
+{
+    std::vector<Point2LL> points = circlePoints(Point2LL(0, 0), 5000, 0, 0.5, ArcFitter::min_segments - 1);
+    const Point2LL start = points.front();
+    points.erase(points.begin());
+    EXPECT_TRUE(ArcFitter(10).fit(start, points).empty());
+}
+
+TEST(ArcFitterTest, ArcBetweenLines)
+{
+    // A slot: a straight line, a half circle, and a straight line back.
+    std::vector<Point2LL> path = { Point2LL(10000, -5000) };
+    const std::vector<Point2LL> half_circle = circlePoints(Point2LL(10000, 0), 5000, -std::numbers::pi / 2, std::numbers::pi, 40);
+    path.insert(path.end(), half_circle.begin() + 1, half_circle.end());
+    path.emplace_back(0, 5000);
+
+    const std::vector<ArcFitter::Arc> arcs = ArcFitter(10).fit(Point2LL(0, -5000), path);
+    ASSERT_EQ(arcs.size(), 1);
+    EXPECT_EQ(arcs[0].first_point_idx, 1) << "The arc starts at the end of the first line.";
+    EXPECT_EQ(arcs[0].last_point_idx, path.size() - 2) << "The arc ends at the start of the last line.";
+    EXPECT_LE(vSize(arcs[0].center - Point2LL(10000, 0)), 5);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,54 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "geometry/CompactShape.h"
+
+#include <gtest/gtest.h>
+
+#include "geometry/Polygon.h"
+#include "geometry/Shape.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+void expectSameShape(const Shape& expected, const Shape& actual)
+{
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t polygon_idx = 0; polygon_idx < expected.size(); polygon_idx++)
+    {
+        EXPECT_EQ(actual[polygon_idx].getPoints(), expected[polygon_idx].getPoints());
+        EXPECT_EQ(actual[polygon_idx].isExplicitelyClosed(), expected[polygon_idx].isExplicitelyClosed());
+    }
+}
+
+TEST(CompactShapeTest, DecodeGivesTheSameShape)
+{
+    Shape shape;
+    shape.push_back(Polygon({ Point2LL(-100000, -50000), Point2LL(200000, -50000), Point2LL(200000, 300000), Point2LL(-100000, 300000) }, false));
+    shape.push_back(Polygon({ Point2LL(0, 0), Point2LL(0, 1000), Point2LL(1000, 1000), Point2LL(0, 0) }, true)); // A hole, explicitly closed.
+
+    const CompactShape compact(shape);
+    EXPECT_FALSE(compact.empty());
+    expectSameShape(shape, compact.decode());
+}
+
+TEST(CompactShapeTest, EmptyShape)
+{
+    const CompactShape compact((Shape()));
+    EXPECT_TRUE(compact.empty());
+    EXPECT_TRUE(compact.decode().empty());
+    EXPECT_TRUE(CompactShape().empty());
+}
+
+TEST(CompactShapeTest, ShapeTooLargeToCompact)
+{
+    Shape shape;
+    shape.push_back(Polygon({ Point2LL(-5000000000, 0), Point2LL(5000000000, 0), Point2LL(0, 1000) }, false));
+
+    const CompactShape compact(shape);
+    expectSameShape(shape, compact.decode());
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
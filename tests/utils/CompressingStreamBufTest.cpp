@@ -0,0 +1,163 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/CompressingStreamBuf.h" //The unit under test.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+#ifdef ZSTD_COMPRESSION
+#include <zstd.h>
+#endif
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+std::string someGCode(const size_t line_count)
+{
+    std::ostringstream gcode;
+    for (size_t line = 0; line < line_count; line++)
+    {
+        gcode << "G1 X" << (line * 37) % 200 << "." << (line * 7) % 1000 << " Y" << (line * 53) % 200 << "." << (line * 11) % 100 << " E" << line << ".12345\n";
+    }
+    return gcode.str();
+}
+
+std::string gunzip(const std::string& compressed)
+{
+    z_stream stream{};
+    EXPECT_EQ(inflateInit2(&stream, 15 + 16), Z_OK);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    std::string result;
+    char buffer[4096];
+    int status;
+    do
+    {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        status = inflate(&stream, Z_NO_FLUSH);
+        result.append(buffer, sizeof(buffer) - stream.avail_out);
+    } while (status == Z_OK);
+    EXPECT_EQ(status, Z_STREAM_END) << "The gzip stream should be complete.";
+    inflateEnd(&stream);
+    return result;
+}
+
+#ifdef ZSTD_COMPRESSION
+std::string unzstd(const std::string& compressed)
+{
+    const unsigned long long size = ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+    std::string result;
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    ZSTD_inBuffer input{ compressed.data(), compressed.size(), 0 };
+    char buffer[4096];
+    size_t status = 1;
+    while (input.pos < input.size && status != 0)
+    {
+        ZSTD_outBuffer output{ buffer, sizeof(buffer), 0 };
+        status = ZSTD_decompressStream(context, &output, &input);
+        EXPECT_FALSE(ZSTD_isError(status));
+        if (ZSTD_isError(status))
+        {
+            break;
+        }
+        result.append(buffer, output.pos);
+    }
+    EXPECT_EQ(status, 0) << "The zstd frame should be complete.";
+    ZSTD_freeDCtx(context);
+    EXPECT_TRUE(size == ZSTD_CONTENTSIZE_UNKNOWN || size == result.size());
+    return result;
+}
+#else
+std::string unzstd(const std::string&)
+{
+    ADD_FAILURE() << "Built without zstd.";
+    return {};
+}
+#endif
+
+//! The formats that this build can compress with.
+std::vector<CompressingStreamBuf::Format> availableFormats()
+{
+#ifdef ZSTD_COMPRESSION
+    return { CompressingStreamBuf::Format::GZIP, CompressingStreamBuf::Format::ZSTD };
+#else
+    return { CompressingStreamBuf::Format::GZIP };
+#endif
+}
+
+TEST(CompressingStreamBufTest, FormatFromFileName)
+{
+    EXPECT_EQ(CompressingStreamBuf::formatFromFileName("out.gcode.gz"), CompressingStreamBuf::Format::GZIP);
+#ifdef ZSTD_COMPRESSION
+    EXPECT_EQ(CompressingStreamBuf::formatFromFileName("out.gcode.zst"), CompressingStreamBuf::Format::ZSTD);
+#else
+    EXPECT_EQ(CompressingStreamBuf::formatFromFileName("out.gcode.zst"), std::nullopt);
+#endif
+    EXPECT_EQ(CompressingStreamBuf::formatFromFileName("out.gcode"), std::nullopt);
+    EXPECT_EQ(CompressingStreamBuf::formatFromFileName("gz"), std::nullopt);
+}
+
+TEST(CompressingStreamBufTest, RoundTrip)
+{
+    const std::string gcode = someGCode(100000); // Several chunks.
+    ASSERT_GT(gcode.size(), CompressingStreamBuf::chunk_size * 3);
+
+    for (const CompressingStreamBuf::Format format : availableFormats())
+    {
+        std::ostringstream target;
+        {
+            CompressingStreamBuf buffer(target, format);
+            std::ostream stream(&buffer);
+            for (size_t start = 0; start < gcode.size(); start += 1000) // In pieces, like the g-code is written.
+            {
+                stream << std::string_view(gcode).substr(start, 1000);
+            }
+            stream.flush();
+            buffer.close();
+        }
+        const std::string compressed = target.str();
+        EXPECT_LT(compressed.size(), gcode.size() / 2);
+        EXPECT_EQ(format == CompressingStreamBuf::Format::GZIP ? gunzip(compressed) : unzstd(compressed), gcode);
+    }
+}
+
+TEST(CompressingStreamBufTest, Empty)
+{
+    for (const CompressingStreamBuf::Format format : availableFormats())
+    {
+        std::ostringstream target;
+        {
+            CompressingStreamBuf buffer(target, format); // Closed by the destructor.
+        }
+        const std::string compressed = target.str();
+        EXPECT_FALSE(compressed.empty()) << "Even empty data needs a header.";
+        EXPECT_EQ(format == CompressingStreamBuf::Format::GZIP ? gunzip(compressed) : unzstd(compressed), "");
+    }
+}
+
+TEST(CompressingStreamBufTest, WriteAfterCloseFails)
+{
+    std::ostringstream target;
+    CompressingStreamBuf buffer(target, CompressingStreamBuf::Format::GZIP);
+    std::ostream stream(&buffer);
+    stream << "G28\n";
+    stream.flush();
+    buffer.close();
+    const std::string compressed = target.str();
+
+    stream << someGCode(100000); // More than fits in the pending chunks, which would block if it was accepted.
+    stream.flush();
+
+    EXPECT_TRUE(stream.bad()) << "Writing after closing must fail.";
+    EXPECT_EQ(target.str(), compressed) << "Nothing may be written to the target after closing.";
+    EXPECT_EQ(gunzip(compressed), "G28\n");
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,48 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ExtrusionLine.h"
+
+#include <gtest/gtest.h>
+
+#include "geometry/Polygon.h"
+#include "geometry/Shape.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(ExtrusionLineTest, InsideLikeShape)
+{
+    // A concave polygon with a horizontal edge, so that points level with its vertices and edges are tested too.
+    const std::vector<Point2LL> vertices{ Point2LL(0, 0), Point2LL(10000, 0), Point2LL(10000, 10000), Point2LL(5000, 4000), Point2LL(0, 10000) };
+    constexpr bool is_closed = true;
+    ExtrusionLine line(0, false, is_closed);
+    for (const Point2LL& vertex : vertices)
+    {
+        line.junctions_.emplace_back(vertex, 400, 0);
+    }
+    Shape shape;
+    shape.push_back(Polygon(vertices, false));
+
+    for (coord_t x = -1000; x <= 11000; x += 500)
+    {
+        for (coord_t y = -1000; y <= 11000; y += 500)
+        {
+            const Point2LL point(x, y);
+            EXPECT_EQ(line.inside(point, false), shape.inside(point, false)) << "At " << point;
+            EXPECT_EQ(line.inside(point, true), shape.inside(point, true)) << "At " << point;
+        }
+    }
+}
+
+TEST(ExtrusionLineTest, InsideOfTooFewJunctions)
+{
+    ExtrusionLine line(0, false, true);
+    line.junctions_.emplace_back(Point2LL(0, 0), 400, 0);
+    line.junctions_.emplace_back(Point2LL(1000, 0), 400, 0);
+    EXPECT_FALSE(line.inside(Point2LL(500, 0), true));
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,73 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/LayerRangeTree.h"
+
+#include <atomic>
+#include <numeric>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(LayerRangeTreeTest, CoverCombinesEveryRange)
+{
+    constexpr size_t layer_count = 13;
+    std::atomic<size_t> layer_evaluations = 0;
+    LayerRangeTree<size_t> tree(
+        layer_count,
+        [&layer_evaluations](const size_t layer_idx)
+        {
+            layer_evaluations++;
+            return layer_idx + 1;
+        },
+        [](const size_t below, const size_t above)
+        {
+            return below + above;
+        });
+
+    for (size_t first = 0; first < layer_count; first++)
+    {
+        for (size_t last = first + 1; last <= layer_count; last++)
+        {
+            size_t sum = 0;
+            for (const size_t* covering_node : tree.cover(first, last))
+            {
+                sum += *covering_node;
+            }
+            EXPECT_EQ(sum, (first + 1 + last) * (last - first) / 2) << "The nodes must cover layers " << first << " up to " << last << " exactly once.";
+        }
+    }
+    EXPECT_EQ(layer_evaluations, layer_count) << "Every layer must only be computed once.";
+    EXPECT_TRUE(tree.cover(4, 4).empty());
+}
+
+TEST(LayerRangeTreeTest, AbsorbingValueSkipsUpperRange)
+{
+    std::atomic<size_t> layer_evaluations = 0;
+    LayerRangeTree<size_t> tree(
+        8,
+        [&layer_evaluations](const size_t layer_idx)
+        {
+            layer_evaluations++;
+            return layer_idx == 0 ? size_t(0) : size_t(1);
+        },
+        [](const size_t below, const size_t above)
+        {
+            return below * above;
+        },
+        [](const size_t below)
+        {
+            return below == 0;
+        });
+
+    const std::vector<const size_t*> covering_nodes = tree.cover(0, 8);
+    ASSERT_EQ(covering_nodes.size(), 1);
+    EXPECT_EQ(*covering_nodes.front(), 0);
+    EXPECT_EQ(layer_evaluations, 1) << "Only the bottom layer is needed when it already absorbs the rest.";
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
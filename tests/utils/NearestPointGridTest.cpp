@@ -0,0 +1,68 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "utils/NearestPointGrid.h"
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/Coord_t.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(NearestPointGridTest, Empty)
+{
+    const NearestPointGrid<size_t> grid({});
+    EXPECT_TRUE(grid.empty());
+    EXPECT_FALSE(grid.findNearest(Point2LL(0, 0)).has_value());
+}
+
+TEST(NearestPointGridTest, TiesPickLowestElement)
+{
+    const NearestPointGrid<size_t> grid({ { Point2LL(100, 0), 3 }, { Point2LL(-100, 0), 1 }, { Point2LL(0, 100), 2 } });
+    EXPECT_EQ(grid.findNearest(Point2LL(0, 0)).value(), 1);
+}
+
+TEST(NearestPointGridTest, MatchesBruteForceWhileRemoving)
+{
+    std::vector<std::pair<Point2LL, size_t>> points;
+    for (size_t i = 0; i < 200; i++)
+    {
+        // A dense cluster and a few far away points, so that queries need to search many rings.
+        const coord_t spread = i % 20 == 0 ? MM2INT(500) : MM2INT(5);
+        points.emplace_back(Point2LL(static_cast<coord_t>(i * 7919 % 1009) * spread / 1009, static_cast<coord_t>(i * 104729 % 1013) * spread / 1013), i);
+    }
+    NearestPointGrid<size_t> grid(points);
+
+    Point2LL query(MM2INT(-10), MM2INT(600)); // Start outside of the grid.
+    std::vector<bool> removed(points.size(), false);
+    for (size_t step = 0; step < points.size(); step++)
+    {
+        size_t expected = 0;
+        coord_t expected_distance2 = std::numeric_limits<coord_t>::max();
+        for (const auto& [point, elem] : points)
+        {
+            if (! removed[elem] && vSize2(point - query) < expected_distance2)
+            {
+                expected = elem;
+                expected_distance2 = vSize2(point - query);
+            }
+        }
+
+        const std::optional<size_t> nearest = grid.findNearest(query);
+        ASSERT_TRUE(nearest.has_value());
+        EXPECT_EQ(*nearest, expected) << "Step " << step << " must find the nearest remaining point.";
+
+        grid.remove(points[expected].first, expected);
+        removed[expected] = true;
+        query = points[expected].first;
+    }
+    EXPECT_TRUE(grid.empty());
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -7,6 +7,8 @@
 
 #include <gtest/gtest.h>
 
+#include "Application.h" // To union in parallel.
+#include "geometry/OffsetEngine.h"
 #include "geometry/OpenPolyline.h"
 #include "geometry/SingleShape.h"
 #include "utils/Coord_t.h"
@@ -242,6 +244,84 @@ TEST_F(PolygonTest, differenceClockwiseTest)
     EXPECT_GT(area, 0) << "Inner polygon should be clockwise.";
 }
 
+TEST_F(PolygonTest, differenceOfManyShapesTest)
+{
+    const Shape square(test_square);
+    std::vector<Shape> others;
+    others.emplace_back(Shape(Polygon({ { -10, -10 }, { 60, -10 }, { 60, 60 }, { -10, 60 } }, false)));
+    others.emplace_back(Shape(Polygon({ { 40, 40 }, { 110, 40 }, { 110, 110 }, { 40, 110 } }, false))); // Overlaps the first one.
+    others.emplace_back(Shape(Polygon({ { 1000, 1000 }, { 1100, 1000 }, { 1100, 1100 }, { 1000, 1100 } }, false))); // Far away.
+
+    const Shape batched = square.difference(others);
+    const Shape one_by_one = square.difference(others[0]).difference(others[1]).difference(others[2]);
+
+    EXPECT_EQ(batched.area(), one_by_one.area()) << "Subtracting all shapes at once must leave the same area as subtracting them one by one.";
+    EXPECT_EQ(batched.area(), 100 * 100 - 60 * 60 - 60 * 60 + 20 * 20);
+}
+
+TEST_F(PolygonTest, unionOfManyShapesTest)
+{
+    const Shape square(test_square);
+    std::vector<Shape> others;
+    others.emplace_back(Shape(Polygon({ { 50, 0 }, { 150, 0 }, { 150, 100 }, { 50, 100 } }, false)));
+    others.emplace_back(Shape(Polygon({ { 1000, 0 }, { 1100, 0 }, { 1100, 100 }, { 1000, 100 } }, false)));
+
+    const Shape batched = square.unionPolygons(others);
+    const Shape one_by_one = square.unionPolygons(others[0]).unionPolygons(others[1]);
+
+    EXPECT_EQ(batched.area(), one_by_one.area()) << "Unioning all shapes at once must give the same area as unioning them one by one.";
+    EXPECT_EQ(batched.size(), 2) << "The overlapping squares merge, and the far away one stays separate.";
+}
+
+TEST_F(PolygonTest, unionInParallelTest)
+{
+    Application::getInstance().startThreadPool();
+    // A grid of overlapping squares with a hole in each of them, and a diamond across many of them.
+    Shape shape;
+    for (coord_t x = 0; x < 20; x++)
+    {
+        for (coord_t y = 0; y < 20; y++)
+        {
+            shape.push_back(Polygon({ { x * 900, y * 900 }, { x * 900 + 1000, y * 900 }, { x * 900 + 1000, y * 900 + 1000 }, { x * 900, y * 900 + 1000 } }, false));
+            shape.push_back(Polygon({ { x * 900 + 300, y * 900 + 300 }, { x * 900 + 300, y * 900 + 700 }, { x * 900 + 700, y * 900 + 700 }, { x * 900 + 700, y * 900 + 300 } }, false));
+        }
+    }
+    shape.push_back(Polygon({ { 9000, -5000 }, { 23000, 9000 }, { 9000, 23000 }, { -5000, 9000 } }, false));
+
+    constexpr size_t parallel_vertex_count = 0; // Always split it into tiles.
+    const Shape parallel = shape.unionPolygonsParallel(parallel_vertex_count);
+    const Shape serial = shape.unionPolygons();
+
+    EXPECT_EQ(parallel.size(), serial.size()) << "Splitting the shape into tiles must not add or lose any polygons.";
+    EXPECT_NEAR(parallel.area(), serial.area(), 1000.0) << "The tiles may only round the points where the outlines cross their borders.";
+    EXPECT_EQ(parallel.splitIntoParts().size(), serial.splitIntoParts().size()) << "The parts that were cut apart by the tiles must be joined again.";
+}
+
+TEST_F(PolygonTest, disjointBooleansTest)
+{
+    const Shape square(test_square);
+    const Shape far_away(Polygon({ { 1000, 1000 }, { 1100, 1000 }, { 1100, 1100 }, { 1000, 1100 } }, false));
+
+    EXPECT_TRUE(square.intersection(far_away).empty()) << "Shapes with disjoint bounding boxes don't intersect.";
+    EXPECT_EQ(square.difference(far_away).area(), square.area()) << "Subtracting a shape with a disjoint bounding box leaves the shape as it was.";
+}
+
+TEST_F(PolygonTest, offsetEngineMatchesOffsetTest)
+{
+    const Shape shape(test_square);
+    OffsetEngine engine(shape, ClipperLib::jtRound);
+    const std::vector<coord_t> distances{ -20, 0, 10, 35 };
+    const std::vector<Shape> offsets = engine.offsets(distances);
+
+    ASSERT_EQ(offsets.size(), distances.size());
+    for (size_t distance_idx = 0; distance_idx < distances.size(); distance_idx++)
+    {
+        const Shape expected = shape.offset(distances[distance_idx], ClipperLib::jtRound);
+        EXPECT_EQ(offsets[distance_idx].area(), expected.area()) << "Offsetting by " << distances[distance_idx] << " must give the same result as Shape::offset.";
+        EXPECT_EQ(engine.offset(distances[distance_idx]).area(), expected.area()) << "The engine must give the same result when asked again.";
+    }
+}
+
 /*
  * The convex hull of a cube should still be a cube
  */
@@ -479,5 +479,19 @@ TEST_F(PolygonUtilsTest, DISABLED_RelativeHammingLineLineDifferentVerts) // Disa
     ASSERT_EQ(PolygonUtils::relativeHammingDistance(test_line, test_line_extra_vertices), 0.0) << "Even though the exact vertices are different, the actual outline is the same.";
 }
 
+TEST_F(PolygonUtilsTest, CornerAnglesSquare)
+{
+    const Polygon square({ Point2LL(0, 0), Point2LL(5000, 0), Point2LL(10000, 0), Point2LL(10000, 10000), Point2LL(0, 10000) }, false);
+    const std::vector<double> angles = PolygonUtils::cornerAngles(square);
+
+    ASSERT_EQ(angles.size(), square.size());
+    EXPECT_NEAR(angles[1], 0.0, 0.0001) << "A point in the middle of a straight edge is no corner.";
+    for (const size_t corner_idx : { 0, 2, 3, 4 })
+    {
+        EXPECT_NEAR(std::abs(angles[corner_idx]), 0.5, 0.0001) << "Each corner of a square is a right angle.";
+        EXPECT_NEAR(angles[corner_idx], angles[0], 0.0001) << "All corners of a square turn the same way.";
+    }
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
@@ -0,0 +1,82 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/PolylineStitcher.h"
+
+#include <gtest/gtest.h>
+
+#include "geometry/OpenLinesSet.h"
+#include "geometry/OpenPolyline.h"
+#include "geometry/Shape.h"
+#include "utils/ExtrusionLine.h"
+#include "utils/ExtrusionLineStitcher.h"
+#include "utils/OpenPolylineStitcher.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(PolylineStitcherTest, StitchInBothDirections)
+{
+    OpenLinesSet lines;
+    lines.push_back(OpenPolyline({ Point2LL(1000, 0), Point2LL(2000, 0) }));
+    lines.push_back(OpenPolyline({ Point2LL(3000, 0), Point2LL(2050, 0) })); // Has to be reversed to connect to the first line.
+    lines.push_back(OpenPolyline({ Point2LL(0, 0), Point2LL(1000, 0) })); // Connects to the start of the first line.
+
+    OpenLinesSet result_lines;
+    Shape result_polygons;
+    OpenPolylineStitcher::stitch(lines, result_lines, result_polygons, 100);
+
+    ASSERT_EQ(result_lines.size(), 1) << "All lines are within the stitch distance of each other, so they form one line.";
+    EXPECT_TRUE(result_polygons.empty()) << "The line doesn't loop back to its start.";
+    const OpenPolyline& line = result_lines.front();
+    ASSERT_EQ(line.size(), 5) << "The points that are within the snap distance are merged.";
+    const bool forward = line.front() == Point2LL(0, 0);
+    const std::vector<Point2LL> expected = { Point2LL(0, 0), Point2LL(1000, 0), Point2LL(2000, 0), Point2LL(2050, 0), Point2LL(3000, 0) };
+    for (size_t point_idx = 0; point_idx < expected.size(); point_idx++)
+    {
+        EXPECT_EQ(line[forward ? point_idx : expected.size() - 1 - point_idx], expected[point_idx]) << "The lines are joined in order.";
+    }
+}
+
+TEST(PolylineStitcherTest, StitchIntoPolygon)
+{
+    OpenLinesSet lines;
+    lines.push_back(OpenPolyline({ Point2LL(0, 0), Point2LL(1000, 0) }));
+    lines.push_back(OpenPolyline({ Point2LL(1000, 1000), Point2LL(1000, 0) }));
+    lines.push_back(OpenPolyline({ Point2LL(1000, 1000), Point2LL(0, 1000) }));
+    lines.push_back(OpenPolyline({ Point2LL(0, 1000), Point2LL(0, 50) }));
+
+    OpenLinesSet result_lines;
+    Shape result_polygons;
+    OpenPolylineStitcher::stitch(lines, result_lines, result_polygons, 100);
+
+    EXPECT_TRUE(result_lines.empty()) << "The lines form a loop, so no open line should be left.";
+    ASSERT_EQ(result_polygons.size(), 1);
+    EXPECT_EQ(result_polygons.front().size(), 5) << "The corners are merged, but the last line ends far enough from the first to keep both points.";
+}
+
+TEST(PolylineStitcherTest, EvenLinesKeepTheirDirection)
+{
+    ExtrusionLine first(0, false);
+    first.emplace_back(Point2LL(0, 0), 400, 0);
+    first.emplace_back(Point2LL(1000, 0), 400, 0);
+    ExtrusionLine second(0, false);
+    second.emplace_back(Point2LL(1000, 0), 400, 0);
+    second.emplace_back(Point2LL(2000, 0), 400, 0);
+    VariableWidthLines lines = { second, first }; // The second line comes first, so it has to be extended at its start.
+
+    VariableWidthLines result_lines;
+    VariableWidthLines result_polygons;
+    ExtrusionLineStitcher::stitch(lines, result_lines, result_polygons, 100);
+
+    ASSERT_EQ(result_lines.size(), 1);
+    const ExtrusionLine& line = result_lines.front();
+    ASSERT_EQ(line.size(), 3);
+    EXPECT_EQ(line[0].p_, Point2LL(0, 0)) << "Even walls can't be reversed, so the joined line has to go in the direction of both lines.";
+    EXPECT_EQ(line[1].p_, Point2LL(1000, 0));
+    EXPECT_EQ(line[2].p_, Point2LL(2000, 0));
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
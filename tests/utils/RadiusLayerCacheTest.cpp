@@ -0,0 +1,96 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/RadiusLayerCache.h"
+
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include "geometry/Polygon.h"
+#include "utils/PairHash.h"
+
+namespace cura
+{
+
+class RadiusLayerCacheTest : public testing::Test
+{
+public:
+    RadiusLayerCache cache;
+    Shape square;
+
+    void SetUp() override
+    {
+        square.push_back(Polygon({ { 0, 0 }, { 100, 0 }, { 100, 100 }, { 0, 100 } }, false));
+    }
+};
+
+TEST_F(RadiusLayerCacheTest, GetMissing)
+{
+    EXPECT_FALSE(cache.get(10, 0)) << "An empty cache has no areas.";
+    cache.insert(10, 3, square);
+    EXPECT_FALSE(cache.get(10, 2)) << "Other layers of the same radius weren't added.";
+    EXPECT_FALSE(cache.get(20, 3)) << "Other radii on the same layer weren't added.";
+    EXPECT_FALSE(cache.get(10, -1)) << "Negative layers are never in the cache.";
+}
+
+TEST_F(RadiusLayerCacheTest, InsertKeepsFirst)
+{
+    cache.insert(10, 3, square);
+    const Shape* first = &cache.get(10, 3).value().get();
+    cache.insert(10, 3, Shape());
+
+    ASSERT_TRUE(cache.get(10, 3));
+    EXPECT_EQ(&cache.get(10, 3).value().get(), first) << "Adding an existing key must leave the first area in place.";
+    EXPECT_EQ(first->area(), square.area());
+}
+
+TEST_F(RadiusLayerCacheTest, ReferencesStayValid)
+{
+    cache.insert(10, 0, square);
+    const Shape& first = cache.get(10, 0).value().get();
+    for (LayerIndex layer_idx = 1; layer_idx < 2000; layer_idx++)
+    {
+        cache.insert(10, layer_idx, square);
+        cache.insert(layer_idx, layer_idx, square);
+    }
+    EXPECT_EQ(&cache.get(10, 0).value().get(), &first) << "Adding areas must not move the ones already handed out.";
+    EXPECT_EQ(cache.get(1999, 1999).value().get().area(), square.area());
+}
+
+TEST_F(RadiusLayerCacheTest, MaxCalculatedLayer)
+{
+    EXPECT_EQ(cache.getMaxCalculatedLayer(10), -1) << "Without any layers the maximum is -1.";
+
+    std::unordered_map<std::pair<coord_t, LayerIndex>, Shape> data;
+    for (LayerIndex layer_idx = 1; layer_idx <= 300; layer_idx++)
+    {
+        data.emplace(std::make_pair(coord_t(10), layer_idx), square);
+    }
+    cache.insert(data);
+    EXPECT_EQ(cache.getMaxCalculatedLayer(10), 300) << "Counting may start at layer 1, as there are no areas on model on layer 0.";
+
+    cache.insert(10, 302, square);
+    EXPECT_EQ(cache.getMaxCalculatedLayer(10), 300) << "Counting stops at the first gap.";
+}
+
+TEST_F(RadiusLayerCacheTest, EvictAbove)
+{
+    for (LayerIndex layer_idx = 0; layer_idx < 600; layer_idx++)
+    {
+        cache.insert(10, layer_idx, square);
+        cache.insert(20, layer_idx, square);
+    }
+    const Shape& kept = cache.get(10, 100).value().get();
+    cache.evictAbove(100);
+
+    EXPECT_EQ(&cache.get(10, 100).value().get(), &kept) << "The areas up to the layer must be kept.";
+    EXPECT_FALSE(cache.get(10, 101)) << "The areas above the layer must be evicted.";
+    EXPECT_FALSE(cache.get(20, 599)) << "The areas of all radii must be evicted.";
+    EXPECT_EQ(cache.getMaxCalculatedLayer(20), 100);
+
+    cache.insert(10, 101, square);
+    EXPECT_TRUE(cache.get(10, 101)) << "Evicted areas can be added again.";
+}
+
+} // namespace cura
@@ -0,0 +1,128 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ShapeCoordinates.h"
+
+#include <cmath>
+#include <numbers>
+
+#include <gtest/gtest.h>
+
+#include "geometry/Polygon.h"
+#include "geometry/Shape.h"
+#include "utils/polygonUtils.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class ShapeCoordinatesTest : public testing::Test
+{
+public:
+    Shape shape;
+
+    void SetUp() override
+    {
+        shape.push_back(Polygon({ Point2LL(0, 0), Point2LL(10000, 0), Point2LL(10000, 10000), Point2LL(0, 10000) }, false));
+        shape.push_back(Polygon({ Point2LL(2000, 2000), Point2LL(2000, 8000), Point2LL(8000, 8000), Point2LL(8000, 2000) }, false)); // A hole.
+        shape.push_back(Polygon({ Point2LL(20000, 0), Point2LL(25000, 3000), Point2LL(21000, 7000), Point2LL(20000, 0) }, true)); // A triangle, explicitly closed.
+    }
+};
+
+TEST_F(ShapeCoordinatesTest, BoundsAndArea)
+{
+    const ShapeCoordinates coordinates(shape);
+    const AABB expected(shape);
+    EXPECT_EQ(coordinates.bounds().min_, expected.min_);
+    EXPECT_EQ(coordinates.bounds().max_, expected.max_);
+    EXPECT_DOUBLE_EQ(coordinates.area(), shape.area());
+}
+
+TEST_F(ShapeCoordinatesTest, InsideLikeShape)
+{
+    const ShapeCoordinates coordinates(shape);
+    const std::vector<Point2LL> points{
+        Point2LL(1000, 1000), // Inside.
+        Point2LL(5000, 5000), // In the hole.
+        Point2LL(-1, 5000), // Outside.
+        Point2LL(0, 5000), // On the outer border.
+        Point2LL(10000, 10000), // On a vertex.
+        Point2LL(2000, 5000), // On the border of the hole.
+        Point2LL(5000, 2000), // On a horizontal edge of the hole.
+        Point2LL(21000, 3000), // In the triangle.
+        Point2LL(21000, 0), // Level with the bottom vertex of the triangle.
+        Point2LL(30000, 3000), // Level with a vertex of the triangle, outside of it.
+    };
+    for (const Point2LL& point : points)
+    {
+        EXPECT_EQ(coordinates.inside(point, true), shape.inside(point, true)) << "At " << point;
+        EXPECT_EQ(coordinates.inside(point, false), shape.inside(point, false)) << "At " << point;
+    }
+}
+
+TEST_F(ShapeCoordinatesTest, FindClosestLikePolygonUtils)
+{
+    const ShapeCoordinates coordinates(shape);
+    const std::vector<Point2LL> points{ Point2LL(-500, 4321), Point2LL(5000, 4000), Point2LL(15000, 1000), Point2LL(23000, 8000), Point2LL(10000, 10000) };
+    for (const Point2LL& point : points)
+    {
+        const ClosestPointPolygon expected = PolygonUtils::findClosest(point, shape);
+        const ClosestPointPolygon actual = coordinates.findClosest(point);
+        ASSERT_TRUE(actual.isValid());
+        EXPECT_EQ(actual.location_, expected.location_) << "From " << point;
+        EXPECT_EQ(actual.poly_, expected.poly_) << "From " << point;
+        EXPECT_EQ(actual.poly_idx_, expected.poly_idx_) << "From " << point;
+        EXPECT_EQ(actual.point_idx_, expected.point_idx_) << "From " << point;
+    }
+}
+
+TEST(ShapeCoordinatesIndexedTest, InsideManyEdgesLikeShape)
+{
+    // A star with a lot of edges, with a hole in it, so that the edges are sorted into bands.
+    Shape shape;
+    Polygon star;
+    Polygon hole;
+    constexpr size_t corners = 200;
+    for (size_t i = 0; i < corners; i++)
+    {
+        const double angle = 2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(corners);
+        const coord_t radius = i % 2 == 0 ? 10000 : 7000;
+        star.push_back(Point2LL(std::llrint(std::cos(angle) * radius), std::llrint(std::sin(angle) * radius)));
+        hole.push_back(Point2LL(std::llrint(std::cos(-angle) * 3000), std::llrint(std::sin(-angle) * 3000)));
+    }
+    shape.push_back(star);
+    shape.push_back(hole);
+
+    std::vector<Point2LL> points;
+    for (coord_t x = -11000; x <= 11000; x += 250)
+    {
+        for (coord_t y = -11000; y <= 11000; y += 250)
+        {
+            points.emplace_back(x, y);
+        }
+    }
+    points.insert(points.end(), star.begin(), star.end()); // On the vertices, including the highest and lowest ones.
+    points.insert(points.end(), hole.begin(), hole.end());
+
+    const std::vector<bool> inside = shape.inside(points, true);
+    const std::vector<bool> inside_not_border = ShapeCoordinates(shape, true).inside(points, false);
+    ASSERT_EQ(inside.size(), points.size());
+    ASSERT_EQ(inside_not_border.size(), points.size());
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        EXPECT_EQ(inside[i], shape.inside(points[i], true)) << "At " << points[i];
+        EXPECT_EQ(inside_not_border[i], shape.inside(points[i], false)) << "At " << points[i];
+    }
+}
+
+TEST(ShapeCoordinatesEmptyTest, EmptyShape)
+{
+    const Shape shape;
+    const ShapeCoordinates coordinates(shape);
+    EXPECT_FALSE(coordinates.findClosest(Point2LL(0, 0)).isValid());
+    EXPECT_FALSE(coordinates.inside(Point2LL(0, 0)));
+    EXPECT_EQ(coordinates.area(), 0.0);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
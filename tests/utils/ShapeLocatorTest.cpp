@@ -0,0 +1,76 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ShapeLocator.h"
+
+#include <gtest/gtest.h>
+
+#include "geometry/Polygon.h"
+#include "geometry/Shape.h"
+#include "utils/polygonUtils.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class ShapeLocatorTest : public testing::Test
+{
+public:
+    Shape shape;
+    std::vector<Point2LL> points; //!< Points close to the border, on it and far away from it.
+
+    void SetUp() override
+    {
+        shape.push_back(Polygon({ Point2LL(0, 0), Point2LL(10000, 0), Point2LL(10000, 10000), Point2LL(0, 10000) }, false));
+        shape.push_back(Polygon({ Point2LL(2000, 2000), Point2LL(2000, 8000), Point2LL(8000, 8000), Point2LL(8000, 2000) }, false)); // A hole.
+        shape.push_back(Polygon({ Point2LL(20000, 0), Point2LL(25000, 3000), Point2LL(21000, 7000) }, false));
+
+        points = { Point2LL(-300, 4321), Point2LL(1000, 1300), Point2LL(5000, 4700), Point2LL(15000, 1000), Point2LL(23000, 8000), Point2LL(10000, 5000), Point2LL(-40000, 90000) };
+    }
+};
+
+TEST_F(ShapeLocatorTest, FindClosestLikePolygonUtils)
+{
+    const ShapeLocator locator(shape, 1000);
+    for (const Point2LL& point : points)
+    {
+        const ClosestPointPolygon expected = PolygonUtils::findClosest(point, shape);
+        const ClosestPointPolygon actual = locator.findClosest(point);
+        ASSERT_TRUE(actual.isValid());
+        EXPECT_EQ(actual.location_, expected.location_) << "From " << point;
+        EXPECT_EQ(actual.poly_idx_, expected.poly_idx_) << "From " << point;
+        EXPECT_EQ(actual.point_idx_, expected.point_idx_) << "From " << point;
+    }
+}
+
+TEST_F(ShapeLocatorTest, FindNearestVertLikePolygonUtils)
+{
+    const ShapeLocator locator(shape, 1000);
+    for (const Point2LL& point : points)
+    {
+        const PolygonsPointIndex expected = PolygonUtils::findNearestVert(point, shape);
+        const PolygonsPointIndex actual = locator.findNearestVert(point);
+        EXPECT_EQ(actual.p(), expected.p()) << "From " << point;
+        EXPECT_EQ(actual.poly_idx_, expected.poly_idx_) << "From " << point;
+    }
+}
+
+TEST_F(ShapeLocatorTest, EnsureInside)
+{
+    const ShapeLocator locator(shape, 1000);
+    const std::vector<Point2LL> points_along_edges{ Point2LL(-300, 4321), Point2LL(1000, 1300), Point2LL(5000, 4700), Point2LL(15000, 1000), Point2LL(10000, 5000) };
+    for (const Point2LL& point : points_along_edges)
+    {
+        Point2LL moved = point;
+        const ClosestPointPolygon cpp = locator.ensureInsideOrOutside(moved, 100);
+        ASSERT_TRUE(cpp.isValid()) << "From " << point;
+        EXPECT_TRUE(shape.inside(moved)) << "From " << point << " to " << moved;
+        if (shape.inside(point) && vSize(point - cpp.location_) > 100)
+        {
+            EXPECT_EQ(moved, point) << "Points that are far enough inside already shouldn't move.";
+        }
+    }
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
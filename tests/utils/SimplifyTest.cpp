@@ -7,7 +7,10 @@
 
 #include <gtest/gtest.h>
 
+#include "Application.h" // To simplify large batches on the thread pool.
+#include "geometry/Shape.h"
 #include "utils/Coord_t.h"
+#include "utils/ExtrusionLine.h"
 #include "utils/polygonUtils.h" // Helper functions for testing deviation.
 
 // NOLINTBEGIN(*-magic-numbers)
@@ -405,5 +408,59 @@ TEST_F(SimplifyTest, ToDegenerate)
     EXPECT_EQ(segment.size(), 0) << "The segment got removed entirely, because simplification would reduce its vertices to less than 2, making it degenerate.";
 }
 
+/*!
+ * Tests that a batch that is large enough to be simplified in parallel gives
+ * the same result as simplifying each of its polygons separately.
+ */
+TEST_F(SimplifyTest, LargeBatchSameAsSeparately)
+{
+    Application::getInstance().startThreadPool();
+
+    Shape batch;
+    std::vector<ExtrusionLine> lines;
+    for (size_t copy = 0; copy < 20; ++copy) // Each shape has several thousand vertices, so this is well above the size that is simplified in parallel.
+    {
+        for (const Polygon& shape : { circle, square_collinear, sine, spiral, zigzag })
+        {
+            Polygon moved = shape;
+            moved.translate(Point2LL(copy * 1000, 0));
+            batch.push_back(moved);
+
+            ExtrusionLine line(0, false, copy % 2 == 0);
+            for (const Point2LL& point : moved)
+            {
+                line.emplace_back(point, 400, 0);
+            }
+            lines.push_back(line);
+        }
+    }
+    batch.push_back(Polygon()); // Simplified away entirely, so it should be left out.
+    lines.emplace_back();
+
+    const Shape simplified = simplifier.polygon(batch);
+    Shape expected;
+    for (const Polygon& polygon : batch)
+    {
+        expected.push_back(simplifier.polygon(polygon), CheckNonEmptyParam::OnlyIfNotEmpty);
+    }
+    ASSERT_EQ(simplified.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_EQ(simplified[i].getPoints(), expected[i].getPoints()) << "Polygon " << i << " should be simplified the same in a batch.";
+    }
+
+    const std::vector<ExtrusionLine> simplified_lines = simplifier.lines(lines);
+    ASSERT_EQ(simplified_lines.size(), lines.size() - 1) << "Only the empty line should be left out.";
+    for (size_t i = 0; i < simplified_lines.size(); ++i)
+    {
+        const ExtrusionLine expected_line = lines[i].is_closed_ ? simplifier.polygon(lines[i]) : simplifier.polyline(lines[i]);
+        ASSERT_EQ(simplified_lines[i].size(), expected_line.size()) << "Line " << i << " should be simplified the same in a batch.";
+        for (size_t j = 0; j < expected_line.size(); ++j)
+        {
+            EXPECT_EQ(simplified_lines[i][j].p_, expected_line[j].p_);
+        }
+    }
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
@@ -300,4 +300,67 @@ TEST_F(GetNearestTest, Equal)
         << ")."; // FIXME: simplify once fmt or we use C++20 is added as a dependency
 }
 
+TEST(SparseGridTest, ManyCells)
+{
+    // Enough points in enough different cells that the cell table has to grow a couple of times.
+    constexpr coord_t grid_size = 10;
+    SparsePointGridInclusive<size_t> grid(grid_size);
+    std::vector<Point2LL> points;
+    for (size_t idx = 0; idx < 5000; idx++)
+    {
+        points.emplace_back(static_cast<coord_t>(idx * 7919 % 1009) - 500, static_cast<coord_t>(idx * 104729 % 997) - 500);
+        grid.insert(points.back(), idx);
+    }
+
+    for (const Point2LL target : { Point2LL(0, 0), Point2LL(-480, 333), Point2LL(495, -495), Point2LL(2000, 2000) })
+    {
+        std::vector<size_t> result = grid.getNearbyVals(target, grid_size * 2);
+        std::sort(result.begin(), result.end());
+        for (size_t idx = 0; idx < points.size(); idx++)
+        {
+            if (vSize(points[idx] - target) <= grid_size * 2)
+            {
+                EXPECT_TRUE(std::binary_search(result.begin(), result.end(), idx)) << "Point " << points[idx] << " is near " << target << " but wasn't found.";
+            }
+        }
+        EXPECT_TRUE(std::adjacent_find(result.begin(), result.end()) == result.end()) << "Each point is found only once.";
+    }
+}
+
+TEST(SparseGridTest, CellKeepsInsertionOrder)
+{
+    constexpr coord_t grid_size = 10;
+    SparsePointGridInclusive<int> grid(grid_size);
+    grid.insert(Point2LL(1, 1), 0);
+    grid.insert(Point2LL(100, 100), 1);
+    grid.insert(Point2LL(2, 2), 2);
+    grid.insert(Point2LL(3, 3), 3);
+
+    EXPECT_EQ(grid.getNearbyVals(Point2LL(2, 2), 1), std::vector<int>({ 0, 2, 3 }));
+    EXPECT_EQ(std::distance(grid.begin(), grid.end()), 4);
+    EXPECT_EQ(grid.begin()->second.val, 0);
+}
+
+TEST(SparseGridTest, BuiltAtOnceLikeInserted)
+{
+    constexpr coord_t grid_size = 10;
+    std::vector<SparsePointGridInclusive<size_t>::Elem> elems;
+    for (size_t idx = 0; idx < 2000; idx++)
+    {
+        elems.emplace_back(Point2LL(static_cast<coord_t>(idx * 7919 % 211) - 100, static_cast<coord_t>(idx * 104729 % 199) - 100), idx);
+    }
+    SparsePointGridInclusive<size_t> inserted(grid_size);
+    for (const SparsePointGridInclusive<size_t>::Elem& elem : elems)
+    {
+        inserted.insert(elem.point, elem.val);
+    }
+    const SparsePointGridInclusive<size_t> built(grid_size, elems);
+
+    EXPECT_EQ(std::distance(built.begin(), built.end()), elems.size());
+    for (const Point2LL target : { Point2LL(0, 0), Point2LL(-95, 42), Point2LL(100, -100), Point2LL(500, 500) })
+    {
+        EXPECT_EQ(built.getNearbyVals(target, grid_size * 2), inserted.getNearbyVals(target, grid_size * 2)) << "The same elements in the same order near " << target << ".";
+    }
+}
+
 } // namespace cura
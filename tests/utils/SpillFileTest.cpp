@@ -0,0 +1,40 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/SpillFile.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(SpillFileTest, ReadBackRecords)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "curaengine_spill_file_test";
+    {
+        SpillFile spill_file(directory);
+        ASSERT_TRUE(spill_file.isOpen());
+
+        const std::string first = "first record";
+        const std::string second(std::string("with\0zero", 9) + std::string(10000, 'x'));
+        const std::optional<SpillFile::Record> first_record = spill_file.write(first);
+        const std::optional<SpillFile::Record> second_record = spill_file.write(second);
+        const std::optional<SpillFile::Record> empty_record = spill_file.write("");
+        ASSERT_TRUE(first_record && second_record && empty_record);
+
+        // Read them back in a different order than they were written.
+        EXPECT_EQ(spill_file.read(*second_record), second);
+        EXPECT_EQ(spill_file.read(*first_record), first);
+        EXPECT_EQ(spill_file.read(*empty_record), "");
+    }
+    EXPECT_TRUE(std::filesystem::is_empty(directory)) << "The spill file should be removed once it's not used anymore.";
+    std::filesystem::remove_all(directory);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -3,7 +3,11 @@
 
 #include "utils/string.h" // The file under test.
 #include "geometry/Point2LL.h"
+#include <cstdio>
 #include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
 
 // NOLINTBEGIN(*-magic-numbers)
 namespace cura
@@ -86,5 +90,50 @@ INSTANTIATE_TEST_SUITE_P(WriteDoubleToStreamTestInstantiation,
                                          std::numeric_limits<double>::lowest(),
                                          -std::numeric_limits<double>::lowest()));
 
+/*
+ * Test the exact strings that writeInt2mm writes, which end up in the g-code.
+ */
+TEST(WriteInt2mmTest, ExactOutput)
+{
+    const std::vector<std::pair<int, std::string>> cases
+        = { { 5, "0.005" }, { 50, "0.05" }, { 500, "0.5" }, { 1500, "1.5" }, { 12000, "12" }, { 123456, "123.456" }, { -5, "-0.005" }, { -1500, "-1.5" }, { -12000, "-12" } };
+    for (const auto& [in, expected] : cases)
+    {
+        std::ostringstream ss;
+        writeInt2mm(in, ss);
+        EXPECT_EQ(ss.str(), expected) << "The integer " << in << " was printed wrongly.";
+    }
+}
+
+/*
+ * Test that writeDoubleToStream rounds exactly like printf does, including on
+ * ties and values that are just below a tie in binary, and only trims zeros.
+ */
+TEST(WriteDoubleToStreamTest, MatchesPrintf)
+{
+    const std::vector<double> values = { 0.0, -0.0, 0.125, 0.375, 1.005, 2.5, -2.5, 0.1, 1234.56789, -0.00049, 99.99995, 1e14 };
+    for (const double value : values)
+    {
+        for (uint8_t precision = 0; precision < 10; precision++)
+        {
+            char buffer[64];
+            const int char_count = snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(precision), value);
+            std::string expected(buffer, char_count);
+            if (precision > 0)
+            {
+                expected.erase(expected.find_last_not_of('0') + 1);
+                if (expected.back() == '.')
+                {
+                    expected.pop_back();
+                }
+            }
+
+            std::ostringstream ss;
+            writeDoubleToStream(precision, value, ss);
+            EXPECT_EQ(ss.str(), expected) << "The double " << value << " was printed wrongly with precision " << int(precision) << ".";
+        }
+    }
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)